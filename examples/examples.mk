@@ -37,7 +37,7 @@ HAZLIB = -L$(HAZDIR)/lib -lhazmath
 
 INCLUDE += -I$(HAZDIR)/include
 
-LIBS += $(HAZLIB) -lm 
+LIBS += $(HAZLIB) -lm -lpthread
 
 RPATH = -Wl,-rpath=$(HAZDIR)/lib
 
@@ -166,7 +166,8 @@ int main (int argc, char* argv[])
   INT solver_flag=-20;
 
   // For direct solver we can factorize the matrix ahead of time and not each time step
-  void* Numeric = NULL;
+  direct_data dirdata;
+  direct_data_null(&dirdata);
 
   // Set parameters for algebriac multigrid methods
   AMG_param amgparam;
@@ -180,11 +181,16 @@ int main (int argc, char* argv[])
   time_stepper.sol = &sol;
 
   // Dump Solution
-  char solout[40];
-  char exactout[40];
+  // The mesh is written once and every time step only writes u and ut
+  // (P0 on elements, otherwise at the vertices) in the background
+  tseries_file* tsout = NULL;
+  REAL* tsvals[2] = {sol.val,exact_sol.val};
   if (inparam.output_dir!=NULL) {
-    sprintf(solout,"output/solution_ts000.vtu");
-    dump_sol_vtk(solout,"u",&mesh,&FE,time_stepper.sol->val);
+    INT center = (FE.FEtype==0) ? TSERIES_CELL : TSERIES_POINT;
+    tsout = tseries_open("output/solution.xmf",&mesh,1);
+    tseries_add_field(tsout,"u",center,1);
+    tseries_add_field(tsout,"ut",center,1);
+    tseries_write(tsout,current_time,tsvals);
   }
 
   // Store current RHS
@@ -210,6 +216,10 @@ int main (int argc, char* argv[])
   printf("L2 Norm of u error      = %26.13e\n",uerr[0]);
   printf(">>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>\n\n\n");
 
+  // Boundary DOF and the entries of At_noBC they touch, found once for all time steps
+  dirichlet_pattern dpat;
+  initialize_dirichlet_pattern(&dpat);
+
   clock_t clk_timeloop_start = clock();
   // Begin Timestepping Loop
   INT j; // Time step counter
@@ -236,28 +246,18 @@ int main (int argc, char* argv[])
       eliminate_DirichletBC(bc,&FE,&mesh,time_stepper.rhs_time,time_stepper.At,time_stepper.time);
       // If Direct Solver used only factorize once
       if(linear_itparam.linear_itsolver_type == 0) { // Direct Solver
-#if WITH_SUITESPARSE
-        printf(" --> using UMFPACK's Direct Solver: factorization \n");
-        Numeric = factorize_UMF(time_stepper.At,linear_itparam.linear_print_level);
-#else
-        error_extlib(255,__FUNCTION__,"SuiteSparse");
-        return 0;
-#endif
+        printf(" --> using the Direct Solver: factorization \n");
+        direct_data_setup(time_stepper.At,&dirdata,linear_itparam.linear_print_level);
       }
     } else {
-      eliminate_DirichletBC_RHS(bc,&FE,&mesh,time_stepper.rhs_time,time_stepper.At_noBC,time_stepper.time);
+      eliminate_DirichletBC_RHS_reuse(bc,&FE,&mesh,time_stepper.rhs_time,time_stepper.At_noBC,time_stepper.time,&dpat);
     }
 
     // Solve
     clock_t clk_solve_start = clock();
     if(linear_itparam.linear_itsolver_type == 0) { // Direct Solver
-#if WITH_SUITESPARSE
-      printf(" --> using UMFPACK's Direct Solver: solve\n");
-      solver_flag = solve_UMF(time_stepper.At,time_stepper.rhs_time,time_stepper.sol,Numeric,linear_itparam.linear_print_level);
-#else
-      error_extlib(255,__FUNCTION__,"SuiteSparse");
-      return 0;
-#endif
+      printf(" --> using the Direct Solver: solve\n");
+      solver_flag = direct_data_solve(&dirdata,time_stepper.rhs_time,time_stepper.sol,1,linear_itparam.linear_print_level);
     } else { // Iterative Solver
       // Use AMG as iterative solver
       if (linear_itparam.linear_itsolver_type == SOLVER_AMG){
@@ -307,10 +307,8 @@ int main (int argc, char* argv[])
     /*******************************************************************/
 
     if (inparam.output_dir!=NULL) {
-      sprintf(solout,"output/solution_ts%03d.vtu",time_stepper.current_step);
-      dump_sol_vtk(solout,"u",&mesh,&FE,time_stepper.sol->val);
-      sprintf(exactout,"output/exact_solution_ts%03d.vtu",time_stepper.current_step);
-      dump_sol_vtk(exactout,"ut",&mesh,&FE,exact_sol.val);
+      tsvals[0] = time_stepper.sol->val;
+      tseries_write(tsout,time_stepper.time,tsvals);
     }
     printf("\n");
   } // End Timestepping Loop
@@ -327,9 +325,9 @@ int main (int argc, char* argv[])
     printf("%02d\t\t%f\t%25.16e\t%25.16e\t%25.16e\n",j,j*time_stepper.dt,unorm[j],utnorm[j],uerr[j]);
   }
 
-  // Combine all timestep vtks in one file
+  // Wait for the last time steps to be written
   if (inparam.output_dir!=NULL) {
-    create_pvd("output/solution.pvd",time_stepper.tsteps+1,"solution_ts","timestep");
+    tseries_close(tsout);
   }
 
   /******** Free All the Arrays **************************************/
@@ -337,6 +335,7 @@ int main (int argc, char* argv[])
   if(utnorm) free(utnorm);
   if(uerr) free(uerr);
   dvec_free(&exact_sol);
+  free_dirichlet_pattern(&dpat);
   free_timestepper(&time_stepper);
   free_fespace(&FE);
   if(cq) {
@@ -345,9 +344,7 @@ int main (int argc, char* argv[])
     cq = NULL;
   }
   free_mesh(&mesh);
-#if WITH_SUITESPARSE
-  if (Numeric) umfpack_free_numeric(Numeric);
-#endif
+  direct_data_free(&dirdata);
 
   /*******************************************************************/
 
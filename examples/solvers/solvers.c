@@ -29,6 +29,8 @@ int main (int argc, char* argv[])
   dCSRmat *A=NULL;
   dvector *b=NULL;
   dvector *x=NULL;
+  dCSRmat Amat;
+  dvector bvec;
 
   printf("\n===========================================================================\n");
   printf("Reading the matrix, right hand side, and parameters\n");
@@ -56,7 +58,17 @@ int main (int argc, char* argv[])
     fnamea=strdup(argv[1]);
     fnameb=strdup(argv[2]);
   }
-  if(read_to_eof){
+  // binary files (see dcsr_write_bin() and dvec_write_bin()) are mapped
+  SHORT read_bin=(strlen(fnamea)>4 && !strcmp(fnamea+strlen(fnamea)-4,".bin"));
+  if(read_bin){
+    fprintf(stdout,"\n%s: mapping files \"%s\" and \"%s\"\n", __FUNCTION__,fnamea,fnameb);
+    dcsr_map_bin(fnamea,&Amat);
+    dvec_map_bin(fnameb,&bvec);
+    free(fnamea);
+    free(fnameb);
+    A=&Amat;
+    b=&bvec;
+  } else if(read_to_eof){
     fprintf(stdout,"\n%s: reading file \"%s\" unitl EOF\n", __FUNCTION__,fnamea);
     fp = fopen(fnamea,"r");
     if (!fp) check_error(ERROR_OPEN_FILE, __FUNCTION__);
@@ -69,15 +81,13 @@ int main (int argc, char* argv[])
     if(fnameb) free(fnameb);
     b=dvector_read_eof_p(fp);
   } else {
-    fp = fopen(fnamea,"r");
-    if (!fp) check_error(ERROR_OPEN_FILE, __FUNCTION__);
-    if(fnamea) free(fnamea);
-    A=dcoo_read_dcsr_p(fp);
-    fclose(fp);
-    fp = fopen(fnameb,"r");
-    if (!fp) check_error(ERROR_OPEN_FILE, __FUNCTION__);
-    if(fnameb) free(fnameb);
-    b=dvector_read_p(fp);
+    // parsed in parallel; MatrixMarket files can be read too
+    dcsr_read_mm(fnamea,&Amat);
+    dvec_read_mm(fnameb,&bvec);
+    free(fnamea);
+    free(fnameb);
+    A=&Amat;
+    b=&bvec;
   }
   /************************************************************/
   /*************** ACTION *************************************/
@@ -112,6 +122,15 @@ int main (int argc, char* argv[])
     else if (linear_itparam.linear_precond_type == PREC_AMG){
         solver_flag = linear_solver_dcsr_krylov_amg(A, b, x, &linear_itparam, &amgparam);
     }
+    // ILU preconditioner
+    else if (linear_itparam.linear_precond_type == PREC_ILU){
+        solver_flag = linear_solver_dcsr_krylov_ilu(A, b, x, &linear_itparam);
+    }
+    // sparse approximate inverse preconditioner
+    else if ( (linear_itparam.linear_precond_type == PREC_FSAI) ||
+              (linear_itparam.linear_precond_type == PREC_SPAI) ){
+        solver_flag = linear_solver_dcsr_krylov_sai(A, b, x, &linear_itparam);
+    }
     // No preconditoner
     else{
         solver_flag = linear_solver_dcsr_krylov(A, b, x, &linear_itparam);
@@ -119,8 +138,16 @@ int main (int argc, char* argv[])
   }
 
   // Clean up memory
-  free(A);
-  free(b);
+  if(read_bin){
+    dcsr_unmap_bin(A);
+    dvec_unmap_bin(b);
+  } else if(read_to_eof){
+    free(A);
+    free(b);
+  } else {
+    dcsr_free(A);
+    dvec_free(b);
+  }
   free(x);
 }	/* End of Program */
 /*******************************************************************/
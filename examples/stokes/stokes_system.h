@@ -87,10 +87,10 @@ void local_assembly_Stokes(REAL* ALoc, block_fespace *FE, mesh_struct *mesh, qco
 
   // Sum over quadrature points
   for (quad=0;quad<cq->nq_per_elm;quad++) {
-    qx[0] = cq->x[elm*cq->nq_per_elm+quad];
-    qx[1] = cq->y[elm*cq->nq_per_elm+quad];
-    if(mesh->dim==3) qx[2] = cq->z[elm*cq->nq_per_elm+quad];
-    w = cq->w[elm*cq->nq_per_elm+quad];
+    qx[0] = cq->x[quad];
+    qx[1] = cq->y[quad];
+    if(mesh->dim==3) qx[2] = cq->z[quad];
+    w = cq->w[quad];
 
     //  Get the Basis Functions at each quadrature node
     // u = (u1,u2,u3,p) and v = (v1,v2,v3,q)
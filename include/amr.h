@@ -35,6 +35,10 @@ typedef struct /* n-homogenous simplicial complex */
   INT n; /* the dimension of SC */
   INT nv; /* number of 0-dimensional simplices */
   INT ns; /* number of n-dimensional simplices */
+  INT nv_max; /* allocated length (in vertices) of the vertex arrays */
+  INT ns_max; /* allocated length (in simplices) of the simplex
+		 arrays; both grow geometrically during refinement
+		 (see haz_scomplex_reserve) */
   INT level; /* level of refinement */
   INT *marked; /*whether marked or not*/
   INT *gen; /* array to hold the simplex generation during refinement */
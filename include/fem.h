@@ -30,9 +30,16 @@
 #define MARKER_ROBIN  33
 #define MARKER_BOUNDARY_NO  65
 
+/* number of elements whose local matrices are computed together
+   (see assemble_local_batch) */
+#define LOCAL_BATCH 8
+
 /**
  * \struct qcoordinates
  * \brief Returns coordinates of quadrature nodes
+ * \note Holds the nodes of ONE element (face or edge) at a time; they are
+ *       computed on the fly (quad_elm, quad_face, quad_edge) by the routines
+ *       looping over the mesh.
  * \note TODO - will remove this and replace with the structure qcoords below.
  */
 typedef struct qcoordinates{
@@ -58,6 +65,12 @@ typedef struct qcoordinates{
   //! Number of quadrature nodes in one direction
   INT nq1d;
 
+  //! Barycentric coordinates (lam1,...,lam_dim for each node) and weights of
+  //! the rule on the reference element, scaled so that w = vol*ref_w (NULL
+  //! until first used)
+  REAL* ref_x;
+  REAL* ref_w;
+
 } qcoordinates;
 
 // Newer version
@@ -152,6 +165,13 @@ typedef struct fespace{
   REAL* dphi;
   REAL* ddphi;
 
+  //! Basis functions and gradients on the reference element at the nq_ref
+  //! quadrature nodes of the last rule used (Lagrange spaces only, see
+  //! tabulate_FEM_basis_elm)
+  INT nq_ref;
+  REAL* phi_ref;
+  REAL* dphi_ref;
+
 } fespace;
 
 /**
@@ -216,7 +236,7 @@ typedef struct simplex_local_data {
   //! Reference Element maps
   REAL* ref_map; // The map x = B*xr + x0
   REAL* lams; // P1 basis at quad points (actually on ref element)
-  REAL* gradlams; // Inverse map plus row sum which gives gradients of P1 basis
+  REAL* gradlams; // Inverse map plus row sum which gives gradients of P1 basis (constant on simplex)
 
   // Space for extra stuff if needed
   REAL* dwork;
@@ -264,6 +284,14 @@ typedef struct simplex_local_data {
    REAL** dphi;
    REAL** ddphi;
 
+   //! Number of quadrature points the reference basis is tabulated at
+   INT nq;
+
+   //! Basis functions and gradients of each space on the reference element
+   //! at all quadrature points (NULL for spaces that are not tabulated)
+   REAL** phi_ref;
+   REAL** dphi_ref;
+
  } fe_local_data;
 
 /**
@@ -307,6 +335,74 @@ typedef struct block_fespace {
 
 } block_fespace;
 
+/**
+ * \struct assemble_pattern
+ * \brief Element slot map kept between global assemblies on the same FE space
+ *
+ * \note The sparsity structure itself stays in the assembled matrix, so the
+ *       matrix must be kept (and not freed) between calls using the pattern.
+ */
+typedef struct assemble_pattern {
+
+  //! number of elements (or faces) in the slot map
+  INT nent;
+
+  //! size of the local matrix (DOF per element, summed over all spaces)
+  INT ld;
+
+  //! number of nonzeros of the assembled matrix (all blocks)
+  INT nnz;
+
+  //! positions in the val array(s) of the local matrix entries (nent*ld*ld)
+  INT* slot;
+
+  //! color to element map and 1 if the colors can be assembled in parallel
+  //! (see color_elements; only set in OpenMP builds)
+  iCSRmat colors;
+  INT threaded;
+
+} assemble_pattern;
+
+/**
+ * \struct dirichlet_pattern
+ * \brief Dirichlet DOF and the matrix entries they touch, kept between
+ *        eliminations of the boundary conditions on the same CSR matrix
+ *
+ * \note Only the sparsity structure of the matrix is used, so the pattern stays
+ *       valid as long as the matrix is reassembled on the same structure.
+ */
+typedef struct dirichlet_pattern {
+
+  //! number of nonzeros of the matrix the pattern was built for
+  INT nnz;
+
+  //! number of Dirichlet rows
+  INT nbrow;
+
+  //! Dirichlet rows (compact list of boundary DOF)
+  INT* brow;
+
+  //! position in val of the diagonal entry of each Dirichlet row (-1 if none)
+  INT* bdiag;
+
+  //! number of entries of each Dirichlet row (to check the matrix on reuse)
+  INT* brow_nnz;
+
+  //! number of entries in non-Dirichlet rows and Dirichlet columns
+  INT nbcol;
+
+  //! row of each of these entries
+  INT* bcol_row;
+
+  //! position in val of each of these entries
+  INT* bcol_slot;
+
+  //! boundary values of all DOF (only set at Dirichlet DOF) and their number
+  REAL* ub;
+  INT nub;
+
+} dirichlet_pattern;
+
 
 //**************** NEW STUFF **********************************//
 
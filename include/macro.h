@@ -144,11 +144,26 @@
 #define PREC_NULL               0  /**< with no precond */
 #define PREC_DIAG               1  /**< with diagonal precond */
 #define PREC_AMG                2  /**< with AMG precond */
+#define PREC_ILU                3  /**< with ILU precond */
+#define PREC_FSAI               4  /**< with factorized sparse approximate inverse precond */
+#define PREC_SPAI               5  /**< with sparse approximate inverse precond */
 #define PREC_HX_CURL_A          6  /**< with additive HX preconditioner for H(curl) problem */
 #define PREC_HX_CURL_M          7  /**< with multiplicative HX preconditioner for H(curl) problem */
 #define PREC_HX_DIV_A           8  /**< with additive HX preconditioner for H(div) problem */
 #define PREC_HX_DIV_M           9  /**< with multiplicative HX preconditioner for H(div) problem */
 
+/**
+ * \brief Definition of ILU types
+ */
+#define ILUk                    1  /**< ILU(k): level of fill-in k, ILU(0) for k=0 */
+#define ILUt                    2  /**< ILUT: dual threshold ILU */
+
+/**
+ * \brief Definition of sparse approximate inverse types
+ */
+#define FSAI                    1  /**< factorized sparse approximate inverse (SPD) */
+#define SPAI                    2  /**< sparse approximate inverse (Frobenius norm) */
+
 /**
  * \brief Definition of AMG types
  */
@@ -195,6 +210,8 @@
 #define SMOOTHER_FJACOBI       11  /**< Fractional Jacobi smoother */
 #define SMOOTHER_FGS           12  /**< Fractional Gauss-Seidel smoother */
 #define SMOOTHER_FSGS          13  /**< Fractional Symmetric Gauss-Seidel smoother */
+#define SMOOTHER_FSAI          14  /**< Factorized sparse approximate inverse smoother */
+#define SMOOTHER_SPAI          15  /**< Sparse approximate inverse smoother */
 #define SMOOTHER_USERDEF       20  /**< User defined smoother (NB! requires fptr to smoother mxv */
 
 /**
@@ -166,7 +166,176 @@ typedef struct mesh_struct{
   //! extra int working array for random things
   INT* iwork;
 
+  //! start of the memory mapped binary mesh file which el_v->JA, cv->x,
+  //! el_flag and v_flag point into (NULL if they are allocated)
+  void* map;
+
+  //! length in bytes of the mapping
+  size_t map_len;
+
 } mesh_struct;
 
+/* Binary mesh format (see dump_mesh_bin() and read_grid_bin()) */
+#define MESHBIN_MAGIC "HAZMESH"
+#define MESHBIN_VERSION 1
+#define MESHBIN_ALIGN 64
+
+/**
+ * \struct meshbin_header
+ * \brief Header of a binary mesh file.  It is followed by the sections
+ * el_v (nelm*v_per_elm INT), el_flag (nelm INT), coordinates (x of all
+ * vertices, then y, then z: dim*nv REAL) and v_flag (nv INT), each
+ * starting at the given byte offset, which is a multiple of MESHBIN_ALIGN
+ */
+typedef struct meshbin_header{
+
+  //! MESHBIN_MAGIC
+  char magic[8];
+
+  //! format version (MESHBIN_VERSION)
+  INT version;
+
+  //! 1 written as an INT, to detect files with the other byte order
+  INT byte_order;
+
+  //! sizeof(INT) and sizeof(REAL) of the writer
+  INT int_size;
+  INT real_size;
+
+  //! dimension, number of elements, vertices and vertices per element
+  INT dim;
+  INT nelm;
+  INT nv;
+  INT v_per_elm;
+
+  //! number of boundary vertices and of connected regions and boundaries
+  INT nbv;
+  INT nconn_reg;
+  INT nconn_bdry;
+
+  //! unused; keeps the offsets 8 byte aligned
+  INT reserved;
+
+  //! byte offsets of the sections from the start of the file
+  long long off_el_v;
+  long long off_el_flag;
+  long long off_cv;
+  long long off_v_flag;
+
+} meshbin_header;
+
+/* Data formats of VTU files (see set_vtu_format()) */
+#define VTU_ASCII 0
+#define VTU_BINARY 1
+#define VTU_BASE64 2
+#define VTU_BLOCK_SIZE 32768
+
+/**
+ * \struct vtu_file
+ * \brief VTU file being written (see vtu_open()).  Binary data goes
+ * through blocks of VTU_BLOCK_SIZE bytes, which are compressed if
+ * asked, and then either to a temporary file which is appended to
+ * the XML at the end (VTU_BINARY) or base64 encoded in the XML
+ * (VTU_BASE64).
+ */
+typedef struct vtu_file{
+
+  //! XML part of the file
+  FILE* fp;
+
+  //! temporary file with the appended data (VTU_BINARY only)
+  FILE* app;
+
+  //! VTU_ASCII, VTU_BINARY or VTU_BASE64
+  INT format;
+
+  //! 1 if the binary data is compressed (zlib format)
+  INT compress;
+
+  //! number of bytes in app
+  long long app_len;
+
+  //! number of bytes of the array being written
+  long long nbytes;
+
+  //! block of the array being filled, and number of bytes in it
+  unsigned char* block;
+  INT nblock;
+
+  //! compressed blocks of the array being written, their total length,
+  //! the allocated length, the compressed size of every block and the
+  //! number of blocks so far
+  unsigned char* cdata;
+  long long clen;
+  long long ccap;
+  unsigned long long* csize;
+  INT ncblock;
+
+  //! working arrays for compression: output, hash heads and chains
+  unsigned char* cwork;
+  INT* head;
+  INT* prev;
+
+  //! bytes waiting to be base64 encoded
+  unsigned char b64[3];
+  INT nb64;
+
+} vtu_file;
+
+/* Centering of the fields of a time series (see tseries_add_field()) */
+#define TSERIES_POINT 0
+#define TSERIES_CELL 1
+
+/**
+ * \struct tseries_file
+ * \brief Time series written as XDMF (see tseries_open()).  Points and
+ * cells are written once to a binary file; every step writes only its
+ * fields to another binary file and appends a grid to the .xmf file
+ * which references both.
+ * Steps are copied to one of two snapshot buffers and written by a
+ * background thread, so the writing overlaps the next time step.
+ */
+typedef struct tseries_file{
+
+  //! name of the .xmf file and of the binary files without extension
+  char* name;
+  char* base;
+
+  //! number of points, cells, and dimension of the mesh
+  INT nv;
+  INT nelm;
+  INT dim;
+
+  //! number of fields, their names, centering and number of components
+  INT nfield;
+  char** fname;
+  INT* center;
+  INT* ncomp;
+
+  //! number of REALs in one snapshot
+  long long nsnap;
+
+  //! the two snapshot buffers, the time in each and whether it is full
+  REAL* snap[2];
+  REAL tsnap[2];
+  INT full[2];
+
+  //! number of snapshots filled and written
+  INT nfill;
+  INT nwritten;
+
+  //! the .xmf file, kept open, and the offset of its closing tags
+  //! (overwritten by the next step)
+  FILE* xmf;
+  long long xmf_end;
+
+  //! 1 if the steps are written by a background thread
+  INT async;
+
+  //! thread, lock and conditions (see tseries_io.c)
+  void* sync;
+
+} tseries_file;
+
 
 #endif
@@ -125,6 +125,14 @@ typedef struct {
     // HX preconditioner
     SHORT HX_smooth_iter;            /**< number of smoothing */
 
+    // ILU preconditioner
+    SHORT ILU_type;                  /**< type of ILU: ILUk or ILUt */
+    INT   ILU_lfil;                  /**< level of fill-in (ILUk) or max entries per row (ILUt, <=0: no cap) */
+    REAL  ILU_droptol;               /**< relative dropping tolerance (ILUt) */
+
+    // sparse approximate inverse preconditioner
+    INT   SAI_levels;                /**< pattern of FSAI/SPAI is the graph of A^SAI_levels */
+
     // BSR preconditioner
     REAL BSR_alpha;                 /**< weight on diagonal matrix alpha*D approx of A */
     REAL BSR_omega;                 /**< weight on update x = x + omega*Binv*(Ax-b) */
@@ -148,6 +156,14 @@ typedef struct {
     // HX preconditioner
     SHORT HX_smooth_iter;            /**< number of smoothing */
 
+    // ILU preconditioner
+    SHORT ILU_type;                  /**< type of ILU: ILUk or ILUt */
+    INT   ILU_lfil;                  /**< level of fill-in (ILUk) or max entries per row (ILUt, <=0: no cap) */
+    REAL  ILU_droptol;               /**< relative dropping tolerance (ILUt) */
+
+    // sparse approximate inverse preconditioner
+    INT   SAI_levels;                /**< pattern of FSAI/SPAI is the graph of A^SAI_levels */
+
     // scaling parameter used in Argumented Lagrange type block preconditioners
     REAL AL_scaling_param;
 
@@ -243,6 +259,9 @@ typedef struct {
     //! type of Schwarz block solver
     INT Schwarz_blksolver;
 
+    //! pattern of FSAI/SPAI smoothers is the graph of A^SAI_levels
+    INT SAI_levels;
+
     /* Hacking in parameters for gmg smoothers */
     //! HAZMATH install dir
     char* HAZDIR;
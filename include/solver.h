@@ -103,6 +103,36 @@ typedef struct {
 
 /***********************************************************************************************/
 
+/**
+ * \struct SAI_data
+ * \brief Data for the sparse approximate inverse preconditioners/smoothers
+ *
+ * \note FSAI: z = G^T*(G*r), SPAI: z = G*r
+ */
+typedef struct {
+
+    //! size of the matrix
+    INT row;
+
+    //! type of SAI: FSAI or SPAI
+    SHORT type;
+
+    //! lower triangular factor (FSAI) or approximate inverse (SPAI)
+    dCSRmat G;
+
+    //! transpose of G (FSAI only)
+    dCSRmat Gt;
+
+    //! work space (FSAI only)
+    REAL *w;
+
+    //! work space of the smoother: residual and correction (2*row)
+    REAL *work;
+
+} SAI_data;
+
+/***********************************************************************************************/
+
 /**
  * \struct AMG_data
  * \brief Data for AMG solvers
@@ -154,6 +184,9 @@ typedef struct {
     //! data of Schwarz smoother
     Schwarz_data Schwarz;
 
+    //! data of sparse approximate inverse smoother
+    SAI_data SAI;
+
     //! Temporary work space
     dvector w;
 
@@ -430,6 +463,9 @@ typedef struct {
     //! temporary work space for other usage
     REAL *w;
 
+    //! work space of the additive version (2*A->row), allocated at its first call
+    REAL *add_work;
+
 } HX_curl_data;
 
 /***********************************************************************************************/
@@ -522,10 +558,200 @@ typedef struct {
     //! temporary work space for other usage
     REAL *w;
 
+    //! work space of the additive version (3*A->row+3*Curlt->row), allocated at its first call
+    REAL *add_work;
+
 } HX_div_data;
 
 /***********************************************************************************************/
 
+typedef struct {
+
+    /*!
+     * \struct ILU_data
+     * \brief Data for ILU preconditioners (factors and level schedules)
+     */
+
+    //! size of the matrix
+    INT row;
+
+    //! type of ILU
+    SHORT type;
+
+    //! strictly lower triangular factor (unit diagonal is not stored)
+    dCSRmat L;
+
+    //! strictly upper triangular factor
+    dCSRmat U;
+
+    //! inverse of the diagonal of U
+    REAL *invdiag;
+
+    /* ---------------------*/
+    /* level schedules for the triangular solves */
+    /* ---------------------*/
+    //! number of levels of L
+    INT nlevL;
+
+    //! start of each level of L in jlevL (size nlevL+1)
+    INT *ilevL;
+
+    //! rows of L ordered level by level
+    INT *jlevL;
+
+    //! number of levels of U
+    INT nlevU;
+
+    //! start of each level of U in jlevU (size nlevU+1)
+    INT *ilevU;
+
+    //! rows of U ordered level by level
+    INT *jlevU;
+
+} ILU_data;
+
+/***********************************************************************************************/
+
+/**
+ * \struct LU_data
+ * \brief Data for the native supernodal sparse direct solver (Cholesky or LU)
+ *
+ * \note The symbolic part (ordering, elimination tree, supernodes) only depends
+ *       on the sparsity pattern of A and is kept between numeric factorizations.
+ *       Supernode s holds the pivots super[s],...,super[s+1]-1; its front has the
+ *       rows sJA[sIA[s]],...,sJA[sIA[s+1]-1] (the pivots first) and is stored as
+ *       a dense column-major m x k panel in Lx for Cholesky.  For LU the pivots
+ *       which fail the threshold test are delayed to the parent front, so the
+ *       fronts grow: front s has the rows frow[fptr[s]],... and the columns
+ *       fcol[fptr[s]],... (m of each, the npiv[s] pivots first), an m x npiv[s]
+ *       panel at Lx+fLptr[s] and an npiv[s] x (m-npiv[s]) panel at Ux+fUptr[s].
+ */
+typedef struct {
+
+    //! size of the matrix
+    INT row;
+
+    //! number of nonzeros of the matrix the symbolic analysis was done for
+    INT nnz;
+
+    //! 1: Cholesky LL^T, 0: LU with threshold pivoting and delayed pivots
+    SHORT sym;
+
+    /* ---------------------*/
+    /* symbolic analysis */
+    /* ---------------------*/
+    //! fill-reducing ordering: k-th pivot is perm[k] (nested dissection + postorder)
+    INT *perm;
+
+    //! inverse of perm
+    INT *iperm;
+
+    //! number of supernodes
+    INT nsuper;
+
+    //! first pivot of each supernode (size nsuper+1)
+    INT *super;
+
+    //! start of the row structure of each supernode in sJA (size nsuper+1)
+    INT *sIA;
+
+    //! row structure of the supernodes (in the permuted numbering)
+    INT *sJA;
+
+    //! parent of each supernode in the supernodal elimination tree (-1 for roots)
+    INT *sparent;
+
+    //! offset of the panel of each supernode in Lx (size nsuper+1)
+    INT *Lptr;
+
+    //! offset of the panel of each supernode in Ux (size nsuper+1)
+    INT *Uptr;
+
+    //! column pointers of A (CSC view used for assembling the fronts)
+    INT *cIA;
+
+    //! row indices of A (CSC view)
+    INT *cJA;
+
+    //! position in A->val of each entry of the CSC view
+    INT *cmap;
+
+    /* ---------------------*/
+    /* numeric factorization */
+    /* ---------------------*/
+    //! L panels (and U11 for LU)
+    REAL *Lx;
+
+    //! U12 panels (LU only)
+    REAL *Ux;
+
+    //! number of pivots eliminated in each front (LU only, size nsuper)
+    INT *npiv;
+
+    //! start of the rows and columns of each front in frow and fcol (LU only, size nsuper+1)
+    INT *fptr;
+
+    //! rows of the fronts, pivot rows first (LU only)
+    INT *frow;
+
+    //! columns of the fronts, pivot columns first (LU only)
+    INT *fcol;
+
+    //! offset of the panel of each front in Lx (LU only, size nsuper+1)
+    INT *fLptr;
+
+    //! offset of the panel of each front in Ux (LU only, size nsuper+1)
+    INT *fUptr;
+
+    //! values of A, kept for the iterative refinement of the LU solve
+    REAL *Aval;
+
+    //! infinity norm of A
+    REAL anorm;
+
+    //! number of pivots delayed to a parent front (LU only)
+    INT ndelay;
+
+    //! number of perturbed (tiny) pivots
+    INT nperturb;
+
+} LU_data;
+
+/***********************************************************************************************/
+
+/**
+ * \struct direct_data
+ * \brief Handle of a direct solver (UMFPACK, or the native solver) for matrices
+ *        with a fixed sparsity pattern
+ *
+ * \note The symbolic analysis and the transpose index map are computed once by
+ *       direct_data_setup; direct_data_refactorize only redoes the numeric
+ *       factorization when the values of A change.
+ */
+typedef struct {
+
+    //! size of the matrix
+    INT row;
+
+    //! number of nonzeros of the matrix
+    INT nnz;
+
+    //! transpose of A (the CSC layout UMFPACK works on)
+    dCSRmat At;
+
+    //! At.val[k] = A->val[tmap[k]]
+    INT *tmap;
+
+    //! symbolic analysis (UMFPACK only; the native solver keeps it in LU_data)
+    void *Symbolic;
+
+    //! numeric factorization
+    void *Numeric;
+
+} direct_data;
+
+/***********************************************************************************************/
+
 /**
  * \brief Data passed to the preconditioner for block preconditioning for block_dCSRmat format
  *
@@ -626,6 +852,7 @@ typedef struct {
     /*------------------------*/
     dvector *r;     /**< temporary dvector to store and restore the residual */
     REAL *w;        /**< temporary work space for other usage */
+    REAL *zpoles;   /**< contributions of the poles, one slot of size n per pole */
 
 } precond_ra_data; /**< Data for RA preconditioner */
 
@@ -175,4 +175,48 @@ typedef struct block_iCSRmat {
 
 } block_iCSRmat; /**< Matrix of INT type in Block CSR format */
 
+/* Binary dCSRmat and dvector files (see dcsr_write_bin() and dvec_write_bin()) */
+#define SPBIN_MAGIC_CSR "HAZCSR"
+#define SPBIN_MAGIC_VEC "HAZVEC"
+#define SPBIN_VERSION 1
+#define SPBIN_ALIGN 64
+
+/**
+ * \struct spbin_header
+ * \brief Header of a binary dCSRmat or dvector file.  It is followed by
+ * IA (row+1 INT), JA (nnz INT) and val (nnz REAL) of a matrix, or by the
+ * row values (REAL) of a vector, each starting at the given byte offset,
+ * which is a multiple of SPBIN_ALIGN
+ */
+typedef struct spbin_header{
+
+    //! SPBIN_MAGIC_CSR or SPBIN_MAGIC_VEC
+    char magic[8];
+
+    //! format version (SPBIN_VERSION)
+    INT version;
+
+    //! 1 written as an INT, to detect files with the other byte order
+    INT byte_order;
+
+    //! sizeof(INT) and sizeof(REAL) of the writer
+    INT int_size;
+    INT real_size;
+
+    //! number of rows, columns and nonzeros (a vector has col=1, nnz=row)
+    INT row;
+    INT col;
+    INT nnz;
+
+    //! unused; keeps the offsets 8 byte aligned
+    INT reserved;
+
+    //! byte offsets of IA, JA and val from the start of the file (the
+    //! values of a vector are at off_val, and off_IA=off_JA=0)
+    long long off_IA;
+    long long off_JA;
+    long long off_val;
+
+} spbin_header;
+
 #endif
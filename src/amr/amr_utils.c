@@ -219,6 +219,88 @@ void marks(scomplex *sc,dvector *errors)
   if(sl)free(sl);
   return;
 }
+/**********************************************************************/
+/*!
+ * \fn INT mark_elements(ivector *marked,REAL *eta,INT nelm,INT mark_type,REAL theta)
+ *
+ * \brief marks elements for refinement using the values of an error
+ *        estimator (e.g. residual_estimator()).
+ *
+ * \param eta:           the estimator on each element (nelm)
+ * \param nelm:          number of elements (the finest level of sc)
+ * \param mark_type:     as amr_marking_type in the input: 0 marks all
+ *                       elements; 1 (maximum strategy) marks the
+ *                       elements with eta_T >= theta*max(eta); 2
+ *                       (Dorfler or bulk strategy) marks the elements
+ *                       with the largest eta_T whose sum of squares is
+ *                       at least theta*sum(eta_T^2).
+ * \param theta:         parameter in [0,1] of the strategy.
+ *
+ * \return               marked: ivector (nelm) with 1 for the marked
+ *                       elements, to be passed to refine(); the
+ *                       number of marked elements.  With strategies 1
+ *                       and 2 nothing is marked if eta is zero everywhere.
+ *
+ * \note The Dorfler set is found without sorting, by bisection on the
+ *       threshold t with sum_{eta_T>=t} eta_T^2 >= theta*sum(eta_T^2);
+ *       each step is a threaded (OpenMP) sum over the elements. The
+ *       set is minimal up to ties.
+ *
+ */
+INT mark_elements(ivector *marked,REAL *eta,INT nelm,INT mark_type,REAL theta)
+{
+  INT i,it,nmarked=0;
+  REAL etamax=0e0,total=0e0,target,s,tlo,thi,tmid,tmark;
+  marked->row=nelm;
+  marked->val=(INT *)realloc(marked->val,(nelm+1)*sizeof(INT));
+  for(i=0;i<nelm;i++){
+    total+=eta[i]*eta[i];
+    if(eta[i]>etamax) etamax=eta[i];
+  }
+  if((mark_type==1 || mark_type==2) && (theta<0e0 || theta>1e0)){
+    fprintf(stderr,"\n***ERROR in %s ; theta=%g must be in [0,1].\n\n",__FUNCTION__,theta);
+    check_error(ERROR_INPUT_PAR,__FUNCTION__);
+    return 0;
+  }
+  if((mark_type==1 || mark_type==2) && (total<=0e0 || etamax<=0e0)){
+    // the estimator vanishes: nothing to refine
+    for(i=0;i<nelm;i++) marked->val[i]=0;
+    return 0;
+  }
+  if(mark_type==0){
+    tmark=-1e0;// everything
+  } else if(mark_type==1){
+    tmark=theta*etamax;
+  } else if(mark_type==2){
+    target=theta*total;
+    tlo=0e0;
+    thi=etamax;
+    for(it=0;it<128;it++){
+      tmid=0.5*(tlo+thi);
+      if(tmid<=tlo || tmid>=thi) break;
+      s=0e0;
+#ifdef _OPENMP
+#pragma omp parallel for reduction(+:s) if(nelm>1024)
+#endif
+      for(i=0;i<nelm;i++)
+	if(eta[i]>=tmid) s+=eta[i]*eta[i];
+      if(s>=target) tlo=tmid;
+      else thi=tmid;
+    }
+    tmark=tlo;
+  } else {
+    check_error(ERROR_INPUT_PAR,__FUNCTION__);
+    return 0;
+  }
+#ifdef _OPENMP
+#pragma omp parallel for reduction(+:nmarked) if(nelm>1024)
+#endif
+  for(i=0;i<nelm;i++){
+    marked->val[i]=(eta[i]>=tmark);
+    nmarked+=marked->val[i];
+  }
+  return nmarked;
+}
 /******************************************************************************/
 /*!
  * \fn unsigned int reflect2(INT n, INT is, INT it, INT* sv1, INT
@@ -580,6 +662,7 @@ void scfinalize(scomplex *sc,const INT set_bndry_codes)
   sc->childn=realloc(sc->childn,sc->ns*sizeof(INT));
   sc->gen=realloc(sc->gen,sc->ns*sizeof(INT));
   sc->flags=realloc(sc->flags,sc->ns*sizeof(INT));
+  sc->ns_max=sc->ns;
   find_nbr(sc->ns,sc->nv,sc->n,sc->nodes,sc->nbr);
   // this also can be called separately
   // set_bndry_codes should always be set to 1.
@@ -826,6 +826,8 @@ static void scomplex_merge1(const INT nvall,		\
     sc->flags=(INT *)realloc(sc->flags,ns*sizeof(INT));
     sc->x=(REAL *)realloc(sc->x,nv*(sc->n)*sizeof(REAL));
     sc->vols=(REAL *)realloc(sc->vols,ns*sizeof(REAL));
+    sc->ns_max=ns;
+    sc->nv_max=nv;
     //  sc->fval=(REAL *)realloc(sc->fval,nv*sizeof(REAL)); // function values at every vertex; not used in general;
     //
     /* for(i=0;i<sc->bndry_v->row;++i){ */
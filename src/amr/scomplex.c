@@ -7,6 +7,7 @@
  *
  */
 #include "hazmath.h"
+#include <sys/mman.h>
 /**********************************************************************/
 /*!
  * \fn REAL void haz_scomplex_realloc(scomplex *sc)
@@ -49,6 +50,57 @@ void haz_scomplex_realloc(scomplex *sc)
     sc->bndry[i]=0;
     sc->csys[i]=0;
   }
+  sc->ns_max=ns;
+  sc->nv_max=nv;
+  return;
+}
+/**********************************************************************/
+/*!
+ * \fn void haz_scomplex_reserve(scomplex *sc,INT ns_max,INT nv_max)
+ *
+ * \brief Sets the allocated length of the simplex arrays to ns_max
+ *        simplices and of the vertex arrays to nv_max vertices (never
+ *        less than sc->ns and sc->nv). The contents are kept.
+ *
+ * \param sc      simplicial complex
+ * \param ns_max  number of simplices to allocate for
+ * \param nv_max  number of vertices to allocate for
+ *
+ * \return
+ *
+ * \note With ns_max=nv_max=0 this trims the arrays to the actual
+ *       sizes. Refinement reserves once per call and then grows the
+ *       arrays geometrically, so it does not reallocate for every
+ *       new simplex.
+ *
+ */
+void haz_scomplex_reserve(scomplex *sc,INT ns_max,INT nv_max)
+{
+  INT n1=sc->n+1,nnz_pv;
+  if(ns_max<sc->ns) ns_max=sc->ns;
+  if(nv_max<sc->nv) nv_max=sc->nv;
+  if(ns_max<1) ns_max=1;
+  if(nv_max<1) nv_max=1;
+  sc->nbr=realloc(sc->nbr,(ns_max*n1)*sizeof(INT));
+  sc->nodes=realloc(sc->nodes,(ns_max*n1)*sizeof(INT));
+  sc->gen=realloc(sc->gen,ns_max*sizeof(INT));
+  sc->marked=realloc(sc->marked,ns_max*sizeof(INT));
+  sc->flags=realloc(sc->flags,ns_max*sizeof(INT));
+  sc->parent=realloc(sc->parent,ns_max*sizeof(INT));
+  sc->child0=realloc(sc->child0,ns_max*sizeof(INT));
+  sc->childn=realloc(sc->childn,ns_max*sizeof(INT));
+  sc->vols=realloc(sc->vols,ns_max*sizeof(REAL));
+  sc->x=realloc(sc->x,(nv_max*sc->nbig)*sizeof(REAL));
+  sc->bndry=realloc(sc->bndry,nv_max*sizeof(INT));
+  sc->csys=realloc(sc->csys,nv_max*sizeof(INT));
+  if(sc->parent_v){
+    /* every vertex added by bisection has two parents */
+    nnz_pv=sc->parent_v->nnz+2*(nv_max-sc->nv);
+    sc->parent_v->IA=realloc(sc->parent_v->IA,(nv_max+1)*sizeof(INT));
+    sc->parent_v->JA=realloc(sc->parent_v->JA,(nnz_pv+1)*sizeof(INT));
+  }
+  sc->ns_max=ns_max;
+  sc->nv_max=nv_max;
   return;
 }
 /**********************************************************************/
@@ -220,6 +272,8 @@ scomplex *haz_scomplex_init(const INT n,INT ns, INT nv,const INT nbig)
   //////////////////////////////////////
   sc->nv=nv;
   sc->ns=ns;
+  sc->nv_max=nv;
+  sc->ns_max=ns;
   sc->bndry_cc=1; // one connected component on the boundary for now.
   sc->cc=1; // one connected component in the bulk for now.
   // NULL pointers for the rest
@@ -283,6 +337,8 @@ scomplex haz_scomplex_null(const INT n,const INT nbig)
   sc.flags=NULL;
   sc.x=NULL;
   sc.vols=NULL;
+  sc.nv_max=0;
+  sc.ns_max=0;
   sc.bndry_cc=1; // one connected component on the boundary for now.
   sc.cc=1; // one connected component in the bulk for now.
   // NULL pointers for the rest
@@ -339,6 +395,8 @@ void haz_scomplex_init_part(scomplex *sc)
     sc->bndry[i]=0;
     sc->csys[i]=0;
   }
+  sc->ns_max=ns;
+  sc->nv_max=nv;
   return;
 }
 /**********************************************************************/
@@ -420,6 +478,45 @@ scomplex *haz_scomplex_read(FILE *fp,INT print_level)
   return sc;
 }
 /**********************************************************************/
+/*!
+ * \fn scomplex *haz_scomplex_read_bin(FILE *fp,INT print_level)
+ *
+ * \brief Reads a simplicial complex from a binary mesh file (see
+ *        dump_mesh_bin()).
+ *
+ * \param fp           FILE ID of the binary mesh file
+ * \param print_level  print level of the complex
+ *
+ * \return the simplicial complex, with the elements of the file as
+ *         simplices, their flags in sc->flags and the vertex flags in
+ *         sc->bndry.
+ *
+ * \note The file is mapped into memory (map_mesh_bin()) and the arrays
+ *       are copied from the mapping, because refinement reallocates
+ *       them.  The coordinates are stored by vertex in sc->x.
+ *
+ */
+scomplex *haz_scomplex_read_bin(FILE *fp,INT print_level)
+{
+  meshbin_header head;
+  size_t len;
+  char *map=(char *)map_mesh_bin(fp,&head,&len);
+  INT i,j,ns=head.nelm,nv=head.nv,n=head.dim,n1=n+1;
+  scomplex *sc=(scomplex *)haz_scomplex_init(n,ns,nv,n);
+  REAL *x=(REAL *)(map+head.off_cv);
+  memcpy(sc->nodes,map+head.off_el_v,ns*n1*sizeof(INT));
+  memcpy(sc->flags,map+head.off_el_flag,ns*sizeof(INT));
+  memcpy(sc->bndry,map+head.off_v_flag,nv*sizeof(INT));
+  for(j=0;j<n;j++){
+    for(i=0;i<nv;i++){
+      sc->x[i*n+j]=x[j*nv+i];
+    }
+  }
+  munmap(map,len);
+  sc->print_level=print_level;
+  return sc;
+}
+/**********************************************************************/
 /*!
  * \fn void haz_scomplex_print(scomplex *sc, const INT ns0,const char *infor)
  *
@@ -539,164 +636,48 @@ void haz_scomplex_free(scomplex *sc)
   return;
 }
 /**********************************************************************/
-/*!
- * \fn static unsigned int cmp_simplex(INT n, INT sim1, INT sim2, INT
- *			 *sv1, INT *sv2, INT *stos1, INT *stos2)
- *
- * \brief
- *
- * \param
- *
- * \return
- *
- * \note
- *
- */
-static unsigned int cmp_simplex(INT n, INT sim1, INT sim2,	\
-			 INT *sv1, INT *sv2, INT *stos1, INT *stos2)
-{
-  //sim1 and sim2 are pointers to the neighboring lists of two
-  //simplices stos1 and stos2 are pointers to rows in
-  //simplex-to-simplex incidence; sv1 and sv2 are pointers to rows in
-  //simplex-vertex incidence for two neighboring simplices.
-  //
-  //rearrange to meet the structural condition.  compare two sets of
-  //length n. they should overlap at exactly n-1 members.  If they do
-  //not, 0 is returned, otherwise 1. no check if the members of the
-  //sets are distinct (they should be for the purpose of comparing two
-  //simplices.
-  unsigned int fnd;
-  unsigned int nf=0;
-  INT i1,k1=-10,i2,k2=-10;
-  INT i,j;
-  for (i=0;i<n;i++){
-    fnd=0;
-    i1=sv1[i];
-    for (j = 0;j < n;j++){
-      if(i1 == sv2[j]){
-	fnd=1;
-	break;
-      }
-    }
-    if(fnd) {
-      continue;
-    } else {
-      // not found
-      nf++;
-      if(nf > 1) return 0;
-      k1=i;
-    }
-  }
-  // same with sv1 and sv2 swapped.
-  nf=0;
-  for (i=0;i<n;i++){
-    fnd=0;
-    i2=sv2[i];
-    for (j=0;j<n;j++){
-      if(i2 == sv1[j]){
-	fnd=1;
-	break;
-      }
-    }
-    if(fnd) {
-      continue;
-    } else {
-      // not found
-      nf++;
-      if(nf > 1) return 0;
-      k2=i;
-    }
-  }
-  /* NOW put the neightbors at the right places ******* */
-  if(k1<0||k2<0){
-    fprintf(stderr,"\n***ERROR in %s; k1=%d,k2=%d\n\n",__FUNCTION__,k1,k2);
-    exit(65);
-  } else {
-    stos1[k1]=sim2;
-    stos2[k2]=sim1;
-    return 1;
-  }
-}
-/**********************************************************************/
 /*!
  * \fn void find_nbr(INT ns,INT nv,INT n,INT *sv,INT *stos)
  *
- * \brief
+ * \brief Finds the neighbors of all simplices: stos[i*(n+1)+k] is the
+ *        simplex sharing with simplex i the face opposite to its k-th
+ *        vertex (-1 on the boundary).
  *
- * \param
+ * \param ns     Number of simplices
+ * \param nv     Number of vertices
+ * \param n      Dimension of the simplices
+ * \param sv     Simplex to vertex map (ns*(n+1))
  *
- * \return
+ * \return stos  Simplex to simplex map (ns*(n+1))
  *
- * \note
+ * \note The faces are matched through a hash table of their sorted
+ *       vertices (see hash_match_tuples()), in expected O(ns) time.
  *
  */
 void find_nbr(INT ns,INT nv,INT n,INT *sv,INT *stos)
 {
-  // find neighboring list
-  INT* ivs=NULL, *jvs=NULL, *stosi=NULL, *stosk=NULL, *svi=NULL, *svk=NULL;
-  INT i,j,k,jp,jia,jib,iabeg,iaend,ibbeg,ibend,kn1;
-  INT n1 = n+1,nv1=nv+1,nsv=ns*n1;
-  /* allocate */
-  ivs=(INT *) calloc(nv1,sizeof(INT));
-  jvs=(INT *) calloc(nsv,sizeof(INT));
-  /* transpose to get the vertex--simplex incidence */
-  for (i = 0; i < nv1; ++i)
-    ivs[i] = 0;
-  //
-  for (k = 0; k < ns; ++k) {
-    kn1=k*n1;
-    for (i = 0; i < n1; i++) {
-      j = sv[kn1+i] + 2;
-      if (j < nv1) ivs[j]++;
-    }
-  }
-  ivs[0] = 0;
-  ivs[1] = 0;
-  if (nv != 1) {
-    for (i= 2; i < nv1; ++i) {
-      ivs[i] += ivs[i-1];
-    }
-  }
-  for (i = 0; i < ns; ++i) {
-    iabeg = i*n1;
-    iaend = i*n1+n1;
-    for (jp = iabeg; jp < iaend; ++jp) {
-      j = sv[jp]+1;
-      k = ivs[j];
-      jvs[k] = i;
-      ivs[j] = k+1;
-    }
+  INT i,k,l,f,n1 = n+1,nsv=ns*n1;
+  // face l of a simplex is made of all its vertices except the l-th
+  INT *loc=(INT *) calloc(n1*n+1,sizeof(INT));
+  for (l = 0; l < n1; ++l) {
+    k=0;
+    for (i = 0; i < n1; ++i)
+      if(i!=l) loc[l*n+k++] = i;
   }
-  /**/
-  INT *icp=(INT *) calloc(ns,sizeof(INT));
-  for (i = 0; i < ns; ++i) icp[i] = -1;
+  INT *id=(INT *) calloc(nsv+1,sizeof(INT));
+  INT *first=(INT *) calloc(nsv+1,sizeof(INT));
+  simplex_match_entities(ns,n1,sv,n1,n,loc,id,first);
   for (i = 0; i < nsv; ++i) stos[i] = -1;
-  for (i = 0; i < ns; ++i) {
-      iabeg = i*n1;
-      iaend = iabeg + n1;
-      stosi=stos+iabeg; svi=sv+iabeg;
-      for (jia = iabeg; jia < iaend; ++jia) {
-	j = sv[jia]; // vertex number
-	ibbeg = ivs[j];
-	ibend = ivs[j+1];
-	// loop over all simplices with this j as a vertex.
-	for (jib = ibbeg; jib < ibend; ++jib) {
-	  k = jvs[jib];
-	  if(k<=i) continue;
-	  if (icp[k] != i) {
-	    icp[k] = i;
-	    kn1=k*n1;
-	    stosk=stos+kn1; svk=sv+kn1;
-	    if(!cmp_simplex(n1,i,k,svi,svk,stosi,stosk)) continue;
-	  }//if
-	} //for
-      } //for
-    } //for (i...
-    if (icp) free(icp);
-    if (ivs) free(ivs);
-    if (jvs) free(jvs);
-    //  }
-    return;
+  for (i = 0; i < nsv; ++i) {
+    f = first[i];
+    if(f==i) continue;
+    stos[i] = f/n1;
+    stos[f] = i/n1;
+  }
+  free(loc);
+  free(id);
+  free(first);
+  return;
 }
 /**********************************************************************/
 /*!
@@ -723,9 +704,12 @@ INT haz_add_simplex(INT is, scomplex *sc,REAL *xnew,	\
   //  INT *dsti,*srci;
   INT j,j0,jn,nnz_pv;
   REAL *dstr;
+  /* grow the arrays geometrically if they are full */
+  if(nsnew>sc->ns_max || nvnew>sc->nv_max)
+    haz_scomplex_reserve(sc,					\
+			 (nsnew>sc->ns_max)?(2*nsnew):sc->ns_max,	\
+			 (nvnew>sc->nv_max)?(2*nvnew):sc->nv_max);
   /* nodes  AND neighbors */
-  sc->nbr=realloc(sc->nbr,(nsnew*n1)*sizeof(INT));
-  sc->nodes=realloc(sc->nodes,(nsnew*n1)*sizeof(INT));
   for(j=0;j<n1;j++){
     j0=isc0+j;
     jn=iscn+j;
@@ -737,49 +721,37 @@ INT haz_add_simplex(INT is, scomplex *sc,REAL *xnew,	\
   }
   //new vertex (if any!!!)
   if(nvnew != nv) {
-    sc->x=realloc(sc->x,(nvnew*nbig)*sizeof(REAL));
     dstr=(sc->x+nv*nbig); memcpy(dstr,xnew,n*sizeof(REAL));
     if(xnew) free(xnew);
-    sc->bndry=realloc(sc->bndry,(nvnew)*sizeof(INT));
     sc->bndry[nv]=ibnew;
-    sc->csys=realloc(sc->csys,(nvnew)*sizeof(INT));
     sc->csys[nv]=csysnew;
     nnz_pv=sc->parent_v->nnz;
     sc->parent_v->row=nvnew;
     sc->parent_v->col=nv;
-    sc->parent_v->JA=realloc(sc->parent_v->JA,(nnz_pv+2)*sizeof(REAL));
     sc->parent_v->JA[nnz_pv]=pv[0];
     sc->parent_v->JA[nnz_pv+1]=pv[1];
     sc->parent_v->nnz+=2;
-    sc->parent_v->IA=realloc(sc->parent_v->IA,(nvnew+1)*sizeof(REAL));
     sc->parent_v->IA[nvnew]=sc->parent_v->nnz;
     /* fprintf(stdout,"\nnv=%d; nvnew=%d;nnz_pv=%d(pv[0]=%d,pv[1]=%d)",nv,nvnew,sc->parent_v->nnz,pv[0],pv[1]); */
   }
   //generation
-  sc->gen=realloc(sc->gen,(nsnew)*sizeof(INT));
   sc->gen[ks0]=sc->gen[is]+1;
   sc->gen[ksn]=sc->gen[is]+1;
   //marked
-  sc->marked=realloc(sc->marked,(nsnew)*sizeof(INT));
   sc->marked[ks0]=sc->marked[is];
   sc->marked[ksn]=sc->marked[is];
   //flags
-  sc->flags=realloc(sc->flags,(nsnew)*sizeof(INT));
   sc->flags[ks0]=sc->flags[is];
   sc->flags[ksn]=sc->flags[is];
   //parents
-  sc->parent=realloc(sc->parent,(nsnew)*sizeof(INT));
   sc->parent[ks0]=is;
   sc->parent[ksn]=is;
   //child0
-  sc->child0=realloc(sc->child0,(nsnew)*sizeof(INT));
   sc->child0[ks0]=-1;
   sc->child0[ksn]=-1;
   //childn
-  sc->childn=realloc(sc->childn,(nsnew)*sizeof(INT));
   sc->childn[ks0]=-1; sc->childn[ksn]=-1;
-  //volumes
-  sc->vols=realloc(sc->vols,(nsnew)*sizeof(REAL));// we can calculate all volumes at the end, so just allocate here.
+  //volumes are calculated at the end
   //scalars
   sc->ns=nsnew;
   sc->nv=nvnew;
@@ -1023,7 +995,7 @@ void refine(const INT ref_levels, scomplex *sc,ivector *marked)
 {
   if(ref_levels<=0) return;
   /*somethind to be done*/
-  INT j=-1,i,nsold,print_level=0,nsfine=-1;
+  INT j=-1,i,nsold,nmarked,print_level=0,nsfine=-1;
   if(!sc->level){
     /* sc->level this is set to 0 in haz_scomplex_init */
     /* form neighboring list on the coarsest level */
@@ -1037,11 +1009,18 @@ void refine(const INT ref_levels, scomplex *sc,ivector *marked)
     // just refine everything that was not refined:
     for (i=0;i<ref_levels;i++){
       nsold=sc->ns;
+      /* every leaf is bisected once (two new simplices, at most one
+	 new vertex), so reserve for this level at once */
+      nmarked=0;
+      for(j = 0;j < nsold;j++)
+	if((sc->child0[j]<0||sc->childn[j]<0)) nmarked++;
+      haz_scomplex_reserve(sc,nsold+2*nmarked,sc->nv+nmarked);
       for(j = 0;j < nsold;j++)
 	if((sc->child0[j]<0||sc->childn[j]<0))
 	  haz_refine_simplex(sc, j, -1);
       sc->level++;
     }
+    haz_scomplex_reserve(sc,0,0); // trim to the actual size
     for(j=0;j<sc->ns;j++) sc->marked[j]=TRUE; // not sure we need this.
     // we are done here;
     return;
@@ -1070,9 +1049,18 @@ void refine(const INT ref_levels, scomplex *sc,ivector *marked)
    * not yet refined: (marked>0 and child<0)
    */
   nsold=sc->ns;
+  /*
+   * reserve for the marked simplices (the closure may add more; then
+   * the arrays grow geometrically in haz_add_simplex)
+   */
+  nmarked=0;
+  for(j = 0;j < nsold;j++)
+    if(sc->marked[j] && (sc->child0[j]<0||sc->childn[j]<0)) nmarked++;
+  haz_scomplex_reserve(sc,nsold+2*nmarked,sc->nv+nmarked);
   for(j = 0;j < nsold;j++)
     if(sc->marked[j] && (sc->child0[j]<0||sc->childn[j]<0))
       haz_refine_simplex(sc, j, -1);
+  haz_scomplex_reserve(sc,0,0); // trim to the actual size
   /*
    *  compute volumes (the volumes on the coarsest grid should be set in
    * generate_initial_grid, but just in case we are coming here from
@@ -1097,6 +1085,266 @@ void refine(const INT ref_levels, scomplex *sc,ivector *marked)
   return;
 }
 /******************************************************************/
+/*!
+ * \fn INT coarsen(scomplex *sc,ivector *marked,ivector *el_map,ivector *v_map)
+ *
+ * \brief Coarsens a simplicial complex: merges pairs of bisection
+ *        siblings back into their parent and removes the vertices
+ *        which are no longer used. The inverse of refine().
+ *
+ * \param sc: scomplex containing the whole hierarchy of refinements
+ *
+ * \param marked: input ivector with one entry for every simplex on
+ *                the finest level (numbered as in refine()): the
+ *                number of bisection levels by which the simplex may
+ *                be coarsened (0 means keep it).
+ *
+ * \param el_map: output (if not NULL): for every simplex on the old
+ *                finest level, the simplex on the new finest level
+ *                containing it.
+ *
+ * \param v_map: output (if not NULL): for every old vertex its new
+ *               number (-1 if the vertex was removed).
+ *
+ * \return the number of vertices removed.
+ *
+ * \note A vertex added by bisection is removed only if every simplex
+ *       of the finest level containing it is a marked child of a
+ *       simplex bisected at this vertex, and its sibling is on the
+ *       finest level too. Then all these pairs are merged at once,
+ *       so the finest level stays conforming and can be refined
+ *       again. A merged parent gets the smaller mark of its children
+ *       minus one, and this is repeated while vertices are
+ *       removed. The simplices of the initial grid are never removed.
+ *
+ * \note All arrays of sc are compacted in their old order, so the
+ *       initial grid and its vertices keep their numbers. As in
+ *       scfinest(), child0 of every simplex on the finest level is
+ *       set to -(k+1), with k its number in the new finest level
+ *       (i.e. in the mesh given by sc2mesh()).
+ *
+ */
+INT coarsen(scomplex *sc,ivector *marked,ivector *el_map,ivector *v_map)
+{
+  INT n=sc->n,n1=n+1,nbig=sc->nbig,ns=sc->ns,nv=sc->nv;
+  INT i,j,k,s,t,p,v,c0,cn,nleaf,nsnew,nvnew,more,nremoved=0;
+  INT kbeg,kend,nnz;
+  INT *lold=(INT *)calloc(ns,sizeof(INT)); // old finest level number
+  INT *mark=(INT *)calloc(ns,sizeof(INT));
+  INT *dead=(INT *)calloc(ns,sizeof(INT));
+  INT *vok=(INT *)calloc(nv,sizeof(INT));
+  INT *vdead=(INT *)calloc(nv,sizeof(INT));
+  nleaf=0;
+  for(j=0;j<ns;j++){
+    lold[j]=-1;
+    if(sc->child0[j]<0||sc->childn[j]<0){
+      lold[j]=abs(sc->child0[j]+1);
+      if(sc->level && marked && marked->val)
+	mark[j]=marked->val[lold[j]];
+      sc->child0[j]=-1; sc->childn[j]=-1;
+      nleaf++;
+    }
+  }
+  do{
+    more=0;
+    /* vok[v]=1 if every simplex on the finest level containing v
+       allows to remove it; -1 if v is not on the finest level */
+    for(v=0;v<nv;v++) vok[v]=-1;
+    for(j=0;j<ns;j++){
+      if(dead[j] || (sc->child0[j]>=0 && sc->childn[j]>=0)) continue;
+      p=sc->parent[j];
+      for(k=0;k<n1;k++){
+	v=sc->nodes[j*n1+k];
+	if(k==1 && p>=0 && mark[j]>0 &&				\
+	   (sc->child0[sc->child0[p]]<0 || sc->childn[sc->child0[p]]<0) && \
+	   (sc->child0[sc->childn[p]]<0 || sc->childn[sc->childn[p]]<0)){
+	  if(vok[v]<0) vok[v]=1;
+	} else {
+	  vok[v]=0;
+	}
+      }
+    }
+    /* merge the children (parents come before their children, so
+       a merged parent is not visited again in this pass) */
+    for(j=0;j<ns;j++){
+      if(dead[j] || (sc->child0[j]>=0 && sc->childn[j]>=0)) continue;
+      p=sc->parent[j];
+      if(p<0 || sc->child0[p]!=j) continue;
+      v=sc->nodes[j*n1+1];
+      if(vok[v]!=1) continue;
+      c0=sc->child0[p]; cn=sc->childn[p];
+      dead[c0]=1; dead[cn]=1;
+      mark[p]=((mark[c0]<mark[cn])?mark[c0]:mark[cn])-1;
+      sc->child0[p]=-1; sc->childn[p]=-1;
+      if(!vdead[v]){
+	vdead[v]=1;
+	nremoved++;
+      }
+      more=1;
+    }
+  } while(more);
+  /* the neighbor pointing to a removed simplex is now its nearest
+     ancestor which is still there (it contains the same face). */
+  for(s=0;s<ns;s++){
+    if(dead[s]) continue;
+    for(i=0;i<n1;i++){
+      t=sc->nbr[s*n1+i];
+      while(t>=0 && dead[t]) t=sc->parent[t];
+      sc->nbr[s*n1+i]=t;
+    }
+  }
+  /* new numbers: dead[] holds the new simplex numbers (-1 if
+     removed), mark[] the new finest level numbers, vok[] the new
+     vertex numbers */
+  nsnew=0; k=0;
+  for(s=0;s<ns;s++){
+    if(dead[s]) {
+      dead[s]=-1;
+      continue;
+    }
+    dead[s]=nsnew++;
+    if(sc->child0[s]<0||sc->childn[s]<0) mark[s]=k++;
+  }
+  nvnew=0;
+  for(v=0;v<nv;v++)
+    vok[v]=(vdead[v])?-1:(nvnew++);
+  if(el_map){
+    el_map->row=nleaf;
+    el_map->val=(INT *)realloc(el_map->val,(nleaf+1)*sizeof(INT));
+    for(j=0;j<ns;j++){
+      if(lold[j]<0) continue;
+      s=j;
+      while(dead[s]<0) s=sc->parent[s];
+      el_map->val[lold[j]]=mark[s];
+    }
+  }
+  if(v_map){
+    v_map->row=nv;
+    v_map->val=(INT *)realloc(v_map->val,(nv+1)*sizeof(INT));
+    memcpy(v_map->val,vok,nv*sizeof(INT));
+  }
+  /* compact the simplex arrays; new numbers never exceed the old */
+  for(s=0;s<ns;s++){
+    t=dead[s];
+    if(t<0) continue;
+    for(k=0;k<n1;k++){
+      sc->nodes[t*n1+k]=vok[sc->nodes[s*n1+k]];
+      p=sc->nbr[s*n1+k];
+      sc->nbr[t*n1+k]=(p>=0)?dead[p]:p;
+    }
+    sc->gen[t]=sc->gen[s];
+    sc->marked[t]=sc->marked[s];
+    sc->flags[t]=sc->flags[s];
+    sc->vols[t]=sc->vols[s];
+    sc->parent[t]=(sc->parent[s]>=0)?dead[sc->parent[s]]:-1;
+    if(sc->child0[s]<0||sc->childn[s]<0){
+      sc->child0[t]=-(mark[s]+1);
+      sc->childn[t]=-1;
+    } else {
+      sc->child0[t]=dead[sc->child0[s]];
+      sc->childn[t]=dead[sc->childn[s]];
+    }
+  }
+  /* compact the vertex arrays */
+  for(v=0;v<nv;v++){
+    t=vok[v];
+    if(t<0) continue;
+    memmove(sc->x+t*nbig,sc->x+v*nbig,nbig*sizeof(REAL));
+    sc->bndry[t]=sc->bndry[v];
+    sc->csys[t]=sc->csys[v];
+  }
+  if(sc->parent_v){
+    /* the parents of a remaining vertex are never removed */
+    nnz=0;
+    kbeg=sc->parent_v->IA[0];
+    for(v=0;v<nv;v++){
+      kend=sc->parent_v->IA[v+1];
+      if(vok[v]>=0){
+	for(k=kbeg;k<kend;k++){
+	  sc->parent_v->JA[nnz]=vok[sc->parent_v->JA[k]];
+	  if(sc->parent_v->JA[nnz]<0)
+	    check_error(ERROR_DATA_STRUCTURE,__FUNCTION__);
+	  nnz++;
+	}
+	sc->parent_v->IA[vok[v]+1]=nnz;
+      }
+      kbeg=kend;
+    }
+    sc->parent_v->IA[0]=0;
+    sc->parent_v->row=nvnew;
+    sc->parent_v->col=nvnew;
+    sc->parent_v->nnz=nnz;
+  }
+  sc->ns=nsnew;
+  sc->nv=nvnew;
+  haz_scomplex_reserve(sc,0,0); // trim to the actual size
+  /* volumes of the merged simplices */
+  if(nremoved){
+    INT node;
+    void *wrk1=malloc((sc->n+1)*(sc->n*sizeof(REAL) + sizeof(INT)));
+    REAL *xs=calloc((sc->n+1)*sc->n,sizeof(REAL));
+    for(s=0;s<ns;s++){
+      t=dead[s];
+      if(t<0 || lold[s]>=0) continue;
+      if(sc->child0[t]>=0 && sc->childn[t]>=0) continue;
+      for (j = 0;j<n1;++j){
+	node=sc->nodes[t*n1+j];
+	memcpy((xs+j*sc->n),(sc->x+node*nbig),sc->n*sizeof(REAL));
+      }
+      sc->vols[t]=volume_compute(sc->n,sc->factorial,xs,wrk1);
+    }
+    free(wrk1);
+    free(xs);
+  }
+  free(lold);
+  free(mark);
+  free(dead);
+  free(vok);
+  free(vdead);
+  return nremoved;
+}
+/******************************************************************/
+/*!
+ * \fn void coarsen_transfer(ivector *map,REAL *w,REAL *u_old,INT n_new,REAL *u_new)
+ *
+ * \brief Transfers a (piecewise constant or nodal) function to the
+ *        grid obtained by coarsen().
+ *
+ * \param map: el_map or v_map returned by coarsen()
+ * \param w: weights of the old entities (e.g. the old element
+ *           volumes); if NULL all weights are 1.
+ * \param u_old: values on the old entities (map->row)
+ * \param n_new: number of new entities
+ *
+ * \return u_new: weighted averages of the old values mapped to each
+ *                new entity (n_new)
+ *
+ * \note With el_map and the element volumes this is the L2
+ *       projection of a piecewise constant function. With v_map
+ *       every remaining vertex keeps its value, which is the
+ *       interpolation of a piecewise linear function (the removed
+ *       vertices are midpoints of edges of the coarser grid).
+ *
+ */
+void coarsen_transfer(ivector *map,REAL *w,REAL *u_old,INT n_new,REAL *u_new)
+{
+  INT i,k;
+  REAL wi;
+  REAL *wsum=(REAL *)calloc(n_new,sizeof(REAL));
+  memset(u_new,0,n_new*sizeof(REAL));
+  for(i=0;i<map->row;i++){
+    k=map->val[i];
+    if(k<0) continue;
+    wi=(w)?w[i]:1e0;
+    u_new[k]+=wi*u_old[i];
+    wsum[k]+=wi;
+  }
+  for(k=0;k<n_new;k++)
+    if(wsum[k]>0e0) u_new[k]/=wsum[k];
+  free(wsum);
+  return;
+}
+/******************************************************************/
 /*!
  * \fn void sc2mesh(scomplex *sc,mesh_struct *mesh)
  *
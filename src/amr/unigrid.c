@@ -352,6 +352,7 @@ void unirefine(INT *nd,scomplex *sc)
     nsold=sc->ns;
     //    nvold=sc->nv;
     for(j = 0;j < nsold;j++)sc->marked[j]=TRUE;
+    haz_scomplex_reserve(sc,3*nsold,sc->nv+nsold);
     for(j = 0;j < nsold;j++)
       if(sc->marked[j] && (sc->child0[j]<0||sc->childn[j]<0))
 	haz_refine_simplex(sc, j, -1);
@@ -13,6 +13,9 @@
 /*********************************************************************/
 #include "hazmath.h"
 /*********************************************************************/
+// number of simplices whose local matrices are computed together.
+#define P1_BATCH 8
+/*********************************************************************/
 /*!
  * \fn grad_compute(INT dim, REAL factorial, REAL *xs, REAL *grad, 
  *                  REAL *vols,void *wrk);
@@ -153,37 +156,170 @@ REAL *local_mm(const INT dim)
   }
   return mlocal;
 }
-/*******************************************************************************/
+/*************************************************************************/
 /*!
- * \fn static void local_coords(const INT dim,REAL *xs,INT *nodes,REAL *x)
+ * \fn static void local_coords_batch(const INT dim,const INT nb,REAL *xs,INT *nodes,REAL *x)
  *
- * \brief grabs the coordinates of the vertices of a simplex and
- *        stores them in an array xs[(dim+1)*dim].
+ * \brief grabs the coordinates of the vertices of nb consecutive
+ *        simplices and stores them by components across the batch:
+ *        xs[(j*dim+k)*P1_BATCH+e] is the k-th coordinate of vertex j
+ *        of simplex e. If nb<P1_BATCH the remaining lanes are filled
+ *        with the last simplex, so that all lanes hold a valid simplex.
  *
  * \param dim     I: The dimension of the problem.
- * \param xs      O: (dim+1) x dim matrix with coordinates of the
- *                   vertices of the simplex stored by rows.
+ * \param nb      I: Number of simplices in the batch (at most P1_BATCH)
+ * \param xs      O: (dim+1)*dim*P1_BATCH array with the coordinates.
+ * \param nodes   I: element_to_vertex of the first simplex in the batch.
+ * \param x       I: coordinates of the vertices of the mesh
+ *
+ * \return
+ *
+ * \note
+ */
+static void local_coords_batch(const INT dim,const INT nb,REAL *xs,INT *nodes, REAL *x)
+{
+  INT dim1=dim+1,j,k,e,el;
+  for(e=0;e<P1_BATCH;e++){
+    el=MIN(e,nb-1);
+    for(j=0;j<dim1;j++){
+      for(k=0;k<dim;k++){
+	xs[(j*dim+k)*P1_BATCH+e]=x[nodes[el*dim1+j]*dim+k];
+      }
+    }
+  }
+  return;
+}
+/*************************************************************************/
+/*!
+ * \fn static void grad_compute_batch(INT dim,REAL factorial,REAL *xs,REAL *grad,void *wrk)
  *
- * \param nodes I: (dim+1) vector containing the global numbers (as
- *                 vertices of the mesh) of the vertices of the
- *                 simplex. This is just a row of the
- *                 element_to_vertex matrix.
+ * \brief Same as grad_compute, but for a batch of P1_BATCH simplices
+ *        with the coordinates and the gradients stored by components
+ *        across the batch: grad[(i*dim+k)*P1_BATCH+e] is the k-th
+ *        component of the gradient of the i-th barycentric coordinate
+ *        on simplex e. In 2D and 3D the inverse is computed with
+ *        cofactors so that the loops over the batch vectorize; in
+ *        other dimensions grad_compute is called for every simplex.
  *
- * \param x     I: coordinates of the vertices of the mesh
+ * \param dim        I: The dimension of the problem.
+ * \param factorial  I: dim! (dim factorial)
+ * \param xs         I: coordinates of the simplices (from local_coords_batch)
+ * \param grad       O: (dim+1)*dim*P1_BATCH gradients of the barycentric coordinates.
+ * \param wrk        W: working array of dimension
+ *                      (2*(dim+1)*dim + (dim+1)*(dim+1))*sizeof(REAL)
  *
  * \return
  *
  * \note
  */
-static void local_coords(const INT dim,REAL *xs,INT *nodes, REAL *x)
+static void grad_compute_batch(INT dim, REAL factorial, REAL *xs, REAL *grad, void *wrk)
 {
-  // from global coords x and nodes=element-vertex for a particular element
-  // correspondence extract the local coordinates from x in xs.
-  // xs must be allocated earlier and should have space for dim1*dim REAL;
-  INT dim1=dim+1,j,k;
-  for(j=0;j<dim1;j++){
-    k=nodes[j]; // pick a node in the simplex
-    memcpy(&xs[j*dim],&x[k*dim],dim*sizeof(REAL)); // copy coordinates;
+  INT dim1=dim+1,i,k,e;
+  const INT nb=P1_BATCH;
+  REAL a0[P1_BATCH],a1[P1_BATCH],a2[P1_BATCH];
+  REAL b0[P1_BATCH],b1[P1_BATCH],b2[P1_BATCH];
+  REAL c0[P1_BATCH],c1[P1_BATCH],c2[P1_BATCH];
+  REAL d,g0,g1,g2,h0,h1,h2,f0,f1,f2;
+  // The coordinates are read first and the gradients are written in
+  // a separate loop, so the compiler does not have to assume that xs
+  // and grad overlap.
+  if(dim==2){
+    for(e=0;e<nb;e++){
+      // columns of B are x(1)-x(0) and x(2)-x(0)
+      a0[e]=xs[2*nb+e]-xs[e]; a1[e]=xs[3*nb+e]-xs[nb+e];
+      b0[e]=xs[4*nb+e]-xs[e]; b1[e]=xs[5*nb+e]-xs[nb+e];
+    }
+    for(e=0;e<nb;e++){
+      d=1e0/(a0[e]*b1[e]-a1[e]*b0[e]);
+      // rows of B^{-1}
+      g0= b1[e]*d; g1=-b0[e]*d;
+      h0=-a1[e]*d; h1= a0[e]*d;
+      grad[2*nb+e]=g0; grad[3*nb+e]=g1;
+      grad[4*nb+e]=h0; grad[5*nb+e]=h1;
+      grad[e]=-g0-h0; grad[nb+e]=-g1-h1;
+    }
+  } else if(dim==3){
+    for(e=0;e<nb;e++){
+      // columns of B are x(1)-x(0), x(2)-x(0) and x(3)-x(0)
+      a0[e]=xs[3*nb+e]-xs[e]; a1[e]=xs[4*nb+e]-xs[nb+e]; a2[e]=xs[5*nb+e]-xs[2*nb+e];
+      b0[e]=xs[6*nb+e]-xs[e]; b1[e]=xs[7*nb+e]-xs[nb+e]; b2[e]=xs[8*nb+e]-xs[2*nb+e];
+      c0[e]=xs[9*nb+e]-xs[e]; c1[e]=xs[10*nb+e]-xs[nb+e]; c2[e]=xs[11*nb+e]-xs[2*nb+e];
+    }
+    for(e=0;e<nb;e++){
+      // rows of B^{-1} are (b x c, c x a, a x b)/det(B)
+      g0=b1[e]*c2[e]-b2[e]*c1[e];
+      g1=b2[e]*c0[e]-b0[e]*c2[e];
+      g2=b0[e]*c1[e]-b1[e]*c0[e];
+      d=1e0/(a0[e]*g0+a1[e]*g1+a2[e]*g2);
+      g0*=d; g1*=d; g2*=d;
+      h0=(c1[e]*a2[e]-c2[e]*a1[e])*d;
+      h1=(c2[e]*a0[e]-c0[e]*a2[e])*d;
+      h2=(c0[e]*a1[e]-c1[e]*a0[e])*d;
+      f0=(a1[e]*b2[e]-a2[e]*b1[e])*d;
+      f1=(a2[e]*b0[e]-a0[e]*b2[e])*d;
+      f2=(a0[e]*b1[e]-a1[e]*b0[e])*d;
+      grad[3*nb+e]=g0; grad[4*nb+e]=g1; grad[5*nb+e]=g2;
+      grad[6*nb+e]=h0; grad[7*nb+e]=h1; grad[8*nb+e]=h2;
+      grad[9*nb+e]=f0; grad[10*nb+e]=f1; grad[11*nb+e]=f2;
+      grad[e]=-g0-h0-f0; grad[nb+e]=-g1-h1-f1; grad[2*nb+e]=-g2-h2-f2;
+    }
+  } else {
+    // general dimension: one simplex at a time.
+    REAL *xs1=(REAL *)wrk;
+    REAL *grad1=xs1+dim1*dim;
+    void *wrk1=(void *)(grad1+dim1*dim);
+    for(e=0;e<nb;e++){
+      for(i=0;i<dim1*dim;i++) xs1[i]=xs[i*nb+e];
+      grad_compute(dim, factorial, xs1, grad1,wrk1);
+      for(i=0;i<dim1;i++)
+	for(k=0;k<dim;k++)
+	  grad[(i*dim+k)*nb+e]=grad1[i*dim+k];
+    }
+  }
+  return;
+}
+/*************************************************************************/
+/*!
+ * \fn static void local_sm_batch(REAL *slocal,REAL *grad,const INT dim,REAL *vols)
+ *
+ * \brief Computes (grad lambda_i,grad lambda_j) on a batch of
+ *        P1_BATCH simplices. Same as local_sm, with all arrays stored
+ *        by components across the batch so that the innermost loop
+ *        runs over the simplices and vectorizes.
+ *
+ * \param slocal  O: (dim+1)*(dim+1)*P1_BATCH local matrices;
+ *                   slocal[(i*(dim+1)+j)*P1_BATCH+e] is entry (i,j) on simplex e.
+ * \param grad    I: (dim+1)*dim*P1_BATCH gradients of the barycentric coordinates
+ *                   (from grad_compute_batch).
+ * \param dim     I: The dimension of the problem.
+ * \param vols    I: The volumes of the P1_BATCH simplices
+ *
+ * \return
+ *
+ * \note
+ */
+static void local_sm_batch(REAL *slocal,		\
+			   REAL *grad,			\
+			   const INT dim,		\
+			   REAL *vols)
+{
+  INT dim1=dim+1,i,j,k,e;
+  REAL s[P1_BATCH];
+  REAL *gi,*gj;
+  // the local matrices are symmetric, so only i<=j is computed.
+  for(i=0;i<dim1;++i){
+    for(j=i;j<dim1;++j){
+      for(e=0;e<P1_BATCH;e++) s[e]=0e0;
+      for(k=0;k<dim;++k){
+	gi=grad+(i*dim+k)*P1_BATCH;
+	gj=grad+(j*dim+k)*P1_BATCH;
+	for(e=0;e<P1_BATCH;e++) s[e]+=gi[e]*gj[e];
+      }
+      for(e=0;e<P1_BATCH;e++){
+	slocal[(i*dim1+j)*P1_BATCH+e]=s[e]*vols[e];
+	slocal[(j*dim1+i)*P1_BATCH+e]=s[e]*vols[e];
+      }
+    }
   }
   return;
 }
@@ -200,7 +336,8 @@ static void local_coords(const INT dim,REAL *xs,INT *nodes, REAL *x)
  *
  * \return
  *
- * \note
+ * \note The local stiffness matrices are computed P1_BATCH simplices
+ *       at a time (see grad_compute_batch and local_sm_batch).
  */
 INT assemble_p1(scomplex *sc, dCSRmat *A, dCSRmat *M)
 {
@@ -220,14 +357,6 @@ INT assemble_p1(scomplex *sc, dCSRmat *A, dCSRmat *M)
   // local mass matrix: it is a constant matrix times the volume of an element.
   REAL *mlocal=local_mm(dim);
   //  fprintf(stdout,"\nnum_simplices=%d ; num_vertices=%d",ns,nv);fflush(stdout);
-  // to compute the volume and to grab the local coordinates of the vertices in the simplex we need some work space
-  REAL *slocal=calloc(dim1*dim1,sizeof(REAL));// local stiffness matrix.
-  REAL *grad=calloc(dim1*dim,sizeof(REAL));// local matrix with
-					   // gradients from which
-					   // many things can be
-					   // computed.
-  REAL *xs=calloc(dim*dim1,sizeof(REAL));// for the local coordinates of vertices of a simplex;
-  void *wrk=calloc(dim1*dim1,sizeof(REAL));// this is used in every simplex but is allocated only once.
   ////////////////////// ASSEMBLY BEGINS HERE:
   // create a block diagonal mass and stiffness matrices with the local matrices on the diagonal
   dCSRmat *m_dg=malloc(sizeof(dCSRmat));
@@ -244,33 +373,58 @@ INT assemble_p1(scomplex *sc, dCSRmat *A, dCSRmat *M)
   // needs to be freed at the end
   a_dg->val=calloc(a_dg->nnz,sizeof(REAL));
   //
-  nnz=0;
-  m_dg->IA[0]=nnz;  
-  for(i=0;i<ns;++i){
-    idim1=i*dim1;
-    // grab the vertex coordinates and compute the volume of the simplex.
-    local_coords(dim,xs,&sc->nodes[idim1],sc->x);// sc->nodes[idim1:idim1+dim]
-						 // point to global
-						 // vertex numbers in
-						 // element i
-    // compute gradients
-    grad_compute(dim, fact, xs, grad,wrk);
-    //    print_full_mat(dim1,dim,grad,"grad");fflush(stdout);
-    volume=sc->vols[i];
-    //    sc->vols[i]=volume;
-    //    fprintf(stdout,"\nvolume[%d]=%.5e",i,sc->vols[i]);fflush(stdout);
-    // copute local stiffness matrix as grad*transpose(grad);
-    local_sm(slocal,grad,dim,volume);
-    for(j=0;j<dim1;j++){
-      jdim1=j*dim1;
-      for(k=0;k<dim1;k++){
-	m_dg->JA[nnz]=idim1+k;
-	m_dg->val[nnz]=mlocal[jdim1+k]*volume;
-	a_dg->val[nnz]=slocal[jdim1+k];
-	nnz++;
+  // the DG blocks of different simplices do not overlap, so every
+  // simplex writes to its own rows of m_dg and a_dg and the loop can
+  // be run in parallel. The local matrices are computed for batches
+  // of P1_BATCH simplices at a time.
+  INT ib,e,nb,nbatch=(ns+P1_BATCH-1)/P1_BATCH;
+  m_dg->IA[0]=0;
+#ifdef _OPENMP
+#pragma omp parallel private(ib,i,j,k,e,nb,idim1,jdim1,nnz,volume)
+#endif
+  {
+    // to compute the volume and to grab the local coordinates of the vertices in the simplex we need some work space
+    REAL *slocal=calloc(dim1*dim1*P1_BATCH,sizeof(REAL));// local stiffness matrices.
+    REAL *grad=calloc(dim1*dim*P1_BATCH,sizeof(REAL));// local matrices with
+						      // gradients from which
+						      // many things can be
+						      // computed.
+    REAL *xs=calloc(dim*dim1*P1_BATCH,sizeof(REAL));// for the local coordinates of vertices of the simplices;
+    void *wrk=calloc(2*dim1*dim+dim1*dim1,sizeof(REAL));// this is used in every batch but is allocated once per thread.
+    REAL vols[P1_BATCH];
+#ifdef _OPENMP
+#pragma omp for
+#endif
+    for(ib=0;ib<nbatch;++ib){
+      i=ib*P1_BATCH;
+      nb=MIN(P1_BATCH,ns-i);
+      // grab the vertex coordinates of the simplices in the batch.
+      local_coords_batch(dim,nb,xs,&sc->nodes[i*dim1],sc->x);
+      for(e=0;e<P1_BATCH;e++) vols[e]=sc->vols[i+MIN(e,nb-1)];
+      // compute gradients
+      grad_compute_batch(dim, fact, xs, grad,wrk);
+      // copute local stiffness matrices as grad*transpose(grad);
+      local_sm_batch(slocal,grad,dim,vols);
+      for(e=0;e<nb;e++,i++){
+	idim1=i*dim1;
+	volume=sc->vols[i];
+	nnz=idim1*dim1;// the block of simplex i starts here.
+	for(j=0;j<dim1;j++){
+	  jdim1=j*dim1;
+	  for(k=0;k<dim1;k++){
+	    m_dg->JA[nnz]=idim1+k;
+	    m_dg->val[nnz]=mlocal[jdim1+k]*volume;
+	    a_dg->val[nnz]=slocal[(jdim1+k)*P1_BATCH+e];
+	    nnz++;
+	  }
+	  m_dg->IA[idim1+j+1]=nnz;
+	}
       }
-      m_dg->IA[idim1+j+1]=nnz;
     }
+    free(xs);
+    free(slocal);
+    free(grad);
+    free(wrk);
   }
   //
   // create a sparse matrix representing the natural inclusion of
@@ -306,10 +460,6 @@ INT assemble_p1(scomplex *sc, dCSRmat *A, dCSRmat *M)
   if(a_dg->val) free(a_dg->val);  
   if(a_dg) free(a_dg);
   // free all the rest;
-  free(xs);
-  free(slocal);
-  free(grad);
-  free(wrk);
   free(mlocal);
   if(P) {
     dcsr_free(P);free(P);
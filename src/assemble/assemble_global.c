@@ -237,76 +237,232 @@
 *
 */
 void assemble_global(dCSRmat* A,dvector *b,void (*local_assembly)(REAL *,fespace *,mesh_struct *,qcoordinates *,INT *,INT *,INT,void (*)(REAL *,REAL *,REAL,void *),REAL),fespace *FE,mesh_struct *mesh,qcoordinates *cq,void (*rhs)(REAL *,REAL *,REAL,void *),void (*coeff)(REAL *,REAL *,REAL,void *),REAL time)
+{
+  assemble_global_reuse(A,b,local_assembly,FE,mesh,cq,rhs,coeff,time,NULL);
+  return;
+}
+/******************************************************************************************************/
+
+/******************************************************************************************************/
+/*!
+* \fn assemble_global_reuse(dCSRmat* A,dvector *b,void (*local_assembly)(REAL *,fespace *,mesh_struct *,qcoordinates *,INT *,INT *,INT,void (*)(REAL *,REAL *,REAL,void *),REAL),fespace *FE,mesh_struct *mesh,qcoordinates *cq,void (*rhs)(REAL *,REAL *,REAL,void *),void (*coeff)(REAL *,REAL *,REAL,void *),REAL time,assemble_pattern *pat)
+*
+* \brief Same as assemble_global, but keeps the element slot map in pat so that repeated
+*        assembly on the same FE space (Newton or time-stepping loops) skips the
+*        sparsity structure and all allocation and only zeros and refills the values.
+*
+* \note If pat->slot is NULL, A is allocated and its sparsity structure built as in
+*       assemble_global, and the slot map is stored in pat.  Otherwise A and b must come
+*       from an earlier call with the same FE space and pat.  With pat=NULL this is assemble_global
+*       (no slot map is built, the local entries are found by searching the rows).
+*
+* \note For assemble_DuDv_local and assemble_mass_local with scalar Lagrange elements
+*       the local matrices are computed LOCAL_BATCH elements at a time (assemble_local_batch).
+*
+* \param pat            Pattern cache (from initialize_assemble_pattern, freed by free_assemble_pattern)
+*
+* \return A             Global stiffness matrix (values only if pat->slot is set)
+* \return b             Global RHS vector
+*
+*/
+void assemble_global_reuse(dCSRmat* A,dvector *b,void (*local_assembly)(REAL *,fespace *,mesh_struct *,qcoordinates *,INT *,INT *,INT,void (*)(REAL *,REAL *,REAL,void *),REAL),fespace *FE,mesh_struct *mesh,qcoordinates *cq,void (*rhs)(REAL *,REAL *,REAL,void *),void (*coeff)(REAL *,REAL *,REAL,void *),REAL time,assemble_pattern *pat)
 {
 
   INT dof_per_elm = FE->dof_per_elm;
   INT v_per_elm = mesh->v_per_elm;
   INT i,j;
+  INT* elm_slot = NULL;
 
-  // Allocate Row Array
-  A->row = FE->ndof;
-  A->col = FE->ndof;
-  A->IA = (INT *) calloc(FE->ndof+1,sizeof(INT));
-  if(rhs!=NULL) {
-    b->row = FE->ndof;
-    b->val = (REAL *) calloc(b->row,sizeof(REAL));
-  }
-
-  // Get Sparsity Structure First
-  // Non-zeros of A and IA (ignores cancellations, so maybe more than necessary)
-  create_CSR_rows(A,FE);
+  if(pat!=NULL && pat->slot!=NULL) {
+    // Sparsity structure and slot map from an earlier call: only zero the values
+    if(pat->nent!=FE->nelm || pat->ld!=dof_per_elm || pat->nnz!=A->nnz || A->val==NULL) {
+      check_error(ERROR_DATA_STRUCTURE,__FUNCTION__);
+    }
+    elm_slot = pat->slot;
+    array_set(A->nnz,A->val,0.0);
+    if(rhs!=NULL) {
+      b->row = FE->ndof;
+      if(b->val) {
+        dvec_set(b->row,b,0.0);
+      } else {
+        b->val = (REAL *) calloc(b->row,sizeof(REAL));
+      }
+    }
+  } else {
+    // Allocate Row Array
+    A->row = FE->ndof;
+    A->col = FE->ndof;
+    A->IA = (INT *) calloc(FE->ndof+1,sizeof(INT));
+    if(rhs!=NULL) {
+      b->row = FE->ndof;
+      b->val = (REAL *) calloc(b->row,sizeof(REAL));
+    }
 
-  // Columns of A -> JA
-  A->JA = (INT *) calloc(A->nnz,sizeof(INT));
-  create_CSR_cols(A,FE);
+    // Get Sparsity Structure First
+    // Non-zeros of A and IA (ignores cancellations, so maybe more than necessary)
+    create_CSR_rows(A,FE);
+
+    // Columns of A -> JA
+    A->JA = (INT *) calloc(A->nnz,sizeof(INT));
+    create_CSR_cols(A,FE);
+
+    // Positions of the local matrix entries in A->val, only to keep in pat: a
+    // one-shot assembly searches the rows instead, which costs the same as
+    // building the map and needs no nelm*dof_per_elm^2 array
+    if(pat!=NULL) {
+      elm_slot = (INT *) calloc(FE->nelm*dof_per_elm*dof_per_elm,sizeof(INT));
+      iarray_set(FE->nelm*dof_per_elm*dof_per_elm,elm_slot,-1);
+      create_CSR_slots(A,FE->el_dof,FE->el_dof,elm_slot,dof_per_elm,dof_per_elm*dof_per_elm);
+      pat->nent = FE->nelm;
+      pat->ld = dof_per_elm;
+      pat->nnz = A->nnz;
+      pat->slot = elm_slot;
+    }
 
-  // Set values
-  A->val = (REAL *) calloc(A->nnz,sizeof(REAL));
-  for (i=0; i<A->nnz; i++) {
-    A->val[i] = 0;
+    // Set values
+    A->val = (REAL *) calloc(A->nnz,sizeof(REAL));
+    for (i=0; i<A->nnz; i++) {
+      A->val[i] = 0;
+    }
   }
 
   // Now Build Global Matrix entries
 
-  /* Loop over all Elements and build local matrix and rhs */
-  INT local_size = dof_per_elm*dof_per_elm;
-  REAL* ALoc = (REAL *) calloc(local_size,sizeof(REAL));
-  REAL* bLoc=NULL;
-  if(rhs!=NULL)
-  bLoc = (REAL *) calloc(dof_per_elm,sizeof(REAL));
-
-  INT* dof_on_elm = (INT *) calloc(dof_per_elm,sizeof(INT));
-  INT* v_on_elm = (INT *) calloc(v_per_elm,sizeof(INT));
-  for (i=0; i<FE->nelm; i++) {
-    // Zero out local matrices
-    for (j=0; j<local_size; j++) {
-      ALoc[j]=0;
-    }
-    if(rhs!=NULL) {
-      for (j=0; j<dof_per_elm; j++) {
-        bLoc[j]=0;
-      }
+  // Compute the local matrices LOCAL_BATCH elements at a time if the kernel
+  // allows it, otherwise pick a specialized local kernel, if there is one
+  INT batch = local_assembly_batch_kind(local_assembly,FE,mesh->dim);
+  if(!batch) specialize_local_assembly(&local_assembly,FE,mesh->dim);
+
+#ifdef _OPENMP
+  // Color the elements so that the elements of one color share no DOF (once;
+  // the colors are kept in the pattern with the slot map)
+  iCSRmat colors;
+  INT threaded;
+  if(pat!=NULL && pat->colors.IA!=NULL) {
+    colors = pat->colors;
+    threaded = pat->threaded;
+  } else {
+    threaded = color_elements(FE->nelm,1,&FE->el_dof,&colors);
+    if(pat!=NULL) {
+      pat->colors = colors;
+      pat->threaded = threaded;
     }
+  }
 
-    // Find DOF for given Element
-    get_incidence_row(i,FE->el_dof,dof_on_elm);
-
-    // Find vertices for given Element
-    get_incidence_row(i,mesh->el_v,v_on_elm);
-
-    // Compute Local Stiffness Matrix for given Element
-    (*local_assembly)(ALoc,FE,mesh,cq,dof_on_elm,v_on_elm,i,coeff,time);
+#pragma omp parallel private(i,j) if(threaded)
+#endif
+  {
+    // Local data for each thread
+    fespace FEt;
+    copy_fespace_scratch(FE,&FEt,mesh->dim);
+    mesh_struct mesht;
+    copy_mesh_scratch(mesh,&mesht);
+    qcoordinates cqt;
+    copy_qcoords_scratch(cq,&cqt);
+
+    /* Loop over all Elements and build local matrix and rhs */
+    INT local_size = dof_per_elm*dof_per_elm;
+    REAL* ALoc = (REAL *) calloc(batch ? LOCAL_BATCH*local_size : local_size,sizeof(REAL));
+    REAL* bLoc=NULL;
     if(rhs!=NULL)
-    FEM_RHS_Local(bLoc,FE,mesh,cq,dof_on_elm,v_on_elm,i,rhs,time);
+    bLoc = (REAL *) calloc(dof_per_elm,sizeof(REAL));
+
+    INT* dof_on_elm = (INT *) calloc(dof_per_elm,sizeof(INT));
+    INT* v_on_elm = (INT *) calloc(v_per_elm,sizeof(INT));
+
+    if(batch) {
+      INT e,nb,ient,nent;
+      INT* elms;
+#ifdef _OPENMP
+      INT icol;
+      for (icol=0; icol<colors.row; icol++) {
+        nent = colors.IA[icol+1]-colors.IA[icol];
+#pragma omp for
+        for (ient=0; ient<nent; ient+=LOCAL_BATCH) {
+          elms = colors.JA+colors.IA[icol]+ient;
+#else
+      INT elm_batch[LOCAL_BATCH];
+      {
+        nent = FE->nelm;
+        for (ient=0; ient<nent; ient+=LOCAL_BATCH) {
+          for (e=0; e<LOCAL_BATCH; e++) elm_batch[e] = ient+e;
+          elms = elm_batch;
+#endif
+          nb = MIN(LOCAL_BATCH,nent-ient);
+
+          // Local matrices of the batch
+          assemble_local_batch(ALoc,nb,elms,batch,&FEt,&mesht,&cqt,coeff,time);
+
+          for (e=0; e<nb; e++) {
+            i = elms[e];
+            get_incidence_row(i,FE->el_dof,dof_on_elm);
+            if(rhs!=NULL) {
+              for (j=0; j<dof_per_elm; j++) {
+                bLoc[j]=0;
+              }
+              get_incidence_row(i,mesh->el_v,v_on_elm);
+              quad_elm(&cqt,mesh,cq->nq1d,i);
+              FEM_RHS_Local(bLoc,&FEt,&mesht,&cqt,dof_on_elm,v_on_elm,i,rhs,time);
+            }
+
+            // Loop over DOF and place in appropriate slot globally
+            LocaltoGlobal(dof_on_elm,FE,b,A,ALoc+e*local_size,bLoc,elm_slot ? elm_slot+i*local_size : NULL);
+          }
+        }
+      }
+    } else {
+#ifdef _OPENMP
+      INT icol,ient;
+      for (icol=0; icol<colors.row; icol++) {
+#pragma omp for
+        for (ient=colors.IA[icol]; ient<colors.IA[icol+1]; ient++) {
+          i = colors.JA[ient];
+#else
+      {
+        for (i=0; i<FE->nelm; i++) {
+#endif
+          // Zero out local matrices
+          for (j=0; j<local_size; j++) {
+            ALoc[j]=0;
+          }
+          if(rhs!=NULL) {
+            for (j=0; j<dof_per_elm; j++) {
+              bLoc[j]=0;
+            }
+          }
+
+          // Find DOF for given Element
+          get_incidence_row(i,FE->el_dof,dof_on_elm);
+
+          // Find vertices for given Element
+          get_incidence_row(i,mesh->el_v,v_on_elm);
+
+          // Quadrature nodes on the element
+          quad_elm(&cqt,mesh,cq->nq1d,i);
+
+          // Compute Local Stiffness Matrix for given Element
+          (*local_assembly)(ALoc,&FEt,&mesht,&cqt,dof_on_elm,v_on_elm,i,coeff,time);
+          if(rhs!=NULL)
+          FEM_RHS_Local(bLoc,&FEt,&mesht,&cqt,dof_on_elm,v_on_elm,i,rhs,time);
+
+          // Loop over DOF and place in appropriate slot globally
+          LocaltoGlobal(dof_on_elm,FE,b,A,ALoc,bLoc,elm_slot ? elm_slot+i*local_size : NULL);
+        }
+      }
+    }
 
-    // Loop over DOF and place in appropriate slot globally
-    LocaltoGlobal(dof_on_elm,FE,b,A,ALoc,bLoc);
+    if(dof_on_elm) free(dof_on_elm);
+    if(v_on_elm) free(v_on_elm);
+    if(ALoc) free(ALoc);
+    if(bLoc) free(bLoc);
+    free_fespace_scratch(&FEt);
+    free_mesh_scratch(&mesht);
+    free_qcoords(&cqt);
   }
+#ifdef _OPENMP
+  if(pat==NULL) icsr_free(&colors);
+#endif
 
-  if(dof_on_elm) free(dof_on_elm);
-  if(v_on_elm) free(v_on_elm);
-  if(ALoc) free(ALoc);
-  if(bLoc) free(bLoc);
 
   return;
 }
@@ -347,32 +503,89 @@ void assemble_global(dCSRmat* A,dvector *b,void (*local_assembly)(REAL *,fespace
 *
 */
 void assemble_global_withBC(dCSRmat* A,dvector *b,void (*local_assembly)(REAL *,fespace *,mesh_struct *,qcoordinates *,INT *,INT *,INT,void (*)(REAL *,REAL *,REAL,void *),REAL),fespace *FE,mesh_struct *mesh,qcoordinates *cq,void (*rhs)(REAL *,REAL *,REAL,void *),void (*bc)(REAL *,REAL *,REAL,void *),void (*coeff)(REAL *,REAL *,REAL,void *),REAL time)
+{
+  assemble_global_withBC_reuse(A,b,local_assembly,FE,mesh,cq,rhs,bc,coeff,time,NULL);
+  return;
+}
+/******************************************************************************************************/
+
+/******************************************************************************************************/
+/*!
+* \fn assemble_global_withBC_reuse(dCSRmat* A,dvector *b,void (*local_assembly)(REAL *,fespace *,mesh_struct *,qcoordinates *,INT *,INT *,INT,void (*)(REAL *,REAL *,REAL,void *),REAL),fespace *FE,mesh_struct *mesh,qcoordinates *cq,void (*rhs)(REAL *,REAL *,REAL,void *),void (*bc)(REAL *,REAL *,REAL,void *),void (*coeff)(REAL *,REAL *,REAL,void *),REAL time,assemble_pattern *pat)
+*
+* \brief Same as assemble_global_withBC, but keeps the element slot map in pat so that repeated
+*        assembly on the same FE space (Newton or time-stepping loops) skips the
+*        sparsity structure and all allocation and only zeros and refills the values.
+*
+* \note If pat->slot is NULL, A is allocated and its sparsity structure built as in
+*       assemble_global_withBC, and the slot map is stored in pat.  Otherwise A and b must come
+*       from an earlier call with the same FE space and pat.  With pat=NULL this is assemble_global_withBC
+*       (no slot map is built, the local entries are found by searching the rows).
+*
+* \param pat            Pattern cache (from initialize_assemble_pattern, freed by free_assemble_pattern)
+*
+* \return A             Global stiffness matrix (values only if pat->slot is set)
+* \return b             Global RHS vector
+*
+*/
+void assemble_global_withBC_reuse(dCSRmat* A,dvector *b,void (*local_assembly)(REAL *,fespace *,mesh_struct *,qcoordinates *,INT *,INT *,INT,void (*)(REAL *,REAL *,REAL,void *),REAL),fespace *FE,mesh_struct *mesh,qcoordinates *cq,void (*rhs)(REAL *,REAL *,REAL,void *),void (*bc)(REAL *,REAL *,REAL,void *),void (*coeff)(REAL *,REAL *,REAL,void *),REAL time,assemble_pattern *pat)
 {
   INT dof_per_elm = FE->dof_per_elm;
   INT v_per_elm = mesh->v_per_elm;
   INT i,j;
+  INT* elm_slot = NULL;
 
-  // Allocate Row Array
-  A->row = FE->ndof;
-  A->col = FE->ndof;
-  A->IA = (INT *) calloc(FE->ndof+1,sizeof(INT));
-  if(rhs!=NULL) {
-    b->row = FE->ndof;
-    b->val = (REAL *) calloc(b->row,sizeof(REAL));
-  }
-
-  // Get Sparsity Structure First
-  // Non-zeros of A and IA (ignores cancellations, so maybe more than necessary)
-  create_CSR_rows_withBC(A,FE);
+  if(pat!=NULL && pat->slot!=NULL) {
+    // Sparsity structure and slot map from an earlier call: only zero the values
+    if(pat->nent!=FE->nelm || pat->ld!=dof_per_elm || pat->nnz!=A->nnz || A->val==NULL) {
+      check_error(ERROR_DATA_STRUCTURE,__FUNCTION__);
+    }
+    elm_slot = pat->slot;
+    array_set(A->nnz,A->val,0.0);
+    if(rhs!=NULL) {
+      b->row = FE->ndof;
+      if(b->val) {
+        dvec_set(b->row,b,0.0);
+      } else {
+        b->val = (REAL *) calloc(b->row,sizeof(REAL));
+      }
+    }
+  } else {
+    // Allocate Row Array
+    A->row = FE->ndof;
+    A->col = FE->ndof;
+    A->IA = (INT *) calloc(FE->ndof+1,sizeof(INT));
+    if(rhs!=NULL) {
+      b->row = FE->ndof;
+      b->val = (REAL *) calloc(b->row,sizeof(REAL));
+    }
 
-  // Columns of A -> JA
-  A->JA = (INT *) calloc(A->nnz,sizeof(INT));
-  create_CSR_cols_withBC(A,FE);
+    // Get Sparsity Structure First
+    // Non-zeros of A and IA (ignores cancellations, so maybe more than necessary)
+    create_CSR_rows_withBC(A,FE);
+
+    // Columns of A -> JA
+    A->JA = (INT *) calloc(A->nnz,sizeof(INT));
+    create_CSR_cols_withBC(A,FE);
+
+    // Positions of the local matrix entries in A->val, only to keep in pat: a
+    // one-shot assembly searches the rows instead, which costs the same as
+    // building the map and needs no nelm*dof_per_elm^2 array
+    if(pat!=NULL) {
+      elm_slot = (INT *) calloc(FE->nelm*dof_per_elm*dof_per_elm,sizeof(INT));
+      iarray_set(FE->nelm*dof_per_elm*dof_per_elm,elm_slot,-1);
+      create_CSR_slots(A,FE->el_dof,FE->el_dof,elm_slot,dof_per_elm,dof_per_elm*dof_per_elm);
+      pat->nent = FE->nelm;
+      pat->ld = dof_per_elm;
+      pat->nnz = A->nnz;
+      pat->slot = elm_slot;
+    }
 
-  // Set values
-  A->val = (REAL *) calloc(A->nnz,sizeof(REAL));
-  for (i=0; i<A->nnz; i++) {
-    A->val[i] = 0;
+    // Set values
+    A->val = (REAL *) calloc(A->nnz,sizeof(REAL));
+    for (i=0; i<A->nnz; i++) {
+      A->val[i] = 0;
+    }
   }
 
   // Now Build Global Matrix entries
@@ -386,45 +599,96 @@ void assemble_global_withBC(dCSRmat* A,dvector *b,void (*local_assembly)(REAL *,
   }
 
   // Now adjust other rows
-  /* Loop over all Elements and build local matrix and rhs */
-  INT local_size = dof_per_elm*dof_per_elm;
-  REAL* ALoc = (REAL *) calloc(local_size,sizeof(REAL));
-  REAL* bLoc=NULL;
-  if(rhs!=NULL)
-  bLoc = (REAL *) calloc(dof_per_elm,sizeof(REAL));
-
-  INT* dof_on_elm = (INT *) calloc(dof_per_elm,sizeof(INT));
-  INT* v_on_elm = (INT *) calloc(v_per_elm,sizeof(INT));
-  for (i=0; i<FE->nelm; i++) {
-    // Zero out local matrices
-    for (j=0; j<local_size; j++) {
-      ALoc[j]=0;
-    }
-    if(rhs!=NULL) {
-      for (j=0; j<dof_per_elm; j++) {
-        bLoc[j]=0;
-      }
+  // Pick a specialized local kernel for this element type, if there is one
+  specialize_local_assembly(&local_assembly,FE,mesh->dim);
+
+#ifdef _OPENMP
+  // Color the elements so that the elements of one color share no DOF (once;
+  // the colors are kept in the pattern with the slot map)
+  iCSRmat colors;
+  INT threaded;
+  if(pat!=NULL && pat->colors.IA!=NULL) {
+    colors = pat->colors;
+    threaded = pat->threaded;
+  } else {
+    threaded = color_elements(FE->nelm,1,&FE->el_dof,&colors);
+    if(pat!=NULL) {
+      pat->colors = colors;
+      pat->threaded = threaded;
     }
+  }
 
-    // Find DOF for given Element
-    get_incidence_row(i,FE->el_dof,dof_on_elm);
+#pragma omp parallel private(i,j) if(threaded)
+#endif
+  {
+    // Local data for each thread
+    fespace FEt;
+    copy_fespace_scratch(FE,&FEt,mesh->dim);
+    mesh_struct mesht;
+    copy_mesh_scratch(mesh,&mesht);
+    qcoordinates cqt;
+    copy_qcoords_scratch(cq,&cqt);
+
+    /* Loop over all Elements and build local matrix and rhs */
+    INT local_size = dof_per_elm*dof_per_elm;
+    REAL* ALoc = (REAL *) calloc(local_size,sizeof(REAL));
+    REAL* bLoc=NULL;
+    if(rhs!=NULL)
+    bLoc = (REAL *) calloc(dof_per_elm,sizeof(REAL));
+
+    INT* dof_on_elm = (INT *) calloc(dof_per_elm,sizeof(INT));
+    INT* v_on_elm = (INT *) calloc(v_per_elm,sizeof(INT));
+#ifdef _OPENMP
+    INT icol,ient;
+    for (icol=0; icol<colors.row; icol++) {
+#pragma omp for
+      for (ient=colors.IA[icol]; ient<colors.IA[icol+1]; ient++) {
+        i = colors.JA[ient];
+#else
+    {
+      for (i=0; i<FE->nelm; i++) {
+#endif
+        // Zero out local matrices
+        for (j=0; j<local_size; j++) {
+          ALoc[j]=0;
+        }
+        if(rhs!=NULL) {
+          for (j=0; j<dof_per_elm; j++) {
+            bLoc[j]=0;
+          }
+        }
 
-    // Find vertices for given Element
-    get_incidence_row(i,mesh->el_v,v_on_elm);
+        // Find DOF for given Element
+        get_incidence_row(i,FE->el_dof,dof_on_elm);
 
-    // Compute Local Stiffness Matrix for given Element
-    (*local_assembly)(ALoc,FE,mesh,cq,dof_on_elm,v_on_elm,i,coeff,time);
-    if(rhs!=NULL)
-    FEM_RHS_Local(bLoc,FE,mesh,cq,dof_on_elm,v_on_elm,i,rhs,time);
+        // Find vertices for given Element
+        get_incidence_row(i,mesh->el_v,v_on_elm);
+
+        // Quadrature nodes on the element
+        quad_elm(&cqt,mesh,cq->nq1d,i);
+
+        // Compute Local Stiffness Matrix for given Element
+        (*local_assembly)(ALoc,&FEt,&mesht,&cqt,dof_on_elm,v_on_elm,i,coeff,time);
+        if(rhs!=NULL)
+        FEM_RHS_Local(bLoc,&FEt,&mesht,&cqt,dof_on_elm,v_on_elm,i,rhs,time);
 
-    // Loop over DOF and place in appropriate slot globally
-    LocaltoGlobal_withBC(dof_on_elm,FE,b,A,ALoc,bLoc);
+        // Loop over DOF and place in appropriate slot globally
+        LocaltoGlobal_withBC(dof_on_elm,FE,b,A,ALoc,bLoc,elm_slot ? elm_slot+i*local_size : NULL);
+      }
+    }
+
+    if(dof_on_elm) free(dof_on_elm);
+    if(v_on_elm) free(v_on_elm);
+    if(ALoc) free(ALoc);
+    if(bLoc) free(bLoc);
+    free_fespace_scratch(&FEt);
+    free_mesh_scratch(&mesht);
+    free_qcoords(&cqt);
   }
+#ifdef _OPENMP
+  if(pat==NULL) icsr_free(&colors);
+#endif
 
-  if(dof_on_elm) free(dof_on_elm);
-  if(v_on_elm) free(v_on_elm);
-  if(ALoc) free(ALoc);
-  if(bLoc) free(bLoc);
 
   return;
 }
@@ -489,6 +753,11 @@ void assemble_global_FE1FE2(dCSRmat* A,dvector *b,void (*local_assembly)(REAL *,
   A->JA = (INT *) calloc(A->nnz,sizeof(INT));
   create_CSR_cols_FE1FE2(A,FE1,FE2);
 
+  // Positions of the local matrix entries in A->val
+  INT* elm_slot = (INT *) calloc(FE1->nelm*dof_per_elm2*dof_per_elm1,sizeof(INT));
+  iarray_set(FE1->nelm*dof_per_elm2*dof_per_elm1,elm_slot,-1);
+  create_CSR_slots(A,FE1->el_dof,FE2->el_dof,elm_slot,dof_per_elm1,dof_per_elm2*dof_per_elm1);
+
   // Set values
   A->val = (REAL *) calloc(A->nnz,sizeof(REAL));
   for (i=0; i<A->nnz; i++) {
@@ -497,51 +766,90 @@ void assemble_global_FE1FE2(dCSRmat* A,dvector *b,void (*local_assembly)(REAL *,
 
   // Now Build Global Matrix entries
 
-  /* Loop over all Elements and build local matrix and rhs */
-  INT local_size = dof_per_elm2*dof_per_elm1;
-  REAL* ALoc = (REAL *) calloc(local_size,sizeof(REAL));
-  REAL* bLoc=NULL;
-  if(rhs!=NULL)
-  bLoc = (REAL *) calloc(dof_per_elm2,sizeof(REAL));
-
-  INT* dof_on_elm1 = (INT *) calloc(dof_per_elm1,sizeof(INT));
-  INT* dof_on_elm2 = (INT *) calloc(dof_per_elm2,sizeof(INT));
-  INT* v_on_elm = (INT *) calloc(v_per_elm,sizeof(INT));
-  // Loop over elements
-  for (i=0; i<FE1->nelm; i++) {
-    // Zero out local matrices
-    for (j=0; j<local_size; j++) {
-      ALoc[j]=0;
-    }
-    if(rhs!=NULL) {
-      for (j=0; j<dof_per_elm2; j++) {
-        bLoc[j]=0;
-      }
-    }
+#ifdef _OPENMP
+  // Color the elements so that the elements of one color share no DOF of the test space
+  iCSRmat colors;
+  INT threaded = color_elements(FE2->nelm,1,&FE2->el_dof,&colors);
+
+#pragma omp parallel private(i,j) if(threaded)
+#endif
+  {
+    // Local data for each thread
+    fespace FE1t,FE2t;
+    copy_fespace_scratch(FE1,&FE1t,mesh->dim);
+    copy_fespace_scratch(FE2,&FE2t,mesh->dim);
+    mesh_struct mesht;
+    copy_mesh_scratch(mesh,&mesht);
+    qcoordinates cqt;
+    copy_qcoords_scratch(cq,&cqt);
+
+    /* Loop over all Elements and build local matrix and rhs */
+    INT local_size = dof_per_elm2*dof_per_elm1;
+    REAL* ALoc = (REAL *) calloc(local_size,sizeof(REAL));
+    REAL* bLoc=NULL;
+    if(rhs!=NULL)
+    bLoc = (REAL *) calloc(dof_per_elm2,sizeof(REAL));
+
+    INT* dof_on_elm1 = (INT *) calloc(dof_per_elm1,sizeof(INT));
+    INT* dof_on_elm2 = (INT *) calloc(dof_per_elm2,sizeof(INT));
+    INT* v_on_elm = (INT *) calloc(v_per_elm,sizeof(INT));
+#ifdef _OPENMP
+    INT icol,ient;
+    for (icol=0; icol<colors.row; icol++) {
+#pragma omp for
+      for (ient=colors.IA[icol]; ient<colors.IA[icol+1]; ient++) {
+        i = colors.JA[ient];
+#else
+    {
+      for (i=0; i<FE2->nelm; i++) {
+#endif
+        // Zero out local matrices
+        for (j=0; j<local_size; j++) {
+          ALoc[j]=0;
+        }
+        if(rhs!=NULL) {
+          for (j=0; j<dof_per_elm2; j++) {
+            bLoc[j]=0;
+          }
+        }
 
-    // Find DOF of FE 1 for given Element
-    get_incidence_row(i,FE1->el_dof,dof_on_elm1);
+        // Find DOF of FE 1 for given Element
+        get_incidence_row(i,FE1->el_dof,dof_on_elm1);
 
-    // Find DOF of FE 2 for given Element
-    get_incidence_row(i,FE2->el_dof,dof_on_elm2);
+        // Find DOF of FE 2 for given Element
+        get_incidence_row(i,FE2->el_dof,dof_on_elm2);
 
-    // Find vertices for given Element
-    get_incidence_row(i,mesh->el_v,v_on_elm);
+        // Find vertices for given Element
+        get_incidence_row(i,mesh->el_v,v_on_elm);
 
-    // Compute Local Stiffness Matrix for given Element
-    (*local_assembly)(ALoc,FE1,FE2,mesh,cq,dof_on_elm1,dof_on_elm2,v_on_elm,i,coeff,time);
-    if(rhs!=NULL)
-    FEM_RHS_Local(bLoc,FE2,mesh,cq,dof_on_elm2,v_on_elm,i,rhs,time);
+        // Quadrature nodes on the element
+        quad_elm(&cqt,mesh,cq->nq1d,i);
+
+        // Compute Local Stiffness Matrix for given Element
+        (*local_assembly)(ALoc,&FE1t,&FE2t,&mesht,&cqt,dof_on_elm1,dof_on_elm2,v_on_elm,i,coeff,time);
+        if(rhs!=NULL)
+        FEM_RHS_Local(bLoc,&FE2t,&mesht,&cqt,dof_on_elm2,v_on_elm,i,rhs,time);
+
+        // Loop over DOF and place in appropriate slot globally
+        LocaltoGlobal_FE1FE2(dof_on_elm1,FE1,dof_on_elm2,FE2,b,A,ALoc,bLoc,elm_slot+i*local_size);
+      }
+    }
 
-    // Loop over DOF and place in appropriate slot globally
-    LocaltoGlobal_FE1FE2(dof_on_elm1,FE1,dof_on_elm2,FE2,b,A,ALoc,bLoc);
+    if(dof_on_elm1) free(dof_on_elm1);
+    if(dof_on_elm2) free(dof_on_elm2);
+    if(v_on_elm) free(v_on_elm);
+    if(ALoc) free(ALoc);
+    if(bLoc) free(bLoc);
+    free_fespace_scratch(&FE1t);
+    free_fespace_scratch(&FE2t);
+    free_mesh_scratch(&mesht);
+    free_qcoords(&cqt);
   }
+#ifdef _OPENMP
+  icsr_free(&colors);
+#endif
 
-  if(dof_on_elm1) free(dof_on_elm1);
-  if(dof_on_elm2) free(dof_on_elm2);
-  if(v_on_elm) free(v_on_elm);
-  if(ALoc) free(ALoc);
-  if(bLoc) free(bLoc);
+  if(elm_slot) free(elm_slot);
 
   return;
 }
@@ -580,6 +888,32 @@ void assemble_global_FE1FE2(dCSRmat* A,dvector *b,void (*local_assembly)(REAL *,
 *
 */
 void assemble_global_block(block_dCSRmat* A,dvector *b,void (*local_assembly)(REAL *,block_fespace *,mesh_struct *,qcoordinates *,INT *,INT *,INT,REAL),void (*local_rhs_assembly)(REAL *,block_fespace *,mesh_struct *,qcoordinates *,INT *,INT *,INT,void (*)(REAL *,REAL *,REAL,void *),REAL),block_fespace *FE,mesh_struct *mesh,qcoordinates *cq,void (*rhs)(REAL *,REAL *,REAL,void *),REAL time)
+{
+  assemble_global_block_reuse(A,b,local_assembly,local_rhs_assembly,FE,mesh,cq,rhs,time,NULL);
+  return;
+}
+/******************************************************************************************************/
+
+/******************************************************************************************************/
+/*!
+* \fn assemble_global_block_reuse(block_dCSRmat* A,dvector *b,void (*local_assembly)(REAL *,block_fespace *,mesh_struct *,qcoordinates *,INT *,INT *,INT,REAL),void (*local_rhs_assembly)(REAL *,block_fespace *,mesh_struct *,qcoordinates *,INT *,INT *,INT,void (*)(REAL *,REAL *,REAL,void *),REAL),block_fespace *FE,mesh_struct *mesh,qcoordinates *cq,void (*rhs)(REAL *,REAL *,REAL,void *),REAL time,assemble_pattern *pat)
+*
+* \brief Same as assemble_global_block, but keeps the element slot map in pat so that repeated
+*        assembly on the same FE space (Newton or time-stepping loops) skips the
+*        sparsity structure and all allocation and only zeros and refills the values.
+*
+* \note If pat->slot is NULL, A is allocated and its sparsity structure built as in
+*       assemble_global_block, and the slot map is stored in pat.  Otherwise A and b must come
+*       from an earlier call with the same FE space and pat.  With pat=NULL this is assemble_global_block
+*       (no slot map is built, the local entries are found by searching the rows).
+*
+* \param pat            Pattern cache (from initialize_assemble_pattern, freed by free_assemble_pattern)
+*
+* \return A             Global stiffness matrix (values only if pat->slot is set)
+* \return b             Global RHS vector
+*
+*/
+void assemble_global_block_reuse(block_dCSRmat* A,dvector *b,void (*local_assembly)(REAL *,block_fespace *,mesh_struct *,qcoordinates *,INT *,INT *,INT,REAL),void (*local_rhs_assembly)(REAL *,block_fespace *,mesh_struct *,qcoordinates *,INT *,INT *,INT,void (*)(REAL *,REAL *,REAL,void *),REAL),block_fespace *FE,mesh_struct *mesh,qcoordinates *cq,void (*rhs)(REAL *,REAL *,REAL,void *),REAL time,assemble_pattern *pat)
 {
   INT dof_per_elm = 0;
   INT v_per_elm = mesh->v_per_elm;
@@ -596,10 +930,14 @@ void assemble_global_block(block_dCSRmat* A,dvector *b,void (*local_assembly)(RE
     printf("You have %d FEM spaces, but only %dx%d blocks.  They must be consistent.\n\n",FE->nspaces,A->brow,A->bcol);
     exit(0);
   }
+  INT reuse = (pat!=NULL && pat->slot!=NULL);
   if(rhs!=NULL) {
     b->row = FE->ndof;
-    b->val = (REAL *) calloc(b->row,sizeof(REAL));
-    dvec_set(b->row,b,0.0);
+    if(reuse && b->val) {
+      dvec_set(b->row,b,0.0);
+    } else {
+      b->val = (REAL *) calloc(b->row,sizeof(REAL));
+    }
   }
 
   // Loop over each block and build sparsity structure of matrices
@@ -607,7 +945,10 @@ void assemble_global_block(block_dCSRmat* A,dvector *b,void (*local_assembly)(RE
     for(j=0;j<nblocks;j++) {
       testdof = FE->var_spaces[i]->ndof;
       trialdof = FE->var_spaces[j]->ndof;
-      if(A->blocks[i*nblocks+j]) {
+      if(A->blocks[i*nblocks+j] && reuse) {
+        // Sparsity structure from an earlier call: only zero the values
+        array_set(A->blocks[i*nblocks+j]->nnz,A->blocks[i*nblocks+j]->val,0.0);
+      } else if(A->blocks[i*nblocks+j]) {
         A->blocks[i*nblocks+j]->row = testdof; // test functions
         A->blocks[i*nblocks+j]->col = trialdof; // trial functions
         A->blocks[i*nblocks+j]->IA = (INT *) calloc(testdof+1,sizeof(INT));
@@ -630,59 +971,127 @@ void assemble_global_block(block_dCSRmat* A,dvector *b,void (*local_assembly)(RE
     dof_per_elm += FE->var_spaces[i]->dof_per_elm;
   }
 
+  // Positions of the local matrix entries in the blocks of A
+  INT nnz = 0;
+  for(i=0;i<nblocks*nblocks;i++) {
+    if(A->blocks[i]) nnz += A->blocks[i]->nnz;
+  }
+  INT* elm_slot = NULL;
+  if(reuse) {
+    if(pat->nent!=mesh->nelm || pat->ld!=dof_per_elm || pat->nnz!=nnz) {
+      check_error(ERROR_DATA_STRUCTURE,__FUNCTION__);
+    }
+    elm_slot = pat->slot;
+  } else if(pat!=NULL) {
+    // Slot map kept in pat (a one-shot assembly searches the rows instead)
+    elm_slot = (INT *) calloc(mesh->nelm*dof_per_elm*dof_per_elm,sizeof(INT));
+    block_create_CSR_slots(A,FE,0,elm_slot);
+    pat->nent = mesh->nelm;
+    pat->ld = dof_per_elm;
+    pat->nnz = nnz;
+    pat->slot = elm_slot;
+  }
+
   // Now Build Global Matrix entries
 
-  /* Loop over all Elements and build local matrix and rhs */
-  INT local_size = dof_per_elm*dof_per_elm;
-  REAL* ALoc = (REAL *) calloc(local_size,sizeof(REAL));
-  REAL* bLoc=NULL;
-  if(rhs!=NULL)
-  bLoc = (REAL *) calloc(dof_per_elm,sizeof(REAL));
-
-  INT* dof_on_elm = (INT *) calloc(dof_per_elm,sizeof(INT));
-  INT* v_on_elm = (INT *) calloc(v_per_elm,sizeof(INT));
-  INT rowa,rowb,jcntr;
-  // Loop over elements
-  for (i=0; i<mesh->nelm; i++) {
-    // Zero out local matrices
-    for (j=0; j<local_size; j++) {
-      ALoc[j]=0;
-    }
-    if(rhs!=NULL) {
-      for (j=0; j<dof_per_elm; j++) {
-        bLoc[j]=0;
-      }
+#ifdef _OPENMP
+  // Color the elements so that the elements of one color share no DOF (once;
+  // the colors are kept in the pattern with the slot map)
+  iCSRmat colors;
+  INT threaded;
+  if(pat!=NULL && pat->colors.IA!=NULL) {
+    colors = pat->colors;
+    threaded = pat->threaded;
+  } else {
+    threaded = block_color_elements(FE,0,&colors);
+    if(pat!=NULL) {
+      pat->colors = colors;
+      pat->threaded = threaded;
     }
+  }
 
-    // Find DOF for given Element
-    // Note this is "local" ordering for the given FE space of the block
-    // Not global ordering of all DOF
-    jcntr = 0;
-    for(k=0;k<nblocks;k++) {
-      rowa = FE->var_spaces[k]->el_dof->IA[i];
-      rowb = FE->var_spaces[k]->el_dof->IA[i+1];
-      for (j=rowa; j<rowb; j++) {
-        dof_on_elm[jcntr] = FE->var_spaces[k]->el_dof->JA[j];
-        jcntr++;
-      }
-    }
+#pragma omp parallel private(i,j,k) if(threaded)
+#endif
+  {
+    // Local data for each thread
+    block_fespace FEt;
+    copy_blockfespace_scratch(FE,&FEt,mesh->dim);
+    mesh_struct mesht;
+    copy_mesh_scratch(mesh,&mesht);
+    qcoordinates cqt;
+    copy_qcoords_scratch(cq,&cqt);
+
+    /* Loop over all Elements and build local matrix and rhs */
+    INT local_size = dof_per_elm*dof_per_elm;
+    REAL* ALoc = (REAL *) calloc(local_size,sizeof(REAL));
+    REAL* bLoc=NULL;
+    if(rhs!=NULL)
+    bLoc = (REAL *) calloc(dof_per_elm,sizeof(REAL));
+
+    INT* dof_on_elm = (INT *) calloc(dof_per_elm,sizeof(INT));
+    INT* v_on_elm = (INT *) calloc(v_per_elm,sizeof(INT));
+    INT rowa,rowb,jcntr;
+#ifdef _OPENMP
+    INT icol,ient;
+    for (icol=0; icol<colors.row; icol++) {
+#pragma omp for
+      for (ient=colors.IA[icol]; ient<colors.IA[icol+1]; ient++) {
+        i = colors.JA[ient];
+#else
+    {
+      for (i=0; i<mesh->nelm; i++) {
+#endif
+        // Zero out local matrices
+        for (j=0; j<local_size; j++) {
+          ALoc[j]=0;
+        }
+        if(rhs!=NULL) {
+          for (j=0; j<dof_per_elm; j++) {
+            bLoc[j]=0;
+          }
+        }
 
-    // Find vertices for given Element
-    get_incidence_row(i,mesh->el_v,v_on_elm);
+        // Find DOF for given Element
+        // Note this is "local" ordering for the given FE space of the block
+        // Not global ordering of all DOF
+        jcntr = 0;
+        for(k=0;k<nblocks;k++) {
+          rowa = FE->var_spaces[k]->el_dof->IA[i];
+          rowb = FE->var_spaces[k]->el_dof->IA[i+1];
+          for (j=rowa; j<rowb; j++) {
+            dof_on_elm[jcntr] = FE->var_spaces[k]->el_dof->JA[j];
+            jcntr++;
+          }
+        }
 
-    // Compute Local Stiffness Matrix for given Element
-    (*local_assembly)(ALoc,FE,mesh,cq,dof_on_elm,v_on_elm,i,time);
-    if(rhs!=NULL)
-    (*local_rhs_assembly)(bLoc,FE,mesh,cq,dof_on_elm,v_on_elm,i,rhs,time);
+        // Find vertices for given Element
+        get_incidence_row(i,mesh->el_v,v_on_elm);
 
-    // Loop over DOF and place in appropriate slot globally
-    block_LocaltoGlobal(dof_on_elm,FE,b,A,ALoc,bLoc);
+        // Quadrature nodes on the element
+        quad_elm(&cqt,mesh,cq->nq1d,i);
+
+        // Compute Local Stiffness Matrix for given Element
+        (*local_assembly)(ALoc,&FEt,&mesht,&cqt,dof_on_elm,v_on_elm,i,time);
+        if(rhs!=NULL)
+        (*local_rhs_assembly)(bLoc,&FEt,&mesht,&cqt,dof_on_elm,v_on_elm,i,rhs,time);
+
+        // Loop over DOF and place in appropriate slot globally
+        block_LocaltoGlobal(dof_on_elm,FE,b,A,ALoc,bLoc,elm_slot ? elm_slot+i*local_size : NULL);
+      }
+    }
+
+    if(dof_on_elm) free(dof_on_elm);
+    if(v_on_elm) free(v_on_elm);
+    if(ALoc) free(ALoc);
+    if(bLoc) free(bLoc);
+    free_blockfespace_scratch(&FEt);
+    free_mesh_scratch(&mesht);
+    free_qcoords(&cqt);
   }
+#ifdef _OPENMP
+  if(pat==NULL) icsr_free(&colors);
+#endif
 
-  if(dof_on_elm) free(dof_on_elm);
-  if(v_on_elm) free(v_on_elm);
-  if(ALoc) free(ALoc);
-  if(bLoc) free(bLoc);
 
   return;
 }
@@ -725,6 +1134,32 @@ void assemble_global_block(block_dCSRmat* A,dvector *b,void (*local_assembly)(RE
 *
 */
 void assemble_global_Jacobian(block_dCSRmat* A,dvector *b,dvector *old_sol,void (*local_assembly)(REAL *,REAL *,dvector *,block_fespace *,mesh_struct *,qcoordinates *,INT *,INT *,INT,void (*)(REAL *,REAL *,REAL,void *),REAL),block_fespace *FE,mesh_struct *mesh,qcoordinates *cq,void (*rhs)(REAL *,REAL *,REAL,void *),REAL time)
+{
+  assemble_global_Jacobian_reuse(A,b,old_sol,local_assembly,FE,mesh,cq,rhs,time,NULL);
+  return;
+}
+/******************************************************************************************************/
+
+/******************************************************************************************************/
+/*!
+* \fn assemble_global_Jacobian_reuse(block_dCSRmat* A,dvector *b,dvector *old_sol,void (*local_assembly)(REAL *,REAL *,dvector *,block_fespace *,mesh_struct *,qcoordinates *,INT *,INT *,INT,void (*)(REAL *,REAL *,REAL,void *),REAL),block_fespace *FE,mesh_struct *mesh,qcoordinates *cq,void (*rhs)(REAL *,REAL *,REAL,void *),REAL time,assemble_pattern *pat)
+*
+* \brief Same as assemble_global_Jacobian, but keeps the element slot map in pat so that repeated
+*        assembly on the same FE space (Newton or time-stepping loops) skips the
+*        sparsity structure and all allocation and only zeros and refills the values.
+*
+* \note If pat->slot is NULL, A is allocated and its sparsity structure built as in
+*       assemble_global_Jacobian, and the slot map is stored in pat.  Otherwise A and b must come
+*       from an earlier call with the same FE space and pat.  With pat=NULL this is assemble_global_Jacobian
+*       (no slot map is built, the local entries are found by searching the rows).
+*
+* \param pat            Pattern cache (from initialize_assemble_pattern, freed by free_assemble_pattern)
+*
+* \return A             Global stiffness matrix (values only if pat->slot is set)
+* \return b             Global RHS vector
+*
+*/
+void assemble_global_Jacobian_reuse(block_dCSRmat* A,dvector *b,dvector *old_sol,void (*local_assembly)(REAL *,REAL *,dvector *,block_fespace *,mesh_struct *,qcoordinates *,INT *,INT *,INT,void (*)(REAL *,REAL *,REAL,void *),REAL),block_fespace *FE,mesh_struct *mesh,qcoordinates *cq,void (*rhs)(REAL *,REAL *,REAL,void *),REAL time,assemble_pattern *pat)
 {
   INT dof_per_elm = 0;
   INT v_per_elm = mesh->v_per_elm;
@@ -742,6 +1177,7 @@ void assemble_global_Jacobian(block_dCSRmat* A,dvector *b,dvector *old_sol,void
     exit(0);
   }
 
+  INT reuse = (pat!=NULL && pat->slot!=NULL);
   b->row = FE->ndof;
   if(b->val) {
     dvec_set(b->row,b,0.0);
@@ -772,66 +1208,132 @@ void assemble_global_Jacobian(block_dCSRmat* A,dvector *b,dvector *old_sol,void
         // Set values
         if(A->blocks[i*nblocks+j]->val==NULL)
           A->blocks[i*nblocks+j]->val = (REAL *) calloc(A->blocks[i*nblocks+j]->nnz,sizeof(REAL));
-        for (k=0; k<A->blocks[i*nblocks+j]->nnz; k++) {
-          A->blocks[i*nblocks+j]->val[k] = 0;
-        }
+        array_set(A->blocks[i*nblocks+j]->nnz,A->blocks[i*nblocks+j]->val,0.0);
       }
     }
     dof_per_elm += FE->var_spaces[i]->dof_per_elm;
   }
 
-  // Now Build Global Matrix entries
-  /* Loop over all Elements and build local matrix and rhs */
-  INT local_size = dof_per_elm*dof_per_elm;
-  REAL* ALoc = (REAL *) calloc(local_size,sizeof(REAL));
-  REAL* bLoc=NULL;
-  if(b!=NULL) bLoc = (REAL *) calloc(dof_per_elm,sizeof(REAL));
-
-  INT* dof_on_elm = (INT *) calloc(dof_per_elm,sizeof(INT));
-  INT* v_on_elm = (INT *) calloc(v_per_elm,sizeof(INT));
-  INT rowa,rowb,jcntr;
-  // Loop over elements
-  for (i=0; i<mesh->nelm; i++) {
-    // Zero out local matrices
-    for (j=0; j<local_size; j++) {
-      ALoc[j]=0;
-    }
-    if(b!=NULL) {
-      for (j=0; j<dof_per_elm; j++) {
-        bLoc[j]=0;
-      }
+  // Positions of the local matrix entries in the blocks of A
+  INT nnz = 0;
+  for(i=0;i<nblocks*nblocks;i++) {
+    if(A->blocks[i]) nnz += A->blocks[i]->nnz;
+  }
+  INT* elm_slot = NULL;
+  if(reuse) {
+    if(pat->nent!=mesh->nelm || pat->ld!=dof_per_elm || pat->nnz!=nnz) {
+      check_error(ERROR_DATA_STRUCTURE,__FUNCTION__);
     }
+    elm_slot = pat->slot;
+  } else if(pat!=NULL) {
+    // Slot map kept in pat (a one-shot assembly searches the rows instead)
+    elm_slot = (INT *) calloc(mesh->nelm*dof_per_elm*dof_per_elm,sizeof(INT));
+    block_create_CSR_slots(A,FE,0,elm_slot);
+    pat->nent = mesh->nelm;
+    pat->ld = dof_per_elm;
+    pat->nnz = nnz;
+    pat->slot = elm_slot;
+  }
 
-    // Find DOF for given Element
-    // Note this is "local" ordering for the given FE space of the block
-    // Not global ordering of all DOF
-    jcntr = 0;
-    for(k=0;k<nblocks;k++) {
-      rowa = FE->var_spaces[k]->el_dof->IA[i];
-      rowb = FE->var_spaces[k]->el_dof->IA[i+1];
-      for (j=rowa; j<rowb; j++) {
-        dof_on_elm[jcntr] = FE->var_spaces[k]->el_dof->JA[j];
-        jcntr++;
-      }
+  // Now Build Global Matrix entries
+#ifdef _OPENMP
+  // Color the elements so that the elements of one color share no DOF (once;
+  // the colors are kept in the pattern with the slot map)
+  iCSRmat colors;
+  INT threaded;
+  if(pat!=NULL && pat->colors.IA!=NULL) {
+    colors = pat->colors;
+    threaded = pat->threaded;
+  } else {
+    threaded = block_color_elements(FE,0,&colors);
+    if(pat!=NULL) {
+      pat->colors = colors;
+      pat->threaded = threaded;
     }
+  }
+
+#pragma omp parallel private(i,j,k) if(threaded)
+#endif
+  {
+    // Local data for each thread
+    block_fespace FEt;
+    copy_blockfespace_scratch(FE,&FEt,mesh->dim);
+    mesh_struct mesht;
+    copy_mesh_scratch(mesh,&mesht);
+    qcoordinates cqt;
+    copy_qcoords_scratch(cq,&cqt);
+
+    /* Loop over all Elements and build local matrix and rhs */
+    INT local_size = dof_per_elm*dof_per_elm;
+    REAL* ALoc = (REAL *) calloc(local_size,sizeof(REAL));
+    REAL* bLoc=NULL;
+    if(b!=NULL) bLoc = (REAL *) calloc(dof_per_elm,sizeof(REAL));
+
+    INT* dof_on_elm = (INT *) calloc(dof_per_elm,sizeof(INT));
+    INT* v_on_elm = (INT *) calloc(v_per_elm,sizeof(INT));
+    INT rowa,rowb,jcntr;
+#ifdef _OPENMP
+    INT icol,ient;
+    for (icol=0; icol<colors.row; icol++) {
+#pragma omp for
+      for (ient=colors.IA[icol]; ient<colors.IA[icol+1]; ient++) {
+        i = colors.JA[ient];
+#else
+    {
+      for (i=0; i<mesh->nelm; i++) {
+#endif
+        // Zero out local matrices
+        for (j=0; j<local_size; j++) {
+          ALoc[j]=0;
+        }
+        if(b!=NULL) {
+          for (j=0; j<dof_per_elm; j++) {
+            bLoc[j]=0;
+          }
+        }
 
-    get_incidence_row(i,mesh->el_v,v_on_elm);
+        // Find DOF for given Element
+        // Note this is "local" ordering for the given FE space of the block
+        // Not global ordering of all DOF
+        jcntr = 0;
+        for(k=0;k<nblocks;k++) {
+          rowa = FE->var_spaces[k]->el_dof->IA[i];
+          rowb = FE->var_spaces[k]->el_dof->IA[i+1];
+          for (j=rowa; j<rowb; j++) {
+            dof_on_elm[jcntr] = FE->var_spaces[k]->el_dof->JA[j];
+            jcntr++;
+          }
+        }
 
-    // Compute Local Stiffness Matrix for given Element
-    if(b!=NULL) {
-      (*local_assembly)(ALoc,bLoc,old_sol,FE,mesh,cq,dof_on_elm,v_on_elm,i,rhs,time);
-    } else {
-      (*local_assembly)(ALoc,NULL,old_sol,FE,mesh,cq,dof_on_elm,v_on_elm,i,rhs,time);
+        get_incidence_row(i,mesh->el_v,v_on_elm);
+
+        // Quadrature nodes on the element
+        quad_elm(&cqt,mesh,cq->nq1d,i);
+
+        // Compute Local Stiffness Matrix for given Element
+        if(b!=NULL) {
+          (*local_assembly)(ALoc,bLoc,old_sol,&FEt,&mesht,&cqt,dof_on_elm,v_on_elm,i,rhs,time);
+        } else {
+          (*local_assembly)(ALoc,NULL,old_sol,&FEt,&mesht,&cqt,dof_on_elm,v_on_elm,i,rhs,time);
+        }
+
+        // Loop over DOF and place in appropriate slot globally
+        block_LocaltoGlobal(dof_on_elm,FE,b,A,ALoc,bLoc,elm_slot ? elm_slot+i*local_size : NULL);
+      }
     }
 
-    // Loop over DOF and place in appropriate slot globally
-    block_LocaltoGlobal(dof_on_elm,FE,b,A,ALoc,bLoc);
+    if(dof_on_elm) free(dof_on_elm);
+    if(v_on_elm) free(v_on_elm);
+    if(ALoc) free(ALoc);
+    if(bLoc) free(bLoc);
+    free_blockfespace_scratch(&FEt);
+    free_mesh_scratch(&mesht);
+    free_qcoords(&cqt);
   }
+#ifdef _OPENMP
+  if(pat==NULL) icsr_free(&colors);
+#endif
 
-  if(dof_on_elm) free(dof_on_elm);
-  if(v_on_elm) free(v_on_elm);
-  if(ALoc) free(ALoc);
-  if(bLoc) free(bLoc);
 
   return;
 }
@@ -879,36 +1381,72 @@ void assemble_global_RHS(dvector *b,fespace *FE,mesh_struct *mesh,qcoordinates *
     b->val = (REAL *) calloc(b->row,sizeof(REAL));
   }
 
-  /* Loop over all Elements and build local rhs */
-  REAL* bLoc= (REAL *) calloc(dof_per_elm,sizeof(REAL));
-
-  INT* dof_on_elm = (INT *) calloc(dof_per_elm,sizeof(INT));
-  INT* v_on_elm = (INT *) calloc(v_per_elm,sizeof(INT));
-  for (i=0; i<FE->nelm; i++) {
+#ifdef _OPENMP
+  // Color the elements so that the elements of one color share no DOF
+  iCSRmat colors;
+  INT threaded = color_elements(FE->nelm,1,&FE->el_dof,&colors);
+
+#pragma omp parallel private(i,j,row) if(threaded)
+#endif
+  {
+    // Local data for each thread
+    fespace FEt;
+    copy_fespace_scratch(FE,&FEt,mesh->dim);
+    mesh_struct mesht;
+    copy_mesh_scratch(mesh,&mesht);
+    qcoordinates cqt;
+    copy_qcoords_scratch(cq,&cqt);
+
+    /* Loop over all Elements and build local rhs */
+    REAL* bLoc= (REAL *) calloc(dof_per_elm,sizeof(REAL));
+
+    INT* dof_on_elm = (INT *) calloc(dof_per_elm,sizeof(INT));
+    INT* v_on_elm = (INT *) calloc(v_per_elm,sizeof(INT));
+#ifdef _OPENMP
+    INT icol,ient;
+    for (icol=0; icol<colors.row; icol++) {
+#pragma omp for
+      for (ient=colors.IA[icol]; ient<colors.IA[icol+1]; ient++) {
+        i = colors.JA[ient];
+#else
+    {
+      for (i=0; i<FE->nelm; i++) {
+#endif
+
+        for (j=0; j<dof_per_elm; j++) {
+          bLoc[j]=0;
+        }
 
-    for (j=0; j<dof_per_elm; j++) {
-      bLoc[j]=0;
-    }
+        // Find DOF for given Element
+        get_incidence_row(i,FE->el_dof,dof_on_elm);
 
-    // Find DOF for given Element
-    get_incidence_row(i,FE->el_dof,dof_on_elm);
+        // Find vertices for given Element
+        get_incidence_row(i,mesh->el_v,v_on_elm);
 
-    // Find vertices for given Element
-    get_incidence_row(i,mesh->el_v,v_on_elm);
+        // Quadrature nodes on the element
+        quad_elm(&cqt,mesh,cq->nq1d,i);
 
-    // Compute Local RHS for given Element
-    FEM_RHS_Local(bLoc,FE,mesh,cq,dof_on_elm,v_on_elm,i,rhs,time);
+        // Compute Local RHS for given Element
+        FEM_RHS_Local(bLoc,&FEt,&mesht,&cqt,dof_on_elm,v_on_elm,i,rhs,time);
 
-    // Loop over DOF and place in appropriate slot globally
-    for (j=0; j<dof_per_elm; j++) {
-      row = dof_on_elm[j];
-      b->val[row] = b->val[row] + bLoc[j];
+        // Loop over DOF and place in appropriate slot globally
+        for (j=0; j<dof_per_elm; j++) {
+          row = dof_on_elm[j];
+          b->val[row] = b->val[row] + bLoc[j];
+        }
+      }
     }
-  }
 
-  if(dof_on_elm) free(dof_on_elm);
-  if(v_on_elm) free(v_on_elm);
-  if(bLoc) free(bLoc);
+    if(dof_on_elm) free(dof_on_elm);
+    if(v_on_elm) free(v_on_elm);
+    if(bLoc) free(bLoc);
+    free_fespace_scratch(&FEt);
+    free_mesh_scratch(&mesht);
+    free_qcoords(&cqt);
+  }
+#ifdef _OPENMP
+  icsr_free(&colors);
+#endif
 
   return;
 }
@@ -965,54 +1503,89 @@ void assemble_global_RHS_block(dvector *b,void (*local_rhs_assembly)(REAL *,bloc
     dof_per_elm += FE->var_spaces[i]->dof_per_elm;
   }
 
-  /* Loop over all Elements and build local rhs */
-  REAL* bLoc = (REAL *) calloc(dof_per_elm,sizeof(REAL));
-
-  INT* dof_on_elm = (INT *) calloc(dof_per_elm,sizeof(INT));
-  INT* v_on_elm = (INT *) calloc(v_per_elm,sizeof(INT));
-  INT rowa,rowb,jcntr;
-  // Loop over elements
-  for (i=0; i<mesh->nelm; i++) {
-    // Zero out local matrices
-    for (j=0; j<dof_per_elm; j++) {
-      bLoc[j]=0;
-    }
-
-    // Find DOF for given Element
-    // Note this is "local" ordering for the given FE space of the block
-    // Not global ordering of all DOF
-    jcntr = 0;
-    for(k=0;k<nblocks;k++) {
-      rowa = FE->var_spaces[k]->el_dof->IA[i];
-      rowb = FE->var_spaces[k]->el_dof->IA[i+1];
-      for (j=rowa; j<rowb; j++) {
-        dof_on_elm[jcntr] = FE->var_spaces[k]->el_dof->JA[j];
-        jcntr++;
-      }
-    }
-
-    // Find vertices for given Element
-    get_incidence_row(i,mesh->el_v,v_on_elm);
+#ifdef _OPENMP
+  // Color the elements so that the elements of one color share no DOF
+  iCSRmat colors;
+  INT threaded = block_color_elements(FE,0,&colors);
+
+#pragma omp parallel private(i,j,k,row) if(threaded)
+#endif
+  {
+    // Local data for each thread
+    block_fespace FEt;
+    copy_blockfespace_scratch(FE,&FEt,mesh->dim);
+    mesh_struct mesht;
+    copy_mesh_scratch(mesh,&mesht);
+    qcoordinates cqt;
+    copy_qcoords_scratch(cq,&cqt);
+
+    /* Loop over all Elements and build local rhs */
+    REAL* bLoc = (REAL *) calloc(dof_per_elm,sizeof(REAL));
+
+    INT* dof_on_elm = (INT *) calloc(dof_per_elm,sizeof(INT));
+    INT* v_on_elm = (INT *) calloc(v_per_elm,sizeof(INT));
+    INT rowa,rowb,jcntr;
+#ifdef _OPENMP
+    INT icol,ient;
+    for (icol=0; icol<colors.row; icol++) {
+#pragma omp for
+      for (ient=colors.IA[icol]; ient<colors.IA[icol+1]; ient++) {
+        i = colors.JA[ient];
+#else
+    {
+      for (i=0; i<mesh->nelm; i++) {
+#endif
+        // Zero out local matrices
+        for (j=0; j<dof_per_elm; j++) {
+          bLoc[j]=0;
+        }
 
-    // Compute Local RHS for given Element
-    (*local_rhs_assembly)(bLoc,FE,mesh,cq,dof_on_elm,v_on_elm,i,rhs,time);
+        // Find DOF for given Element
+        // Note this is "local" ordering for the given FE space of the block
+        // Not global ordering of all DOF
+        jcntr = 0;
+        for(k=0;k<nblocks;k++) {
+          rowa = FE->var_spaces[k]->el_dof->IA[i];
+          rowb = FE->var_spaces[k]->el_dof->IA[i+1];
+          for (j=rowa; j<rowb; j++) {
+            dof_on_elm[jcntr] = FE->var_spaces[k]->el_dof->JA[j];
+            jcntr++;
+          }
+        }
 
-    // Loop over DOF and place in appropriate slot globally
-    jcntr = 0;
-    rowa = 0;
-    for(k=0;k<nblocks;k++) {
-      for(j=0;j<FE->var_spaces[k]->dof_per_elm;j++) {
-        row = dof_on_elm[jcntr];
-        b->val[row+rowa]+=bLoc[jcntr];
-        jcntr++;
+        // Find vertices for given Element
+        get_incidence_row(i,mesh->el_v,v_on_elm);
+
+        // Quadrature nodes on the element
+        quad_elm(&cqt,mesh,cq->nq1d,i);
+
+        // Compute Local RHS for given Element
+        (*local_rhs_assembly)(bLoc,&FEt,&mesht,&cqt,dof_on_elm,v_on_elm,i,rhs,time);
+
+        // Loop over DOF and place in appropriate slot globally
+        jcntr = 0;
+        rowa = 0;
+        for(k=0;k<nblocks;k++) {
+          for(j=0;j<FE->var_spaces[k]->dof_per_elm;j++) {
+            row = dof_on_elm[jcntr];
+            b->val[row+rowa]+=bLoc[jcntr];
+            jcntr++;
+          }
+          rowa += FE->var_spaces[k]->ndof;
+        }
       }
-      rowa += FE->var_spaces[k]->ndof;
     }
-  }
 
-  if(dof_on_elm) free(dof_on_elm);
-  if(v_on_elm) free(v_on_elm);
-  if(bLoc) free(bLoc);
+    if(dof_on_elm) free(dof_on_elm);
+    if(v_on_elm) free(v_on_elm);
+    if(bLoc) free(bLoc);
+    free_blockfespace_scratch(&FEt);
+    free_mesh_scratch(&mesht);
+    free_qcoords(&cqt);
+  }
+#ifdef _OPENMP
+  icsr_free(&colors);
+#endif
 
   return;
 }
@@ -1072,54 +1645,89 @@ void assemble_global_RHS_Jacobian(dvector *b,dvector *old_sol,void (*local_rhs_a
     dof_per_elm += FE->var_spaces[i]->dof_per_elm;
   }
 
-  /* Loop over all Elements and build local rhs */
-  REAL* bLoc = (REAL *) calloc(dof_per_elm,sizeof(REAL));
-
-  INT* dof_on_elm = (INT *) calloc(dof_per_elm,sizeof(INT));
-  INT* v_on_elm = (INT *) calloc(v_per_elm,sizeof(INT));
-  INT rowa,rowb,jcntr;
-  // Loop over elements
-  for (i=0; i<mesh->nelm; i++) {
-    // Zero out local matrices
-    for (j=0; j<dof_per_elm; j++) {
-      bLoc[j]=0;
-    }
-
-    // Find DOF for given Element
-    // Note this is "local" ordering for the given FE space of the block
-    // Not global ordering of all DOF
-    jcntr = 0;
-    for(k=0;k<nblocks;k++) {
-      rowa = FE->var_spaces[k]->el_dof->IA[i];
-      rowb = FE->var_spaces[k]->el_dof->IA[i+1];
-      for (j=rowa; j<rowb; j++) {
-        dof_on_elm[jcntr] = FE->var_spaces[k]->el_dof->JA[j];
-        jcntr++;
-      }
-    }
-
-    // Find vertices for given Element
-    get_incidence_row(i,mesh->el_v,v_on_elm);
+#ifdef _OPENMP
+  // Color the elements so that the elements of one color share no DOF
+  iCSRmat colors;
+  INT threaded = block_color_elements(FE,0,&colors);
+
+#pragma omp parallel private(i,j,k,row) if(threaded)
+#endif
+  {
+    // Local data for each thread
+    block_fespace FEt;
+    copy_blockfespace_scratch(FE,&FEt,mesh->dim);
+    mesh_struct mesht;
+    copy_mesh_scratch(mesh,&mesht);
+    qcoordinates cqt;
+    copy_qcoords_scratch(cq,&cqt);
+
+    /* Loop over all Elements and build local rhs */
+    REAL* bLoc = (REAL *) calloc(dof_per_elm,sizeof(REAL));
+
+    INT* dof_on_elm = (INT *) calloc(dof_per_elm,sizeof(INT));
+    INT* v_on_elm = (INT *) calloc(v_per_elm,sizeof(INT));
+    INT rowa,rowb,jcntr;
+#ifdef _OPENMP
+    INT icol,ient;
+    for (icol=0; icol<colors.row; icol++) {
+#pragma omp for
+      for (ient=colors.IA[icol]; ient<colors.IA[icol+1]; ient++) {
+        i = colors.JA[ient];
+#else
+    {
+      for (i=0; i<mesh->nelm; i++) {
+#endif
+        // Zero out local matrices
+        for (j=0; j<dof_per_elm; j++) {
+          bLoc[j]=0;
+        }
 
-    // Compute Local RHS for given Element
-    (*local_rhs_assembly)(bLoc,old_sol,FE,mesh,cq,dof_on_elm,v_on_elm,i,rhs,time);
+        // Find DOF for given Element
+        // Note this is "local" ordering for the given FE space of the block
+        // Not global ordering of all DOF
+        jcntr = 0;
+        for(k=0;k<nblocks;k++) {
+          rowa = FE->var_spaces[k]->el_dof->IA[i];
+          rowb = FE->var_spaces[k]->el_dof->IA[i+1];
+          for (j=rowa; j<rowb; j++) {
+            dof_on_elm[jcntr] = FE->var_spaces[k]->el_dof->JA[j];
+            jcntr++;
+          }
+        }
 
-    // Loop over DOF and place in appropriate slot globally
-    jcntr = 0;
-    rowa = 0;
-    for(k=0;k<nblocks;k++) {
-      for(j=0;j<FE->var_spaces[k]->dof_per_elm;j++) {
-        row = dof_on_elm[jcntr];
-        b->val[row+rowa]+=bLoc[jcntr];
-        jcntr++;
+        // Find vertices for given Element
+        get_incidence_row(i,mesh->el_v,v_on_elm);
+
+        // Quadrature nodes on the element
+        quad_elm(&cqt,mesh,cq->nq1d,i);
+
+        // Compute Local RHS for given Element
+        (*local_rhs_assembly)(bLoc,old_sol,&FEt,&mesht,&cqt,dof_on_elm,v_on_elm,i,rhs,time);
+
+        // Loop over DOF and place in appropriate slot globally
+        jcntr = 0;
+        rowa = 0;
+        for(k=0;k<nblocks;k++) {
+          for(j=0;j<FE->var_spaces[k]->dof_per_elm;j++) {
+            row = dof_on_elm[jcntr];
+            b->val[row+rowa]+=bLoc[jcntr];
+            jcntr++;
+          }
+          rowa += FE->var_spaces[k]->ndof;
+        }
       }
-      rowa += FE->var_spaces[k]->ndof;
     }
-  }
 
-  if(dof_on_elm) free(dof_on_elm);
-  if(v_on_elm) free(v_on_elm);
-  if(bLoc) free(bLoc);
+    if(dof_on_elm) free(dof_on_elm);
+    if(v_on_elm) free(v_on_elm);
+    if(bLoc) free(bLoc);
+    free_blockfespace_scratch(&FEt);
+    free_mesh_scratch(&mesht);
+    free_qcoords(&cqt);
+  }
+#ifdef _OPENMP
+  icsr_free(&colors);
+#endif
 
   return;
 }
@@ -1198,6 +1806,21 @@ void assemble_global_face(dCSRmat* A,dvector* b,dvector *old_sol,void (*local_as
   A->JA = (INT *) calloc(A->nnz,sizeof(INT));
   create_CSR_cols_flag(A,FE,flag0,flag1);
 
+  // Positions of the local matrix entries in A->val (if all faces have the same DOF)
+  INT* f_slot = NULL;
+  INT uniform = 1;
+  for(i=0;i<mesh->nface;i++) {
+    if(FE->f_dof->IA[i+1]-FE->f_dof->IA[i]!=dof_per_face) {
+      uniform = 0;
+      break;
+    }
+  }
+  if(uniform) {
+    f_slot = (INT *) calloc(mesh->nface*dof_per_face*dof_per_face,sizeof(INT));
+    iarray_set(mesh->nface*dof_per_face*dof_per_face,f_slot,-1);
+    create_CSR_slots(A,FE->f_dof,FE->f_dof,f_slot,dof_per_face,dof_per_face*dof_per_face);
+  }
+
   // Set values
   A->val = (REAL *) calloc(A->nnz,sizeof(REAL));
   for (i=0; i<A->nnz; i++) {
@@ -1206,66 +1829,98 @@ void assemble_global_face(dCSRmat* A,dvector* b,dvector *old_sol,void (*local_as
 
   // Now Build Global Matrix entries
 
-  /* Loop over all Faces and build local matrix */
-  INT local_size = dof_per_face*dof_per_face;
-  REAL* ALoc = (REAL *) calloc(local_size,sizeof(REAL));
-  REAL* bLoc=NULL;
-  if(rhs!=NULL)
-  bLoc = (REAL *) calloc(dof_per_face,sizeof(REAL));
-
-  // Get mappings for given element and face
-  INT* dof_on_elm = (INT *) calloc(dof_per_elm,sizeof(INT));
-  INT* v_on_elm = (INT *) calloc(v_per_elm,sizeof(INT));
-  INT* dof_on_f = (INT *) calloc(dof_per_face,sizeof(INT));
-  INT rowa;
-
   // We will need the face to element map
   iCSRmat f_el;
   icsr_trans(mesh->el_f,&f_el);
 
-  // Loop over boundary faces
-  for (i=0; i<mesh->nface; i++) {
-    // Only grab the faces on the flagged boundary
-    if(mesh->f_flag[i]>=flag0 && mesh->f_flag[i]<=flag1) {
-      // Zero out local matrices
-      for (j=0; j<local_size; j++) {
-        ALoc[j]=0;
-      }
-      if(rhs!=NULL) {
-        for (j=0; j<dof_per_face; j++) {
-          bLoc[j]=0;
+#ifdef _OPENMP
+  // Color the faces so that the faces of one color share no DOF
+  iCSRmat colors;
+  INT threaded = color_elements(mesh->nface,1,&FE->f_dof,&colors);
+
+#pragma omp parallel private(i,j,elm) if(threaded)
+#endif
+  {
+    // Local data for each thread
+    fespace FEt;
+    copy_fespace_scratch(FE,&FEt,mesh->dim);
+    mesh_struct mesht;
+    copy_mesh_scratch(mesh,&mesht);
+
+    /* Loop over all Faces and build local matrix */
+    INT local_size = dof_per_face*dof_per_face;
+    REAL* ALoc = (REAL *) calloc(local_size,sizeof(REAL));
+    REAL* bLoc=NULL;
+    if(rhs!=NULL)
+    bLoc = (REAL *) calloc(dof_per_face,sizeof(REAL));
+
+    // Get mappings for given element and face
+    INT* dof_on_elm = (INT *) calloc(dof_per_elm,sizeof(INT));
+    INT* v_on_elm = (INT *) calloc(v_per_elm,sizeof(INT));
+    INT* dof_on_f = (INT *) calloc(dof_per_face,sizeof(INT));
+    INT rowa;
+
+    // Loop over boundary faces
+#ifdef _OPENMP
+    INT icol,ient;
+    for (icol=0; icol<colors.row; icol++) {
+#pragma omp for
+      for (ient=colors.IA[icol]; ient<colors.IA[icol+1]; ient++) {
+        i = colors.JA[ient];
+#else
+    {
+      for (i=0; i<mesh->nface; i++) {
+#endif
+        // Only grab the faces on the flagged boundary
+        if(mesh->f_flag[i]>=flag0 && mesh->f_flag[i]<=flag1) {
+          // Zero out local matrices
+          for (j=0; j<local_size; j++) {
+            ALoc[j]=0;
+          }
+          if(rhs!=NULL) {
+            for (j=0; j<dof_per_face; j++) {
+              bLoc[j]=0;
+            }
+          }
+
+          // Find DOF for given Face
+          get_incidence_row(i,FE->f_dof,dof_on_f);
+
+          // Find the corresponding element associated with the face
+          // Assume only 1 matters (if on boundary)
+          rowa = f_el.IA[i];
+          elm = f_el.JA[rowa];
+
+          // Find DOF on that element
+          get_incidence_row(elm,FE->el_dof,dof_on_elm);
+
+          // Find vertices for given Element
+          get_incidence_row(elm,mesh->el_v,v_on_elm);
+
+          // Compute Local Stiffness Matrix for given Element
+          (*local_assembly_face)(ALoc,old_sol,&FEt,&mesht,cq,dof_on_f,dof_on_elm,v_on_elm,i,elm,coeff,time);
+          if(rhs!=NULL)
+          (*local_rhs_assembly_face)(bLoc,old_sol,&FEt,&mesht,cq,dof_on_f,dof_on_elm,v_on_elm,i,elm,rhs,time);
+
+          // Loop over DOF and place in appropriate slot globally
+          LocaltoGlobal_face(dof_on_f,dof_per_face,FE,b,A,ALoc,bLoc,flag0,flag1,f_slot ? f_slot+i*local_size : NULL);
         }
       }
-
-      // Find DOF for given Face
-      get_incidence_row(i,FE->f_dof,dof_on_f);
-
-      // Find the corresponding element associated with the face
-      // Assume only 1 matters (if on boundary)
-      rowa = f_el.IA[i];
-      elm = f_el.JA[rowa];
-
-      // Find DOF on that element
-      get_incidence_row(elm,FE->el_dof,dof_on_elm);
-
-      // Find vertices for given Element
-      get_incidence_row(elm,mesh->el_v,v_on_elm);
-
-      // Compute Local Stiffness Matrix for given Element
-      (*local_assembly_face)(ALoc,old_sol,FE,mesh,cq,dof_on_f,dof_on_elm,v_on_elm,i,elm,coeff,time);
-      if(rhs!=NULL)
-      (*local_rhs_assembly_face)(bLoc,old_sol,FE,mesh,cq,dof_on_f,dof_on_elm,v_on_elm,i,elm,rhs,time);
-
-      // Loop over DOF and place in appropriate slot globally
-      LocaltoGlobal_face(dof_on_f,dof_per_face,FE,b,A,ALoc,bLoc,flag0,flag1);
     }
+
+    if(dof_on_elm) free(dof_on_elm);
+    if(v_on_elm) free(v_on_elm);
+    if(dof_on_f) free(dof_on_f);
+    if(ALoc) free(ALoc);
+    if(bLoc) free(bLoc);
+    free_fespace_scratch(&FEt);
+    free_mesh_scratch(&mesht);
   }
+#ifdef _OPENMP
+  icsr_free(&colors);
+#endif
 
-  if(dof_on_elm) free(dof_on_elm);
-  if(v_on_elm) free(v_on_elm);
-  if(dof_on_f) free(dof_on_f);
-  if(ALoc) free(ALoc);
-  if(bLoc) free(bLoc);
+  if(f_slot) free(f_slot);
   icsr_free(&f_el);
 
   return;
@@ -1336,57 +1991,88 @@ void assemble_global_RHS_face(dvector* b,dvector *old_sol,void (*local_rhs_assem
     b->val = (REAL *) calloc(b->row,sizeof(REAL));
   }
 
-  /* Loop over all Faces and build local matrix */
-  REAL* bLoc=NULL;
-  bLoc = (REAL *) calloc(dof_per_face,sizeof(REAL));
-
-  // Get mappings for given element and face
-  INT* dof_on_elm = (INT *) calloc(dof_per_elm,sizeof(INT));
-  INT* v_on_elm = (INT *) calloc(v_per_elm,sizeof(INT));
-  INT* dof_on_f = (INT *) calloc(dof_per_face,sizeof(INT));
-
   // We will need the face to element map
   iCSRmat f_el;
   icsr_trans(mesh->el_f,&f_el);
 
-  // Loop over boundary faces
-  for (i=0; i<mesh->nface; i++) {
-    // Only grab the faces on the flagged boundary
-    if(mesh->f_flag[i]>=flag0 && mesh->f_flag[i]<=flag1) {
-      // Zero out local matrices
-      for (j=0; j<dof_per_face; j++) {
-        bLoc[j]=0;
-      }
-
-      // Find DOF for given Face
-      get_incidence_row(i,FE->f_dof,dof_on_f);
-
-      // Find the corresponding element associated with the face
-      // Assume only 1 matters (if on boundary)
-      rowa = f_el.IA[i];
-      elm = f_el.JA[rowa];
-
-      // Find DOF on that element
-      get_incidence_row(elm,FE->el_dof,dof_on_elm);
-
-      // Find vertices for given Element
-      get_incidence_row(elm,mesh->el_v,v_on_elm);
-
-      // Compute Local Stiffness Matrix for given Element
-      (*local_rhs_assembly_face)(bLoc,old_sol,FE,mesh,cq,dof_on_f,dof_on_elm,v_on_elm,dof_per_face,i,elm,rhs,time);
-
-      // Loop over DOF and place in appropriate slot globally
-      for (j=0; j<dof_per_face; j++) { /* Rows of Local Stiffness */
-        row = dof_on_f[j];
-        b->val[row] += bLoc[j];
+#ifdef _OPENMP
+  // Color the faces so that the faces of one color share no DOF
+  iCSRmat colors;
+  INT threaded = color_elements(mesh->nface,1,&FE->f_dof,&colors);
+
+#pragma omp parallel private(i,j,elm,row,rowa) if(threaded)
+#endif
+  {
+    // Local data for each thread
+    fespace FEt;
+    copy_fespace_scratch(FE,&FEt,mesh->dim);
+    mesh_struct mesht;
+    copy_mesh_scratch(mesh,&mesht);
+
+    /* Loop over all Faces and build local matrix */
+    REAL* bLoc=NULL;
+    bLoc = (REAL *) calloc(dof_per_face,sizeof(REAL));
+
+    // Get mappings for given element and face
+    INT* dof_on_elm = (INT *) calloc(dof_per_elm,sizeof(INT));
+    INT* v_on_elm = (INT *) calloc(v_per_elm,sizeof(INT));
+    INT* dof_on_f = (INT *) calloc(dof_per_face,sizeof(INT));
+
+    // Loop over boundary faces
+#ifdef _OPENMP
+    INT icol,ient;
+    for (icol=0; icol<colors.row; icol++) {
+#pragma omp for
+      for (ient=colors.IA[icol]; ient<colors.IA[icol+1]; ient++) {
+        i = colors.JA[ient];
+#else
+    {
+      for (i=0; i<mesh->nface; i++) {
+#endif
+        // Only grab the faces on the flagged boundary
+        if(mesh->f_flag[i]>=flag0 && mesh->f_flag[i]<=flag1) {
+          // Zero out local matrices
+          for (j=0; j<dof_per_face; j++) {
+            bLoc[j]=0;
+          }
+
+          // Find DOF for given Face
+          get_incidence_row(i,FE->f_dof,dof_on_f);
+
+          // Find the corresponding element associated with the face
+          // Assume only 1 matters (if on boundary)
+          rowa = f_el.IA[i];
+          elm = f_el.JA[rowa];
+
+          // Find DOF on that element
+          get_incidence_row(elm,FE->el_dof,dof_on_elm);
+
+          // Find vertices for given Element
+          get_incidence_row(elm,mesh->el_v,v_on_elm);
+
+          // Compute Local Stiffness Matrix for given Element
+          (*local_rhs_assembly_face)(bLoc,old_sol,&FEt,&mesht,cq,dof_on_f,dof_on_elm,v_on_elm,dof_per_face,i,elm,rhs,time);
+
+          // Loop over DOF and place in appropriate slot globally
+          for (j=0; j<dof_per_face; j++) { /* Rows of Local Stiffness */
+            row = dof_on_f[j];
+            b->val[row] += bLoc[j];
+          }
+        }
       }
     }
+
+    if(dof_on_elm) free(dof_on_elm);
+    if(v_on_elm) free(v_on_elm);
+    if(dof_on_f) free(dof_on_f);
+    if(bLoc) free(bLoc);
+    free_fespace_scratch(&FEt);
+    free_mesh_scratch(&mesht);
   }
+#ifdef _OPENMP
+  icsr_free(&colors);
+#endif
 
-  if(dof_on_elm) free(dof_on_elm);
-  if(v_on_elm) free(v_on_elm);
-  if(dof_on_f) free(dof_on_f);
-  if(bLoc) free(bLoc);
   icsr_free(&f_el);
 
   return;
@@ -1519,85 +2205,137 @@ void assemble_global_face_block(block_dCSRmat* A,dvector* b,dvector *old_sol,voi
     }
   }
 
-  // Now Build Global Matrix entries
-
-  /* Loop over all Faces and build local matrix */
-  INT local_size = dof_per_face*dof_per_face;
-  REAL* ALoc = (REAL *) calloc(local_size,sizeof(REAL));
-  REAL* bLoc=NULL;
-  if(b!=NULL) bLoc = (REAL *) calloc(dof_per_face,sizeof(REAL));
+  // Positions of the local matrix entries in the blocks of A (if every space has the face DOF map)
+  INT* f_slot = NULL;
+  INT uniform = 1;
+  for(i=0;i<nblocks && uniform;i++) {
+    if(FE->var_spaces[i]->f_dof==NULL) {
+      uniform = 0;
+      break;
+    }
+    for(j=0;j<mesh->nface;j++) {
+      if(FE->var_spaces[i]->f_dof->IA[j+1]-FE->var_spaces[i]->f_dof->IA[j]!=dof_per_face_blk[i]) {
+        uniform = 0;
+        break;
+      }
+    }
+  }
+  if(uniform) {
+    f_slot = (INT *) calloc(mesh->nface*dof_per_face*dof_per_face,sizeof(INT));
+    block_create_CSR_slots(A,FE,1,f_slot);
+  }
 
-  // Get mappings for given element and face
-  INT* dof_on_elm = (INT *) calloc(dof_per_elm,sizeof(INT));
-  INT* v_on_elm = (INT *) calloc(v_per_elm,sizeof(INT));
-  INT* dof_on_f = (INT *) calloc(dof_per_face,sizeof(INT));
-  INT rowa;
+  // Now Build Global Matrix entries
 
   // We will need the face to element map
   iCSRmat f_el;
   icsr_trans(mesh->el_f,&f_el);
 
-  // Loop over boundary faces
-  for (i=0; i<mesh->nface; i++) {
-    // Only grab the faces on the flagged boundary
-    if(mesh->f_flag[i]>=flag0 && mesh->f_flag[i]<=flag1) {
-      // Zero out local matrices
-      for (j=0; j<local_size; j++) {
-        ALoc[j]=0;
-      }
-      if(rhs!=NULL) {
-        for (j=0; j<dof_per_face; j++) {
-          bLoc[j]=0;
-        }
-      }
-
-      // Find DOF for given face
-      jcntr = 0;
-      for(k=0;k<nblocks;k++) {
-        rowa = FE->var_spaces[k]->f_dof->IA[i];
-        rowb = FE->var_spaces[k]->f_dof->IA[i+1];
-        for (j=rowa; j<rowb; j++) {
-          dof_on_f[jcntr] = FE->var_spaces[k]->f_dof->JA[j];
-          jcntr++;
+#ifdef _OPENMP
+  // Color the faces so that the faces of one color share no DOF
+  iCSRmat colors;
+  INT threaded = block_color_elements(FE,1,&colors);
+
+#pragma omp parallel private(i,j,k,jcntr,rowb,elm) if(threaded)
+#endif
+  {
+    // Local data for each thread
+    block_fespace FEt;
+    copy_blockfespace_scratch(FE,&FEt,mesh->dim);
+    mesh_struct mesht;
+    copy_mesh_scratch(mesh,&mesht);
+
+    /* Loop over all Faces and build local matrix */
+    INT local_size = dof_per_face*dof_per_face;
+    REAL* ALoc = (REAL *) calloc(local_size,sizeof(REAL));
+    REAL* bLoc=NULL;
+    if(b!=NULL) bLoc = (REAL *) calloc(dof_per_face,sizeof(REAL));
+
+    // Get mappings for given element and face
+    INT* dof_on_elm = (INT *) calloc(dof_per_elm,sizeof(INT));
+    INT* v_on_elm = (INT *) calloc(v_per_elm,sizeof(INT));
+    INT* dof_on_f = (INT *) calloc(dof_per_face,sizeof(INT));
+    INT rowa;
+
+    // Loop over boundary faces
+#ifdef _OPENMP
+    INT icol,ient;
+    for (icol=0; icol<colors.row; icol++) {
+#pragma omp for
+      for (ient=colors.IA[icol]; ient<colors.IA[icol+1]; ient++) {
+        i = colors.JA[ient];
+#else
+    {
+      for (i=0; i<mesh->nface; i++) {
+#endif
+        // Only grab the faces on the flagged boundary
+        if(mesh->f_flag[i]>=flag0 && mesh->f_flag[i]<=flag1) {
+          // Zero out local matrices
+          for (j=0; j<local_size; j++) {
+            ALoc[j]=0;
+          }
+          if(rhs!=NULL) {
+            for (j=0; j<dof_per_face; j++) {
+              bLoc[j]=0;
+            }
+          }
+
+          // Find DOF for given face
+          jcntr = 0;
+          for(k=0;k<nblocks;k++) {
+            rowa = FE->var_spaces[k]->f_dof->IA[i];
+            rowb = FE->var_spaces[k]->f_dof->IA[i+1];
+            for (j=rowa; j<rowb; j++) {
+              dof_on_f[jcntr] = FE->var_spaces[k]->f_dof->JA[j];
+              jcntr++;
+            }
+          }
+
+          // Find the corresponding element associated with the face
+          // Assume only 1 matters (if on boundary)
+          rowa = f_el.IA[i];
+          elm = f_el.JA[rowa];
+
+          // Find DOF for given Element
+          // Note this is "local" ordering for the given FE space of the block
+          // Not global ordering of all DOF
+          jcntr = 0;
+          for(k=0;k<nblocks;k++) {
+            rowa = FE->var_spaces[k]->el_dof->IA[elm];
+            rowb = FE->var_spaces[k]->el_dof->IA[elm+1];
+            for (j=rowa; j<rowb; j++) {
+              dof_on_elm[jcntr] = FE->var_spaces[k]->el_dof->JA[j];
+              jcntr++;
+            }
+          }
+
+          // Find vertices for given Element
+          get_incidence_row(elm,mesh->el_v,v_on_elm);
+
+          // Compute Local Stiffness Matrix for given Element
+          (*local_assembly_face)(ALoc,old_sol,&FEt,&mesht,cq,dof_on_f,dof_on_elm,v_on_elm,dof_per_face,i,elm,coeff,time);
+          if(b!=NULL) (*local_rhs_assembly_face)(bLoc,old_sol,&FEt,&mesht,cq,dof_on_f,dof_on_elm,v_on_elm,dof_per_face,i,elm,rhs,time);
+
+          // Loop over DOF and place in appropriate slot globally
+          block_LocaltoGlobal_face(dof_on_f,dof_per_face,dof_per_face_blk,FE,b,A,ALoc,bLoc,flag0,flag1,f_slot ? f_slot+i*local_size : NULL);
         }
       }
-
-      // Find the corresponding element associated with the face
-      // Assume only 1 matters (if on boundary)
-      rowa = f_el.IA[i];
-      elm = f_el.JA[rowa];
-
-      // Find DOF for given Element
-      // Note this is "local" ordering for the given FE space of the block
-      // Not global ordering of all DOF
-      jcntr = 0;
-      for(k=0;k<nblocks;k++) {
-        rowa = FE->var_spaces[k]->el_dof->IA[elm];
-        rowb = FE->var_spaces[k]->el_dof->IA[elm+1];
-        for (j=rowa; j<rowb; j++) {
-          dof_on_elm[jcntr] = FE->var_spaces[k]->el_dof->JA[j];
-          jcntr++;
-        }
-      }
-
-      // Find vertices for given Element
-      get_incidence_row(elm,mesh->el_v,v_on_elm);
-
-      // Compute Local Stiffness Matrix for given Element
-      (*local_assembly_face)(ALoc,old_sol,FE,mesh,cq,dof_on_f,dof_on_elm,v_on_elm,dof_per_face,i,elm,coeff,time);
-      if(b!=NULL) (*local_rhs_assembly_face)(bLoc,old_sol,FE,mesh,cq,dof_on_f,dof_on_elm,v_on_elm,dof_per_face,i,elm,rhs,time);
-
-      // Loop over DOF and place in appropriate slot globally
-      block_LocaltoGlobal_face(dof_on_f,dof_per_face,dof_per_face_blk,FE,b,A,ALoc,bLoc,flag0,flag1);
     }
+
+    if(dof_on_elm) free(dof_on_elm);
+    if(v_on_elm) free(v_on_elm);
+    if(dof_on_f) free(dof_on_f);
+    if(ALoc) free(ALoc);
+    if(bLoc) free(bLoc);
+    free_blockfespace_scratch(&FEt);
+    free_mesh_scratch(&mesht);
   }
+#ifdef _OPENMP
+  icsr_free(&colors);
+#endif
 
-  if(dof_on_elm) free(dof_on_elm);
   if(dof_per_face_blk) free (dof_per_face_blk);
-  if(v_on_elm) free(v_on_elm);
-  if(dof_on_f) free(dof_on_f);
-  if(ALoc) free(ALoc);
-  if(bLoc) free(bLoc);
+  if(f_slot) free(f_slot);
   icsr_free(&f_el);
 
   return;
@@ -1688,97 +2426,129 @@ void assemble_global_RHS_face_block(dvector *b, dvector *old_sol, void (*local_r
     }
   }
 
-  /* Loop over all Elements and build local rhs */
-  REAL* bLoc = (REAL *) calloc(dof_per_face,sizeof(REAL));
-
-  INT* dof_on_elm = (INT *) calloc(dof_per_elm,sizeof(INT));
-  INT* v_on_elm = (INT *) calloc(v_per_elm,sizeof(INT));
-  INT* dof_on_f = (INT *) calloc(dof_per_face,sizeof(INT));
-
   // Need face to element map
   iCSRmat f_el;
   icsr_trans(mesh->el_f,&f_el);
 
-  INT jcntr,rowa,rowb;
-  INT elm;
-  //INT dof_on_f_shift;
-  //INT dof_on_elm_shift;
-
-  // Loop over boundary faces
-  for(i=0;i<mesh->nface;i++) {
-    // Only grab faces on the flagged boundary
-    if(mesh->f_flag[i]>=flag0 && mesh->f_flag[i]<=flag1) {
-      // Zero out local vector
-      for(j=0;j<dof_per_face;j++) {
-        bLoc[j] = 0;
-      }
-
-      // Find DOF for given face
-      jcntr = 0;
-      for(k=0;k<nblocks;k++) {
-        rowa = FE->var_spaces[k]->f_dof->IA[i];
-        rowb = FE->var_spaces[k]->f_dof->IA[i+1];
-        for (j=rowa; j<rowb; j++) {
-          dof_on_f[jcntr] = FE->var_spaces[k]->f_dof->JA[j];
-          jcntr++;
-        }
-      }
-
-      // Find corresponding element associated with the face
-      // Assume only 1 matters (if on boundary)
-      rowa = f_el.IA[i];
-      elm = f_el.JA[rowa];
-
-      // Find DOF for given Element
-      // Note this is "local" ordering for the given FE space of the block
-      // Not global ordering of all DOF
-      jcntr = 0;
-      for(k=0;k<nblocks;k++) {
-        rowa = FE->var_spaces[k]->el_dof->IA[elm];
-        rowb = FE->var_spaces[k]->el_dof->IA[elm+1];
-        for (j=rowa; j<rowb; j++) {
-          dof_on_elm[jcntr] = FE->var_spaces[k]->el_dof->JA[j];
-          jcntr++;
-        }
-      }
-      //// DOF for given Face
-      //// then Find DOF on that element
-      //jcntr = 0;
-      //dof_on_f_shift = 0;
-      //dof_on_elm_shift = 0;
-      //for(k=0;k<nblocks;k++){
-      //  get_incidence_row(i,FE->var_spaces[k]->f_dof,dof_on_f+dof_on_f_shift);
-      //  dof_on_f_shift += dof_per_face_blk[k];
-      //
-      //  get_incidence_row(elm,FE->var_spaces[k]->el_dof,dof_on_elm+dof_on_elm_shift);
-      //  dof_on_elm_shift += FE->var_spaces[k]->dof_per_elm;
-      //}
-
-      // Find vertices for given element
-      get_incidence_row(elm,mesh->el_v,v_on_elm);
-
-      // Compute Local RHS for given element
-      (*local_rhs_assembly_face)(bLoc,old_sol,FE,mesh,cq,dof_on_f,dof_on_elm,v_on_elm,dof_per_face,i,elm,rhs,time);
-
-      // Put Local RHS in correct location
-      jcntr = 0;
-      rowa = 0;
-      for(k=0;k<nblocks;k++) {
-        for(j=0;j<dof_per_face_blk[k];j++) {
-          row = dof_on_f[jcntr];
-          b->val[row+rowa]+=bLoc[jcntr];
-          jcntr++;
+#ifdef _OPENMP
+  // Color the faces so that the faces of one color share no DOF
+  iCSRmat colors;
+  INT threaded = block_color_elements(FE,1,&colors);
+
+#pragma omp parallel private(i,j,k,row) if(threaded)
+#endif
+  {
+    // Local data for each thread
+    block_fespace FEt;
+    copy_blockfespace_scratch(FE,&FEt,mesh->dim);
+    mesh_struct mesht;
+    copy_mesh_scratch(mesh,&mesht);
+
+    /* Loop over all Elements and build local rhs */
+    REAL* bLoc = (REAL *) calloc(dof_per_face,sizeof(REAL));
+
+    INT* dof_on_elm = (INT *) calloc(dof_per_elm,sizeof(INT));
+    INT* v_on_elm = (INT *) calloc(v_per_elm,sizeof(INT));
+    INT* dof_on_f = (INT *) calloc(dof_per_face,sizeof(INT));
+
+
+    INT jcntr,rowa,rowb;
+    INT elm;
+    //INT dof_on_f_shift;
+    //INT dof_on_elm_shift;
+
+    // Loop over boundary faces
+#ifdef _OPENMP
+    INT icol,ient;
+    for (icol=0; icol<colors.row; icol++) {
+#pragma omp for
+      for (ient=colors.IA[icol]; ient<colors.IA[icol+1]; ient++) {
+        i = colors.JA[ient];
+#else
+    {
+      for (i=0; i<mesh->nface; i++) {
+#endif
+        // Only grab faces on the flagged boundary
+        if(mesh->f_flag[i]>=flag0 && mesh->f_flag[i]<=flag1) {
+          // Zero out local vector
+          for(j=0;j<dof_per_face;j++) {
+            bLoc[j] = 0;
+          }
+
+          // Find DOF for given face
+          jcntr = 0;
+          for(k=0;k<nblocks;k++) {
+            rowa = FE->var_spaces[k]->f_dof->IA[i];
+            rowb = FE->var_spaces[k]->f_dof->IA[i+1];
+            for (j=rowa; j<rowb; j++) {
+              dof_on_f[jcntr] = FE->var_spaces[k]->f_dof->JA[j];
+              jcntr++;
+            }
+          }
+
+          // Find corresponding element associated with the face
+          // Assume only 1 matters (if on boundary)
+          rowa = f_el.IA[i];
+          elm = f_el.JA[rowa];
+
+          // Find DOF for given Element
+          // Note this is "local" ordering for the given FE space of the block
+          // Not global ordering of all DOF
+          jcntr = 0;
+          for(k=0;k<nblocks;k++) {
+            rowa = FE->var_spaces[k]->el_dof->IA[elm];
+            rowb = FE->var_spaces[k]->el_dof->IA[elm+1];
+            for (j=rowa; j<rowb; j++) {
+              dof_on_elm[jcntr] = FE->var_spaces[k]->el_dof->JA[j];
+              jcntr++;
+            }
+          }
+          //// DOF for given Face
+          //// then Find DOF on that element
+          //jcntr = 0;
+          //dof_on_f_shift = 0;
+          //dof_on_elm_shift = 0;
+          //for(k=0;k<nblocks;k++){
+          //  get_incidence_row(i,FE->var_spaces[k]->f_dof,dof_on_f+dof_on_f_shift);
+          //  dof_on_f_shift += dof_per_face_blk[k];
+          //
+          //  get_incidence_row(elm,FE->var_spaces[k]->el_dof,dof_on_elm+dof_on_elm_shift);
+          //  dof_on_elm_shift += FE->var_spaces[k]->dof_per_elm;
+          //}
+
+          // Find vertices for given element
+          get_incidence_row(elm,mesh->el_v,v_on_elm);
+
+          // Compute Local RHS for given element
+          (*local_rhs_assembly_face)(bLoc,old_sol,&FEt,&mesht,cq,dof_on_f,dof_on_elm,v_on_elm,dof_per_face,i,elm,rhs,time);
+
+          // Put Local RHS in correct location
+          jcntr = 0;
+          rowa = 0;
+          for(k=0;k<nblocks;k++) {
+            for(j=0;j<dof_per_face_blk[k];j++) {
+              row = dof_on_f[jcntr];
+              b->val[row+rowa]+=bLoc[jcntr];
+              jcntr++;
+            }
+            rowa += FE->var_spaces[k]->ndof;
+          }
         }
-        rowa += FE->var_spaces[k]->ndof;
       }
     }
+
+    if(dof_on_f) free(dof_on_f);
+    if(dof_on_elm) free(dof_on_elm);
+    if(v_on_elm) free(v_on_elm);
+    if(bLoc) free(bLoc);
+    free_blockfespace_scratch(&FEt);
+    free_mesh_scratch(&mesht);
   }
+#ifdef _OPENMP
+  icsr_free(&colors);
+#endif
 
-  if(dof_on_f) free(dof_on_f);
   if(dof_per_face_blk) free(dof_per_face_blk);
-  if(dof_on_elm) free(dof_on_elm);
-  if(v_on_elm) free(v_on_elm);
-  if(bLoc) free(bLoc);
   icsr_free(&f_el);
 
   return;
@@ -1813,36 +2583,74 @@ void assemble_global_Ned_GradH1_RHS(dvector *b,fespace *FE_H1,fespace *FE_Ned,me
   b->row = FE_H1->ndof;
   b->val = (REAL *) calloc(b->row,sizeof(REAL));
 
-  /* Loop over all Elements and build local rhs */
-  REAL* bLoc= (REAL *) calloc(v_per_elm,sizeof(REAL));
-
-  INT* ed_on_elm = (INT *) calloc(ed_per_elm,sizeof(INT));
-  INT* v_on_elm = (INT *) calloc(v_per_elm,sizeof(INT));
-  for (i=0; i<FE_H1->nelm; i++) {
+#ifdef _OPENMP
+  // Color the elements so that the elements of one color share no vertex
+  iCSRmat colors;
+  INT threaded = color_elements(mesh->nelm,1,&mesh->el_v,&colors);
+
+#pragma omp parallel private(i,j,row) if(threaded)
+#endif
+  {
+    // Local data for each thread
+    fespace FE_H1t,FE_Nedt;
+    copy_fespace_scratch(FE_H1,&FE_H1t,mesh->dim);
+    copy_fespace_scratch(FE_Ned,&FE_Nedt,mesh->dim);
+    mesh_struct mesht;
+    copy_mesh_scratch(mesh,&mesht);
+    qcoordinates cqt;
+    copy_qcoords_scratch(cq,&cqt);
+
+    /* Loop over all Elements and build local rhs */
+    REAL* bLoc= (REAL *) calloc(v_per_elm,sizeof(REAL));
+
+    INT* ed_on_elm = (INT *) calloc(ed_per_elm,sizeof(INT));
+    INT* v_on_elm = (INT *) calloc(v_per_elm,sizeof(INT));
+#ifdef _OPENMP
+    INT icol,ient;
+    for (icol=0; icol<colors.row; icol++) {
+#pragma omp for
+      for (ient=colors.IA[icol]; ient<colors.IA[icol+1]; ient++) {
+        i = colors.JA[ient];
+#else
+    {
+      for (i=0; i<mesh->nelm; i++) {
+#endif
+
+        for (j=0; j<v_per_elm; j++) {
+          bLoc[j]=0;
+        }
 
-    for (j=0; j<v_per_elm; j++) {
-      bLoc[j]=0;
-    }
+        // Find Edges for given Element
+        get_incidence_row(i,FE_Ned->el_dof,ed_on_elm);
 
-    // Find Edges for given Element
-    get_incidence_row(i,FE_Ned->el_dof,ed_on_elm);
+        // Find vertices for given Element
+        get_incidence_row(i,mesh->el_v,v_on_elm);
 
-    // Find vertices for given Element
-    get_incidence_row(i,mesh->el_v,v_on_elm);
+        // Quadrature nodes on the element
+        quad_elm(&cqt,mesh,cq->nq1d,i);
 
-    // Compute Local RHS for given Element
-    Ned_GradH1_RHS_local(bLoc,FE_H1,FE_Ned,mesh,cq,ed_on_elm,v_on_elm,i,u);
+        // Compute Local RHS for given Element
+        Ned_GradH1_RHS_local(bLoc,&FE_H1t,&FE_Nedt,&mesht,&cqt,ed_on_elm,v_on_elm,i,u);
 
-    // Loop over DOF and place in appropriate slot globally
-    for (j=0; j<v_per_elm; j++) {
-      row = v_on_elm[j];
-      b->val[row] += bLoc[j];
+        // Loop over DOF and place in appropriate slot globally
+        for (j=0; j<v_per_elm; j++) {
+          row = v_on_elm[j];
+          b->val[row] += bLoc[j];
+        }
+      }
     }
-  }
 
-  if(ed_on_elm) free(ed_on_elm);
-  if(v_on_elm) free(v_on_elm);
-  if(bLoc) free(bLoc);
+    if(ed_on_elm) free(ed_on_elm);
+    if(v_on_elm) free(v_on_elm);
+    if(bLoc) free(bLoc);
+    free_fespace_scratch(&FE_H1t);
+    free_fespace_scratch(&FE_Nedt);
+    free_mesh_scratch(&mesht);
+    free_qcoords(&cqt);
+  }
+#ifdef _OPENMP
+  icsr_free(&colors);
+#endif
 
   return;
 }
@@ -52,33 +52,35 @@ void assemble_DuDv_local(REAL* ALoc,fespace *FE,mesh_struct *mesh,qcoordinates *
 
   // Quadrature Weights and Nodes
   REAL w;
-  INT maxdim=4;
-  REAL qx[maxdim];
+  REAL *qx;
 
   // Stiffness Matrix Entry
   REAL kij;
   // Coefficient Value at Quadrature Nodes
   REAL coeff_val=0.0;
 
+  // Quadrature nodes of the element and coefficient at all of them
+  INT nq = cq->nq_per_elm;
+  REAL qxs[nq*dim];
+  REAL coeff_vals[nq];
+  evaluate_function_on_elm(coeff_vals,qxs,1,coeff,cq,dim,time,&(mesh->el_flag[elm]));
+
+  // Basis tabulated at the quadrature nodes (Lagrange spaces)
+  REAL dlam[(dim+1)*dim];
+  INT tab = tabulate_FEM_basis_elm(dlam,FE,cq,v_on_elm,mesh);
+
   // Vector Derivatives: Gradients (PX) and 3D Curls (3D Ned)
   if(FE->FEtype<20 || (FE->FEtype>=20 && FE->FEtype<30 && dim==3)) {
 
     //  Sum over quadrature points
     for (quad=0;quad<cq->nq_per_elm;quad++) {
-      qx[0] = cq->x[elm*cq->nq_per_elm+quad];
-      if(dim==2 || dim==3)
-        qx[1] = cq->y[elm*cq->nq_per_elm+quad];
-      if(dim==3)
-        qx[2] = cq->z[elm*cq->nq_per_elm+quad];
-      w = cq->w[elm*cq->nq_per_elm+quad];
-      if(coeff!=NULL) {
-        (*coeff)(&coeff_val,qx,time,&(mesh->el_flag[elm]));
-      } else {
-        coeff_val = 1.0;
-      }
+      qx = qxs+quad*dim;
+      w = cq->w[quad];
+      coeff_val = (coeff!=NULL) ? coeff_vals[quad] : 1.0;
 
       // Basis Functions and its derivatives if necessary
-      get_FEM_basis(FE->phi,FE->dphi,qx,v_on_elm,dof_on_elm,mesh,FE);
+      if(tab) get_FEM_basis_tabulated(FE->phi,FE->dphi,dlam,quad,FE,dim);
+      else get_FEM_basis(FE->phi,FE->dphi,qx,v_on_elm,dof_on_elm,mesh,FE);
 
       // Loop over Test Functions (Rows)
       for (test=0; test<FE->dof_per_elm;test++) {
@@ -95,20 +97,13 @@ void assemble_DuDv_local(REAL* ALoc,fespace *FE,mesh_struct *mesh,qcoordinates *
 
     //  Sum over quadrature points
     for (quad=0;quad<cq->nq_per_elm;quad++) {
-      qx[0] = cq->x[elm*cq->nq_per_elm+quad];
-      if(dim==2 || dim==3)
-        qx[1] = cq->y[elm*cq->nq_per_elm+quad];
-      if(dim==3)
-        qx[2] = cq->z[elm*cq->nq_per_elm+quad];
-      w = cq->w[elm*cq->nq_per_elm+quad];
-      if(coeff!=NULL) {
-        (*coeff)(&coeff_val,qx,time,&(mesh->el_flag[elm]));
-      } else {
-        coeff_val = 1.0;
-      }
+      qx = qxs+quad*dim;
+      w = cq->w[quad];
+      coeff_val = (coeff!=NULL) ? coeff_vals[quad] : 1.0;
 
       // Basis Functions and its derivatives if necessary
-      get_FEM_basis(FE->phi,FE->dphi,qx,v_on_elm,dof_on_elm,mesh,FE);
+      if(tab) get_FEM_basis_tabulated(FE->phi,FE->dphi,dlam,quad,FE,dim);
+      else get_FEM_basis(FE->phi,FE->dphi,qx,v_on_elm,dof_on_elm,mesh,FE);
 
       // Loop over Test Functions (Rows)
       for (test=0; test<FE->dof_per_elm;test++) {
@@ -125,6 +120,404 @@ void assemble_DuDv_local(REAL* ALoc,fespace *FE,mesh_struct *mesh,qcoordinates *
 }
 /******************************************************************************************************/
 
+/******************************************************************************************************/
+/*  Specialized DuDv kernels.
+ *
+ *  The kernels below have the number of DOF and derivative components as
+ *  compile-time constants, so that the loops over test and trial functions
+ *  can be fully unrolled.  They are selected once per assembly by
+ *  specialize_local_assembly() and compute the same local matrix as
+ *  assemble_DuDv_local().  They are used when the elements cannot be
+ *  batched (see local_assembly_batch_kind).
+ */
+
+/* Vertex coordinates of the element, stored as xv[k*dim+d] */
+static inline void dudv_vertex_coords(REAL *xv,mesh_struct *mesh,INT *v_on_elm,const INT dim)
+{
+  INT k;
+  coordinates *cv = mesh->cv;
+  for(k=0;k<=dim;k++) {
+    xv[k*dim] = cv->x[v_on_elm[k]];
+    if(dim>1) xv[k*dim+1] = cv->y[v_on_elm[k]];
+    if(dim>2) xv[k*dim+2] = cv->z[v_on_elm[k]];
+  }
+  return;
+}
+
+/* Elements whose derivative (gradient of P1, curl of Ned0, div of RT0) is
+ * constant on the element: A_ij = (sum_q w_q coeff(x_q)) * <D phi_j,D phi_i>.
+ * ndof DOF, nder derivative components; p1!=0 computes the gradients directly
+ * from the vertices, otherwise the basis is evaluated once per element. */
+static inline void dudv_constder_kernel(REAL* ALoc,fespace *FE,mesh_struct *mesh,qcoordinates *cq,INT *dof_on_elm,INT *v_on_elm,INT elm,void (*coeff)(REAL *,REAL *,REAL,void *),REAL time,const INT ndof,const INT nder,const INT p1)
+{
+  INT dim = mesh->dim;
+  INT quad,test,trial,idim;
+  INT nq = cq->nq_per_elm;
+  REAL qxs[nq*dim],coeff_vals[nq],xv[12],glam[12];
+  REAL csum=0.0,kij;
+  REAL *dphi = FE->dphi;
+
+  // Integral of the coefficient over the element
+  evaluate_function_on_elm(coeff_vals,qxs,1,coeff,cq,dim,time,&(mesh->el_flag[elm]));
+  for (quad=0;quad<nq;quad++) {
+    csum += cq->w[quad]*((coeff!=NULL) ? coeff_vals[quad] : 1.0);
+  }
+
+  // Constant derivatives of the basis
+  if(p1) {
+    dudv_vertex_coords(xv,mesh,v_on_elm,nder);
+    P1_basis_grad_elm(glam,xv,nder);
+    dphi = glam;
+  } else {
+    get_FEM_basis(FE->phi,FE->dphi,qxs,v_on_elm,dof_on_elm,mesh,FE);
+  }
+
+  for (test=0;test<ndof;test++) {
+    for (trial=test;trial<ndof;trial++) {
+      kij = 0.0;
+      for(idim=0;idim<nder;idim++)
+        kij += dphi[test*nder+idim]*dphi[trial*nder+idim];
+      kij *= csum;
+      ALoc[test*ndof+trial] += kij;
+      if(trial!=test) ALoc[trial*ndof+test] += kij;
+    }
+  }
+  return;
+}
+
+/* P2 Lagrange elements: the gradients are linear in the barycentric
+ * coordinates,
+ *   grad phi_i  = (4*lam_i-1)*grad lam_i                  (vertices)
+ *   grad phi_ij = 4*(lam_i*grad lam_j + lam_j*grad lam_i)  (edges i<j)
+ * with the edges in the same (lexicographic) order as PX_H1_basis. */
+static inline void dudv_p2_kernel(REAL* ALoc,fespace *FE,mesh_struct *mesh,qcoordinates *cq,INT *dof_on_elm,INT *v_on_elm,INT elm,void (*coeff)(REAL *,REAL *,REAL,void *),REAL time,const INT dim)
+{
+  const INT nv = dim+1;
+  const INT ndof = nv*(nv+1)/2;
+  INT quad,test,trial,idim,i,j,m;
+  INT nq = cq->nq_per_elm;
+  REAL qxs[nq*dim],coeff_vals[nq],xv[12],glam[12],lam[4],dphi[30];
+  REAL *qx;
+  REAL w,kij;
+
+  dudv_vertex_coords(xv,mesh,v_on_elm,dim);
+  P1_basis_grad_elm(glam,xv,dim);
+  evaluate_function_on_elm(coeff_vals,qxs,1,coeff,cq,dim,time,&(mesh->el_flag[elm]));
+
+  for (quad=0;quad<nq;quad++) {
+    qx = qxs+quad*dim;
+    w = cq->w[quad];
+    if(coeff!=NULL) w *= coeff_vals[quad];
+
+    // Barycentric coordinates of the quadrature node
+    lam[0] = 1.0;
+    for(i=1;i<nv;i++) {
+      lam[i] = 0.0;
+      for(idim=0;idim<dim;idim++)
+        lam[i] += glam[i*dim+idim]*(qx[idim]-xv[idim]);
+      lam[0] -= lam[i];
+    }
+
+    // Gradients of the basis
+    for(i=0;i<nv;i++)
+      for(idim=0;idim<dim;idim++)
+        dphi[i*dim+idim] = (4.0*lam[i]-1.0)*glam[i*dim+idim];
+    m = nv;
+    for(i=0;i<nv;i++) {
+      for(j=i+1;j<nv;j++) {
+        for(idim=0;idim<dim;idim++)
+          dphi[m*dim+idim] = 4.0*(lam[i]*glam[j*dim+idim]+lam[j]*glam[i*dim+idim]);
+        m++;
+      }
+    }
+
+    for (test=0;test<ndof;test++) {
+      for (trial=test;trial<ndof;trial++) {
+        kij = 0.0;
+        for(idim=0;idim<dim;idim++)
+          kij += dphi[test*dim+idim]*dphi[trial*dim+idim];
+        kij *= w;
+        ALoc[test*ndof+trial] += kij;
+        if(trial!=test) ALoc[trial*ndof+test] += kij;
+      }
+    }
+  }
+  return;
+}
+
+#define DUDV_SPECIALIZE(name,kernel,...)                                \
+  static void name(REAL* ALoc,fespace *FE,mesh_struct *mesh,qcoordinates *cq,INT *dof_on_elm,INT *v_on_elm,INT elm,void (*coeff)(REAL *,REAL *,REAL,void *),REAL time) \
+  { kernel(ALoc,FE,mesh,cq,dof_on_elm,v_on_elm,elm,coeff,time,__VA_ARGS__); }
+
+DUDV_SPECIALIZE(assemble_DuDv_local_P1_1D,dudv_constder_kernel,2,1,1)
+DUDV_SPECIALIZE(assemble_DuDv_local_P1_2D,dudv_constder_kernel,3,2,1)
+DUDV_SPECIALIZE(assemble_DuDv_local_P1_3D,dudv_constder_kernel,4,3,1)
+DUDV_SPECIALIZE(assemble_DuDv_local_P2_1D,dudv_p2_kernel,1)
+DUDV_SPECIALIZE(assemble_DuDv_local_P2_2D,dudv_p2_kernel,2)
+DUDV_SPECIALIZE(assemble_DuDv_local_P2_3D,dudv_p2_kernel,3)
+DUDV_SPECIALIZE(assemble_DuDv_local_Ned_2D,dudv_constder_kernel,3,1,0)
+DUDV_SPECIALIZE(assemble_DuDv_local_Ned_3D,dudv_constder_kernel,6,3,0)
+DUDV_SPECIALIZE(assemble_DuDv_local_RT_2D,dudv_constder_kernel,3,1,0)
+DUDV_SPECIALIZE(assemble_DuDv_local_RT_3D,dudv_constder_kernel,4,1,0)
+
+#undef DUDV_SPECIALIZE
+/******************************************************************************************************/
+
+/******************************************************************************************************/
+/*!
+ * \fn void specialize_local_assembly(void (**local_assembly)(REAL *,fespace *,mesh_struct *,qcoordinates *,INT *,INT *,INT,void (*)(REAL *,REAL *,REAL,void *),REAL),fespace *FE,INT dim)
+ *
+ * \brief Replaces a generic local assembly routine by a kernel specialized for
+ *        the element type and dimension, if one exists.  Meant to be called
+ *        once per global assembly, before the loop over elements.
+ *
+ *        Currently specialized: assemble_DuDv_local for P1 and P2 in 1D-3D,
+ *        lowest order Nedelec (curl-curl) and Raviart-Thomas (div-div) in 2D and 3D.
+ *
+ * \param local_assembly  Local assembly routine (replaced on output)
+ * \param FE              FE Space
+ * \param dim             Dimension of the mesh
+ *
+ */
+void specialize_local_assembly(void (**local_assembly)(REAL *,fespace *,mesh_struct *,qcoordinates *,INT *,INT *,INT,void (*)(REAL *,REAL *,REAL,void *),REAL),fespace *FE,INT dim)
+{
+  if(*local_assembly!=assemble_DuDv_local)
+    return;
+
+  if(FE->FEtype==1 && FE->scal_or_vec==0 && FE->dof_per_elm==dim+1) {
+    if(dim==1) *local_assembly = assemble_DuDv_local_P1_1D;
+    else if(dim==2) *local_assembly = assemble_DuDv_local_P1_2D;
+    else if(dim==3) *local_assembly = assemble_DuDv_local_P1_3D;
+  } else if(FE->FEtype==2 && FE->scal_or_vec==0 && FE->dof_per_elm==(dim+1)*(dim+2)/2) {
+    if(dim==1) *local_assembly = assemble_DuDv_local_P2_1D;
+    else if(dim==2) *local_assembly = assemble_DuDv_local_P2_2D;
+    else if(dim==3) *local_assembly = assemble_DuDv_local_P2_3D;
+  } else if(FE->FEtype==20) {
+    if(dim==2 && FE->dof_per_elm==3) *local_assembly = assemble_DuDv_local_Ned_2D;
+    else if(dim==3 && FE->dof_per_elm==6) *local_assembly = assemble_DuDv_local_Ned_3D;
+  } else if(FE->FEtype==30) {
+    if(dim==2 && FE->dof_per_elm==3) *local_assembly = assemble_DuDv_local_RT_2D;
+    else if(dim==3 && FE->dof_per_elm==4) *local_assembly = assemble_DuDv_local_RT_3D;
+  }
+  return;
+}
+/******************************************************************************************************/
+
+/******************************************************************************************************/
+/*!
+ * \fn INT local_assembly_batch_kind(void (*local_assembly)(REAL *,fespace *,mesh_struct *,qcoordinates *,INT *,INT *,INT,void (*)(REAL *,REAL *,REAL,void *),REAL),fespace *FE,INT dim)
+ *
+ * \brief Tells whether the local matrices of local_assembly can be computed
+ *        LOCAL_BATCH elements at a time by assemble_local_batch.
+ *
+ * \param local_assembly  Local assembly routine
+ * \param FE              FE Space
+ * \param dim             Dimension of the mesh
+ *
+ * \return                1 for assemble_DuDv_local, 2 for assemble_mass_local, with
+ *                        scalar Lagrange elements in 1D-3D; 0 otherwise
+ *
+ */
+INT local_assembly_batch_kind(void (*local_assembly)(REAL *,fespace *,mesh_struct *,qcoordinates *,INT *,INT *,INT,void (*)(REAL *,REAL *,REAL,void *),REAL),fespace *FE,INT dim)
+{
+  if(FE->scal_or_vec || FE->FEtype<0 || FE->FEtype>=10 || dim<1 || dim>3)
+    return 0;
+  if(local_assembly==assemble_DuDv_local && FE->FEtype>0) return 1;
+  if(local_assembly==assemble_mass_local) return 2;
+  return 0;
+}
+/******************************************************************************************************/
+
+/* Gradients of the P1 basis on LOCAL_BATCH simplices, stored by components
+ * across the batch: glam[(k*dim+d)*LOCAL_BATCH+e] is component d of the
+ * gradient of lam_k on simplex e (same formulas as P1_basis_grad_elm) */
+static inline void p1_grad_batch(REAL *glam,REAL *xv,const INT dim)
+{
+  const INT B = LOCAL_BATCH;
+  INT e;
+  REAL a0,a1,a2,b0,b1,b2,c0,c1,c2,g0,g1,g2,h0,h1,h2,f0,f1,f2,det;
+  if(dim==1) {
+    for(e=0;e<B;e++) {
+      glam[B+e] = 1.0/(xv[B+e]-xv[e]);
+      glam[e] = -glam[B+e];
+    }
+  } else if(dim==2) {
+    for(e=0;e<B;e++) {
+      a0 = xv[2*B+e]-xv[e]; a1 = xv[3*B+e]-xv[B+e];
+      b0 = xv[4*B+e]-xv[e]; b1 = xv[5*B+e]-xv[B+e];
+      det = 1.0/(a0*b1-b0*a1);
+      glam[2*B+e] =  b1*det; glam[3*B+e] = -b0*det;
+      glam[4*B+e] = -a1*det; glam[5*B+e] =  a0*det;
+      glam[e]   = -glam[2*B+e]-glam[4*B+e];
+      glam[B+e] = -glam[3*B+e]-glam[5*B+e];
+    }
+  } else {
+    for(e=0;e<B;e++) {
+      a0 = xv[3*B+e]-xv[e]; a1 = xv[4*B+e]-xv[B+e];  a2 = xv[5*B+e]-xv[2*B+e];
+      b0 = xv[6*B+e]-xv[e]; b1 = xv[7*B+e]-xv[B+e];  b2 = xv[8*B+e]-xv[2*B+e];
+      c0 = xv[9*B+e]-xv[e]; c1 = xv[10*B+e]-xv[B+e]; c2 = xv[11*B+e]-xv[2*B+e];
+      // rows of the inverse of [a b c] are the cross products over det
+      g0 = b1*c2-b2*c1; g1 = b2*c0-b0*c2; g2 = b0*c1-b1*c0;
+      det = 1.0/(a0*g0+a1*g1+a2*g2);
+      g0 *= det; g1 *= det; g2 *= det;
+      h0 = (c1*a2-c2*a1)*det; h1 = (c2*a0-c0*a2)*det; h2 = (c0*a1-c1*a0)*det;
+      f0 = (a1*b2-a2*b1)*det; f1 = (a2*b0-a0*b2)*det; f2 = (a0*b1-a1*b0)*det;
+      glam[3*B+e] = g0; glam[4*B+e]  = g1; glam[5*B+e]  = g2;
+      glam[6*B+e] = h0; glam[7*B+e]  = h1; glam[8*B+e]  = h2;
+      glam[9*B+e] = f0; glam[10*B+e] = f1; glam[11*B+e] = f2;
+      glam[e] = -g0-h0-f0; glam[B+e] = -g1-h1-f1; glam[2*B+e] = -g2-h2-f2;
+    }
+  }
+  return;
+}
+
+/******************************************************************************************************/
+/*!
+ * \fn void assemble_local_batch(REAL* ALocs,INT nb,INT *elms,INT kind,fespace *FE,mesh_struct *mesh,qcoordinates *cq,void (*coeff)(REAL *,REAL *,REAL,void *),REAL time)
+ *
+ * \brief Computes the local matrices of up to LOCAL_BATCH elements at once:
+ *        coeff*<Du,Dv> (kind 1) or coeff*<u,v> (kind 2) for scalar Lagrange
+ *        elements (see local_assembly_batch_kind).  Same matrices as
+ *        assemble_DuDv_local and assemble_mass_local.
+ *
+ *        The vertex coordinates, P1 gradients, basis gradients, quadrature
+ *        weights and local matrices are stored by components across the batch,
+ *        so the innermost loops run over the elements and vectorize.  The basis
+ *        is tabulated on the reference element (tabulate_FEM_basis_elm) and the
+ *        coefficient is evaluated at the quadrature nodes of all the elements
+ *        with the same flag in one call (evaluate_function_batch).
+ *
+ * \param nb            Number of elements in the batch (1,...,LOCAL_BATCH)
+ * \param elms          Elements of the batch
+ * \param kind          1 for <Du,Dv>, 2 for <u,v>
+ * \param FE            FE Space
+ * \param mesh          Mesh Data
+ * \param cq            Quadrature Nodes (scratch, overwritten)
+ * \param coeff         Function that gives coefficient (NULL for 1)
+ * \param time          Physical Time if time dependent
+ *
+ * \return ALocs        Local matrices, ALocs[e*dof_per_elm^2 + test*dof_per_elm + trial]
+ *                      on element elms[e] (Full Matrices)
+ *
+ */
+void assemble_local_batch(REAL* ALocs,INT nb,INT *elms,INT kind,fespace *FE,mesh_struct *mesh,qcoordinates *cq,void (*coeff)(REAL *,REAL *,REAL,void *),REAL time)
+{
+  const INT B = LOCAL_BATCH;
+  INT dim = mesh->dim;
+  INT nd = FE->dof_per_elm;
+  INT nq = cq->nq_per_elm;
+  INT e,e0,q,i,j,k,d,nqk;
+  INT el[LOCAL_BATCH];
+  INT *v_on_elm;
+  REAL xv[(dim+1)*dim*B],glam[(dim+1)*dim*B],dphi[nd*dim*B],ALocB[nd*nd*B];
+  REAL qxs[B*nq*dim],coeff_vals[B*nq],wc[nq*B],s[LOCAL_BATCH];
+  REAL *lam,*dpref,*pref,lam0,c;
+  coordinates* cv = mesh->cv;
+  REAL* cvx[3] = {cv->x,cv->y,cv->z};
+
+  // Reference rule and basis (computed once, kept in cq and FE)
+  v_on_elm = mesh->el_v->JA + mesh->el_v->IA[elms[0]];
+  quad_elm(cq,mesh,cq->nq1d,elms[0]);
+  tabulate_FEM_basis_elm(glam,FE,cq,v_on_elm,mesh);
+
+  // Elements of the batch, the last one repeated to fill it
+  for(e=0;e<B;e++) el[e] = elms[MIN(e,nb-1)];
+
+  // Vertex coordinates and P1 gradients
+  for(k=0;k<=dim;k++) {
+    for(e=0;e<B;e++) {
+      v_on_elm = mesh->el_v->JA + mesh->el_v->IA[el[e]];
+      for(d=0;d<dim;d++) xv[(k*dim+d)*B+e] = cvx[d][v_on_elm[k]];
+    }
+  }
+  if(kind==1) p1_grad_batch(glam,xv,dim);
+
+  // Quadrature nodes (x(q0) y(q0) z(q0) x(q1) ... element by element) and weights
+  for(e=0;e<nb;e++) {
+    for(q=0;q<nq;q++) {
+      lam = cq->ref_x + q*dim;
+      lam0 = 1.0;
+      for(k=0;k<dim;k++) lam0 -= lam[k];
+      for(d=0;d<dim;d++) {
+        c = xv[d*B+e]*lam0;
+        for(k=0;k<dim;k++) c += xv[((k+1)*dim+d)*B+e]*lam[k];
+        qxs[(e*nq+q)*dim+d] = c;
+      }
+    }
+  }
+  for(q=0;q<nq;q++)
+    for(e=0;e<B;e++) wc[q*B+e] = mesh->el_vol[el[e]]*cq->ref_w[q];
+
+  // Coefficient at the quadrature nodes, one call per run of elements with the same flag
+  if(coeff!=NULL) {
+    for(e0=0;e0<nb;e0=e) {
+      e = e0+1;
+      if(mesh->el_flag!=NULL)
+        while(e<nb && mesh->el_flag[el[e]]==mesh->el_flag[el[e0]]) e++;
+      else
+        e = nb;
+      evaluate_function_batch(coeff_vals+e0*nq,1,coeff,qxs+e0*nq*dim,(e-e0)*nq,dim,time,
+                              (mesh->el_flag!=NULL) ? &(mesh->el_flag[el[e0]]) : NULL);
+    }
+    for(q=0;q<nq;q++)
+      for(e=0;e<B;e++) wc[q*B+e] *= coeff_vals[MIN(e,nb-1)*nq+q];
+  }
+
+  // P1 gradients are constant: sum the weights
+  nqk = nq;
+  if(kind==1 && FE->FEtype==1) {
+    for(q=1;q<nq;q++)
+      for(e=0;e<B;e++) wc[e] += wc[q*B+e];
+    nqk = 1;
+  }
+
+  for(i=0;i<nd*nd*B;i++) ALocB[i] = 0.0;
+  for(q=0;q<nqk;q++) {
+    if(kind==1) {
+      // grad(phi_i) = sum_j d(phi_i)/d(xr_j) * grad(lam_{j+1})
+      dpref = FE->dphi_ref + q*nd*dim;
+      for(i=0;i<nd;i++) {
+        for(d=0;d<dim;d++) {
+          for(e=0;e<B;e++) s[e] = 0.0;
+          for(j=0;j<dim;j++) {
+            c = dpref[i*dim+j];
+            for(e=0;e<B;e++) s[e] += c*glam[((j+1)*dim+d)*B+e];
+          }
+          for(e=0;e<B;e++) dphi[(i*dim+d)*B+e] = s[e];
+        }
+      }
+      // upper triangle of the symmetric matrix
+      for(i=0;i<nd;i++) {
+        for(j=i;j<nd;j++) {
+          for(e=0;e<B;e++) s[e] = 0.0;
+          for(d=0;d<dim;d++)
+            for(e=0;e<B;e++) s[e] += dphi[(i*dim+d)*B+e]*dphi[(j*dim+d)*B+e];
+          for(e=0;e<B;e++) ALocB[(i*nd+j)*B+e] += wc[q*B+e]*s[e];
+        }
+      }
+    } else {
+      pref = FE->phi_ref + q*nd;
+      for(i=0;i<nd;i++) {
+        for(j=i;j<nd;j++) {
+          c = pref[i]*pref[j];
+          for(e=0;e<B;e++) ALocB[(i*nd+j)*B+e] += c*wc[q*B+e];
+        }
+      }
+    }
+  }
+
+  for(e=0;e<nb;e++) {
+    for(i=0;i<nd;i++) {
+      for(j=i;j<nd;j++) {
+        ALocs[e*nd*nd+i*nd+j] = ALocB[(i*nd+j)*B+e];
+        ALocs[e*nd*nd+j*nd+i] = ALocB[(i*nd+j)*B+e];
+      }
+    }
+  }
+  return;
+}
+/******************************************************************************************************/
+
 /******************************************************************************************************/
 /*!
  * \fn void assemble_mass_local(REAL* MLoc,fespace *FE,mesh_struct *mesh,qcoordinates *cq,INT *dof_on_elm,INT *v_on_elm,INT elm,void (*coeff)(REAL *,REAL *,REAL,void *),REAL time)
@@ -163,33 +556,35 @@ void assemble_mass_local(REAL* MLoc,fespace *FE,mesh_struct *mesh,qcoordinates *
 
   // Quadrature Weights and Nodes
   REAL w;
-  INT maxdim=4;
-  REAL qx[maxdim];
+  REAL *qx;
 
   // Stiffness Matrix Entry
   REAL kij;
   // Coefficient Value at Quadrature Nodes
   REAL coeff_val=0.0;
 
+  // Quadrature nodes of the element and coefficient at all of them
+  INT nq = cq->nq_per_elm;
+  REAL qxs[nq*dim];
+  REAL coeff_vals[nq];
+  evaluate_function_on_elm(coeff_vals,qxs,1,coeff,cq,dim,time,&(mesh->el_flag[elm]));
+
+  // Basis tabulated at the quadrature nodes (Lagrange spaces)
+  REAL dlam[(dim+1)*dim];
+  INT tab = tabulate_FEM_basis_elm(dlam,FE,cq,v_on_elm,mesh);
+
   // Vector Functions
   if(FE->scal_or_vec) {
 
     //  Sum over quadrature points
     for (quad=0;quad<cq->nq_per_elm;quad++) {
-      qx[0] = cq->x[elm*cq->nq_per_elm+quad];
-      if(dim==2 || dim==3)
-        qx[1] = cq->y[elm*cq->nq_per_elm+quad];
-      if(dim==3)
-        qx[2] = cq->z[elm*cq->nq_per_elm+quad];
-      w = cq->w[elm*cq->nq_per_elm+quad];
-      if(coeff!=NULL) {
-        (*coeff)(&coeff_val,qx,time,&(mesh->el_flag[elm]));
-      } else {
-        coeff_val = 1.0;
-      }
+      qx = qxs+quad*dim;
+      w = cq->w[quad];
+      coeff_val = (coeff!=NULL) ? coeff_vals[quad] : 1.0;
 
       // Basis Functions and its derivatives if necessary
-      get_FEM_basis(FE->phi,FE->dphi,qx,v_on_elm,dof_on_elm,mesh,FE);
+      if(tab) get_FEM_basis_tabulated(FE->phi,NULL,dlam,quad,FE,dim);
+      else get_FEM_basis(FE->phi,FE->dphi,qx,v_on_elm,dof_on_elm,mesh,FE);
 
       // Loop over Test Functions (Rows)
       for (test=0; test<FE->dof_per_elm;test++) {
@@ -206,20 +601,13 @@ void assemble_mass_local(REAL* MLoc,fespace *FE,mesh_struct *mesh,qcoordinates *
 
     //  Sum over quadrature points
     for (quad=0;quad<cq->nq_per_elm;quad++) {
-      qx[0] = cq->x[elm*cq->nq_per_elm+quad];
-      if(dim==2 || dim==3)
-        qx[1] = cq->y[elm*cq->nq_per_elm+quad];
-      if(dim==3)
-        qx[2] = cq->z[elm*cq->nq_per_elm+quad];
-      w = cq->w[elm*cq->nq_per_elm+quad];
-      if(coeff!=NULL) {
-        (*coeff)(&coeff_val,qx,time,&(mesh->el_flag[elm]));
-      } else {
-        coeff_val = 1.0;
-      }
+      qx = qxs+quad*dim;
+      w = cq->w[quad];
+      coeff_val = (coeff!=NULL) ? coeff_vals[quad] : 1.0;
 
       // Basis Functions and its derivatives if necessary
-      get_FEM_basis(FE->phi,FE->dphi,qx,v_on_elm,dof_on_elm,mesh,FE);
+      if(tab) get_FEM_basis_tabulated(FE->phi,NULL,dlam,quad,FE,dim);
+      else get_FEM_basis(FE->phi,FE->dphi,qx,v_on_elm,dof_on_elm,mesh,FE);
 
       // Loop over Test Functions (Rows)
       for (test=0; test<FE->dof_per_elm;test++) {
@@ -279,26 +667,28 @@ void assemble_DuDvplusmass_local(REAL* ALoc,fespace *FE,mesh_struct *mesh,qcoord
 
   // Quadrature Weights and Nodes
   REAL w;
-  INT maxdim=4;
-  REAL qx[maxdim];
+  REAL *qx;
   // Stiffness Matrix Entry
   REAL kij;
   // Coefficient Value at Quadrature Nodes
   REAL coeff_val[2];
 
+  // Quadrature nodes of the element and coefficient at all of them
+  INT nq = cq->nq_per_elm;
+  REAL qxs[nq*dim];
+  REAL coeff_vals[nq*2];
+  evaluate_function_on_elm(coeff_vals,qxs,2,coeff,cq,dim,time,&(mesh->el_flag[elm]));
+
   // Scalar Functions and Vector Derivatives: PX
   if(FE->FEtype<20) {
 
     //  Sum over quadrature points
     for (quad=0;quad<cq->nq_per_elm;quad++) {
-      qx[0] = cq->x[elm*cq->nq_per_elm+quad];
-      if(dim==2 || dim==3)
-        qx[1] = cq->y[elm*cq->nq_per_elm+quad];
-      if(dim==3)
-        qx[2] = cq->z[elm*cq->nq_per_elm+quad];
-      w = cq->w[elm*cq->nq_per_elm+quad];
+      qx = qxs+quad*dim;
+      w = cq->w[quad];
       if(coeff!=NULL) {
-        (*coeff)(coeff_val,qx,time,&(mesh->el_flag[elm]));
+        coeff_val[0] = coeff_vals[2*quad];
+        coeff_val[1] = coeff_vals[2*quad+1];
       } else {
         coeff_val[0] = 1.0;
         coeff_val[1] = 1.0;
@@ -322,14 +712,11 @@ void assemble_DuDvplusmass_local(REAL* ALoc,fespace *FE,mesh_struct *mesh,qcoord
 
     //  Sum over quadrature points
     for (quad=0;quad<cq->nq_per_elm;quad++) {
-      qx[0] = cq->x[elm*cq->nq_per_elm+quad];
-      if(dim==2 || dim==3)
-        qx[1] = cq->y[elm*cq->nq_per_elm+quad];
-      if(dim==3)
-        qx[2] = cq->z[elm*cq->nq_per_elm+quad];
-      w = cq->w[elm*cq->nq_per_elm+quad];
+      qx = qxs+quad*dim;
+      w = cq->w[quad];
       if(coeff!=NULL) {
-        (*coeff)(coeff_val,qx,time,&(mesh->el_flag[elm]));
+        coeff_val[0] = coeff_vals[2*quad];
+        coeff_val[1] = coeff_vals[2*quad+1];
       } else {
         coeff_val[0] = 1.0;
         coeff_val[1] = 1.0;
@@ -362,12 +749,11 @@ void assemble_DuDvplusmass_local(REAL* ALoc,fespace *FE,mesh_struct *mesh,qcoord
 
     //  Sum over quadrature points
     for (quad=0;quad<cq->nq_per_elm;quad++) {
-      qx[0] = cq->x[elm*cq->nq_per_elm+quad];
-      qx[1] = cq->y[elm*cq->nq_per_elm+quad];
-      if(dim==3) qx[2] = cq->z[elm*cq->nq_per_elm+quad];
-      w = cq->w[elm*cq->nq_per_elm+quad];
+      qx = qxs+quad*dim;
+      w = cq->w[quad];
       if(coeff!=NULL) {
-        (*coeff)(coeff_val,qx,time,&(mesh->el_flag[elm]));
+        coeff_val[0] = coeff_vals[2*quad];
+        coeff_val[1] = coeff_vals[2*quad+1];
       } else {
         coeff_val[0] = 1.0;
         coeff_val[1] = 1.0;
@@ -466,10 +852,10 @@ void assemble_symmetricDuDv_local(REAL* ALoc, block_fespace *FE, mesh_struct *me
 
   // Sum over quadrature points
   for (quad=0;quad<cq->nq_per_elm;quad++) {
-    qx[0] = cq->x[elm*cq->nq_per_elm+quad];
-    qx[1] = cq->y[elm*cq->nq_per_elm+quad];
-    if(mesh->dim==3) qx[2] = cq->z[elm*cq->nq_per_elm+quad];
-    w = cq->w[elm*cq->nq_per_elm+quad];
+    qx[0] = cq->x[quad];
+    qx[1] = cq->y[quad];
+    if(mesh->dim==3) qx[2] = cq->z[quad];
+    w = cq->w[quad];
 
     //  Get the Basis Functions at each quadrature node
     local_dof_on_elm = dof_on_elm;
@@ -658,6 +1044,8 @@ void boundary_mass_local(REAL* MLoc,dvector* old_sol,fespace *FE,mesh_struct *me
   INT j,quad,test,trial,doft,dofb;
 
   // Quadrature Weights and Nodes
+  qcoordinates *cq_face = allocateqcoords_bdry(cq->nq1d,1,dim,2);
+  quad_face(cq_face,mesh,cq->nq1d,face);
   REAL w;
   INT maxdim=4;
   REAL qx[maxdim];
@@ -682,11 +1070,11 @@ void boundary_mass_local(REAL* MLoc,dvector* old_sol,fespace *FE,mesh_struct *me
     }
 
     //  Sum over midpoints of edges
-    for (quad=0;quad<cq->nq_per_elm;quad++) {
-      qx[0] = cq->x[face*cq->nq_per_elm+quad];
-      qx[1] = cq->y[face*cq->nq_per_elm+quad];
-      if(dim==3) qx[2] = cq->z[face*cq->nq_per_elm+quad];
-      w = cq->w[face*cq->nq_per_elm+quad];
+    for (quad=0;quad<cq_face->nq_per_elm;quad++) {
+      qx[0] = cq_face->x[quad];
+      qx[1] = cq_face->y[quad];
+      if(dim==3) qx[2] = cq_face->z[quad];
+      w = cq_face->w[quad];
 
       if(coeff!=NULL) {
         (*coeff)(&coeff_val,qx,time,&(mesh->f_flag[face]));
@@ -728,11 +1116,11 @@ void boundary_mass_local(REAL* MLoc,dvector* old_sol,fespace *FE,mesh_struct *me
     }
 
     //  Sum over quadrature points
-    for (quad=0;quad<cq->nq_per_elm;quad++) {
-      qx[0] = cq->x[face*cq->nq_per_elm+quad];
-      qx[1] = cq->y[face*cq->nq_per_elm+quad];
-      if(dim==3) qx[2] = cq->z[face*cq->nq_per_elm+quad];
-      w = cq->w[face*cq->nq_per_elm+quad];
+    for (quad=0;quad<cq_face->nq_per_elm;quad++) {
+      qx[0] = cq_face->x[quad];
+      qx[1] = cq_face->y[quad];
+      if(dim==3) qx[2] = cq_face->z[quad];
+      w = cq_face->w[quad];
 
       if(coeff!=NULL) {
         (*coeff)(&coeff_val,qx,time,&(mesh->f_flag[face]));
@@ -774,11 +1162,11 @@ void boundary_mass_local(REAL* MLoc,dvector* old_sol,fespace *FE,mesh_struct *me
     }
 
     //  Sum over quadrature points
-    for (quad=0;quad<cq->nq_per_elm;quad++) {
-      qx[0] = cq->x[face*cq->nq_per_elm+quad];
-      qx[1] = cq->y[face*cq->nq_per_elm+quad];
-      if(dim==3) qx[2] = cq->z[face*cq->nq_per_elm+quad];
-      w = cq->w[face*cq->nq_per_elm+quad];
+    for (quad=0;quad<cq_face->nq_per_elm;quad++) {
+      qx[0] = cq_face->x[quad];
+      qx[1] = cq_face->y[quad];
+      if(dim==3) qx[2] = cq_face->z[quad];
+      w = cq_face->w[quad];
 
       if(coeff!=NULL) {
         (*coeff)(&coeff_val,qx,time,&(mesh->f_flag[face]));
@@ -813,6 +1201,9 @@ void boundary_mass_local(REAL* MLoc,dvector* old_sol,fespace *FE,mesh_struct *me
     check_error(status, __FUNCTION__);
   }
 
+  free_qcoords(cq_face);
+  free(cq_face);
+
   return;
 }
 /******************************************************************************************************/
@@ -850,27 +1241,34 @@ void FEM_RHS_Local(REAL* bLoc,fespace *FE,mesh_struct *mesh,qcoordinates *cq,INT
 
   // Quadrature Weights and Nodes
   REAL w;
-  INT maxdim=4;
-  REAL qx[maxdim];
+  REAL *qx;
 
   // Right-hand side function at Quadrature Nodes
   REAL rhs_val_scalar;
-  REAL rhs_val_vector[dim];
+  REAL *rhs_val_vector;
+  INT ncomp = FE->scal_or_vec ? dim : 1;
+
+  // Quadrature nodes of the element and right hand side at all of them
+  INT nq = cq->nq_per_elm;
+  REAL qxs[nq*dim];
+  REAL rhs_vals[nq*ncomp];
+  evaluate_function_on_elm(rhs_vals,qxs,ncomp,rhs,cq,dim,time,&(mesh->el_flag[elm]));
+
+  // Basis tabulated at the quadrature nodes (Lagrange spaces)
+  REAL dlam[(dim+1)*dim];
+  INT tab = tabulate_FEM_basis_elm(dlam,FE,cq,v_on_elm,mesh);
 
   if(FE->scal_or_vec==0) { // Scalar Functions
 
     //  Sum over quadrature points
     for (quad=0;quad<cq->nq_per_elm;quad++) {
-      qx[0] = cq->x[elm*cq->nq_per_elm+quad];
-      if(dim==2 || dim==3)
-        qx[1] = cq->y[elm*cq->nq_per_elm+quad];
-      if(dim==3)
-        qx[2] = cq->z[elm*cq->nq_per_elm+quad];
-      w = cq->w[elm*cq->nq_per_elm+quad];
-      (*rhs)(&rhs_val_scalar,qx,time,&(mesh->el_flag[elm]));
+      qx = qxs+quad*dim;
+      w = cq->w[quad];
+      rhs_val_scalar = rhs_vals[quad];
 
       //  Get the Basis Functions at each quadrature node
-      get_FEM_basis(FE->phi,FE->dphi,qx,v_on_elm,dof_on_elm,mesh,FE);
+      if(tab) get_FEM_basis_tabulated(FE->phi,NULL,dlam,quad,FE,dim);
+      else get_FEM_basis(FE->phi,FE->dphi,qx,v_on_elm,dof_on_elm,mesh,FE);
 
       // Loop over test functions and integrate rhs
       for (test=0; test<FE->dof_per_elm;test++) {
@@ -881,14 +1279,13 @@ void FEM_RHS_Local(REAL* bLoc,fespace *FE,mesh_struct *mesh,qcoordinates *cq,INT
 
     //  Sum over quadrature points
     for (quad=0;quad<cq->nq_per_elm;quad++) {
-      qx[0] = cq->x[elm*cq->nq_per_elm+quad];
-      qx[1] = cq->y[elm*cq->nq_per_elm+quad];
-      if(dim==3) qx[2] = cq->z[elm*cq->nq_per_elm+quad];
-      w = cq->w[elm*cq->nq_per_elm+quad];
-      (*rhs)(rhs_val_vector,qx,time,&(mesh->el_flag[elm]));
+      qx = qxs+quad*dim;
+      w = cq->w[quad];
+      rhs_val_vector = rhs_vals+quad*dim;
 
       //  Get the Basis Functions at each quadrature node
-      get_FEM_basis(FE->phi,FE->dphi,qx,v_on_elm,dof_on_elm,mesh,FE);
+      if(tab) get_FEM_basis_tabulated(FE->phi,NULL,dlam,quad,FE,dim);
+      else get_FEM_basis(FE->phi,FE->dphi,qx,v_on_elm,dof_on_elm,mesh,FE);
 
       // Loop over test functions and integrate rhs
       for (test=0; test<FE->dof_per_elm;test++) {
@@ -954,10 +1351,10 @@ void FEM_Block_RHS_Local(REAL* bLoc,block_fespace *FE,mesh_struct *mesh,qcoordin
 
   //  Sum over quadrature points
   for (quad=0;quad<cq->nq_per_elm;quad++) {
-    qx[0] = cq->x[elm*cq->nq_per_elm+quad];
-    qx[1] = cq->y[elm*cq->nq_per_elm+quad];
-    if(mesh->dim==3) qx[2] = cq->z[elm*cq->nq_per_elm+quad];
-    w = cq->w[elm*cq->nq_per_elm+quad];
+    qx[0] = cq->x[quad];
+    qx[1] = cq->y[quad];
+    if(mesh->dim==3) qx[2] = cq->z[quad];
+    w = cq->w[quad];
     (*rhs)(rhs_val,qx,time,&(mesh->el_flag[elm]));
 
     local_row_index=0;
@@ -1042,10 +1439,10 @@ void Ned_GradH1_RHS_local(REAL* bLoc,fespace *FE_H1,fespace *FE_Ned,mesh_struct
 
   //  Sum over quadrature points
   for (quad=0;quad<cq->nq_per_elm;quad++) {
-    qx[0] = cq->x[elm*cq->nq_per_elm+quad];
-    qx[1] = cq->y[elm*cq->nq_per_elm+quad];
-    if(dim==3) qx[2] = cq->z[elm*cq->nq_per_elm+quad];
-    w = cq->w[elm*cq->nq_per_elm+quad];
+    qx[0] = cq->x[quad];
+    qx[1] = cq->y[quad];
+    if(dim==3) qx[2] = cq->z[quad];
+    w = cq->w[quad];
 
     // Get FEM function at quadrature nodes
     FE_Interpolation(ucoeff,u->val,qx,ed_on_elm,v_on_elm,FE_Ned,mesh);
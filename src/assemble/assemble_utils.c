@@ -518,7 +518,497 @@ return;
 
 /******************************************************************************************************/
 /*!
-* \fn LocaltoGlobal(INT *dof_on_elm,fespace *FE,dvector *b,dCSRmat *A,REAL *ALoc,REAL *bLoc)
+* \fn void create_CSR_slots(dCSRmat *A, iCSRmat *el_dof1, iCSRmat *el_dof2, INT *slot, INT ld, INT elm_stride)
+*
+* \brief Finds, for each element, the position in A->val of every entry of the local
+*        matrix, so that the local to global map is a direct indexed add.
+*        The sparsity structure of A (IA and JA) must be built first.
+*
+* \note Assumes every element has the same number of DOF.  Entries that are not in
+*       the sparsity structure (i.e. Dirichlet rows or columns) get -1.
+*       Local entry (i,j) of element elm is stored in slot[elm*elm_stride+i*ld+j],
+*       so a block of a larger local matrix can be filled by shifting slot.
+*
+* \param A             dCSRmat Stiffness Matrix (IA and JA)
+* \param el_dof1       Element to DOF map for trial functions (columns of A)
+* \param el_dof2       Element to DOF map for test functions (rows of A)
+* \param ld            Leading dimension of the local matrix
+* \param elm_stride    Size of the slots of one element
+*
+* \return slot         Positions in A->val of the local matrix entries
+*
+*/
+void create_CSR_slots(dCSRmat *A, iCSRmat *el_dof1, iCSRmat *el_dof2, INT *slot, INT ld, INT elm_stride)
+{
+  INT i,j,k,kk,li,lj,elm,col;
+  INT* elm_slot;
+
+  // We will need the DOF to element map of the test space
+  iCSRmat dof_el_2;
+  icsr_trans(el_dof2,&dof_el_2);
+
+  INT nrows = MIN(A->row,dof_el_2.row);
+  INT ncols = A->col;
+
+  INT* ix = (INT *) calloc(ncols,sizeof(INT));
+  INT* pos = (INT *) calloc(ncols,sizeof(INT));
+  for (i=0; i<ncols; i++) {
+    ix[i] = -1;
+  }
+
+  for (i=0; i<nrows; i++) {
+    // Mark where each column of this row is
+    for (k=A->IA[i]; k<A->IA[i+1]; k++) {
+      ix[A->JA[k]] = i;
+      pos[A->JA[k]] = k;
+    }
+    // Loop over all Elements connected to particular DOF of test space
+    for (j=dof_el_2.IA[i]; j<dof_el_2.IA[i+1]; j++) {
+      elm = dof_el_2.JA[j];
+      // Local row(s) of this DOF on the element
+      for (kk=el_dof2->IA[elm]; kk<el_dof2->IA[elm+1]; kk++) {
+        if (el_dof2->JA[kk]!=i) continue;
+        li = kk-el_dof2->IA[elm];
+        elm_slot = slot + elm*elm_stride + li*ld;
+        for (k=el_dof1->IA[elm]; k<el_dof1->IA[elm+1]; k++) {
+          lj = k-el_dof1->IA[elm];
+          col = el_dof1->JA[k];
+          elm_slot[lj] = (ix[col]==i) ? pos[col] : -1;
+        }
+      }
+    }
+  }
+
+  if(ix) free(ix);
+  if(pos) free(pos);
+  icsr_free(&dof_el_2);
+
+  return;
+}
+/******************************************************************************************************/
+
+/******************************************************************************************************/
+/*!
+* \fn void initialize_assemble_pattern(assemble_pattern *pat)
+*
+* \brief Initializes an empty pattern cache for the *_reuse global assembly routines
+*
+* \param pat           Pattern cache
+*
+*/
+void initialize_assemble_pattern(assemble_pattern *pat)
+{
+  pat->nent = 0;
+  pat->ld = 0;
+  pat->nnz = 0;
+  pat->slot = NULL;
+  icsr_null(&pat->colors);
+  pat->threaded = 0;
+
+  return;
+}
+/******************************************************************************************************/
+
+/******************************************************************************************************/
+/*!
+* \fn void free_assemble_pattern(assemble_pattern *pat)
+*
+* \brief Frees the slot map and colors of a pattern cache (the matrix keeps its own
+*        sparsity structure)
+*
+* \param pat           Pattern cache
+*
+*/
+void free_assemble_pattern(assemble_pattern *pat)
+{
+  if(pat->slot) free(pat->slot);
+  if(pat->colors.IA) icsr_free(&pat->colors);
+  initialize_assemble_pattern(pat);
+
+  return;
+}
+/******************************************************************************************************/
+
+/******************************************************************************************************/
+/*!
+* \fn void block_create_CSR_slots(block_dCSRmat *A, block_fespace *FE, INT face, INT *slot)
+*
+* \brief Finds, for each element (or face), the position in the val array of the
+*        corresponding block of A of every entry of the local (block) matrix.
+*        The sparsity structure of the blocks of A must be built first.
+*
+* \note Local DOF are ordered by block fespace as in block_LocaltoGlobal.
+*       Entries of NULL blocks get -1.
+*
+* \param A             block_dCSRmat Stiffness Matrix
+* \param FE            block FE Space
+* \param face          0: slots of the elements (el_dof); 1: slots of the faces (f_dof)
+*
+* \return slot         Positions of the local matrix entries (nelm or nface times dof_per_elm^2)
+*
+*/
+void block_create_CSR_slots(block_dCSRmat *A, block_fespace *FE, INT face, INT *slot)
+{
+  INT i,j,ld=0,nent,roff,coff;
+  INT nblocks = FE->nspaces;
+  iCSRmat *dofi, *dofj;
+
+  // Get total DOF per element (or face) for indexing
+  for(i=0;i<nblocks;i++) {
+    dofi = face ? FE->var_spaces[i]->f_dof : FE->var_spaces[i]->el_dof;
+    ld += dofi->IA[1]-dofi->IA[0];
+  }
+  dofi = face ? FE->var_spaces[0]->f_dof : FE->var_spaces[0]->el_dof;
+  nent = dofi->row;
+  for (i=0; i<nent*ld*ld; i++) slot[i] = -1;
+
+  roff = 0;
+  for(i=0;i<nblocks;i++) {
+    dofi = face ? FE->var_spaces[i]->f_dof : FE->var_spaces[i]->el_dof;
+    coff = 0;
+    for(j=0;j<nblocks;j++) {
+      dofj = face ? FE->var_spaces[j]->f_dof : FE->var_spaces[j]->el_dof;
+      if(A->blocks[i*nblocks+j]) {
+        create_CSR_slots(A->blocks[i*nblocks+j],dofj,dofi,slot+roff*ld+coff,ld,ld*ld);
+      }
+      coff += dofj->IA[1]-dofj->IA[0];
+    }
+    roff += dofi->IA[1]-dofi->IA[0];
+  }
+
+  return;
+}
+/******************************************************************************************************/
+
+/******************************************************************************************************/
+/*!
+* \fn INT color_elements(INT nent, INT nmaps, iCSRmat **ent_dof, iCSRmat *colors)
+*
+* \brief Greedy coloring of the elements (or faces) so that no two entities of the
+*        same color share a DOF in any of the given maps.  The local matrices of one
+*        color can then be assembled by several threads at the same time without
+*        atomics or locks.
+*
+* \note Without OpenMP all entities are put in one color in their natural order.
+*       With OpenMP the coloring does not depend on the number of threads, so the
+*       assembled values do not either.
+*
+* \param nent          Number of elements (or faces)
+* \param nmaps         Number of entity to DOF maps (one per FE space)
+* \param ent_dof       Entity to DOF maps
+*
+* \return colors       Color to entity map (colors->row is the number of colors)
+* \return              1 if the colors can be assembled in parallel; 0 if not
+*
+*/
+INT color_elements(INT nent, INT nmaps, iCSRmat **ent_dof, iCSRmat *colors)
+{
+  INT i,e,c,ncolor=1,threaded=0;
+  INT* color = (INT *) calloc(nent,sizeof(INT));
+
+#ifdef _OPENMP
+  INT j,k,m,d;
+  // A DOF shared by too many entities (e.g. a global constraint) would make the
+  // colors useless and the coloring quadratic, so assemble serially instead
+  const INT max_share = 512;
+  iCSRmat* dof_ent = (iCSRmat *) calloc(nmaps,sizeof(iCSRmat));
+  threaded = 1;
+  for(m=0;m<nmaps;m++) {
+    icsr_trans(ent_dof[m],&dof_ent[m]);
+    for(d=0;d<dof_ent[m].row;d++) {
+      if(dof_ent[m].IA[d+1]-dof_ent[m].IA[d]>max_share) threaded = 0;
+    }
+  }
+
+  if(threaded) {
+    INT* mark = (INT *) calloc(nent+1,sizeof(INT));
+    for(c=0;c<=nent;c++) mark[c] = -1;
+    for(e=0;e<nent;e++) color[e] = -1;
+    ncolor = 0;
+    for(e=0;e<nent;e++) {
+      // Mark the colors of the neighbors already colored
+      for(m=0;m<nmaps;m++) {
+        for(j=ent_dof[m]->IA[e];j<ent_dof[m]->IA[e+1];j++) {
+          d = ent_dof[m]->JA[j];
+          for(k=dof_ent[m].IA[d];k<dof_ent[m].IA[d+1];k++) {
+            if(color[dof_ent[m].JA[k]]>=0) mark[color[dof_ent[m].JA[k]]] = e;
+          }
+        }
+      }
+      // Smallest free color
+      for(c=0;mark[c]==e;c++);
+      color[e] = c;
+      if(c+1>ncolor) ncolor = c+1;
+    }
+    free(mark);
+  } else {
+    for(e=0;e<nent;e++) color[e] = 0;
+  }
+
+  for(m=0;m<nmaps;m++) icsr_free(&dof_ent[m]);
+  free(dof_ent);
+#endif
+
+  // Color to entity map (entities keep their natural order within a color)
+  colors->row = ncolor;
+  colors->col = nent;
+  colors->nnz = nent;
+  colors->IA = (INT *) calloc(ncolor+1,sizeof(INT));
+  colors->JA = (INT *) calloc(nent,sizeof(INT));
+  colors->val = NULL;
+  for(e=0;e<nent;e++) colors->IA[color[e]+1]++;
+  for(c=0;c<ncolor;c++) colors->IA[c+1] += colors->IA[c];
+  for(e=0;e<nent;e++) {
+    i = colors->IA[color[e]]++;
+    colors->JA[i] = e;
+  }
+  for(c=ncolor;c>0;c--) colors->IA[c] = colors->IA[c-1];
+  colors->IA[0] = 0;
+
+  free(color);
+
+  return threaded;
+}
+/******************************************************************************************************/
+
+/******************************************************************************************************/
+/*!
+* \fn INT block_color_elements(block_fespace *FE, INT face, iCSRmat *colors)
+*
+* \brief Colors the elements (or faces) of a block FE space so that no two entities
+*        of the same color share a DOF in any of the spaces (see color_elements)
+*
+* \param FE            block FE Space
+* \param face          0: color the elements (el_dof); 1: color the faces (f_dof)
+*
+* \return colors       Color to entity map
+* \return              1 if the colors can be assembled in parallel; 0 if not
+*
+*/
+INT block_color_elements(block_fespace *FE, INT face, iCSRmat *colors)
+{
+  INT i,threaded;
+  INT nspaces = FE->nspaces;
+  iCSRmat** ent_dof = (iCSRmat **) calloc(nspaces,sizeof(iCSRmat *));
+
+  for(i=0;i<nspaces;i++) {
+    ent_dof[i] = face ? FE->var_spaces[i]->f_dof : FE->var_spaces[i]->el_dof;
+  }
+  threaded = color_elements(ent_dof[0]->row,nspaces,ent_dof,colors);
+
+  free(ent_dof);
+
+  return threaded;
+}
+/******************************************************************************************************/
+
+/******************************************************************************************************/
+/*!
+* \fn void copy_fespace_scratch(fespace *FE, fespace *FEt, INT dim)
+*
+* \brief Shallow copy of an FE space with its own basis function arrays, so that
+*        each thread of a threaded assembly can evaluate the basis on its element.
+*        All the maps (el_dof, dirichlet, ...) are shared with FE.
+*
+* \param FE            FE Space
+* \param dim           Dimension of the problem
+*
+* \return FEt          Copy of FE with private phi, dphi and ddphi
+*
+*/
+void copy_fespace_scratch(fespace *FE, fespace *FEt, INT dim)
+{
+  // Large enough for the basis and derivatives of any of the spaces
+  INT n = FE->dof_per_elm*dim*dim;
+
+  *FEt = *FE;
+  FEt->phi = NULL;
+  FEt->dphi = NULL;
+  FEt->ddphi = NULL;
+  // Each copy tabulates the reference basis itself (see tabulate_FEM_basis_elm)
+  FEt->nq_ref = 0;
+  FEt->phi_ref = NULL;
+  FEt->dphi_ref = NULL;
+  if(FE->phi) {
+    FEt->phi = (REAL *) calloc(n,sizeof(REAL));
+    // Some spaces (P0) set their basis once when created
+    array_cp(FE->dof_per_elm,FE->phi,FEt->phi);
+  }
+  if(FE->dphi) FEt->dphi = (REAL *) calloc(n,sizeof(REAL));
+  if(FE->ddphi) FEt->ddphi = (REAL *) calloc(n*dim,sizeof(REAL));
+
+  return;
+}
+/******************************************************************************************************/
+
+/******************************************************************************************************/
+/*!
+* \fn void free_fespace_scratch(fespace *FEt)
+*
+* \brief Frees the basis function arrays of a copy made by copy_fespace_scratch
+*
+* \param FEt           Copy of an FE space
+*
+*/
+void free_fespace_scratch(fespace *FEt)
+{
+  if(FEt->phi) free(FEt->phi);
+  if(FEt->dphi) free(FEt->dphi);
+  if(FEt->ddphi) free(FEt->ddphi);
+  if(FEt->phi_ref) free(FEt->phi_ref);
+  if(FEt->dphi_ref) free(FEt->dphi_ref);
+  FEt->phi = NULL;
+  FEt->dphi = NULL;
+  FEt->ddphi = NULL;
+  FEt->nq_ref = 0;
+  FEt->phi_ref = NULL;
+  FEt->dphi_ref = NULL;
+
+  return;
+}
+/******************************************************************************************************/
+
+/******************************************************************************************************/
+/*!
+* \fn void copy_blockfespace_scratch(block_fespace *FE, block_fespace *FEt, INT dim)
+*
+* \brief Shallow copy of a block FE space where every space has its own basis function
+*        arrays (see copy_fespace_scratch)
+*
+* \note The local data (simplex_data, fe_data) is shared with FE, so local assembly
+*       routines that use it cannot be threaded.
+*
+* \param FE            block FE Space
+* \param dim           Dimension of the problem
+*
+* \return FEt          Copy of FE
+*
+*/
+void copy_blockfespace_scratch(block_fespace *FE, block_fespace *FEt, INT dim)
+{
+  INT i;
+
+  *FEt = *FE;
+  FEt->var_spaces = (fespace **) calloc(FE->nspaces,sizeof(fespace *));
+  for(i=0;i<FE->nspaces;i++) {
+    FEt->var_spaces[i] = (fespace *) malloc(sizeof(fespace));
+    copy_fespace_scratch(FE->var_spaces[i],FEt->var_spaces[i],dim);
+  }
+
+  return;
+}
+/******************************************************************************************************/
+
+/******************************************************************************************************/
+/*!
+* \fn void free_blockfespace_scratch(block_fespace *FEt)
+*
+* \brief Frees a copy made by copy_blockfespace_scratch
+*
+* \param FEt           Copy of a block FE space
+*
+*/
+void free_blockfespace_scratch(block_fespace *FEt)
+{
+  INT i;
+
+  for(i=0;i<FEt->nspaces;i++) {
+    free_fespace_scratch(FEt->var_spaces[i]);
+    free(FEt->var_spaces[i]);
+  }
+  free(FEt->var_spaces);
+  FEt->var_spaces = NULL;
+
+  return;
+}
+/******************************************************************************************************/
+
+/******************************************************************************************************/
+/*!
+* \fn void copy_mesh_scratch(mesh_struct *mesh, mesh_struct *mesht)
+*
+* \brief Shallow copy of a mesh with its own work array (dwork), which the
+*        global basis functions (Nedelec, Raviart-Thomas, ...) use as scratch.
+*
+* \param mesh          Mesh
+*
+* \return mesht        Copy of mesh with a private dwork
+*
+*/
+void copy_mesh_scratch(mesh_struct *mesh, mesh_struct *mesht)
+{
+  *mesht = *mesh;
+  mesht->dwork = NULL;
+  if(mesh->dwork)
+    mesht->dwork = (REAL *) calloc(mesh->v_per_elm*(mesh->dim+1),sizeof(REAL));
+
+  return;
+}
+/******************************************************************************************************/
+
+/******************************************************************************************************/
+/*!
+* \fn void free_mesh_scratch(mesh_struct *mesht)
+*
+* \brief Frees the work array of a copy made by copy_mesh_scratch
+*
+* \param mesht         Copy of a mesh
+*
+*/
+void free_mesh_scratch(mesh_struct *mesht)
+{
+  if(mesht->dwork) free(mesht->dwork);
+  mesht->dwork = NULL;
+
+  return;
+}
+/******************************************************************************************************/
+
+/******************************************************************************************************/
+/*!
+* \fn void copy_qcoords_scratch(qcoordinates *cq, qcoordinates *cqt)
+*
+* \brief Makes a copy of the quadrature struct with its own node and weight arrays
+*        (one element), so each thread can compute the quadrature of its elements
+*        with quad_elm.  The rule on the reference element is copied if present.
+*
+* \param cq            Quadrature struct
+*
+* \return cqt          Copy of the quadrature struct (free with free_qcoords)
+*
+*/
+void copy_qcoords_scratch(qcoordinates *cq, qcoordinates *cqt)
+{
+  INT nq = cq->nq_per_elm;
+  INT nref = 0;
+  if(cq->x) nref++;
+  if(cq->y) nref++;
+  if(cq->z) nref++;
+
+  *cqt = *cq;
+  cqt->n = nq;
+  cqt->x = (REAL *) calloc(nq,sizeof(REAL));
+  cqt->y = NULL;
+  cqt->z = NULL;
+  if(cq->y) cqt->y = (REAL *) calloc(nq,sizeof(REAL));
+  if(cq->z) cqt->z = (REAL *) calloc(nq,sizeof(REAL));
+  cqt->w = (REAL *) calloc(nq,sizeof(REAL));
+  cqt->ref_x = NULL;
+  cqt->ref_w = NULL;
+  if(cq->ref_x && cq->ref_w) {
+    cqt->ref_x = (REAL *) calloc(nq*nref,sizeof(REAL));
+    cqt->ref_w = (REAL *) calloc(nq,sizeof(REAL));
+    memcpy(cqt->ref_x,cq->ref_x,nq*nref*sizeof(REAL));
+    memcpy(cqt->ref_w,cq->ref_w,nq*sizeof(REAL));
+  }
+
+  return;
+}
+/******************************************************************************************************/
+
+/******************************************************************************************************/
+/*!
+* \fn LocaltoGlobal(INT *dof_on_elm,fespace *FE,dvector *b,dCSRmat *A,REAL *ALoc,REAL *bLoc,INT *elm_slot)
 *
 * \brief Maps the local matrix to global matrix NOT considering boundaries
 *
@@ -526,12 +1016,14 @@ return;
 * \param FE            FE Space
 * \param ALoc          Local stiffness matrix (full matrix)
 * \param bLoc          Local RHS vector
+* \param elm_slot      Positions in A->val of the local entries (from create_CSR_slots),
+*                      or NULL to search the rows of A
 *
 * \return A            Global CSR matrix
 * \return b            Global RHS vector
 *
 */
-void LocaltoGlobal(INT *dof_on_elm,fespace *FE,dvector *b,dCSRmat *A,REAL *ALoc,REAL *bLoc)
+void LocaltoGlobal(INT *dof_on_elm,fespace *FE,dvector *b,dCSRmat *A,REAL *ALoc,REAL *bLoc,INT *elm_slot)
 {
   INT i,j,k,row,col,col_a,col_b,acol;
 
@@ -541,6 +1033,14 @@ void LocaltoGlobal(INT *dof_on_elm,fespace *FE,dvector *b,dCSRmat *A,REAL *ALoc,
     if(bLoc!=NULL)
     b->val[row] = b->val[row] + bLoc[i];
 
+    if(elm_slot!=NULL) { /* Positions are known */
+      for (j=0; j<FE->dof_per_elm; j++) {
+        k = elm_slot[i*FE->dof_per_elm+j];
+        if (k>=0) A->val[k] += ALoc[i*FE->dof_per_elm+j];
+      }
+      continue;
+    }
+
     for (j=0; j<FE->dof_per_elm; j++) { /* Columns of Local Stiffness */
       col = dof_on_elm[j];
 
@@ -550,6 +1050,7 @@ void LocaltoGlobal(INT *dof_on_elm,fespace *FE,dvector *b,dCSRmat *A,REAL *ALoc,
         acol = A->JA[k];
         if (acol==col) {	/* If they match, put it in the global matrix */
           A->val[k] = A->val[k] + ALoc[i*FE->dof_per_elm+j];
+          break;
         }
       }
     }
@@ -560,7 +1061,7 @@ void LocaltoGlobal(INT *dof_on_elm,fespace *FE,dvector *b,dCSRmat *A,REAL *ALoc,
 
 /******************************************************************************************************/
 /*!
-* \fn LocaltoGlobal_FE1FE2(INT *dof_on_elm1,fespace *FE1,INT *dof_on_elm2,fespace *FE2,dvector *b,dCSRmat *A,REAL *ALoc,REAL *bLoc)
+* \fn LocaltoGlobal_FE1FE2(INT *dof_on_elm1,fespace *FE1,INT *dof_on_elm2,fespace *FE2,dvector *b,dCSRmat *A,REAL *ALoc,REAL *bLoc,INT *elm_slot)
 *
 * \brief Maps the local matrix to global matrix NOT considering boundaries
 *
@@ -572,12 +1073,14 @@ void LocaltoGlobal(INT *dof_on_elm,fespace *FE,dvector *b,dCSRmat *A,REAL *ALoc,
 * \param FE2           FE Space for test functions (v)
 * \param ALoc          Local stiffness matrix (full matrix)
 * \param bLoc          Local RHS vector
+* \param elm_slot      Positions in A->val of the local entries (from create_CSR_slots),
+*                      or NULL to search the rows of A
 *
 * \return A            Global CSR matrix
 * \return b            Global RHS vector
 *
 */
-void LocaltoGlobal_FE1FE2(INT *dof_on_elm1,fespace *FE1,INT *dof_on_elm2,fespace *FE2,dvector *b,dCSRmat *A,REAL *ALoc,REAL *bLoc)
+void LocaltoGlobal_FE1FE2(INT *dof_on_elm1,fespace *FE1,INT *dof_on_elm2,fespace *FE2,dvector *b,dCSRmat *A,REAL *ALoc,REAL *bLoc,INT *elm_slot)
 {
   INT i,j,k,row,col,col_a,col_b,acol;
 
@@ -587,6 +1090,14 @@ void LocaltoGlobal_FE1FE2(INT *dof_on_elm1,fespace *FE1,INT *dof_on_elm2,fespace
     if(bLoc!=NULL)
     b->val[row] = b->val[row] + bLoc[i];
 
+    if(elm_slot!=NULL) { /* Positions are known */
+      for (j=0; j<FE1->dof_per_elm; j++) {
+        k = elm_slot[i*FE1->dof_per_elm+j];
+        if (k>=0) A->val[k] += ALoc[i*FE1->dof_per_elm+j];
+      }
+      continue;
+    }
+
     for (j=0; j<FE1->dof_per_elm; j++) { /* Columns of Local Stiffness (trial space)*/
       col = dof_on_elm1[j];
 
@@ -596,6 +1107,7 @@ void LocaltoGlobal_FE1FE2(INT *dof_on_elm1,fespace *FE1,INT *dof_on_elm2,fespace
         acol = A->JA[k];
         if (acol==col) {	/* If they match, put it in the global matrix */
           A->val[k] = A->val[k] + ALoc[i*FE1->dof_per_elm+j];
+          break;
         }
       }
     }
@@ -606,7 +1118,7 @@ void LocaltoGlobal_FE1FE2(INT *dof_on_elm1,fespace *FE1,INT *dof_on_elm2,fespace
 
 /******************************************************************************************************/
 /*!
-* \fn block_LocaltoGlobal(INT *dof_on_elm,block_fespace *FE,dvector *b,block_dCSRmat *A,REAL *ALoc,REAL *bLoc)
+* \fn block_LocaltoGlobal(INT *dof_on_elm,block_fespace *FE,dvector *b,block_dCSRmat *A,REAL *ALoc,REAL *bLoc,INT *elm_slot)
 *
 * \brief Maps the local matrix to global block matrix NOT considering boundaries
 *
@@ -616,12 +1128,14 @@ void LocaltoGlobal_FE1FE2(INT *dof_on_elm1,fespace *FE1,INT *dof_on_elm2,fespace
 * \param FE            block FE Space
 * \param ALoc          Local stiffness matrix (full matrix)
 * \param bLoc          Local RHS vector
+* \param elm_slot      Positions in the block val arrays of the local entries
+*                      (from block_create_CSR_slots), or NULL to search the rows of A
 *
 * \return A            Global block_CSR matrix
 * \return b            Global RHS vector (ordered by block structure of FE space)
 *
 */
-void block_LocaltoGlobal(INT *dof_on_elm,block_fespace *FE,dvector *b,block_dCSRmat *A,REAL *ALoc,REAL *bLoc)
+void block_LocaltoGlobal(INT *dof_on_elm,block_fespace *FE,dvector *b,block_dCSRmat *A,REAL *ALoc,REAL *bLoc,INT *elm_slot)
 {
   INT i,j,k,col_a,col_b,acol,block_row,block_col;
   INT local_row,local_col;
@@ -656,6 +1170,15 @@ void block_LocaltoGlobal(INT *dof_on_elm,block_fespace *FE,dvector *b,block_dCSR
         b->val[local_row+global_row_index] += bLoc[local_row_index+i];
 
         /* Columns of Local Stiffness (trial space)*/
+        if(elm_slot!=NULL) { /* Positions are known */
+          if(A->blocks[block_row*nblocks+block_col]) {
+            for (j=0; j<dof_per_elm_trial; j++) {
+              k = elm_slot[(local_row_index+i)*block_dof_per_elm+(local_col_index+j)];
+              if (k>=0) A->blocks[block_row*nblocks+block_col]->val[k] += ALoc[(local_row_index+i)*block_dof_per_elm+(local_col_index+j)];
+            }
+          }
+          continue;
+        }
         for (j=0; j<dof_per_elm_trial; j++) {
           local_col = dof_on_elm[local_col_index + j];
           /* Columns of A */
@@ -666,6 +1189,7 @@ void block_LocaltoGlobal(INT *dof_on_elm,block_fespace *FE,dvector *b,block_dCSR
               acol = A->blocks[block_row*nblocks+block_col]->JA[k];
               if (acol==local_col) {	/* If they match, put it in the global matrix */
                 A->blocks[block_row*nblocks+block_col]->val[k] += ALoc[(local_row_index+i)*block_dof_per_elm+(local_col_index+j)];
+                break;
               }
             }
           }
@@ -683,7 +1207,7 @@ void block_LocaltoGlobal(INT *dof_on_elm,block_fespace *FE,dvector *b,block_dCSR
 
 /******************************************************************************************************/
 /*!
-* \fn LocaltoGlobal_withBC(INT *dof_on_elm,fespace *FE,dvector *b,dCSRmat *A,REAL *ALoc,REAL *bLoc)
+* \fn LocaltoGlobal_withBC(INT *dof_on_elm,fespace *FE,dvector *b,dCSRmat *A,REAL *ALoc,REAL *bLoc,INT *elm_slot)
 *
 * \brief Maps the local matrix to global matrix considering boundaries
 *
@@ -691,12 +1215,14 @@ void block_LocaltoGlobal(INT *dof_on_elm,block_fespace *FE,dvector *b,block_dCSR
 * \param FE            FE Space
 * \param ALoc          Local stiffness matrix (full matrix)
 * \param bLoc          Local RHS vector
+* \param elm_slot      Positions in A->val of the local entries (from create_CSR_slots),
+*                      or NULL to search the rows of A
 *
 * \return A            Global CSR matrix
 * \return b            Global RHS vector
 *
 */
-void LocaltoGlobal_withBC(INT *dof_on_elm,fespace *FE,dvector *b,dCSRmat *A,REAL *ALoc,REAL *bLoc)
+void LocaltoGlobal_withBC(INT *dof_on_elm,fespace *FE,dvector *b,dCSRmat *A,REAL *ALoc,REAL *bLoc,INT *elm_slot)
 {
   INT i,j,k,row,col,col_a,col_b,acol;
 
@@ -710,12 +1236,18 @@ void LocaltoGlobal_withBC(INT *dof_on_elm,fespace *FE,dvector *b,dCSRmat *A,REAL
       for (j=0; j<FE->dof_per_elm; j++) { /* Columns of Local Stiffness */
         col = dof_on_elm[j];
         if (FE->dirichlet[col]==0) { /* Only do stuff if hit a non-boundary edge */
+          if(elm_slot!=NULL) { /* Position is known */
+            k = elm_slot[i*FE->dof_per_elm+j];
+            if (k>=0) A->val[k] += ALoc[i*FE->dof_per_elm+j];
+            continue;
+          }
           col_a = A->IA[row];
           col_b = A->IA[row+1];
           for (k=col_a; k<col_b; k++) { /* Columns of A */
             acol = A->JA[k];
             if (acol==col) {	/* If they match, put it in the global matrix */
               A->val[k] = A->val[k] + ALoc[i*FE->dof_per_elm+j];
+              break;
             }
           }
         } else { /* If boundary adjust Right hand side */
@@ -731,7 +1263,7 @@ void LocaltoGlobal_withBC(INT *dof_on_elm,fespace *FE,dvector *b,dCSRmat *A,REAL
 
 /******************************************************************************************************/
 /*!
-* \fn LocaltoGlobal_face(INT *dof_on_f,INT dof_per_f,fespace *FE,dvector *b,dCSRmat *A,REAL *ALoc,REAL *bLoc,INT flag0,INT flag1)
+* \fn LocaltoGlobal_face(INT *dof_on_f,INT dof_per_f,fespace *FE,dvector *b,dCSRmat *A,REAL *ALoc,REAL *bLoc,INT flag0,INT flag1,INT *f_slot)
 *
 * \brief Maps the local matrix to global matrix considering "special" boundaries
 *        Flag indicates which types of boundaries to consider as Dirichlet
@@ -743,12 +1275,14 @@ void LocaltoGlobal_withBC(INT *dof_on_elm,fespace *FE,dvector *b,dCSRmat *A,REAL
 * \param ALoc          Local stiffness matrix (full matrix)
 * \param bLoc          Local RHS vector
 * \param flag0,flag1   Indicates which range of boundaries DOF to grab
+* \param f_slot        Positions in A->val of the local entries (from create_CSR_slots
+*                      with the face to DOF map), or NULL to search the rows of A
 *
 * \return A            Global CSR matrix
 * \return b            Global RHS vector
 *
 */
-void LocaltoGlobal_face(INT *dof_on_f,INT dof_per_f,fespace *FE,dvector *b,dCSRmat *A,REAL *ALoc,REAL *bLoc,INT flag0,INT flag1)
+void LocaltoGlobal_face(INT *dof_on_f,INT dof_per_f,fespace *FE,dvector *b,dCSRmat *A,REAL *ALoc,REAL *bLoc,INT flag0,INT flag1,INT *f_slot)
 {
   INT i,j,k,row,col,col_a,col_b,acol;
 
@@ -761,12 +1295,18 @@ void LocaltoGlobal_face(INT *dof_on_f,INT dof_per_f,fespace *FE,dvector *b,dCSRm
       for (j=0; j<dof_per_f; j++) { /* Columns of Local Stiffness */
         col = dof_on_f[j];
         if (FE->dof_flag[col]>=flag0 && FE->dof_flag[col]<=flag1) { /* Only do stuff if hit a special boundary */
+          if(f_slot!=NULL) { /* Position is known */
+            k = f_slot[i*dof_per_f+j];
+            if (k>=0) A->val[k] += ALoc[i*dof_per_f+j];
+            continue;
+          }
           col_a = A->IA[row];
           col_b = A->IA[row+1];
           for (k=col_a; k<col_b; k++) { /* Columns of A */
             acol = A->JA[k];
             if (acol==col) {	/* If they match, put it in the global matrix */
               A->val[k] = A->val[k] + ALoc[i*dof_per_f+j];
+              break;
             }
           }
         }
@@ -779,7 +1319,7 @@ void LocaltoGlobal_face(INT *dof_on_f,INT dof_per_f,fespace *FE,dvector *b,dCSRm
 
 /******************************************************************************************************/
 /*!
-* \fn block_LocaltoGlobal_face(INT *dof_on_f,INT dof_per_f,block_fespace *FE,dvector *b,dCSRmat *A,REAL *ALoc,REAL *bLoc,INT flag0,INT flag1)
+* \fn block_LocaltoGlobal_face(INT *dof_on_f,INT dof_per_f,INT* dof_per_face_blk,block_fespace *FE,dvector *b,block_dCSRmat *A,REAL *ALoc,REAL *bLoc,INT flag0,INT flag1,INT *f_slot)
 *
 * \brief Maps the local matrix to global matrix considering "special" boundaries
 *        Flag indicates which types of boundaries to consider as Dirichlet
@@ -791,12 +1331,14 @@ void LocaltoGlobal_face(INT *dof_on_f,INT dof_per_f,fespace *FE,dvector *b,dCSRm
 * \param ALoc          Local stiffness matrix (full matrix)
 * \param bLoc          Local RHS vector
 * \param flag0,flag1   Indicates which range of boundaries DOF to grab
+* \param f_slot        Positions in the block val arrays of the local entries
+*                      (from block_create_CSR_slots), or NULL to search the rows of A
 *
 * \return A            Global CSR matrix
 * \return b            Global RHS vector
 *
 */
-void block_LocaltoGlobal_face(INT *dof_on_f,INT dof_per_f,INT* dof_per_face_blk,block_fespace *FE,dvector *b,block_dCSRmat *A,REAL *ALoc,REAL *bLoc,INT flag0,INT flag1)
+void block_LocaltoGlobal_face(INT *dof_on_f,INT dof_per_f,INT* dof_per_face_blk,block_fespace *FE,dvector *b,block_dCSRmat *A,REAL *ALoc,REAL *bLoc,INT flag0,INT flag1,INT *f_slot)
 {
   INT i,j,k,col_a,col_b,acol,block_row,block_col;
   INT local_row,local_col;
@@ -821,6 +1363,15 @@ void block_LocaltoGlobal_face(INT *dof_on_f,INT dof_per_f,INT* dof_per_face_blk,
         // Update RHS
         if(bLoc!=NULL && block_col==0)  b->val[local_row+global_row_index] += bLoc[local_row_index+i];
 
+        if(f_slot!=NULL) { /* Positions are known */
+          if(A->blocks[block_row*nblocks+block_col]) {
+            for (j=0; j<dof_per_face_trial; j++) {
+              k = f_slot[(local_row_index+i)*dof_per_f+(local_col_index+j)];
+              if (k>=0) A->blocks[block_row*nblocks+block_col]->val[k] += ALoc[(local_row_index+i)*dof_per_f+(local_col_index+j)];
+            }
+          }
+          continue;
+        }
         for (j=0; j<dof_per_face_trial; j++) { /* Columns of Local Stiffness */
           local_col = dof_on_f[local_col_index+j];
           if(A->blocks[block_row*nblocks+block_col]) {
@@ -830,20 +1381,244 @@ void block_LocaltoGlobal_face(INT *dof_on_f,INT dof_per_f,INT* dof_per_face_blk,
               acol = A->blocks[block_row*nblocks+block_col]->JA[k];
               if (acol==local_col) {	/* If they match, put it in the global matrix */
                 A->blocks[block_row*nblocks+block_col]->val[k] += ALoc[(local_row_index+i)*dof_per_f+(local_col_index+j)];
+                break;
               }
             }
           }
         }
       }
-      local_col_index += dof_per_face_trial;
+      local_col_index += dof_per_face_trial;
+    }
+    local_col_index = 0;
+    global_row_index += FE->var_spaces[block_row]->ndof;
+    local_row_index += dof_per_face_test;
+  }
+  return;
+}
+/******************************************************************************************************/
+
+/******************************************************************************************************/
+/*!
+* \fn void initialize_dirichlet_pattern(dirichlet_pattern *pat)
+*
+* \brief Initializes an empty pattern for the *_reuse Dirichlet elimination routines
+*
+* \param pat           Dirichlet pattern
+*
+*/
+void initialize_dirichlet_pattern(dirichlet_pattern *pat)
+{
+  pat->nnz = 0;
+  pat->nbrow = 0;
+  pat->brow = NULL;
+  pat->bdiag = NULL;
+  pat->brow_nnz = NULL;
+  pat->nbcol = 0;
+  pat->bcol_row = NULL;
+  pat->bcol_slot = NULL;
+  pat->ub = NULL;
+  pat->nub = 0;
+
+  return;
+}
+/******************************************************************************************************/
+
+/******************************************************************************************************/
+/*!
+* \fn void free_dirichlet_pattern(dirichlet_pattern *pat)
+*
+* \brief Frees the index lists and the boundary values of a Dirichlet pattern
+*
+* \param pat           Dirichlet pattern
+*
+*/
+void free_dirichlet_pattern(dirichlet_pattern *pat)
+{
+  if(pat->brow) free(pat->brow);
+  if(pat->bdiag) free(pat->bdiag);
+  if(pat->brow_nnz) free(pat->brow_nnz);
+  if(pat->bcol_row) free(pat->bcol_row);
+  if(pat->bcol_slot) free(pat->bcol_slot);
+  if(pat->ub) free(pat->ub);
+  initialize_dirichlet_pattern(pat);
+
+  return;
+}
+/******************************************************************************************************/
+
+/******************************************************************************************************/
+/*!
+* \fn void create_dirichlet_pattern(dirichlet_pattern *pat,dCSRmat *A,INT *dirichlet_row,INT *dirichlet_col,INT diag)
+*
+* \brief Finds the Dirichlet rows of A and the entries of the other rows in
+*        Dirichlet columns, so that the boundary conditions can be eliminated
+*        without scanning the whole matrix again.
+*
+* \note Entries are listed in row order.  For a block of a block matrix, pass the
+*       Dirichlet flags shifted to the first row and column of the block.
+*
+* \param A             CSR matrix (only the sparsity structure is used)
+* \param dirichlet_row Dirichlet flags of the rows of A (1 if Dirichlet)
+* \param dirichlet_col Dirichlet flags of the columns of A (1 if Dirichlet)
+* \param diag          1: Dirichlet rows get 1 on the diagonal; 0: they are zeroed entirely
+*
+* \return pat          Dirichlet pattern of A
+*
+*/
+void create_dirichlet_pattern(dirichlet_pattern *pat,dCSRmat *A,INT *dirichlet_row,INT *dirichlet_col,INT diag)
+{
+  INT i,j,nbrow=0,nbcol=0;
+
+  // Count first
+  for(i=0;i<A->row;i++) {
+    if(dirichlet_row[i]==1) {
+      nbrow++;
+    } else {
+      for(j=A->IA[i];j<A->IA[i+1];j++) {
+        if(dirichlet_col[A->JA[j]]==1) nbcol++;
+      }
+    }
+  }
+
+  pat->nnz = A->nnz;
+  pat->nbrow = nbrow;
+  pat->nbcol = nbcol;
+  // Allocate at least one entry so that an empty pattern is still marked as built
+  pat->brow = (INT *) calloc(nbrow+1,sizeof(INT));
+  pat->bdiag = (INT *) calloc(nbrow+1,sizeof(INT));
+  pat->brow_nnz = (INT *) calloc(nbrow+1,sizeof(INT));
+  pat->bcol_row = (INT *) calloc(nbcol+1,sizeof(INT));
+  pat->bcol_slot = (INT *) calloc(nbcol+1,sizeof(INT));
+
+  nbrow = 0;
+  nbcol = 0;
+  for(i=0;i<A->row;i++) {
+    if(dirichlet_row[i]==1) {
+      pat->brow[nbrow] = i;
+      pat->brow_nnz[nbrow] = A->IA[i+1]-A->IA[i];
+      pat->bdiag[nbrow] = -1;
+      if(diag) {
+        for(j=A->IA[i];j<A->IA[i+1];j++) {
+          if(A->JA[j]==i) pat->bdiag[nbrow] = j;
+        }
+      }
+      nbrow++;
+    } else {
+      for(j=A->IA[i];j<A->IA[i+1];j++) {
+        if(dirichlet_col[A->JA[j]]==1) {
+          pat->bcol_row[nbcol] = i;
+          pat->bcol_slot[nbcol] = j;
+          nbcol++;
+        }
+      }
+    }
+  }
+
+  return;
+}
+/******************************************************************************************************/
+
+/* Returns the Dirichlet pattern to use for A: the cached one in pat if it was
+ * built before (checked against A), otherwise a new one built in pat or, if pat
+ * is NULL, in loc (which the caller frees). */
+static dirichlet_pattern* get_dirichlet_pattern(dirichlet_pattern *pat,dirichlet_pattern *loc,dCSRmat *A,
+INT *dirichlet_row,INT *dirichlet_col,INT diag)
+{
+  INT i,k;
+  if(pat!=NULL && pat->brow!=NULL) {
+    if(pat->nnz!=A->nnz) check_error(ERROR_DATA_STRUCTURE,__FUNCTION__);
+    // the Dirichlet rows are rewritten entirely, so they must not have moved
+    for(k=0;k<pat->nbrow;k++) {
+      i = pat->brow[k];
+      if(i>=A->row || A->IA[i+1]-A->IA[i]!=pat->brow_nnz[k]) {
+        printf("\n### ERROR HAZMATH DANGER: %s: Dirichlet row %d does not match the pattern.\n",
+               __FUNCTION__,i);
+        check_error(ERROR_DATA_STRUCTURE,__FUNCTION__);
+      }
+    }
+    return pat;
+  }
+  if(pat==NULL) pat = loc;
+  create_dirichlet_pattern(pat,A,dirichlet_row,dirichlet_col,diag);
+  return pat;
+}
+
+/* Boundary values of the ndof DOF, kept in pat between calls.  Only the
+ * Dirichlet entries are ever written or read, so they need no reset. */
+static REAL* dirichlet_pattern_values(dirichlet_pattern *pat,INT ndof)
+{
+  if(pat->ub==NULL || pat->nub!=ndof) {
+    if(pat->ub) free(pat->ub);
+    pat->ub = (REAL *) calloc(ndof,sizeof(REAL));
+    pat->nub = ndof;
+  }
+  return pat->ub;
+}
+
+/* Zeros the Dirichlet rows (except for the diagonal, set to 1) and the Dirichlet
+ * columns of A listed in pat */
+static void eliminate_dirichlet_pattern(dirichlet_pattern *pat,dCSRmat *A)
+{
+  INT i,j,k;
+  INT nbrow = pat->nbrow, nbcol = pat->nbcol;
+  INT *brow = pat->brow, *bdiag = pat->bdiag, *bcol_slot = pat->bcol_slot;
+
+#ifdef _OPENMP
+#pragma omp parallel for private(i,j) if(nbrow>1024)
+#endif
+  for(k=0;k<nbrow;k++) {
+    i = brow[k];
+    for(j=A->IA[i];j<A->IA[i+1];j++) A->val[j] = 0.0;
+    if(bdiag[k]>=0) A->val[bdiag[k]] = 1.0;
+  }
+
+#ifdef _OPENMP
+#pragma omp parallel for if(nbcol>1024)
+#endif
+  for(k=0;k<nbcol;k++) A->val[bcol_slot[k]] = 0.0;
+
+  return;
+}
+
+/* b(non-Dirichlet rows) -= A(:,Dirichlet columns)*ub using the entries listed in
+ * pat; rowshift and colshift locate the block A in b and ub */
+static void eliminate_dirichlet_pattern_RHS(dirichlet_pattern *pat,dCSRmat *A,REAL *ub,REAL *b,INT rowshift,INT colshift)
+{
+  INT k,j;
+
+  for(k=0;k<pat->nbcol;k++) {
+    j = pat->bcol_slot[k];
+    b[pat->bcol_row[k]+rowshift] -= A->val[j]*ub[A->JA[j]+colshift];
+  }
+
+  return;
+}
+
+/* Offsets of the blocks of a block matrix (number of rows of each block row) */
+static INT* block_dirichlet_shifts(block_dCSRmat *A)
+{
+  INT i,j;
+  INT nsp = A->brow;
+  INT *dofshift = (INT *) calloc(nsp,sizeof(INT));
+
+  for(i=0;i<nsp;i++){
+    for(j=0;j<nsp;j++){
+      if(dofshift[j]==0){
+        if(A->blocks[i+j*nsp] != NULL){
+          dofshift[j] = A->blocks[i+j*nsp]->row;
+        }
+      }
     }
-    local_col_index = 0;
-    global_row_index += FE->var_spaces[block_row]->ndof;
-    local_row_index += dof_per_face_test;
   }
-  return;
+  // Error Check
+  for(i=0;i<nsp;i++) {
+    if(dofshift[i]==0) {
+      printf("ERROR HAZMATH DANGER: in function %s: NULL BLOCK ROW in A.\n",__FUNCTION__);
+    }
+  }
+
+  return dofshift;
 }
-/******************************************************************************************************/
 
 /******************************************************************************************************/
 /*!
@@ -871,9 +1646,38 @@ void block_LocaltoGlobal_face(INT *dof_on_f,INT dof_per_f,INT* dof_per_face_blk,
 */
 void eliminate_DirichletBC(void (*bc)(REAL *,REAL *,REAL,void *),fespace *FE,mesh_struct *mesh,dvector *b,dCSRmat *A,REAL time)
 {
-  INT i,j,cola,colb;
+  eliminate_DirichletBC_reuse(bc,FE,mesh,b,A,time,NULL);
+  return;
+}
+/******************************************************************************************************/
+
+/******************************************************************************************************/
+/*!
+* \fn eliminate_DirichletBC_reuse(void (*bc)(REAL *,REAL *,REAL,void *),fespace *FE,mesh_struct *mesh,dvector *b,dCSRmat *A,REAL time,dirichlet_pattern *pat)
+*
+* \brief Same as eliminate_DirichletBC, but only touches the boundary rows and the
+*        boundary columns listed in a Dirichlet pattern.  The pattern is built on
+*        the first call and reused by later calls on the same sparsity structure.
+*
+* \param bc            Function to get boundary condition at given coordinates.
+* \param FE            FE Space
+* \param mesh          Mesh struct
+* \param b             RHS vector
+* \param A             CSR stiffness matrix
+* \param time          Physical time if time-dependent
+* \param pat           Dirichlet pattern (from initialize_dirichlet_pattern, freed by free_dirichlet_pattern)
+*                      or NULL to build a temporary one
+*
+* \return A            Global CSR matrix with boundaries eliminated
+* \return b            Global RHS vector with boundaries eliminated
+*
+*/
+void eliminate_DirichletBC_reuse(void (*bc)(REAL *,REAL *,REAL,void *),fespace *FE,mesh_struct *mesh,dvector *b,dCSRmat *A,REAL time,dirichlet_pattern *pat)
+{
   INT ndof = FE->ndof;
   SHORT status;
+  dirichlet_pattern loc;
+  dirichlet_pattern *dpat;
 
   // Error Check
   if(A->row!=ndof || A->col!=ndof) {
@@ -881,34 +1685,18 @@ void eliminate_DirichletBC(void (*bc)(REAL *,REAL *,REAL,void *),fespace *FE,mes
     check_error(status, __FUNCTION__);
   }
 
+  initialize_dirichlet_pattern(&loc);
+  dpat = get_dirichlet_pattern(pat,&loc,A,FE->dirichlet,FE->dirichlet,1);
+
   // Fix RHS First b_interior = (b - A(0;u_bdry)^T)_interior
   //               b_bdry = u_bdry
   if(b!=NULL)
-  eliminate_DirichletBC_RHS(bc,FE,mesh,b,A,time);
+  eliminate_DirichletBC_RHS_reuse(bc,FE,mesh,b,A,time,dpat);
 
   // Now fix A
-  // Loop over rows of A
-  for (i=0; i<ndof; i++) {
-    cola = A->IA[i];
-    colb = A->IA[i+1];
-    if(FE->dirichlet[i]==1) { // Boundary Row
-      // Loop over columns and 0 out everything in a row except for diagonal
-      for(j=cola; j<colb; j++) {
-        if(A->JA[j]==i)
-        A->val[j] = 1.0;
-        else
-        A->val[j] = 0.0;
-      }
-    } else { // Non-boundary-row
-      // Loop over columns and 0 out if column is boundary
-      for(j=cola; j<colb; j++) {
-        if(FE->dirichlet[A->JA[j]]==1) {
-          // Zero out matrix entry
-          A->val[j] = 0.0;
-        }
-      }
-    }
-  }
+  eliminate_dirichlet_pattern(dpat,A);
+
+  free_dirichlet_pattern(&loc);
   return;
 }
 /******************************************************************************************************/
@@ -934,11 +1722,40 @@ void eliminate_DirichletBC(void (*bc)(REAL *,REAL *,REAL,void *),fespace *FE,mes
 *
 */
 void eliminate_DirichletBC_RHS(void (*bc)(REAL *,REAL *,REAL,void *),fespace *FE,mesh_struct *mesh,dvector *b,dCSRmat *A,REAL time)
+{
+  eliminate_DirichletBC_RHS_reuse(bc,FE,mesh,b,A,time,NULL);
+  return;
+}
+/******************************************************************************************************/
+
+/******************************************************************************************************/
+/*!
+* \fn eliminate_DirichletBC_RHS_reuse(void (*bc)(REAL *,REAL *,REAL,void *),fespace *FE,mesh_struct *mesh,dvector *b,dCSRmat *A,REAL time,dirichlet_pattern *pat)
+*
+* \brief Same as eliminate_DirichletBC_RHS, but the boundary values are only
+*        evaluated at the Dirichlet DOF and only the entries of A in boundary
+*        columns are used, as listed in a Dirichlet pattern (built on the first call).
+*
+* \param bc            Function to get boundary condition at given coordinates.
+* \param FE            FE Space
+* \param mesh          Mesh struct
+* \param b             RHS vector
+* \param A             CSR stiffness matrix (without boundaries eliminated)
+* \param time          Physical time if time-dependent
+* \param pat           Dirichlet pattern (from initialize_dirichlet_pattern, freed by free_dirichlet_pattern)
+*                      or NULL to build a temporary one
+*
+* \return b            Global RHS vector with boundaries eliminated
+*
+*/
+void eliminate_DirichletBC_RHS_reuse(void (*bc)(REAL *,REAL *,REAL,void *),fespace *FE,mesh_struct *mesh,dvector *b,dCSRmat *A,REAL time,dirichlet_pattern *pat)
 {
   SHORT status;
-  INT i;
+  INT i,k;
   INT ndof = FE->ndof;
-  REAL* ub = (REAL *) calloc(ndof,sizeof(REAL));
+  REAL* ub;
+  dirichlet_pattern loc;
+  dirichlet_pattern *dpat;
 
   // Error Check
   if(A->row!=ndof || A->col!=ndof) {
@@ -946,26 +1763,26 @@ void eliminate_DirichletBC_RHS(void (*bc)(REAL *,REAL *,REAL,void *),fespace *FE
     check_error(status, __FUNCTION__);
   }
 
+  initialize_dirichlet_pattern(&loc);
+  dpat = get_dirichlet_pattern(pat,&loc,A,FE->dirichlet,FE->dirichlet,1);
+  ub = dirichlet_pattern_values(dpat,ndof);
+
   // Get solution vector that's 0 on interior and boundary value on boundary
-  for(i=0; i<ndof; i++) {
-    if(FE->dirichlet[i]==1) {
-      ub[i] = FE_Evaluate_DOF(bc,FE,mesh,time,i);
-    } else {
-      ub[i] = 0.0;
-    }
+  for(k=0; k<dpat->nbrow; k++) {
+    i = dpat->brow[k];
+    ub[i] = FE_Evaluate_DOF(bc,FE,mesh,time,i);
   }
 
-  // b = b - Aub
-  dcsr_aAxpy(-1.0,A,ub,b->val);
+  // b = b - Aub (only the non-boundary rows, the others are overwritten)
+  eliminate_dirichlet_pattern_RHS(dpat,A,ub,b->val,0,0);
 
   // Fix boundary values
-  for(i=0;i<ndof;i++) {
-    if(FE->dirichlet[i]==1) {
-      b->val[i] = ub[i];
-    }
+  for(k=0; k<dpat->nbrow; k++) {
+    i = dpat->brow[k];
+    b->val[i] = ub[i];
   }
 
-  if(ub) free(ub);
+  free_dirichlet_pattern(&loc);
 
   return;
 }
@@ -1000,13 +1817,42 @@ void *A,INT Atype,REAL time)
 */
 void block_eliminate_DirichletBC(void (*bc)(REAL *,REAL *,REAL,void *),block_fespace *FE,mesh_struct *mesh,dvector *b,
 void *A,INT Atype,REAL time)
+{
+  block_eliminate_DirichletBC_reuse(bc,FE,mesh,b,A,Atype,time,NULL);
+  return;
+}
+/******************************************************************************************************/
+
+/******************************************************************************************************/
+/*!
+* \fn block_eliminate_DirichletBC_reuse(void (*bc)(REAL *,REAL *,REAL,void *),block_fespace *FE,mesh_struct *mesh,dvector *b,
+void *A,INT Atype,REAL time,dirichlet_pattern *pat)
+*
+* \brief Same as block_eliminate_DirichletBC, reusing the Dirichlet pattern(s) of A
+*
+* \param bc            Function to get boundary condition at given coordinates.
+* \param FE            block FE Space
+* \param mesh          Mesh struct
+* \param b             RHS vector
+* \param A             Stiffness matrix
+* \param Atype         0 - CSR matrix; 1 - block CSR matrix
+* \param time          Physical time if time-dependent
+* \param pat           Dirichlet pattern (Atype=0) or array of one pattern per block (Atype=1),
+*                      or NULL to build temporary ones
+*
+* \return A            Global CSR matrix with boundaries eliminated
+* \return b            Global RHS vector with boundaries eliminated
+*
+*/
+void block_eliminate_DirichletBC_reuse(void (*bc)(REAL *,REAL *,REAL,void *),block_fespace *FE,mesh_struct *mesh,dvector *b,
+void *A,INT Atype,REAL time,dirichlet_pattern *pat)
 {
   if(Atype==0) {
     dCSRmat *Atemp = (dCSRmat *) A;
-    eliminate_DirichletBC_blockFE(bc,FE,mesh,b,Atemp,time);
+    eliminate_DirichletBC_blockFE_reuse(bc,FE,mesh,b,Atemp,time,pat);
   } else if(Atype==1) {
     block_dCSRmat *Atemp = (block_dCSRmat *) A;
-    eliminate_DirichletBC_blockFE_blockA(bc,FE,mesh,b,Atemp,time);
+    eliminate_DirichletBC_blockFE_blockA_reuse(bc,FE,mesh,b,Atemp,time,pat);
   } else {
     printf("Wrong type of matrix.  Not eliminating anything...\n\n");
   }
@@ -1039,13 +1885,41 @@ dvector *b,void *A,INT Atype,REAL time)
 */
 void block_eliminate_DirichletBC_RHS(void (*bc)(REAL *,REAL *,REAL,void *),block_fespace *FE,mesh_struct *mesh,
 dvector *b,void *A,INT Atype,REAL time)
+{
+  block_eliminate_DirichletBC_RHS_reuse(bc,FE,mesh,b,A,Atype,time,NULL);
+  return;
+}
+/******************************************************************************************************/
+
+/******************************************************************************************************/
+/*!
+* \fn block_eliminate_DirichletBC_RHS_reuse(void (*bc)(REAL *,REAL *,REAL,void *),block_fespace *FE,mesh_struct *mesh,
+dvector *b,void *A,INT Atype,REAL time,dirichlet_pattern *pat)
+*
+* \brief Same as block_eliminate_DirichletBC_RHS, reusing the Dirichlet pattern(s) of A
+*
+* \param bc            Function to get boundary condition at given coordinates.
+* \param FE            block FE Space
+* \param mesh          Mesh struct
+* \param b             RHS vector
+* \param A             Stiffness matrix (without boundaries eliminated)
+* \param Atype         0 - CSR matrix; 1 - block CSR matrix
+* \param time          Physical time if time-dependent
+* \param pat           Dirichlet pattern (Atype=0) or array of one pattern per block (Atype=1),
+*                      or NULL to build temporary ones
+*
+* \return b            Global RHS vector with boundaries eliminated
+*
+*/
+void block_eliminate_DirichletBC_RHS_reuse(void (*bc)(REAL *,REAL *,REAL,void *),block_fespace *FE,mesh_struct *mesh,
+dvector *b,void *A,INT Atype,REAL time,dirichlet_pattern *pat)
 {
   if(Atype==0) {
     dCSRmat *Atemp = (dCSRmat *) A;
-    eliminate_DirichletBC_RHS_blockFE(bc,FE,mesh,b,Atemp,time);
+    eliminate_DirichletBC_RHS_blockFE_reuse(bc,FE,mesh,b,Atemp,time,pat);
   } else if(Atype==1) {
     block_dCSRmat *Atemp = (block_dCSRmat *) A;
-    eliminate_DirichletBC_RHS_blockFE_blockA(bc,FE,mesh,b,Atemp,time);
+    eliminate_DirichletBC_RHS_blockFE_blockA_reuse(bc,FE,mesh,b,Atemp,time,pat);
   } else {
     printf("Wrong type of matrix.  Not eliminating anything...\n\n");
   }
@@ -1078,10 +1952,38 @@ dvector *b,void *A,INT Atype,REAL time)
 *
 */
 void eliminate_DirichletBC_blockFE(void (*bc)(REAL *,REAL *,REAL,void *),block_fespace *FE,mesh_struct *mesh,dvector *b,dCSRmat *A,REAL time)
+{
+  eliminate_DirichletBC_blockFE_reuse(bc,FE,mesh,b,A,time,NULL);
+  return;
+}
+/******************************************************************************************************/
+
+/******************************************************************************************************/
+/*!
+* \fn eliminate_DirichletBC_blockFE_reuse(void (*bc)(REAL *,REAL *,REAL,void *),block_fespace *FE,mesh_struct *mesh,dvector *b,dCSRmat *A,REAL time,dirichlet_pattern *pat)
+*
+* \brief Same as eliminate_DirichletBC_blockFE, but only touches the boundary rows
+*        and the boundary columns listed in a Dirichlet pattern (built on the first call).
+*
+* \param bc            Function to get boundary condition at given coordinates.
+* \param FE            block FE Space
+* \param mesh          Mesh struct
+* \param b             RHS vector
+* \param A             CSR stiffness matrix
+* \param time          Physical time if time-dependent
+* \param pat           Dirichlet pattern (from initialize_dirichlet_pattern, freed by free_dirichlet_pattern)
+*                      or NULL to build a temporary one
+*
+* \return A            Global CSR matrix with boundaries eliminated
+* \return b            Global RHS vector with boundaries eliminated
+*
+*/
+void eliminate_DirichletBC_blockFE_reuse(void (*bc)(REAL *,REAL *,REAL,void *),block_fespace *FE,mesh_struct *mesh,dvector *b,dCSRmat *A,REAL time,dirichlet_pattern *pat)
 {
   SHORT status;
-  INT i,j,cola,colb;
   INT ndof = FE->ndof;
+  dirichlet_pattern loc;
+  dirichlet_pattern *dpat;
 
   // Error Check
   if(A->row!=ndof || A->col!=ndof) {
@@ -1089,34 +1991,18 @@ void eliminate_DirichletBC_blockFE(void (*bc)(REAL *,REAL *,REAL,void *),block_f
     check_error(status, __FUNCTION__);
   }
 
+  initialize_dirichlet_pattern(&loc);
+  dpat = get_dirichlet_pattern(pat,&loc,A,FE->dirichlet,FE->dirichlet,1);
+
   // Fix RHS First b_interior = (b - A(0;u_bdry)^T)_interior
   //               b_bdry = u_bdry
   if(b!=NULL)
-  eliminate_DirichletBC_RHS_blockFE(bc,FE,mesh,b,A,time);
+  eliminate_DirichletBC_RHS_blockFE_reuse(bc,FE,mesh,b,A,time,dpat);
 
   // Now fix A
-  // Loop over rows of A
-  for (i=0; i<ndof; i++) {
-    cola = A->IA[i];
-    colb = A->IA[i+1];
-    if(FE->dirichlet[i]==1) { // Boundary Row
-      // Loop over columns and 0 out row except for diagonal
-      for(j=cola; j<colb; j++) {
-        if(A->JA[j]==i)
-        A->val[j] = 1.0;
-        else
-        A->val[j] = 0.0;
-      }
-    } else { // Non-boundary-row
-      // Loop over columns and 0 out if column is boundary
-      for(j=cola; j<colb; j++) {
-        if(FE->dirichlet[A->JA[j]]==1) {
-          // Zero out matrix entry
-          A->val[j] = 0.0;
-        }
-      }
-    }
-  }
+  eliminate_dirichlet_pattern(dpat,A);
+
+  free_dirichlet_pattern(&loc);
   return;
 }
 /******************************************************************************************************/
@@ -1142,12 +2028,41 @@ void eliminate_DirichletBC_blockFE(void (*bc)(REAL *,REAL *,REAL,void *),block_f
 *
 */
 void eliminate_DirichletBC_RHS_blockFE(void (*bc)(REAL *,REAL *,REAL,void *),block_fespace *FE,mesh_struct *mesh,dvector *b,dCSRmat *A,REAL time)
+{
+  eliminate_DirichletBC_RHS_blockFE_reuse(bc,FE,mesh,b,A,time,NULL);
+  return;
+}
+/******************************************************************************************************/
+
+/******************************************************************************************************/
+/*!
+* \fn eliminate_DirichletBC_RHS_blockFE_reuse(void (*bc)(REAL *,REAL *,REAL,void *),block_fespace *FE,mesh_struct *mesh,dvector *b,dCSRmat *A,REAL time,dirichlet_pattern *pat)
+*
+* \brief Same as eliminate_DirichletBC_RHS_blockFE, but the boundary values are only
+*        evaluated at the Dirichlet DOF and only the entries of A in boundary
+*        columns are used, as listed in a Dirichlet pattern (built on the first call).
+*
+* \param bc            Function to get boundary condition at given coordinates.
+* \param FE            block FE Space
+* \param mesh          Mesh struct
+* \param b             RHS vector
+* \param A             CSR stiffness matrix (without boundaries eliminated)
+* \param time          Physical time if time-dependent
+* \param pat           Dirichlet pattern (from initialize_dirichlet_pattern, freed by free_dirichlet_pattern)
+*                      or NULL to build a temporary one
+*
+* \return b            Global RHS vector with boundaries eliminated
+*
+*/
+void eliminate_DirichletBC_RHS_blockFE_reuse(void (*bc)(REAL *,REAL *,REAL,void *),block_fespace *FE,mesh_struct *mesh,dvector *b,dCSRmat *A,REAL time,dirichlet_pattern *pat)
 {
   SHORT status;
-  INT i,j;
+  INT i,j,k;
   INT ndof = FE->ndof;
-  INT ndof_local=0, entry = 0;
-  REAL* ub = (REAL *) calloc(ndof,sizeof(REAL));
+  INT entry = 0;
+  REAL* ub;
+  dirichlet_pattern loc;
+  dirichlet_pattern *dpat;
 
   // Error Check
   if(A->row!=ndof || A->col!=ndof) {
@@ -1155,30 +2070,32 @@ void eliminate_DirichletBC_RHS_blockFE(void (*bc)(REAL *,REAL *,REAL,void *),blo
     check_error(status, __FUNCTION__);
   }
 
+  initialize_dirichlet_pattern(&loc);
+  dpat = get_dirichlet_pattern(pat,&loc,A,FE->dirichlet,FE->dirichlet,1);
+  ub = dirichlet_pattern_values(dpat,ndof);
+
   // Get solution vector that's 0 on interior and boundary value on boundary
-  for(j=0;j<FE->nspaces;j++) {
-    ndof_local = FE->var_spaces[j]->ndof;
-    for(i=0; i<ndof_local; i++) {
-      if(FE->dirichlet[entry+i]==1) {
-        ub[entry + i] = blockFE_Evaluate_DOF(bc,FE,mesh,time,j,i);
-      } else {
-        ub[entry + i] = 0.0;
-      }
+  // (boundary rows are in increasing order, so walk through the spaces with them)
+  j = 0;
+  for(k=0; k<dpat->nbrow; k++) {
+    i = dpat->brow[k];
+    while(i>=entry+FE->var_spaces[j]->ndof) {
+      entry += FE->var_spaces[j]->ndof;
+      j++;
     }
-    entry += ndof_local;
+    ub[i] = blockFE_Evaluate_DOF(bc,FE,mesh,time,j,i-entry);
   }
 
-  // b = b - Aub
-  dcsr_aAxpy(-1.0,A,ub,b->val);
+  // b = b - Aub (only the non-boundary rows, the others are overwritten)
+  eliminate_dirichlet_pattern_RHS(dpat,A,ub,b->val,0,0);
 
   // Fix boundary values
-  for(i=0;i<ndof;i++) {
-    if(FE->dirichlet[i]==1) {
-      b->val[i] = ub[i];
-    }
+  for(k=0; k<dpat->nbrow; k++) {
+    i = dpat->brow[k];
+    b->val[i] = ub[i];
   }
 
-  if(ub) free(ub);
+  free_dirichlet_pattern(&loc);
 
   return;
 }
@@ -1212,37 +2129,50 @@ block_dCSRmat *A,REAL time)   *
 void eliminate_DirichletBC_blockFE_blockA(void (*bc)(REAL *, REAL *,REAL,void *),block_fespace *FE,mesh_struct *mesh,dvector *b,
 block_dCSRmat *A,REAL time)
 {
-  INT i,j,k,cola,colb;
-  //INT nsp = FE->nspaces;
-  INT nsp = A->brow;
+  eliminate_DirichletBC_blockFE_blockA_reuse(bc,FE,mesh,b,A,time,NULL);
+  return;
+}
+/******************************************************************************************************/
 
-  INT nrows;
+/******************************************************************************************************/
+/*!
+* \fn eliminate_DirichletBC_blockFE_blockA_reuse(void (*bc)(REAL *, REAL *,REAL,void *),block_fespace *FE,mesh_struct *mesh,dvector *b,
+block_dCSRmat *A,REAL time,dirichlet_pattern *pat)
+*
+* \brief Same as eliminate_DirichletBC_blockFE_blockA, but only touches the boundary
+*        rows and the boundary columns listed in one Dirichlet pattern per block
+*        (built on the first call).
+*
+* \param bc            Function to get boundary condition at given coordinates.
+* \param FE            block FE Space
+* \param mesh          Mesh struct
+* \param b             RHS vector
+* \param A             block CSR stiffness matrix
+* \param time          Physical time if time-dependent
+* \param pat           Array of A->brow*A->bcol Dirichlet patterns, one per block, ordered as
+*                      A->blocks (each from initialize_dirichlet_pattern, freed by
+*                      free_dirichlet_pattern), or NULL to build temporary ones
+*
+* \return A            Global block CSR matrix with boundaries eliminated
+* \return b            Global RHS vector with boundaries eliminated
+*
+*/
+void eliminate_DirichletBC_blockFE_blockA_reuse(void (*bc)(REAL *, REAL *,REAL,void *),block_fespace *FE,mesh_struct *mesh,dvector *b,
+block_dCSRmat *A,REAL time,dirichlet_pattern *pat)
+{
+  INT i,j;
+  INT nsp = A->brow;
   INT rowshift, colshift;
-  INT l;
+  dirichlet_pattern loc;
+  dirichlet_pattern *dpat;
 
   // Fix RHS First b_interior = (b - A(0;u_bdry)^T)_interior
   //               b_bdry = u_bdry
   if(b!=NULL)
-  eliminate_DirichletBC_RHS_blockFE_blockA(bc,FE,mesh,b,A,time);
+  eliminate_DirichletBC_RHS_blockFE_blockA_reuse(bc,FE,mesh,b,A,time,pat);
 
   // Find dof shifts needed for each block
-  INT *dofshift;
-  dofshift = (INT *)calloc(nsp,sizeof(INT));
-  for(i=0;i<nsp;i++){
-    for(j=0;j<nsp;j++){
-      if(dofshift[j]==0){
-        if(A->blocks[i+j*nsp] != NULL){
-          dofshift[j] = A->blocks[i+j*nsp]->row;
-        }
-      }
-    }
-  }
-  // Error Check
-  for(i=0;i<nsp;i++) {
-    if(dofshift[i]==0) {
-      printf("ERROR HAZMATH DANGER: in function %s: NULL BLOCK ROW in A.\n",__FUNCTION__);
-    }
-  }
+  INT *dofshift = block_dirichlet_shifts(A);
 
   colshift = 0;
   // Loop over blocks of A
@@ -1250,26 +2180,11 @@ block_dCSRmat *A,REAL time)
     rowshift = 0;
     for(j=0;j<nsp;j++){ // Loop over block rows
       if(A->blocks[i+j*nsp]!=NULL){
-        nrows = A->blocks[i+j*nsp]->row;
-        for(k=0;k<nrows;k++){ // Loop over matrix rows
-          cola = A->blocks[i+j*nsp]->IA[k];
-          colb = A->blocks[i+j*nsp]->IA[k+1];
-          if(FE->dirichlet[k+rowshift] == 1) { // Boundary Row
-            for(l=cola;l<colb;l++){ // Loop over matrix columns
-              if(A->blocks[i+j*nsp]->JA[l]==k && i==j) // diagonal Entry
-              A->blocks[i+j*nsp]->val[l] = 1.0;
-              else
-              A->blocks[i+j*nsp]->val[l] = 0.0;
-            }//end for(l)
-          } else { // Non-boundary Row
-            for(l=cola;l<colb;l++){ // Loop over matrix columns
-              if(FE->dirichlet[A->blocks[i+j*nsp]->JA[l]+colshift]==1) { // Boundary Column
-                // If column is boundary column, set to zero
-                A->blocks[i+j*nsp]->val[l] = 0.0;
-              }//end if(boundary column)
-            }//end for(l)
-          }//end Non-boundary Row
-        }//end for(k)
+        initialize_dirichlet_pattern(&loc);
+        dpat = get_dirichlet_pattern(pat ? &pat[i+j*nsp] : NULL,&loc,A->blocks[i+j*nsp],
+                                     FE->dirichlet+rowshift,FE->dirichlet+colshift,i==j);
+        eliminate_dirichlet_pattern(dpat,A->blocks[i+j*nsp]);
+        free_dirichlet_pattern(&loc);
       }//end if(A->blocks[i+j*nsp]!=NULL)
 
       // Update dof shift for rows
@@ -1307,11 +2222,47 @@ block_dCSRmat *A,REAL time)
 *
 */
 void eliminate_DirichletBC_RHS_blockFE_blockA(void (*bc)(REAL *,REAL *,REAL,void *),block_fespace *FE,mesh_struct *mesh,dvector *b,block_dCSRmat *A,REAL time)
+{
+  eliminate_DirichletBC_RHS_blockFE_blockA_reuse(bc,FE,mesh,b,A,time,NULL);
+  return;
+}
+/******************************************************************************************************/
+
+/******************************************************************************************************/
+/*!
+* \fn eliminate_DirichletBC_RHS_blockFE_blockA_reuse(void (*bc)(REAL *,REAL *,REAL,void *),block_fespace *FE,mesh_struct *mesh,dvector *b,block_dCSRmat *A,REAL time,dirichlet_pattern *pat)
+*
+* \brief Same as eliminate_DirichletBC_RHS_blockFE_blockA, but only the entries of
+*        the blocks of A in boundary columns are used, as listed in one Dirichlet
+*        pattern per block (built on the first call).
+*
+* \param bc            Function to get boundary condition at given coordinates.
+* \param FE            block FE Space
+* \param mesh          Mesh struct
+* \param b             RHS vector
+* \param A             block CSR stiffness matrix (without boundaries eliminated)
+* \param time          Physical time if time-dependent
+* \param pat           Array of A->brow*A->bcol Dirichlet patterns, one per block, ordered as
+*                      A->blocks (the first one also keeps the boundary values),
+*                      or NULL to build temporary ones
+*
+* \return b            Global RHS vector with boundaries eliminated
+*
+*/
+void eliminate_DirichletBC_RHS_blockFE_blockA_reuse(void (*bc)(REAL *,REAL *,REAL,void *),block_fespace *FE,mesh_struct *mesh,dvector *b,block_dCSRmat *A,REAL time,dirichlet_pattern *pat)
 {
   INT i,j;
+  INT nsp = A->brow;
   INT ndof = FE->ndof;
   INT ndof_local=0, entry = 0;
-  REAL* ub = (REAL *) calloc(ndof,sizeof(REAL));
+  INT rowshift, colshift;
+  REAL* ub;
+  dirichlet_pattern loc;
+  dirichlet_pattern *dpat;
+
+  // The boundary values are kept in the pattern of the first block
+  initialize_dirichlet_pattern(&loc);
+  ub = dirichlet_pattern_values(pat ? &pat[0] : &loc,ndof);
 
   // Get solution vector that's 0 on interior and boundary value on boundary
   for(j=0;j<FE->nspaces;j++) {
@@ -1319,15 +2270,30 @@ void eliminate_DirichletBC_RHS_blockFE_blockA(void (*bc)(REAL *,REAL *,REAL,void
     for(i=0; i<ndof_local; i++) {
       if(FE->dirichlet[entry+i]==1) {
         ub[entry + i] = blockFE_Evaluate_DOF(bc,FE,mesh,time,j,i);
-      } else {
-        ub[entry + i] = 0.0;
       }
     }
     entry += ndof_local;
   }
 
-  // b = b - Aub
-  bdcsr_aAxpy(-1.0,A,ub,b->val);
+  // b = b - Aub (only the non-boundary rows, the others are overwritten)
+  INT *dofshift = block_dirichlet_shifts(A);
+  dirichlet_pattern bloc;
+  colshift = 0;
+  for(i=0;i<nsp;i++){ // Loop over block cols
+    rowshift = 0;
+    for(j=0;j<nsp;j++){ // Loop over block rows
+      if(A->blocks[i+j*nsp]!=NULL){
+        initialize_dirichlet_pattern(&bloc);
+        dpat = get_dirichlet_pattern(pat ? &pat[i+j*nsp] : NULL,&bloc,A->blocks[i+j*nsp],
+                                     FE->dirichlet+rowshift,FE->dirichlet+colshift,i==j);
+        eliminate_dirichlet_pattern_RHS(dpat,A->blocks[i+j*nsp],ub,b->val,rowshift,colshift);
+        free_dirichlet_pattern(&bloc);
+      }
+      rowshift += dofshift[j];
+    }
+    colshift += dofshift[i];
+  }
+  free(dofshift);
 
   // Fix boundary values
   for(i=0;i<ndof;i++) {
@@ -1336,7 +2302,7 @@ void eliminate_DirichletBC_RHS_blockFE_blockA(void (*bc)(REAL *,REAL *,REAL,void
     }
   }
 
-  if(ub) free(ub);
+  free_dirichlet_pattern(&loc);
 
   return;
 }
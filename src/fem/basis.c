@@ -32,6 +32,8 @@
 * \return lam      Basis functions (1 for each vertex on element)
 * \return dlam     Derivatives of basis functions (i.e., gradient)
 *
+*  \note lam and dlam must be allocated before entering here.
+*
 *  \note Functions are defined as follows:
 *
 *        lam0 = 1 - x_1 - x_2 - ... - x_dim
@@ -46,9 +48,6 @@ void P1_basis_ref(REAL *lam,REAL *dlam,REAL *x,INT dim)
   // Loop Counters
   INT idim,jdim;
 
-  // Allocate here
-  lam = (REAL *) calloc(dim+1,sizeof(REAL));
-  dlam = (REAL *) calloc((dim+1)*dim,sizeof(REAL));
   lam[0] = 1.0;
   for(idim=0;idim<dim;idim++) {
     lam[0] -= x[idim];
@@ -125,18 +124,8 @@ void P1_basis_physical(REAL *lam,REAL *dlam,REAL *x,simplex_local_data* elm_data
     lam[i+1] = xr[i];
   }
 
-  // Get gradients
-  // dlam[0] = sum of rows of B^{-1}
-  // Then rest is just B^{-1}
-  REAL dlam0val;
-  for(i=0;i<dim;i++) {
-    dlam0val = 0.0;
-    for(j=0;j<dim;j++) {
-      dlam0val += binv[j*dim+i];
-      dlam[(i+1)*dim+j] = binv[i*dim+j];
-    }
-    dlam[i] = dlam0val;
-  }
+  // Get gradients (constant on the element and already stored in gradlams)
+  array_cp((dim+1)*dim,binv,dlam);
 
   if(xr) free(xr);
 
@@ -169,11 +158,11 @@ void P1_basis_physical(REAL *lam,REAL *dlam,REAL *x,simplex_local_data* elm_data
 *        But hat(lam0) = 1 - x_0 - x_1 - ... - x_d
 *            hat(lami) = x_i i = 1,..,d
 *        so
-*        B^{-1}^T grad(hat(lam0)) = (-(1,1,...1)*B^{-1})^T = sumofrows(B^{-1}) = grad(lam0)
+*        B^{-1}^T grad(hat(lam0)) = (-(1,1,...1)*B^{-1})^T = -sumofrows(B^{-1}) = grad(lam0)
 *        B^{-1}^T hat(lami) = B^{-1}^T ei = grad(lami) = (B^{-1})_rowi
 *
 *        lamgrads stores the following then,
-*        grad(lam)(x) = ( --- grad(lam0) --- ) =  ( sumrows(B^{-1}) )
+*        grad(lam)(x) = ( --- grad(lam0) --- ) =  ( -sumrows(B^{-1}) )
 *                     = ( --- grad(lam1) --- ) =  (   B^{-1)_row1   )
 *                     = (         |          ) =  (      |          )
 *                     = ( --- grad(lamd) --- ) =  (   B^{-1}_rowd   )
@@ -239,7 +228,7 @@ void compute_refelm_mapping(REAL* ref_map,REAL* lamgrads,REAL *xv,INT dim)
   // Get B
   for(i=0;i<dim;i++) {
     for(j=0;j<dim;j++) {
-      ref_map[i*dim+j] = xv[(j+1)*dim+i]-xv[0];
+      ref_map[i*dim+j] = xv[(j+1)*dim+i]-xv[i];
     }
   }
 
@@ -249,20 +238,69 @@ void compute_refelm_mapping(REAL* ref_map,REAL* lamgrads,REAL *xv,INT dim)
   ddense_inv(binv,dim,ref_map,wrk);
 
   // Place all grad(lam) in one matrix as rows
-  // First row is sum of rows of B-1
+  // First row is minus the sum of rows of B-1
   // Then rest is just B^{-1}
   REAL dlam0val;
   for(i=0;i<dim;i++) {
     dlam0val = 0.0;
     for(j=0;j<dim;j++) {
-      dlam0val += binv[j*dim+i];
-      lamgrads[(i+1)*dim+j] = binv[i*dim+j];
+      dlam0val -= binv[j*dim+i];
+      lamgrads[(j+1)*dim+i] = binv[j*dim+i];
     }
     lamgrads[i] = dlam0val;
   }
 
   if(binv) free(binv);
+  if(wrk) free(wrk);
+
+  return;
+}
+/******************************************************************************/
 
+/*!
+* \fn void P1_basis_grad_elm(REAL *dlam,REAL *xv,INT dim)
+*
+* \brief Gradients of the P1 basis functions (constant on the simplex) computed
+*        directly from the coordinates of the vertices.  Same result as the lamgrads
+*        of compute_refelm_mapping, without a general matrix inverse.
+*
+* \param xv      Coordinates of the vertices (xv[k*dim+d], k=0,...,dim)
+* \param dim     Dimension of problem (1, 2 or 3)
+*
+* \return dlam   Gradients of the P1 basis functions ((dim+1)*dim)
+*
+*/
+void P1_basis_grad_elm(REAL *dlam,REAL *xv,INT dim)
+{
+  INT k,d;
+  REAL e[9],det;
+  for(k=0;k<dim;k++)
+    for(d=0;d<dim;d++)
+      e[k*dim+d] = xv[(k+1)*dim+d] - xv[d];
+  if(dim==1) {
+    dlam[1] = 1.0/e[0];
+  } else if(dim==2) {
+    det = e[0]*e[3] - e[2]*e[1];
+    dlam[2] =  e[3]/det; dlam[3] = -e[2]/det;
+    dlam[4] = -e[1]/det; dlam[5] =  e[0]/det;
+  } else {
+    // rows of the inverse of [e1 e2 e3] are the cross products over det
+    dlam[3]  = e[4]*e[8] - e[5]*e[7];
+    dlam[4]  = e[5]*e[6] - e[3]*e[8];
+    dlam[5]  = e[3]*e[7] - e[4]*e[6];
+    dlam[6]  = e[7]*e[2] - e[8]*e[1];
+    dlam[7]  = e[8]*e[0] - e[6]*e[2];
+    dlam[8]  = e[6]*e[1] - e[7]*e[0];
+    dlam[9]  = e[1]*e[5] - e[2]*e[4];
+    dlam[10] = e[2]*e[3] - e[0]*e[5];
+    dlam[11] = e[0]*e[4] - e[1]*e[3];
+    det = e[0]*dlam[3] + e[1]*dlam[4] + e[2]*dlam[5];
+    for(d=3;d<12;d++) dlam[d] /= det;
+  }
+  for(d=0;d<dim;d++) {
+    dlam[d] = 0.0;
+    for(k=1;k<=dim;k++) dlam[d] -= dlam[k*dim+d];
+  }
   return;
 }
 /******************************************************************************/
@@ -768,7 +806,7 @@ void get_FEM_basis_on_elm(REAL *phi,REAL *dphi,simplex_local_data *simplex_data,
 
   } else if(fe_type==60) { // Vector element
 
-    for(i=0;i<dim;i++) PX_basis(phi+i*dim_offset,dphi+i*dof_per_elm,fe_type,dim,lam,dlam);
+    for(i=0;i<dim;i++) PX_basis(phi+i*dim_offset,dphi+i*dof_per_elm,1,dim,lam,dlam);
 
   } else if(fe_type==61) { // Bubble element
 
@@ -787,6 +825,57 @@ void get_FEM_basis_on_elm(REAL *phi,REAL *dphi,simplex_local_data *simplex_data,
 }
 /******************************************************************************/
 
+/*!
+* \fn void tabulate_FEM_basis_ref(fe_local_data *fe_data,REAL *lams,REAL *dlams,INT nq,INT dim)
+*
+* \brief Computes the basis functions and gradients of the Lagrange spaces
+*        (PX and vector P1) on the reference element at all quadrature points.
+*        This is done once per quadrature rule and the values are mapped to each
+*        element in get_FEM_basis_at_quadpt.
+*
+* \param lams          P1 basis functions at the nq reference quadrature points
+* \param dlams         Gradients of the P1 basis functions on the reference element
+* \param nq            Number of quadrature points
+* \param dim           Dimension of problem
+*
+* \return fe_data->phi_ref[i]      Basis functions at each quadrature point (NULL if not tabulated)
+* \return fe_data->dphi_ref[i]     Gradients in reference coordinates at each quadrature point
+*
+* \note Nedelec, Raviart-Thomas and bubble elements are not tabulated.  They are
+*       built from the P1 values (tabulated in simplex_data->lams) and the P1
+*       gradients on the element, which gives the Piola transforms of the
+*       reference functions.
+*
+*/
+void tabulate_FEM_basis_ref(fe_local_data *fe_data,REAL *lams,REAL *dlams,INT nq,INT dim)
+{
+  INT i,q,fe_type,porder,nd;
+
+  fe_data->nq = nq;
+  fe_data->phi_ref = (REAL **) calloc(fe_data->nspaces,sizeof(REAL *));
+  fe_data->dphi_ref = (REAL **) calloc(fe_data->nspaces,sizeof(REAL *));
+  for(i=0;i<fe_data->nspaces;i++) {
+    fe_type = fe_data->fe_types[i];
+    if(fe_type>=0 && fe_type<10) {
+      porder = fe_type;
+      nd = fe_data->n_dof_per_space[i];
+    } else if(fe_type==60) { // Each component is P1
+      porder = 1;
+      nd = dim+1;
+    } else {
+      continue;
+    }
+    fe_data->phi_ref[i] = (REAL *) calloc(nq*nd,sizeof(REAL));
+    fe_data->dphi_ref[i] = (REAL *) calloc(nq*nd*dim,sizeof(REAL));
+    for(q=0;q<nq;q++) {
+      PX_basis(fe_data->phi_ref[i]+q*nd,fe_data->dphi_ref[i]+q*nd*dim,porder,dim,lams+q*(dim+1),dlams);
+    }
+  }
+
+  return;
+}
+/******************************************************************************/
+
 /*!
 * \fn void get_FEM_basis_at_quadpt(simplex_local_data *simplex_data,fe_local_data *fe_data,INT space_index,INT quadpt)
 *
@@ -801,6 +890,9 @@ void get_FEM_basis_on_elm(REAL *phi,REAL *dphi,simplex_local_data *simplex_data,
 * \param quadpt          Index of quadrature point basis is to be evaluated at
 *
 * \note ordering of quad point is determined by get_quadrature routine
+* \note If the space was tabulated on the reference element, the values are
+*       copied and the gradients are mapped with B^{-T}, whose columns are the
+*       gradients of the P1 basis on the element (stored in gradlams).
 *
 * \return fe_data->phi[space_index]      Basis functions
 * \return fe_data->dphi[space_index]     Derivatives of basis functions (depends on type)
@@ -808,14 +900,39 @@ void get_FEM_basis_on_elm(REAL *phi,REAL *dphi,simplex_local_data *simplex_data,
 */
 void get_FEM_basis_at_quadpt(simplex_local_data *simplex_data,fe_local_data *fe_data,INT space_index,INT quadpt)
 {
+  INT i,j,k,icomp,ncomp,nd;
+  REAL s;
 
   INT dim = simplex_data->dim;
-  // P1 basis functions at quadpt
+  // P1 basis functions at quadpt and their gradients (constant on the element)
   REAL* lam = simplex_data->lams + quadpt*(dim+1);
-  REAL* dlam = simplex_data->gradlams + quadpt*((dim+1)*dim);
-
-  // Call general function at any x
-  get_FEM_basis_on_elm(fe_data->phi[space_index],fe_data->dphi[space_index],simplex_data,fe_data,lam,dlam,space_index);
+  REAL* dlam = simplex_data->gradlams;
+
+  REAL* phi = fe_data->phi[space_index];
+  REAL* dphi = fe_data->dphi[space_index];
+
+  if(fe_data->phi_ref && fe_data->phi_ref[space_index]) {
+    // Tabulated Lagrange space
+    ncomp = (fe_data->fe_types[space_index]==60) ? dim : 1;
+    nd = fe_data->n_dof_per_space[space_index]/ncomp;
+    REAL* pref = fe_data->phi_ref[space_index] + quadpt*nd;
+    REAL* dpref = fe_data->dphi_ref[space_index] + quadpt*nd*dim;
+    for(icomp=0;icomp<ncomp;icomp++) {
+      array_cp(nd,pref,phi+icomp*nd);
+      if(dphi==NULL) continue;
+      // grad(phi_i) = sum_j d(phi_i)/d(xr_j) * grad(lam_{j+1})
+      for(i=0;i<nd;i++) {
+        for(k=0;k<dim;k++) {
+          s = 0.0;
+          for(j=0;j<dim;j++) s += dpref[i*dim+j]*dlam[(j+1)*dim+k];
+          dphi[icomp*nd*dim+i*dim+k] = s;
+        }
+      }
+    }
+  } else {
+    // Call general function at any x
+    get_FEM_basis_on_elm(phi,dphi,simplex_data,fe_data,lam,dlam,space_index);
+  }
 
   return;
 }
@@ -1896,3 +2013,124 @@ void get_FEM_basis(REAL *phi,REAL *dphi,REAL *x,INT *v_on_elm,INT *dof,mesh_stru
   return;
 }
 /****************************************************************************************************************************/
+
+/****************************************************************************************************************************/
+/*!
+* \fn INT tabulate_FEM_basis_elm(REAL *dlam,fespace *FE,qcoordinates *cq,INT *v_on_elm,mesh_struct *mesh)
+*
+* \brief Prepares get_FEM_basis_tabulated on an element.  The basis functions of a
+*        Lagrange space and their gradients are tabulated on the reference element at
+*        the reference nodes of cq (once per rule, kept in FE), and the gradients of
+*        the P1 basis on the element are computed (once per element).
+*
+* \param FE        Fespace struct
+* \param cq        Quadrature nodes on the element (from quad_elm)
+* \param v_on_elm  Vertices on element
+* \param mesh      Mesh struct
+*
+* \return dlam     Gradients of the P1 basis on the element ((dim+1)*dim)
+* \return          1 if the basis is tabulated; 0 if get_FEM_basis must be used
+*
+* \note Nedelec, Raviart-Thomas and bubble spaces are not tabulated.
+*
+*/
+INT tabulate_FEM_basis_elm(REAL *dlam,fespace *FE,qcoordinates *cq,INT *v_on_elm,mesh_struct *mesh)
+{
+  INT i,q,porder,nd;
+  INT dim = mesh->dim;
+  INT nq = cq->nq_per_elm;
+
+  if(FE->FEtype>=0 && FE->FEtype<10) { // PX elements
+    porder = FE->FEtype;
+    nd = FE->dof_per_elm;
+  } else if(FE->FEtype==60) { // Each component is P1
+    porder = 1;
+    nd = dim+1;
+  } else {
+    return 0;
+  }
+  if(cq->ref_x==NULL) return 0;
+
+  // Basis on the reference element at the nodes of the rule
+  if(FE->nq_ref!=nq) {
+    REAL lam[dim+1],dlamref[(dim+1)*dim];
+    if(FE->phi_ref) free(FE->phi_ref);
+    if(FE->dphi_ref) free(FE->dphi_ref);
+    FE->phi_ref = (REAL *) calloc(nq*nd,sizeof(REAL));
+    FE->dphi_ref = (REAL *) calloc(nq*nd*dim,sizeof(REAL));
+    for(q=0;q<nq;q++) {
+      P1_basis_ref(lam,dlamref,cq->ref_x+q*dim,dim);
+      PX_basis(FE->phi_ref+q*nd,FE->dphi_ref+q*nd*dim,porder,dim,lam,dlamref);
+    }
+    FE->nq_ref = nq;
+  }
+
+  // Gradients of the P1 basis on the element (same vertex order as quad_elm)
+  REAL xv[(dim+1)*dim];
+  coordinates* cv = mesh->cv;
+  for(i=0;i<=dim;i++) {
+    xv[i*dim] = cv->x[v_on_elm[i]];
+    if(dim>1) xv[i*dim+1] = cv->y[v_on_elm[i]];
+    if(dim>2) xv[i*dim+2] = cv->z[v_on_elm[i]];
+  }
+  P1_basis_grad_elm(dlam,xv,dim);
+
+  return 1;
+}
+/****************************************************************************************************************************/
+
+/* grad(phi_i) = sum_j d(phi_i)/d(xr_j) * grad(lam_{j+1}) for the nd reference
+ * gradients dpref, with dlam the P1 gradients on the element */
+static inline void map_ref_gradients(REAL *dphi,REAL *dpref,REAL *dlam,INT nd,const INT dim)
+{
+  INT i,j,k;
+  REAL s;
+  for(i=0;i<nd;i++) {
+    for(k=0;k<dim;k++) {
+      s = 0.0;
+      for(j=0;j<dim;j++) s += dpref[i*dim+j]*dlam[(j+1)*dim+k];
+      dphi[i*dim+k] = s;
+    }
+  }
+  return;
+}
+
+/****************************************************************************************************************************/
+/*!
+* \fn void get_FEM_basis_tabulated(REAL *phi,REAL *dphi,REAL *dlam,INT quad,fespace *FE,INT dim)
+*
+* \brief Grabs the basis function of a Lagrange space at a quadrature node of an
+*        element from the table built by tabulate_FEM_basis_elm.  Gives the same
+*        values as get_FEM_basis at that node: the values are copied and the
+*        gradients are mapped with the P1 gradients of the element.
+*
+* \param dlam      Gradients of the P1 basis on the element (from tabulate_FEM_basis_elm)
+* \param quad      Index of the quadrature node
+* \param FE        Fespace struct
+* \param dim       Dimension of problem
+*
+* \return phi      Basis functions
+* \return dphi     Gradients of basis functions (not computed if NULL)
+*
+*/
+void get_FEM_basis_tabulated(REAL *phi,REAL *dphi,REAL *dlam,INT quad,fespace *FE,INT dim)
+{
+  INT icomp;
+
+  INT ncomp = (FE->FEtype==60) ? dim : 1;
+  INT nd = FE->dof_per_elm/ncomp;
+  REAL* pref = FE->phi_ref + quad*nd;
+  REAL* dpref = FE->dphi_ref + quad*nd*dim;
+
+  for(icomp=0;icomp<ncomp;icomp++) {
+    array_cp(nd,pref,phi+icomp*nd);
+    if(dphi==NULL) continue;
+    // Constant dim so that the small loops are unrolled
+    if(dim==3) map_ref_gradients(dphi+icomp*nd*dim,dpref,dlam,nd,3);
+    else if(dim==2) map_ref_gradients(dphi+icomp*nd*dim,dpref,dlam,nd,2);
+    else map_ref_gradients(dphi+icomp*nd*dim,dpref,dlam,nd,1);
+  }
+
+  return;
+}
+/****************************************************************************************************************************/
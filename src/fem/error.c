@@ -53,6 +53,9 @@ REAL L2norm(REAL *u,fespace *FE,mesh_struct *mesh,qcoordinates *cq)
     //Find Nodes for given Element if not H1 elements
     get_incidence_row(i,mesh->el_v,v_on_elm);
 
+    // Quadrature nodes on the element
+    quad_elm(cq,mesh,cq->nq1d,i);
+
     // Compute Local Stiffness Matrix for given Element
     assemble_mass_local(MLoc,FE,mesh,cq,dof_on_elm,v_on_elm,i,constant_coeff_scal,1.0);
 
@@ -140,6 +143,9 @@ REAL L2_InnerProduct(REAL *u,REAL *v,fespace *FE,mesh_struct *mesh,qcoordinates
     //Find Nodes for given Element if not H1 elements
     get_incidence_row(i,mesh->el_v,v_on_elm);
 
+    // Quadrature nodes on the element
+    quad_elm(cq,mesh,cq->nq1d,i);
+
     // Compute Local Stiffness Matrix for given Element
     assemble_mass_local(MLoc,FE,mesh,cq,dof_on_elm,v_on_elm,i,constant_coeff_scal,1.0);
 
@@ -213,7 +219,7 @@ REAL L2error(REAL *u,void (*truesol)(REAL *,REAL *,REAL,void *),fespace *FE,mesh
 
   // Quadrature Weights and Nodes
   REAL w;
-  REAL* qx = (REAL *) calloc(mesh->dim,sizeof(REAL));
+  REAL* qx;
 
   // FE Stuff
   //INT FEtype = FE->FEtype;
@@ -232,8 +238,12 @@ REAL L2error(REAL *u,void (*truesol)(REAL *,REAL *,REAL,void *),fespace *FE,mesh
   } else { // Vector Elements
     ncomp = dim;
   }
-  REAL* val_true = (REAL *) calloc(ncomp,sizeof(REAL));
+  REAL* qxs = (REAL *) calloc(cq->nq_per_elm*dim,sizeof(REAL));
+  REAL* true_vals = (REAL *) calloc(cq->nq_per_elm*ncomp,sizeof(REAL));
+  REAL* val_true;
   REAL* val_sol = (REAL *) calloc(ncomp,sizeof(REAL));
+  REAL dlam[(dim+1)*dim];
+  INT tab;
 
   /* Loop over all Elements */
   for (elm=0; elm<FE->nelm; elm++) {
@@ -244,20 +254,30 @@ REAL L2error(REAL *u,void (*truesol)(REAL *,REAL *,REAL,void *),fespace *FE,mesh
     // Find Vertices for given Element if not H1 elements
     get_incidence_row(elm,mesh->el_v,v_on_elm);
 
+    // Quadrature nodes on the element
+    quad_elm(cq,mesh,cq->nq1d,elm);
+
+    // Quadrature nodes and true solution at all of them
+    evaluate_function_on_elm(true_vals,qxs,ncomp,truesol,cq,dim,time,&(mesh->el_flag[elm]));
+
+    // Basis tabulated at the quadrature nodes (Lagrange spaces)
+    tab = tabulate_FEM_basis_elm(dlam,FE,cq,v_on_elm,mesh);
+
     // Loop over quadrature nodes on element
     for (quad=0;quad<cq->nq_per_elm;quad++) {
-      qx[0] = cq->x[elm*cq->nq_per_elm+quad];
-      if(mesh->dim==2 || mesh->dim==3)
-        qx[1] = cq->y[elm*cq->nq_per_elm+quad];
-      if(mesh->dim==3)
-        qx[2] = cq->z[elm*cq->nq_per_elm+quad];
-      w = cq->w[elm*cq->nq_per_elm+quad];
+      qx = qxs+quad*dim;
+      w = cq->w[quad];
 
       // Get True Solution at Quadrature Nodes
-      (*truesol)(val_true,qx,time,&(mesh->el_flag[elm]));
+      val_true = true_vals+quad*ncomp;
 
       // Interpolate FE solution to quadrature point
-      FE_Interpolation(val_sol,u,qx,dof_on_elm,v_on_elm,FE,mesh);
+      if(tab) {
+        get_FEM_basis_tabulated(FE->phi,NULL,dlam,quad,FE,dim);
+        FE_Interpolation_basis(val_sol,u,dof_on_elm,FE,dim);
+      } else {
+        FE_Interpolation(val_sol,u,qx,dof_on_elm,v_on_elm,FE,mesh);
+      }
 
       // Compute Error on Element
       for(j=0;j<ncomp;j++) {
@@ -269,8 +289,8 @@ REAL L2error(REAL *u,void (*truesol)(REAL *,REAL *,REAL,void *),fespace *FE,mesh
 
   if(dof_on_elm) free(dof_on_elm);
   if(v_on_elm) free(v_on_elm);
-  if(qx) free(qx);
-  if(val_true) free(val_true);
+  if(qxs) free(qxs);
+  if(true_vals) free(true_vals);
   if(val_sol) free(val_sol);
 
   return sqrt(sum);
@@ -306,7 +326,7 @@ void L2error_block(REAL *err,REAL *u,void (*truesol)(REAL *,REAL *,REAL,void *),
 
   // Quadrature Weights and Nodes
   REAL w;
-  REAL* qx = (REAL *) calloc(dim,sizeof(REAL));
+  REAL* qx;
 
   // FEM Stuff
   INT nspaces = FE->nspaces;
@@ -323,7 +343,9 @@ void L2error_block(REAL *err,REAL *u,void (*truesol)(REAL *,REAL *,REAL,void *),
     nun += ncomp[i];
   }
   INT* dof_on_elm = (INT *) calloc(dof_per_elm,sizeof(INT));
-  REAL* val_true = (REAL *) calloc(nun,sizeof(REAL));
+  REAL* qxs = (REAL *) calloc(cq->nq_per_elm*dim,sizeof(REAL));
+  REAL* true_vals = (REAL *) calloc(cq->nq_per_elm*nun,sizeof(REAL));
+  REAL* val_true;
   REAL* val_sol = (REAL *) calloc(nun,sizeof(REAL));
 
   /* Loop over all Elements */
@@ -344,17 +366,19 @@ void L2error_block(REAL *err,REAL *u,void (*truesol)(REAL *,REAL *,REAL,void *),
     // Find vertices for given Element
     get_incidence_row(elm,mesh->el_v,v_on_elm);
 
+    // Quadrature nodes on the element
+    quad_elm(cq,mesh,cq->nq1d,elm);
+
+    // Quadrature nodes and true solution at all of them
+    evaluate_function_on_elm(true_vals,qxs,nun,truesol,cq,dim,time,&(mesh->el_flag[elm]));
+
     // Loop over quadrature nodes on element
     for (quad=0;quad<cq->nq_per_elm;quad++) {
-      qx[0] = cq->x[elm*cq->nq_per_elm+quad];
-      if(mesh->dim==2 || mesh->dim==3)
-        qx[1] = cq->y[elm*cq->nq_per_elm+quad];
-      if(mesh->dim==3)
-        qx[2] = cq->z[elm*cq->nq_per_elm+quad];
-      w = cq->w[elm*cq->nq_per_elm+quad];
+      qx = qxs+quad*dim;
+      w = cq->w[quad];
 
       // Get True Solution at Quadrature Nodes
-      (*truesol)(val_true,qx,time,&(mesh->el_flag[elm]));
+      val_true = true_vals+quad*nun;
 
       // Interpolate FE solution to quadrature point
       blockFE_Interpolation(val_sol,u,qx,dof_on_elm,v_on_elm,FE,mesh);
@@ -376,8 +400,8 @@ void L2error_block(REAL *err,REAL *u,void (*truesol)(REAL *,REAL *,REAL,void *),
 
   if(dof_on_elm) free(dof_on_elm);
   if(v_on_elm) free(v_on_elm);
-  if(qx) free(qx);
-  if(val_true) free(val_true);
+  if(qxs) free(qxs);
+  if(true_vals) free(true_vals);
   if(val_sol) free(val_sol);
   if(ncomp) free(ncomp);
 
@@ -427,6 +451,9 @@ REAL L2error_mass(REAL *u,void (*truesol)(REAL *,REAL *,REAL,void *),fespace *FE
     //Find Nodes for given Element if not H1 elements
     get_incidence_row(i,mesh->el_v,v_on_elm);
 
+    // Quadrature nodes on the element
+    quad_elm(cq,mesh,cq->nq1d,i);
+
     // Compute Local Stiffness Matrix for given Element
     assemble_mass_local(MLoc,FE,mesh,cq,dof_on_elm,v_on_elm,i,constant_coeff_scal,1.0);
 
@@ -488,6 +515,9 @@ void L2error_block_mass(REAL *err, REAL *u,void (*truesol)(REAL *,REAL *,REAL,vo
     // Find vertices for given Element
     get_incidence_row(elm,mesh->el_v,v_on_elm);
 
+    // Quadrature nodes on the element
+    quad_elm(cq,mesh,cq->nq1d,elm);
+
     // Get DOF and error on DOF for given element for each FE space
     u_dof=0;
     for(i=0;i<nspaces;i++) {
@@ -572,6 +602,9 @@ REAL HDseminorm(REAL *u,fespace *FE,mesh_struct *mesh,qcoordinates *cq)
       //Find Nodes for given Element if not H1 elements
       get_incidence_row(i,mesh->el_v,v_on_elm);
 
+      // Quadrature nodes on the element
+      quad_elm(cq,mesh,cq->nq1d,i);
+
       // Compute Local Stiffness Matrix for given Element
       assemble_DuDv_local(ALoc,FE,mesh,cq,dof_on_elm,v_on_elm,i,constant_coeff_scal,1.0);
 
@@ -656,7 +689,7 @@ REAL HDsemierror(REAL *u,void (*D_truesol)(REAL *,REAL *,REAL,void *),fespace *F
 
   // Quadrature Weights and Nodes
   REAL w;
-  REAL* qx = (REAL *) calloc(mesh->dim,sizeof(REAL));
+  REAL* qx;
 
   // FE Stuff
   INT FEtype = FE->FEtype;
@@ -676,8 +709,12 @@ REAL HDsemierror(REAL *u,void (*D_truesol)(REAL *,REAL *,REAL,void *),fespace *F
   } else { // 2D Nedelec -> Curl is a scalar or RT -> Div is a scalar
     ncomp = 1;
   }
-  REAL* val_true = (REAL *) calloc(ncomp,sizeof(REAL));
+  REAL* qxs = (REAL *) calloc(cq->nq_per_elm*dim,sizeof(REAL));
+  REAL* true_vals = (REAL *) calloc(cq->nq_per_elm*ncomp,sizeof(REAL));
+  REAL* val_true;
   REAL* val_sol = (REAL *) calloc(ncomp,sizeof(REAL));
+  REAL dlam[(dim+1)*dim];
+  INT tab;
 
   /* Loop over all Elements */
   for (elm=0; elm<FE->nelm; elm++) {
@@ -688,21 +725,31 @@ REAL HDsemierror(REAL *u,void (*D_truesol)(REAL *,REAL *,REAL,void *),fespace *F
     //Find Vertices for given Element if not H1 elements
     get_incidence_row(elm,mesh->el_v,v_on_elm);
 
+    // Quadrature nodes on the element
+    quad_elm(cq,mesh,cq->nq1d,elm);
+
+    // Quadrature nodes and true solution at all of them
+    evaluate_function_on_elm(true_vals,qxs,ncomp,D_truesol,cq,dim,time,&(mesh->el_flag[elm]));
+
+    // Basis tabulated at the quadrature nodes (Lagrange spaces)
+    tab = tabulate_FEM_basis_elm(dlam,FE,cq,v_on_elm,mesh);
+
     // Loop over quadrature nodes on element
 
     for (quad=0;quad<cq->nq_per_elm;quad++) {
-      qx[0] = cq->x[elm*cq->nq_per_elm+quad];
-      if(mesh->dim==2 || mesh->dim==3)
-        qx[1] = cq->y[elm*cq->nq_per_elm+quad];
-      if(mesh->dim==3)
-        qx[2] = cq->z[elm*cq->nq_per_elm+quad];
-      w = cq->w[elm*cq->nq_per_elm+quad];
+      qx = qxs+quad*dim;
+      w = cq->w[quad];
 
       // Get True Solution at Quadrature Nodes
-      (*D_truesol)(val_true,qx,time,&(mesh->el_flag[elm]));
+      val_true = true_vals+quad*ncomp;
 
       // Interpolate FE solution to quadrature point
-      FE_DerivativeInterpolation(val_sol,u,qx,dof_on_elm,v_on_elm,FE,mesh);
+      if(tab) {
+        get_FEM_basis_tabulated(FE->phi,FE->dphi,dlam,quad,FE,dim);
+        FE_DerivativeInterpolation_basis(val_sol,u,dof_on_elm,FE,dim);
+      } else {
+        FE_DerivativeInterpolation(val_sol,u,qx,dof_on_elm,v_on_elm,FE,mesh);
+      }
 
       // Compute Error on Element
       for(j=0;j<ncomp;j++) {
@@ -714,8 +761,8 @@ REAL HDsemierror(REAL *u,void (*D_truesol)(REAL *,REAL *,REAL,void *),fespace *F
 
   if(dof_on_elm) free(dof_on_elm);
   if(v_on_elm) free(v_on_elm);
-  if(qx) free(qx);
-  if(val_true) free(val_true);
+  if(qxs) free(qxs);
+  if(true_vals) free(true_vals);
   if(val_sol) free(val_sol);
 
   return sqrt(sum);
@@ -753,7 +800,7 @@ void HDsemierror_block(REAL *err,REAL *u,void (*D_truesol)(REAL *,REAL *,REAL,vo
 
   // Quadrature Weights and Nodes
   REAL w;
-  REAL* qx = (REAL *) calloc(dim,sizeof(REAL));
+  REAL* qx;
 
   // FEM Stuff
   INT nspaces = FE->nspaces;
@@ -774,7 +821,9 @@ void HDsemierror_block(REAL *err,REAL *u,void (*D_truesol)(REAL *,REAL *,REAL,vo
     nun += ncomp[i];
   }
   INT* dof_on_elm = (INT *) calloc(dof_per_elm,sizeof(INT));
-  REAL* val_true = (REAL *) calloc(nun,sizeof(REAL));
+  REAL* qxs = (REAL *) calloc(cq->nq_per_elm*dim,sizeof(REAL));
+  REAL* true_vals = (REAL *) calloc(cq->nq_per_elm*nun,sizeof(REAL));
+  REAL* val_true;
   REAL* val_sol = (REAL *) calloc(nun,sizeof(REAL));
 
   /* Loop over all Elements */
@@ -795,17 +844,19 @@ void HDsemierror_block(REAL *err,REAL *u,void (*D_truesol)(REAL *,REAL *,REAL,vo
     // Find vertices for given Element
     get_incidence_row(elm,mesh->el_v,v_on_elm);
 
+    // Quadrature nodes on the element
+    quad_elm(cq,mesh,cq->nq1d,elm);
+
+    // Quadrature nodes and true solution at all of them
+    evaluate_function_on_elm(true_vals,qxs,nun,D_truesol,cq,dim,time,&(mesh->el_flag[elm]));
+
     // Loop over quadrature nodes on element
     for (quad=0;quad<cq->nq_per_elm;quad++) {
-      qx[0] = cq->x[elm*cq->nq_per_elm+quad];
-      if(mesh->dim==2 || mesh->dim==3)
-        qx[1] = cq->y[elm*cq->nq_per_elm+quad];
-      if(mesh->dim==3)
-        qx[2] = cq->z[elm*cq->nq_per_elm+quad];
-      w = cq->w[elm*cq->nq_per_elm+quad];
+      qx = qxs+quad*dim;
+      w = cq->w[quad];
 
       // Get True Solution at Quadrature Nodes
-      (*D_truesol)(val_true,qx,time,&(mesh->el_flag[elm]));
+      val_true = true_vals+quad*nun;
 
       // Interpolate FE solution to quadrature point
       blockFE_DerivativeInterpolation(val_sol,u,qx,dof_on_elm,v_on_elm,FE,mesh);
@@ -831,8 +882,8 @@ void HDsemierror_block(REAL *err,REAL *u,void (*D_truesol)(REAL *,REAL *,REAL,vo
 
   if(dof_on_elm) free(dof_on_elm);
   if(v_on_elm) free(v_on_elm);
-  if(qx) free(qx);
-  if(val_true) free(val_true);
+  if(qxs) free(qxs);
+  if(true_vals) free(true_vals);
   if(val_sol) free(val_sol);
   if(ncomp) free(ncomp);
 
@@ -884,6 +935,9 @@ REAL HDsemierror_stiff(REAL *u,void (*truesol)(REAL *,REAL *,REAL,void *),fespac
     //Find Nodes for given Element if not H1 elements
     get_incidence_row(i,mesh->el_v,v_on_elm);
 
+    // Quadrature nodes on the element
+    quad_elm(cq,mesh,cq->nq1d,i);
+
     // Compute Local Stiffness Matrix for given Element
     assemble_DuDv_local(ALoc,FE,mesh,cq,dof_on_elm,v_on_elm,i,constant_coeff_scal,1.0);
 
@@ -947,6 +1001,9 @@ void HDsemierror_block_stiff(REAL *err, REAL *u,void (*truesol)(REAL *,REAL *,RE
     // Find vertices for given Element
     get_incidence_row(elm,mesh->el_v,v_on_elm);
 
+    // Quadrature nodes on the element
+    quad_elm(cq,mesh,cq->nq1d,elm);
+
     // Get DOF and error on DOF for given element for each FE space
     u_dof=0;
     for(i=0;i<nspaces;i++) {
@@ -1168,6 +1225,9 @@ REAL energynorm_discrete(REAL *u,fespace *FE,mesh_struct *mesh,qcoordinates *cq,
     // Find Nodes for given Element if not H1 elements
     get_incidence_row(i,mesh->el_v,v_on_elm);
 
+    // Quadrature nodes on the element
+    quad_elm(cq,mesh,cq->nq1d,i);
+
     // Compute Local Stiffness Matrix(operator associated with energy norm) for given Element
     (*local_assembly_routine)(ALoc,FE,mesh,cq,dof_on_elm,v_on_elm,i,coeff,param);
 
@@ -1187,3 +1247,225 @@ REAL energynorm_discrete(REAL *u,fespace *FE,mesh_struct *mesh,qcoordinates *cq,
 }
 
 /***************************************************************************/
+
+/* Quadrature on face f for the square of the jump of the normal
+   derivative of a P1 (constant jump: midpoint) or P2 function (linear
+   jump: Simpson's rule on an edge, edge midpoints on a triangle).
+   Returns the number of nodes. */
+static INT face_jump_quad(REAL *qx,REAL *qw,INT f,INT porder,mesh_struct *mesh)
+{
+  INT dim = mesh->dim;
+  INT i,j;
+  INT *fv = mesh->f_v->JA+mesh->f_v->IA[f];
+  REAL xv[9];
+  REAL area = mesh->f_area[f];
+
+  if(porder==1) {
+    for(j=0;j<dim;j++) qx[j] = mesh->f_mid[f*dim+j];
+    qw[0] = area;
+    return 1;
+  }
+  for(i=0;i<dim;i++) {
+    xv[i*dim] = mesh->cv->x[fv[i]];
+    xv[i*dim+1] = mesh->cv->y[fv[i]];
+    if(dim==3) xv[i*dim+2] = mesh->cv->z[fv[i]];
+  }
+  if(dim==2) {
+    for(j=0;j<dim;j++) {
+      qx[j] = xv[j];
+      qx[dim+j] = 0.5*(xv[j]+xv[dim+j]);
+      qx[2*dim+j] = xv[dim+j];
+    }
+    qw[0] = area/6.0;
+    qw[1] = 4.0*area/6.0;
+    qw[2] = area/6.0;
+  } else {
+    for(i=0;i<3;i++) {
+      for(j=0;j<dim;j++)
+        qx[i*dim+j] = 0.5*(xv[i*dim+j]+xv[((i+1)%3)*dim+j]);
+      qw[i] = area/3.0;
+    }
+  }
+  return 3;
+}
+
+/***************************************************************************/
+/*!
+ * \fn REAL residual_estimator(REAL *eta,REAL *u,void (*rhs)(REAL *,REAL *,REAL,void *),void (*coeff)(REAL *,REAL *,REAL,void *),fespace *FE,mesh_struct *mesh,qcoordinates *cq,REAL time)
+ *
+ * \brief Computes the residual based a posteriori error estimator of a P1 or
+ *        P2 approximation of -div(a grad u) = f:
+ *
+ *        eta_T^2 = h_T^2 ||f + a Lap(u)||_T^2 + sum_{F in T} c_F h_F ||[a du/dn]||_F^2
+ *
+ *        with c_F = 1/2 on interior faces, c_F = 1 on Neumann faces
+ *        (homogeneous Neumann data) and c_F = 0 on the other boundary faces.
+ *
+ * \param eta           Estimator on each element, eta_T (OUTPUT, nelm)
+ * \param u             Numerical Solution at DOF
+ * \param rhs           Right hand side f (NULL means f=0)
+ * \param coeff         Diffusion coefficient a, taken at the element midpoints
+ *                      (NULL means a=1)
+ * \param FE            FE Space (P1 or P2)
+ * \param mesh          Mesh Data (needs el_f, f_v, f_area, f_norm, f_flag)
+ * \param cq            Quadrature Nodes (for the element residual)
+ * \param time          Physical time
+ *
+ * \return eta          Global estimator sqrt(sum_T eta_T^2)
+ *
+ * \note h_T = |T|^(1/dim) and h_F = |F|^(1/(dim-1)).  The face jumps are
+ *       computed face by face first, so both loops are threaded (OpenMP).
+ *
+ */
+REAL residual_estimator(REAL *eta,REAL *u,void (*rhs)(REAL *,REAL *,REAL,void *),void (*coeff)(REAL *,REAL *,REAL,void *),fespace *FE,mesh_struct *mesh,qcoordinates *cq,REAL time)
+{
+  INT dim = mesh->dim;
+  INT nelm = mesh->nelm;
+  INT nface = mesh->nface;
+  INT FEtype = FE->FEtype;
+  INT dof_per_elm = FE->dof_per_elm;
+  INT v_per_elm = mesh->v_per_elm;
+  INT i,j,k,q,elm,face,e1,e2;
+  REAL sum = 0.0;
+
+  if(FEtype!=1 && FEtype!=2) check_error(ERROR_FE_TYPE,__FUNCTION__);
+  if(dim!=2 && dim!=3) check_error(ERROR_DIM,__FUNCTION__);
+
+  // Coefficient on each element
+  REAL* a = (REAL *) calloc(nelm,sizeof(REAL));
+  for(elm=0;elm<nelm;elm++) {
+    a[elm] = 1.0;
+    if(coeff!=NULL) coeff(a+elm,mesh->el_mid+elm*dim,time,&(mesh->el_flag[elm]));
+  }
+
+  // Elements on each face (in increasing order)
+  iCSRmat f_el;
+  icsr_trans(mesh->el_f,&f_el);
+
+  // Squared jumps ||[a du/dn]||_F^2 on each face
+  REAL* jump = (REAL *) calloc(nface,sizeof(REAL));
+
+#ifdef _OPENMP
+#pragma omp parallel private(i,j,q,face,e1,e2) if(nface>1024)
+#endif
+  {
+    // Local data for each thread
+    fespace FEt;
+    copy_fespace_scratch(FE,&FEt,dim);
+    mesh_struct mesht;
+    copy_mesh_scratch(mesh,&mesht);
+    INT* dof_on_elm = (INT *) calloc(2*dof_per_elm,sizeof(INT));
+    INT* v_on_elm = (INT *) calloc(2*v_per_elm,sizeof(INT));
+    REAL qx[9],qw[3],g1[3],g2[3];
+    REAL dn;
+    INT nq,ne;
+#ifdef _OPENMP
+#pragma omp for
+#endif
+    for(face=0;face<nface;face++) {
+      jump[face] = 0.0;
+      ne = f_el.IA[face+1]-f_el.IA[face];
+      // Only interior and Neumann faces
+      if(ne==1 && (mesh->f_flag[face]<MARKER_NEUMANN || mesh->f_flag[face]>=MARKER_ROBIN)) continue;
+      e1 = f_el.JA[f_el.IA[face]];
+      e2 = (ne>1) ? f_el.JA[f_el.IA[face]+1] : -1;
+      get_incidence_row(e1,FE->el_dof,dof_on_elm);
+      get_incidence_row(e1,mesh->el_v,v_on_elm);
+      if(e2>=0) {
+        get_incidence_row(e2,FE->el_dof,dof_on_elm+dof_per_elm);
+        get_incidence_row(e2,mesh->el_v,v_on_elm+v_per_elm);
+      }
+      nq = face_jump_quad(qx,qw,face,FEtype,mesh);
+      for(q=0;q<nq;q++) {
+        FE_DerivativeInterpolation(g1,u,qx+q*dim,dof_on_elm,v_on_elm,&FEt,&mesht);
+        for(j=0;j<dim;j++) g2[j] = 0.0;
+        if(e2>=0)
+          FE_DerivativeInterpolation(g2,u,qx+q*dim,dof_on_elm+dof_per_elm,v_on_elm+v_per_elm,&FEt,&mesht);
+        dn = 0.0;
+        for(j=0;j<dim;j++) {
+          dn += a[e1]*g1[j]*mesh->f_norm[face*dim+j];
+          if(e2>=0) dn -= a[e2]*g2[j]*mesh->f_norm[face*dim+j];
+        }
+        jump[face] += qw[q]*dn*dn;
+      }
+    }
+    if(dof_on_elm) free(dof_on_elm);
+    if(v_on_elm) free(v_on_elm);
+    free_fespace_scratch(&FEt);
+    free_mesh_scratch(&mesht);
+  }
+
+  // Element residuals and the face terms
+#ifdef _OPENMP
+#pragma omp parallel private(i,j,k,q,elm,face) reduction(+:sum) if(nelm>1024)
+#endif
+  {
+    // Local data for each thread
+    fespace FEt;
+    copy_fespace_scratch(FE,&FEt,dim);
+    mesh_struct mesht;
+    copy_mesh_scratch(mesh,&mesht);
+    qcoordinates cqt;
+    copy_qcoords_scratch(cq,&cqt);
+    INT* dof_on_elm = (INT *) calloc(dof_per_elm,sizeof(INT));
+    INT* v_on_elm = (INT *) calloc(v_per_elm,sizeof(INT));
+    REAL* qxs = (REAL *) calloc(cq->nq_per_elm*dim,sizeof(REAL));
+    REAL* fvals = (REAL *) calloc(cq->nq_per_elm,sizeof(REAL));
+    REAL lam[4],dlam[12],xv[3],g[3];
+    REAL lap,res,hT,hF,cF,etaT;
+#ifdef _OPENMP
+#pragma omp for
+#endif
+    for(elm=0;elm<nelm;elm++) {
+      get_incidence_row(elm,FE->el_dof,dof_on_elm);
+      get_incidence_row(elm,mesh->el_v,v_on_elm);
+
+      // Laplacian of u (constant): the gradient is linear, so its
+      // divergence is sum_k grad u(x_k).grad lambda_k
+      lap = 0.0;
+      if(FEtype==2) {
+        PX_H1_basis(lam,dlam,mesh->el_mid+elm*dim,v_on_elm,1,&mesht);
+        for(k=0;k<v_per_elm;k++) {
+          xv[0] = mesh->cv->x[v_on_elm[k]];
+          xv[1] = mesh->cv->y[v_on_elm[k]];
+          if(dim==3) xv[2] = mesh->cv->z[v_on_elm[k]];
+          FE_DerivativeInterpolation(g,u,xv,dof_on_elm,v_on_elm,&FEt,&mesht);
+          for(j=0;j<dim;j++) lap += g[j]*dlam[k*dim+j];
+        }
+      }
+
+      // ||f + a Lap(u)||_T^2
+      quad_elm(&cqt,mesh,cq->nq1d,elm);
+      for(q=0;q<cqt.nq_per_elm;q++) fvals[q] = 0.0;
+      evaluate_function_on_elm(fvals,qxs,1,rhs,&cqt,dim,time,&(mesh->el_flag[elm]));
+      res = 0.0;
+      for(q=0;q<cqt.nq_per_elm;q++)
+        res += cqt.w[q]*(fvals[q]+a[elm]*lap)*(fvals[q]+a[elm]*lap);
+
+      hT = pow(mesh->el_vol[elm],1.0/((REAL) dim));
+      etaT = hT*hT*res;
+      for(i=mesh->el_f->IA[elm];i<mesh->el_f->IA[elm+1];i++) {
+        face = mesh->el_f->JA[i];
+        cF = (f_el.IA[face+1]-f_el.IA[face]>1) ? 0.5 : 1.0;
+        hF = pow(mesh->f_area[face],1.0/((REAL) (dim-1)));
+        etaT += cF*hF*jump[face];
+      }
+      eta[elm] = sqrt(etaT);
+      sum += etaT;
+    }
+    if(dof_on_elm) free(dof_on_elm);
+    if(v_on_elm) free(v_on_elm);
+    if(qxs) free(qxs);
+    if(fvals) free(fvals);
+    free_fespace_scratch(&FEt);
+    free_mesh_scratch(&mesht);
+    free_qcoords(&cqt);
+  }
+
+  icsr_free(&f_el);
+  if(jump) free(jump);
+  if(a) free(a);
+
+  return sqrt(sum);
+}
+/***************************************************************************/
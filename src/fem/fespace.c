@@ -40,6 +40,9 @@ void initialize_fespace(fespace *FE)
   FE->phi = NULL;
   FE->dphi = NULL;
   FE->ddphi = NULL;
+  FE->nq_ref = 0;
+  FE->phi_ref = NULL;
+  FE->dphi_ref = NULL;
 
   return;
 }
@@ -440,6 +443,17 @@ void free_fespace(fespace* FE)
     FE->ddphi = NULL;
   }
 
+  if(FE->phi_ref) {
+    free(FE->phi_ref);
+    FE->phi_ref = NULL;
+  }
+
+  if(FE->dphi_ref) {
+    free(FE->dphi_ref);
+    FE->dphi_ref = NULL;
+  }
+  FE->nq_ref = 0;
+
   return;
 }
 /******************************************************************************/
@@ -524,19 +538,18 @@ void initialize_localdata_elm(simplex_local_data *simplex_data,fe_local_data *fe
   quad_refelm(simplex_data->quad_local,nq1d,dim);
   INT nq = simplex_data->quad_local->nq;
   simplex_data->lams = (REAL *) calloc(nq*v_per_elm,sizeof(REAL));
+  simplex_data->ref_map = (REAL *) calloc(dim*dim,sizeof(REAL));
+  // Gradients of P1 are constant on each element (overwritten in get_elmlocaldata)
+  simplex_data->gradlams = (REAL *) calloc(v_per_elm*dim,sizeof(REAL));
   // Lams are ordered for each quadrature point, lam0, lam1, etc.
-  // We fill in gradlams, knowing that this will be overwritten later anyway
+  // For now gradlams holds the gradients on the reference element
   REAL* lam_at_q = simplex_data->lams;
-  REAL* dlam_at_q = simplex_data->gradlams;
   REAL* qx = simplex_data->quad_local->x;
   for(i=0;i<nq;i++) {
-    P1_basis_ref(lam_at_q,dlam_at_q,qx,dim);
+    P1_basis_ref(lam_at_q,simplex_data->gradlams,qx,dim);
     lam_at_q += dim+1;
-    dlam_at_q += (dim+1)*dim;
     qx += dim;
   }
-  simplex_data->ref_map = (REAL *) calloc(dim*dim,sizeof(REAL));
-  simplex_data->gradlams = (REAL *) calloc(nq*v_per_elm*dim,sizeof(REAL));
 
 
   // FE local data that is fixed
@@ -566,6 +579,9 @@ void initialize_localdata_elm(simplex_local_data *simplex_data,fe_local_data *fe
   fe_data->local_dof_flags = (INT *) calloc(dof_per_elm_tot,sizeof(INT));
   fe_data->u_local = (REAL *) calloc(dof_per_elm_tot,sizeof(REAL));
 
+  // Basis functions on the reference element at the quadrature points
+  tabulate_FEM_basis_ref(fe_data,simplex_data->lams,simplex_data->gradlams,nq,dim);
+
   return;
 }
 /******************************************************************************/
@@ -604,7 +620,7 @@ void get_elmlocaldata(simplex_local_data* elm_data,mesh_struct* mesh,INT elm)
   for(i=0;i<v_per_elm;i++) {
     vind = elm_data->local_v[i];
     for(j=0;j<dim;j++) {
-      elm_data->xv[i*dim+j] = mesh->cv->x[vind*dim+j];
+      elm_data->xv[i*dim+j] = mesh->cv->x[j*mesh->cv->n+vind];
     }
   }
 
@@ -748,7 +764,7 @@ void get_facelocaldata(simplex_local_data* face_data,mesh_struct* mesh,INT face)
   for(i=0;i<v_per_f;i++) {
     vind = face_data->local_v[i];
     for(j=0;j<dim;j++) {
-      face_data->xv[i*dim+j] = mesh->cv->x[vind*dim+j];
+      face_data->xv[i*dim+j] = mesh->cv->x[j*mesh->cv->n+vind];
     }
   }
 
@@ -876,7 +892,7 @@ void get_edgelocaldata(simplex_local_data* edge_data,mesh_struct* mesh,INT edge)
   for(i=0;i<v_per_ed;i++) {
     vind = edge_data->local_v[i];
     for(j=0;j<dim;j++) {
-      edge_data->xv[i*dim+j] = mesh->cv->x[vind*dim+j];
+      edge_data->xv[i*dim+j] = mesh->cv->x[j*mesh->cv->n+vind];
     }
   }
 
@@ -943,6 +959,8 @@ void free_felocaldata(fe_local_data* loc_data)
 {
   if (loc_data == NULL) return; // Nothing need to be freed!
 
+  INT i;
+
   if(loc_data->fe_types) free(loc_data->fe_types);
   if(loc_data->scal_or_vec) free(loc_data->scal_or_vec);
   if(loc_data->n_dof_per_space) free(loc_data->n_dof_per_space);
@@ -958,6 +976,22 @@ void free_felocaldata(fe_local_data* loc_data)
   if(loc_data->ddphi) free(loc_data->ddphi);
   loc_data->ddphi = NULL;
 
+  // Tabulated basis on reference element
+  if(loc_data->phi_ref) {
+    for(i=0;i<loc_data->nspaces;i++) {
+      if(loc_data->phi_ref[i]) free(loc_data->phi_ref[i]);
+    }
+    free(loc_data->phi_ref);
+    loc_data->phi_ref = NULL;
+  }
+  if(loc_data->dphi_ref) {
+    for(i=0;i<loc_data->nspaces;i++) {
+      if(loc_data->dphi_ref[i]) free(loc_data->dphi_ref[i]);
+    }
+    free(loc_data->dphi_ref);
+    loc_data->dphi_ref = NULL;
+  }
+
   return;
 }
 
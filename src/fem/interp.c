@@ -1427,6 +1427,28 @@ void ProjectOut_Grad(dvector* u,fespace* FE_H1,fespace* FE_Ned,mesh_struct* mesh
  *
  */
 void FE_Interpolation(REAL* val,REAL *u,REAL* x,INT *dof_on_elm,INT *v_on_elm,fespace *FE,mesh_struct *mesh)
+{
+  get_FEM_basis(FE->phi,FE->dphi,x,v_on_elm,dof_on_elm,mesh,FE);
+  FE_Interpolation_basis(val,u,dof_on_elm,FE,mesh->dim);
+
+  return;
+}
+/******************************************************************************/
+
+/*!
+ * \fn void FE_Interpolation_basis(REAL* val,REAL *u,INT *dof_on_elm,fespace *FE,INT dim)
+ *
+ * \brief Combines the basis functions already in FE->phi (from get_FEM_basis or
+ *        get_FEM_basis_tabulated) into the value of a finite-element approximation.
+ *
+ * \param u 	      Approximation to interpolate
+ * \param dof_on_elm  DOF belonging to particular element
+ * \param FE          FE Space
+ * \param dim         Dimension of problem
+ * \param val         Pointer to value of approximation at the point of the basis
+ *
+ */
+void FE_Interpolation_basis(REAL* val,REAL *u,INT *dof_on_elm,fespace *FE,INT dim)
 {
   INT i,j,dof;
 
@@ -1434,12 +1456,9 @@ void FE_Interpolation(REAL* val,REAL *u,REAL* x,INT *dof_on_elm,INT *v_on_elm,fe
   INT dof_per_elm = FE->dof_per_elm;
   //INT FEtype = FE->FEtype;
   INT scal_or_vec = FE->scal_or_vec;
-  INT dim = mesh->dim;
 
   REAL coef[dim];
 
-  get_FEM_basis(FE->phi,FE->dphi,x,v_on_elm,dof_on_elm,mesh,FE);
-
   if(scal_or_vec==0) { // Scalar Element
     coef[0] = 0.0;
     for(j=0; j<dof_per_elm; j++) {
@@ -1480,20 +1499,40 @@ void FE_Interpolation(REAL* val,REAL *u,REAL* x,INT *dof_on_elm,INT *v_on_elm,fe
  *
  */
 void FE_DerivativeInterpolation(REAL* val,REAL *u,REAL *x,INT *dof_on_elm,INT *v_on_elm,fespace *FE,mesh_struct *mesh)
+{
+  get_FEM_basis(FE->phi,FE->dphi,x,v_on_elm,dof_on_elm,mesh,FE);
+  FE_DerivativeInterpolation_basis(val,u,dof_on_elm,FE,mesh->dim);
+
+  return;
+}
+/******************************************************************************/
+
+/*!
+ * \fn void FE_DerivativeInterpolation_basis(REAL* val,REAL *u,INT *dof_on_elm,fespace *FE,INT dim)
+ *
+ * \brief Combines the derivatives of the basis functions already in FE->dphi (from
+ *        get_FEM_basis or get_FEM_basis_tabulated) into the "derivative" of a
+ *        finite-element approximation (see FE_DerivativeInterpolation).
+ *
+ * \param u 	      Approximation to interpolate
+ * \param dof_on_elm  DOF belonging to particular element
+ * \param FE          FE Space
+ * \param dim         Dimension of problem
+ * \param val         Pointer to value of the derivative at the point of the basis
+ *
+ */
+void FE_DerivativeInterpolation_basis(REAL* val,REAL *u,INT *dof_on_elm,fespace *FE,INT dim)
 {
   INT dof,j,k,i;
 
   // Get FE and Mesh data
   INT dof_per_elm = FE->dof_per_elm;
   INT FEtype = FE->FEtype;
-  INT dim = mesh->dim;
 
   // Basis Functions and its derivatives if necessary
   //REAL coef[dim];
   REAL coef[dim*dim];
 
-  get_FEM_basis(FE->phi,FE->dphi,x,v_on_elm,dof_on_elm,mesh,FE);
-
   if(FEtype==0 || FEtype==99) { // Don't compute derivatives of P0 elements (set to 0)
     for(j=0;j<dim;j++) {
       val[j] = 0.0;
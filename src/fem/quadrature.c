@@ -32,7 +32,7 @@ struct quadrature *alloc_quadrature(INT nq1d,INT nsimplex,INT dim)
   struct quadrature *Q = malloc(sizeof(struct quadrature));
   assert(Q != NULL);
 
-  INT nq = (INT) pow(nq1d,dim);
+  INT nq = quad_simplex_nq(nq1d,dim);
   INT nq_tot = nq*nsimplex;
   Q->dim = dim;
   Q->nq1d = nq1d;
@@ -79,7 +79,7 @@ struct quadrature *alloc_quadrature_bdry(INT nq1d,INT nregion,INT dim,INT ed_or_
     break;
 
     case 2:
-    nq = (INT) pow(nq1d,dim-1);
+    nq = quad_simplex_nq(nq1d,dim-1);
     break;
 
     default:
@@ -147,7 +147,7 @@ void quad_refelm(quadrature *cqelm,INT nq1d,INT dim)
   INT q;
 
   /* Total Number of Quadrature Nodes */
-  INT nq = pow(nq1d,dim);
+  INT nq = quad_simplex_nq(nq1d,dim);
 
   /* Gaussian points for reference element */
   REAL* gp = (REAL *) calloc(dim*nq,sizeof(REAL));
@@ -174,7 +174,7 @@ void quad_refelm(quadrature *cqelm,INT nq1d,INT dim)
   } else if(dim==2) {
 
     // Get Quad Nodes and Weights
-    triquad_(gp,gw,nq1d);
+    quad_simplex(gp,gw,nq1d,dim);
 
     // Map to Real Triangle
     // x = x1*(1-r-s) + x2*r + x3*s
@@ -190,7 +190,7 @@ void quad_refelm(quadrature *cqelm,INT nq1d,INT dim)
   } else if(dim==3) {
 
     // Get Quad Nodes and Weights
-    tetquad_(gp,gw,nq1d);
+    quad_simplex(gp,gw,nq1d,dim);
 
     // Map to Real Triangle
     // x = x1*(1-r-s-t) + x2*r + x3*s + x4*t
@@ -242,7 +242,7 @@ void quad_elm_local(quadrature *cqelm,simplex_local_data *loc_data,INT nq1d)
   INT dim = loc_data->dim;
 
   /* Total Number of Quadrature Nodes */
-  INT nq = pow(nq1d,dim);
+  INT nq = quad_simplex_nq(nq1d,dim);
 
   /* Coordinates of vertices of element */
   REAL* xv = loc_data->xv;
@@ -279,7 +279,7 @@ void quad_elm_local(quadrature *cqelm,simplex_local_data *loc_data,INT nq1d)
     voldim = 2.0*e_vol;
 
     // Get Quad Nodes and Weights
-    triquad_(gp,gw,nq1d);
+    quad_simplex(gp,gw,nq1d,dim);
 
     // Map to Real Triangle
     // x = x1*(1-r-s) + x2*r + x3*s
@@ -296,7 +296,7 @@ void quad_elm_local(quadrature *cqelm,simplex_local_data *loc_data,INT nq1d)
     voldim = 6.0*e_vol;
 
     // Get Quad Nodes and Weights
-    tetquad_(gp,gw,nq1d);
+    quad_simplex(gp,gw,nq1d,dim);
 
     // Map to Real Triangle
     // x = x1*(1-r-s-t) + x2*r + x3*s + x4*t
@@ -435,7 +435,7 @@ void quad_face_local(quadrature *cqface,simplex_local_data *loc_data,INT nq1d,IN
   INT q,i,j,k; /* Loop indices */
   INT dim = loc_data->dim;
   // Face is an edge in 2D
-  INT nq = (INT) pow(nq1d,dim-1);
+  INT nq = quad_simplex_nq(nq1d,dim-1);
 
   /* Coordinates of vertices of face */
   INT v_per_face = dim;
@@ -475,7 +475,7 @@ void quad_face_local(quadrature *cqface,simplex_local_data *loc_data,INT nq1d,IN
   if(dim==2) { // face is an edge
     quad1d(gp,gw,nq1d);
   } else if(dim==3) { // face is a face
-    triquad_(gp,gw,nq1d);
+    quad_simplex(gp,gw,nq1d,2);
   } else {
     status = ERROR_DIM;
     check_error(status, __FUNCTION__);
@@ -497,9 +497,9 @@ void quad_face_local(quadrature *cqface,simplex_local_data *loc_data,INT nq1d,IN
     //        y = y1*(1-r-s) + y2*r + y3*s
     //        z = z1*(1-r-s) + z2*r + z3*s
     //        w = 2*Element Area*wref
-    for (q=0; q<nq1d*nq1d; q++) {
+    for (q=0; q<nq; q++) {
       r = gp[q];
-      s = gp[nq1d*nq1d+q];
+      s = gp[nq+q];
       for(k=0;k<dim;k++) cqface->x[q*dim+k] = xvf[0*dim+j]*(1-r-s) + xvf[1*dim+j]*r + xvf[2*dim+j]*s;
       cqface->w[q] = w*gw[q];
     }
@@ -2360,6 +2360,259 @@ void tetquad_(REAL *gp, REAL *gc, INT ng1d)
 }
 /******************************************************************************/
 
+/************************************************************************************/
+/* Fully symmetric quadrature rules on the reference triangle, one row per orbit:
+ * {orbit type, weight, a, b}, weights summing to 1.  Orbits (in barycentric
+ * coordinates): 0 - centroid (1 point), 1 - (a,a,1-2a) (3 points),
+ * 2 - (a,b,1-a-b) (6 points). */
+static const REAL symquad_tri[][4] = {
+  // degree 1, 1 point
+  {0, 1.0, 0.0, 0.0},
+  // degree 2, 3 points
+  {1, 0.33333333333333333, 0.16666666666666667, 0.0},
+  // degree 4, 6 points (Dunavant)
+  {1, 0.22338158967801140, 0.44594849091596483, 0.0},
+  {1, 0.10995174365532193, 0.091576213509770780, 0.0},
+  // degree 5, 7 points (Dunavant)
+  {0, 0.22500000000000000, 0.0, 0.0},
+  {1, 0.13239415278850616, 0.47014206410511505, 0.0},
+  {1, 0.12593918054482717, 0.10128650732345633, 0.0},
+  // degree 6, 12 points
+  {1, 0.17133312415298424, 0.21942998254978240, 0.0},
+  {1, 0.080731089593029190, 0.48013796411221650, 0.0},
+  {2, 0.040634559793659970, 0.019371724361240628, 0.14161901592396670},
+  // degree 7, 15 points
+  {1, 0.079268464725728780, 0.20668630264641563, 0.0},
+  {1, 0.079514397996260630, 0.40816764790611265, 0.0},
+  {1, 0.049957955470584195, 0.062879733319822160, 0.0},
+  {2, 0.062296257570379890, 0.64901619844506700, 0.038072625097008886},
+  // degree 8, 16 points (Dunavant)
+  {0, 0.14431560767777990, 0.0, 0.0},
+  {1, 0.032458497623196890, 0.050547228317028550, 0.0},
+  {1, 0.095091634267292400, 0.45929258829271260, 0.0},
+  {1, 0.10321737053470921, 0.17056930775174780, 0.0},
+  {2, 0.027230314174437432, 0.72849239295537860, 0.26311282963466490},
+  // degree 9, 19 points (Dunavant)
+  {0, 0.097135796282799710, 0.0, 0.0},
+  {1, 0.031334700227139230, 0.48968251919873595, 0.0},
+  {1, 0.077827541004774240, 0.43708959149293763, 0.0},
+  {1, 0.079647738927210250, 0.18820353561903225, 0.0},
+  {1, 0.025577675658698170, 0.044729513394452955, 0.0},
+  {2, 0.043283539377289120, 0.036838412054736180, 0.22196298916076576},
+  // degree 10, 25 points (Dunavant)
+  {0, 0.090817990382754150, 0.0, 0.0},
+  {1, 0.036725957756467050, 0.48557763338365784, 0.0},
+  {1, 0.045321059435528050, 0.10948157548503724, 0.0},
+  {2, 0.072757916845420030, 0.14170721941487954, 0.30793983876412060},
+  {2, 0.028327242531057027, 0.025003534762686214, 0.24667256063990334},
+  {2, 0.0094216669637330050, 0.0095408154002999330, 0.066803251012200940}
+};
+/* {degree, first row in symquad_tri, number of orbits, number of points} */
+static const INT symquad_tri_rules[][4] = {
+  {1,0,1,1},{2,1,1,3},{4,2,2,6},{5,4,3,7},{6,7,3,12},{7,10,4,15},{8,14,5,16},
+  {9,19,6,19},{10,25,6,25}
+};
+
+/* Same for the reference tetrahedron.  Orbits: 0 - centroid (1 point),
+ * 1 - (a,a,a,1-3a) (4 points), 2 - (a,a,1/2-a,1/2-a) (6 points),
+ * 3 - (a,a,b,1-2a-b) (12 points). */
+static const REAL symquad_tet[][4] = {
+  // degree 1, 1 point
+  {0, 1.0, 0.0, 0.0},
+  // degree 2, 4 points
+  {1, 0.25000000000000000, 0.13819660112501053, 0.0},
+  // degree 3, 8 points
+  {1, 0.11558404215595751, 0.10888016401298693, 0.0},
+  {1, 0.13441595784404250, 0.32825611634819934, 0.0},
+  // degree 5, 14 points (Walkington)
+  {1, 0.11268792571801096, 0.31088591926330000, 0.0},
+  {1, 0.073493043116360550, 0.092735250310890540, 0.0},
+  {2, 0.042546020777085640, 0.045503704125654270, 0.0},
+  // degree 6, 24 points (Keast)
+  {1, 0.039922750258168080, 0.21460287125915120, 0.0},
+  {1, 0.010077211055320173, 0.040673958534609910, 0.0},
+  {1, 0.055357181543654580, 0.32233789014227540, 0.0},
+  {3, 0.048214285714285765, 0.063661001875017360, 0.60300566479165010}
+};
+/* {degree, first row in symquad_tet, number of orbits, number of points} */
+static const INT symquad_tet_rules[][4] = {
+  {1,0,1,1},{2,1,1,4},{3,2,2,8},{5,4,3,14},{6,7,4,24}
+};
+
+/* Barycentric coordinates (dim+1 per point) of all points of one orbit of a
+ * symmetric rule; returns the number of points */
+static INT symquad_orbit(REAL *lam,INT dim,INT orbit,REAL a,REAL b)
+{
+  static const INT perm3[6][3] = {{0,1,2},{0,2,1},{1,0,2},{1,2,0},{2,0,1},{2,1,0}};
+  static const INT pair4[6][4] = {{0,1,2,3},{0,2,1,3},{0,3,1,2},{1,2,0,3},{1,3,0,2},{2,3,0,1}};
+  INT i,j,n=0;
+  INT nv = dim+1;
+
+  if(orbit==0) {
+    for(j=0;j<nv;j++) lam[j] = 1.0/((REAL) nv);
+    n = 1;
+  } else if(orbit==1) {
+    // one coordinate differs from the others
+    for(i=0;i<nv;i++) {
+      for(j=0;j<nv;j++) lam[n*nv+j] = a;
+      lam[n*nv+i] = 1.0-dim*a;
+      n++;
+    }
+  } else if(dim==2 && orbit==2) {
+    REAL v[3] = {a,b,1.0-a-b};
+    for(i=0;i<6;i++) {
+      for(j=0;j<3;j++) lam[n*3+perm3[i][j]] = v[j];
+      n++;
+    }
+  } else if(dim==3 && orbit==2) {
+    for(i=0;i<6;i++) {
+      lam[n*4+pair4[i][0]] = a;
+      lam[n*4+pair4[i][1]] = a;
+      lam[n*4+pair4[i][2]] = 0.5-a;
+      lam[n*4+pair4[i][3]] = 0.5-a;
+      n++;
+    }
+  } else if(dim==3 && orbit==3) {
+    for(i=0;i<6;i++) {
+      for(j=0;j<2;j++) {
+        lam[n*4+pair4[i][0]] = a;
+        lam[n*4+pair4[i][1]] = a;
+        lam[n*4+pair4[i][2+j]] = b;
+        lam[n*4+pair4[i][3-j]] = 1.0-2.0*a-b;
+        n++;
+      }
+    }
+  } else {
+    check_error(ERROR_DIM, __FUNCTION__);
+  }
+
+  return n;
+}
+/************************************************************************************/
+
+/************************************************************************************/
+/*!
+* \fn INT symquad_(REAL *gp,REAL *gc,INT dim,INT degree)
+*
+* \brief Fully symmetric quadrature on the reference triangle or tetrahedron
+*        which is exact for polynomials of the given degree.  The rule with the
+*        fewest points among the tabulated ones is chosen (Dunavant, Keast and
+*        Xiao-Gimbutas type rules: positive weights and interior nodes).
+*
+* \note Tabulated up to degree 10 on triangles and degree 6 on tetrahedra.
+*
+* \param dim         Dimension (2 or 3)
+* \param degree      Polynomial degree integrated exactly
+*
+* \return gp         Coordinates of the points, stored as in triquad_ and tetquad_
+*                    (all x, then all y, then all z); nothing is stored if NULL
+* \return gc         Weights, summing to the volume of the reference simplex
+* \return nq         Number of points (0 if no rule of this degree is tabulated)
+*
+*/
+INT symquad_(REAL *gp,REAL *gc,INT dim,INT degree)
+{
+  const REAL (*orbits)[4] = NULL;
+  const INT (*rules)[4] = NULL;
+  INT nrules=0,r,k,q,j,n,nq=0;
+  REAL vol=1.0;
+
+  if(dim==2) {
+    orbits = symquad_tri;
+    rules = symquad_tri_rules;
+    nrules = sizeof(symquad_tri_rules)/sizeof(symquad_tri_rules[0]);
+    vol = 0.5;
+  } else if(dim==3) {
+    orbits = symquad_tet;
+    rules = symquad_tet_rules;
+    nrules = sizeof(symquad_tet_rules)/sizeof(symquad_tet_rules[0]);
+    vol = 1.0/6.0;
+  } else {
+    return 0;
+  }
+
+  // Lowest tabulated degree that is high enough
+  for(r=0;r<nrules;r++) {
+    if(rules[r][0]>=MAX(degree,1)) break;
+  }
+  if(r==nrules) return 0;
+  nq = rules[r][3];
+  if(gp==NULL || gc==NULL) return nq;
+
+  REAL lam[12*4];
+  q = 0;
+  for(k=rules[r][1];k<rules[r][1]+rules[r][2];k++) {
+    n = symquad_orbit(lam,dim,(INT) orbits[k][0],orbits[k][2],orbits[k][3]);
+    for(j=0;j<n;j++) {
+      gp[q] = lam[j*(dim+1)+1];
+      gp[nq+q] = lam[j*(dim+1)+2];
+      if(dim==3) gp[2*nq+q] = lam[j*(dim+1)+3];
+      gc[q] = vol*orbits[k][1];
+      q++;
+    }
+  }
+
+  return nq;
+}
+/************************************************************************************/
+
+/************************************************************************************/
+/*!
+* \fn INT quad_simplex_nq(INT nq1d,INT dim)
+*
+* \brief Number of quadrature points used on a simplex of dimension dim for nq1d
+*        points per direction.  The collapsed Gauss rule with nq1d^dim points is
+*        exact for degree 2*nq1d-1; when a symmetric rule of that degree has
+*        fewer points, it is used instead (see quad_simplex).
+*
+* \param nq1d        Number of quadrature points in 1D direction
+* \param dim         Dimension of the simplex
+*
+* \return nq         Number of quadrature points
+*
+*/
+INT quad_simplex_nq(INT nq1d,INT dim)
+{
+  INT nq = (INT) pow(nq1d,dim);
+  INT nsym = symquad_(NULL,NULL,dim,2*nq1d-1);
+  if(nsym>0 && nsym<nq) nq = nsym;
+  return nq;
+}
+/************************************************************************************/
+
+/************************************************************************************/
+/*!
+* \fn void quad_simplex(REAL *gp,REAL *gc,INT nq1d,INT dim)
+*
+* \brief Quadrature on the reference simplex exact for degree 2*nq1d-1 with
+*        quad_simplex_nq(nq1d,dim) points: the symmetric rule (symquad_) when it
+*        has fewer points, otherwise the collapsed Gauss rule (quad1d, triquad_,
+*        tetquad_).
+*
+* \param nq1d        Number of quadrature points in 1D direction
+* \param dim         Dimension of the simplex
+*
+* \return gp         Coordinates of the points (as in triquad_ and tetquad_; on [-1,1] in 1D)
+* \return gc         Weights of the points
+*
+*/
+void quad_simplex(REAL *gp,REAL *gc,INT nq1d,INT dim)
+{
+  if(dim==1) {
+    quad1d(gp,gc,nq1d);
+  } else if(quad_simplex_nq(nq1d,dim)<(INT) pow(nq1d,dim)) {
+    symquad_(gp,gc,dim,2*nq1d-1);
+  } else if(dim==2) {
+    triquad_(gp,gc,nq1d);
+  } else if(dim==3) {
+    tetquad_(gp,gc,nq1d);
+  } else {
+    check_error(ERROR_DIM, __FUNCTION__);
+  }
+  return;
+}
+/******************************************************************************/
+
 
 /*****************************************************************************/
 /******* SOON TO BE DEPRECATED ROUTINES **************************************/
@@ -2397,13 +2650,13 @@ struct qcoordinates *allocateqcoords(INT nq1d,INT nelm,INT mydim)
     A->z = NULL;
     break;
     case 2:
-    nq = nq1d*nq1d;
+    nq = quad_simplex_nq(nq1d,2);
     A->x = (REAL *) calloc(nq*nelm,sizeof(REAL));
     A->y = (REAL *) calloc(nq*nelm,sizeof(REAL));
     A->z = NULL;
     break;
     case 3:
-    nq = nq1d*nq1d*nq1d;
+    nq = quad_simplex_nq(nq1d,3);
     A->x = (REAL *) calloc(nq*nelm,sizeof(REAL));
     A->y = (REAL *) calloc(nq*nelm,sizeof(REAL));
     A->z = (REAL *) calloc(nq*nelm,sizeof(REAL));
@@ -2419,6 +2672,8 @@ struct qcoordinates *allocateqcoords(INT nq1d,INT nelm,INT mydim)
   A->n = nq*nelm;
   A->nq_per_elm = nq;
   A->nq1d = nq1d;
+  A->ref_x = NULL;
+  A->ref_w = NULL;
 
   return A;
 }
@@ -2459,7 +2714,7 @@ struct qcoordinates *allocateqcoords_bdry(INT nq1d,INT nregion,INT dim,INT ed_or
     if(dim==2) { // face is edge in 2D
       nq = nq1d;
     } else {
-      nq = nq1d*nq1d;
+      nq = quad_simplex_nq(nq1d,2);
     }
     break;
     default:
@@ -2481,6 +2736,8 @@ struct qcoordinates *allocateqcoords_bdry(INT nq1d,INT nregion,INT dim,INT ed_or
   A->n = nq*nregion;
   A->nq_per_elm = nq;
   A->nq1d = nq1d;
+  A->ref_x = NULL;
+  A->ref_w = NULL;
 
   return A;
 }
@@ -2519,6 +2776,16 @@ void free_qcoords(qcoordinates* A)
     A->w = NULL;
   }
 
+  if(A->ref_x) {
+    free(A->ref_x);
+    A->ref_x = NULL;
+  }
+
+  if(A->ref_w) {
+    free(A->ref_w);
+    A->ref_w = NULL;
+  }
+
   return;
 }
 /******************************************************************************/
@@ -2526,44 +2793,76 @@ void free_qcoords(qcoordinates* A)
 /*!
  * \fn qcoordinates* get_quadrature(mesh_struct *mesh,INT nq1d)
  *
- * \brief Computes quadrature weights and nodes for entire domain using nq1d^(dim)
- *        quadrature nodes per element
+ * \brief Allocates the quadrature struct for quad_simplex_nq(nq1d,dim) quadrature
+ *        nodes per element.  Only the rule on the reference element is stored; the nodes
+ *        and weights of an element are computed with quad_elm() when needed,
+ *        so the memory does not grow with the mesh.
  *
  * \param nq1d    Number of quadrature nodes on an element in 1D direction
  * \param mesh    Mesh struct
  *
- * \return cq_all      Quadrature struct
- *
- * \note TODO: This will be deprecated soon
+ * \return cq     Quadrature struct (one element)
  *
  */
 qcoordinates* get_quadrature(mesh_struct *mesh,INT nq1d)
 {
-  INT i,j;
+  qcoordinates *cq = allocateqcoords(nq1d,1,mesh->dim);
+  quad_elm_ref(cq,mesh->dim,nq1d);
+  return cq;
+}
+/******************************************************************************/
 
-  INT dim = mesh->dim;
-  INT nelm = mesh->nelm;
-  INT nq = (INT) pow(nq1d,dim);
-  qcoordinates *cq_all = allocateqcoords(nq1d,nelm,dim);
-  qcoordinates *cqelm = allocateqcoords(nq1d,1,dim);
-
-  for (i=0; i<nelm; i++) {
-    quad_elm(cqelm,mesh,nq1d,i);
-    for (j=0; j<nq; j++) {
-      cq_all->x[i*nq+j] = cqelm->x[j];
-      cq_all->w[i*nq+j] = cqelm->w[j];
-      if(dim>1) cq_all->y[i*nq+j] = cqelm->y[j];
-      if(dim>2) cq_all->z[i*nq+j] = cqelm->z[j];
+/*!
+ * \fn void quad_elm_ref(qcoordinates *cqelm,INT dim,INT nq1d)
+ *
+ * \brief Stores the rule with nq1d^(dim) nodes on the reference simplex in the
+ *        quadrature struct (barycentric coordinates and scaled weights), so
+ *        that quad_elm only needs to apply the affine map of each element.
+ *
+ * \param cqelm   Quadrature struct (ref_x and ref_w are allocated if needed)
+ * \param dim     Dimension
+ * \param nq1d    Number of quadrature nodes on an element in 1D direction
+ *
+ */
+void quad_elm_ref(qcoordinates *cqelm,INT dim,INT nq1d)
+{
+  // Flag for errors
+  SHORT status;
+
+  INT q,j;
+  INT nq = quad_simplex_nq(nq1d,dim);
+
+  /* Gaussian points and weights for reference element */
+  REAL* gp = (REAL *) calloc(dim*nq,sizeof(REAL));
+  REAL* gw = (REAL *) calloc(nq,sizeof(REAL));
+
+  if(cqelm->ref_x==NULL) cqelm->ref_x = (REAL *) calloc(dim*nq,sizeof(REAL));
+  if(cqelm->ref_w==NULL) cqelm->ref_w = (REAL *) calloc(nq,sizeof(REAL));
+
+  if(dim==1) {
+    // Nodes on [-1,1] -> lam1 = (1+r)/2, w = 0.5*length*wref
+    quad1d(gp,gw,nq1d);
+    for (q=0; q<nq; q++) {
+      cqelm->ref_x[q] = 0.5*(1.0+gp[q]);
+      cqelm->ref_w[q] = 0.5*gw[q];
+    }
+  } else if(dim==2 || dim==3) {
+    // Nodes (r,s,t) = (lam1,lam2,lam3), w = 2*area*wref (6*volume*wref)
+    quad_simplex(gp,gw,nq1d,dim);
+    for (q=0; q<nq; q++) {
+      for (j=0; j<dim; j++)
+        cqelm->ref_x[q*dim+j] = gp[j*nq+q];
+      cqelm->ref_w[q] = ((dim==2) ? 2.0 : 6.0)*gw[q];
     }
+  } else {
+    status = ERROR_DIM;
+    check_error(status, __FUNCTION__);
   }
 
-  if(cqelm) {
-    free_qcoords(cqelm);
-    free(cqelm);
-    cqelm = NULL;
-  }
+  if(gp) free(gp);
+  if(gw) free(gw);
 
-  return cq_all;
+  return;
 }
 /******************************************************************************/
 
@@ -2579,7 +2878,8 @@ qcoordinates* get_quadrature(mesh_struct *mesh,INT nq1d)
  *
  * \return cq_elm Quadrature struct on element
  *
- * \note TODO Will be deprecated soon
+ * \note The rule on the reference element is computed on the first call and
+ *       kept in cqelm, so repeated calls only map it to the element.
  *
  */
 void quad_elm(qcoordinates *cqelm,mesh_struct *mesh,INT nq1d,INT elm)
@@ -2588,111 +2888,43 @@ void quad_elm(qcoordinates *cqelm,mesh_struct *mesh,INT nq1d,INT elm)
   SHORT status;
 
   /* Loop indices */
-  INT q,j;
+  INT q,j,k;
 
   /* Dimension */
   INT dim = mesh->dim;
+  if(dim<1 || dim>3) {
+    status = ERROR_DIM;
+    check_error(status, __FUNCTION__);
+  }
 
   /* Total Number of Quadrature Nodes */
-  INT nq = pow(nq1d,dim);
+  INT nq = quad_simplex_nq(nq1d,dim);
 
-  /* Coordinates of vertices of element */
-  INT v_per_elm = mesh->v_per_elm;
-  coordinates *cvelm = allocatecoords(v_per_elm,dim);
-
-  /* Gaussian points for reference element */
-  REAL* gp = (REAL *) calloc(dim*nq,sizeof(REAL));
-  /* Gaussian weights for reference element */
-  REAL* gw = (REAL *) calloc(nq,sizeof(REAL));
+  /* Rule on the reference element */
+  if(cqelm->ref_x==NULL || cqelm->ref_w==NULL) quad_elm_ref(cqelm,dim,nq1d);
 
-  /* Points on Reference Triangle */
-  REAL r,s,t;
+  /* Vertices of the element and their coordinates */
+  INT* thiselm_v = mesh->el_v->JA + mesh->el_v->IA[elm];
+  REAL* cv[3] = {mesh->cv->x,mesh->cv->y,mesh->cv->z};
+  REAL* cqx[3] = {cqelm->x,cqelm->y,cqelm->z};
 
   REAL e_vol = mesh->el_vol[elm]; /* Area/Volume of Element */
-  REAL voldim=0.0;
-
-  // Get vertices of element
-  INT* thiselm_v = (INT *) calloc(v_per_elm,sizeof(INT));
-  iCSRmat* el_v = mesh->el_v;
-  get_incidence_row(elm,el_v,thiselm_v);
-
-  // Get coordinates of vertices for given element
-  if(dim==1) {
-    for (j=0; j<v_per_elm; j++) {
-      cvelm->x[j] = mesh->cv->x[thiselm_v[j]];
-    }
-    voldim = 0.5*e_vol;
-
-    // Get Quad Nodes and Weights
-    quad1d(gp,gw,nq1d);
-
-    // Map to Real Interval
-    // x = 0.5*(x2-x1)*r + 0.5*(x1+x2)
-    // w = 0.5*(x2-x1)*wref
-    for (q=0; q<nq; q++) {
-      r = gp[q];
-      cqelm->x[q] = 0.5*(cvelm->x[0]*(1-r) + cvelm->x[1]*(1+r));
-      cqelm->w[q] = voldim*gw[q];
-    }
-  } else if(dim==2) {
-    for (j=0; j<v_per_elm; j++) {
-      cvelm->x[j] = mesh->cv->x[thiselm_v[j]];
-      cvelm->y[j] = mesh->cv->y[thiselm_v[j]];
-    }
-    voldim = 2.0*e_vol;
-
-    // Get Quad Nodes and Weights
-    triquad_(gp,gw,nq1d);
-
-    // Map to Real Triangle
-    // x = x1*(1-r-s) + x2*r + x3*s
-    // y = y1*(1-r-s) + y2*r + y3*s
-    // w = 2*Element Area*wref
-    for (q=0; q<nq; q++) {
-      r = gp[q];
-      s = gp[nq+q];
-      cqelm->x[q] = cvelm->x[0]*(1-r-s) + cvelm->x[1]*r + cvelm->x[2]*s;
-      cqelm->y[q] = cvelm->y[0]*(1-r-s) + cvelm->y[1]*r + cvelm->y[2]*s;
-      cqelm->w[q] = voldim*gw[q];
-    }
-  } else if(dim==3) {
-    for (j=0; j<v_per_elm; j++) {
-      cvelm->x[j] = mesh->cv->x[thiselm_v[j]];
-      cvelm->y[j] = mesh->cv->y[thiselm_v[j]];
-      cvelm->z[j] = mesh->cv->z[thiselm_v[j]];
-    }
-    voldim = 6.0*e_vol;
-
-    // Get Quad Nodes and Weights
-    tetquad_(gp,gw,nq1d);
-
-    // Map to Real Triangle
-    // x = x1*(1-r-s-t) + x2*r + x3*s + x4*t
-    // y = y1*(1-r-s-t) + y2*r + y3*s + y4*t
-    // z = z1*(1-r-s-t) + z2*r + z3*s + z4*t3*s
-    // w = 6*Element Vol*wref
-    for (q=0; q<nq; q++) {
-      r = gp[q];
-      s = gp[nq+q];
-      t = gp[2*nq+q];
-      cqelm->x[q] = cvelm->x[0]*(1-r-s-t) + cvelm->x[1]*r + cvelm->x[2]*s + cvelm->x[3]*t;
-      cqelm->y[q] = cvelm->y[0]*(1-r-s-t) + cvelm->y[1]*r + cvelm->y[2]*s + cvelm->y[3]*t;
-      cqelm->z[q] = cvelm->z[0]*(1-r-s-t) + cvelm->z[1]*r + cvelm->z[2]*s + cvelm->z[3]*t;
-      cqelm->w[q] = voldim*gw[q];
+  REAL *lam,lam0,xq;
+
+  // Map to the element
+  // x = x1*(1-r-s-t) + x2*r + x3*s + x4*t, etc.
+  // w = vol*wref
+  for (q=0; q<nq; q++) {
+    lam = cqelm->ref_x + q*dim;
+    lam0 = 1.0;
+    for (k=0; k<dim; k++) lam0 -= lam[k];
+    for (j=0; j<dim; j++) {
+      xq = cv[j][thiselm_v[0]]*lam0;
+      for (k=0; k<dim; k++) xq += cv[j][thiselm_v[k+1]]*lam[k];
+      cqx[j][q] = xq;
     }
-  } else {
-    status = ERROR_DIM;
-    check_error(status, __FUNCTION__);
-  }
-
-  if(gp) free(gp);
-  if(gw) free(gw);
-  if(cvelm) {
-    free_coords(cvelm);
-    free(cvelm);
-    cvelm=NULL;
+    cqelm->w[q] = e_vol*cqelm->ref_w[q];
   }
-  if(thiselm_v) free(thiselm_v);
 
   return;
 }
@@ -2701,77 +2933,22 @@ void quad_elm(qcoordinates *cqelm,mesh_struct *mesh,INT nq1d,INT elm)
 /*!
  * \fn qcoordinates* get_quadrature_boundary(mesh_struct *mesh,INT nq1d,INT ed_or_f)
  *
- * \brief Computes quadrature weights and nodes for all faces (surface integral)
- *        or edges (line integral) in entire domain using nq1d quadrature nodes
- *        per 1D direction.
+ * \brief Allocates the quadrature struct for faces (surface integral) or edges
+ *        (line integral) using nq1d quadrature nodes per 1D direction.  The
+ *        nodes of a face or edge are computed with quad_face() or quad_edge()
+ *        when needed.
  *
  * \param nq1d    Number of quadrature nodes on an element in 1D direction
  * \param mesh    Mesh struct
  * \param ed_or_f Whether we do an edge integral (1) or face integral (2)
  *
- * \return cq_all Quadrature struct on boundary
+ * \return cq_bdry Quadrature struct on boundary (one face or edge)
  *
  * \note This will be deprecated
  */
 qcoordinates* get_quadrature_boundary(mesh_struct *mesh,INT nq1d,INT ed_or_f)
 {
-  INT i,j;
-
-  INT dim = mesh->dim;
-  INT nedge = mesh->nedge;
-  INT nface = mesh->nface;
-  INT ndof=0;
-  INT nq=0;
-
-  if(ed_or_f==1) { // 1D integral -> get quadrature on edges
-    ndof=nedge;
-    nq = nq1d;
-  } else if(ed_or_f==2) { // 2D integral -> get quadrature on faces
-    ndof=nface;
-    if(dim==2) { // face is an edge
-      nq = nq1d;
-    } else {
-      nq = nq1d*nq1d;
-    }
-  }
-
-  // Allocate quadrature points
-  qcoordinates *cq_all = allocateqcoords_bdry(nq1d,ndof,dim,ed_or_f);
-  qcoordinates *cq_surf = allocateqcoords_bdry(nq1d,1,dim,ed_or_f);
-
-  if(ed_or_f==1) { // Edges
-    for (i=0; i<ndof; i++) {
-      quad_edge(cq_surf,mesh,nq1d,i);
-      for (j=0; j<nq; j++) {
-        cq_all->x[i*nq+j] = cq_surf->x[j];
-        cq_all->y[i*nq+j] = cq_surf->y[j];
-        cq_all->w[i*nq+j] = cq_surf->w[j];
-        if(dim==3) {
-          cq_all->z[i*nq+j] = cq_surf->z[j];
-        }
-      }
-    }
-  } else { // Faces
-    for (i=0; i<ndof; i++) {
-      quad_face(cq_surf,mesh,nq1d,i);
-      for (j=0; j<nq; j++) {
-        cq_all->x[i*nq+j] = cq_surf->x[j];
-        cq_all->y[i*nq+j] = cq_surf->y[j];
-        cq_all->w[i*nq+j] = cq_surf->w[j];
-        if(dim==3) {
-          cq_all->z[i*nq+j] = cq_surf->z[j];
-        }
-      }
-    }
-  }
-
-  if(cq_surf) {
-    free_qcoords(cq_surf);
-    free(cq_surf);
-    cq_surf = NULL;
-  }
-
-  return cq_all;
+  return allocateqcoords_bdry(nq1d,1,mesh->dim,ed_or_f);
 }
 /******************************************************************************/
 
@@ -2928,7 +3105,7 @@ void quad_face(qcoordinates *cqbdry,mesh_struct *mesh,INT nq1d,INT dof)
   if(dim==2) { // face is edge in 2D
     nq = nq1d;
   } else if(dim==3) {
-    nq = nq1d*nq1d;
+    nq = quad_simplex_nq(nq1d,2);
   } else {
     status = ERROR_DIM;
     check_error(status, __FUNCTION__);
@@ -2980,7 +3157,7 @@ void quad_face(qcoordinates *cqbdry,mesh_struct *mesh,INT nq1d,INT dof)
   if(dim==2) { // face is an edge
     quad1d(gp,gw,nq1d);
   } else if(dim==3) { // face is a face
-    triquad_(gp,gw,nq1d);
+    quad_simplex(gp,gw,nq1d,2);
   } else {
     status = ERROR_DIM;
     check_error(status, __FUNCTION__);
@@ -3003,9 +3180,9 @@ void quad_face(qcoordinates *cqbdry,mesh_struct *mesh,INT nq1d,INT dof)
     //        y = y1*(1-r-s) + y2*r + y3*s
     //        z = z1*(1-r-s) + z2*r + z3*s
     //        w = 2*Element Area*wref
-    for (q=0; q<nq1d*nq1d; q++) {
+    for (q=0; q<nq; q++) {
       r = gp[q];
-      s = gp[nq1d*nq1d+q];
+      s = gp[nq+q];
       cqbdry->x[q] = cvdof->x[0]*(1-r-s) + cvdof->x[1]*r + cvdof->x[2]*s;
       cqbdry->y[q] = cvdof->y[0]*(1-r-s) + cvdof->y[1]*r + cvdof->y[2]*s;
       cqbdry->z[q] = cvdof->z[0]*(1-r-s) + cvdof->z[1]*r + cvdof->z[2]*s;
@@ -3082,8 +3259,9 @@ void dump_qcoords(qcoordinates *q)
 *
 * \return integral Integral of scalar function over element
 *
-* \note If cq is given, we will just use these precomputed values instead of reallocating the quadrature.
-*       Otherwise, we will allocate a new set of quadrature based on nq1d
+* \note If cq is given, its arrays are filled with the nodes of this entity (using cq->nq1d)
+*       instead of reallocating the quadrature.  Otherwise, we will allocate a new set of
+*       quadrature based on nq1d
 */
 REAL integrate_elm(void (*expr)(REAL *,REAL *,REAL,void *),INT nun,INT comp,INT nq1d,qcoordinates *cq,mesh_struct *mesh,REAL time,INT elm)
 {
@@ -3103,11 +3281,12 @@ REAL integrate_elm(void (*expr)(REAL *,REAL *,REAL,void *),INT nun,INT comp,INT
 
   // Quadrature on elm
   if(cq) { // assuming quadrature is given
+    quad_elm(cq,mesh,cq->nq1d,elm);
     for (quad=0;quad<cq->nq_per_elm;quad++) {
-      qx[0] = cq->x[elm*cq->nq_per_elm+quad];
-      if(mesh->dim>1) qx[1] = cq->y[elm*cq->nq_per_elm+quad];
-      if(mesh->dim==3) qx[2] = cq->z[elm*cq->nq_per_elm+quad];
-      w = cq->w[elm*cq->nq_per_elm+quad];
+      qx[0] = cq->x[quad];
+      if(mesh->dim>1) qx[1] = cq->y[quad];
+      if(mesh->dim==3) qx[2] = cq->z[quad];
+      w = cq->w[quad];
       (*expr)(uval,qx,time,&(mesh->el_flag[elm]));
       integral += w*uval[comp];
     }
@@ -3148,8 +3327,9 @@ REAL integrate_elm(void (*expr)(REAL *,REAL *,REAL,void *),INT nun,INT comp,INT
 *
 * \return integral Integral of scalar function over domain
 *
-* \note If cq is given, we will just use these precomputed values instead of reallocating the quadrature.
-*       Otherwise, we will allocate a new set of quadrature based on nq1d
+* \note If cq is given, its arrays are filled with the nodes of this entity (using cq->nq1d)
+*       instead of reallocating the quadrature.  Otherwise, we will allocate a new set of
+*       quadrature based on nq1d
 */
 REAL integrate_domain(void (*expr)(REAL *,REAL *,REAL,void *),INT nun,INT comp,INT nq1d,qcoordinates *cq,mesh_struct *mesh,REAL time)
 {
@@ -3183,8 +3363,9 @@ REAL integrate_domain(void (*expr)(REAL *,REAL *,REAL,void *),INT nun,INT comp,I
 *
 * \return integral Integral of scalar function over face
 *
-* \note If cq is given, we will just use these precomputed values instead of reallocating the quadrature.
-*       Otherwise, we will allocate a new set of quadrature based on nq1d
+* \note If cq is given, its arrays are filled with the nodes of this entity (using cq->nq1d)
+*       instead of reallocating the quadrature.  Otherwise, we will allocate a new set of
+*       quadrature based on nq1d
 *
 * \note In 3D, this is an area (2D) integral.  In 2D, this is a line (1D) integral.
 *
@@ -3206,11 +3387,12 @@ REAL integrate_face(void (*expr)(REAL *,REAL *,REAL,void *),INT nun,INT comp,INT
 
   // Quadrature on elm
   if(cq) { // assuming quadrature is given
+    quad_face(cq,mesh,cq->nq1d,face);
     for (quad=0;quad<cq->nq_per_elm;quad++) {
-      qx[0] = cq->x[face*cq->nq_per_elm+quad];
-      qx[1] = cq->y[face*cq->nq_per_elm+quad];
-      if(mesh->dim==3) qx[2] = cq->z[face*cq->nq_per_elm+quad];
-      w = cq->w[face*cq->nq_per_elm+quad];
+      qx[0] = cq->x[quad];
+      qx[1] = cq->y[quad];
+      if(mesh->dim==3) qx[2] = cq->z[quad];
+      w = cq->w[quad];
       (*expr)(uval,qx,time,&(mesh->f_flag[face]));
       integral += w*uval[comp];
     }
@@ -3252,8 +3434,9 @@ REAL integrate_face(void (*expr)(REAL *,REAL *,REAL,void *),INT nun,INT comp,INT
 *
 * \return integral Integral of scalar function over edge
 *
-* \note If cq is given, we will just use these precomputed values instead of reallocating the quadrature.
-*       Otherwise, we will allocate a new set of quadrature based on nq1d
+* \note If cq is given, its arrays are filled with the nodes of this entity (using cq->nq1d)
+*       instead of reallocating the quadrature.  Otherwise, we will allocate a new set of
+*       quadrature based on nq1d
 *
 * \note This is a line integral in any dimension
 *
@@ -3275,11 +3458,12 @@ REAL integrate_edge(void (*expr)(REAL *,REAL *,REAL,void *),INT nun,INT comp,INT
 
   // Quadrature on elm
   if(cq) { // assuming quadrature is given
+    quad_edge(cq,mesh,cq->nq1d,edge);
     for (quad=0;quad<cq->nq_per_elm;quad++) {
-      qx[0] = cq->x[edge*cq->nq_per_elm+quad];
-      qx[1] = cq->y[edge*cq->nq_per_elm+quad];
-      if(mesh->dim==3) qx[2] = cq->z[edge*cq->nq_per_elm+quad];
-      w = cq->w[edge*cq->nq_per_elm+quad];
+      qx[0] = cq->x[quad];
+      qx[1] = cq->y[quad];
+      if(mesh->dim==3) qx[2] = cq->z[quad];
+      w = cq->w[quad];
       (*expr)(uval,qx,time,&(mesh->ed_flag[edge]));
       integral += w*uval[comp];
     }
@@ -3321,8 +3505,9 @@ REAL integrate_edge(void (*expr)(REAL *,REAL *,REAL,void *),INT nun,INT comp,INT
 *
 * \return integral Integral of vector function along the edge
 *
-* \note If cq is given, we will just use these precomputed values instead of reallocating the quadrature.
-*       Otherwise, we will allocate a new set of quadrature based on nq1d
+* \note If cq is given, its arrays are filled with the nodes of this entity (using cq->nq1d)
+*       instead of reallocating the quadrature.  Otherwise, we will allocate a new set of
+*       quadrature based on nq1d
 *
 * \note This is a tangential line integral in any dimension
 *
@@ -3346,11 +3531,12 @@ REAL integrate_edge_vector_tangent(void (*expr)(REAL *,REAL *,REAL,void *),INT n
 
   // Quadrature on elm
   if(cq) { // assuming quadrature is given
+    quad_edge(cq,mesh,cq->nq1d,edge);
     for (quad=0;quad<cq->nq_per_elm;quad++) {
-      qx[0] = cq->x[edge*cq->nq_per_elm+quad];
-      qx[1] = cq->y[edge*cq->nq_per_elm+quad];
-      if(dim==3) qx[2] = cq->z[edge*cq->nq_per_elm+quad];
-      w = cq->w[edge*cq->nq_per_elm+quad];
+      qx[0] = cq->x[quad];
+      qx[1] = cq->y[quad];
+      if(dim==3) qx[2] = cq->z[quad];
+      w = cq->w[quad];
       (*expr)(uval,qx,time,&(mesh->ed_flag[edge]));
       for(j=0; j<dim; j++) integral += w*uval[comp+j]*mesh->ed_tau[edge*dim+j];
     }
@@ -3392,8 +3578,9 @@ REAL integrate_edge_vector_tangent(void (*expr)(REAL *,REAL *,REAL,void *),INT n
 *
 * \return integral Integral of vector function across the face
 *
-* \note If cq is given, we will just use these precomputed values instead of reallocating the quadrature.
-*       Otherwise, we will allocate a new set of quadrature based on nq1d
+* \note If cq is given, its arrays are filled with the nodes of this entity (using cq->nq1d)
+*       instead of reallocating the quadrature.  Otherwise, we will allocate a new set of
+*       quadrature based on nq1d
 *
 */
 REAL integrate_face_vector_normal(void (*expr)(REAL *,REAL *,REAL,void *),INT nun,INT comp,INT nq1d,qcoordinates *cq,mesh_struct *mesh,REAL time,INT face)
@@ -3415,11 +3602,12 @@ REAL integrate_face_vector_normal(void (*expr)(REAL *,REAL *,REAL,void *),INT nu
 
   // Quadrature on elm
   if(cq) { // assuming quadrature is given
+    quad_face(cq,mesh,cq->nq1d,face);
     for (quad=0;quad<cq->nq_per_elm;quad++) {
-      qx[0] = cq->x[face*cq->nq_per_elm+quad];
-      qx[1] = cq->y[face*cq->nq_per_elm+quad];
-      if(dim==3) qx[2] = cq->z[face*cq->nq_per_elm+quad];
-      w = cq->w[face*cq->nq_per_elm+quad];
+      qx[0] = cq->x[quad];
+      qx[1] = cq->y[quad];
+      if(dim==3) qx[2] = cq->z[quad];
+      w = cq->w[quad];
       (*expr)(uval,qx,time,&(mesh->f_flag[face]));
       for(j=0; j<dim; j++) integral += w*uval[comp+j]*mesh->f_norm[face*dim+j];
     }
@@ -539,6 +539,9 @@ precond* create_precond_ra(dCSRmat *A,
     pcdata->s_power = s_frac_power;
     pcdata->t_power = t_frac_power;
 
+    // workspace of the poles (see precond_ra_fenics)
+    pcdata->zpoles = (REAL *)calloc(MAX(npoles,1)*n, sizeof(REAL));
+
     pc->data = pcdata;
     pc->fct = precond_ra_fenics;
 
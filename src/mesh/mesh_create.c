@@ -55,6 +55,8 @@ void initialize_mesh(mesh_struct* mesh)
   mesh->el_flag = NULL;
   mesh->dwork = NULL;
   mesh->iwork = NULL;
+  mesh->map = NULL;
+  mesh->map_len = 0;
   return;
 }
 
@@ -64,7 +66,8 @@ void initialize_mesh(mesh_struct* mesh)
 * \brief Creates grid by reading in from file.
 *
 * \param gfid      Grid FILE ID
-* \param file_type Type of File Input: 0 - haz format; 1 - vtk format
+* \param file_type Type of File Input: 0 - haz format; 1 - vtk format;
+*                  2 - binary format (see read_grid_bin())
 *
 * \return mesh     Struct for Mesh
 *
@@ -80,6 +83,8 @@ void creategrid_fread(FILE *gfid,INT file_type,mesh_struct* mesh)
     fprintf(stdout,"reading complete...\n");fflush(stdout);
   } else if(file_type==1) {
     read_grid_vtk(gfid,mesh);
+  } else if(file_type==2) {
+    read_grid_bin(gfid,mesh);
   } else {
     fprintf(stderr,"Unknown mesh file type, %d. Try using vtk format. -Exiting\n",file_type);
     exit(255);
@@ -324,6 +329,519 @@ void build_mesh_all(mesh_struct* mesh)
   return;
 }
 
+/*!
+* \fn void build_mesh_refined(mesh_struct* mesh,scomplex *sc,INT ns_old,ivector *el_parent)
+*
+* \brief Updates a mesh after adaptive refinement of the simplicial
+*        complex it was built from.  Connectivity and geometry are only
+*        computed for the new elements and the edges and faces touching
+*        them, instead of rebuilding the whole mesh with sc2mesh() and
+*        build_mesh_all().
+*
+* \param mesh      Mesh on the leaves of sc when sc had ns_old simplices (from
+*                  sc2mesh() and build_mesh_all(), or from this routine)
+* \param sc        Simplicial complex after refine()
+* \param ns_old    Number of simplices of sc when mesh was built
+*
+* \return mesh       Mesh on the leaves of sc
+* \return el_parent  If not NULL, the element of the old mesh containing each
+*                    element of the new mesh
+*
+* \note Elements are ordered as in sc2mesh(): the ones which were not refined
+*       come first, in their old order.  Vertices, edges and faces which
+*       were not refined keep their numbers, so the DOF of FE spaces created
+*       again on the mesh keep their numbers too.  The numbers of bisected
+*       edges and faces are given to new ones, and the rest are appended.
+* \note As in scfinest(), child0 of every leaf of sc is set to -(element+1),
+*       so the elements of the mesh can be marked for the next refine().
+* \note Boundary codes of the old vertices are assumed unchanged.
+* \note If the mesh was mapped from a binary file by read_grid_bin(), its
+*       arrays are copied out of the mapping first.
+*
+*/
+void build_mesh_refined(mesh_struct* mesh,scomplex *sc,INT ns_old,ivector *el_parent)
+{
+  INT dim = mesh->dim;
+  INT n1 = dim+1;
+  INT nv_old = mesh->nv, nelm_old = mesh->nelm;
+  INT nedge_old = mesh->nedge, nface_old = mesh->nface;
+  INT edpe = (dim*(dim+1))/2;
+  INT edpf = 2*dim-3;
+  INT i,j,k,l,p,q,r,g,e,t,occ,knew,maxe,nb; /* Loop indices and counters */
+  INT *tl,*ev,*row;
+  INT fv[3],fp[3];
+
+  if((dim!=2 && dim!=3) || sc->n!=dim || sc->nbig!=dim) {
+    check_error(ERROR_DIM, __FUNCTION__);
+  }
+
+  /* The arrays below are reallocated, so they cannot stay in a mapped file */
+  if(mesh->map) release_mesh_map(mesh,1);
+
+  /* Elements: old element of every old leaf, unrefined and new leaves */
+  INT* old_el = (INT *) calloc(ns_old+1,sizeof(INT));
+  k=0;
+  for(j=0;j<ns_old;j++) {
+    if(sc->child0[j]<0 || sc->childn[j]<0 || sc->child0[j]>=ns_old) {
+      old_el[j] = k++;
+    } else {
+      old_el[j] = -1;
+    }
+  }
+  if(k!=nelm_old) check_error(ERROR_DATA_STRUCTURE, __FUNCTION__);
+  INT nelm=0, nkept=0;
+  for(j=0;j<sc->ns;j++) {
+    if(sc->child0[j]<0 || sc->childn[j]<0) {
+      if(j<ns_old) nkept++;
+      nelm++;
+    }
+  }
+  INT nnew = nelm-nkept, nref = nelm_old-nkept;
+  INT* kept = (INT *) calloc(nkept+1,sizeof(INT)); // old number of kept elements
+  INT* elsc = (INT *) calloc(nnew+1,sizeof(INT)); // simplex of new elements
+  INT* ref = (INT *) calloc(nref+1,sizeof(INT)); // simplex of refined elements
+  e=0;
+  for(j=0;j<sc->ns;j++) {
+    if(sc->child0[j]<0 || sc->childn[j]<0) {
+      if(j<ns_old) {
+        kept[e] = old_el[j];
+      } else {
+        elsc[e-nkept] = j;
+      }
+      sc->child0[j] = -(e+1);
+      e++;
+    }
+  }
+  r=0;
+  for(j=0;j<ns_old;j++) {
+    if(old_el[j]>=0 && sc->child0[j]>=0) ref[r++] = j;
+  }
+  if(el_parent) {
+    *el_parent = ivec_create(nelm);
+    for(e=0;e<nkept;e++) el_parent->val[e] = kept[e];
+    for(i=0;i<nnew;i++) {
+      j = elsc[i];
+      while(j>=ns_old) j = sc->parent[j];
+      el_parent->val[nkept+i] = old_el[j];
+    }
+  }
+
+  /* Vertices: new ones are appended */
+  INT nv = sc->nv;
+  coordinates *cv = allocatecoords(nv,dim);
+  for(k=0;k<dim;k++) {
+    memcpy(cv->x+k*nv,mesh->cv->x+k*nv_old,nv_old*sizeof(REAL));
+    for(i=nv_old;i<nv;i++) cv->x[k*nv+i] = sc->x[i*dim+k];
+  }
+  free_coords(mesh->cv);
+  free(mesh->cv);
+  mesh->cv = cv;
+  mesh->v_flag = (INT *) realloc(mesh->v_flag,nv*sizeof(INT));
+  for(i=nv_old;i<nv;i++) {
+    mesh->v_flag[i] = sc->bndry[i];
+    if(sc->bndry[i]!=0) mesh->nbv++;
+  }
+  mesh->nv = nv;
+
+  /* Element to vertex map, flags, volumes and midpoints */
+  iCSRmat* el_v = (iCSRmat *) malloc(sizeof(iCSRmat));
+  el_v[0] = icsr_create(nelm,nv,nelm*n1);
+  free(el_v->val); el_v->val=NULL;
+  INT* el_flag = (INT *) calloc(nelm,sizeof(INT));
+  REAL* el_vol = (REAL *) calloc(nelm,sizeof(REAL));
+  REAL* el_mid = (REAL *) calloc(nelm*dim,sizeof(REAL));
+  for(e=0;e<=nelm;e++) el_v->IA[e] = e*n1;
+  for(e=0;e<nkept;e++) {
+    memcpy(el_v->JA+e*n1,mesh->el_v->JA+mesh->el_v->IA[kept[e]],n1*sizeof(INT));
+    el_flag[e] = mesh->el_flag[kept[e]];
+    el_vol[e] = mesh->el_vol[kept[e]];
+    memcpy(el_mid+e*dim,mesh->el_mid+kept[e]*dim,dim*sizeof(REAL));
+  }
+  for(i=0;i<nnew;i++) {
+    memcpy(el_v->JA+(nkept+i)*n1,sc->nodes+elsc[i]*n1,n1*sizeof(INT));
+    el_flag[nkept+i] = sc->flags[elsc[i]];
+  }
+  // the new elements are the last rows of el_v
+  iCSRmat el_v_new = *el_v;
+  el_v_new.IA = el_v->IA+nkept;
+  el_v_new.row = nnew;
+  get_el_vol(el_vol+nkept,&el_v_new,cv,dim,n1);
+  get_el_mid(el_mid+nkept*dim,&el_v_new,cv,dim);
+
+  /* Edges: match the edges of the refined elements and of the new ones */
+  INT* lnum = (INT *) calloc(n1*n1,sizeof(INT));
+  l=0;
+  for(p=0;p<n1;p++) {
+    for(q=p+1;q<n1;q++) {
+      lnum[p*n1+q] = lnum[q*n1+p] = l++;
+    }
+  }
+  iCSRmat *ed_v = mesh->ed_v;
+  iCSRmat *el_ed_old = mesh->el_ed;
+  INT ncand = nref*edpe;
+  INT mE = ncand+nnew*edpe;
+  INT* tup = (INT *) calloc(2*mE+1,sizeof(INT));
+  INT* eid = (INT *) calloc(mE+1,sizeof(INT));
+  for(r=0;r<nref;r++) {
+    for(l=0;l<edpe;l++) {
+      k = el_ed_old->JA[el_ed_old->IA[old_el[ref[r]]]+l];
+      p = ed_v->JA[ed_v->IA[k]];
+      q = ed_v->JA[ed_v->IA[k]+1];
+      tup[2*(r*edpe+l)] = MIN(p,q);
+      tup[2*(r*edpe+l)+1] = MAX(p,q);
+    }
+  }
+#ifdef _OPENMP
+#pragma omp parallel for private(p,q,tl,ev) if(nnew>1024)
+#endif
+  for(i=0;i<nnew;i++) {
+    ev = el_v->JA+(nkept+i)*n1;
+    tl = tup+2*(ncand+i*edpe);
+    for(p=0;p<n1;p++) {
+      for(q=p+1;q<n1;q++) {
+        tl[0] = MIN(ev[p],ev[q]);
+        tl[1] = MAX(ev[p],ev[q]);
+        tl += 2;
+      }
+    }
+  }
+  INT ng = hash_match_tuples(mE,2,tup,eid,NULL);
+  INT* gold = (INT *) calloc(ng+1,sizeof(INT)); // old edge of each group
+  INT* gocc = (INT *) calloc(ng+1,sizeof(INT)); // first occurrence in a new element
+  INT* gnum = (INT *) calloc(ng+1,sizeof(INT)); // edge of each group
+  for(g=0;g<ng;g++) {
+    gold[g] = -1;
+    gocc[g] = -1;
+  }
+  for(i=0;i<ncand;i++) {
+    gold[eid[i]] = el_ed_old->JA[el_ed_old->IA[old_el[ref[i/edpe]]]+i%edpe];
+  }
+  for(i=mE-1;i>=ncand;i--) gocc[eid[i]] = i;
+  // bisected edges are in no new element; their numbers are reused
+  INT nfreed=0;
+  INT* freed = (INT *) calloc(ng+1,sizeof(INT));
+  for(g=0;g<ng;g++) {
+    if(gold[g]>=0 && gocc[g]<0) {
+      freed[nfreed++] = gold[g];
+      if(mesh->ed_flag[gold[g]]!=0) mesh->nbedge--;
+    }
+  }
+  knew=0;
+  for(g=0;g<ng;g++) {
+    if(gold[g]>=0) {
+      gnum[g] = gold[g];
+    } else {
+      gnum[g] = (knew<nfreed) ? freed[knew] : nedge_old+knew-nfreed;
+      knew++;
+    }
+  }
+  if(knew<nfreed) check_error(ERROR_DATA_STRUCTURE, __FUNCTION__);
+  INT nedge = nedge_old+knew-nfreed;
+  ed_v->IA = (INT *) realloc(ed_v->IA,(nedge+1)*sizeof(INT));
+  ed_v->JA = (INT *) realloc(ed_v->JA,2*nedge*sizeof(INT));
+  for(k=nedge_old;k<=nedge;k++) ed_v->IA[k] = 2*k;
+  ed_v->row = nedge;
+  ed_v->col = nv;
+  ed_v->nnz = 2*nedge;
+  mesh->ed_len = (REAL *) realloc(mesh->ed_len,nedge*sizeof(REAL));
+  mesh->ed_tau = (REAL *) realloc(mesh->ed_tau,nedge*dim*sizeof(REAL));
+  mesh->ed_mid = (REAL *) realloc(mesh->ed_mid,nedge*dim*sizeof(REAL));
+  mesh->ed_flag = (INT *) realloc(mesh->ed_flag,nedge*sizeof(INT));
+  // New edges (i->j with i<j is stored as (j,i)) and their stats
+  iCSRmat ed_v_new = icsr_create(knew,nv,2*knew);
+  INT* ed_slot = (INT *) calloc(knew+1,sizeof(INT));
+  k=0;
+  for(g=0;g<ng;g++) {
+    if(gold[g]>=0) continue;
+    occ = gocc[g];
+    ed_slot[k] = gnum[g];
+    ed_v_new.IA[k] = 2*k;
+    ed_v_new.JA[2*k] = ed_v->JA[2*gnum[g]] = tup[2*occ+1];
+    ed_v_new.JA[2*k+1] = ed_v->JA[2*gnum[g]+1] = tup[2*occ];
+    mesh->ed_flag[gnum[g]] = 0;
+    k++;
+  }
+  if(knew>0) ed_v_new.IA[knew] = 2*knew;
+  REAL* ed_len = (REAL *) calloc(knew+1,sizeof(REAL));
+  REAL* ed_tau = (REAL *) calloc(knew*dim+1,sizeof(REAL));
+  REAL* ed_mid = (REAL *) calloc(knew*dim+1,sizeof(REAL));
+  edge_stats_all(ed_len,ed_tau,ed_mid,cv,&ed_v_new,dim);
+  for(k=0;k<knew;k++) {
+    mesh->ed_len[ed_slot[k]] = ed_len[k];
+    memcpy(mesh->ed_tau+ed_slot[k]*dim,ed_tau+k*dim,dim*sizeof(REAL));
+    memcpy(mesh->ed_mid+ed_slot[k]*dim,ed_mid+k*dim,dim*sizeof(REAL));
+  }
+  free(ed_len);
+  free(ed_tau);
+  free(ed_mid);
+  free(ed_slot);
+  icsr_free(&ed_v_new);
+
+  // Edges of the new elements, and the element to edge map: the edges of
+  // a row are ordered by the position of their first vertex in the element
+  // and then by number
+  INT* eloc = (INT *) calloc(nnew*edpe+1,sizeof(INT));
+  for(i=0;i<nnew*edpe;i++) eloc[i] = gnum[eid[ncand+i]];
+  iCSRmat* el_ed = (iCSRmat *) malloc(sizeof(iCSRmat));
+  el_ed[0] = icsr_create(nelm,nedge,nelm*edpe);
+  free(el_ed->val); el_ed->val=NULL;
+  for(e=0;e<=nelm;e++) el_ed->IA[e] = e*edpe;
+  for(e=0;e<nkept;e++) {
+    memcpy(el_ed->JA+e*edpe,el_ed_old->JA+el_ed_old->IA[kept[e]],edpe*sizeof(INT));
+  }
+#ifdef _OPENMP
+#pragma omp parallel for private(p,k,row) if(nnew>1024)
+#endif
+  for(i=0;i<nnew;i++) {
+    row = el_ed->JA+(nkept+i)*edpe;
+    memcpy(row,eloc+i*edpe,edpe*sizeof(INT));
+    k=0;
+    for(p=0;p<n1;p++) {
+      isi_sort(n1-1-p,row+k);
+      k += n1-1-p;
+    }
+  }
+  icsr_free(el_ed_old);
+  free(el_ed_old);
+  mesh->el_ed = el_ed;
+  icsr_free(mesh->el_v);
+  free(mesh->el_v);
+  mesh->el_v = el_v;
+
+  /* Faces: match the faces of the refined elements and of the new ones */
+  INT* fel_order = (INT *) calloc(n1*dim,sizeof(INT));
+  get_face_ordering(n1,dim,n1,fel_order);
+  iCSRmat *f_v = mesh->f_v;
+  iCSRmat *f_ed = mesh->f_ed;
+  iCSRmat *el_f_old = mesh->el_f;
+  INT ncf = nref*n1;
+  INT mF = ncf+nnew*n1;
+  tup = (INT *) realloc(tup,(dim*mF+1)*sizeof(INT));
+  INT* fid = (INT *) calloc(mF+1,sizeof(INT));
+  for(r=0;r<nref;r++) {
+    for(l=0;l<n1;l++) {
+      k = el_f_old->JA[el_f_old->IA[old_el[ref[r]]]+l];
+      memcpy(tup+dim*(r*n1+l),f_v->JA+f_v->IA[k],dim*sizeof(INT));
+      isi_sort(dim,tup+dim*(r*n1+l));
+    }
+  }
+#ifdef _OPENMP
+#pragma omp parallel for private(l,k,tl,ev) if(nnew>1024)
+#endif
+  for(i=0;i<nnew;i++) {
+    ev = el_v->JA+(nkept+i)*n1;
+    for(l=0;l<n1;l++) {
+      tl = tup+dim*(ncf+i*n1+l);
+      for(k=0;k<dim;k++) tl[k] = ev[fel_order[l*dim+k]];
+      isi_sort(dim,tl);
+    }
+  }
+  ng = hash_match_tuples(mF,dim,tup,fid,NULL);
+  gold = (INT *) realloc(gold,(ng+1)*sizeof(INT)); // old face of each group
+  gocc = (INT *) realloc(gocc,(2*ng+1)*sizeof(INT)); // occurrences in new elements
+  gnum = (INT *) realloc(gnum,(ng+1)*sizeof(INT)); // face of each group
+  freed = (INT *) realloc(freed,(ng+1)*sizeof(INT));
+  INT* gbdry = (INT *) calloc(ng+1,sizeof(INT)); // boundary faces
+  for(g=0;g<ng;g++) {
+    gold[g] = -1;
+    gocc[2*g] = gocc[2*g+1] = -1;
+  }
+  for(i=0;i<ncf;i++) {
+    j = el_f_old->IA[old_el[ref[i/n1]]]+i%n1;
+    gold[fid[i]] = el_f_old->JA[j];
+    // the neighbor across a face is stored at the place of the opposite vertex
+    gbdry[fid[i]] = (sc->nbr[ref[i/n1]*n1+el_f_old->val[j]]<0);
+  }
+  for(i=ncf;i<mF;i++) {
+    g = fid[i];
+    if(gocc[2*g]<0) {
+      gocc[2*g] = i-ncf;
+    } else if(gocc[2*g+1]<0) {
+      gocc[2*g+1] = i-ncf;
+    } else {
+      check_error(ERROR_DATA_STRUCTURE, __FUNCTION__);
+    }
+  }
+  // bisected faces are in no new element; their numbers are reused
+  nfreed=0;
+  for(g=0;g<ng;g++) {
+    if(gold[g]>=0 && gocc[2*g]<0) {
+      freed[nfreed++] = gold[g];
+      if(gbdry[g]) mesh->nbface--;
+    }
+  }
+  knew=0;
+  INT ntouch=0;
+  for(g=0;g<ng;g++) {
+    if(gold[g]>=0) {
+      gnum[g] = gold[g];
+    } else {
+      gnum[g] = (knew<nfreed) ? freed[knew] : nface_old+knew-nfreed;
+      knew++;
+    }
+    if(gocc[2*g]>=0) ntouch++;
+  }
+  if(knew<nfreed) check_error(ERROR_DATA_STRUCTURE, __FUNCTION__);
+  INT nface = nface_old+knew-nfreed;
+  f_v->IA = (INT *) realloc(f_v->IA,(nface+1)*sizeof(INT));
+  f_v->JA = (INT *) realloc(f_v->JA,nface*dim*sizeof(INT));
+  if(f_v->val) f_v->val = (INT *) realloc(f_v->val,nface*dim*sizeof(INT));
+  for(k=nface_old;k<=nface;k++) f_v->IA[k] = k*dim;
+  f_v->row = nface;
+  f_v->col = nv;
+  f_v->nnz = nface*dim;
+  f_ed->IA = (INT *) realloc(f_ed->IA,(nface+1)*sizeof(INT));
+  f_ed->JA = (INT *) realloc(f_ed->JA,nface*edpf*sizeof(INT));
+  if(f_ed->val) f_ed->val = (INT *) realloc(f_ed->val,nface*edpf*sizeof(INT));
+  for(k=nface_old;k<=nface;k++) f_ed->IA[k] = k*edpf;
+  f_ed->row = nface;
+  f_ed->col = nedge;
+  f_ed->nnz = nface*edpf;
+  mesh->f_area = (REAL *) realloc(mesh->f_area,nface*sizeof(REAL));
+  mesh->f_mid = (REAL *) realloc(mesh->f_mid,nface*dim*sizeof(REAL));
+  mesh->f_norm = (REAL *) realloc(mesh->f_norm,nface*dim*sizeof(REAL));
+  mesh->f_flag = (INT *) realloc(mesh->f_flag,nface*sizeof(INT));
+
+  // Faces touching new elements: vertices (in increasing order) and edges
+  // (ordered as in el_ed), and the element with lower number, which the
+  // normal vector points out of.  If only one new element has the face and
+  // it is not on the boundary, this is an unrefined element, so the normal
+  // is the inward one of the new element.
+  INT* flist = (INT *) calloc(ntouch+1,sizeof(INT));
+  INT* fel = (INT *) calloc(2*ntouch+1,sizeof(INT));
+  INT* fflip = (INT *) calloc(ntouch+1,sizeof(INT));
+  t=0;
+  for(g=0;g<ng;g++) {
+    if(gocc[2*g]<0) continue;
+    k = gnum[g];
+    occ = gocc[2*g];
+    i = occ/n1;
+    l = occ%n1;
+    flist[t] = k;
+    fel[2*t] = nkept+i;
+    fel[2*t+1] = l;
+    if(gocc[2*g+1]>=0) {
+      gbdry[g] = 0;
+    } else {
+      nb = sc->nbr[elsc[i]*n1+l];
+      gbdry[g] = (nb<0);
+      fflip[t] = (nb>=0);
+    }
+    if(gold[g]<0 && gbdry[g]) mesh->nbface++;
+    memcpy(f_v->JA+k*dim,tup+dim*(ncf+occ),dim*sizeof(INT));
+    if(f_v->val) memset(f_v->val+k*dim,0,dim*sizeof(INT));
+    // local positions of the face vertices, in increasing order
+    ev = el_v->JA+(nkept+i)*n1;
+    for(j=0;j<dim;j++) {
+      fv[j] = ev[fel_order[l*dim+j]];
+      fp[j] = fel_order[l*dim+j];
+    }
+    for(j=1;j<dim;j++) {
+      for(q=j;q>0 && fv[q-1]>fv[q];q--) {
+        p = fv[q]; fv[q] = fv[q-1]; fv[q-1] = p;
+        p = fp[q]; fp[q] = fp[q-1]; fp[q-1] = p;
+      }
+    }
+    row = f_ed->JA+k*edpf;
+    if(f_ed->val) memset(f_ed->val+k*edpf,0,edpf*sizeof(INT));
+    r=0;
+    for(p=0;p<dim;p++) {
+      for(q=p+1;q<dim;q++) row[r+q-p-1] = eloc[i*edpe+lnum[fp[p]*n1+fp[q]]];
+      isi_sort(dim-1-p,row+r);
+      r += dim-1-p;
+    }
+    t++;
+  }
+  face_stats_list(ntouch,flist,fel,mesh->f_area,mesh->f_mid,mesh->f_norm,f_v,mesh);
+  for(t=0;t<ntouch;t++) {
+    if(!fflip[t]) continue;
+    for(j=0;j<dim;j++) mesh->f_norm[flist[t]*dim+j] = -mesh->f_norm[flist[t]*dim+j];
+  }
+  sync_facenode_list(ntouch,flist,f_v,mesh->f_norm,mesh);
+
+  // Face and edge flags (as in boundary_f_ed())
+  t=0;
+  for(g=0;g<ng;g++) {
+    if(gocc[2*g]<0) continue;
+    k = flist[t++];
+    if(!gbdry[g]) {
+      mesh->f_flag[k] = 0;
+      continue;
+    }
+    maxe = -666;
+    for(j=0;j<edpf;j++) {
+      e = f_ed->JA[k*edpf+j];
+      p = MAX(mesh->v_flag[ed_v->JA[2*e]],mesh->v_flag[ed_v->JA[2*e+1]]);
+      if(mesh->ed_flag[e]==0 && p!=0) mesh->nbedge++;
+      if(mesh->ed_flag[e]!=0 && p==0) mesh->nbedge--;
+      mesh->ed_flag[e] = p;
+      if(p>maxe) maxe = p;
+    }
+    mesh->f_flag[k] = maxe;
+  }
+
+  // Element to face map: faces of a row in increasing order, with their
+  // position on the element in val
+  iCSRmat* el_f = (iCSRmat *) malloc(sizeof(iCSRmat));
+  el_f[0] = icsr_create(nelm,nface,nelm*n1);
+  for(e=0;e<=nelm;e++) el_f->IA[e] = e*n1;
+  for(e=0;e<nkept;e++) {
+    memcpy(el_f->JA+e*n1,el_f_old->JA+el_f_old->IA[kept[e]],n1*sizeof(INT));
+    memcpy(el_f->val+e*n1,el_f_old->val+el_f_old->IA[kept[e]],n1*sizeof(INT));
+  }
+#ifdef _OPENMP
+#pragma omp parallel for private(l,k,q,p,row,tl) if(nnew>1024)
+#endif
+  for(i=0;i<nnew;i++) {
+    row = el_f->JA+(nkept+i)*n1;
+    tl = el_f->val+(nkept+i)*n1;
+    for(l=0;l<n1;l++) {
+      k = gnum[fid[ncf+i*n1+l]];
+      for(q=l;q>0 && row[q-1]>k;q--) {
+        row[q] = row[q-1];
+        tl[q] = tl[q-1];
+      }
+      row[q] = k;
+      tl[q] = l;
+    }
+  }
+  icsr_free(el_f_old);
+  free(el_f_old);
+  mesh->el_f = el_f;
+
+  /* Assign the rest to the mesh */
+  free(mesh->el_flag);
+  free(mesh->el_vol);
+  free(mesh->el_mid);
+  mesh->el_flag = el_flag;
+  mesh->el_vol = el_vol;
+  mesh->el_mid = el_mid;
+  mesh->nelm = nelm;
+  mesh->nedge = nedge;
+  mesh->nface = nface;
+
+  free(old_el);
+  free(kept);
+  free(elsc);
+  free(ref);
+  free(lnum);
+  free(tup);
+  free(eid);
+  free(fid);
+  free(gold);
+  free(gocc);
+  free(gnum);
+  free(gbdry);
+  free(freed);
+  free(eloc);
+  free(fel_order);
+  free(flist);
+  free(fel);
+  free(fflip);
+
+  return;
+}
+
 /*!
 * \fn struct coordinates *allocatecoords(INT ndof,INT mydim)
 *
@@ -429,6 +947,9 @@ void free_mesh(mesh_struct* mesh)
 {
   if(mesh==NULL) return;
 
+  // Arrays in a mapped binary mesh file are not freed
+  if(mesh->map) release_mesh_map(mesh,0);
+
   if (mesh->cv){
     free_coords(mesh->cv);
     free(mesh->cv);
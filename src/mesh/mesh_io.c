@@ -10,6 +10,8 @@
  */
 
 #include "hazmath.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 /******************************************************************************/
 /*!
@@ -136,6 +138,90 @@ void read_grid_haz(FILE *gfid,mesh_struct *mesh)
 }
 /******************************************************************************/
 
+/******************************************************************************/
+/*
+ * Finds the DataArray with the given Name (or the first one in <Points> if
+ * name is NULL) in the vtu file contents buf and returns the text after its
+ * opening tag, or NULL if there is no such array.  Only ascii arrays are
+ * supported.
+ */
+static char *vtu_data_array(char *buf,const char *name)
+{
+  char key[128];
+  char *tag,*end;
+  INT found,ascii;
+  if(name) {
+    snprintf(key,128,"Name=\"%s\"",name);
+    tag=buf;
+  } else {
+    tag=strstr(buf,"<Points");
+    if(tag==NULL) return NULL;
+  }
+  while((tag=strstr(tag,"<DataArray"))!=NULL) {
+    end=strchr(tag,'>');
+    if(end==NULL) return NULL;
+    *end='\0';
+    found=(name==NULL || strstr(tag,key)!=NULL);
+    ascii=(strstr(tag,"\"ascii\"")!=NULL);
+    *end='>';
+    if(found) {
+      if(!ascii) {
+        fprintf(stderr,"Only ascii DataArrays can be read from vtu files\n");
+        check_error(ERROR_WRONG_FILE,__FUNCTION__);
+      }
+      return end+1;
+    }
+    tag=end+1;
+  }
+  return NULL;
+}
+
+/*
+ * Reads n integers from the vtu DataArray with the given Name.  Returns 0
+ * if there is no such array, which is an error if required is nonzero.
+ */
+static INT vtu_read_int(char *buf,const char *name,INT n,INT *a,INT required)
+{
+  INT i;
+  char *s=vtu_data_array(buf,name),*e;
+  if(s==NULL) {
+    if(!required) return 0;
+    fprintf(stderr,"No DataArray \"%s\" in vtu file\n",name);
+    check_error(ERROR_WRONG_FILE,__FUNCTION__);
+  }
+  for(i=0;i<n;i++) {
+    a[i]=(INT )strtol(s,&e,10);
+    if(e==s) {
+      fprintf(stderr,"DataArray \"%s\" in vtu file is too short\n",name);
+      check_error(ERROR_WRONG_FILE,__FUNCTION__);
+    }
+    s=e;
+  }
+  return 1;
+}
+
+/*
+ * Reads n reals from the vtu DataArray with the given Name (the points if
+ * name is NULL).
+ */
+static void vtu_read_real(char *buf,const char *name,INT n,REAL *a)
+{
+  INT i;
+  char *s=vtu_data_array(buf,name),*e;
+  if(s==NULL) {
+    fprintf(stderr,"No DataArray \"%s\" in vtu file\n",name?name:"Points");
+    check_error(ERROR_WRONG_FILE,__FUNCTION__);
+  }
+  for(i=0;i<n;i++) {
+    a[i]=strtod(s,&e);
+    if(e==s) {
+      fprintf(stderr,"DataArray \"%s\" in vtu file is too short\n",name?name:"Points");
+      check_error(ERROR_WRONG_FILE,__FUNCTION__);
+    }
+    s=e;
+  }
+  return;
+}
 /******************************************************************************/
 /*!
  * \fn void read_grid_vtk(FILE *gfid,mesh_struct *mesh)
@@ -192,11 +278,117 @@ void read_grid_haz(FILE *gfid,mesh_struct *mesh)
  * \return mesh.cv         Coordinates of mesh vertices
  * \return mesh.el_v       Element to vertex map
  *
+ * \note Reads files in the ascii format written by dump_mesh_vtk(), with
+ *       lines, triangles or tetrahedra.  The flags of the elements are read
+ *       from a DataArray named "el_flag" if there is one.
+ *
  */
 void read_grid_vtk(FILE *gfid,mesh_struct *mesh)
 {
-  fprintf(stderr,"I don't really want to process this vtk file just yet...Come back later...\n\n");
-  exit(ERROR_OPEN_FILE);
+  // Loop indices
+  INT i,k;
+
+  // Read the whole file
+  fseek(gfid,0,SEEK_END);
+  long size = ftell(gfid);
+  rewind(gfid);
+  char* buf = (char *) malloc(size+1);
+  size = (long) fread(buf,1,size,gfid);
+  buf[size] = '\0';
+
+  // Get basic data
+  INT nv=-1,nelm=-1;
+  char* piece = strstr(buf,"<Piece");
+  char* s;
+  if(piece) {
+    s = strstr(piece,"NumberOfPoints=\"");
+    if(s) nv = (INT) strtol(s+16,NULL,10);
+    s = strstr(piece,"NumberOfCells=\"");
+    if(s) nelm = (INT) strtol(s+15,NULL,10);
+  }
+  if(nv<0 || nelm<0) {
+    fprintf(stderr,"No <Piece NumberOfPoints=.. NumberOfCells=..> in vtu file\n");
+    check_error(ERROR_WRONG_FILE, __FUNCTION__);
+  }
+
+  // Get dimension from the cell types (all must be the same)
+  INT* types = (INT *) calloc(nelm+1,sizeof(INT));
+  vtu_read_int(buf,"types",nelm,types,1);
+  INT dim = 0;
+  if(nelm>0) {
+    if(types[0]==3) dim=1;
+    else if(types[0]==5) dim=2;
+    else if(types[0]==10) dim=3;
+  }
+  for(i=0;i<nelm;i++) if(types[i]!=types[0]) dim=0;
+  free(types);
+  if(dim==0) {
+    fprintf(stderr,"Vtu file must contain only lines, only triangles or only tetrahedra\n");
+    check_error(ERROR_WRONG_FILE, __FUNCTION__);
+  }
+  INT v_per_elm = dim+1;
+
+  // Element-Vertex Map
+  mesh->el_v=malloc(sizeof(iCSRmat));
+  mesh->el_v->row=nelm;
+  mesh->el_v->col=nv;
+  mesh->el_v->nnz=nelm*v_per_elm;
+  mesh->el_v->IA = (INT *)calloc(nelm+1, sizeof(INT));
+  mesh->el_v->JA = (INT *)calloc(mesh->el_v->nnz, sizeof(INT));
+  mesh->el_v->val=NULL;
+  vtu_read_int(buf,"offsets",nelm,mesh->el_v->IA+1,1);
+  for(i=0;i<nelm+1;i++) {
+    if(mesh->el_v->IA[i]!=v_per_elm*i) {
+      fprintf(stderr,"Wrong offsets in vtu file\n");
+      check_error(ERROR_WRONG_FILE, __FUNCTION__);
+    }
+  }
+  vtu_read_int(buf,"connectivity",mesh->el_v->nnz,mesh->el_v->JA,1);
+
+  // Flags for each element (zero if not in the file)
+  mesh->el_flag = (INT *) calloc(nelm,sizeof(INT));
+  vtu_read_int(buf,"el_flag",nelm,mesh->el_flag,0);
+
+  // Coordinates (always three components in the file)
+  mesh->cv = allocatecoords(nv,dim);
+  REAL* xyz = (REAL *) calloc(3*nv+1,sizeof(REAL));
+  vtu_read_real(buf,NULL,3*nv,xyz);
+  for(k=0;k<dim;k++)
+    for(i=0;i<nv;i++) mesh->cv->x[k*nv+i] = xyz[3*i+k];
+  free(xyz);
+
+  // Boundary flags (zero if not in the file)
+  INT nbv = 0;
+  mesh->v_flag = (INT *) calloc(nv,sizeof(INT));
+  vtu_read_int(buf,"v_flag",nv,mesh->v_flag,0);
+  for(i=0;i<nv;i++) {
+    if(mesh->v_flag[i]>0) {
+      nbv++;
+    }
+  }
+
+  // Connected components: positive in the interior, negative on the
+  // boundaries (see dump_mesh_vtk())
+  INT nconn_reg = 1;
+  INT nconn_bdry = 1;
+  INT* comp = (INT *) calloc(nv+1,sizeof(INT));
+  if(vtu_read_int(buf,"connectedcomponents",nv,comp,0)) {
+    for(i=0;i<nv;i++) {
+      if(comp[i]>nconn_reg) nconn_reg = comp[i];
+      if(-comp[i]>nconn_bdry) nconn_bdry = -comp[i];
+    }
+  }
+  free(comp);
+  free(buf);
+
+  // Update mesh with known quantities
+  mesh->dim = dim;
+  mesh->nelm = nelm;
+  mesh->nv = nv;
+  mesh->nbv = nbv;
+  mesh->nconn_reg = nconn_reg;
+  mesh->nconn_bdry = nconn_bdry;
+  mesh->v_per_elm = v_per_elm;
 
   return;
 }
@@ -344,6 +536,11 @@ void dump_mesh_haz(char *namehaz,mesh_struct *mesh)
  *        -1  -1  -1  -1  1  -1  -1  -1  -1
  *        </DataArray>
  *        </PointData>
+ *        <CellData Scalars="scalars">
+ *        <DataArray type="Int64" Name="el_flag" Format="ascii">
+ *        0  0  0  0  0  0  0  0
+ *        </DataArray>
+ *        </CellData>
  *        <Cells>
  *        <DataArray type="Int64" Name="offsets" Format="ascii">
  *        3  6  9  12  15  18  21  24
@@ -364,6 +561,9 @@ void dump_mesh_haz(char *namehaz,mesh_struct *mesh)
  *
  * \return namevtk.vtu     File with mesh data.
  *
+ * \note The data is written as ascii (as above) or binary, see
+ *       set_vtu_format().
+ *
  */
 void dump_mesh_vtk(char *namevtk,mesh_struct *mesh)
 {
@@ -371,94 +571,19 @@ void dump_mesh_vtk(char *namevtk,mesh_struct *mesh)
   INT nv = mesh->nv;
   INT nelm = mesh->nelm;
   INT dim = mesh->dim;
-  INT v_per_elm = mesh->v_per_elm;
-
-  // VTK needed Quantities
-  INT tcell=-10;
-  INT k=-10,j=-10,kndl=-10;
-  char *tfloat="Float64", *tinto="Int64", *endian="LittleEndian";
-
-  /*
-     What endian?:
-
-     Intel x86; OS=MAC OS X: little-endian
-     Intel x86; OS=Windows: little-endian
-     Intel x86; OS=Linux: little-endian
-     Intel x86; OS=Solaris: little-endian
-     Dec Alpha; OS=Digital Unix: little-endian
-     Dec Alpha; OS=VMS: little-endian
-     Hewlett Packard PA-RISC; OS=HP-UX: big-endian
-     IBM RS/6000; OS=AIX: big-endian
-     Motorola PowerPC; OS=Mac OS X:  big-endian
-     SGI R4000 and up; OS=IRIX: big-endian
-     Sun SPARC; OS=Solaris: big-endian
-  */
-
-  /*
-     Types of cells for VTK
-
-     VTK_VERTEX (=1)
-     VTK_POLY_VERTEX (=2)
-     VTK_LINE (=3)
-     VTK_POLY_LINE (=4)
-     VTK_TRIANGLE(=5)
-     VTK_TRIANGLE_STRIP (=6)
-     VTK_POLYGON (=7)
-     VTK_PIXEL (=8)
-     VTK_QUAD (=9)
-     VTK_TETRA (=10)
-     VTK_VOXEL (=11)
-     VTK_HEXAHEDRON (=12)
-     VTK_WEDGE (=13)
-     VTK_PYRAMID (=14)
-  */
-  const INT LINE=3;
-  const INT TRI=5;
-  const INT TET=10;
-
-  if(dim==1) /* Line */
-    tcell=LINE;
-  else if(dim==2)
-    tcell=TRI; /* triangle */
-  else
-    tcell=TET; /* tet */
+  REAL* xyz[3] = {mesh->cv->x,mesh->cv->y,mesh->cv->z};
 
-  // Open File for Writing
-  FILE* fvtk = HAZ_fopen(namevtk,"w");
-
-  // Write Headers
-  fprintf(fvtk, \
-          "<VTKFile type=\"UnstructuredGrid\" version=\"0.1\" byte_order=\"%s\">\n", \
-          endian);
-  fprintf(fvtk,"<UnstructuredGrid>\n");
-  fprintf(fvtk,"<Piece NumberOfPoints=\"%i\" NumberOfCells=\"%i\">\n",nv,nelm);
-  fprintf(fvtk,"<Points>\n");
-  fprintf(fvtk,"<DataArray type=\"%s\" NumberOfComponents=\"3\" Format=\"ascii\">", \
-          tfloat);
+  // Open File for Writing (ascii or binary, see set_vtu_format())
+  vtu_file* vf = vtu_open(namevtk,nv,nelm);
 
   // Dump coordinates
-  if(dim == 1) {
-    for(k=0;k<nv;k++) {
-      fprintf(fvtk," %23.16e %23.16e %23.16e ",mesh->cv->x[k],0e0,0e0);
-    }
-  } else if(dim == 2) {
-    for(k=0;k<nv;k++) {
-      fprintf(fvtk," %23.16e %23.16e %23.16e ",mesh->cv->x[k],mesh->cv->y[k],0e0);
-    }
-  } else {
-    for(k=0;k<nv;k++) {
-      fprintf(fvtk," %23.16e %23.16e %23.16e ",mesh->cv->x[k],mesh->cv->y[k], \
-              mesh->cv->z[k]);
-    }
-  }
-  fprintf(fvtk,"</DataArray>\n");
-  fprintf(fvtk,"</Points>\n");
+  fprintf(vf->fp,"<Points>\n");
+  vtu_array_real(vf,NULL,nv,3,xyz,1);
+  fprintf(vf->fp,"</Points>\n");
 
   // Dump v_flag Data to indicate if vertices are boundaries
-  fprintf(fvtk,"<PointData Scalars=\"scalars\">\n");
-  fprintf(fvtk,"<DataArray type=\"%s\" Name=\"v_flag\" Format=\"ascii\">",tinto);
-  for(k=0;k<nv;k++) fprintf(fvtk," %i ",mesh->v_flag[k]);
-  fprintf(fvtk,"</DataArray>\n");
+  fprintf(vf->fp,"<PointData Scalars=\"scalars\">\n");
+  vtu_array_int(vf,"v_flag",nv,mesh->v_flag,1,0);
 
   // Dump information about connected components.
   // Positive integers indicate connected components of a domain
@@ -470,37 +595,379 @@ void dump_mesh_vtk(char *namevtk,mesh_struct *mesh)
   //          -1 on points on the outer boundary and -2 on the inner boundary
   // If NULL, then one connected region and boundary.
   if(mesh->v_component) {
-    fprintf(fvtk,"<DataArray type=\"%s\" Name=\"connectedcomponents\" Format=\"ascii\">",tinto);
-    for(k=0;k<nv;k++) fprintf(fvtk," %i ",mesh->v_component[k]);
-    fprintf(fvtk,"</DataArray>\n");
-  }
-  fprintf(fvtk,"</PointData>\n");
-
-  // Dump el_v map
-  fprintf(fvtk,"<Cells>\n");
-  fprintf(fvtk,"<DataArray type=\"%s\" Name=\"offsets\" Format=\"ascii\">",tinto);
-  for(k=1;k<=nelm;k++) fprintf(fvtk," %i ",mesh->el_v->IA[k]);
-  fprintf(fvtk,"</DataArray>\n");
-  fprintf(fvtk,"<DataArray type=\"%s\" Name=\"connectivity\" Format=\"ascii\">\n",tinto);
-  for(k=0;k<nelm;k++){
-    kndl=k*v_per_elm;
-    for(j=0;j<v_per_elm;j++) fprintf(fvtk," %i ",mesh->el_v->JA[kndl + j]);
-  }
-  fprintf(fvtk,"</DataArray>\n");
-
-  // Dump Element Type
-  fprintf(fvtk,"<DataArray type=\"%s\" Name=\"types\" Format=\"ascii\">",tinto);
-  for(k=1;k<=nelm;k++)
-    fprintf(fvtk," %i ",tcell);
-
-  // Put in remaining headers
-  fprintf(fvtk,"</DataArray>\n");
-  fprintf(fvtk,"</Cells>\n");
-  fprintf(fvtk,"</Piece>\n");
-  fprintf(fvtk,"</UnstructuredGrid>\n");
-  fprintf(fvtk,"</VTKFile>\n");
-
-  fclose(fvtk);
+    vtu_array_int(vf,"connectedcomponents",nv,mesh->v_component,1,0);
+  }
+  fprintf(vf->fp,"</PointData>\n");
+
+  // Dump el_flag, so that read_grid_vtk() gets the flags of the elements back
+  if(mesh->el_flag) {
+    fprintf(vf->fp,"<CellData Scalars=\"scalars\">\n");
+    vtu_array_int(vf,"el_flag",nelm,mesh->el_flag,1,0);
+    fprintf(vf->fp,"</CellData>\n");
+  }
+
+  // Dump el_v map and element types
+  vtu_cells(vf,nelm,dim,mesh->el_v->JA,0);
+
+  vtu_close(vf);
+
+  return;
+}
+/******************************************************************************/
+
+/******************************************************************************/
+/*
+ * Writes nbytes of a to fp (zeros if a is NULL), after padding the file with
+ * zeros from *pos up to the byte offset off.
+ */
+static void meshbin_write(FILE *fp,long long *pos,long long off,const void *a,size_t nbytes)
+{
+  static const char zeros[MESHBIN_ALIGN]={0};
+  size_t m,w=0;
+  while(*pos<off) {
+    m=(size_t )(off-*pos);
+    if(m>MESHBIN_ALIGN) m=MESHBIN_ALIGN;
+    if(fwrite(zeros,1,m,fp)!=m) check_error(ERROR_OPEN_FILE,__FUNCTION__);
+    *pos+=m;
+  }
+  if(a) {
+    w=fwrite(a,1,nbytes,fp);
+  } else {
+    while(w<nbytes) {
+      m=nbytes-w;
+      if(m>MESHBIN_ALIGN) m=MESHBIN_ALIGN;
+      if(fwrite(zeros,1,m,fp)!=m) break;
+      w+=m;
+    }
+  }
+  if(w!=nbytes) check_error(ERROR_OPEN_FILE,__FUNCTION__);
+  *pos+=nbytes;
+  return;
+}
+
+/* Rounds a byte offset up to a multiple of MESHBIN_ALIGN */
+static long long meshbin_align(long long off)
+{
+  return ((off+MESHBIN_ALIGN-1)/MESHBIN_ALIGN)*MESHBIN_ALIGN;
+}
+
+/******************************************************************************/
+/*!
+ * \fn void dump_mesh_bin(char *namebin,mesh_struct *mesh)
+ *
+ * \brief Dumps mesh data to the binary format read by read_grid_bin():
+ *
+ *        Header:    struct meshbin_header (sizes and byte offsets of the rest)
+ *        el_v:      nelm*(dim+1) INT, the vertices of each element (from 0)
+ *        el_flag:   nelm INT
+ *        coords:    dim*nv REAL, x of all vertices, then y, then z
+ *        v_flag:    nv INT
+ *
+ *        Every section starts at a multiple of MESHBIN_ALIGN bytes.
+ *
+ * \param namebin          Output file name
+ * \param mesh             Pointer to mesh struct
+ *
+ * \return namebin         File with mesh data.
+ *
+ * \note The data is written as it is in memory, so the file can only be read
+ *       on machines with the same byte order and sizes of INT and REAL
+ *       (which read_grid_bin() checks).  Missing flags are written as zeros.
+ *
+ */
+void dump_mesh_bin(char *namebin,mesh_struct *mesh)
+{
+  // Basic Quantities
+  INT i;
+  INT nv = mesh->nv;
+  INT nelm = mesh->nelm;
+  INT dim = mesh->dim;
+  INT v_per_elm = dim+1;
+  long long pos=0;
+
+  // Elements are written with a fixed number of vertices
+  for(i=0;i<=nelm;i++) {
+    if(mesh->el_v->IA[i]!=v_per_elm*i) {
+      fprintf(stderr,"Binary mesh format needs %d vertices in every element\n",v_per_elm);
+      check_error(ERROR_DATA_STRUCTURE,__FUNCTION__);
+    }
+  }
+
+  // Header
+  meshbin_header head;
+  memset(&head,0,sizeof(meshbin_header));
+  strncpy(head.magic,MESHBIN_MAGIC,sizeof(head.magic));
+  head.version = MESHBIN_VERSION;
+  head.byte_order = 1;
+  head.int_size = (INT ) sizeof(INT);
+  head.real_size = (INT ) sizeof(REAL);
+  head.dim = dim;
+  head.nelm = nelm;
+  head.nv = nv;
+  head.v_per_elm = v_per_elm;
+  head.nbv = mesh->nbv;
+  head.nconn_reg = mesh->nconn_reg;
+  head.nconn_bdry = mesh->nconn_bdry;
+  head.off_el_v = meshbin_align((long long ) sizeof(meshbin_header));
+  head.off_el_flag = meshbin_align(head.off_el_v+(long long ) nelm*v_per_elm*sizeof(INT));
+  head.off_cv = meshbin_align(head.off_el_flag+(long long ) nelm*sizeof(INT));
+  head.off_v_flag = meshbin_align(head.off_cv+(long long ) dim*nv*sizeof(REAL));
+
+  // Open File for Writing
+  FILE* fbin = HAZ_fopen(namebin,"wb");
+
+  meshbin_write(fbin,&pos,0,&head,sizeof(meshbin_header));
+  meshbin_write(fbin,&pos,head.off_el_v,mesh->el_v->JA,(size_t ) nelm*v_per_elm*sizeof(INT));
+  meshbin_write(fbin,&pos,head.off_el_flag,mesh->el_flag,(size_t ) nelm*sizeof(INT));
+  meshbin_write(fbin,&pos,head.off_cv,mesh->cv->x,(size_t ) nv*sizeof(REAL));
+  if(dim>1) meshbin_write(fbin,&pos,pos,mesh->cv->y,(size_t ) nv*sizeof(REAL));
+  if(dim>2) meshbin_write(fbin,&pos,pos,mesh->cv->z,(size_t ) nv*sizeof(REAL));
+  meshbin_write(fbin,&pos,head.off_v_flag,mesh->v_flag,(size_t ) nv*sizeof(INT));
+
+  fclose(fbin);
+
+  return;
+}
+/******************************************************************************/
+
+/******************************************************************************/
+/*!
+ * \fn void *map_mesh_bin(FILE *gfid,meshbin_header *head,size_t *len)
+ *
+ * \brief Maps a binary mesh file (see dump_mesh_bin()) into memory and checks
+ *        its header.
+ *
+ * \param gfid             Grid FILE ID.
+ *
+ * \return head            Header of the file
+ * \return len             Length of the mapping in bytes
+ * \return                 Start of the mapping: the sections of the file are
+ *                         at the byte offsets given in head.
+ *
+ * \note The mapping is private and writable: changes to the data are not
+ *       written to the file, and only the pages which are changed are
+ *       copied.  It stays valid after gfid is closed and is removed with
+ *       munmap().
+ *
+ */
+void *map_mesh_bin(FILE *gfid,meshbin_header *head,size_t *len)
+{
+  struct stat st;
+  INT fd = fileno(gfid);
+  if(fstat(fd,&st) || st.st_size<(off_t ) sizeof(meshbin_header)) {
+    fprintf(stderr,"Binary mesh file is too short\n");
+    check_error(ERROR_WRONG_FILE,__FUNCTION__);
+  }
+  *len = (size_t ) st.st_size;
+  void *map = mmap(NULL,*len,PROT_READ|PROT_WRITE,MAP_PRIVATE,fd,0);
+  if(map==MAP_FAILED) {
+    fprintf(stderr,"Cannot map binary mesh file\n");
+    check_error(ERROR_OPEN_FILE,__FUNCTION__);
+  }
+  memcpy(head,map,sizeof(meshbin_header));
+
+  // Check that the file was written by dump_mesh_bin() on a similar machine
+  long long size = (long long ) *len;
+  long long nelm = head->nelm, nv = head->nv;
+  INT ok = (strncmp(head->magic,MESHBIN_MAGIC,sizeof(head->magic))==0);
+  if(!ok) fprintf(stderr,"Not a binary mesh file\n");
+  if(ok && (head->version<1 || head->version>MESHBIN_VERSION)) {
+    fprintf(stderr,"Binary mesh file has version %d; only %d or earlier can be read\n", \
+            head->version,MESHBIN_VERSION);
+    ok = 0;
+  }
+  if(ok && (head->byte_order!=1 || head->int_size!=(INT ) sizeof(INT) || \
+            head->real_size!=(INT ) sizeof(REAL))) {
+    fprintf(stderr,"Binary mesh file was written with a different byte order or INT/REAL size\n");
+    ok = 0;
+  }
+  if(ok) {
+    ok = (head->dim>=1 && head->dim<=3 && head->v_per_elm==head->dim+1 && \
+          nelm>=0 && nv>=0 &&                                             \
+          head->off_el_v>=(long long ) sizeof(meshbin_header) &&          \
+          head->off_el_v+nelm*head->v_per_elm*(long long ) sizeof(INT)<=size && \
+          head->off_el_flag>=0 &&                                         \
+          head->off_el_flag+nelm*(long long ) sizeof(INT)<=size &&        \
+          head->off_cv>=0 &&                                              \
+          head->off_cv+head->dim*nv*(long long ) sizeof(REAL)<=size &&    \
+          head->off_v_flag>=0 &&                                          \
+          head->off_v_flag+nv*(long long ) sizeof(INT)<=size &&           \
+          head->off_el_v%MESHBIN_ALIGN==0 && head->off_el_flag%MESHBIN_ALIGN==0 && \
+          head->off_cv%MESHBIN_ALIGN==0 && head->off_v_flag%MESHBIN_ALIGN==0);
+    if(!ok) fprintf(stderr,"Binary mesh file has wrong sizes or offsets\n");
+  }
+  if(!ok) {
+    munmap(map,*len);
+    check_error(ERROR_WRONG_FILE,__FUNCTION__);
+  }
+  return map;
+}
+/******************************************************************************/
+
+/******************************************************************************/
+/*!
+ * \fn void read_grid_bin(FILE *gfid,mesh_struct *mesh)
+ *
+ * \brief Reads in gridfile in the binary format written by dump_mesh_bin().
+ *        The file is mapped into memory and the arrays of the mesh point into
+ *        the mapping, so nothing is read until it is used.
+ *
+ * \param gfid             Grid FILE ID.
+ * \param mesh             Pointer to mesh struct
+ *
+ * \return mesh.dim        Dimension of problem
+ * \return mesh.nelm       Number of elements in mesh
+ * \return mesh.nvert      Number of vertices in mesh
+ * \return mesh.nbvert     Number of boundary vertices in mesh
+ * \return mesh.v_per_elm  Number of vertices per element
+ * \return mesh.cv         Coordinates of mesh vertices
+ * \return mesh.el_v       Element to vertex map
+ * \return mesh.map        Start of the mapping, mesh.map_len its length
+ *
+ * \note el_v->JA, cv->x (and y, z), el_flag and v_flag are in the mapping;
+ *       only el_v->IA is allocated.  They may be changed in place, but not
+ *       freed or reallocated: free_mesh() unmaps them, and
+ *       release_mesh_map() copies them to allocated memory.
+ *
+ */
+void read_grid_bin(FILE *gfid,mesh_struct *mesh)
+{
+  // Loop indices
+  INT i;
+
+  meshbin_header head;
+  size_t len;
+  char* map = (char *) map_mesh_bin(gfid,&head,&len);
+
+  // Get basic data
+  INT nelm = head.nelm;
+  INT nv = head.nv;
+  INT dim = head.dim;
+  INT v_per_elm = head.v_per_elm;
+
+  // Element-Vertex Map
+  mesh->el_v=malloc(sizeof(iCSRmat));
+  mesh->el_v->row=nelm;
+  mesh->el_v->col=nv;
+  mesh->el_v->nnz=nelm*v_per_elm;
+  mesh->el_v->IA = (INT *)calloc(nelm+1, sizeof(INT));
+  for(i=0;i<nelm+1;i++) {
+    mesh->el_v->IA[i] = v_per_elm*i;
+  }
+  mesh->el_v->JA = (INT *) (map+head.off_el_v);
+  mesh->el_v->val=NULL;
+
+  // Flags, coordinates (as in allocatecoords()) and boundary flags
+  mesh->el_flag = (INT *) (map+head.off_el_flag);
+  mesh->cv = (coordinates *) malloc(sizeof(coordinates));
+  mesh->cv->n = nv;
+  mesh->cv->x = (REAL *) (map+head.off_cv);
+  mesh->cv->y = (dim>1) ? mesh->cv->x+nv : NULL;
+  mesh->cv->z = (dim>2) ? mesh->cv->x+2*nv : NULL;
+  mesh->v_flag = (INT *) (map+head.off_v_flag);
+
+  // Update mesh with known quantities
+  mesh->dim = dim;
+  mesh->nelm = nelm;
+  mesh->nv = nv;
+  mesh->nbv = head.nbv;
+  mesh->nconn_reg = head.nconn_reg;
+  mesh->nconn_bdry = head.nconn_bdry;
+  mesh->v_per_elm = v_per_elm;
+  mesh->map = map;
+  mesh->map_len = len;
+
+  return;
+}
+/******************************************************************************/
+
+/*
+ * Returns p if it does not point into the mapping of the mesh; otherwise
+ * returns a copy of its nbytes in allocated memory if copy is nonzero, and
+ * NULL if copy is zero.
+ */
+static void *unmap_array(mesh_struct *mesh,void *p,size_t nbytes,INT copy)
+{
+  char *lo = (char *) mesh->map;
+  if(p==NULL || (char *) p<lo || (char *) p>=lo+mesh->map_len) return p;
+  if(!copy) return NULL;
+  void *q = malloc(nbytes+1);
+  memcpy(q,p,nbytes);
+  return q;
+}
+
+/******************************************************************************/
+/*!
+ * \fn void release_mesh_map(mesh_struct *mesh,INT copy)
+ *
+ * \brief Removes the mapping of a mesh read by read_grid_bin().
+ *
+ * \param mesh             Pointer to mesh struct
+ * \param copy             If nonzero, the arrays of the mesh which are in the
+ *                         mapping are copied to allocated memory, and the mesh
+ *                         can be used and changed as any other mesh; if zero
+ *                         they are set to NULL (as in free_mesh()).
+ *
+ */
+void release_mesh_map(mesh_struct *mesh,INT copy)
+{
+  if(mesh==NULL || mesh->map==NULL) return;
+
+  INT nv = mesh->nv;
+  INT nelm = mesh->nelm;
+
+  if(mesh->el_v) {
+    mesh->el_v->JA = (INT *) unmap_array(mesh,mesh->el_v->JA, \
+                                         (size_t ) mesh->el_v->nnz*sizeof(INT),copy);
+  }
+  mesh->el_flag = (INT *) unmap_array(mesh,mesh->el_flag,(size_t ) nelm*sizeof(INT),copy);
+  mesh->v_flag = (INT *) unmap_array(mesh,mesh->v_flag,(size_t ) nv*sizeof(INT),copy);
+  if(mesh->cv) {
+    mesh->cv->x = (REAL *) unmap_array(mesh,mesh->cv->x, \
+                                       (size_t ) mesh->dim*nv*sizeof(REAL),copy);
+    mesh->cv->y = (mesh->cv->x && mesh->dim>1) ? mesh->cv->x+nv : NULL;
+    mesh->cv->z = (mesh->cv->x && mesh->dim>2) ? mesh->cv->x+2*nv : NULL;
+  }
+
+  munmap(mesh->map,mesh->map_len);
+  mesh->map = NULL;
+  mesh->map_len = 0;
+
+  return;
+}
+/******************************************************************************/
+
+/******************************************************************************/
+/*!
+ * \fn void convert_mesh_bin(char *namein,INT file_type,char *namebin)
+ *
+ * \brief Converts a mesh file to the binary format (see dump_mesh_bin()).
+ *
+ * \param namein           Input file name
+ * \param file_type        Type of input file: 0 - haz format; 1 - vtk format
+ * \param namebin          Output file name
+ *
+ * \return namebin         File with mesh data.
+ *
+ */
+void convert_mesh_bin(char *namein,INT file_type,char *namebin)
+{
+  mesh_struct mesh;
+  initialize_mesh(&mesh);
+
+  FILE* fin = HAZ_fopen(namein,"r");
+  if(file_type==0) {
+    read_grid_haz(fin,&mesh);
+  } else if(file_type==1) {
+    read_grid_vtk(fin,&mesh);
+  } else {
+    fclose(fin);
+    check_error(ERROR_INPUT_PAR,__FUNCTION__);
+  }
+  fclose(fin);
+
+  dump_mesh_bin(namebin,&mesh);
+  free_mesh(&mesh);
 
   return;
 }
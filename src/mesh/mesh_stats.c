@@ -11,6 +11,161 @@
 
 #include "hazmath.h"
 
+/*******************************************************************************/
+/* 64-bit hash of a (sorted) tuple of k vertex numbers */
+static unsigned long long tuple_hash(INT k,const INT *t)
+{
+  INT i;
+  unsigned long long h=0x9e3779b97f4a7c15ULL;
+  for(i=0;i<k;i++){
+    h ^= (unsigned long long )((unsigned INT )t[i]);
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h>>31;
+  }
+  return h;
+}
+/*******************************************************************************/
+
+/*******************************************************************************/
+/*!
+ * \fn INT hash_match_tuples(INT m,INT k,INT *tup,INT *id,INT *first)
+ *
+ * \brief Numbers the distinct tuples in a list of m tuples of k integers
+ *        (e.g. the sorted vertices of the faces or edges of all elements),
+ *        in expected linear time using a hash table.
+ *
+ * \param m        Number of tuples
+ * \param k        Length of each tuple
+ * \param tup      Tuples (m*k); equal tuples must have their entries in the same order
+ *
+ * \return id      Number of each tuple; distinct tuples are numbered in the
+ *                 order of their first appearance in tup
+ * \return first   Index of the first tuple equal to each tuple (may be NULL)
+ * \return         Number of distinct tuples
+ *
+ * \note With OpenMP the tuples are split by hash value into partitions that
+ *       are matched independently by different threads; the result does
+ *       not depend on the number of threads.
+ *
+ */
+INT hash_match_tuples(INT m,INT k,INT *tup,INT *id,INT *first)
+{
+  INT i,p,nent=0,nparts=1;
+  unsigned long long *h=(unsigned long long *)calloc(m+1,sizeof(unsigned long long));
+  INT *fst = first ? first : (INT *)calloc(m+1,sizeof(INT));
+
+#ifdef _OPENMP
+  // Fixed number of partitions, so that each is matched in one piece
+  if(m>4096) nparts = 64;
+#endif
+
+#ifdef _OPENMP
+#pragma omp parallel for if(m>4096)
+#endif
+  for(i=0;i<m;i++) h[i] = tuple_hash(k,tup+i*k);
+
+  // Bucket the tuples by partition, keeping their order
+  INT *pia=(INT *)calloc(nparts+1,sizeof(INT));
+  INT *pja=(INT *)calloc(m+1,sizeof(INT));
+  for(i=0;i<m;i++) pia[(h[i]>>40)%nparts+1]++;
+  for(p=0;p<nparts;p++) pia[p+1] += pia[p];
+  for(i=0;i<m;i++) pja[pia[(h[i]>>40)%nparts]++] = i;
+  for(p=nparts;p>0;p--) pia[p] = pia[p-1];
+  pia[0] = 0;
+
+#ifdef _OPENMP
+#pragma omp parallel for private(i) schedule(dynamic,1) if(nparts>1)
+#endif
+  for(p=0;p<nparts;p++) {
+    INT j,jp,slot,tsize=2;
+    while(tsize<2*(pia[p+1]-pia[p])) tsize *= 2;
+    INT *table=(INT *)malloc(tsize*sizeof(INT));
+    for(slot=0;slot<tsize;slot++) table[slot] = -1;
+    for(jp=pia[p];jp<pia[p+1];jp++) {
+      i = pja[jp];
+      slot = (INT )(h[i] & (unsigned long long )(tsize-1));
+      while(1) {
+        j = table[slot];
+        if(j<0) {
+          table[slot] = i;
+          fst[i] = i;
+          break;
+        }
+        if(h[j]==h[i] && !memcmp(tup+j*k,tup+i*k,k*sizeof(INT))) {
+          fst[i] = j;
+          break;
+        }
+        slot = (slot+1) & (tsize-1);
+      }
+    }
+    free(table);
+  }
+
+  // Number in the order of first appearance
+  for(i=0;i<m;i++) {
+    if(fst[i]==i) {
+      id[i] = nent++;
+    } else {
+      id[i] = id[fst[i]];
+    }
+  }
+
+  free(pia);
+  free(pja);
+  free(h);
+  if(!first) free(fst);
+  return nent;
+}
+/*******************************************************************************/
+
+/*******************************************************************************/
+/*!
+ * \fn INT simplex_match_entities(INT ns,INT nvs,INT *sv,INT nloc,INT k,INT *loc,INT *id,INT *first)
+ *
+ * \brief Finds the distinct sub-entities (faces, edges, ...) of a list of
+ *        simplices, matching them by their sorted vertex tuples.
+ *
+ * \param ns       Number of simplices
+ * \param nvs      Number of vertices of each simplex
+ * \param sv       Vertices of the simplices (ns*nvs)
+ * \param nloc     Number of sub-entities of each simplex
+ * \param k        Number of vertices of each sub-entity
+ * \param loc      Local vertices of each sub-entity (nloc*k, indices in 0..nvs-1)
+ *
+ * \return id      Number of sub-entity l of simplex s in id[s*nloc+l]; the
+ *                 sub-entities are numbered in the order of first appearance
+ * \return first   First occurrence s*nloc+l of each sub-entity occurrence (may be NULL)
+ * \return         Number of distinct sub-entities
+ *
+ */
+INT simplex_match_entities(INT ns,INT nvs,INT *sv,INT nloc,INT k,INT *loc,INT *id,INT *first)
+{
+  INT s,l,i,j,t,nent;
+  INT m = ns*nloc;
+  INT *tup=(INT *)calloc(m*k+1,sizeof(INT));
+  INT *tl;
+
+#ifdef _OPENMP
+#pragma omp parallel for private(l,i,j,t,tl) if(ns>1024)
+#endif
+  for(s=0;s<ns;s++) {
+    for(l=0;l<nloc;l++) {
+      tl = tup+(s*nloc+l)*k;
+      // insertion sort of the (few) vertices
+      for(i=0;i<k;i++) {
+        t = sv[s*nvs+loc[l*k+i]];
+        for(j=i;j>0 && tl[j-1]>t;j--) tl[j] = tl[j-1];
+        tl[j] = t;
+      }
+    }
+  }
+  nent = hash_match_tuples(m,k,tup,id,first);
+
+  free(tup);
+  return nent;
+}
+/*******************************************************************************/
+
 /******************************************************************************/
 /*!
  * \fn iCSRmat convert_elmnode(INT *element_vertex,INT nelm,INT nv,INT nve)
@@ -83,28 +238,69 @@ iCSRmat convert_elmnode(INT *element_vertex,INT nelm,INT nv,INT nve)
  *
  * \return ed_v:	  Edge to vertex map in CSR format.
  *
+ * \note The edges are matched by hashing their vertex pairs and are
+ *       numbered as the upper triangle of the vertex to vertex map.
+ *
  */
 iCSRmat get_edge_v(INT* nedge,iCSRmat* el_v)
 {
   INT nv = el_v->col;
-  INT i,j,col_b,col_e,icntr,jcntr; /* Loop indices and counters */
-
-  /* Get Transpose of el_v -> v_el */
-  iCSRmat v_el;
-  icsr_trans(el_v,&v_el);
-
-  /* Create Vertex to Vertex Map by v_el*el_v */
-  iCSRmat v_v;
-  icsr_mxm_symb(&v_el,el_v,&v_v);
-  INT* iv_v = v_v.IA;
-  INT* jv_v = v_v.JA;
-
-  // Get the number of edges.
-  // This is the number of nonzeroes in the upper triangular
-  // part of vertex-vertex map (not including diagonal).
-  INT ned = (INT) (v_v.nnz - v_v.row)/2;
+  INT nelm = el_v->row;
+  INT nve = (nelm>0) ? (el_v->IA[1]-el_v->IA[0]) : 0;
+  INT nloc = (nve*(nve-1))/2;
+  INT i,j,p,q,l,e,occ,icntr; /* Loop indices and counters */
+  INT *ev;
+
+  // The elements are matched as rows of a dense array
+  for(e=0;e<nelm;e++) {
+    if(el_v->IA[e+1]-el_v->IA[e]!=nve) check_error(ERROR_DATA_STRUCTURE,__FUNCTION__);
+  }
+
+  // Local edges (p,q), p<q, of an element
+  INT* loc = (INT *) calloc(2*nloc+1,sizeof(INT));
+  INT* lnum = (INT *) calloc(nve*nve+1,sizeof(INT));
+  l = 0;
+  for(p=0;p<nve;p++) {
+    for(q=p+1;q<nve;q++) {
+      loc[2*l] = p;
+      loc[2*l+1] = q;
+      lnum[p*nve+q] = lnum[q*nve+p] = l;
+      l++;
+    }
+  }
+
+  // Match the edges of all elements by their vertices
+  INT* id = (INT *) calloc(nelm*nloc+1,sizeof(INT));
+  INT* first = (INT *) calloc(nelm*nloc+1,sizeof(INT));
+  INT ned = simplex_match_entities(nelm,nve,el_v->JA+el_v->IA[0],nloc,2,loc,id,first);
   *nedge = ned;
 
+  // Order the edges as the upper triangle of the vertex-vertex map
+  // v_el*el_v: by lower vertex, and then by the first element containing
+  // the edge and the position of its higher vertex in that element.
+  INT* cnt = (INT *) calloc(nv+1,sizeof(INT));
+  INT* perm = (INT *) calloc(ned+1,sizeof(INT));
+  for(e=0;e<nelm;e++) {
+    ev = el_v->JA+el_v->IA[e];
+    for(p=0;p<nve;p++) {
+      for(q=p+1;q<nve;q++) {
+        occ = e*nloc+lnum[p*nve+q];
+        if(first[occ]==occ) cnt[MIN(ev[p],ev[q])+1]++;
+      }
+    }
+  }
+  for(i=0;i<nv;i++) cnt[i+1] += cnt[i];
+  for(e=0;e<nelm;e++) {
+    ev = el_v->JA+el_v->IA[e];
+    for(q=0;q<nve;q++) {
+      for(p=0;p<nve;p++) {
+        if(ev[p]>=ev[q]) continue;
+        occ = e*nloc+lnum[p*nve+q];
+        if(first[occ]==occ) perm[cnt[ev[p]]++] = occ;
+      }
+    }
+  }
+
   iCSRmat ed_v;
   if ( ned > 0 ) {
     ed_v.IA = (INT *)calloc(ned+1, sizeof(INT));
@@ -119,31 +315,25 @@ iCSRmat get_edge_v(INT* nedge,iCSRmat* el_v)
     ed_v.JA = NULL;
   }
 
-  // Now go through upper triangular (above diagonal) portion of node-node and
-  // count non-zeros.
-  // Each of these node-node connections are edges.  Upper so we don't count
-  // i->j and j->i as two separate edges, and no diagonal since i->i is not
-  // an edge.
-  jcntr = 0;
-  icntr = 0;
-  for(i=0;i<nv-1;i++) {
-    col_b = iv_v[i];
-    col_e = iv_v[i+1]-1;
-    for(j=col_b;j<=col_e;j++) {
-      if(jv_v[j]>i) {
-        ed_v.IA[icntr] = jcntr;
-        ed_v.JA[jcntr] = jv_v[j];
-        ed_v.JA[jcntr+1] = i;
-        jcntr=jcntr+2;
-        icntr++;
-      }
-    }
+  // Edge i->j with i<j is stored as (j,i)
+  for(icntr=0;icntr<ned;icntr++) {
+    occ = perm[icntr];
+    e = occ/nloc;
+    l = occ%nloc;
+    i = el_v->JA[el_v->IA[e]+loc[2*l]];
+    j = el_v->JA[el_v->IA[e]+loc[2*l+1]];
+    ed_v.IA[icntr] = 2*icntr;
+    ed_v.JA[2*icntr] = MAX(i,j);
+    ed_v.JA[2*icntr+1] = MIN(i,j);
   }
-  ed_v.IA[icntr] = jcntr;
-
-  /* Free Node Node */
-  icsr_free(&v_v);
-  icsr_free(&v_el);
+  if(ned>0) ed_v.IA[ned] = 2*ned;
+
+  free(loc);
+  free(lnum);
+  free(id);
+  free(first);
+  free(cnt);
+  free(perm);
   ed_v.val=NULL;
   ed_v.row = ned;
   ed_v.col = nv;
@@ -212,6 +402,67 @@ void boundary_f_ed(iCSRmat* f_ed,iCSRmat* ed_v,INT nedge, INT nface,INT *f_flag,
 }
 /*******************************************************************************/
 
+/*******************************************************************************/
+/* Edges of ns simplices (nvs vertices each, given in sv) looked up in ed_v.
+ * The edges of simplex s are written to sed[s*nloc..] in the order of
+ * icsr_mxm_symb_max(s_v,v_ed,.,2): by the position in the simplex of their
+ * first vertex, and then by edge number. */
+static void simplex_edges_lookup(INT ns,INT nvs,INT *sv,iCSRmat *ed_v,INT *sed)
+{
+  INT nedge = ed_v->row;
+  INT nloc = (nvs*(nvs-1))/2;
+  INT m = nedge+ns*nloc;
+  INT i,j,p,q,s,t,icntr,e1,e2;
+  INT *tup = (INT *) calloc(2*m+1,sizeof(INT));
+  INT *id = (INT *) calloc(m+1,sizeof(INT));
+  INT *ts;
+
+  // Edges of ed_v first, so that they keep their numbers
+  for(i=0;i<nedge;i++) {
+    e1 = ed_v->JA[ed_v->IA[i]];
+    e2 = ed_v->JA[ed_v->IA[i]+1];
+    tup[2*i] = MIN(e1,e2);
+    tup[2*i+1] = MAX(e1,e2);
+  }
+#ifdef _OPENMP
+#pragma omp parallel for private(p,q,e1,e2,icntr,ts) if(ns>1024)
+#endif
+  for(s=0;s<ns;s++) {
+    ts = tup+2*(nedge+s*nloc);
+    icntr = 0;
+    for(p=0;p<nvs;p++) {
+      for(q=p+1;q<nvs;q++) {
+        e1 = sv[s*nvs+p];
+        e2 = sv[s*nvs+q];
+        ts[2*icntr] = MIN(e1,e2);
+        ts[2*icntr+1] = MAX(e1,e2);
+        icntr++;
+      }
+    }
+  }
+  if(hash_match_tuples(m,2,tup,id,NULL)!=nedge) {
+    check_error(ERROR_DATA_STRUCTURE,__FUNCTION__);
+  }
+
+  // Sort the edges starting at each position by number
+  for(s=0;s<ns;s++) {
+    icntr = s*nloc;
+    for(p=0;p<nvs;p++) {
+      for(i=icntr;i<icntr+nvs-1-p;i++) {
+        t = id[nedge+i];
+        for(j=i;j>icntr && sed[j-1]>t;j--) sed[j] = sed[j-1];
+        sed[j] = t;
+      }
+      icntr += nvs-1-p;
+    }
+  }
+
+  free(tup);
+  free(id);
+  return;
+}
+/*******************************************************************************/
+
 /*******************************************************************************/
 /*!
  * \fn iCSRmat get_el_ed(iCSRmat* el_v,iCSRmat* ed_v)
@@ -223,19 +474,30 @@ void boundary_f_ed(iCSRmat* f_ed,iCSRmat* ed_v,INT nedge, INT nface,INT *f_flag,
  *
  * \return el_ed                     Element to edge map
  *
+ * \note The edges of each element are found by hashing their vertex pairs.
+ *
  */
 iCSRmat get_el_ed(iCSRmat* el_v,iCSRmat* ed_v)
 {
+  INT i;
+  INT nelm = el_v->row;
+  INT nve = (nelm>0) ? (el_v->IA[1]-el_v->IA[0]) : 0;
+  INT nloc = (nve*(nve-1))/2;
+
+  for(i=0;i<nelm;i++) {
+    if(el_v->IA[i+1]-el_v->IA[i]!=nve) check_error(ERROR_DATA_STRUCTURE,__FUNCTION__);
+  }
+
   iCSRmat el_ed;
+  el_ed.IA = (INT *)calloc(nelm+1, sizeof(INT));
+  el_ed.JA = (INT *)calloc(nelm*nloc+1, sizeof(INT));
+  for(i=0;i<=nelm;i++) el_ed.IA[i] = i*nloc;
+  simplex_edges_lookup(nelm,nve,el_v->JA+el_v->IA[0],ed_v,el_ed.JA);
 
-  // Get transpose of edge to vertex
-  iCSRmat v_ed;
-  icsr_trans(ed_v,&v_ed);
-  icsr_mxm_symb_max(el_v,&v_ed,&el_ed,2);
-  //zicsr_mxm_symb_max(el_v,&v_ed,&el_ed,2);
-  //fprintf(stdout,"\nXXXX: %d, %d %d\n",el_ed.nnz,el_ed.row,el_ed.col);
-  //print_full_mat_int(el_ed.nnz,1,el_ed.JA,"eled");
-  icsr_free(&v_ed);
+  el_ed.val = NULL;
+  el_ed.row = nelm;
+  el_ed.col = ed_v->row;
+  el_ed.nnz = nelm*nloc;
 
   return el_ed;
 }
@@ -387,125 +649,72 @@ void get_face_ordering(INT el_order,INT dim,INT f_order,INT *fel_order)
  * \return f_bdry                    Binary boundary array for faces
  * \return nbf                       Number of boundary faces
  * \return f_v                       Face to vertex map
+ * \return f_ed                      Face to edge map
+ *
+ * \note The faces are matched by hashing their sorted vertices, which
+ *       takes expected linear time in the number of elements.
  *
  */
 void get_face_maps(iCSRmat* el_v,INT el_order,iCSRmat* ed_v,INT nface,INT dim,INT f_order,iCSRmat *el_f,INT *f_bdry,INT *nbface,iCSRmat *f_v,iCSRmat *f_ed,INT *fel_order)
 {
-  // Flag for errors
-  SHORT status;
-
-  INT i,j,k,m,p,jk,col_b,icntr,jcntr,kcntr; /* Loop Indices */
-  INT ncol1,ncol2,ncol3,ncol4,ncol5,ncol6;  /* Node indices */
-  INT el1=-1,el2=-1,el3=-1,el=-1; /* Element indices */
-  INT iflag = 0;  /* Marks if we found a face */
+  INT i,j,k,t,occ,fst,f,icntr,jcntr,kcntr; /* Loop Indices */
   INT nbf = 0; /* hold number of boundary faces */
-  INT nd[dim];
-  INT f_num=-1;  /* Current face number of element */
   INT nelm = el_v->row;
   INT edpf = 2*dim - 3;
 
+  for(i=0;i<nelm;i++) {
+    if(el_v->IA[i+1]-el_v->IA[i]!=el_order) check_error(ERROR_DATA_STRUCTURE,__FUNCTION__);
+  }
+
+  // Match the faces of all elements by their vertices.  Faces are numbered
+  // in the order they are first met looping over elements and their faces.
+  INT nocc = nelm*f_order;
+  INT* id = (INT *) calloc(nocc+1,sizeof(INT));
+  INT* first = (INT *) calloc(nocc+1,sizeof(INT));
+  if(simplex_match_entities(nelm,el_order,el_v->JA+el_v->IA[0],f_order,dim,fel_order,id,first)!=nface) {
+    check_error(ERROR_DATA_STRUCTURE,__FUNCTION__);
+  }
+
+  // Second occurrence of each face (-1 on the boundary)
+  INT* other = (INT *) calloc(nface+1,sizeof(INT));
+  for(f=0;f<nface;f++) other[f] = -1;
+  for(occ=0;occ<nocc;occ++) {
+    if(first[occ]!=occ) other[id[occ]] = occ;
+  }
+
   // We will build face to element map first and then transpose it
   iCSRmat f_el = icsr_create (nface,nelm,nelm*f_order);
 
-  /* Get Transpose of el_v -> v_el */
-  iCSRmat v_el;
-  icsr_trans(el_v,&v_el);
-
-  // Get interior faces first
-  // Loop over All elements and each face on the element
-  // Then populate face to element and face to vertex map
-  // Also determines if a face is on the boundary.
+  // Populate face to element and face to vertex map (vertices in increasing
+  // order). Also determines if a face is on the boundary.
   icntr=0;
   jcntr=0;
   kcntr=0;
-  iflag=0;
-  for(i=0;i<nelm;i++) {
-    // Get first node of element
-    col_b = el_v->IA[i];
-    // Now loop over all faces of element
-    for(j=0;j<f_order;j++) {
-      // Get appropriate nodes on face
-      for(k=0;k<dim;k++) {
-        jk = col_b+fel_order[j*dim+k];
-        nd[k] = el_v->JA[jk];
-      }
-      // Next Loop over all elements that touch the first node
-      ncol1 = v_el.IA[nd[0]];
-      ncol2 = v_el.IA[nd[0]+1];
-      for(k=ncol1;k<ncol2;k++) {
-        el1 = v_el.JA[k];
-        // If not the same element we started in then check other nodes elements
-        if(el1!=i) {
-          ncol3 = v_el.IA[nd[1]];
-          ncol4 = v_el.IA[nd[1]+1];
-          for(m=ncol3;m<ncol4;m++) {
-            el2 = v_el.JA[m];
-            // Our two nodes share the element!  In 2D this is the face!
-            // In 3D, we check third guy
-            if(el2==el1) {
-              if(dim==2) {
-                // Mark the element that shares the face as well as the
-                // nodes that are shared
-                iflag = 1;
-                el = el1;
-              } else if(dim==3) {
-                ncol5 = v_el.IA[nd[2]];
-                ncol6 = v_el.IA[nd[2]+1];
-                for(p=ncol5;p<ncol6;p++) {
-                  el3 = v_el.JA[p];
-                  if(el3==el2) {
-                    // Mark the element that shares the face as well as
-                    // the nodes that are shared
-                    iflag = 1;
-                    el = el1;
-                  }
-                }
-              } else {
-                status = ERROR_DIM;
-                check_error(status, __FUNCTION__);
-              }
-            }
-          }
-        }
-      }
-      if(iflag && el>i) {
-        f_el.IA[icntr] = jcntr;
-        f_el.JA[jcntr] = i;
-        f_el.val[jcntr] = j;
-        f_el.JA[jcntr+1] = el;
-        // Find face number for other element
-        find_facenumber(el_v,el,nd,dim,&f_num); 
-        f_el.val[jcntr+1] = f_num;
-        f_bdry[icntr] = 0;
-        f_v->IA[icntr] = kcntr;
-        f_v->JA[kcntr] = nd[0];
-        f_v->JA[kcntr+1] = nd[1];
-        kcntr+=2;
-        if(dim==3) {
-          f_v->JA[kcntr] = nd[2];
-          kcntr++;
-        }
-        icntr++;
-        jcntr+=2;
-      } else if(!iflag){  // this must be a boundary face!
-        nbf++;
-        f_el.IA[icntr] = jcntr;
-        f_el.JA[jcntr] = i;
-        f_el.val[jcntr] = j;
-        f_bdry[icntr] = 1;
-        f_v->IA[icntr] = kcntr;
-        f_v->JA[kcntr] = nd[0];
-        f_v->JA[kcntr+1] = nd[1];
-        kcntr+=2;
-        if(dim==3) {
-          f_v->JA[kcntr] = nd[2];
-          kcntr++;
-        }
-        icntr++;
-        jcntr++;
-      }
-      iflag=0;
+  for(occ=0;occ<nocc;occ++) {
+    if(first[occ]!=occ) continue;
+    i = occ/f_order;
+    j = occ%f_order;
+    f_el.IA[icntr] = jcntr;
+    f_el.JA[jcntr] = i;
+    f_el.val[jcntr] = j;
+    if(other[icntr]>=0) {
+      f_el.JA[jcntr+1] = other[icntr]/f_order;
+      f_el.val[jcntr+1] = other[icntr]%f_order;
+      f_bdry[icntr] = 0;
+      jcntr+=2;
+    } else { // this must be a boundary face!
+      nbf++;
+      f_bdry[icntr] = 1;
+      jcntr++;
+    }
+    f_v->IA[icntr] = kcntr;
+    for(k=0;k<dim;k++) {
+      t = el_v->JA[el_v->IA[i]+fel_order[j*dim+k]];
+      for(fst=kcntr+k;fst>kcntr && f_v->JA[fst-1]>t;fst--) f_v->JA[fst] = f_v->JA[fst-1];
+      f_v->JA[fst] = t;
     }
+    kcntr+=dim;
+    icntr++;
   }
 
   f_el.IA[icntr] = jcntr;
@@ -514,31 +723,17 @@ void get_face_maps(iCSRmat* el_v,INT el_order,iCSRmat* ed_v,INT nface,INT dim,IN
   /* Get Transpose of f_el -> el_f */
   icsr_trans(&f_el,el_f);
 
-  /* Transpose face_node and back again to order nodes in increasing order
-   * (from global structure) */
-  iCSRmat v_f;
-  icsr_trans(f_v,&v_f);
-  icsr_free(f_v);
-  icsr_trans(&v_f,f_v);
-
   /* Get Face to Edge Map */
-  iCSRmat face_ed;
-  iCSRmat v_ed;
-  icsr_trans(ed_v,&v_ed);
-  icsr_mxm_symb_max(f_v,&v_ed,&face_ed,2);
   for(i=0;i<nface+1;i++)
-    f_ed->IA[i] = face_ed.IA[i];
-
-  for(i=0;i<nface*edpf;i++)
-    f_ed->JA[i] = face_ed.JA[i];
-  icsr_free(&face_ed);
-  icsr_free(&v_ed);
+    f_ed->IA[i] = i*edpf;
+  simplex_edges_lookup(nface,dim,f_v->JA,ed_v,f_ed->JA);
 
   *nbface = nbf;
 
-  icsr_free(&v_el);
+  free(id);
+  free(first);
+  free(other);
   icsr_free(&f_el);
-  icsr_free(&v_f);
 
   return;
 }
@@ -603,20 +798,88 @@ void find_facenumber(iCSRmat* el_v,INT elm,INT* nd,INT dim,INT *f_num)
  *
  */
 void face_stats(REAL *f_area,REAL *f_mid,REAL *f_norm,iCSRmat *f_v,mesh_struct *mesh)
+{
+  // Loop indices
+  INT i,jcnt,j,j_a,j_b;
+
+  INT nface = mesh->el_f->col;
+  iCSRmat *el_f = mesh->el_f;
+
+  // Face Element Stuff
+  INT notbdry=-666;
+  INT ie[2],op_n[2];
+  INT* fel = (INT *) calloc(2*nface+1,sizeof(INT));
+
+  /* Get Face to Element Map */
+  /* Get Transpose of f_el -> el_f */
+  iCSRmat f_el;
+  icsr_trans(el_f,&f_el);
+
+  // Find Corresponding Elements and order in element
+  // Also picks correct opposite node to form vector
+  // normal vectors point from lower number element to higher one
+  // or outward from external boundary
+  for(i=0;i<nface;i++) {
+    j_a = f_el.IA[i];
+    j_b = f_el.IA[i+1];
+    jcnt=0;
+    for (j=j_a; j<j_b; j++) {
+      notbdry = j_b-j_a-1;
+      ie[jcnt] = f_el.JA[j];
+      op_n[jcnt] = f_el.val[j];
+      jcnt++;
+    }
+    if(notbdry && (ie[1]<ie[0])) {
+      fel[2*i] = ie[1];
+      fel[2*i+1] = op_n[1];
+    } else {
+      fel[2*i] = ie[0];
+      fel[2*i+1] = op_n[0];
+    }
+  }
+  face_stats_list(nface,NULL,fel,f_area,f_mid,f_norm,f_v,mesh);
+
+  icsr_free(&f_el);
+  free(fel);
+
+  return;
+}
+/********************************************************************************/
+
+/********************************************************************************/
+/*!
+ * \fn void face_stats_list(INT nfl,INT *flist,INT *fel,REAL *f_area,REAL *f_mid,REAL *f_norm,iCSRmat *f_v,mesh_struct *mesh)
+ *
+ * \brief Get area, normal vector, and midpoints for a list of faces
+ *
+ * \param nfl                        Number of faces in the list
+ * \param flist                      Faces in the list (NULL means faces 0..nfl-1)
+ * \param fel                        For each face in the list, an element
+ *                                   containing it and the local index of the
+ *                                   vertex of that element opposite to the
+ *                                   face (2*nfl); the normal vector points
+ *                                   outward from this element
+ * \param f_v                        Face to vertex map
+ * \param mesh                       Mesh struct (el_v and cv are used)
+ *
+ * \return f_area                    Area of each face (length in 2D)
+ * \return f_norm                    Normal vector or each face
+ * \return f_mid                     Midpoint of each face
+ *
+ */
+void face_stats_list(INT nfl,INT *flist,INT *fel,REAL *f_area,REAL *f_mid,REAL *f_norm,iCSRmat *f_v,mesh_struct *mesh)
 {
   // Flag for errors
   SHORT status;
 
   // Loop indices
-  INT i,jcnt,j,j_a,j_b;
+  INT i,k,jcnt,j,j_a,j_b;
 
-  INT nface = mesh->el_f->col;
   INT dim = mesh->dim;
   INT el_order = mesh->v_per_elm;
 
   coordinates *cv = mesh->cv;
 
-  iCSRmat *el_f = mesh->el_f;
   iCSRmat *el_v = mesh->el_v;
 
   // Face Node Stuff
@@ -631,10 +894,7 @@ void face_stats(REAL *f_area,REAL *f_mid,REAL *f_norm,iCSRmat *f_v,mesh_struct *
   REAL* myx = (REAL *) calloc(dim,sizeof(REAL));
 
   // Face Element Stuff
-  INT notbdry=-666;
   INT myel,myopn;
-  INT* ie = (INT *) calloc(2,sizeof(INT));
-  INT* op_n = (INT *) calloc(2,sizeof(INT));
 
   // Element Node Stuff
   INT* myel_n = (INT *) calloc(el_order,sizeof(INT));
@@ -642,13 +902,9 @@ void face_stats(REAL *f_area,REAL *f_mid,REAL *f_norm,iCSRmat *f_v,mesh_struct *
   REAL* dp = (REAL *) calloc(el_order*dim,sizeof(REAL));
   REAL grad_mag,e1x,e1y,e1z,e2x,e2y,e2z;
 
-  /* Get Face to Element Map */
-  /* Get Transpose of f_el -> el_f */
-  iCSRmat f_el;
-  icsr_trans(el_f,&f_el);
-  
-  // Loop over all Faces
-  for(i=0;i<nface;i++) {
+  // Loop over the Faces
+  for(k=0;k<nfl;k++) {
+    i = flist ? flist[k] : k;
     /* Find Vertices in given Face */
     j_a = f_v->IA[i];
     j_b = f_v->IA[i+1];
@@ -663,26 +919,9 @@ void face_stats(REAL *f_area,REAL *f_mid,REAL *f_norm,iCSRmat *f_v,mesh_struct *
       jcnt++;
     }
 
-    // Find Corresponding Elements and order in element
-    // Also picks correct opposite node to form vector
-    // normal vectors point from lower number element to higher one
-    // or outward from external boundary
-    j_a = f_el.IA[i];
-    j_b = f_el.IA[i+1];
-    jcnt=0;
-    for (j=j_a; j<j_b; j++) {
-      notbdry = j_b-j_a-1;
-      ie[jcnt] = f_el.JA[j];
-      op_n[jcnt] = f_el.val[j];
-      jcnt++;
-    }
-    if(notbdry && (ie[1]<ie[0])) {
-      myopn = op_n[1];
-      myel = ie[1];
-    } else {
-      myopn = op_n[0];
-      myel = ie[0];
-    }
+    // Element and its node opposite to the face
+    myel = fel[2*k];
+    myopn = fel[2*k+1];
     // Get Nodes of this chosen element
     j_a = el_v->IA[myel];
     j_b = el_v->IA[myel+1];
@@ -696,7 +935,6 @@ void face_stats(REAL *f_area,REAL *f_mid,REAL *f_norm,iCSRmat *f_v,mesh_struct *
     if(dim==3) {
       myx[2] = cv->z[myel_n[myopn]];
     }
-
     /* Compute Area (length if 2D) and get midpt of face */
     if(dim==2) {
       f_area[i] = sqrt(pow(fabs(xf[1]-xf[0]),2)+pow(fabs(yf[1]-yf[0]),2));
@@ -734,15 +972,12 @@ void face_stats(REAL *f_area,REAL *f_mid,REAL *f_norm,iCSRmat *f_v,mesh_struct *
     }
   }
 
-  icsr_free(&f_el);
   if(ipf) free(ipf);
   if(xf) free(xf);
   if(yf) free(yf);
   if(myx) free(myx);
   if(p) free(p);
   if(dp) free(dp);
-  if(op_n) free(op_n);
-  if(ie) free(ie);
   if(myel_n) free(myel_n);
   if(dim==3) {
     if(zf) free(zf);
@@ -766,11 +1001,32 @@ void face_stats(REAL *f_area,REAL *f_mid,REAL *f_norm,iCSRmat *f_v,mesh_struct *
  *
  */
 void sync_facenode(iCSRmat *f_v,REAL* f_norm,mesh_struct *mesh)
+{
+  sync_facenode_list(mesh->el_f->col,NULL,f_v,f_norm,mesh);
+  return;
+}
+/********************************************************************************/
+
+/********************************************************************************/
+/*!
+ * \fn void sync_facenode_list(INT nfl,INT *flist,iCSRmat *f_v,REAL* f_norm,mesh_struct *mesh)
+ *
+ * \brief Reorder the Face-Node mapping of a list of faces so it has positive
+ *        orientation with respect to the face's normal vector
+ *
+ * \param nfl                        Number of faces in the list
+ * \param flist                      Faces in the list (NULL means faces 0..nfl-1)
+ * \param mesh                       Mesh struct
+ * \param f_norm                     Normal vector or each face
+ *
+ * \return f_v                       Reordered face to vertex map
+ *
+ */
+void sync_facenode_list(INT nfl,INT *flist,iCSRmat *f_v,REAL* f_norm,mesh_struct *mesh)
 {
   // Loop indices
-  INT i,j;
+  INT i,j,k;
 
-  INT nface = mesh->el_f->col;
   INT dim = mesh->dim;
   INT ndpf = dim;
   coordinates *cv = mesh->cv;
@@ -782,7 +1038,8 @@ void sync_facenode(iCSRmat *f_v,REAL* f_norm,mesh_struct *mesh)
   REAL* zf = calloc(ndpf,sizeof(REAL));
 
   if(dim==2) {
-    for(i=0;i<nface;i++) {
+    for(k=0;k<nfl;k++) {
+      i = flist ? flist[k] : k;
       // Get normal vector of face
       nx = f_norm[(i)*dim];
       ny = f_norm[(i)*dim+1];
@@ -810,7 +1067,8 @@ void sync_facenode(iCSRmat *f_v,REAL* f_norm,mesh_struct *mesh)
       }
     }
   } else if (dim==3) {
-    for(i=0;i<nface;i++) {
+    for(k=0;k<nfl;k++) {
+      i = flist ? flist[k] : k;
       // Get normal vector of face
       nx = f_norm[(i)*dim];
       ny = f_norm[(i)*dim+1];
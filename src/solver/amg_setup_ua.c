@@ -815,6 +815,13 @@ static SHORT amg_setup_unsmoothP_unsmoothR(AMG_data *mgl,
           Schwarz_setup(&mgl[lvl].Schwarz, &swzparam);
       }
 
+      /*-- Setup sparse approximate inverse smoother if necessary */
+      if ( param->smoother == SMOOTHER_FSAI || param->smoother == SMOOTHER_SPAI ) {
+          sai_setup(&mgl[lvl].A, &mgl[lvl].SAI,
+                    (param->smoother == SMOOTHER_FSAI) ? FSAI : SPAI,
+                    param->SAI_levels, PRINT_NONE);
+      }
+
         /*-- Aggregation --*/
         switch ( param->aggregation_type ) {
 
@@ -901,7 +908,6 @@ static SHORT amg_setup_unsmoothP_unsmoothR(AMG_data *mgl,
     // Setup coarse level systems for direct solvers
     switch (csolver) {
 
-#if WITH_SUITESPARSE
         case SOLVER_UMFPACK: {
             // Need to sort the matrix A for UMFPACK to work
             dCSRmat Ac_tran;
@@ -914,7 +920,6 @@ static SHORT amg_setup_unsmoothP_unsmoothR(AMG_data *mgl,
             mgl[lvl].Numeric = umfpack_factorize(&mgl[lvl].A, 0);
             break;
         }
-#endif
         default:
             // Do nothing!
             break;
@@ -1049,6 +1054,13 @@ static SHORT amg_setup_smoothP_smoothR(AMG_data *mgl,
           Schwarz_setup(&mgl[lvl].Schwarz, &swzparam);
         }
 
+        /*-- Setup sparse approximate inverse smoother if necessary */
+        if ( param->smoother == SMOOTHER_FSAI || param->smoother == SMOOTHER_SPAI ) {
+            sai_setup(&mgl[lvl].A, &mgl[lvl].SAI,
+                      (param->smoother == SMOOTHER_FSAI) ? FSAI : SPAI,
+                      param->SAI_levels, PRINT_NONE);
+        }
+
         /*-- Aggregation --*/
         switch ( param->aggregation_type ) {
 
@@ -1137,7 +1149,6 @@ static SHORT amg_setup_smoothP_smoothR(AMG_data *mgl,
     // Setup coarse level systems for direct solvers
     switch (csolver) {
 
-#if WITH_SUITESPARSE
         case SOLVER_UMFPACK: {
             // Need to sort the matrix A for UMFPACK to work
             dCSRmat Ac_tran;
@@ -1150,7 +1161,6 @@ static SHORT amg_setup_smoothP_smoothR(AMG_data *mgl,
             mgl[lvl].Numeric = umfpack_factorize(&mgl[lvl].A, 0);
             break;
         }
-#endif
         default:
             // Do nothing!
             break;
@@ -1373,7 +1383,6 @@ static SHORT famg_setup_unsmoothP_unsmoothR(AMG_data *mgl,
     // Setup coarse level systems for direct solvers
     switch (csolver) {
 
-#if WITH_SUITESPARSE
         case SOLVER_UMFPACK: {
             // Need to sort the matrix A for UMFPACK to work
             dCSRmat Ac_tran;
@@ -1386,7 +1395,6 @@ static SHORT famg_setup_unsmoothP_unsmoothR(AMG_data *mgl,
             mgl[lvl].Numeric = umfpack_factorize(&mgl[lvl].A, 0);
             break;
         }
-#endif
         default:
             // Do nothing!
             break;
@@ -1604,7 +1612,6 @@ static SHORT famg_setup_smoothP_smoothR(AMG_data *mgl,
     // Setup coarse level systems for direct solvers
     switch (csolver) {
 
-#if WITH_SUITESPARSE
         case SOLVER_UMFPACK: {
             // Need to sort the matrix A for UMFPACK to work
             dCSRmat Ac_tran;
@@ -1617,7 +1624,6 @@ static SHORT famg_setup_smoothP_smoothR(AMG_data *mgl,
             mgl[lvl].Numeric = umfpack_factorize(&mgl[lvl].A, 0);
             break;
         }
-#endif
         default:
             // Do nothing!
             break;
@@ -3,7 +3,8 @@
  *  Created by James Adler, Xiaozhe Hu, and Ludmil Zikatanov on 8/19/15.
  *  Copyright 2015__HAZMATH__. All rights reserved.
  *
- * \brief Direct Solver methods -- for now just using UMFPACK Solvers
+ * \brief Direct Solver methods -- UMFPACK Solvers, or the native supernodal
+ *        Cholesky/LU solver when HAZMATH is built without SuiteSparse
  *
  * \note   Done cleanup for releasing -- Xiaozhe Hu 08/28/2021
  *
@@ -15,6 +16,26 @@
 #include "umfpack.h"
 #endif
 
+/* native solver: threshold of the LU pivoting, and the iterative refinement
+   of the LU solve (number of steps, tolerance on the componentwise backward error) */
+#define DIRECT_PIVOT_TOL  0.1
+#define DIRECT_MAX_REFINE 5
+#define DIRECT_BERR_TOL   1e-10
+
+/* native solver: number of pivots per panel in the blocked front factorization */
+#define DIRECT_BLOCK 32
+
+/* native solver: relaxed supernode amalgamation (CHOLMOD defaults), a child is
+   merged into its parent if the merged supernode has at most NRELAX0 columns, or
+   at most NRELAX1 (NRELAX2) columns and a fraction of explicit zeros below
+   ZRELAX0 (ZRELAX1), or any size and a fraction of zeros below ZRELAX2 */
+#define DIRECT_NRELAX0 4
+#define DIRECT_NRELAX1 16
+#define DIRECT_NRELAX2 48
+#define DIRECT_ZRELAX0 0.8
+#define DIRECT_ZRELAX1 0.1
+#define DIRECT_ZRELAX2 0.05
+
 /***********************************************************************************************/
 /**
  * \fn directsolve_UMF(dCSRmat *A,dvector *f,dvector *x,INT print_level)
@@ -36,8 +57,6 @@ INT directsolve_UMF(dCSRmat *A,
                     dvector *x,
                     INT print_level)
 {
-
-#if WITH_SUITESPARSE
   INT err_flag;
   INT shift_flag = 0;
 
@@ -80,10 +99,6 @@ INT directsolve_UMF(dCSRmat *A,
   }
 
   return err_flag;
-#else
-  error_extlib(252, __FUNCTION__, "SuiteSparse");
-  return 0;
-#endif
 }
 
 /***********************************************************************************************/
@@ -104,8 +119,6 @@ INT directsolve_UMF(dCSRmat *A,
 void* factorize_UMF(dCSRmat *A,
                     INT print_level)
 {
-
-#if WITH_SUITESPARSE
   INT shift_flag = 0;
 
   // UMFPACK requires transpose of A
@@ -133,10 +146,6 @@ void* factorize_UMF(dCSRmat *A,
   dcsr_free(&At);
 
   return Numeric;
-#else
-  error_extlib(252, __FUNCTION__, "SuiteSparse");
-  return 0;
-#endif
 }
 
 /***********************************************************************************************/
@@ -164,8 +173,6 @@ INT solve_UMF(dCSRmat *A,
               void *Numeric,
               INT print_level)
 {
-
-#if WITH_SUITESPARSE
   INT err_flag;
   INT shift_flag = 0;
 
@@ -197,10 +204,6 @@ INT solve_UMF(dCSRmat *A,
   dcsr_free(&At);
 
   return err_flag;
-#else
-  error_extlib(252, __FUNCTION__, "SuiteSparse");
-  return 0;
-#endif
 }
 
 /***********************************************************************************************/
@@ -224,7 +227,6 @@ INT block_directsolve_UMF(block_dCSRmat *bA,
                     dvector *x,
                     INT print_level)
 {
-#if WITH_SUITESPARSE
   INT err_flag;
 
   // Convert block matrix to regular matrix
@@ -239,10 +241,6 @@ INT block_directsolve_UMF(block_dCSRmat *bA,
   dcsr_free(&A);
 
   return err_flag;
-#else
-  error_extlib(252, __FUNCTION__, "SuiteSparse");
-  return 0;
-#endif
 }
 
 /***********************************************************************************************/
@@ -260,9 +258,6 @@ INT block_directsolve_UMF(block_dCSRmat *bA,
 void* block_factorize_UMF(block_dCSRmat *bA,
                     INT print_level)
 {
-
-#if WITH_SUITESPARSE
-
   // Data for Numerical factorization
   void* Numeric = NULL;
 
@@ -276,10 +271,6 @@ void* block_factorize_UMF(block_dCSRmat *bA,
   dcsr_free(&A);
 
   return Numeric;
-#else
-  error_extlib(252, __FUNCTION__, "SuiteSparse");
-  return 0;
-#endif
 }
 
 /***********************************************************************************************/
@@ -305,8 +296,6 @@ INT block_solve_UMF(block_dCSRmat *bA,
               void *Numeric,
               INT print_level)
 {
-
-#if WITH_SUITESPARSE
   INT err_flag;
 
   // Convert block matrix to regular matrix
@@ -319,10 +308,6 @@ INT block_solve_UMF(block_dCSRmat *bA,
   dcsr_free(&A);
 
   return err_flag;
-#else
-  error_extlib(252, __FUNCTION__, "SuiteSparse");
-  return 0;
-#endif
 }
 
 // Suitesparse routines - assumes conversions have been done
@@ -373,8 +358,15 @@ void* umfpack_factorize (dCSRmat *ptrA,
 
   return Numeric;
 #else
-  error_extlib(253, __FUNCTION__, "SuiteSparse");
-  return NULL;
+  // native solver: ptrA is the transpose of the matrix
+  dCSRmat A;
+  void *Numeric;
+
+  dcsr_trans(ptrA, &A);
+  Numeric = direct_factorize(&A, prtlvl);
+  dcsr_free(&A);
+
+  return Numeric;
 #endif
 
 }
@@ -421,8 +413,21 @@ INT umfpack_solve (dCSRmat *ptrA,
 
   return status;
 #else
-  error_extlib(254, __FUNCTION__, "SuiteSparse");
-  return 0;
+  // native solver
+  INT status;
+  REAL solve_start, solve_end;
+
+  get_time(&solve_start);
+
+  if (Numeric == NULL) return ERROR_SOLVER_EXIT;
+  status = direct_solve((LU_data *)Numeric, b, u);
+
+  if ( prtlvl > PRINT_NONE ) {
+    get_time(&solve_end);
+    print_cputime("Direct solve", solve_end - solve_start);
+  }
+
+  return status;
 #endif
 }
 
@@ -445,11 +450,1620 @@ INT umfpack_free_numeric (void *Numeric)
 
   return status;
 #else
-  error_extlib(255, __FUNCTION__, "SuiteSparse");
-  return 0;
+  direct_free_numeric(Numeric);
+
+  return SUCCESS;
+#endif
+}
+
+/***************************************************************************************************************************/
+/**
+ * \fn INT umfpack_free_symbolic (void *Symbolic)
+ * \brief Free the symbolic analysis of UMFpack
+ *
+ * \param Symbolic   Pointer to the symbolic analysis
+ *
+ * \note The native solver keeps its symbolic analysis with the numeric
+ *       factorization, so there is nothing to free without SuiteSparse.
+ */
+INT umfpack_free_symbolic (void *Symbolic)
+{
+#if WITH_SUITESPARSE
+  umfpack_di_free_symbolic (&Symbolic);
+#endif
+
+  return SUCCESS;
+}
+
+/*---------------------------------*/
+/*--   Direct solver handle      --*/
+/*---------------------------------*/
+
+#if WITH_SUITESPARSE
+/***********************************************************************************************/
+/**
+ * \fn static void direct_trans_map (dCSRmat *A, dCSRmat *At, INT **tmap)
+ *
+ * \brief Transpose A and keep the index map At->val[k] = A->val[tmap[k]]
+ *
+ * \param A      Pointer to the dCSRmat matrix (0-based)
+ * \param At     Pointer to the transpose (OUTPUT)
+ * \param tmap   Index map (OUTPUT)
+ *
+ */
+static void direct_trans_map(dCSRmat *A,
+                             dCSRmat *At,
+                             INT **tmap)
+{
+  const INT n = A->row, m = A->col, nnz = A->nnz;
+  INT i, k, p;
+  INT *map;
+
+  At->row = m; At->col = n; At->nnz = nnz;
+  At->IA  = (INT *)calloc(m+1, sizeof(INT));
+  At->JA  = (INT *)calloc(MAX(nnz,1), sizeof(INT));
+  At->val = (REAL *)calloc(MAX(nnz,1), sizeof(REAL));
+  map     = (INT *)calloc(MAX(nnz,1), sizeof(INT));
+
+  for (k=0; k<nnz; ++k) At->IA[A->JA[k]+1]++;
+  for (i=0; i<m; ++i) At->IA[i+1] += At->IA[i];
+
+  for (i=0; i<n; ++i) {
+    for (k=A->IA[i]; k<A->IA[i+1]; ++k) {
+      p = At->IA[A->JA[k]]++;
+      At->JA[p]  = i;
+      At->val[p] = A->val[k];
+      map[p]     = k;
+    }
+  }
+  for (i=m; i>0; --i) At->IA[i] = At->IA[i-1];
+  At->IA[0] = 0;
+
+  *tmap = map;
+}
+#endif
+
+/***********************************************************************************************/
+/**
+ * \fn SHORT direct_data_setup (dCSRmat *A, direct_data *dirdata, const SHORT prtlvl)
+ *
+ * \brief Symbolic analysis and numeric factorization of A, kept in a direct
+ *        solver handle (UMFPACK, or the native solver without SuiteSparse)
+ *
+ * \param A         Pointer to the dCSRmat matrix (no need of transpose)
+ * \param dirdata   Pointer to the direct solver handle (OUTPUT)
+ * \param prtlvl    Print level
+ *
+ * \return          SUCCESS if succeed; ERROR otherwise
+ *
+ * \note Use direct_data_refactorize when only the values of A change.
+ */
+SHORT direct_data_setup(dCSRmat *A,
+                        direct_data *dirdata,
+                        const SHORT prtlvl)
+{
+  SHORT status = SUCCESS;
+  INT shift_flag = 0;
+  REAL setup_start, setup_end;
+
+  get_time(&setup_start);
+
+  direct_data_free(dirdata);
+  dirdata->row = A->row;
+  dirdata->nnz = A->nnz;
+
+  // Check if counting from 1 or 0 for CSR arrays
+  if(A->IA[0]==1) {
+    dcsr_shift(A, -1);  // shift A
+    shift_flag = 1;
+  }
+
+#if WITH_SUITESPARSE
+  direct_trans_map(A, &dirdata->At, &dirdata->tmap);
+
+  status = umfpack_di_symbolic (A->row, A->col, dirdata->At.IA, dirdata->At.JA, dirdata->At.val,
+                                &dirdata->Symbolic, NULL, NULL);
+  if(status<0) {
+    fprintf(stderr,"UMFPACK ERROR in Symbolic, status = %d\n\n",status);
+  }
+  else {
+    status = umfpack_di_numeric (dirdata->At.IA, dirdata->At.JA, dirdata->At.val,
+                                 dirdata->Symbolic, &dirdata->Numeric, NULL, NULL);
+    if(status<0) {
+      fprintf(stderr,"UMFPACK ERROR in Numeric, status = %d\n\n",status);
+    }
+  }
+#else
+  dirdata->Numeric = direct_factorize(A, prtlvl);
+  if (dirdata->Numeric == NULL) status = ERROR_SOLVER_EXIT;
+#endif
+
+  // Fix A back to correct counting
+  if(shift_flag==1) {
+    dcsr_shift(A, 1);  // shift A back
+  }
+
+  if ( prtlvl > PRINT_MIN ) {
+    get_time(&setup_end);
+    print_cputime("Direct solver setup", setup_end - setup_start);
+  }
+
+  return status;
+}
+
+/***********************************************************************************************/
+/**
+ * \fn SHORT direct_data_refactorize (dCSRmat *A, direct_data *dirdata, const SHORT prtlvl)
+ *
+ * \brief Numeric factorization of A reusing the symbolic analysis in the handle
+ *        (A has the sparsity pattern given to direct_data_setup)
+ *
+ * \param A         Pointer to the dCSRmat matrix
+ * \param dirdata   Pointer to the direct solver handle (OUTPUT)
+ * \param prtlvl    Print level
+ *
+ * \return          SUCCESS if succeed; ERROR otherwise
+ *
+ */
+SHORT direct_data_refactorize(dCSRmat *A,
+                              direct_data *dirdata,
+                              const SHORT prtlvl)
+{
+  SHORT status = SUCCESS;
+  INT shift_flag = 0;
+  REAL setup_start, setup_end;
+
+  if (A->row != dirdata->row || A->nnz != dirdata->nnz) {
+    printf("### ERROR HAZMATH DANGER: %s: pattern differs from the setup!\n", __FUNCTION__);
+    return ERROR_MAT_SIZE;
+  }
+
+  // Nothing to reuse if the setup failed
+#if WITH_SUITESPARSE
+  if (dirdata->Symbolic == NULL) {
+#else
+  if (dirdata->Numeric == NULL) {
+#endif
+    printf("### ERROR HAZMATH DANGER: %s: no symbolic analysis, setup failed!\n", __FUNCTION__);
+    return ERROR_SOLVER_EXIT;
+  }
+
+  get_time(&setup_start);
+
+  // Check if counting from 1 or 0 for CSR arrays
+  if(A->IA[0]==1) {
+    dcsr_shift(A, -1);  // shift A
+    shift_flag = 1;
+  }
+
+#if WITH_SUITESPARSE
+  INT k;
+  for (k=0; k<dirdata->nnz; ++k) dirdata->At.val[k] = A->val[dirdata->tmap[k]];
+
+  if (dirdata->Numeric) umfpack_di_free_numeric (&dirdata->Numeric);
+  status = umfpack_di_numeric (dirdata->At.IA, dirdata->At.JA, dirdata->At.val,
+                               dirdata->Symbolic, &dirdata->Numeric, NULL, NULL);
+  if(status<0) {
+    fprintf(stderr,"UMFPACK ERROR in Numeric, status = %d\n\n",status);
+  }
+#else
+  status = direct_numeric(A, (LU_data *)dirdata->Numeric, prtlvl);
+#endif
+
+  // Fix A back to correct counting
+  if(shift_flag==1) {
+    dcsr_shift(A, 1);  // shift A back
+  }
+
+  if ( prtlvl > PRINT_MIN ) {
+    get_time(&setup_end);
+    print_cputime("Direct solver refactorization", setup_end - setup_start);
+  }
+
+  return status;
+}
+
+/***********************************************************************************************/
+/**
+ * \fn SHORT direct_data_solve (direct_data *dirdata, dvector *b, dvector *x,
+ *                              const INT nrhs, const SHORT prtlvl)
+ *
+ * \brief Solve AX=B for nrhs right hand sides with the factorization in the handle
+ *
+ * \param dirdata   Pointer to the direct solver handle
+ * \param b         Right hand sides b[0],...,b[nrhs-1]
+ * \param x         Solutions x[0],...,x[nrhs-1] (OUTPUT)
+ * \param nrhs      Number of right hand sides
+ * \param prtlvl    Print level
+ *
+ * \return          SUCCESS if succeed; ERROR otherwise
+ *
+ */
+SHORT direct_data_solve(direct_data *dirdata,
+                        dvector *b,
+                        dvector *x,
+                        const INT nrhs,
+                        const SHORT prtlvl)
+{
+  SHORT status = SUCCESS;
+  REAL solve_start, solve_end;
+
+  if (dirdata->Numeric == NULL) return ERROR_SOLVER_EXIT;
+
+  get_time(&solve_start);
+
+#if WITH_SUITESPARSE
+  INT r;
+#ifdef _OPENMP
+#pragma omp parallel for private(r) reduction(min:status) if(nrhs > 1)
+#endif
+  for (r=0; r<nrhs; ++r) {
+    INT flag = umfpack_di_solve (UMFPACK_A, dirdata->At.IA, dirdata->At.JA, dirdata->At.val,
+                                 x[r].val, b[r].val, dirdata->Numeric, NULL, NULL);
+    if (flag < status) status = flag;
+  }
+#else
+  status = direct_solve_nrhs((LU_data *)dirdata->Numeric, nrhs, b, x);
+#endif
+
+  if ( prtlvl > PRINT_NONE ) {
+    get_time(&solve_end);
+    print_cputime("Direct solve", solve_end - solve_start);
+  }
+
+  return status;
+}
+
+
+/*---------------------------------*/
+/*--  Native sparse direct solver --*/
+/*---------------------------------*/
+// Used by the routines above when HAZMATH is built without SuiteSparse:
+// multifrontal supernodal Cholesky (symmetric positive definite A) or LU with
+// threshold pivoting, delaying the pivots a front cannot take to its parent
+// (general A on the symmetrized pattern), after a nested dissection ordering.
+// The LU solve is followed by iterative refinement and a backward error check.
+
+/***********************************************************************************************/
+/**
+ * \fn static int direct_icmp (const void *a, const void *b)
+ *
+ * \brief Compare two INTs (for qsort)
+ *
+ */
+static int direct_icmp(const void *a,
+                       const void *b)
+{
+  const INT ia = *(const INT *)a, ib = *(const INT *)b;
+  return (ia > ib) - (ia < ib);
+}
+
+/***********************************************************************************************/
+/**
+ * \fn static void direct_sym_graph (dCSRmat *A, INT **gia, INT **gja)
+ *
+ * \brief Adjacency graph of A+A^T without the diagonal
+ *
+ * \param A     Pointer to the dCSRmat matrix
+ * \param gia   Row pointers of the graph (OUTPUT)
+ * \param gja   Column indices of the graph (OUTPUT)
+ *
+ */
+static void direct_sym_graph(dCSRmat *A,
+                             INT **gia,
+                             INT **gja)
+{
+  const INT n = A->row;
+  INT i, j, k, p, nz;
+  INT *ia = (INT *)calloc(n+1, sizeof(INT));
+  INT *ja, *pos;
+
+  for (i=0; i<n; ++i) {
+    for (k=A->IA[i]; k<A->IA[i+1]; ++k) {
+      j = A->JA[k];
+      if (j != i) { ia[i+1]++; ia[j+1]++; }
+    }
+  }
+  for (i=0; i<n; ++i) ia[i+1] += ia[i];
+
+  ja  = (INT *)calloc(MAX(ia[n],1), sizeof(INT));
+  pos = (INT *)calloc(MAX(n,1), sizeof(INT));
+  iarray_cp(n, ia, pos);
+  for (i=0; i<n; ++i) {
+    for (k=A->IA[i]; k<A->IA[i+1]; ++k) {
+      j = A->JA[k];
+      if (j != i) { ja[pos[i]++] = j; ja[pos[j]++] = i; }
+    }
+  }
+
+  // remove duplicates (pos is reused as a marker)
+  for (i=0; i<n; ++i) pos[i] = -1;
+  nz = 0; p = 0;
+  for (i=0; i<n; ++i) {
+    k = ia[i+1];
+    ia[i] = nz;
+    for (; p<k; ++p) {
+      j = ja[p];
+      if (pos[j] != i) { pos[j] = i; ja[nz++] = j; }
+    }
+  }
+  ia[n] = nz;
+
+  free(pos);
+    *gia = ia;
+    *gja = ja;
+}
+
+/***********************************************************************************************/
+/**
+ * \fn static void direct_nd_order (INT *ia, INT *ja, INT *V, const INT nv,
+ *                                  INT *perm, INT *pos, INT *map)
+ *
+ * \brief Nested dissection ordering of the subgraph induced by the vertices V
+ *
+ * \param ia     Row pointers of the graph
+ * \param ja     Column indices of the graph
+ * \param V      Vertices of the subgraph
+ * \param nv     Number of vertices of the subgraph
+ * \param perm   Ordering (OUTPUT: the vertices of V are stored from perm[*pos] on)
+ * \param pos    Next free position in perm (OUTPUT)
+ * \param map    Work array of the size of the graph, all entries -1 (restored)
+ *
+ * \note The connected components are ordered one after another. A connected
+ *       subgraph is split with the bfs level structure (run_bfs) rooted at a
+ *       pseudo-peripheral vertex: the level of the median vertex, thinned to
+ *       the vertices adjacent to the next level, is the separator and is
+ *       ordered after the two parts.
+ */
+static void direct_nd_order(INT *ia,
+                            INT *ja,
+                            INT *V,
+                            const INT nv,
+                            INT *perm,
+                            INT *pos,
+                            INT *map)
+{
+  const INT leaf = 64; // smaller subgraphs are not dissected
+  INT i, j, k, q, qend, nz, ncomp, nlev, mid, cum, n1, n2, ns;
+  INT *lia, *lja, *comp, *queue, *lev, *part1, *part2, *sep;
+  ivector roots, anc;
+  iCSRmat *blk;
+
+  if (nv <= leaf) {
+    iarray_cp(nv, V, perm + *pos);
+        *pos += nv;
+    return;
+  }
+
+  // local graph
+  for (i=0; i<nv; ++i) map[V[i]] = i;
+  lia = (INT *)calloc(nv+1, sizeof(INT));
+  for (i=0; i<nv; ++i) {
+    for (k=ia[V[i]]; k<ia[V[i]+1]; ++k) if (map[ja[k]] >= 0) lia[i+1]++;
+  }
+  for (i=0; i<nv; ++i) lia[i+1] += lia[i];
+  lja = (INT *)calloc(MAX(lia[nv],1), sizeof(INT));
+  nz = 0;
+  for (i=0; i<nv; ++i) {
+    for (k=ia[V[i]]; k<ia[V[i]+1]; ++k) if (map[ja[k]] >= 0) lja[nz++] = map[ja[k]];
+  }
+  for (i=0; i<nv; ++i) map[V[i]] = -1;
+
+  // connected components: they are stored one after another in queue
+  comp  = (INT *)calloc(nv, sizeof(INT));
+  queue = (INT *)calloc(nv, sizeof(INT));
+  for (i=0; i<nv; ++i) comp[i] = -1;
+  ncomp = 0; qend = 0;
+  for (i=0; i<nv; ++i) {
+    if (comp[i] >= 0) continue;
+    q = qend; queue[qend++] = i; comp[i] = ncomp;
+    for (; q<qend; ++q) {
+      for (k=lia[queue[q]]; k<lia[queue[q]+1]; ++k) {
+        j = lja[k];
+        if (comp[j] < 0) { comp[j] = ncomp; queue[qend++] = j; }
+      }
+    }
+    ncomp++;
+  }
+
+  if (ncomp > 1) {
+    INT *W = (INT *)calloc(nv, sizeof(INT));
+    for (q=0; q<nv; ++q) W[q] = V[queue[q]];
+    free(lia); free(lja);
+    for (q=0; q<nv; q=k) {
+      for (k=q+1; k<nv && comp[queue[k]] == comp[queue[q]]; ++k) ;
+      direct_nd_order(ia, ja, W+q, k-q, perm, pos, map);
+    }
+    free(W); free(comp); free(queue);
+    return;
+  }
+  free(comp);
+  free(queue);
+
+  // level structure from a pseudo-peripheral vertex
+  roots.row = 1;
+  roots.val = (INT *)calloc(1, sizeof(INT));
+  blk = run_bfs(nv, lia, lja, &roots, &anc, -1);
+  roots.val[0] = blk->JA[blk->IA[blk->row]-1];
+  free(anc.val); icsr_free(blk); free(blk);
+  blk = run_bfs(nv, lia, lja, &roots, &anc, -1);
+  free(anc.val); free(roots.val);
+
+  nlev = blk->row;
+  if (nlev < 3) { // no useful separator
+    icsr_free(blk); free(blk);
+    free(lia); free(lja);
+    iarray_cp(nv, V, perm + *pos);
+        *pos += nv;
+    return;
+  }
+
+  lev = (INT *)calloc(nv, sizeof(INT));
+  for (i=0; i<nlev; ++i) {
+    for (q=blk->IA[i]; q<blk->IA[i+1]; ++q) lev[blk->JA[q]] = i;
+  }
+
+  // level of the median vertex
+  cum = 0;
+  for (mid=0; mid<nlev; ++mid) {
+    cum += blk->IA[mid+1] - blk->IA[mid];
+    if (2*cum >= nv) break;
+  }
+  mid = MAX(1, MIN(mid, nlev-2));
+
+  part1 = (INT *)calloc(nv, sizeof(INT));
+  part2 = (INT *)calloc(nv, sizeof(INT));
+  sep   = (INT *)calloc(nv, sizeof(INT));
+  n1 = n2 = ns = 0;
+  for (q=0; q<blk->IA[mid]; ++q) part1[n1++] = V[blk->JA[q]];
+  for (q=blk->IA[mid+1]; q<blk->IA[nlev]; ++q) part2[n2++] = V[blk->JA[q]];
+  for (q=blk->IA[mid]; q<blk->IA[mid+1]; ++q) {
+    i = blk->JA[q];
+    for (k=lia[i]; k<lia[i+1]; ++k) if (lev[lja[k]] == mid+1) break;
+    if (k < lia[i+1]) sep[ns++] = V[i];
+    else part1[n1++] = V[i];
+  }
+
+  icsr_free(blk); free(blk);
+  free(lev); free(lia); free(lja);
+
+  direct_nd_order(ia, ja, part1, n1, perm, pos, map);
+  direct_nd_order(ia, ja, part2, n2, perm, pos, map);
+  iarray_cp(ns, sep, perm + *pos);
+    *pos += ns;
+
+  free(part1); free(part2); free(sep);
+}
+
+/***********************************************************************************************/
+/**
+ * \fn static void direct_etree (const INT n, INT *ia, INT *ja, INT *perm,
+ *                               INT *iperm, INT *parent)
+ *
+ * \brief Elimination tree of the symmetric graph (ia,ja) in the ordering perm
+ *
+ * \param n       Number of vertices
+ * \param ia      Row pointers of the graph
+ * \param ja      Column indices of the graph
+ * \param perm    Ordering: k-th vertex is perm[k]
+ * \param iperm   Inverse of perm
+ * \param parent  Parent of each (permuted) vertex, -1 for roots (OUTPUT)
+ *
+ */
+static void direct_etree(const INT n,
+                         INT *ia,
+                         INT *ja,
+                         INT *perm,
+                         INT *iperm,
+                         INT *parent)
+{
+  INT i, k, p, next;
+  INT *anc = (INT *)calloc(MAX(n,1), sizeof(INT));
+
+  for (k=0; k<n; ++k) {
+    parent[k] = -1; anc[k] = -1;
+    for (p=ia[perm[k]]; p<ia[perm[k]+1]; ++p) {
+      // climb from i to the root of its subtree (with path compression)
+      for (i=iperm[ja[p]]; i!=-1 && i<k; i=next) {
+        next = anc[i];
+        anc[i] = k;
+        if (next == -1) { parent[i] = k; }
+      }
+    }
+  }
+  free(anc);
+}
+
+/***********************************************************************************************/
+/**
+ * \fn static void direct_postorder (const INT n, INT *parent, INT *post)
+ *
+ * \brief Postorder of a forest given by parent
+ *
+ * \param n       Number of vertices
+ * \param parent  Parent of each vertex, -1 for roots
+ * \param post    k-th vertex in postorder (OUTPUT)
+ *
+ */
+static void direct_postorder(const INT n,
+                             INT *parent,
+                             INT *post)
+{
+  INT i, j, k = 0, top;
+  INT *head  = (INT *)calloc(MAX(n,1), sizeof(INT));
+  INT *next  = (INT *)calloc(MAX(n,1), sizeof(INT));
+  INT *stack = (INT *)calloc(MAX(n,1), sizeof(INT));
+
+  for (i=0; i<n; ++i) head[i] = -1;
+  // children lists (in increasing order)
+  for (i=n-1; i>=0; --i) {
+    if (parent[i] == -1) continue;
+    next[i] = head[parent[i]];
+    head[parent[i]] = i;
+  }
+
+  for (i=0; i<n; ++i) {
+    if (parent[i] != -1) continue;
+    // depth first search from the root i
+    top = 0; stack[0] = i;
+    while (top >= 0) {
+      j = stack[top];
+      if (head[j] == -1) {
+        post[k++] = j; top--;
+      }
+      else {
+        stack[++top] = head[j];
+        head[j] = next[head[j]];
+      }
+    }
+  }
+
+  free(head);
+  free(next);
+  free(stack);
+}
+
+/***********************************************************************************************/
+/**
+ * \fn static INT direct_front_lu (const INT m, const INT K, REAL *F, INT *rows, INT *cols,
+ *                                 const SHORT root, const REAL tiny, INT *nperturb)
+ *
+ * \brief Partial LU factorization of a dense front F (column-major, m x m) with
+ *        K fully summed rows and columns: F11 = L11*U11, L21 = F21*inv(U11),
+ *        U12 = inv(L11)*F12, F22 = F22 - L21*U12
+ *
+ * \param m         Size of the front
+ * \param K         Number of fully summed rows and columns
+ * \param F         Front (IN: assembled, OUT: factors and Schur complement)
+ * \param rows      Row indices of the front (permuted as the rows of F, OUTPUT)
+ * \param cols      Column indices of the front (permuted as the columns of F, OUTPUT)
+ * \param root      1 if the front has no parent: every pivot must be eliminated
+ * \param tiny      Pivots smaller than tiny are delayed, or replaced by +-tiny in a root
+ * \param nperturb  Number of perturbed pivots (OUTPUT, incremented)
+ *
+ * \return          Number of pivots e; the rows and columns e,...,K-1 are delayed
+ *
+ * \note The pivot of a column is the largest entry in the fully summed rows and
+ *       is accepted if it is at least DIRECT_PIVOT_TOL times the largest entry of
+ *       the whole column. Columns without an acceptable pivot are moved behind
+ *       the pivots and are eliminated in the parent front.
+ */
+static INT direct_front_lu(const INT m,
+                           const INT K,
+                           REAL *F,
+                           INT *rows,
+                           INT *cols,
+                           const SHORT root,
+                           const REAL tiny,
+                           INT *nperturb)
+{
+  INT i, j, p, r, e = K;
+  REAL d, t, amax, *Fp;
+
+  // panel [F11; F21]
+  for (p=0; p<e; ) {
+    Fp = F + p*m;
+    r = p;
+    for (i=p+1; i<K; ++i) if (ABS(Fp[i]) > ABS(Fp[r])) r = i;
+    amax = ABS(Fp[r]);
+    for (i=K; i<m; ++i) amax = MAX(amax, ABS(Fp[i]));
+
+    if (!root && (ABS(Fp[r]) < tiny || ABS(Fp[r]) < DIRECT_PIVOT_TOL*amax)) {
+      // delay the column
+      --e;
+      if (p < e) {
+        REAL *Fe = F + e*m;
+        for (i=0; i<m; ++i) { t = Fp[i]; Fp[i] = Fe[i]; Fe[i] = t; }
+        j = cols[p]; cols[p] = cols[e]; cols[e] = j;
+      }
+      continue;
+    }
+
+    if (r != p) {
+      for (j=0; j<m; ++j) { t = F[p+j*m]; F[p+j*m] = F[r+j*m]; F[r+j*m] = t; }
+      j = rows[p]; rows[p] = rows[r]; rows[r] = j;
+    }
+    d = Fp[p];
+    if (ABS(d) < tiny) {
+      d = (d < 0.0) ? -tiny : tiny;
+      Fp[p] = d;
+      (*nperturb)++;
+    }
+    for (i=p+1; i<m; ++i) Fp[i] /= d;
+    for (j=p+1; j<K; ++j) {
+      t = F[p+j*m];
+      if (t != 0.0) for (i=p+1; i<m; ++i) F[i+j*m] -= Fp[i]*t;
+    }
+    ++p;
+  }
+
+  // U12 = inv(L11)*F12 and F22 = F22 - L21*U12 (the delayed columns are done)
+#ifdef _OPENMP
+#pragma omp parallel for private(i,p,t) if((REAL)(m-K)*e*(m-K) > 65536.0)
 #endif
+  for (j=K; j<m; ++j) {
+    REAL *Fj = F + j*m;
+    for (p=0; p<e; ++p) {
+      t = Fj[p];
+      if (t == 0.0) continue;
+      for (i=p+1; i<m; ++i) Fj[i] -= F[i+p*m]*t;
+    }
+  }
+
+  return e;
+}
+
+/***********************************************************************************************/
+/**
+ * \fn static SHORT direct_front_chol (const INT m, const INT k, REAL *F)
+ *
+ * \brief Partial Cholesky factorization of a dense front F (column-major, m x m,
+ *        lower triangle used) with k fully summed variables:
+ *        F11 = L11*L11^T, L21 = F21*inv(L11^T), F22 = F22 - L21*L21^T
+ *
+ * \param m         Size of the front
+ * \param k         Number of pivots
+ * \param F         Front (IN: assembled, OUT: factors and Schur complement)
+ *
+ * \return          SUCCESS, or ERROR_MISC if a pivot is not positive
+ *
+ */
+static SHORT direct_front_chol(const INT m,
+                               const INT k,
+                               REAL *F)
+{
+  INT i, j, p, pb, pe;
+  REAL d, t, *Fp;
+
+  for (pb=0; pb<k; pb+=DIRECT_BLOCK) {
+    pe = MIN(pb+DIRECT_BLOCK, k);
+
+    // panel [F11; F21] of the pivots pb..pe-1
+    for (p=pb; p<pe; ++p) {
+      Fp = F + p*m;
+      d = Fp[p];
+      if (!(d > 0.0)) return ERROR_MISC;
+      d = sqrt(d);
+      Fp[p] = d;
+      for (i=p+1; i<m; ++i) Fp[i] /= d;
+      for (j=p+1; j<pe; ++j) {
+        t = Fp[j];
+        if (t != 0.0) for (i=j; i<m; ++i) F[i+j*m] -= Fp[i]*t;
+      }
+    }
+
+    // trailing columns (remaining pivots and F22): F = F - L(:,pb:pe)*L(:,pb:pe)^T,
+    // lower triangle, four pivots at a time
+#ifdef _OPENMP
+#pragma omp parallel for private(i,p,t) if((REAL)(m-pe)*(pe-pb)*(m-pe) > 131072.0)
+#endif
+    for (j=pe; j<m; ++j) {
+      REAL *Fj = F + j*m;
+      for (p=pb; p+3<pe; p+=4) {
+        const REAL *L0 = F+p*m, *L1 = L0+m, *L2 = L1+m, *L3 = L2+m;
+        const REAL t0 = L0[j], t1 = L1[j], t2 = L2[j], t3 = L3[j];
+        if (t0 == 0.0 && t1 == 0.0 && t2 == 0.0 && t3 == 0.0) continue;
+        for (i=j; i<m; ++i) Fj[i] -= L0[i]*t0 + L1[i]*t1 + L2[i]*t2 + L3[i]*t3;
+      }
+      for (; p<pe; ++p) {
+        t = F[j+p*m];
+        if (t == 0.0) continue;
+        for (i=j; i<m; ++i) Fj[i] -= F[i+p*m]*t;
+      }
+    }
+  }
+
+  return SUCCESS;
+}
+
+/***********************************************************************************************/
+/**
+ * \fn static SHORT direct_numeric_chol (dCSRmat *A, LU_data *lu)
+ *
+ * \brief Multifrontal Cholesky factorization on the supernodal elimination tree
+ *
+ * \param A    Pointer to the dCSRmat matrix
+ * \param lu   Pointer to the LU data (symbolic part given, numeric part OUTPUT)
+ *
+ * \return     SUCCESS, or ERROR_MISC if a pivot is not positive
+ *
+ */
+static SHORT direct_numeric_chol(dCSRmat *A,
+                                 LU_data *lu)
+{
+  const INT n = lu->row, nsuper = lu->nsuper;
+  const INT *perm = lu->perm, *iperm = lu->iperm;
+  const INT *super = lu->super, *sIA = lu->sIA, *sJA = lu->sJA;
+  INT s, c, f, k, m, mc, kc, i, jj, ii, col, maxm = 0;
+  INT *map, *head, *next;
+  const INT *rows, *crows;
+  REAL *F, *cb;
+  REAL **CB;
+  SHORT status = SUCCESS;
+
+  for (s=0; s<nsuper; ++s) maxm = MAX(maxm, sIA[s+1]-sIA[s]);
+
+  map  = (INT *)calloc(MAX(n,1), sizeof(INT));
+  head = (INT *)calloc(MAX(nsuper,1), sizeof(INT));
+  next = (INT *)calloc(MAX(nsuper,1), sizeof(INT));
+  CB   = (REAL **)calloc(MAX(nsuper,1), sizeof(REAL *));
+  F    = (REAL *)calloc(MAX(maxm*maxm,1), sizeof(REAL));
+
+  for (s=0; s<nsuper; ++s) head[s] = -1;
+  for (s=nsuper-1; s>=0; --s) {
+    if (lu->sparent[s] == -1) continue;
+    next[s] = head[lu->sparent[s]];
+    head[lu->sparent[s]] = s;
+  }
+
+  for (s=0; s<nsuper; ++s) {
+
+    f = super[s]; k = super[s+1]-f;
+    rows = sJA + sIA[s]; m = sIA[s+1]-sIA[s];
+
+    for (i=0; i<m; ++i) map[rows[i]] = i;
+    array_set(m*m, F, 0.0);
+
+    // assemble the entries of A: F(i,jj), i >= f
+    for (jj=0; jj<k; ++jj) {
+      col = perm[f+jj];
+      for (c=lu->cIA[col]; c<lu->cIA[col+1]; ++c) {
+        i = iperm[lu->cJA[c]];
+        if (i >= f) F[map[i]+jj*m] += A->val[lu->cmap[c]];
+      }
+    }
+
+    // extend-add the contribution blocks of the children
+    for (c=head[s]; c!=-1; c=next[c]) {
+      kc = super[c+1]-super[c];
+      mc = sIA[c+1]-sIA[c]-kc;
+      crows = sJA + sIA[c] + kc;
+      cb = CB[c];
+      for (jj=0; jj<mc; ++jj) {
+        col = map[crows[jj]]*m;
+        for (ii=jj; ii<mc; ++ii)
+          F[map[crows[ii]]+col] += cb[ii+jj*mc];
+      }
+      free(cb); CB[c] = NULL;
+    }
+
+    // partial factorization of the front
+    status = direct_front_chol(m, k, F);
+    if (status < 0) break;
+
+    // store the factors
+    array_cp(m*k, F, lu->Lx + lu->Lptr[s]);
+
+    // contribution block for the parent
+    if (m > k) {
+      mc = m-k;
+      cb = (REAL *)calloc(mc*mc, sizeof(REAL));
+      for (jj=0; jj<mc; ++jj) array_cp(mc, F+k+(k+jj)*m, cb+jj*mc);
+      CB[s] = cb;
+    }
+
+    for (i=0; i<m; ++i) map[rows[i]] = -1;
+  }
+
+  for (s=0; s<nsuper; ++s) if (CB[s]) free(CB[s]);
+  free(CB);
+  free(F);
+  free(map);
+  free(head);
+  free(next);
+
+  return status;
+}
+
+/***********************************************************************************************/
+/**
+ * \fn static SHORT direct_numeric_lu (dCSRmat *A, LU_data *lu)
+ *
+ * \brief Multifrontal LU factorization on the supernodal elimination tree with
+ *        threshold pivoting; the pivots a front cannot take are delayed to its
+ *        parent, whose front then also has the delayed rows and columns
+ *
+ * \param A    Pointer to the dCSRmat matrix
+ * \param lu   Pointer to the LU data (symbolic part given, numeric part OUTPUT)
+ *
+ * \return     SUCCESS
+ *
+ */
+static SHORT direct_numeric_lu(dCSRmat *A,
+                               LU_data *lu)
+{
+  const INT n = lu->row, nsuper = lu->nsuper;
+  const INT *perm = lu->perm, *iperm = lu->iperm;
+  const INT *super = lu->super, *sIA = lu->sIA, *sJA = lu->sJA;
+  INT s, c, f, k, m, nd, e, mc, ec, i, j, jj, ii, col;
+  INT Fcap, Icap, Lcap, Ucap;
+  INT *rpos, *cpos, *head, *next, *ndel, *rows, *cols;
+  const INT *crows, *ccols;
+  REAL tiny, *F, *cb;
+  REAL **CB;
+
+  tiny = 1e-14*MAX(lu->anorm, SMALLREAL);
+
+  rpos = (INT *)calloc(MAX(n,1), sizeof(INT));
+  cpos = (INT *)calloc(MAX(n,1), sizeof(INT));
+  head = (INT *)calloc(MAX(nsuper,1), sizeof(INT));
+  next = (INT *)calloc(MAX(nsuper,1), sizeof(INT));
+  ndel = (INT *)calloc(MAX(nsuper,1), sizeof(INT));
+  CB   = (REAL **)calloc(MAX(nsuper,1), sizeof(REAL *));
+
+  // start from the sizes without delayed pivots
+  Fcap = 1;
+  for (s=0; s<nsuper; ++s) Fcap = MAX(Fcap, (sIA[s+1]-sIA[s])*(sIA[s+1]-sIA[s]));
+  Icap = MAX(sIA[nsuper],1);
+  Lcap = MAX(lu->Lptr[nsuper],1);
+  Ucap = MAX(lu->Uptr[nsuper],1);
+  F       = (REAL *)calloc(Fcap, sizeof(REAL));
+  lu->frow = (INT *)calloc(Icap, sizeof(INT));
+  lu->fcol = (INT *)calloc(Icap, sizeof(INT));
+  lu->Lx   = (REAL *)calloc(Lcap, sizeof(REAL));
+  lu->Ux   = (REAL *)calloc(Ucap, sizeof(REAL));
+  lu->npiv  = (INT *)calloc(MAX(nsuper,1), sizeof(INT));
+  lu->fptr  = (INT *)calloc(nsuper+1, sizeof(INT));
+  lu->fLptr = (INT *)calloc(nsuper+1, sizeof(INT));
+  lu->fUptr = (INT *)calloc(nsuper+1, sizeof(INT));
+
+  for (i=0; i<n; ++i) { rpos[i] = -1; cpos[i] = -1; }
+  for (s=0; s<nsuper; ++s) head[s] = -1;
+  for (s=nsuper-1; s>=0; --s) {
+    if (lu->sparent[s] == -1) continue;
+    next[s] = head[lu->sparent[s]];
+    head[lu->sparent[s]] = s;
+  }
+
+  lu->nperturb = 0;
+  lu->ndelay = 0;
+
+  for (s=0; s<nsuper; ++s) {
+
+    f = super[s]; k = super[s+1]-f;
+
+    // rows and columns: delayed pivots of the children, then the supernode structure
+    nd = 0;
+    for (c=head[s]; c!=-1; c=next[c]) nd += ndel[c];
+    m = nd + sIA[s+1]-sIA[s];
+
+    if (lu->fptr[s]+m > Icap) {
+      Icap = MAX(2*Icap, lu->fptr[s]+m);
+      lu->frow = (INT *)realloc(lu->frow, Icap*sizeof(INT));
+      lu->fcol = (INT *)realloc(lu->fcol, Icap*sizeof(INT));
+    }
+    rows = lu->frow + lu->fptr[s];
+    cols = lu->fcol + lu->fptr[s];
+    lu->fptr[s+1] = lu->fptr[s] + m;
+
+    nd = 0;
+    for (c=head[s]; c!=-1; c=next[c]) {
+      ec = lu->npiv[c];
+      iarray_cp(ndel[c], lu->frow+lu->fptr[c]+ec, rows+nd);
+      iarray_cp(ndel[c], lu->fcol+lu->fptr[c]+ec, cols+nd);
+      nd += ndel[c];
+    }
+    for (i=nd; i<m; ++i) { rows[i] = sJA[sIA[s]+i-nd]; cols[i] = rows[i]; }
+    for (i=0; i<m; ++i) { rpos[rows[i]] = i; cpos[cols[i]] = i; }
+
+    if (m*m > Fcap) {
+      Fcap = MAX(2*Fcap, m*m);
+      free(F);
+      F = (REAL *)calloc(Fcap, sizeof(REAL));
+    }
+    array_set(m*m, F, 0.0);
+
+    // assemble the entries of A
+    for (jj=0; jj<k; ++jj) {
+      col = perm[f+jj];
+      // column part: F(i,nd+jj), i >= f
+      for (c=lu->cIA[col]; c<lu->cIA[col+1]; ++c) {
+        i = iperm[lu->cJA[c]];
+        if (i >= f) F[rpos[i]+(nd+jj)*m] += A->val[lu->cmap[c]];
+      }
+      // row part: F(nd+jj,j), j beyond the supernode
+      for (c=A->IA[col]; c<A->IA[col+1]; ++c) {
+        j = iperm[A->JA[c]];
+        if (j >= f+k) F[nd+jj+cpos[j]*m] += A->val[c];
+      }
+    }
+
+    // extend-add the contribution blocks of the children
+    for (c=head[s]; c!=-1; c=next[c]) {
+      ec = lu->npiv[c];
+      mc = lu->fptr[c+1]-lu->fptr[c]-ec;
+      crows = lu->frow + lu->fptr[c] + ec;
+      ccols = lu->fcol + lu->fptr[c] + ec;
+      cb = CB[c];
+      for (jj=0; jj<mc; ++jj) {
+        col = cpos[ccols[jj]]*m;
+        for (ii=0; ii<mc; ++ii)
+          F[rpos[crows[ii]]+col] += cb[ii+jj*mc];
+      }
+      free(cb); CB[c] = NULL;
+    }
+
+    // partial factorization of the front
+    e = direct_front_lu(m, nd+k, F, rows, cols, (lu->sparent[s] == -1),
+                        tiny, &lu->nperturb);
+    lu->npiv[s] = e;
+    ndel[s] = nd+k-e;
+    lu->ndelay += ndel[s];
+
+    // store the factors
+    lu->fLptr[s+1] = lu->fLptr[s] + m*e;
+    lu->fUptr[s+1] = lu->fUptr[s] + e*(m-e);
+    if (lu->fLptr[s+1] > Lcap) {
+      Lcap = MAX(2*Lcap, lu->fLptr[s+1]);
+      lu->Lx = (REAL *)realloc(lu->Lx, Lcap*sizeof(REAL));
+    }
+    if (lu->fUptr[s+1] > Ucap) {
+      Ucap = MAX(2*Ucap, lu->fUptr[s+1]);
+      lu->Ux = (REAL *)realloc(lu->Ux, Ucap*sizeof(REAL));
+    }
+    array_cp(m*e, F, lu->Lx + lu->fLptr[s]);
+    for (j=e; j<m; ++j) array_cp(e, F+j*m, lu->Ux + lu->fUptr[s] + (j-e)*e);
+
+    // contribution block (with the delayed pivots) for the parent
+    if (m > e) {
+      mc = m-e;
+      cb = (REAL *)calloc(mc*mc, sizeof(REAL));
+      for (j=0; j<mc; ++j) array_cp(mc, F+e+(e+j)*m, cb+j*mc);
+      CB[s] = cb;
+    }
+
+    for (i=0; i<m; ++i) { rpos[rows[i]] = -1; cpos[cols[i]] = -1; }
+  }
+
+  for (s=0; s<nsuper; ++s) if (CB[s]) free(CB[s]);
+  free(CB);
+  free(F);
+  free(rpos);
+  free(cpos);
+  free(head);
+  free(next);
+  free(ndel);
+
+  return SUCCESS;
+}
+
+/***********************************************************************************************/
+/**
+ * \fn static void direct_axpy (const INT n, const REAL a, const REAL *x, REAL *y)
+ *
+ * \brief y = y + a*x for short arrays (the right hand sides of one row in the solve)
+ *
+ */
+static void direct_axpy(const INT n,
+                        const REAL a,
+                        const REAL *x,
+                        REAL *y)
+{
+  INT r;
+  for (r=0; r<n; ++r) y[r] += a*x[r];
+}
+
+/***********************************************************************************************/
+/**
+ * \fn static void direct_ax (const INT n, const REAL a, REAL *x)
+ *
+ * \brief x = a*x for short arrays
+ *
+ */
+static void direct_ax(const INT n,
+                      const REAL a,
+                      REAL *x)
+{
+  INT r;
+  for (r=0; r<n; ++r) x[r] *= a;
+}
+
+/***********************************************************************************************/
+/**
+ * \fn static void direct_sweep (LU_data *lu, const INT nrhs, REAL *y, REAL *x)
+ *
+ * \brief Forward and backward substitution with the factors for nrhs right hand
+ *        sides, in the permuted numbering and stored by rows
+ *
+ * \param lu     Pointer to the LU data
+ * \param nrhs   Number of right hand sides
+ * \param y      Right hand sides (destroyed)
+ * \param x      Solutions (OUTPUT)
+ *
+ */
+static void direct_sweep(LU_data *lu,
+                         const INT nrhs,
+                         REAL *y,
+                         REAL *x)
+{
+  INT s, f, k, m, e, i, p;
+  const INT *rows, *cols;
+  REAL *L, *U, *yi, *yp, t;
+
+  if (lu->sym) {
+    // forward substitution
+    for (s=0; s<lu->nsuper; ++s) {
+      f = lu->super[s]; k = lu->super[s+1]-f;
+      rows = lu->sJA + lu->sIA[s]; m = lu->sIA[s+1]-lu->sIA[s];
+      L = lu->Lx + lu->Lptr[s];
+      for (p=0; p<k; ++p) {
+        yp = y+(f+p)*nrhs;
+        direct_ax(nrhs, 1.0/L[p+p*m], yp);
+        for (i=p+1; i<m; ++i) direct_axpy(nrhs, -L[i+p*m], yp, y+rows[i]*nrhs);
+      }
+    }
+    // backward substitution
+    for (s=lu->nsuper-1; s>=0; --s) {
+      f = lu->super[s]; k = lu->super[s+1]-f;
+      rows = lu->sJA + lu->sIA[s]; m = lu->sIA[s+1]-lu->sIA[s];
+      L = lu->Lx + lu->Lptr[s];
+      for (p=k-1; p>=0; --p) {
+        yp = y+(f+p)*nrhs;
+        for (i=p+1; i<m; ++i) direct_axpy(nrhs, -L[i+p*m], y+rows[i]*nrhs, yp);
+        direct_ax(nrhs, 1.0/L[p+p*m], yp);
+      }
+    }
+    array_cp(lu->row*nrhs, y, x);
+    return;
+  }
+
+  // forward substitution with the unit lower triangular factor (by rows of the fronts)
+  for (s=0; s<lu->nsuper; ++s) {
+    e = lu->npiv[s];
+    rows = lu->frow + lu->fptr[s]; m = lu->fptr[s+1]-lu->fptr[s];
+    L = lu->Lx + lu->fLptr[s];
+    for (p=0; p<e; ++p) {
+      yp = y+rows[p]*nrhs;
+      for (i=p+1; i<m; ++i) direct_axpy(nrhs, -L[i+p*m], yp, y+rows[i]*nrhs);
+    }
+  }
+
+  // backward substitution with the upper triangular factor (unknowns are the columns)
+  for (s=lu->nsuper-1; s>=0; --s) {
+    e = lu->npiv[s];
+    rows = lu->frow + lu->fptr[s]; cols = lu->fcol + lu->fptr[s];
+    m = lu->fptr[s+1]-lu->fptr[s];
+    L = lu->Lx + lu->fLptr[s];
+    U = lu->Ux + lu->fUptr[s];
+    for (i=e; i<m; ++i) {
+      yi = x+cols[i]*nrhs;
+      for (p=0; p<e; ++p) {
+        t = U[(i-e)*e+p];
+        if (t != 0.0) direct_axpy(nrhs, -t, yi, y+rows[p]*nrhs);
+      }
+    }
+    for (p=e-1; p>=0; --p) {
+      yp = y+rows[p]*nrhs;
+      direct_ax(nrhs, 1.0/L[p+p*m], yp);
+      for (i=0; i<p; ++i) direct_axpy(nrhs, -L[i+p*m], yp, y+rows[i]*nrhs);
+      array_cp(nrhs, yp, x+cols[p]*nrhs);
+    }
+  }
+}
+
+/***********************************************************************************************/
+/**
+ * \fn static REAL direct_residual (LU_data *lu, const INT nrhs, REAL *b, REAL *x,
+ *                                  REAL *r, REAL *w)
+ *
+ * \brief Residual r = b - A*x in the permuted numbering (A is lu->Aval) and the
+ *        componentwise backward error of x
+ *
+ * \param lu     Pointer to the LU data
+ * \param nrhs   Number of right hand sides
+ * \param b      Right hand sides (stored by rows)
+ * \param x      Solutions (stored by rows)
+ * \param r      Residuals (OUTPUT)
+ * \param w      Work space of size row*nrhs
+ *
+ * \return       Componentwise backward error max_i |r_i|/(|A||x|+|b|)_i
+ *
+ */
+static REAL direct_residual(LU_data *lu,
+                            const INT nrhs,
+                            REAL *b,
+                            REAL *x,
+                            REAL *r,
+                            REAL *w)
+{
+  const INT n = lu->row;
+  INT i, j, jc, c, q;
+  REAL a, berr = 0.0;
+
+  array_cp(n*nrhs, b, r);
+  for (q=0; q<n*nrhs; ++q) w[q] = ABS(b[q]);
+  for (jc=0; jc<n; ++jc) {
+    j = lu->iperm[jc]*nrhs;
+    for (c=lu->cIA[jc]; c<lu->cIA[jc+1]; ++c) {
+      i = lu->iperm[lu->cJA[c]]*nrhs;
+      a = lu->Aval[lu->cmap[c]];
+      for (q=0; q<nrhs; ++q) { r[i+q] -= a*x[j+q]; w[i+q] += ABS(a*x[j+q]); }
+    }
+  }
+  for (q=0; q<n*nrhs; ++q) if (w[q] > 0.0) berr = MAX(berr, ABS(r[q])/w[q]);
+
+  return berr;
+}
+
+/*---------------------------------*/
+/*--      Public Functions       --*/
+/*---------------------------------*/
+/***********************************************************************************************/
+/**
+ * \fn SHORT direct_symbolic (dCSRmat *A, LU_data *lu, const SHORT prtlvl)
+ *
+ * \brief Symbolic analysis for the native sparse direct solver: nested
+ *        dissection ordering, elimination tree, relaxed supernodes and their row
+ *        structures (depends only on the sparsity pattern of A)
+ *
+ * \param A        Pointer to the dCSRmat matrix (square, 0-based)
+ * \param lu       Pointer to the LU data (OUTPUT)
+ * \param prtlvl   Print level
+ *
+ * \return         SUCCESS if succeed; ERROR otherwise
+ *
+ */
+SHORT direct_symbolic(dCSRmat *A,
+                      LU_data *lu,
+                      const SHORT prtlvl)
+{
+  const INT n = A->row;
+  INT i, j, k, p, s, f, l, pos, nsuper, nz, cap;
+  INT *gia, *gja, *parent, *post, *work, *count, *nchild, *snode, *mark, *head, *next;
+  INT *rep, *ncol, *lnz, ns;
+  REAL *zeros, z, tot;
+  REAL setup_start, setup_end;
+
+  if (A->row != A->col) {
+    printf("### ERROR HAZMATH DANGER: %s: direct solver needs a square matrix!\n", __FUNCTION__);
+    return ERROR_MAT_SIZE;
+  }
+
+  get_time(&setup_start);
+
+  LU_data_free(lu);
+  lu->row = n;
+  lu->nnz = A->nnz;
+
+  // fill-reducing ordering
+  direct_sym_graph(A, &gia, &gja);
+  lu->perm  = (INT *)calloc(MAX(n,1), sizeof(INT));
+  lu->iperm = (INT *)calloc(MAX(n,1), sizeof(INT));
+  work = (INT *)calloc(MAX(n,1), sizeof(INT));
+  mark = (INT *)calloc(MAX(n,1), sizeof(INT));
+  for (i=0; i<n; ++i) { mark[i] = -1; work[i] = i; }
+  pos = 0;
+  direct_nd_order(gia, gja, work, n, lu->perm, &pos, mark);
+  for (i=0; i<n; ++i) lu->iperm[lu->perm[i]] = i;
+
+  // elimination tree, postordered (same fill, subtrees are contiguous)
+  parent = (INT *)calloc(MAX(n,1), sizeof(INT));
+  post   = (INT *)calloc(MAX(n,1), sizeof(INT));
+  direct_etree(n, gia, gja, lu->perm, lu->iperm, parent);
+  direct_postorder(n, parent, post);
+  for (i=0; i<n; ++i) work[i] = lu->perm[post[i]];
+  iarray_cp(n, work, lu->perm);
+  for (i=0; i<n; ++i) lu->iperm[lu->perm[i]] = i;
+  direct_etree(n, gia, gja, lu->perm, lu->iperm, parent);
+
+  // column counts of L (row subtrees)
+  count  = (INT *)calloc(MAX(n,1), sizeof(INT));
+  nchild = (INT *)calloc(MAX(n,1), sizeof(INT));
+  for (i=0; i<n; ++i) { mark[i] = -1; count[i] = 1; }
+  for (i=0; i<n; ++i) {
+    mark[i] = i;
+    for (p=gia[lu->perm[i]]; p<gia[lu->perm[i]+1]; ++p) {
+      for (j=lu->iperm[gja[p]]; j<i && mark[j]!=i; j=parent[j]) {
+        count[j]++; mark[j] = i;
+      }
+    }
+    if (parent[i] != -1) nchild[parent[i]]++;
+  }
+
+  // fundamental supernodes
+  snode = (INT *)calloc(MAX(n,1), sizeof(INT));
+  lu->super = (INT *)calloc(n+1, sizeof(INT));
+  nsuper = 0;
+  for (j=0; j<n; ++j) {
+    if (j == 0 || !(parent[j-1] == j && nchild[j] == 1 && count[j-1] == count[j]+1))
+      lu->super[nsuper++] = j;
+    snode[j] = nsuper-1;
+  }
+  lu->super[nsuper] = n;
+
+  // relaxed amalgamation: merge a supernode into the next one if that is its
+  // parent and the explicit zeros of the merged supernode stay small
+  rep   = (INT *)calloc(MAX(nsuper,1), sizeof(INT));
+  ncol  = (INT *)calloc(MAX(nsuper,1), sizeof(INT));
+  lnz   = (INT *)calloc(MAX(nsuper,1), sizeof(INT));
+  zeros = (REAL *)calloc(MAX(nsuper,1), sizeof(REAL));
+  for (s=0; s<nsuper; ++s) {
+    rep[s]  = s;
+    ncol[s] = lu->super[s+1]-lu->super[s];
+    lnz[s]  = count[lu->super[s]];
+  }
+  for (s=nsuper-2; s>=0; --s) {
+    if (parent[lu->super[s+1]-1] != lu->super[s+1]) continue;
+    for (p=s+1; rep[p]!=p; p=rep[p]);
+    ns = ncol[s]+ncol[p];
+    // each column of s gets the rows of the first column of p
+    z   = zeros[s] + zeros[p] + (REAL)ncol[s]*(ncol[s]+lnz[p]-lnz[s]);
+    tot = 0.5*(REAL)ns*(ns+1) + (REAL)ns*(lnz[p]-ncol[p]);
+    if (ns <= DIRECT_NRELAX0 ||
+        (ns <= DIRECT_NRELAX1 && z < DIRECT_ZRELAX0*tot) ||
+        (ns <= DIRECT_NRELAX2 && z < DIRECT_ZRELAX1*tot) ||
+        z < DIRECT_ZRELAX2*tot) {
+      rep[s]   = p;
+      ncol[p]  = ns;
+      lnz[p]   = ncol[s]+lnz[p];
+      zeros[p] = z;
+    }
+  }
+  k = 0;
+  for (s=0; s<nsuper; ++s) {
+    if (s == 0 || rep[s-1] == s-1) lu->super[k++] = lu->super[s];
+  }
+  nsuper = k;
+  lu->super[nsuper] = n;
+  for (s=0; s<nsuper; ++s) {
+    for (j=lu->super[s]; j<lu->super[s+1]; ++j) snode[j] = s;
+  }
+  lu->nsuper = nsuper;
+  free(rep); free(ncol); free(lnz); free(zeros);
+
+  // supernodal elimination tree
+  lu->sparent = (INT *)calloc(MAX(nsuper,1), sizeof(INT));
+  head = (INT *)calloc(MAX(nsuper,1), sizeof(INT));
+  next = (INT *)calloc(MAX(nsuper,1), sizeof(INT));
+  for (s=0; s<nsuper; ++s) {
+    l = lu->super[s+1]-1;
+    lu->sparent[s] = (parent[l] == -1) ? -1 : snode[parent[l]];
+    head[s] = -1;
+  }
+  for (s=nsuper-1; s>=0; --s) {
+    if (lu->sparent[s] == -1) continue;
+    next[s] = head[lu->sparent[s]];
+    head[lu->sparent[s]] = s;
+  }
+
+  // row structures: pivots, then the rows of A and of the children below the supernode
+  lu->sIA  = (INT *)calloc(nsuper+1, sizeof(INT));
+  lu->Lptr = (INT *)calloc(nsuper+1, sizeof(INT));
+  lu->Uptr = (INT *)calloc(nsuper+1, sizeof(INT));
+  cap = 0;
+  for (s=0; s<nsuper; ++s) cap += count[lu->super[s]];
+  cap = MAX(cap,1);
+  lu->sJA = (INT *)calloc(cap, sizeof(INT));
+
+  for (i=0; i<n; ++i) mark[i] = -1;
+  nz = 0;
+  for (s=0; s<nsuper; ++s) {
+    f = lu->super[s]; l = lu->super[s+1]-1;
+    lu->sIA[s] = nz;
+    for (j=f; j<=l; ++j) { work[j-f] = j; mark[j] = s; }
+    pos = l-f+1;
+    for (j=f; j<=l; ++j) {
+      for (k=gia[lu->perm[j]]; k<gia[lu->perm[j]+1]; ++k) {
+        i = lu->iperm[gja[k]];
+        if (i > l && mark[i] != s) { mark[i] = s; work[pos++] = i; }
+      }
+    }
+    for (p=head[s]; p!=-1; p=next[p]) {
+      for (k=lu->sIA[p]+lu->super[p+1]-lu->super[p]; k<lu->sIA[p+1]; ++k) {
+        i = lu->sJA[k];
+        if (i > l && mark[i] != s) { mark[i] = s; work[pos++] = i; }
+      }
+    }
+    qsort(work+(l-f+1), pos-(l-f+1), sizeof(INT), direct_icmp);
+
+    if (nz+pos > cap) {
+      cap = MAX(2*cap, nz+pos);
+      lu->sJA = (INT *)realloc(lu->sJA, cap*sizeof(INT));
+    }
+    iarray_cp(pos, work, lu->sJA+nz);
+    nz += pos;
+    lu->sIA[s+1]  = nz;
+    lu->Lptr[s+1] = lu->Lptr[s] + pos*(l-f+1);
+    lu->Uptr[s+1] = lu->Uptr[s] + (pos-(l-f+1))*(l-f+1);
+  }
+
+  // CSC view of A for assembling the fronts
+  lu->cIA  = (INT *)calloc(n+1, sizeof(INT));
+  lu->cJA  = (INT *)calloc(MAX(A->nnz,1), sizeof(INT));
+  lu->cmap = (INT *)calloc(MAX(A->nnz,1), sizeof(INT));
+  for (k=0; k<A->nnz; ++k) lu->cIA[A->JA[k]+1]++;
+  for (i=0; i<n; ++i) lu->cIA[i+1] += lu->cIA[i];
+  iarray_cp(n, lu->cIA, work);
+  for (i=0; i<n; ++i) {
+    for (k=A->IA[i]; k<A->IA[i+1]; ++k) {
+      p = work[A->JA[k]]++;
+      lu->cJA[p]  = i;
+      lu->cmap[p] = k;
+    }
+  }
+
+  free(count); free(nchild); free(snode); free(parent); free(post);
+  free(head); free(next); free(work); free(mark);
+  free(gia); free(gja);
+
+  get_time(&setup_end);
+
+  if ( prtlvl > PRINT_MIN ) {
+    printf("Direct solver: n = %d, supernodes = %d, nnz(L) = %d\n",
+       n, nsuper, lu->Lptr[nsuper]);
+    print_cputime("Direct solver symbolic", setup_end - setup_start);
+  }
+
+  return SUCCESS;
+}
+
+/***********************************************************************************************/
+/**
+ * \fn SHORT direct_numeric (dCSRmat *A, LU_data *lu, const SHORT prtlvl)
+ *
+ * \brief Numeric factorization for the native sparse direct solver
+ *
+ * \param A        Pointer to the dCSRmat matrix (same pattern as in direct_symbolic)
+ * \param lu       Pointer to the LU data (symbolic part given, numeric part OUTPUT)
+ * \param prtlvl   Print level
+ *
+ * \return         SUCCESS if succeed; ERROR otherwise
+ *
+ * \note Numerically symmetric matrices are factorized by Cholesky first; LU with
+ *       threshold pivoting and delayed pivots is used otherwise, or if Cholesky
+ *       breaks down. Pivots which are still tiny in a root front are perturbed
+ *       (counted in lu->nperturb); the LU solve then relies on the iterative
+ *       refinement in direct_solve_nrhs and fails if it does not converge.
+ */
+SHORT direct_numeric(dCSRmat *A,
+                     LU_data *lu,
+                     const SHORT prtlvl)
+{
+  const INT n = lu->row;
+  INT i, k, c;
+  INT *mark;
+  REAL *w, tol, rsum;
+  SHORT status = SUCCESS;
+  REAL setup_start, setup_end;
+
+  if (A->row != n || A->nnz != lu->nnz) {
+    printf("### ERROR HAZMATH DANGER: %s: pattern differs from the symbolic analysis!\n", __FUNCTION__);
+    return ERROR_MAT_SIZE;
+  }
+
+  get_time(&setup_start);
+
+  // numerical symmetry: compare row i with column i
+  lu->sym = 1;
+  mark = (INT *)calloc(MAX(n,1), sizeof(INT));
+  w    = (REAL *)calloc(MAX(n,1), sizeof(REAL));
+  for (i=0; i<n; ++i) mark[i] = -1;
+  for (i=0; i<n && lu->sym; ++i) {
+    if (A->IA[i+1]-A->IA[i] != lu->cIA[i+1]-lu->cIA[i]) { lu->sym = 0; break; }
+    for (k=A->IA[i]; k<A->IA[i+1]; ++k) { mark[A->JA[k]] = i; w[A->JA[k]] = A->val[k]; }
+    for (c=lu->cIA[i]; c<lu->cIA[i+1]; ++c) {
+      k = lu->cJA[c];
+      tol = 1e-12*(ABS(w[k]) + ABS(A->val[lu->cmap[c]]));
+      if (mark[k] != i || ABS(w[k] - A->val[lu->cmap[c]]) > tol) { lu->sym = 0; break; }
+    }
+  }
+  free(mark);
+  free(w);
+
+  lu->anorm = 0.0;
+  for (i=0; i<n; ++i) {
+    rsum = 0.0;
+    for (k=A->IA[i]; k<A->IA[i+1]; ++k) rsum += ABS(A->val[k]);
+    lu->anorm = MAX(lu->anorm, rsum);
+  }
+
+  if (lu->Lx) free(lu->Lx);
+  if (lu->Ux) free(lu->Ux);
+  if (lu->npiv) free(lu->npiv);
+  if (lu->fptr) free(lu->fptr);
+  if (lu->frow) free(lu->frow);
+  if (lu->fcol) free(lu->fcol);
+  if (lu->fLptr) free(lu->fLptr);
+  if (lu->fUptr) free(lu->fUptr);
+  if (lu->Aval) free(lu->Aval);
+  lu->Lx = NULL; lu->Ux = NULL; lu->npiv = NULL; lu->fptr = NULL;
+  lu->frow = NULL; lu->fcol = NULL; lu->fLptr = NULL; lu->fUptr = NULL; lu->Aval = NULL;
+  lu->nperturb = 0; lu->ndelay = 0;
+
+  if (lu->sym) {
+    lu->Lx = (REAL *)calloc(MAX(lu->Lptr[lu->nsuper],1), sizeof(REAL));
+    status = direct_numeric_chol(A, lu);
+    if (status < 0) { // not positive definite
+      lu->sym = 0;
+      free(lu->Lx); lu->Lx = NULL;
+    }
+  }
+
+  if (!lu->sym) {
+    lu->Aval = (REAL *)calloc(MAX(A->nnz,1), sizeof(REAL));
+    array_cp(A->nnz, A->val, lu->Aval);
+    status = direct_numeric_lu(A, lu);
+  }
+
+  get_time(&setup_end);
+
+  if ( prtlvl > PRINT_MIN ) {
+    printf("Direct solver: %s factorization", lu->sym ? "Cholesky" : "LU");
+    if (lu->ndelay > 0) printf(", %d delayed pivots", lu->ndelay);
+    if (lu->nperturb > 0) printf(", %d perturbed pivots", lu->nperturb);
+    printf("\n");
+    print_cputime("Direct solver numeric", setup_end - setup_start);
+  }
+
+  if (lu->nperturb > 0 && prtlvl > PRINT_NONE) {
+    printf("### WARNING HAZMATH: %s: %d tiny pivots perturbed, matrix may be singular!\n",
+       __FUNCTION__, lu->nperturb);
+  }
+
+  return status;
 }
 
+/***********************************************************************************************/
+/**
+ * \fn SHORT direct_solve_nrhs (LU_data *lu, const INT nrhs, dvector *b, dvector *x)
+ *
+ * \brief Solve AX=B for nrhs right hand sides with the factorization computed
+ *        by direct_numeric (one sweep over the factors for all of them)
+ *
+ * \param lu     Pointer to the LU data
+ * \param nrhs   Number of right hand sides
+ * \param b      Right hand sides b[0],...,b[nrhs-1]
+ * \param x      Solutions x[0],...,x[nrhs-1] (OUTPUT, may be the same as b)
+ *
+ * \return       SUCCESS if succeed; ERROR_SOLVER_MISC if the backward error of
+ *               an LU solve is above DIRECT_BERR_TOL after the refinement
+ *
+ * \note The LU solve is followed by iterative refinement with A until the
+ *       componentwise backward error is at the level of the machine precision
+ *       or stops decreasing (at most DIRECT_MAX_REFINE steps).
+ */
+SHORT direct_solve_nrhs(LU_data *lu,
+                        const INT nrhs,
+                        dvector *b,
+                        dvector *x)
+{
+  const INT n = lu->row;
+  INT i, r, it;
+  REAL *y, *z, *bp, *w, berr, lastberr = BIGREAL;
+  SHORT status = SUCCESS;
+
+  for (r=0; r<nrhs; ++r) {
+    if (b[r].row != n || x[r].row != n) {
+      printf("### ERROR HAZMATH DANGER: %s: vector size does not match!\n", __FUNCTION__);
+      return ERROR_DATA_STRUCTURE;
+    }
+  }
+
+  // y(i,r) = b[r](perm[i]), stored by rows
+  y = (REAL *)calloc(MAX(n*nrhs,1), sizeof(REAL));
+  z = (REAL *)calloc(MAX(n*nrhs,1), sizeof(REAL));
+  for (r=0; r<nrhs; ++r) {
+    for (i=0; i<n; ++i) y[i*nrhs+r] = b[r].val[lu->perm[i]];
+  }
+
+  if (lu->sym) {
+    direct_sweep(lu, nrhs, y, z);
+  }
+  else {
+    bp = (REAL *)calloc(MAX(n*nrhs,1), sizeof(REAL));
+    w  = (REAL *)calloc(MAX(n*nrhs,1), sizeof(REAL));
+    array_cp(n*nrhs, y, bp);
+    direct_sweep(lu, nrhs, y, z);
+
+    // iterative refinement
+    for (it=0; ; ++it) {
+      berr = direct_residual(lu, nrhs, bp, z, y, w);
+      if (berr <= DBL_EPSILON || berr > 0.5*lastberr || it == DIRECT_MAX_REFINE) break;
+      lastberr = berr;
+      direct_sweep(lu, nrhs, y, w);
+      array_axpy(n*nrhs, 1.0, w, z);
+    }
+
+    if (!(berr <= DIRECT_BERR_TOL)) {
+      printf("### ERROR HAZMATH DANGER: %s: backward error %e after %d refinement steps (%d perturbed pivots)!\n",
+             __FUNCTION__, berr, it, lu->nperturb);
+      status = ERROR_SOLVER_MISC;
+    }
+    free(bp);
+    free(w);
+  }
+
+  for (r=0; r<nrhs; ++r) {
+    for (i=0; i<n; ++i) x[r].val[lu->perm[i]] = z[i*nrhs+r];
+  }
+  free(y);
+  free(z);
+
+  return status;
+}
+
+/***********************************************************************************************/
+/**
+ * \fn SHORT direct_solve (LU_data *lu, dvector *b, dvector *x)
+ *
+ * \brief Solve Ax=b with the factorization computed by direct_numeric
+ *
+ * \param lu   Pointer to the LU data
+ * \param b    Pointer to the right hand side
+ * \param x    Pointer to the solution (OUTPUT, may be the same as b)
+ *
+ * \return     SUCCESS if succeed; ERROR otherwise
+ *
+ */
+SHORT direct_solve(LU_data *lu,
+                   dvector *b,
+                   dvector *x)
+{
+  return direct_solve_nrhs(lu, 1, b, x);
+}
+
+/***********************************************************************************************/
+/**
+ * \fn void* direct_factorize (dCSRmat *A, const SHORT prtlvl)
+ *
+ * \brief Symbolic analysis and numeric factorization of A by the native direct solver
+ *
+ * \param A        Pointer to the dCSRmat matrix (0-based)
+ * \param prtlvl   Print level
+ *
+ * \return         Pointer to the LU data (free by direct_free_numeric), NULL if failed
+ *
+ */
+void* direct_factorize(dCSRmat *A,
+                       const SHORT prtlvl)
+{
+  LU_data *lu = (LU_data *)malloc(sizeof(LU_data));
+  LU_data_null(lu);
+
+  if ( direct_symbolic(A, lu, prtlvl) < 0 || direct_numeric(A, lu, prtlvl) < 0 ) {
+    LU_data_free(lu);
+    free(lu);
+    return NULL;
+  }
+
+  return (void *)lu;
+}
+
+/***********************************************************************************************/
+/**
+ * \fn void direct_free_numeric (void *Numeric)
+ *
+ * \brief Free the factorization returned by direct_factorize
+ *
+ * \param Numeric   Pointer to the LU data
+ *
+ */
+void direct_free_numeric(void *Numeric)
+{
+  if (Numeric == NULL) return;
+  LU_data_free((LU_data *)Numeric);
+  free(Numeric);
+}
 
 /*---------------------------------*/
 /*--        End of File          --*/
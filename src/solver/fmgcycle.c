@@ -288,13 +288,11 @@ ForwardSweep:
     // call the coarse space solver:
     switch ( coarse_solver ) {
 
-#if WITH_SUITESPARSE
         case SOLVER_UMFPACK: {
             // use UMFPACK direct solver on the coarsest level
             umfpack_solve(&mgl[nl-1].A, &mgl[nl-1].b, &mgl[nl-1].x, mgl[nl-1].Numeric, 0);
             break;
         }
-#endif
         default:
             // use iterative solver on the coarsest level
             coarse_fitsolver(&mgl[nl-1].A, &mgl[nl-1].b, &mgl[nl-1].x, tol,
@@ -438,13 +436,11 @@ void fmgcycle_add_update(AMG_data *mgl,
     // call the coarse space solver:
     switch ( coarse_solver ) {
 
-#if WITH_SUITESPARSE
         case SOLVER_UMFPACK: {
             // use UMFPACK direct solver on the coarsest level
             umfpack_solve(&mgl[nl-1].A, &mgl[nl-1].b, &mgl[nl-1].x, mgl[nl-1].Numeric, 0);
             break;
         }
-#endif
         default:
             // use eigensolver to approximate coarse A^-s
             coarse_fracinv(&mgl[nl-1].A, &mgl[nl-1].b, &mgl[nl-1].x, &mgl[nl-1].M, power);
@@ -599,12 +595,10 @@ void famli(AMG_data *mgl,
 
         switch (coarse_solver) {
 
-#if WITH_SUITESPARSE
             case SOLVER_UMFPACK:
                 // use UMFPACK direct solver on the coarsest level //
                 umfpack_solve(A0, b0, e0, mgl[level].Numeric, 0);
                 break;
-#endif
 
             default:
                 /* use iterative solver on the coarsest level */
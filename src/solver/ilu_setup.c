@@ -0,0 +1,578 @@
+/*! \file src/solver/ilu_setup.c
+ *
+ *  Setup phase for the incomplete LU preconditioners
+ *
+ *  Copyright 2015__HAZMATH__. All rights reserved.
+ *
+ *  \note  ILU(k) (ILU(0) for k=0) and ILUT factorizations of a dCSRmat.
+ *         The factors are stored as a strictly lower triangular L (unit
+ *         diagonal not stored), a strictly upper triangular U and the
+ *         inverse of the diagonal of U. The rows of both factors are grouped
+ *         into levels so that the triangular solves in precond_ilu can be
+ *         done in parallel within each level.
+ *
+ */
+
+#include "hazmath.h"
+
+/*---------------------------------*/
+/*--      Private Functions      --*/
+/*---------------------------------*/
+/***********************************************************************************************/
+/**
+ * \fn static void ilu_append (dCSRmat *T, INT *cap, const INT col, const REAL val)
+ *
+ * \brief Append one entry to the last row of a triangular factor which is being
+ *        built row by row (grows the storage if needed)
+ *
+ * \param T      Pointer to the factor (OUTPUT)
+ * \param cap    Current capacity of T->JA and T->val (OUTPUT)
+ * \param col    Column index
+ * \param val    Value
+ *
+ */
+static void ilu_append(dCSRmat *T,
+                       INT *cap,
+                       const INT col,
+                       const REAL val)
+{
+    if (T->nnz >= *cap) {
+        *cap = 2*(*cap) + 1;
+        T->JA  = (INT *)realloc(T->JA, (*cap)*sizeof(INT));
+        T->val = (REAL *)realloc(T->val, (*cap)*sizeof(REAL));
+    }
+    T->JA[T->nnz]  = col;
+    T->val[T->nnz] = val;
+    T->nnz++;
+}
+
+/***********************************************************************************************/
+/**
+ * \fn static void ilu_sort_row (const INT n, INT *ind, REAL *val)
+ *
+ * \brief Sort (ind,val) pairs with respect to ind (straight insertion, rows are short)
+ *
+ * \param n      Number of pairs
+ * \param ind    Pointer to the indices (OUTPUT)
+ * \param val    Pointer to the values (OUTPUT)
+ *
+ */
+static void ilu_sort_row(const INT n,
+                         INT *ind,
+                         REAL *val)
+{
+    INT i, j, ij;
+    REAL vj;
+    for (j=1; j<n; ++j) {
+        ij = ind[j]; vj = val[j];
+        i = j-1;
+        while ( (i>=0) && (ij<ind[i]) ) {
+            ind[i+1] = ind[i]; val[i+1] = val[i];
+            --i;
+        }
+        ind[i+1] = ij; val[i+1] = vj;
+    }
+}
+
+/***********************************************************************************************/
+/**
+ * \fn static void ilu_qsplit (REAL *val, INT *ind, const INT n, const INT ncut)
+ *
+ * \brief Partial quick-split: on return the ncut entries with largest absolute
+ *        value are in the first ncut positions of val (and ind)
+ *
+ * \param val    Pointer to the values (OUTPUT)
+ * \param ind    Pointer to the indices (OUTPUT)
+ * \param n      Number of entries
+ * \param ncut   Number of largest entries to keep in front
+ *
+ */
+static void ilu_qsplit(REAL *val,
+                       INT *ind,
+                       const INT n,
+                       const INT ncut)
+{
+    INT first = 0, last = n-1, mid, j, itmp;
+    REAL abskey, tmp;
+
+    if (ncut < 1 || ncut >= n) return;
+
+    while (1) {
+        mid = first;
+        abskey = ABS(val[mid]);
+        for (j=first+1; j<=last; ++j) {
+            if (ABS(val[j]) > abskey) {
+                ++mid;
+                tmp = val[mid]; val[mid] = val[j]; val[j] = tmp;
+                itmp = ind[mid]; ind[mid] = ind[j]; ind[j] = itmp;
+            }
+        }
+        // put the key in its final position
+        tmp = val[mid]; val[mid] = val[first]; val[first] = tmp;
+        itmp = ind[mid]; ind[mid] = ind[first]; ind[first] = itmp;
+
+        if (mid == ncut-1 || mid == ncut) return;
+        if (mid > ncut) last = mid-1;
+        else first = mid+1;
+    }
+}
+
+/***********************************************************************************************/
+/**
+ * \fn static REAL ilu_row_norm (dCSRmat *A, const INT i)
+ *
+ * \brief Average absolute value of the entries in the i-th row of A (used to
+ *        scale the dropping tolerance and to replace zero pivots)
+ *
+ */
+static REAL ilu_row_norm(dCSRmat *A,
+                         const INT i)
+{
+    INT k, len = A->IA[i+1]-A->IA[i];
+    REAL tnorm = 0.0;
+    for (k=A->IA[i]; k<A->IA[i+1]; ++k) tnorm += ABS(A->val[k]);
+    if (len > 0) tnorm /= (REAL)len;
+    if (tnorm < SMALLREAL) tnorm = 1.0;
+    return tnorm;
+}
+
+/***********************************************************************************************/
+/**
+ * \fn static void ilu_level_schedule (dCSRmat *T, const SHORT lower,
+ *                                     INT *nlev, INT **ilev, INT **jlev)
+ *
+ * \brief Group the rows of a triangular factor into levels: rows in the same
+ *        level only depend on rows from previous levels
+ *
+ * \param T      Pointer to the strictly lower/upper triangular factor
+ * \param lower  TRUE for lower triangular (forward solve), FALSE for upper
+ * \param nlev   Number of levels (OUTPUT)
+ * \param ilev   Start of each level in jlev, size nlev+1 (OUTPUT)
+ * \param jlev   Rows ordered level by level, size T->row (OUTPUT)
+ *
+ */
+static void ilu_level_schedule(dCSRmat *T,
+                               const SHORT lower,
+                               INT *nlev,
+                               INT **ilev,
+                               INT **jlev)
+{
+    const INT n = T->row;
+    INT i, k, l, maxlev = -1;
+    INT ibegin, iend, istep;
+    INT *level = (INT *)calloc(n, sizeof(INT));
+
+    if (lower) { ibegin = 0;   iend = n;  istep =  1; }
+    else       { ibegin = n-1; iend = -1; istep = -1; }
+
+    for (i=ibegin; i!=iend; i+=istep) {
+        l = 0;
+        for (k=T->IA[i]; k<T->IA[i+1]; ++k) l = MAX(l, level[T->JA[k]]+1);
+        level[i] = l;
+        maxlev = MAX(maxlev, l);
+    }
+
+    *nlev = maxlev+1;
+    *ilev = (INT *)calloc((*nlev)+1, sizeof(INT));
+    *jlev = (INT *)calloc(MAX(n,1), sizeof(INT));
+
+    for (i=0; i<n; ++i) (*ilev)[level[i]+1]++;
+    for (l=0; l<*nlev; ++l) (*ilev)[l+1] += (*ilev)[l];
+
+    // insertion pointer of each level
+    INT *pos = (INT *)calloc((*nlev)+1, sizeof(INT));
+    iarray_cp((*nlev)+1, *ilev, pos);
+    for (i=ibegin; i!=iend; i+=istep) (*jlev)[pos[level[i]]++] = i;
+
+    free(pos);
+    free(level);
+}
+
+/***********************************************************************************************/
+/**
+ * \fn static void ilu_symbolic_k (dCSRmat *A, const INT lfil, dCSRmat *L, dCSRmat *U)
+ *
+ * \brief Symbolic ILU(k): sparsity pattern of L and U with fill-in up to level lfil
+ *
+ * \param A      Pointer to the dCSRmat matrix
+ * \param lfil   Level of fill-in (0 gives the pattern of A)
+ * \param L      Pattern of the strictly lower triangular factor (OUTPUT)
+ * \param U      Pattern of the strictly upper triangular factor (OUTPUT)
+ *
+ * \note Each row is kept as a sorted linked list; fill-ins are inserted while
+ *       the rows of U above are traversed in increasing column order.
+ *
+ */
+static void ilu_symbolic_k(dCSRmat *A,
+                           const INT lfil,
+                           dCSRmat *L,
+                           dCSRmat *U)
+{
+    const INT n = A->row;
+    const INT head = n;
+    INT i, j, k, col, lev, prev, nc;
+    INT lcap = A->nnz/2+n, ucap = A->nnz/2+n, ulcap = ucap;
+
+    INT *next = (INT *)calloc(n+1, sizeof(INT));
+    INT *levw = (INT *)calloc(n, sizeof(INT));
+    INT *cols = (INT *)calloc(n, sizeof(INT));
+    INT *ulev = (INT *)calloc(ulcap, sizeof(INT)); // fill level of the entries of U
+
+    for (i=0; i<n; ++i) levw[i] = -1;
+
+    L->row = L->col = U->row = U->col = n;
+    L->nnz = U->nnz = 0;
+    L->IA  = (INT *)calloc(n+1, sizeof(INT));
+    U->IA  = (INT *)calloc(n+1, sizeof(INT));
+    L->JA  = (INT *)calloc(lcap, sizeof(INT));
+    U->JA  = (INT *)calloc(ucap, sizeof(INT));
+    L->val = (REAL *)calloc(lcap, sizeof(REAL));
+    U->val = (REAL *)calloc(ucap, sizeof(REAL));
+
+    for (i=0; i<n; ++i) {
+
+        // pattern of the i-th row of A (the diagonal is always there)
+        nc = 0;
+        for (k=A->IA[i]; k<A->IA[i+1]; ++k) {
+            col = A->JA[k];
+            if (levw[col] < 0) { levw[col] = 0; cols[nc++] = col; }
+        }
+        if (levw[i] < 0) { levw[i] = 0; cols[nc++] = i; }
+        isi_sort(nc, cols);
+
+        prev = head;
+        for (k=0; k<nc; ++k) { next[prev] = cols[k]; prev = cols[k]; }
+        next[prev] = -1;
+
+        // eliminate with the rows above in increasing column order
+        for (j=next[head]; j<i; j=next[j]) {
+            prev = j;
+            for (k=U->IA[j]; k<U->IA[j+1]; ++k) {
+                col = U->JA[k];
+                lev = levw[j] + ulev[k] + 1;
+                if (lev > lfil) continue;
+                if (levw[col] < 0) {
+                    while ( (next[prev] != -1) && (next[prev] < col) ) prev = next[prev];
+                    next[col] = next[prev]; next[prev] = col;
+                    levw[col] = lev;
+                    prev = col;
+                }
+                else {
+                    levw[col] = MIN(levw[col], lev);
+                }
+            }
+        }
+
+        // store the row
+        for (col=next[head]; col!=-1; col=next[col]) {
+            if (col < i) {
+                ilu_append(L, &lcap, col, 0.0);
+            }
+            else if (col > i) {
+                if (U->nnz >= ulcap) {
+                    ulcap = 2*ulcap+1;
+                    ulev = (INT *)realloc(ulev, ulcap*sizeof(INT));
+                }
+                ulev[U->nnz] = levw[col];
+                ilu_append(U, &ucap, col, 0.0);
+            }
+            levw[col] = -1;
+        }
+        L->IA[i+1] = L->nnz;
+        U->IA[i+1] = U->nnz;
+    }
+
+    free(next);
+    free(levw);
+    free(cols);
+    free(ulev);
+}
+
+/***********************************************************************************************/
+/**
+ * \fn static INT ilu_numeric (dCSRmat *A, dCSRmat *L, dCSRmat *U, REAL *invdiag)
+ *
+ * \brief Numeric ILU factorization on a given pattern (IKJ variant)
+ *
+ * \param A        Pointer to the dCSRmat matrix
+ * \param L        Strictly lower triangular factor with sorted pattern (OUTPUT)
+ * \param U        Strictly upper triangular factor with given pattern (OUTPUT)
+ * \param invdiag  Inverse of the diagonal of U (OUTPUT)
+ *
+ * \return         Number of replaced (zero) pivots
+ *
+ */
+static INT ilu_numeric(dCSRmat *A,
+                       dCSRmat *L,
+                       dCSRmat *U,
+                       REAL *invdiag)
+{
+    const INT n = A->row;
+    INT i, j, k, kk, col, nzero = 0;
+    REAL lij, d;
+
+    REAL *w    = (REAL *)calloc(n, sizeof(REAL));
+    INT  *mark = (INT *)calloc(n, sizeof(INT));
+
+    for (i=0; i<n; ++i) {
+
+        // pattern of the i-th row
+        for (k=L->IA[i]; k<L->IA[i+1]; ++k) mark[L->JA[k]] = 1;
+        for (k=U->IA[i]; k<U->IA[i+1]; ++k) mark[U->JA[k]] = 1;
+        mark[i] = 1;
+
+        // scatter the i-th row of A
+        for (k=A->IA[i]; k<A->IA[i+1]; ++k) {
+            col = A->JA[k];
+            if (mark[col]) w[col] += A->val[k];
+        }
+
+        // eliminate
+        for (k=L->IA[i]; k<L->IA[i+1]; ++k) {
+            j = L->JA[k];
+            lij = w[j]*invdiag[j];
+            w[j] = lij;
+            for (kk=U->IA[j]; kk<U->IA[j+1]; ++kk) {
+                col = U->JA[kk];
+                if (mark[col]) w[col] -= lij*U->val[kk];
+            }
+        }
+
+        // gather and reset
+        for (k=L->IA[i]; k<L->IA[i+1]; ++k) {
+            col = L->JA[k];
+            L->val[k] = w[col]; w[col] = 0.0; mark[col] = 0;
+        }
+        for (k=U->IA[i]; k<U->IA[i+1]; ++k) {
+            col = U->JA[k];
+            U->val[k] = w[col]; w[col] = 0.0; mark[col] = 0;
+        }
+
+        d = w[i]; w[i] = 0.0; mark[i] = 0;
+        if (ABS(d) < SMALLREAL) {
+            d = 1e-4*ilu_row_norm(A, i);
+            nzero++;
+        }
+        invdiag[i] = 1.0/d;
+    }
+
+    free(w);
+    free(mark);
+
+    return nzero;
+}
+
+/***********************************************************************************************/
+/**
+ * \fn static INT ilu_threshold (dCSRmat *A, const INT lfil, const REAL droptol,
+ *                               dCSRmat *L, dCSRmat *U, REAL *invdiag)
+ *
+ * \brief ILUT: dual threshold incomplete LU factorization
+ *
+ * \param A        Pointer to the dCSRmat matrix
+ * \param lfil     Maximal number of entries kept in each row of L and of U
+ * \param droptol  Entries smaller than droptol*(average of |a_ij| in the row) are dropped
+ * \param L        Strictly lower triangular factor (OUTPUT)
+ * \param U        Strictly upper triangular factor (OUTPUT)
+ * \param invdiag  Inverse of the diagonal of U (OUTPUT)
+ *
+ * \return         Number of replaced (zero) pivots
+ *
+ * \note Y. Saad, ILUT: a dual threshold incomplete LU factorization, 1994.
+ *
+ */
+static INT ilu_threshold(dCSRmat *A,
+                         const INT lfil,
+                         const REAL droptol,
+                         dCSRmat *L,
+                         dCSRmat *U,
+                         REAL *invdiag)
+{
+    const INT n = A->row;
+    INT i, j, k, kk, kmin, col, lenl, lenu, nl, nu, nzero = 0;
+    INT lcap = A->nnz/2+n, ucap = A->nnz/2+n;
+    REAL tnorm, tau, fact, d;
+
+    REAL *w    = (REAL *)calloc(n, sizeof(REAL));
+    INT  *mark = (INT *)calloc(n, sizeof(INT));
+    INT  *jl   = (INT *)calloc(n, sizeof(INT));
+    INT  *ju   = (INT *)calloc(n, sizeof(INT));
+    INT  *ind  = (INT *)calloc(n, sizeof(INT));
+    REAL *val  = (REAL *)calloc(n, sizeof(REAL));
+
+    L->row = L->col = U->row = U->col = n;
+    L->nnz = U->nnz = 0;
+    L->IA  = (INT *)calloc(n+1, sizeof(INT));
+    U->IA  = (INT *)calloc(n+1, sizeof(INT));
+    L->JA  = (INT *)calloc(lcap, sizeof(INT));
+    U->JA  = (INT *)calloc(ucap, sizeof(INT));
+    L->val = (REAL *)calloc(lcap, sizeof(REAL));
+    U->val = (REAL *)calloc(ucap, sizeof(REAL));
+
+    for (i=0; i<n; ++i) {
+
+        tnorm = ilu_row_norm(A, i);
+        tau   = droptol*tnorm;
+
+        // scatter the i-th row of A (the diagonal is not put in the lists)
+        lenl = lenu = 0;
+        mark[i] = 1;
+        for (k=A->IA[i]; k<A->IA[i+1]; ++k) {
+            col = A->JA[k];
+            if (!mark[col]) {
+                mark[col] = 1;
+                if (col < i) jl[lenl++] = col;
+                else ju[lenu++] = col;
+            }
+            w[col] += A->val[k];
+        }
+
+        // eliminate in increasing column order
+        for (j=0; j<lenl; ++j) {
+            kmin = j;
+            for (kk=j+1; kk<lenl; ++kk) if (jl[kk] < jl[kmin]) kmin = kk;
+            col = jl[kmin]; jl[kmin] = jl[j]; jl[j] = col;
+
+            fact = w[col]*invdiag[col];
+            w[col] = fact;
+            if (ABS(fact) <= tau) continue;
+
+            for (kk=U->IA[col]; kk<U->IA[col+1]; ++kk) {
+                k = U->JA[kk];
+                if (!mark[k]) {
+                    mark[k] = 1;
+                    if (k < i) jl[lenl++] = k;
+                    else ju[lenu++] = k;
+                }
+                w[k] -= fact*U->val[kk];
+            }
+        }
+
+        // L part: drop small entries and keep the lfil largest ones
+        nl = 0;
+        for (k=0; k<lenl; ++k) {
+            col = jl[k];
+            if (ABS(w[col]) > tau) { ind[nl] = col; val[nl] = w[col]; nl++; }
+            w[col] = 0.0; mark[col] = 0;
+        }
+        if (nl > lfil) { ilu_qsplit(val, ind, nl, lfil); nl = lfil; }
+        ilu_sort_row(nl, ind, val);
+        for (k=0; k<nl; ++k) ilu_append(L, &lcap, ind[k], val[k]);
+        L->IA[i+1] = L->nnz;
+
+        // U part: same for the strictly upper entries
+        nu = 0;
+        for (k=0; k<lenu; ++k) {
+            col = ju[k];
+            if (ABS(w[col]) > tau) { ind[nu] = col; val[nu] = w[col]; nu++; }
+            w[col] = 0.0; mark[col] = 0;
+        }
+        if (nu > lfil) { ilu_qsplit(val, ind, nu, lfil); nu = lfil; }
+        ilu_sort_row(nu, ind, val);
+        for (k=0; k<nu; ++k) ilu_append(U, &ucap, ind[k], val[k]);
+        U->IA[i+1] = U->nnz;
+
+        // diagonal
+        d = w[i]; w[i] = 0.0; mark[i] = 0;
+        if (ABS(d) < SMALLREAL) {
+            d = (1e-4+droptol)*tnorm;
+            nzero++;
+        }
+        invdiag[i] = 1.0/d;
+    }
+
+    free(w);
+    free(mark);
+    free(jl);
+    free(ju);
+    free(ind);
+    free(val);
+
+    return nzero;
+}
+
+/*---------------------------------*/
+/*--      Public Functions       --*/
+/*---------------------------------*/
+/***********************************************************************************************/
+/**
+ * \fn SHORT ilu_setup (dCSRmat *A, ILU_data *iludata, const SHORT ilu_type,
+ *                      const INT ilu_lfil, const REAL ilu_droptol, const SHORT prtlvl)
+ *
+ * \brief Setup phase of the ILU preconditioner: factorization and level schedules
+ *
+ * \param A            Pointer to the dCSRmat matrix
+ * \param iludata      Pointer to the ILU data (OUTPUT)
+ * \param ilu_type     ILUk: ILU(k) with k = ilu_lfil | ILUt: ILUT(ilu_lfil, ilu_droptol)
+ * \param ilu_lfil     Level of fill-in (ILUk) or max number of entries per row of L
+ *                     and of U (ILUt; ilu_lfil<=0 keeps all entries above the
+ *                     dropping tolerance, so the default 0 is not Jacobi)
+ * \param ilu_droptol  Relative dropping tolerance (ILUt only)
+ * \param prtlvl       Print level
+ *
+ * \return             SUCCESS if succeed; ERROR otherwise
+ *
+ */
+SHORT ilu_setup(dCSRmat *A,
+                ILU_data *iludata,
+                const SHORT ilu_type,
+                const INT ilu_lfil,
+                const REAL ilu_droptol,
+                const SHORT prtlvl)
+{
+    const INT n = A->row;
+    INT nzero = 0;
+    REAL setup_start, setup_end;
+
+    if (A->row != A->col) {
+        printf("### ERROR HAZMATH DANGER: %s: ILU needs a square matrix!\n", __FUNCTION__);
+        return ERROR_MAT_SIZE;
+    }
+
+    get_time(&setup_start);
+
+    ILU_data_null(iludata);
+    iludata->row     = n;
+    iludata->type    = ilu_type;
+    iludata->invdiag = (REAL *)calloc(MAX(n,1), sizeof(REAL));
+
+    switch (ilu_type) {
+
+        case ILUt:
+            nzero = ilu_threshold(A, (ilu_lfil > 0) ? ilu_lfil : n, ilu_droptol,
+                                  &iludata->L, &iludata->U, iludata->invdiag);
+            break;
+
+        case ILUk:
+            ilu_symbolic_k(A, MAX(ilu_lfil,0), &iludata->L, &iludata->U);
+            nzero = ilu_numeric(A, &iludata->L, &iludata->U, iludata->invdiag);
+            break;
+
+        default:
+            printf("### ERROR HAZMATH DANGER: %s: Unknown ILU type %d!\n", __FUNCTION__, ilu_type);
+            ILU_data_free(iludata);
+            return ERROR_SOLVER_PRECTYPE;
+
+    }
+
+    // level schedules for the triangular solves
+    ilu_level_schedule(&iludata->L, TRUE,
+                       &iludata->nlevL, &iludata->ilevL, &iludata->jlevL);
+    ilu_level_schedule(&iludata->U, FALSE,
+                       &iludata->nlevU, &iludata->ilevU, &iludata->jlevU);
+
+    if ( prtlvl >= PRINT_MIN ) {
+        get_time(&setup_end);
+        printf("ILU: nnz(L)+nnz(U)+n = %d (fill ratio %.2f), levels L/U = %d/%d\n",
+               iludata->L.nnz+iludata->U.nnz+n,
+               (REAL)(iludata->L.nnz+iludata->U.nnz+n)/(REAL)MAX(A->nnz,1),
+               iludata->nlevL, iludata->nlevU);
+        if (nzero > 0)
+            printf("### HAZMATH WARNING: ILU replaced %d zero pivots!\n", nzero);
+        print_cputime("ILU setup", setup_end - setup_start);
+    }
+
+    return SUCCESS;
+}
+
+/*************************************  END  ***************************************************/
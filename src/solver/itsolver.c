@@ -634,6 +634,9 @@ INT linear_solver_frac_rational_approx(dCSRmat *A,
  *
  * \author Xiaozhe Hu
  * \date   10/06/2015
+ *
+ * \note If itparam->linear_precond_type is PREC_ILU, ILU preconditioning is used;
+ *       if it is PREC_FSAI or PREC_SPAI, sparse approximate inverse preconditioning is used.
  */
 INT linear_solver_dcsr_krylov(dCSRmat *A,
                              dvector *b,
@@ -646,6 +649,13 @@ INT linear_solver_dcsr_krylov(dCSRmat *A,
     INT      status = SUCCESS;
     REAL     solver_start, solver_end, solver_duration;
 
+    // ILU and SAI need no extra data, so they can be selected here
+    if ( itparam->linear_precond_type == PREC_ILU )
+        return linear_solver_dcsr_krylov_ilu(A,b,x,itparam);
+    if ( (itparam->linear_precond_type == PREC_FSAI) ||
+         (itparam->linear_precond_type == PREC_SPAI) )
+        return linear_solver_dcsr_krylov_sai(A,b,x,itparam);
+
     get_time(&solver_start);
 
     status = solver_dcsr_linear_itsolver(A,b,x,NULL,itparam);
@@ -713,6 +723,116 @@ INT linear_solver_dcsr_krylov_diag(dCSRmat *A,
     return status;
 }
 
+/********************************************************************************************/
+/**
+ * \fn INT linear_solver_dcsr_krylov_ilu (dCSRmat *A, dvector *b, dvector *x,
+ *                                      linear_itsolver_param *itparam)
+ *
+ * \brief Solve Ax=b by ILU preconditioned Krylov methods
+ *
+ * \param A        Pointer to the coeff matrix in dCSRmat format
+ * \param b        Pointer to the right hand side in dvector format
+ * \param x        Pointer to the approx solution in dvector format
+ * \param itparam  Pointer to parameters for linear iterative solvers
+ *
+ * \return         Iteration number if converges; ERROR otherwise.
+ *
+ * \note The type of ILU and its parameters are taken from itparam
+ *       (ILU_type, ILU_lfil, ILU_droptol).
+ */
+INT linear_solver_dcsr_krylov_ilu(dCSRmat *A,
+                                  dvector *b,
+                                  dvector *x,
+                                  linear_itsolver_param *itparam)
+{
+    const SHORT prtlvl = itparam->linear_print_level;
+
+    /* Local Variables */
+    INT       status = SUCCESS;
+    REAL      solver_start, solver_end, solver_duration;
+
+    get_time(&solver_start);
+
+    // setup preconditioner
+    ILU_data iludata;
+    status = ilu_setup(A, &iludata, itparam->ILU_type, itparam->ILU_lfil,
+                       itparam->ILU_droptol, prtlvl);
+    if (status < 0) return status;
+
+    precond pc;
+    pc.data = &iludata;
+    pc.fct  = precond_ilu;
+
+    // call iterative solver
+    status = solver_dcsr_linear_itsolver(A,b,x,&pc,itparam);
+
+    if ( prtlvl >= PRINT_MIN ) {
+        get_time(&solver_end);
+        solver_duration = solver_end - solver_start;
+        print_cputime("ILU_Krylov method totally", solver_duration);
+        printf("**********************************************************\n");
+    }
+
+    ILU_data_free(&iludata);
+
+    return status;
+}
+
+/********************************************************************************************/
+/**
+ * \fn INT linear_solver_dcsr_krylov_sai (dCSRmat *A, dvector *b, dvector *x,
+ *                                      linear_itsolver_param *itparam)
+ *
+ * \brief Solve Ax=b by sparse approximate inverse preconditioned Krylov methods
+ *
+ * \param A        Pointer to the coeff matrix in dCSRmat format
+ * \param b        Pointer to the right hand side in dvector format
+ * \param x        Pointer to the approx solution in dvector format
+ * \param itparam  Pointer to parameters for linear iterative solvers
+ *
+ * \return         Iteration number if converges; ERROR otherwise.
+ *
+ * \note PREC_FSAI (A SPD) or PREC_SPAI is taken from itparam->linear_precond_type,
+ *       the pattern from itparam->SAI_levels.
+ */
+INT linear_solver_dcsr_krylov_sai(dCSRmat *A,
+                                  dvector *b,
+                                  dvector *x,
+                                  linear_itsolver_param *itparam)
+{
+    const SHORT prtlvl = itparam->linear_print_level;
+    const SHORT sai_type = (itparam->linear_precond_type == PREC_FSAI) ? FSAI : SPAI;
+
+    /* Local Variables */
+    INT       status = SUCCESS;
+    REAL      solver_start, solver_end, solver_duration;
+
+    get_time(&solver_start);
+
+    // setup preconditioner
+    SAI_data saidata;
+    status = sai_setup(A, &saidata, sai_type, itparam->SAI_levels, prtlvl);
+    if (status < 0) return status;
+
+    precond pc;
+    pc.data = &saidata;
+    pc.fct  = precond_sai;
+
+    // call iterative solver
+    status = solver_dcsr_linear_itsolver(A,b,x,&pc,itparam);
+
+    if ( prtlvl >= PRINT_MIN ) {
+        get_time(&solver_end);
+        solver_duration = solver_end - solver_start;
+        print_cputime("SAI_Krylov method totally", solver_duration);
+        printf("**********************************************************\n");
+    }
+
+    SAI_data_free(&saidata);
+
+    return status;
+}
+
 /********************************************************************************************/
 /**
  * \fn INT linear_solver_dcsr_krylov_amg (dCSRmat *A, dvector *b, dvector *x,
@@ -1567,6 +1687,7 @@ INT linear_solver_dcsr_krylov_hx_curl(dCSRmat *A,
 
     hxcurldata.backup_r = (REAL*)calloc(A->row, sizeof(REAL));
     hxcurldata.w = (REAL*)calloc(A->row, sizeof(REAL));
+    hxcurldata.add_work = NULL;
 
     precond pc; pc.data = &hxcurldata;
     switch (itparam->linear_precond_type) {
@@ -1807,6 +1928,7 @@ INT linear_solver_dcsr_krylov_hx_div(dCSRmat *A,
 
     hxdivdata.backup_r = (REAL*)calloc(A->row, sizeof(REAL));
     hxdivdata.w = (REAL*)calloc(2*(A_curl.row)+A->row, sizeof(REAL));
+    hxdivdata.add_work = NULL;
 
     precond pc; pc.data = &hxdivdata;
     switch (itparam->linear_precond_type) {
@@ -1938,11 +2060,7 @@ INT linear_solver_bdcsr_krylov_block_2(block_dCSRmat *A,
   REAL setup_start, setup_end, setup_duration;
   REAL solver_start, solver_end, solver_duration;
 
-#if WITH_SUITESPARSE
     void **LU_diag = (void **)calloc(2, sizeof(void *));
-#else
-    error_extlib(257, __FUNCTION__, "SuiteSparse");
-#endif
 
   SHORT max_levels;
   if (amgparam) max_levels = amgparam->max_levels;
@@ -1953,7 +2071,6 @@ INT linear_solver_bdcsr_krylov_block_2(block_dCSRmat *A,
 
   if (precond_type > 0 && precond_type < 20) {
   /* diagonal blocks are solved exactly */
-#if WITH_SUITESPARSE
     // Need to sort the diagonal blocks for UMFPACK format
     dCSRmat A_tran;
 
@@ -1968,7 +2085,6 @@ INT linear_solver_bdcsr_krylov_block_2(block_dCSRmat *A,
         dcsr_free(&A_tran);
 
     }
-#endif
   }
   else {
 
@@ -2015,9 +2131,7 @@ INT linear_solver_bdcsr_krylov_block_2(block_dCSRmat *A,
 
   if (precond_type > 0 && precond_type < 20) {
   /* diagonal blocks are solved exactly */
-#if WITH_SUITESPARSE
       precdata.LU_diag = LU_diag;
-#endif
   }
   else {
       precdata.mgl = mgl;
@@ -2140,11 +2254,7 @@ INT linear_solver_bdcsr_krylov_block_3(block_dCSRmat *A,
     REAL setup_start, setup_end, setup_duration;
     REAL solver_start, solver_end, solver_duration;
 
-#if WITH_SUITESPARSE
     void **LU_diag = (void **)calloc(3, sizeof(void *));
-//#else
-//    error_extlib(257, __FUNCTION__, "SuiteSparse");
-#endif
 
 
     SHORT max_levels;
@@ -2156,7 +2266,6 @@ INT linear_solver_bdcsr_krylov_block_3(block_dCSRmat *A,
 
     if (precond_type > 0 && precond_type < 20) {
     /* diagonal blocks are solved exactly */
-#if WITH_SUITESPARSE
         // Need to sort the diagonal blocks for UMFPACK format
         dCSRmat A_tran;
 
@@ -2172,7 +2281,6 @@ INT linear_solver_bdcsr_krylov_block_3(block_dCSRmat *A,
 
         }
 
-#endif
     }
     else {
 
@@ -2220,9 +2328,7 @@ INT linear_solver_bdcsr_krylov_block_3(block_dCSRmat *A,
 
     if (precond_type > 0 && precond_type < 20) {
     /* diagonal blocks are solved exactly */
-#if WITH_SUITESPARSE
         precdata.LU_diag = LU_diag;
-#endif
     }
     else {
         precdata.mgl = mgl;
@@ -2339,11 +2445,7 @@ INT linear_solver_bdcsr_krylov_block_4(block_dCSRmat *A,
     REAL setup_start, setup_end, setup_duration;
     REAL solver_start, solver_end, solver_duration;
 
-#if WITH_SUITESPARSE
     void **LU_diag = (void **)calloc(4, sizeof(void *));
-#else
-    error_extlib(258, __FUNCTION__, "SuiteSparse");
-#endif
 
     SHORT max_levels;
     if (amgparam) max_levels = amgparam->max_levels;
@@ -2354,7 +2456,6 @@ INT linear_solver_bdcsr_krylov_block_4(block_dCSRmat *A,
 
     if (precond_type > 0 && precond_type < 20) {
     /* diagonal blocks are solved exactly */
-#if WITH_SUITESPARSE
         // Need to sort the diagonal blocks for UMFPACK format
         dCSRmat A_tran;
 
@@ -2370,7 +2471,6 @@ INT linear_solver_bdcsr_krylov_block_4(block_dCSRmat *A,
 
 
         }
-#endif
     }
     else {
 
@@ -2421,9 +2521,7 @@ INT linear_solver_bdcsr_krylov_block_4(block_dCSRmat *A,
 
     if (precond_type > 0 && precond_type < 20) {
     /* diagonal blocks are solved exactly */
-#if WITH_SUITESPARSE
         precdata.LU_diag = LU_diag;
-#endif
     }
     else {
       precdata.mgl = mgl;
@@ -2541,11 +2639,7 @@ INT linear_solver_bdcsr_krylov_block_5(block_dCSRmat *A,
     REAL setup_start, setup_end, setup_duration;
     REAL solver_start, solver_end, solver_duration;
 
-#if WITH_SUITESPARSE
     void **LU_diag = (void **)calloc(5, sizeof(void *));
-//#else
-//    error_extlib(257, __FUNCTION__, "SuiteSparse");
-#endif
 
     SHORT max_levels;
     if (amgparam) max_levels = amgparam->max_levels;
@@ -2556,7 +2650,6 @@ INT linear_solver_bdcsr_krylov_block_5(block_dCSRmat *A,
 
     if (precond_type > 0 && precond_type < 20) {
     /* diagonal blocks are solved exactly */
-#if WITH_SUITESPARSE
         // Need to sort the diagonal blocks for UMFPACK format
         dCSRmat A_tran;
 
@@ -2572,7 +2665,6 @@ INT linear_solver_bdcsr_krylov_block_5(block_dCSRmat *A,
 
         }
 
-#endif
     }
     else {
 
@@ -2620,9 +2712,7 @@ INT linear_solver_bdcsr_krylov_block_5(block_dCSRmat *A,
 
     if (precond_type > 0 && precond_type < 20) {
     /* diagonal blocks are solved exactly */
-#if WITH_SUITESPARSE
         precdata.LU_diag = LU_diag;
-#endif
     }
     else {
         precdata.mgl = mgl;
@@ -2740,24 +2830,17 @@ INT linear_solver_bdcsr_krylov_block(block_dCSRmat *A,
 
   const INT nb = A->brow;
 
-#if WITH_SUITESPARSE
   INT i;
-#endif
   INT status = SUCCESS;
   REAL setup_start, setup_end, setup_duration;
   REAL solver_start, solver_end, solver_duration;
 
-#if WITH_SUITESPARSE
   void **LU_diag = (void **)calloc(nb, sizeof(void *));
-#else
-    error_extlib(256, __FUNCTION__, "SuiteSparse");
-#endif
 
   /* setup preconditioner */
   get_time(&setup_start);
 
   /* diagonal blocks are solved exactly */
-#if WITH_SUITESPARSE
   // Need to sort the diagonal blocks for UMFPACK format
   dCSRmat A_tran;
 
@@ -2772,7 +2855,6 @@ INT linear_solver_bdcsr_krylov_block(block_dCSRmat *A,
     dcsr_free(&A_tran);
 
   }
-#endif
 
   precond_block_data precdata;
   precond_block_data_null(&precdata);
@@ -2782,9 +2864,7 @@ INT linear_solver_bdcsr_krylov_block(block_dCSRmat *A,
   precdata.A_diag = A_diag;
   precdata.r = dvec_create(b->row);
 
-#if WITH_SUITESPARSE
   precdata.LU_diag = LU_diag;
-#endif
 
   precond prec; prec.data = &precdata;
 
@@ -58,7 +58,7 @@ static void coarse_itsolver(dCSRmat *A,
  *                                         dvector *b, dvector *x,
  *                                         const INT nsweeps, const INT istart,
  *                                         const INT iend, const INT istep,
- *                                         const REAL relax)
+ *                                         const REAL relax, SAI_data *saidata)
  *
  * \brief  Pre-smoothing
  *
@@ -71,6 +71,7 @@ static void coarse_itsolver(dCSRmat *A,
  * \param  iend      ending index
  * \param  istep     step size
  * \param  relax     relaxation parameter for SOR-type smoothers
+ * \param  saidata   sparse approximate inverse for FSAI/SPAI smoothers
  *
  */
 static void dcsr_presmoothing(SHORT smoother,
@@ -81,7 +82,8 @@ static void dcsr_presmoothing(SHORT smoother,
                               const INT istart,
                               const INT iend,
                               const INT istep,
-                              const REAL relax)
+                              const REAL relax,
+                              SAI_data *saidata)
 {
 
     switch (smoother) {
@@ -127,6 +129,11 @@ static void dcsr_presmoothing(SHORT smoother,
             dcsr_pcg(A, b, x, NULL, 1e-3, nsweeps, 1, PRINT_NONE);
             break;
 
+        case SMOOTHER_FSAI:
+        case SMOOTHER_SPAI:
+            smoother_dcsr_sai(x, A, b, nsweeps, saidata);
+            break;
+
         case SMOOTHER_USERDEF:
             printf("Smoother type not implemented! Running GS just in case. \n");
             smoother_dcsr_gs(x, iend, istart, istep, A, b, nsweeps);
@@ -144,7 +151,7 @@ static void dcsr_presmoothing(SHORT smoother,
  *                                          dvector *b, dvector *x,
  *                                          const INT nsweeps, const INT istart,
  *                                          const INT iend, const INT istep,
- *                                          const REAL relax)
+ *                                          const REAL relax, SAI_data *saidata)
  *
  * \brief  Post-smoothing
  *
@@ -157,6 +164,7 @@ static void dcsr_presmoothing(SHORT smoother,
  * \param  iend      ending index
  * \param  istep     step size
  * \param  relax     relaxation parameter for SOR-type smoothers
+ * \param  saidata   sparse approximate inverse for FSAI/SPAI smoothers
  *
  */
 static void dcsr_postsmoothing(SHORT smoother,
@@ -167,7 +175,8 @@ static void dcsr_postsmoothing(SHORT smoother,
                                const INT istart,
                                const INT iend,
                                const INT istep,
-                               const REAL relax)
+                               const REAL relax,
+                               SAI_data *saidata)
 {
 
     switch (smoother) {
@@ -213,6 +222,11 @@ static void dcsr_postsmoothing(SHORT smoother,
             dcsr_pcg(A, b, x, NULL, 1e-3, nsweeps, 1, PRINT_NONE);
             break;
 
+        case SMOOTHER_FSAI:
+        case SMOOTHER_SPAI:
+            smoother_dcsr_sai(x, A, b, nsweeps, saidata);
+            break;
+
         case SMOOTHER_USERDEF:
             printf("Smoother type not implemented! Running GS just in case. \n");
             smoother_dcsr_gs(x, iend, istart, istep, A, b, nsweeps);
@@ -286,7 +300,7 @@ ForwardSweep:
         { // pre-smoothing with standard smoothers
           dcsr_presmoothing(smoother, &mgl[l].A, &mgl[l].b, &mgl[l].x,
                             param->presmooth_iter, 0, mgl[l].A.row-1, 1,
-                            relax);
+                            relax, &mgl[l].SAI);
         }
 
         // form residual r = b - A x
@@ -312,13 +326,11 @@ ForwardSweep:
     // call the coarse space solver:
     switch ( coarse_solver ) {
 
-#if WITH_SUITESPARSE
         case SOLVER_UMFPACK: {
             // use UMFPACK direct solver on the coarsest level
             umfpack_solve(&mgl[nl-1].A, &mgl[nl-1].b, &mgl[nl-1].x, mgl[nl-1].Numeric, 0);
             break;
         }
-#endif
         default:
             // use iterative solver on the coarsest level
             coarse_itsolver(&mgl[nl-1].A, &mgl[nl-1].b, &mgl[nl-1].x, tol, prtlvl);
@@ -368,7 +380,7 @@ ForwardSweep:
         { // post-smoothing with standard methods
           dcsr_postsmoothing(smoother, &mgl[l].A, &mgl[l].b, &mgl[l].x,
                              param->postsmooth_iter, 0, mgl[l].A.row-1, -1,
-                             relax);
+                             relax, &mgl[l].SAI);
         }
 
         if ( num_lvl[l] < cycle_type ) break;
@@ -433,7 +445,7 @@ void amli(AMG_data *mgl,
 
         // presmoothing
         dcsr_presmoothing(smoother,A0,b0,e0,param->presmooth_iter,
-                          0,m0-1,1,relax);
+                          0,m0-1,1,relax,&mgl[level].SAI);
 
         // form residual r = b - A x
         array_cp(m0,b0->val,r);
@@ -488,7 +500,7 @@ void amli(AMG_data *mgl,
 
         // postsmoothing
         dcsr_postsmoothing(smoother,A0,b0,e0,param->postsmooth_iter,
-                           0,m0-1,-1,relax);
+                           0,m0-1,-1,relax,&mgl[level].SAI);
 
     }
 
@@ -496,12 +508,10 @@ void amli(AMG_data *mgl,
 
         switch (coarse_solver) {
 
-#if WITH_SUITESPARSE
             case SOLVER_UMFPACK:
                 // use UMFPACK direct solver on the coarsest level //
                 umfpack_solve(A0, b0, e0, mgl[level].Numeric, 0);
                 break;
-#endif
 
             default:
                 /* use iterative solver on the coarsest level */
@@ -564,7 +574,7 @@ void nl_amli (AMG_data *mgl,
 
         // presmoothing
         dcsr_presmoothing(smoother,A0,b0,e0,param->presmooth_iter,
-                          0,m0-1,1,relax);
+                          0,m0-1,1,relax,&mgl[level].SAI);
 
         // form residual r = b - A x
         array_cp(m0,b0->val,r);
@@ -632,7 +642,7 @@ void nl_amli (AMG_data *mgl,
 
         // postsmoothing
         dcsr_postsmoothing(smoother,A0,b0,e0,param->postsmooth_iter,
-                           0,m0-1,-1,relax);
+                           0,m0-1,-1,relax,&mgl[level].SAI);
 
     }
 
@@ -640,12 +650,10 @@ void nl_amli (AMG_data *mgl,
 
         switch (coarse_solver) {
 
-#if WITH_SUITESPARSE
             case SOLVER_UMFPACK:
                 // use UMFPACK direct solver on the coarsest level //
                 umfpack_solve(A0, b0, e0, mgl[level].Numeric, 0);
                 break;
-#endif
 
             default:
                 /* use iterative solver on the coarsest level */
@@ -714,7 +722,7 @@ void mgcycle_add(AMG_data *mgl,
         { // pre-smoothing with standard smoothers
           dcsr_presmoothing(smoother, &mgl[l].A, &mgl[l].b, &mgl[l].x,
                             param->presmooth_iter, 0, mgl[l].A.row-1, 1,
-                            relax);
+                            relax, &mgl[l].SAI);
         }
 
         // restriction rH = R*rh (restrict residual, not the right-hand-side)
@@ -748,13 +756,11 @@ void mgcycle_add(AMG_data *mgl,
     // call the coarse space solver:
     switch ( coarse_solver ) {
 
-#if WITH_SUITESPARSE
         case SOLVER_UMFPACK: {
             // use UMFPACK direct solver on the coarsest level
             umfpack_solve(&mgl[nl-1].A, &mgl[nl-1].b, &mgl[nl-1].x, mgl[nl-1].Numeric, 0);
             break;
         }
-#endif
         default:
             // use iterative solver on the coarsest level
             coarse_itsolver(&mgl[nl-1].A, &mgl[nl-1].b, &mgl[nl-1].x, tol, prtlvl);
@@ -847,7 +853,7 @@ void mgcycle_add_update(AMG_data *mgl,
         { // pre-smoothing with standard smoothers
           dcsr_presmoothing(smoother, &mgl[l].A, &mgl[l].b, &mgl[l].x,
                             param->presmooth_iter, 0, mgl[l].A.row-1, 1,
-                            relax);
+                            relax, &mgl[l].SAI);
         }
 
         // restriction rH = R*rh (restrict residual)
@@ -869,13 +875,11 @@ void mgcycle_add_update(AMG_data *mgl,
     // call the coarse space solver:
     switch ( coarse_solver ) {
 
-#if WITH_SUITESPARSE
         case SOLVER_UMFPACK: {
             // use UMFPACK direct solver on the coarsest level
             umfpack_solve(&mgl[nl-1].A, &mgl[nl-1].b, &mgl[nl-1].x, mgl[nl-1].Numeric, 0);
             break;
         }
-#endif
         default:
             // use iterative solver on the coarsest level
             coarse_itsolver(&mgl[nl-1].A, &mgl[nl-1].b, &mgl[nl-1].x, tol, prtlvl);
@@ -143,6 +143,109 @@ void precond_diag (REAL *r,
     }
 }
 
+/***********************************************************************************************/
+/**
+ * \fn void precond_ilu(REAL *r, REAL *z, void *data)
+ *
+ * \brief ILU preconditioner z=inv(U)*inv(L)*r
+ *
+ * \param r     Pointer to the vector needs preconditioning
+ * \param z     Pointer to preconditioned vector
+ * \param data  Pointer to precondition data (ILU_data)
+ *
+ * \note The triangular solves follow the level schedules computed in ilu_setup:
+ *       rows within one level are independent and are solved in parallel.
+ */
+void precond_ilu(REAL *r,
+                 REAL *z,
+                 void *data)
+{
+    ILU_data *iludata=(ILU_data *)data;
+    const INT nlevL = iludata->nlevL, nlevU = iludata->nlevU;
+    const INT *ilevL = iludata->ilevL, *jlevL = iludata->jlevL;
+    const INT *ilevU = iludata->ilevU, *jlevU = iludata->jlevU;
+    const INT *IL = iludata->L.IA, *JL = iludata->L.JA;
+    const INT *IU = iludata->U.IA, *JU = iludata->U.JA;
+    const REAL *valL = iludata->L.val, *valU = iludata->U.val;
+    const REAL *invdiag = iludata->invdiag;
+    INT lev, ii, i, k;
+    REAL t;
+
+    // forward solve: L y = r (y is stored in z)
+    for (lev=0; lev<nlevL; ++lev) {
+#ifdef _OPENMP
+#pragma omp parallel for private(i,k,t) if(ilevL[lev+1]-ilevL[lev]>256)
+#endif
+        for (ii=ilevL[lev]; ii<ilevL[lev+1]; ++ii) {
+            i = jlevL[ii];
+            t = r[i];
+            for (k=IL[i]; k<IL[i+1]; ++k) t -= valL[k]*z[JL[k]];
+            z[i] = t;
+        }
+    }
+
+    // backward solve: U z = y
+    for (lev=0; lev<nlevU; ++lev) {
+#ifdef _OPENMP
+#pragma omp parallel for private(i,k,t) if(ilevU[lev+1]-ilevU[lev]>256)
+#endif
+        for (ii=ilevU[lev]; ii<ilevU[lev+1]; ++ii) {
+            i = jlevU[ii];
+            t = z[i];
+            for (k=IU[i]; k<IU[i+1]; ++k) t -= valU[k]*z[JU[k]];
+            z[i] = t*invdiag[i];
+        }
+    }
+}
+
+/***********************************************************************************************/
+/**
+ * \fn void precond_sai(REAL *r, REAL *z, void *data)
+ *
+ * \brief Sparse approximate inverse preconditioner z=G^T*G*r (FSAI) or z=G*r (SPAI)
+ *
+ * \param r     Pointer to the vector needs preconditioning
+ * \param z     Pointer to preconditioned vector
+ * \param data  Pointer to precondition data (SAI_data)
+ *
+ * \note Only sparse matrix-vector products, the rows are done in parallel.
+ */
+void precond_sai(REAL *r,
+                 REAL *z,
+                 void *data)
+{
+    SAI_data *saidata=(SAI_data *)data;
+    const INT n = saidata->row;
+    const INT *IG = saidata->G.IA, *JG = saidata->G.JA;
+    const REAL *valG = saidata->G.val;
+    REAL *y = (saidata->type == FSAI) ? saidata->w : z;
+    INT i, k;
+    REAL t;
+
+    // y = G r
+#ifdef _OPENMP
+#pragma omp parallel for private(k,t) if(n>1024)
+#endif
+    for (i=0; i<n; ++i) {
+        t = 0.0;
+        for (k=IG[i]; k<IG[i+1]; ++k) t += valG[k]*r[JG[k]];
+        y[i] = t;
+    }
+
+    if (saidata->type != FSAI) return;
+
+    // z = G^T y
+    IG = saidata->Gt.IA; JG = saidata->Gt.JA; valG = saidata->Gt.val;
+#ifdef _OPENMP
+#pragma omp parallel for private(k,t) if(n>1024)
+#endif
+    for (i=0; i<n; ++i) {
+        t = 0.0;
+        for (k=IG[i]; k<IG[i+1]; ++k) t += valG[k]*y[JG[k]];
+        z[i] = t;
+    }
+}
+
 /***********************************************************************************************/
 /**
  * \fn void precond_amg (REAL *r, REAL *z, void *data)
@@ -615,38 +718,69 @@ void precond_hx_curl_additive(REAL *r,
     dvector rr;
     rr.row = n; rr.val = r;
 
-    SHORT maxit, i;
-
-    // smoothing
-    smoother_dcsr_sgs(&zz, hxcurldata->A, &rr, smooth_iter);
+    // each subspace correction goes to its own vector and they are summed at the end
+    if (hxcurldata->add_work == NULL)
+        hxcurldata->add_work = (REAL*)calloc(2*n, sizeof(REAL));
+    REAL *z_vgrad = hxcurldata->add_work;
+    REAL *z_grad = z_vgrad + n;
 
-    // solve vector Laplacian
     AMG_param *amgparam_vgrad = hxcurldata->amgparam_vgrad;
     AMG_data *mgl_vgrad = hxcurldata->mgl_vgrad;
-    maxit = amgparam_vgrad->maxit;
+    AMG_param *amgparam_grad = hxcurldata->amgparam_grad;
+    AMG_data *mgl_grad = hxcurldata->mgl_grad;
 
-    mgl_vgrad->b.row = hxcurldata->A_vgrad->row;
-    dcsr_mxv(hxcurldata->Pt_curl, r, mgl_vgrad->b.val);
-    mgl_vgrad->x.row=hxcurldata->A_vgrad->row;
-    dvec_set(hxcurldata->A_vgrad->row, &mgl_vgrad->x, 0.0);
+    // the corrections are independent: run them concurrently as long as
+    // the two AMG hierarchies (and their cycle workspace) are not shared
+#ifdef _OPENMP
+#pragma omp parallel sections if(mgl_vgrad != mgl_grad)
+#endif
+    {
+#ifdef _OPENMP
+#pragma omp section
+#endif
+        {
+            // smoothing
+            smoother_dcsr_sgs(&zz, hxcurldata->A, &rr, smooth_iter);
+        }
 
-    for (i=0;i<maxit;++i) mgcycle(mgl_vgrad, amgparam_vgrad);
+#ifdef _OPENMP
+#pragma omp section
+#endif
+        {
+            // solve vector Laplacian
+            SHORT i, maxit = amgparam_vgrad->maxit;
 
-    dcsr_aAxpy(1.0, hxcurldata->P_curl, mgl_vgrad->x.val, z);
+            mgl_vgrad->b.row = hxcurldata->A_vgrad->row;
+            dcsr_mxv(hxcurldata->Pt_curl, r, mgl_vgrad->b.val);
+            mgl_vgrad->x.row=hxcurldata->A_vgrad->row;
+            dvec_set(hxcurldata->A_vgrad->row, &mgl_vgrad->x, 0.0);
 
-    // solve scalar Laplacian
-    AMG_param *amgparam_grad = hxcurldata->amgparam_grad;
-    AMG_data *mgl_grad = hxcurldata->mgl_grad;
-    maxit = amgparam_grad->maxit;
+            for (i=0;i<maxit;++i) mgcycle(mgl_vgrad, amgparam_vgrad);
 
-    mgl_grad->b.row = hxcurldata->A_grad->row;
-    dcsr_mxv(hxcurldata->Gradt, r, mgl_grad->b.val);
-    mgl_grad->x.row=hxcurldata->A_grad->row;
-    dvec_set(hxcurldata->A_grad->row, &mgl_grad->x, 0.0);
+            dcsr_mxv(hxcurldata->P_curl, mgl_vgrad->x.val, z_vgrad);
+        }
 
-    for (i=0;i<maxit;++i) mgcycle(mgl_grad, amgparam_grad);
+#ifdef _OPENMP
+#pragma omp section
+#endif
+        {
+            // solve scalar Laplacian
+            SHORT i, maxit = amgparam_grad->maxit;
 
-    dcsr_aAxpy(1.0, hxcurldata->Grad, mgl_grad->x.val, z);
+            mgl_grad->b.row = hxcurldata->A_grad->row;
+            dcsr_mxv(hxcurldata->Gradt, r, mgl_grad->b.val);
+            mgl_grad->x.row=hxcurldata->A_grad->row;
+            dvec_set(hxcurldata->A_grad->row, &mgl_grad->x, 0.0);
+
+            for (i=0;i<maxit;++i) mgcycle(mgl_grad, amgparam_grad);
+
+            dcsr_mxv(hxcurldata->Grad, mgl_grad->x.val, z_grad);
+        }
+    }
+
+    // sum up the corrections
+    array_axpy(n, 1.0, z_vgrad, z);
+    array_axpy(n, 1.0, z_grad, z);
 
 }
 
@@ -984,6 +1118,7 @@ void precond_hx_div_additive(REAL *r,
     //printf("HX div additive precond\n");
     HX_div_data *hxdivdata=(HX_div_data *)data;
     INT n = hxdivdata->A->row;
+    INT nc = hxdivdata->Curlt->row;
     SHORT smooth_iter = hxdivdata->smooth_iter;
 
     // make sure z is initialzied by zeros
@@ -995,82 +1130,102 @@ void precond_hx_div_additive(REAL *r,
     dvector rr;
     rr.row = n; rr.val = r;
 
-    SHORT maxit, i;
+    // each subspace correction goes to its own vector and they are summed at the end
+    if (hxdivdata->add_work == NULL)
+        hxdivdata->add_work = (REAL*)calloc(3*n+3*nc, sizeof(REAL));
+    REAL *z_divgrad = hxdivdata->add_work;
+    REAL *z_curl = z_divgrad + n;
+    REAL *z_curlgrad = z_curl + n;
 
-    // smoothing
-    smoother_dcsr_sgs(&zz, hxdivdata->A, &rr, smooth_iter);
-    //smoother_dcsr_jacobi(&zz, 0, n, 1, hxdivdata->A, &rr, smooth_iter);
+    // Curl^T r is shared by the curl smoother and the curl vector Laplacian
+    REAL *temp1 = z_curlgrad + n;
+    REAL *temp2 = temp1 + nc;
+    REAL *temp = temp2 + nc;
+    array_set(nc, temp1, 0.0);
+    dcsr_mxv(hxdivdata->Curlt, r, temp2);
 
-    // solve div vector Laplacian
     AMG_param *amgparam_divgrad = hxdivdata->amgparam_divgrad;
     AMG_data *mgl_divgrad = hxdivdata->mgl_divgrad;
-    maxit = amgparam_divgrad->maxit;
-
-    mgl_divgrad->b.row = hxdivdata->A_divgrad->row;
-    dcsr_mxv(hxdivdata->Pt_div, r, mgl_divgrad->b.val);
-    mgl_divgrad->x.row=hxdivdata->A_divgrad->row;
-    dvec_set(hxdivdata->A_divgrad->row, &mgl_divgrad->x, 0.0);
-
-    for (i=0;i<maxit;++i) mgcycle(mgl_divgrad, amgparam_divgrad);
-    //dcsr_pvfgmres(hxdivdata->A_divgrad, &mgl_divgrad->b, &mgl_divgrad->x, NULL, 1e-3, 1000, 1000, 1, 1);
-    //directsolve_UMF(hxdivdata->A_divgrad, &(mgl_divgrad->b), &(mgl_divgrad->x), 1);
+    AMG_param *amgparam_curlgrad = hxdivdata->amgparam_curlgrad;
+    AMG_data *mgl_curlgrad = hxdivdata->mgl_curlgrad;
 
-    dcsr_aAxpy(1.0, hxdivdata->P_div, mgl_divgrad->x.val, z);
+    // the corrections are independent: run them concurrently as long as
+    // the two AMG hierarchies (and their cycle workspace) are not shared
+#ifdef _OPENMP
+#pragma omp parallel sections if(mgl_divgrad != mgl_curlgrad)
+#endif
+    {
+#ifdef _OPENMP
+#pragma omp section
+#endif
+        {
+            // smoothing
+            smoother_dcsr_sgs(&zz, hxdivdata->A, &rr, smooth_iter);
+            //smoother_dcsr_jacobi(&zz, 0, n, 1, hxdivdata->A, &rr, smooth_iter);
+        }
 
-    /*
-    INT j;
-    for(j=0;j<n;j++){
-      if(z[j]!=z[j]){ printf("DIV z[%d]=%f\n",j,z[j]);}
-    }
-    */
+#ifdef _OPENMP
+#pragma omp section
+#endif
+        {
+            // solve div vector Laplacian
+            SHORT i, maxit = amgparam_divgrad->maxit;
 
-    // smoothing
-    REAL *temp1 = (REAL*)calloc(hxdivdata->Curlt->row,sizeof(REAL));
-    REAL *temp2 = (REAL*)calloc(hxdivdata->Curlt->row,sizeof(REAL));
+            mgl_divgrad->b.row = hxdivdata->A_divgrad->row;
+            dcsr_mxv(hxdivdata->Pt_div, r, mgl_divgrad->b.val);
+            mgl_divgrad->x.row=hxdivdata->A_divgrad->row;
+            dvec_set(hxdivdata->A_divgrad->row, &mgl_divgrad->x, 0.0);
 
-    dvector Cz;
-    Cz.row = hxdivdata->A_curl->row;
-    Cz.val = temp1;// initial guess is zero
+            for (i=0;i<maxit;++i) mgcycle(mgl_divgrad, amgparam_divgrad);
+            //dcsr_pvfgmres(hxdivdata->A_divgrad, &mgl_divgrad->b, &mgl_divgrad->x, NULL, 1e-3, 1000, 1000, 1, 1);
+            //directsolve_UMF(hxdivdata->A_divgrad, &(mgl_divgrad->b), &(mgl_divgrad->x), 1);
 
-    dvector Cr;
-    Cr.row = Cz.row;
-    Cr.val = temp2;
+            dcsr_mxv(hxdivdata->P_div, mgl_divgrad->x.val, z_divgrad);
+        }
 
-    dcsr_mxv(hxdivdata->Curlt,r,Cr.val);
-//    INT flag;
-//    flag = directsolve_UMF(hxdivdata->A_curl, &Cr, &Cz, 1);
-//    printf("flag=%d\n",flag);
-    smoother_dcsr_sgs(&Cz, hxdivdata->A_curl, &Cr, smooth_iter);
-//    //smoother_dcsr_jacobi(&Cz, 0, Cz.row, 1, hxdivdata->A_curl, &Cr, smooth_iter);
-    dcsr_aAxpy(1.0,hxdivdata->Curl,Cz.val,z);
+#ifdef _OPENMP
+#pragma omp section
+#endif
+        {
+            // smoothing on the curl space
+            dvector Cz;
+            Cz.row = hxdivdata->A_curl->row;
+            Cz.val = temp1;// initial guess is zero
+
+            dvector Cr;
+            Cr.row = Cz.row;
+            Cr.val = temp2;
+
+            smoother_dcsr_sgs(&Cz, hxdivdata->A_curl, &Cr, smooth_iter);
+            //smoother_dcsr_jacobi(&Cz, 0, Cz.row, 1, hxdivdata->A_curl, &Cr, smooth_iter);
+            dcsr_mxv(hxdivdata->Curl, Cz.val, z_curl);
+        }
 
-    // solve scalar Laplacian
-    AMG_param *amgparam_curlgrad = hxdivdata->amgparam_curlgrad;
-    AMG_data *mgl_curlgrad = hxdivdata->mgl_curlgrad;
-    maxit = amgparam_curlgrad->maxit;
+#ifdef _OPENMP
+#pragma omp section
+#endif
+        {
+            // solve curl vector Laplacian
+            SHORT i, maxit = amgparam_curlgrad->maxit;
 
-    REAL *temp = (REAL*)calloc(hxdivdata->Curlt->row,sizeof(REAL));
-    dcsr_mxv(hxdivdata->Curlt, r, temp);
-    mgl_curlgrad->b.row = hxdivdata->Pt_curl->row;
-    dcsr_mxv(hxdivdata->Pt_curl, temp, mgl_curlgrad->b.val);
-    dvec_set(hxdivdata->A_curlgrad->row, &mgl_curlgrad->x, 0.0);
+            mgl_curlgrad->b.row = hxdivdata->Pt_curl->row;
+            dcsr_mxv(hxdivdata->Pt_curl, temp2, mgl_curlgrad->b.val);
+            dvec_set(hxdivdata->A_curlgrad->row, &mgl_curlgrad->x, 0.0);
 
-    for (i=0;i<maxit;++i) mgcycle(mgl_curlgrad, amgparam_curlgrad);
-    //dcsr_pvfgmres(hxdivdata->A_curlgrad, &mgl_curlgrad->b, &mgl_curlgrad->x, NULL, 1e-3, 1000, 1000, 1, 1);
-    //directsolve_UMF(hxdivdata->A_curlgrad, &(mgl_curlgrad->b), &(mgl_curlgrad->x),1);
+            for (i=0;i<maxit;++i) mgcycle(mgl_curlgrad, amgparam_curlgrad);
+            //dcsr_pvfgmres(hxdivdata->A_curlgrad, &mgl_curlgrad->b, &mgl_curlgrad->x, NULL, 1e-3, 1000, 1000, 1, 1);
+            //directsolve_UMF(hxdivdata->A_curlgrad, &(mgl_curlgrad->b), &(mgl_curlgrad->x),1);
 
-    dcsr_mxv(hxdivdata->P_curl, mgl_curlgrad->x.val, temp);
-    dcsr_aAxpy(1.0, hxdivdata->Curl, temp, z);
-    /*
-    for(j=0;j<n;j++){
-      if(z[j]!=z[j]){ printf("z[%d]=%f\n",j,z[j]);}
+            dcsr_mxv(hxdivdata->P_curl, mgl_curlgrad->x.val, temp);
+            dcsr_mxv(hxdivdata->Curl, temp, z_curlgrad);
+        }
     }
-    */
 
-    // free
-    free(temp);
-    free(temp1);
-    free(temp2);
+    // sum up the corrections
+    array_axpy(n, 1.0, z_divgrad, z);
+    array_axpy(n, 1.0, z_curl, z);
+    array_axpy(n, 1.0, z_curlgrad, z);
+
 }
 
 /***********************************************************************************************/
@@ -1272,7 +1427,6 @@ void precond_block_diag_2(REAL *r,
                           REAL *z,
                           void *data)
 {
-#if WITH_SUITESPARSE
   precond_block_data *precdata=(precond_block_data *)data;
   dCSRmat *A_diag = precdata->A_diag;
   dvector *tempr = &(precdata->r);
@@ -1312,7 +1466,6 @@ void precond_block_diag_2(REAL *r,
   // restore r
   array_cp(N, tempr->val, r);
 
-#endif
 }
 
 /***********************************************************************************************/
@@ -1459,7 +1612,6 @@ void precond_block_lower_2(REAL *r,
                            REAL *z,
                            void *data)
 {
-#if WITH_SUITESPARSE
 
   precond_block_data *precdata=(precond_block_data *)data;
   block_dCSRmat *A = precdata->Abcsr;
@@ -1503,7 +1655,6 @@ void precond_block_lower_2(REAL *r,
   // restore r
   array_cp(N, tempr->val, r);
 
-#endif
 
 }
 
@@ -1662,7 +1813,6 @@ void precond_block_upper_2(REAL *r,
                            REAL *z,
                            void *data)
 {
-#if WITH_SUITESPARSE
 
   precond_block_data *precdata=(precond_block_data *)data;
   block_dCSRmat *A = precdata->Abcsr;
@@ -1706,7 +1856,6 @@ void precond_block_upper_2(REAL *r,
   // restore r
   array_cp(N, tempr->val, r);
 
-#endif
 
 }
 
@@ -1863,7 +2012,6 @@ void precond_block_diag_3(REAL *r,
                           REAL *z,
                           void *data)
 {
-#if WITH_SUITESPARSE
     precond_block_data *precdata=(precond_block_data *)data;
     dCSRmat *A_diag = precdata->A_diag;
     dvector *tempr = &(precdata->r);
@@ -1903,7 +2051,6 @@ void precond_block_diag_3(REAL *r,
     // restore r
     array_cp(N, tempr->val, r);
 
-#endif
 }
 
 /***********************************************************************************************/
@@ -2069,7 +2216,6 @@ void precond_block_lower_3(REAL *r,
                            REAL *z,
                            void *data)
 {
-#if WITH_SUITESPARSE
 
     precond_block_data *precdata=(precond_block_data *)data;
     block_dCSRmat *A = precdata->Abcsr;
@@ -2122,7 +2268,6 @@ void precond_block_lower_3(REAL *r,
     // restore r
     array_cp(N, tempr->val, r);
 
-#endif
 
 }
 
@@ -2311,7 +2456,6 @@ void precond_block_upper_3(REAL *r,
                            REAL *z,
                            void *data)
 {
-#if WITH_SUITESPARSE
 
     precond_block_data *precdata=(precond_block_data *)data;
     block_dCSRmat *A = precdata->Abcsr;
@@ -2364,7 +2508,6 @@ void precond_block_upper_3(REAL *r,
     // restore r
     array_cp(N, tempr->val, r);
 
-#endif
 
 }
 
@@ -2552,7 +2695,6 @@ void precond_block_diag_4(REAL *r,
                           REAL *z,
                           void *data)
 {
-#if WITH_SUITESPARSE
     precond_block_data *precdata=(precond_block_data *)data;
     dCSRmat *A_diag = precdata->A_diag;
     dvector *tempr = &(precdata->r);
@@ -2604,7 +2746,6 @@ void precond_block_diag_4(REAL *r,
     // restore r
     array_cp(N, tempr->val, r);
 
-#endif
 }
 
 /***********************************************************************************************/
@@ -2708,7 +2849,6 @@ void precond_block_diag_4_amg_krylov(REAL *r,
                                      REAL *z,
                                      void *data)
 {
-#if WITH_SUITESPARSE
     precond_block_data *precdata=(precond_block_data *)data;
     dCSRmat *A_diag = precdata->A_diag;
     dvector *tempr = &(precdata->r);
@@ -2783,7 +2923,6 @@ void precond_block_diag_4_amg_krylov(REAL *r,
     // restore r
     array_cp(N, tempr->val, r);
 
-#endif
 }
 
 /***********************************************************************************************/
@@ -2808,7 +2947,6 @@ void precond_block_lower_4(REAL *r,
                            REAL *z,
                            void *data)
 {
-#if WITH_SUITESPARSE
 
     precond_block_data *precdata=(precond_block_data *)data;
     block_dCSRmat *A = precdata->Abcsr;
@@ -2881,7 +3019,6 @@ void precond_block_lower_4(REAL *r,
     // restore r
     array_cp(N, tempr->val, r);
 
-#endif
 
 }
 
@@ -3134,7 +3271,6 @@ void precond_block_upper_4(REAL *r,
                            REAL *z,
                            void *data)
 {
-#if WITH_SUITESPARSE
 
     precond_block_data *precdata=(precond_block_data *)data;
     block_dCSRmat *A = precdata->Abcsr;
@@ -3207,7 +3343,6 @@ void precond_block_upper_4(REAL *r,
     // restore r
     array_cp(N, tempr->val, r);
 
-#endif
 
 }
 
@@ -3561,7 +3696,6 @@ void precond_block_diag(REAL *r,
                           REAL *z,
                           void *data)
 {
-#if WITH_SUITESPARSE
   precond_block_data *precdata=(precond_block_data *)data;
   dCSRmat *A_diag = precdata->A_diag;
   dvector *tempr = &(precdata->r);
@@ -3604,7 +3738,6 @@ void precond_block_diag(REAL *r,
   // restore r
   array_cp(N, tempr->val, r);
 
-#endif
 }
 
 
@@ -5733,6 +5866,10 @@ void precond_block2_babuska_upper(REAL *r,
  *                  by using algorithm Ludmil provided;
  * \note 2021-10-28 here we solve for both pole=a+ib and pole=a-ib even though
  *                  the solving process is the same; FIXME
+ * \note The poles are solved concurrently (OpenMP), each with its own
+ *       preconditioner data and update vector (a slot of precdata->zpoles,
+ *       allocated once); the updates are summed into z in pole order, so the
+ *       result does not depend on the number of threads.
  */
 void precond_ra_fenics(REAL *r, REAL *z, void *data)
 {
@@ -5788,12 +5925,9 @@ void precond_ra_fenics(REAL *r, REAL *z, void *data)
     pc_scaled_M.data = diag_scaled_M;
     pc_scaled_M.fct  = precond_diag;
 
-    // pc for krylov for shifted Laplacians
-    precond pc_frac_A;
-    pc_frac_A.fct = precond_amg;
+    // pc parameters for krylov for shifted Laplacians (each pole gets its own copy)
     precond_data pcdata;
     param_amg_to_prec(&pcdata, amgparam);
-    pc_frac_A.data = &pcdata;
 
     /*----------------------------------------*/
 
@@ -5819,14 +5953,32 @@ void precond_ra_fenics(REAL *r, REAL *z, void *data)
         array_ax(n, residues->val[0], z_vec.val);
     }
 
-    dvector update = dvec_create(n);
-    /* dvector u000 = dvec_create(n); */
-    // INT solver_flag,jjj;
-    /* printf("\nNumber of poles: %d\n", npoles); */
-    // INT count = 0;
+    // contributions of the poles: the poles are independent shifted solves with
+    // their own AMG hierarchies, so they are done concurrently, each one into
+    // its own slot of zpoles, and summed into z afterwards (in pole order);
+    // every slot is zeroed by its pole before it is used
+    if(precdata->zpoles == NULL)
+        precdata->zpoles = (REAL *)calloc(MAX(npoles,1)*n, sizeof(REAL));
+    REAL *zpoles = precdata->zpoles;
 
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic,1) private(status)
+#endif
     for(i = 0; i < npoles; ++i) {
 
+        // per-pole preconditioner and workspace
+        precond_data pcdata_i = pcdata;
+        pcdata_i.max_levels = mgl[i]->num_levels;
+        pcdata_i.mgl_data = mgl[i];
+
+        precond pc_i;
+        pc_i.fct  = precond_amg;
+        pc_i.data = &pcdata_i;
+
+        dvector update;
+        update.row = n;
+        update.val = zpoles + (size_t)i*n;
+
         if(fabs(poles->val[i+npoles]) > 0.) {
             // then we have a nonzero imag part of that pole and we do the 2x2 block algorithm
             /* solve
@@ -5855,25 +6007,25 @@ void precond_ra_fenics(REAL *r, REAL *z, void *data)
                 dvec_axpy(p_im, &update, &rhs2);
 
                 // (1) solve (A - Re(pole)*I) update = rhs1
-                status = dcsr_pcg(&(mgl[i][0].A), &rhs1, &update, &pc_frac_A, 1e-6, 100, 1, 0);
+                status = dcsr_pcg(&(mgl[i][0].A), &rhs1, &update, &pc_i, 1e-6, 100, 1, 0);
 		if(status<SUCCESS)
 		  WARN_STATUS(__FUNCTION__,"dcsr_pcg((1) solve...)",status);
                 // (2) solve (A - Re(pole)*I) iupdate = rhs2
-                status = dcsr_pcg(&(mgl[i][0].A), &rhs2, &iupdate, &pc_frac_A, 1e-6, 100, 1, 0);
+                status = dcsr_pcg(&(mgl[i][0].A), &rhs2, &iupdate, &pc_i, 1e-6, 100, 1, 0);
 		if(status<SUCCESS)
 		  WARN_STATUS(__FUNCTION__,"dcsr_pcg((2) solve...)",status);
             }
 
-            // update next increment
+            // contribution of this pole
             // first check if Im(residue) > 0
             if(fabs(residues->val[(npoles+1)+i+1]) > 0.) {
-                // z = z + residues[i+1]*update - residues[npoles+1+i+1]*iupdate
-                array_axpy(n, 2*residues->val[i+1], update.val, z_vec.val);
-                array_axpy(n, -2*residues->val[(npoles+1)+i+1], iupdate.val, z_vec.val);
+                // upd = residues[i+1]*update - residues[npoles+1+i+1]*iupdate
+                array_ax(n, 2*residues->val[i+1], update.val);
+                array_axpy(n, -2*residues->val[(npoles+1)+i+1], iupdate.val, update.val);
             }
             else {
-                // z = z + residues[i+1]*update
-                array_axpy(n, 2*residues->val[i+1], update.val, z_vec.val);
+                // upd = residues[i+1]*update
+                array_ax(n, 2*residues->val[i+1], update.val);
             }
 
             // free memory
@@ -5887,35 +6039,22 @@ void precond_ra_fenics(REAL *r, REAL *z, void *data)
             mgl[i]->b.row = n; array_cp(n, r_vec.val, mgl[i]->b.val); // residual is an input
             mgl[i]->x.row = n; dvec_set(n, &mgl[i]->x, 0.0);
 
-            // set precond data and param
-            pcdata.max_levels = mgl[i]->num_levels;
-            pcdata.mgl_data = mgl[i];
-
             // set update to zero
             dvec_set(update.row, &update, 0.0);
 
             // solve
-            // printf("\tPole %d, norm of r = %e\n", i, dvec_norm2(&r_vec));
-            // status = dcsr_pvfgmres(&(mgl[i][0].A), &r1, &update, &pc_frac_A, 1e-6, 100, 100, 1, 1);
-            status = dcsr_pcg(&(mgl[i][0].A), &r_vec, &update, &pc_frac_A, 1e-6, 100, 1, 0);
+            status = dcsr_pcg(&(mgl[i][0].A), &r_vec, &update, &pc_i, 1e-6, 100, 1, 0);
 	    if(status<SUCCESS)
 	      WARN_STATUS(__FUNCTION__,"dcsr_pcg(...)",status);
-            /* void *numeric=NULL;  // prepare for direct solve.
-            numeric=factorize_UMF(&(mgl[i][0].A),0);
-            solver_flag=(INT )solve_UMF(&(mgl[i][0].A),	\
-                              &r_vec,		\
-                              &update,		\
-                              numeric,
-                              0);
-            free(numeric); */
-            // if(status > 0) count += status;
-            // printf("\tPole %d, norm of update = %e\n", i, dvec_norm2(&update));
-            // z = z + residues[i+1]*update
-            array_axpy(n, residues->val[i+1], update.val, z_vec.val);
-            /* for(jjj=0;jjj<z_vec.row;jjj++) z[jjj]=z_vec.val[jjj]; */
+
+            // upd = residues[i+1]*update
+            array_ax(n, residues->val[i+1], update.val);
         }
     }
 
+    // z = z + sum of the contributions of the poles
+    for(i = 0; i < npoles; ++i) array_axpy(n, 1.0, zpoles + (size_t)i*n, z_vec.val);
+
     // if(count) printf("Inner solver took total of %d iterations. \n", count);
 
     // cleanup
@@ -5926,7 +6065,6 @@ void precond_ra_fenics(REAL *r, REAL *z, void *data)
     else {
       dvec_ax(scaled_beta, &r_vec);
     }
-    dvec_free(&update);
     //    dvec_free(&r_vec);
     /* dvec_free(&z_vec); */
     return;
@@ -0,0 +1,373 @@
+/*! \file src/solver/sai_setup.c
+ *
+ *  Setup phase for the sparse approximate inverse preconditioners
+ *
+ *  Copyright 2015__HAZMATH__. All rights reserved.
+ *
+ *  \note  FSAI: factorized sparse approximate inverse G^T*G ~ A^{-1} of an SPD
+ *         matrix, G lower triangular. SPAI: left approximate inverse M ~ A^{-1}
+ *         minimizing ||I - M*A||_F row by row. The sparsity pattern of G (or M)
+ *         is the graph of A^k, k = sai_levels. Every row is an independent
+ *         small dense problem, so the rows are computed in parallel (OpenMP),
+ *         and applying the preconditioner is only sparse matrix-vector products.
+ *
+ */
+
+#include "hazmath.h"
+
+/*---------------------------------*/
+/*--      Private Functions      --*/
+/*---------------------------------*/
+/***********************************************************************************************/
+/**
+ * \fn static void sai_pattern (dCSRmat *A, const INT levels, const SHORT lower,
+ *                              dCSRmat *G)
+ *
+ * \brief Sparsity pattern of the graph of A^levels (sorted rows, values allocated
+ *        but not set)
+ *
+ * \param A       Pointer to the dCSRmat matrix
+ * \param levels  Power of the graph of A (0 gives the diagonal only)
+ * \param lower   TRUE: keep only the lower triangular part (including diagonal)
+ * \param G       Pointer to the pattern (OUTPUT)
+ *
+ */
+static void sai_pattern(dCSRmat *A,
+                        const INT levels,
+                        const SHORT lower,
+                        dCSRmat *G)
+{
+    const INT n = A->row;
+    const INT *ia = A->IA, *ja = A->JA;
+
+    INT i, j, k, p, lev, start, end, len, cnt;
+    INT cap = MAX(A->nnz,1);
+
+    INT *mark = (INT *)calloc(MAX(n,1), sizeof(INT));
+    INT *list = (INT *)calloc(MAX(n,1), sizeof(INT));
+
+    for (i=0; i<n; ++i) mark[i] = -1;
+
+    G->row = n; G->col = n; G->nnz = 0;
+    G->IA  = (INT *)calloc(n+1, sizeof(INT));
+    G->JA  = (INT *)calloc(cap, sizeof(INT));
+
+    for (i=0; i<n; ++i) {
+
+        // breadth first search of depth levels starting from i
+        list[0] = i; mark[i] = i; len = 1; start = 0;
+        for (lev=0; lev<levels; ++lev) {
+            end = len;
+            for (p=start; p<end; ++p) {
+                for (k=ia[list[p]]; k<ia[list[p]+1]; ++k) {
+                    j = ja[k];
+                    if (mark[j] != i) { mark[j] = i; list[len++] = j; }
+                }
+            }
+            if (end == len) break;
+            start = end;
+        }
+
+        // keep (lower part of) the pattern
+        cnt = 0;
+        for (p=0; p<len; ++p) {
+            if ( !lower || list[p] <= i ) list[cnt++] = list[p];
+        }
+        isi_sort(cnt, list);
+
+        if (G->nnz + cnt > cap) {
+            cap = MAX(2*cap, G->nnz + cnt);
+            G->JA = (INT *)realloc(G->JA, cap*sizeof(INT));
+        }
+        iarray_cp(cnt, list, G->JA + G->nnz);
+        G->nnz += cnt;
+        G->IA[i+1] = G->nnz;
+    }
+
+    G->JA  = (INT *)realloc(G->JA, MAX(G->nnz,1)*sizeof(INT));
+    G->val = (REAL *)calloc(MAX(G->nnz,1), sizeof(REAL));
+
+    free(mark);
+    free(list);
+}
+
+/***********************************************************************************************/
+/**
+ * \fn static REAL sai_diag (dCSRmat *A, const INT i)
+ *
+ * \brief Diagonal entry A(i,i) (0 if not stored)
+ *
+ */
+static REAL sai_diag(dCSRmat *A,
+                     const INT i)
+{
+    INT k;
+    for (k=A->IA[i]; k<A->IA[i+1]; ++k) {
+        if (A->JA[k] == i) return A->val[k];
+    }
+    return 0.0;
+}
+
+/***********************************************************************************************/
+/**
+ * \fn static INT sai_fsai_numeric (dCSRmat *A, dCSRmat *G)
+ *
+ * \brief Values of the FSAI factor G on a given lower triangular pattern:
+ *        A(J,J) y = e_i and G(i,J) = y/sqrt(y_i) for every row i
+ *
+ * \param A   Pointer to the dCSRmat matrix (SPD)
+ * \param G   Pointer to the FSAI factor (IN: pattern, OUT: values)
+ *
+ * \return    Number of rows where the local problem failed and Jacobi was used
+ *
+ */
+static INT sai_fsai_numeric(dCSRmat *A,
+                            dCSRmat *G)
+{
+    const INT n = A->row;
+    INT i, nmax = 1, nfail = 0;
+
+    for (i=0; i<n; ++i) nmax = MAX(nmax, G->IA[i+1]-G->IA[i]);
+
+#ifdef _OPENMP
+#pragma omp parallel private(i) reduction(+:nfail)
+#endif
+    {
+        INT ii, jj, k, c, r, nJ, *J;
+        REAL yii, aii, *y;
+        INT  *pos = (INT *)calloc(MAX(n,1), sizeof(INT));
+        INT  *p   = (INT *)calloc(nmax, sizeof(INT));
+        REAL *piv = (REAL *)calloc(nmax, sizeof(REAL));
+        REAL *D   = (REAL *)calloc(nmax*nmax, sizeof(REAL));
+
+        for (ii=0; ii<n; ++ii) pos[ii] = -1;
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic,64)
+#endif
+        for (i=0; i<n; ++i) {
+
+            J  = G->JA  + G->IA[i];
+            y  = G->val + G->IA[i];
+            nJ = G->IA[i+1] - G->IA[i];
+
+            // D = A(J,J), row-major
+            for (jj=0; jj<nJ; ++jj) pos[J[jj]] = jj;
+            array_set(nJ*nJ, D, 0.0);
+            for (jj=0; jj<nJ; ++jj) {
+                r = J[jj];
+                for (k=A->IA[r]; k<A->IA[r+1]; ++k) {
+                    c = pos[A->JA[k]];
+                    if (c >= 0) D[jj*nJ+c] = A->val[k];
+                }
+            }
+            for (jj=0; jj<nJ; ++jj) pos[J[jj]] = -1;
+
+            // the pattern is sorted, so i is the last entry
+            array_set(nJ, y, 0.0);
+            y[nJ-1] = 1.0;
+            ddense_solve_pivot(1, nJ, D, y, p, piv);
+
+            yii = y[nJ-1];
+            if ( yii > SMALLREAL && isfinite(yii) ) {
+                array_ax(nJ, 1.0/sqrt(yii), y);
+            }
+            else { // fall back to Jacobi on this row
+                aii = ABS(sai_diag(A, i));
+                array_set(nJ, y, 0.0);
+                y[nJ-1] = (aii > SMALLREAL) ? 1.0/sqrt(aii) : 1.0;
+                nfail++;
+            }
+        }
+
+        free(pos);
+        free(p);
+        free(piv);
+        free(D);
+    }
+
+    return nfail;
+}
+
+/***********************************************************************************************/
+/**
+ * \fn static INT sai_spai_numeric (dCSRmat *A, dCSRmat *M)
+ *
+ * \brief Values of the left SPAI M on a given pattern: for every row i,
+ *        min ||e_i^T - M(i,J) A(J,:)||_2 solved by QR of A(J,I)^T, where I is
+ *        the set of nonzero columns of A(J,:)
+ *
+ * \param A   Pointer to the dCSRmat matrix
+ * \param M   Pointer to the approximate inverse (IN: pattern, OUT: values)
+ *
+ * \return    Number of rows where the local problem failed and Jacobi was used
+ *
+ */
+static INT sai_spai_numeric(dCSRmat *A,
+                            dCSRmat *M)
+{
+    const INT n = A->row;
+    INT i, jj, mi, nmax = 1, mmax = 1, nfail = 0;
+
+    for (i=0; i<n; ++i) {
+        mi = 0;
+        for (jj=M->IA[i]; jj<M->IA[i+1]; ++jj)
+            mi += A->IA[M->JA[jj]+1] - A->IA[M->JA[jj]];
+        mmax = MAX(mmax, mi);
+        nmax = MAX(nmax, M->IA[i+1]-M->IA[i]);
+    }
+
+#ifdef _OPENMP
+#pragma omp parallel private(i) reduction(+:nfail)
+#endif
+    {
+        INT ii, kk, k, l, c, r, m, nJ, posi, *J;
+        REAL s, aii, *x;
+        SHORT fail;
+        INT  *pos = (INT *)calloc(MAX(A->col,1), sizeof(INT));
+        INT  *I   = (INT *)calloc(mmax, sizeof(INT));
+        REAL *B   = (REAL *)calloc(mmax*nmax, sizeof(REAL));
+        REAL *Q   = (REAL *)calloc(mmax*nmax, sizeof(REAL));
+        REAL *R   = (REAL *)calloc(nmax*nmax, sizeof(REAL));
+
+        for (ii=0; ii<A->col; ++ii) pos[ii] = -1;
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic,64)
+#endif
+        for (i=0; i<n; ++i) {
+
+            J  = M->JA  + M->IA[i];
+            x  = M->val + M->IA[i];
+            nJ = M->IA[i+1] - M->IA[i];
+
+            // nonzero columns I of A(J,:)
+            m = 0;
+            for (kk=0; kk<nJ; ++kk) {
+                r = J[kk];
+                for (k=A->IA[r]; k<A->IA[r+1]; ++k) {
+                    c = A->JA[k];
+                    if (pos[c] < 0) { pos[c] = m; I[m++] = c; }
+                }
+            }
+            posi = (i < A->col) ? pos[i] : -1;
+
+            fail = (m < nJ || posi < 0);
+
+            if (!fail) {
+                // B = A(J,I)^T, column-major m x nJ
+                array_set(m*nJ, B, 0.0);
+                for (kk=0; kk<nJ; ++kk) {
+                    r = J[kk];
+                    for (k=A->IA[r]; k<A->IA[r+1]; ++k)
+                        B[kk*m+pos[A->JA[k]]] = A->val[k];
+                }
+
+                ddense_qr(m, nJ, B, Q, R);
+
+                // R x = Q^T e_i
+                for (k=nJ-1; k>=0; --k) {
+                    s = Q[k*m+posi];
+                    for (l=k+1; l<nJ; ++l) s -= R[k*nJ+l]*x[l];
+                    x[k] = s/R[k*nJ+k];
+                    if (!isfinite(x[k])) { fail = TRUE; break; }
+                }
+            }
+
+            for (kk=0; kk<m; ++kk) pos[I[kk]] = -1;
+
+            if (fail) { // fall back to Jacobi on this row
+                aii = sai_diag(A, i);
+                for (kk=0; kk<nJ; ++kk)
+                    x[kk] = (J[kk] == i && ABS(aii) > SMALLREAL) ? 1.0/aii : 0.0;
+                nfail++;
+            }
+        }
+
+        free(pos);
+        free(I);
+        free(B);
+        free(Q);
+        free(R);
+    }
+
+    return nfail;
+}
+
+/*---------------------------------*/
+/*--      Public Functions       --*/
+/*---------------------------------*/
+/***********************************************************************************************/
+/**
+ * \fn SHORT sai_setup (dCSRmat *A, SAI_data *saidata, const SHORT sai_type,
+ *                      const INT sai_levels, const SHORT prtlvl)
+ *
+ * \brief Setup phase of the sparse approximate inverse preconditioner
+ *
+ * \param A            Pointer to the dCSRmat matrix
+ * \param saidata      Pointer to the SAI data (OUTPUT)
+ * \param sai_type     FSAI: G^T*G ~ A^{-1} (A SPD) | SPAI: M ~ A^{-1}
+ * \param sai_levels   The pattern is the graph of A^sai_levels
+ * \param prtlvl       Print level
+ *
+ * \return             SUCCESS if succeed; ERROR otherwise
+ *
+ */
+SHORT sai_setup(dCSRmat *A,
+                SAI_data *saidata,
+                const SHORT sai_type,
+                const INT sai_levels,
+                const SHORT prtlvl)
+{
+    const INT n = A->row;
+    INT nfail = 0;
+    REAL setup_start, setup_end;
+
+    if (A->row != A->col) {
+        printf("### ERROR HAZMATH DANGER: %s: SAI needs a square matrix!\n", __FUNCTION__);
+        return ERROR_MAT_SIZE;
+    }
+
+    get_time(&setup_start);
+
+    SAI_data_null(saidata);
+    saidata->row  = n;
+    saidata->type = sai_type;
+
+    switch (sai_type) {
+
+        case FSAI:
+            sai_pattern(A, MAX(sai_levels,0), TRUE, &saidata->G);
+            nfail = sai_fsai_numeric(A, &saidata->G);
+            dcsr_trans(&saidata->G, &saidata->Gt);
+            saidata->w = (REAL *)calloc(MAX(n,1), sizeof(REAL));
+            break;
+
+        case SPAI:
+            sai_pattern(A, MAX(sai_levels,0), FALSE, &saidata->G);
+            nfail = sai_spai_numeric(A, &saidata->G);
+            break;
+
+        default:
+            printf("### ERROR HAZMATH DANGER: %s: Unknown SAI type %d!\n", __FUNCTION__, sai_type);
+            SAI_data_free(saidata);
+            return ERROR_SOLVER_PRECTYPE;
+
+    }
+
+    // work space of smoother_dcsr_sai()
+    saidata->work = (REAL *)calloc(2*MAX(n,1), sizeof(REAL));
+
+    if ( prtlvl >= PRINT_MIN ) {
+        get_time(&setup_end);
+        printf("%s: nnz = %d (ratio %.2f)\n", (sai_type == FSAI) ? "FSAI" : "SPAI",
+               saidata->G.nnz, (REAL)saidata->G.nnz/(REAL)MAX(A->nnz,1));
+        if (nfail > 0)
+            printf("### HAZMATH WARNING: SAI used Jacobi on %d rows!\n", nfail);
+        print_cputime("SAI setup", setup_end - setup_start);
+    }
+
+    return SUCCESS;
+}
+
+/*************************************  END  ***************************************************/
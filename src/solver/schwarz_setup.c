@@ -199,7 +199,6 @@ INT Schwarz_setup (Schwarz_data *Schwarz,
     // Setup for each block solver
     switch (block_solver) {
 
-#if WITH_SUITESPARSE
         case SOLVER_UMFPACK: {
             /* use UMFPACK direct solver on each block */
             dCSRmat *blk = Schwarz->blk_data;
@@ -218,7 +217,6 @@ INT Schwarz_setup (Schwarz_data *Schwarz,
 
             break;
         }
-#endif
 
         default: {
             /* do nothing for iterative methods */
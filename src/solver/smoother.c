@@ -380,6 +380,45 @@ void smoother_dcsr_L1diag(dvector *u,
     return;
 }
 
+/**
+ * \fn void smoother_dcsr_sai (dvector *u, dCSRmat *A, dvector *b, INT L,
+ *                             SAI_data *saidata)
+ *
+ * \brief Sparse approximate inverse smoother u = u + M*(b - A*u), M = G^T*G (FSAI)
+ *        or M = G (SPAI)
+ *
+ * \param u        Pointer to dvector: the unknowns (IN: initial, OUT: approximation)
+ * \param A        Pointer to dCSRmat: the coefficient matrix
+ * \param b        Pointer to dvector: the right hand side
+ * \param L        Number of iterations
+ * \param saidata  Pointer to SAI_data: the approximate inverse of A
+ *
+ */
+void smoother_dcsr_sai(dvector *u,
+                       dCSRmat *A,
+                       dvector *b,
+                       INT L,
+                       SAI_data *saidata)
+{
+    const INT n = A->row;
+
+    // work space allocated in sai_setup()
+    REAL *t = saidata->work;
+    REAL *d = saidata->work + n;
+
+    while (L--) {
+        // t = b - A u
+        array_cp(n, b->val, t);
+        dcsr_aAxpy(-1.0, A, u->val, t);
+
+        // u = u + M t
+        precond_sai(t, d, saidata);
+        array_axpy(n, 1.0, d, u->val);
+    }
+
+    return;
+}
+
 /**
  * \fn void smoother_dcsr_Schwarz_forward (Schwarz_data  *Schwarz,
  *                                         Schwarz_param *param,
@@ -420,9 +459,7 @@ void smoother_dcsr_Schwarz_forward (Schwarz_data  *Schwarz,
     dvector rhs = Schwarz->rhsloc1;
     dvector u   = Schwarz->xloc1;
 
-#if WITH_SUITESPARSE
     void **numeric = Schwarz->numeric;
-#endif
 
     for (is=0; is<nblk; ++is) {
         // Form the right hand of eack block
@@ -453,13 +490,11 @@ void smoother_dcsr_Schwarz_forward (Schwarz_data  *Schwarz,
         // Solve each block
         switch (block_solver) {
 
-#if WITH_SUITESPARSE
             case SOLVER_UMFPACK: {
                 /* use UMFPACK direct solver on each block */
                 umfpack_solve(&blk[is], &rhs, &u, numeric[is], 0);
                 break;
             }
-#endif
             default:
                 /* use iterative solver on each block */
                 u.row = blk[is].row;
@@ -522,9 +557,7 @@ void smoother_dcsr_Schwarz_forward_additive (Schwarz_data  *Schwarz,
     dvector averaging_factor = dvec_create( x->row );
     dvector xout = dvec_create( x->row );//TODO: need to allocate
 
-#if WITH_SUITESPARSE
     void **numeric = Schwarz->numeric;
-#endif
 
     for (is=0; is<nblk; ++is) {
         // Form the right hand of eack block
@@ -555,13 +588,11 @@ void smoother_dcsr_Schwarz_forward_additive (Schwarz_data  *Schwarz,
         // Solve each block
         switch (block_solver) {
 
-#if WITH_SUITESPARSE
             case SOLVER_UMFPACK: {
                 /* use UMFPACK direct solver on each block */
                 umfpack_solve(&blk[is], &rhs, &u, numeric[is], 0);
                 break;
             }
-#endif
             default:
                 /* use iterative solver on each block */
                 u.row = blk[is].row;
@@ -634,9 +665,7 @@ void smoother_dcsr_Schwarz_backward (Schwarz_data *Schwarz,
     dvector rhs = Schwarz->rhsloc1;
     dvector u   = Schwarz->xloc1;
 
-#if WITH_SUITESPARSE
     void **numeric = Schwarz->numeric;
-#endif
 
     for (is=nblk-1; is>=0; --is) {
         // Form the right hand of eack block
@@ -667,13 +696,11 @@ void smoother_dcsr_Schwarz_backward (Schwarz_data *Schwarz,
         // Solve each block
         switch (block_solver) {
 
-#if WITH_SUITESPARSE
             case SOLVER_UMFPACK: {
                 /* use UMFPACK direct solver on each block */
                 umfpack_solve(&blk[is], &rhs, &u, numeric[is], 0);
                 break;
             }
-#endif
             default:
                 /* use iterative solver on each block */
                 rhs.row = blk[is].row;
@@ -736,9 +763,7 @@ void smoother_dcsr_Schwarz_backward_additive (Schwarz_data *Schwarz,
     dvector averaging_factor = dvec_create( x->row );
     dvector xout = dvec_create( x->row );//TODO: need to allocate
 
-#if WITH_SUITESPARSE
     void **numeric = Schwarz->numeric;
-#endif
 
     for (is=nblk-1; is>=0; --is) {
         // Form the right hand of eack block
@@ -769,13 +794,11 @@ void smoother_dcsr_Schwarz_backward_additive (Schwarz_data *Schwarz,
         // Solve each block
         switch (block_solver) {
 
-#if WITH_SUITESPARSE
             case SOLVER_UMFPACK: {
                 /* use UMFPACK direct solver on each block */
                 umfpack_solve(&blk[is], &rhs, &u, numeric[is], 0);
                 break;
             }
-#endif
             default:
                 /* use iterative solver on each block */
                 rhs.row = blk[is].row;
@@ -200,5 +200,237 @@ void one_coeff_vec3D(REAL *val,
     val[1] = 1.0;
     val[2] = 1.0;
 }
+/****************************************************************************************/
+
+/****************************************************************************************/
+/*  Batched coefficient functions
+ *
+ *  A batched function evaluates a pointwise function
+ *      void f(REAL *val,REAL *x,REAL time,void *param)
+ *  at np points in one call:
+ *      void fb(REAL *val,REAL *x,INT np,REAL time,void *param)
+ *  with x ordered x(p0) y(p0) z(p0) x(p1) ... and val ordered the same way
+ *  (all values at point 0, then at point 1, ...).  param is the same as for
+ *  the pointwise function (e.g. the flag of the element the points lie in).
+ *
+ *  A batched version is attached to a pointwise function with
+ *  register_batched_function(); the assembly and error routines keep taking
+ *  the pointwise function and use the batched one if it is registered.
+ */
+#define MAX_BATCHED_FUNCTIONS 64
+
+static void fill_batch(REAL *val,INT n,REAL c)
+{
+  INT i;
+  for(i=0;i<n;i++) val[i] = c;
+}
+static void constant_coeff_scal_batch(REAL *val,REAL *x,INT np,REAL constval,void *param)
+{ fill_batch(val,np,constval); }
+static void constant_coeff_vec2D_batch(REAL *val,REAL *x,INT np,REAL constval,void *param)
+{ fill_batch(val,2*np,constval); }
+static void constant_coeff_vec3D_batch(REAL *val,REAL *x,INT np,REAL constval,void *param)
+{ fill_batch(val,3*np,constval); }
+static void zero_coeff_scal_batch(REAL *val,REAL *x,INT np,REAL time,void *param)
+{ fill_batch(val,np,0.0); }
+static void zero_coeff_vec2D_batch(REAL *val,REAL *x,INT np,REAL time,void *param)
+{ fill_batch(val,2*np,0.0); }
+static void zero_coeff_vec3D_batch(REAL *val,REAL *x,INT np,REAL time,void *param)
+{ fill_batch(val,3*np,0.0); }
+static void one_coeff_scal_batch(REAL *val,REAL *x,INT np,REAL time,void *param)
+{ fill_batch(val,np,1.0); }
+static void one_coeff_vec2D_batch(REAL *val,REAL *x,INT np,REAL time,void *param)
+{ fill_batch(val,2*np,1.0); }
+static void one_coeff_vec3D_batch(REAL *val,REAL *x,INT np,REAL time,void *param)
+{ fill_batch(val,3*np,1.0); }
+
+// Pointwise functions with a batched version, hashed on the address of the
+// pointwise function (open addressing, linear probing).  The table is at most
+// half full, so a lookup, done for every element, takes one or two probes.
+#define BATCHED_TABLE_SIZE (2*MAX_BATCHED_FUNCTIONS)
+typedef struct batched_entry {
+  void (*f)(REAL *,REAL *,REAL,void *);
+  void (*fb)(REAL *,REAL *,INT,REAL,void *);
+} batched_entry;
+static batched_entry batched_table[BATCHED_TABLE_SIZE];
+static INT n_batched_functions = 0;
+
+#if WITH_PTHREADS
+#include <pthread.h>
+static pthread_mutex_t batched_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t batched_once = PTHREAD_ONCE_INIT;
+#else
+static INT batched_table_filled = 0;
+#endif
+
+static INT batched_slot(void (*f)(REAL *,REAL *,REAL,void *))
+{
+  size_t h = (size_t )f;
+  h ^= h>>7;
+  h ^= h>>17;
+  return (INT )(h%BATCHED_TABLE_SIZE);
+}
+
+// Slot of f, or of the empty slot where f would go
+static INT find_batched_slot(void (*f)(REAL *,REAL *,REAL,void *))
+{
+  INT i = batched_slot(f);
+  while(batched_table[i].f!=NULL && batched_table[i].f!=f)
+    i = (i+1)%BATCHED_TABLE_SIZE;
+  return i;
+}
+
+static void insert_batched_function(void (*f)(REAL *,REAL *,REAL,void *),void (*fb)(REAL *,REAL *,INT,REAL,void *))
+{
+  INT i = find_batched_slot(f);
+  if(batched_table[i].f==NULL) {
+    if(n_batched_functions==MAX_BATCHED_FUNCTIONS) {
+      printf("\n### ERROR HAZMATH DANGER: %s: more than %d batched functions registered.\n",
+             __FUNCTION__,MAX_BATCHED_FUNCTIONS);
+      check_error(ERROR_ALLOC_MEM,__FUNCTION__);
+    }
+    n_batched_functions++;
+  }
+  batched_table[i].f = f;
+  batched_table[i].fb = fb;
+}
+
+static void remove_batched_function(void (*f)(REAL *,REAL *,REAL,void *))
+{
+  INT i = find_batched_slot(f), j;
+  if(batched_table[i].f==NULL) return;
+  batched_table[i].f = NULL;
+  batched_table[i].fb = NULL;
+  n_batched_functions--;
+  // reinsert the rest of the cluster so that no lookup stops at the hole
+  for(j=(i+1)%BATCHED_TABLE_SIZE;batched_table[j].f!=NULL;j=(j+1)%BATCHED_TABLE_SIZE) {
+    batched_entry e = batched_table[j];
+    batched_table[j].f = NULL;
+    batched_table[j].fb = NULL;
+    batched_table[find_batched_slot(e.f)] = e;
+  }
+}
+
+// The generic functions above are always there
+static void fill_batched_table(void)
+{
+  insert_batched_function(constant_coeff_scal,constant_coeff_scal_batch);
+  insert_batched_function(constant_coeff_vec2D,constant_coeff_vec2D_batch);
+  insert_batched_function(constant_coeff_vec3D,constant_coeff_vec3D_batch);
+  insert_batched_function(zero_coeff_scal,zero_coeff_scal_batch);
+  insert_batched_function(zero_coeff_vec2D,zero_coeff_vec2D_batch);
+  insert_batched_function(zero_coeff_vec3D,zero_coeff_vec3D_batch);
+  insert_batched_function(one_coeff_scal,one_coeff_scal_batch);
+  insert_batched_function(one_coeff_vec2D,one_coeff_vec2D_batch);
+  insert_batched_function(one_coeff_vec3D,one_coeff_vec3D_batch);
+}
+
+static void init_batched_table(void)
+{
+#if WITH_PTHREADS
+  pthread_once(&batched_once,fill_batched_table);
+#else
+  if(!batched_table_filled) {
+    fill_batched_table();
+    batched_table_filled = 1;
+  }
+#endif
+}
+
+/****************************************************************************************/
+/*!
+ * \fn void register_batched_function(void (*f)(REAL *,REAL *,REAL,void *),void (*fb)(REAL *,REAL *,INT,REAL,void *))
+ *
+ * \brief Attaches a batched version fb to the pointwise function f.  Whenever f
+ *        is passed to an assembly or error routine, fb is called once for all
+ *        quadrature nodes of an element instead of f once per node.
+ *
+ * \param f          Pointwise function
+ * \param fb         Batched version of f (NULL removes a registered one)
+ *
+ * \note At most MAX_BATCHED_FUNCTIONS functions can be registered; one more is
+ *       an error.  Registrations are serialized, but the lookups during
+ *       assembly are not locked: register the functions before assembling.
+ *
+ */
+void register_batched_function(void (*f)(REAL *,REAL *,REAL,void *),void (*fb)(REAL *,REAL *,INT,REAL,void *))
+{
+  if(f==NULL) return;
+  init_batched_table();
+#if WITH_PTHREADS
+  pthread_mutex_lock(&batched_lock);
+#endif
+  if(fb==NULL)
+    remove_batched_function(f);
+  else
+    insert_batched_function(f,fb);
+#if WITH_PTHREADS
+  pthread_mutex_unlock(&batched_lock);
+#endif
+  return;
+}
+/****************************************************************************************/
+
+/****************************************************************************************/
+/*!
+ * \fn void evaluate_function_batch(REAL *val,INT nval,void (*f)(REAL *,REAL *,REAL,void *),REAL *x,INT np,INT dim,REAL time,void *param)
+ *
+ * \brief Evaluates f at np points: one call to its batched version if one is
+ *        registered, one call per point otherwise.
+ *
+ * \param val        Values, nval per point (OUTPUT)
+ * \param nval       Number of values of f at a point
+ * \param f          Pointwise function
+ * \param x          Points, ordered x(p0) y(p0) z(p0) x(p1) ...
+ * \param np         Number of points
+ * \param dim        Dimension of the points
+ * \param time       Physical time
+ * \param param      Passed to f
+ *
+ */
+void evaluate_function_batch(REAL *val,INT nval,void (*f)(REAL *,REAL *,REAL,void *),REAL *x,INT np,INT dim,REAL time,void *param)
+{
+  INT i;
+  init_batched_table();
+  i = find_batched_slot(f);
+  if(batched_table[i].f!=NULL) {
+    (*batched_table[i].fb)(val,x,np,time,param);
+    return;
+  }
+  for(i=0;i<np;i++)
+    (*f)(val+i*nval,x+i*dim,time,param);
+  return;
+}
+/****************************************************************************************/
+
+/****************************************************************************************/
+/*!
+ * \fn void evaluate_function_on_elm(REAL *val,REAL *qx,INT nval,void (*f)(REAL *,REAL *,REAL,void *),qcoordinates *cq,INT dim,REAL time,void *param)
+ *
+ * \brief Gathers the quadrature nodes of an element (as computed by quad_elm)
+ *        and evaluates f at all of them (see evaluate_function_batch).
+ *
+ * \param val        Values, nval per quadrature node (OUTPUT, untouched if f is NULL)
+ * \param qx         Quadrature nodes, ordered x(q0) y(q0) z(q0) x(q1) ... (OUTPUT)
+ * \param nval       Number of values of f at a point
+ * \param f          Pointwise function (may be NULL)
+ * \param cq         Quadrature nodes on the element
+ * \param dim        Dimension
+ * \param time       Physical time
+ * \param param      Passed to f
+ *
+ */
+void evaluate_function_on_elm(REAL *val,REAL *qx,INT nval,void (*f)(REAL *,REAL *,REAL,void *),qcoordinates *cq,INT dim,REAL time,void *param)
+{
+  INT quad;
+  INT nq = cq->nq_per_elm;
+  for (quad=0;quad<nq;quad++) {
+    qx[quad*dim] = cq->x[quad];
+    if(dim>1) qx[quad*dim+1] = cq->y[quad];
+    if(dim>2) qx[quad*dim+2] = cq->z[quad];
+  }
+  if(f!=NULL)
+    evaluate_function_batch(val,nval,f,qx,nq,dim,time,param);
+  return;
+}
 /*************************************  END  *******************************************/
 
@@ -108,6 +108,7 @@ void amg_data_free(AMG_data *mgl,
         dvec_free(&mgl[i].b);
         dvec_free(&mgl[i].x);
         dvec_free(&mgl[i].w);
+        SAI_data_free(&mgl[i].SAI);
     }
 
     for (i=0; i<mgl->near_kernel_dim; ++i) {
@@ -118,12 +119,10 @@ void amg_data_free(AMG_data *mgl,
     // Clean direct solver data if necessary
     switch (param->coarse_solver) {
 
-#if WITH_SUITESPARSE
         case SOLVER_UMFPACK: {
             umfpack_free_numeric(mgl[max_levels-1].Numeric);
             break;
         }
-#endif
 
         default: // Do nothing!
             break;
@@ -171,6 +170,7 @@ void HX_curl_data_null (HX_curl_data *hxcurldata)
 
     hxcurldata->backup_r        = NULL;
     hxcurldata->w               = NULL;
+    hxcurldata->add_work        = NULL;
 
 }
 
@@ -209,6 +209,8 @@ void HX_curl_data_free (HX_curl_data *hxcurldata,
 
     if (hxcurldata->w) free(hxcurldata->w);
 
+    if (hxcurldata->add_work) free(hxcurldata->add_work);
+
 }
 
 
@@ -251,6 +253,7 @@ void HX_div_data_null (HX_div_data *hxdivdata)
 
     hxdivdata->backup_r        = NULL;
     hxdivdata->w               = NULL;
+    hxdivdata->add_work        = NULL;
 
 }
 
@@ -288,9 +291,219 @@ void HX_div_data_free (HX_div_data *hxdivdata,
 
     if (hxdivdata->backup_r) free(hxdivdata->backup_r);
     if (hxdivdata->w) free(hxdivdata->w);
+    if (hxdivdata->add_work) free(hxdivdata->add_work);
+
+}
+
+
+/***********************************************************************************************/
+/*!
+ * \fn void ILU_data_null (ILU_data *iludata)
+ *
+ * \brief Initalize ILU_data structure (set values to 0 and pointers to NULL) (OUTPUT)
+ *
+ * \param iludata    Pointer to the ILU_data structure
+ *
+ */
+void ILU_data_null (ILU_data *iludata)
+{
+    iludata->row     = 0;
+    iludata->type    = 0;
+
+    dcsr_null(&iludata->L);
+    dcsr_null(&iludata->U);
+    iludata->invdiag = NULL;
+
+    iludata->nlevL   = 0;
+    iludata->ilevL   = NULL;
+    iludata->jlevL   = NULL;
+    iludata->nlevU   = 0;
+    iludata->ilevU   = NULL;
+    iludata->jlevU   = NULL;
+}
+
+/***********************************************************************************************/
+/*!
+ * \fn void ILU_data_free (ILU_data *iludata)
+ *
+ * \brief Free ILU_data structure
+ *
+ * \param iludata    Pointer to the ILU_data structure (OUTPUT)
+ *
+ */
+void ILU_data_free (ILU_data *iludata)
+{
+    dcsr_free(&iludata->L);
+    dcsr_free(&iludata->U);
+
+    if (iludata->invdiag) free(iludata->invdiag);
+    if (iludata->ilevL) free(iludata->ilevL);
+    if (iludata->jlevL) free(iludata->jlevL);
+    if (iludata->ilevU) free(iludata->ilevU);
+    if (iludata->jlevU) free(iludata->jlevU);
+
+    ILU_data_null(iludata);
+}
+
+/***********************************************************************************************/
+/*!
+ * \fn void SAI_data_null (SAI_data *saidata)
+ *
+ * \brief Initalize SAI_data structure (set values to 0 and pointers to NULL) (OUTPUT)
+ *
+ * \param saidata    Pointer to the SAI_data structure
+ *
+ */
+void SAI_data_null (SAI_data *saidata)
+{
+    saidata->row  = 0;
+    saidata->type = 0;
 
+    dcsr_null(&saidata->G);
+    dcsr_null(&saidata->Gt);
+    saidata->w    = NULL;
+    saidata->work = NULL;
 }
 
+/***********************************************************************************************/
+/*!
+ * \fn void SAI_data_free (SAI_data *saidata)
+ *
+ * \brief Free SAI_data structure
+ *
+ * \param saidata    Pointer to the SAI_data structure (OUTPUT)
+ *
+ */
+void SAI_data_free (SAI_data *saidata)
+{
+    dcsr_free(&saidata->G);
+    dcsr_free(&saidata->Gt);
+
+    if (saidata->w) free(saidata->w);
+    if (saidata->work) free(saidata->work);
+
+    SAI_data_null(saidata);
+}
+
+/***********************************************************************************************/
+/*!
+ * \fn void LU_data_null (LU_data *ludata)
+ *
+ * \brief Initalize LU_data structure (set values to 0 and pointers to NULL) (OUTPUT)
+ *
+ * \param ludata    Pointer to the LU_data structure
+ *
+ */
+void LU_data_null (LU_data *ludata)
+{
+    ludata->row      = 0;
+    ludata->nnz      = 0;
+    ludata->sym      = 0;
+
+    ludata->perm     = NULL;
+    ludata->iperm    = NULL;
+    ludata->nsuper   = 0;
+    ludata->super    = NULL;
+    ludata->sIA      = NULL;
+    ludata->sJA      = NULL;
+    ludata->sparent  = NULL;
+    ludata->Lptr     = NULL;
+    ludata->Uptr     = NULL;
+    ludata->cIA      = NULL;
+    ludata->cJA      = NULL;
+    ludata->cmap     = NULL;
+
+    ludata->Lx       = NULL;
+    ludata->Ux       = NULL;
+    ludata->npiv     = NULL;
+    ludata->fptr     = NULL;
+    ludata->frow     = NULL;
+    ludata->fcol     = NULL;
+    ludata->fLptr    = NULL;
+    ludata->fUptr    = NULL;
+    ludata->Aval     = NULL;
+    ludata->anorm    = 0.0;
+    ludata->ndelay   = 0;
+    ludata->nperturb = 0;
+}
+
+/***********************************************************************************************/
+/*!
+ * \fn void LU_data_free (LU_data *ludata)
+ *
+ * \brief Free LU_data structure (symbolic and numeric parts)
+ *
+ * \param ludata    Pointer to the LU_data structure (OUTPUT)
+ *
+ */
+void LU_data_free (LU_data *ludata)
+{
+    if (ludata->perm) free(ludata->perm);
+    if (ludata->iperm) free(ludata->iperm);
+    if (ludata->super) free(ludata->super);
+    if (ludata->sIA) free(ludata->sIA);
+    if (ludata->sJA) free(ludata->sJA);
+    if (ludata->sparent) free(ludata->sparent);
+    if (ludata->Lptr) free(ludata->Lptr);
+    if (ludata->Uptr) free(ludata->Uptr);
+    if (ludata->cIA) free(ludata->cIA);
+    if (ludata->cJA) free(ludata->cJA);
+    if (ludata->cmap) free(ludata->cmap);
+    if (ludata->Lx) free(ludata->Lx);
+    if (ludata->Ux) free(ludata->Ux);
+    if (ludata->npiv) free(ludata->npiv);
+    if (ludata->fptr) free(ludata->fptr);
+    if (ludata->frow) free(ludata->frow);
+    if (ludata->fcol) free(ludata->fcol);
+    if (ludata->fLptr) free(ludata->fLptr);
+    if (ludata->fUptr) free(ludata->fUptr);
+    if (ludata->Aval) free(ludata->Aval);
+
+    LU_data_null(ludata);
+}
+
+/***********************************************************************************************/
+/*!
+ * \fn void direct_data_null (direct_data *dirdata)
+ *
+ * \brief Initalize direct_data structure (set values to 0 and pointers to NULL) (OUTPUT)
+ *
+ * \param dirdata    Pointer to the direct_data structure
+ *
+ */
+void direct_data_null (direct_data *dirdata)
+{
+    dirdata->row      = 0;
+    dirdata->nnz      = 0;
+    dirdata->At.row   = 0;
+    dirdata->At.col   = 0;
+    dirdata->At.nnz   = 0;
+    dirdata->At.IA    = NULL;
+    dirdata->At.JA    = NULL;
+    dirdata->At.val   = NULL;
+    dirdata->tmap     = NULL;
+    dirdata->Symbolic = NULL;
+    dirdata->Numeric  = NULL;
+}
+
+/***********************************************************************************************/
+/*!
+ * \fn void direct_data_free (direct_data *dirdata)
+ *
+ * \brief Free direct_data structure (symbolic and numeric factorizations)
+ *
+ * \param dirdata    Pointer to the direct_data structure (OUTPUT)
+ *
+ */
+void direct_data_free (direct_data *dirdata)
+{
+    dcsr_free(&dirdata->At);
+    if (dirdata->tmap) free(dirdata->tmap);
+    if (dirdata->Symbolic) umfpack_free_symbolic(dirdata->Symbolic);
+    if (dirdata->Numeric) umfpack_free_numeric(dirdata->Numeric);
+
+    direct_data_null(dirdata);
+}
 
 /***********************************************************************************************/
 /**
@@ -324,9 +537,7 @@ void precond_block_data_null(precond_block_data *precdata)
     precdata->A_diag = NULL;
     precdata->diag = NULL;
 
-#if WITH_SUITESPARSE
     precdata->LU_diag = NULL;
-#endif
 
     precdata->mgl = NULL;
     precdata->amgparam = NULL;
@@ -402,7 +613,6 @@ void precond_block_data_free(precond_block_data *precdata,
     if(precdata->hxcurldata) free(precdata->hxcurldata);
     if(precdata->hxdivdata)  free(precdata->hxdivdata);
 
-#if WITH_SUITESPARSE
     for (i=0; i<nb; i++)
     {
         if(precdata->LU_diag){
@@ -410,7 +620,6 @@ void precond_block_data_free(precond_block_data *precdata,
         }
     }
     if(precdata->LU_diag) free(precdata->LU_diag);
-#endif
 
     dvec_free(&precdata->r);
 
@@ -478,7 +687,6 @@ void precond_ra_data_free(precond_ra_data *precdata)
 
     if(precdata->amgparam) amli_coef_free(precdata->amgparam);
 
-#if WITH_SUITESPARSE
     for (i = 0; i < np; i++)
     {
         if(precdata->LU_diag){
@@ -486,7 +694,6 @@ void precond_ra_data_free(precond_ra_data *precdata)
         }
     }
     if(precdata->LU_diag) free(precdata->LU_diag);
-#endif
 
     if(precdata->scaled_M)  dcsr_free(precdata->scaled_M);
     if(precdata->scaled_A)  dcsr_free(precdata->scaled_A);
@@ -497,6 +704,7 @@ void precond_ra_data_free(precond_ra_data *precdata)
     if(precdata->r) dvec_free(precdata->r);
 
     if(precdata->w) free(precdata->w);
+    if(precdata->zpoles) free(precdata->zpoles);
 
     return;
 }
@@ -548,6 +548,10 @@ void param_input (const char *filenm,		\
                 inparam->AMG_smoother = SMOOTHER_FGS;
             else if ((strcmp(buffer,"FSGS")==0)||(strcmp(buffer,"fsgs")==0))
                 inparam->AMG_smoother = SMOOTHER_FSGS;
+            else if ((strcmp(buffer,"FSAI")==0)||(strcmp(buffer,"fsai")==0))
+                inparam->AMG_smoother = SMOOTHER_FSAI;
+            else if ((strcmp(buffer,"SPAI")==0)||(strcmp(buffer,"spai")==0))
+                inparam->AMG_smoother = SMOOTHER_SPAI;
             else
             { status = ERROR_INPUT_PAR; break; }
             fgets(buffer,maxb,fp); // skip rest of line
@@ -782,6 +786,62 @@ void param_input (const char *filenm,		\
             fgets(buffer,maxb,fp); // skip rest of line
         }
 
+        // ------------------
+        // ILU-preconditioner
+        // ------------------
+        else if (strcmp(buffer,"ILU_type")==0) {
+            val = fscanf(fp,"%s",buffer);
+            if (val!=1 || strcmp(buffer,"=")!=0) {
+                status = ERROR_INPUT_PAR; break;
+            }
+            val = fscanf(fp,"%s",buffer);
+            if (val!=1) { status = ERROR_INPUT_PAR; break; }
+
+            if ((strcmp(buffer,"ILUK")==0)||(strcmp(buffer,"iluk")==0))
+                inparam->ILU_type = ILUk;
+            else if ((strcmp(buffer,"ILUT")==0)||(strcmp(buffer,"ilut")==0))
+                inparam->ILU_type = ILUt;
+            else
+            { status = ERROR_INPUT_PAR; break; }
+            fgets(buffer,maxb,fp); // skip rest of line
+        }
+
+        else if (strcmp(buffer,"ILU_lfil")==0) {
+            val = fscanf(fp,"%s",buffer);
+            if (val!=1 || strcmp(buffer,"=")!=0) {
+                status = ERROR_INPUT_PAR; break;
+            }
+            val = fscanf(fp,"%d",&ibuff);
+            if (val!=1) { status = ERROR_INPUT_PAR; break; }
+            inparam->ILU_lfil = ibuff;
+            fgets(buffer,maxb,fp); // skip rest of line
+        }
+
+        else if (strcmp(buffer,"ILU_droptol")==0) {
+            val = fscanf(fp,"%s",buffer);
+            if (val!=1 || strcmp(buffer,"=")!=0) {
+                status = ERROR_INPUT_PAR; break;
+            }
+            val = fscanf(fp,"%lf",&dbuff);
+            if (val!=1) { status = ERROR_INPUT_PAR; break; }
+            inparam->ILU_droptol = dbuff;
+            fgets(buffer,maxb,fp); // skip rest of line
+        }
+
+        // ------------------
+        // SAI-preconditioner
+        // ------------------
+        else if (strcmp(buffer,"SAI_levels")==0) {
+            val = fscanf(fp,"%s",buffer);
+            if (val!=1 || strcmp(buffer,"=")!=0) {
+                status = ERROR_INPUT_PAR; break;
+            }
+            val = fscanf(fp,"%d",&ibuff);
+            if (val!=1) { status = ERROR_INPUT_PAR; break; }
+            inparam->SAI_levels = ibuff;
+            fgets(buffer,maxb,fp); // skip rest of line
+        }
+
         // ------------------
         // BSR-preconditioner
         // ------------------
@@ -196,34 +196,22 @@ void dvector_read (const char *filename,
                    dvector *b)
 {
 
-  int  i, n;
-  REAL value;
-
-  FILE *fp = fopen(filename,"r");
-
-  if ( fp == NULL ) check_error(ERROR_OPEN_FILE, __FUNCTION__);
+  int  i;
 
   fprintf(stdout,"%%%%%s: HAZMATH is reading file %s...\n", __FUNCTION__, filename);
 
-  fscanf(fp,"%d",&n);
-
-  dvec_alloc(n,b);
+  // parsed in parallel; also reads MatrixMarket files
+  dvec_read_mm(filename,b);
 
-  for ( i = 0; i < n; ++i ) {
+  for ( i = 0; i < b->row; ++i ) {
 
-    fscanf(fp, "%le", &value);
-    b->val[i] = value;
-
-    if ( value > BIGREAL ) {
-      fprintf(stderr,"### ERROR: Wrong value = %lf\n", value);
+    if ( b->val[i] > BIGREAL ) {
+      fprintf(stderr,"### ERROR: Wrong value = %lf\n", b->val[i]);
       dvec_free(b);
-      fclose(fp);
       exit(ERROR_INPUT_PAR);
     }
 
   }
-
-  fclose(fp);
 }
 
 /***********************************************************************************************/
@@ -658,36 +646,16 @@ void bdcsr_write_dcoo(const char *filename,
  *   - nrow ncol nnz     % number of rows, number of columns, and nnz
  *   - i  j  a_ij        % i, j a_ij in each line
  *
+ * \note MatrixMarket files are read as well (see dcsr_read_mm()).
+ *
  */
 void dcoo_read_dcsr (const char *filename,
                      dCSRmat *A)
 {
-  int  i,j,k,m,n,nnz;
-  REAL value;
-
-  FILE *fp = fopen(filename,"r");
-
-  if ( fp == NULL ) check_error(ERROR_OPEN_FILE, __FUNCTION__);
-
   fprintf(stdout,"%%%%%s: HAZMATH is reading file %s...\n", __FUNCTION__, filename);
 
-  fscanf(fp,"%d %d %d",&m,&n,&nnz);
-
-  dCOOmat Atmp=dcoo_create(m,n,nnz);
-
-  for ( k = 0; k < nnz; k++ ) {
-    if ( fscanf(fp, "%d %d %le", &i, &j, &value) != EOF ) {
-      Atmp.rowind[k]=i; Atmp.colind[k]=j; Atmp.val[k] = value;
-    }
-    else {
-      check_error(ERROR_WRONG_FILE, "dcoo_read_dcsr");
-    }
-  }
-
-  fclose(fp);
-
-  dcoo_2_dcsr(&Atmp,A);
-  dcoo_free(&Atmp);
+  // parsed in parallel; also reads MatrixMarket files
+  dcsr_read_mm(filename,A);
 }
 
 /*** Auxillary Files *********************************************************************/
@@ -792,125 +760,32 @@ void dump_sol_onV_vtk(char *namevtk,
   INT nv = mesh->nv;
   INT nelm = mesh->nelm;
   INT dim = mesh->dim;
-  INT v_per_elm = mesh->v_per_elm;
-
-  // VTK needed Quantities
-  INT tcell=-10;
-  INT k=-10,j=-10,kndl=-10;
-  char *tfloat="Float64", *tinto="Int64", *endian="LittleEndian";
-
-  /*
-    What endian?:
-
-    Intel x86; OS=MAC OS X: little-endian
-    Intel x86; OS=Windows: little-endian
-    Intel x86; OS=Linux: little-endian
-    Intel x86; OS=Solaris: little-endian
-    Dec Alpha; OS=Digital Unix: little-endian
-    Dec Alpha; OS=VMS: little-endian
-    Hewlett Packard PA-RISC; OS=HP-UX: big-endian
-    IBM RS/6000; OS=AIX: big-endian
-    Motorola PowerPC; OS=Mac OS X:  big-endian
-    SGI R4000 and up; OS=IRIX: big-endian
-    Sun SPARC; OS=Solaris: big-endian
-  */
-
-  /*
-    Types of cells for VTK
-
-    VTK_VERTEX (=1)
-    VTK_POLY_VERTEX (=2)
-    VTK_LINE (=3)
-    VTK_POLY_LINE (=4)
-    VTK_TRIANGLE(=5)
-    VTK_TRIANGLE_STRIP (=6)
-    VTK_POLYGON (=7)
-    VTK_PIXEL (=8)
-    VTK_QUAD (=9)
-    VTK_TETRA (=10)
-    VTK_VOXEL (=11)
-    VTK_HEXAHEDRON (=12)
-    VTK_WEDGE (=13)
-    VTK_PYRAMID (=14)
-  */
-
-  const INT LINE=3;
-  const INT TRI=5;
-  const INT TET=10;
-
-  if(dim==1) {
-    tcell=LINE; /* line */
-  } else if(dim==2) {
-    tcell=TRI; /* triangle */
-  } else {
-    tcell=TET; /* tet */
-  }
-  // Open File for Writing
-  FILE* fvtk = HAZ_fopen(namevtk,"w");
+  REAL* xyz[3] = {mesh->cv->x,mesh->cv->y,mesh->cv->z};
+  REAL* solptr=NULL;
+  char name[64];
 
-  // Write Headers
-  fprintf(fvtk, \
-	  "<VTKFile type=\"UnstructuredGrid\" version=\"0.1\" byte_order=\"%s\">\n", \
-	  endian);
-  fprintf(fvtk,"<UnstructuredGrid>\n");
-  fprintf(fvtk,"<Piece NumberOfPoints=\"%i\" NumberOfCells=\"%i\">\n",nv,nelm);
-  fprintf(fvtk,"<Points>\n");
-  fprintf(fvtk,"<DataArray type=\"%s\" NumberOfComponents=\"3\" Format=\"ascii\">", \
-  	  tfloat);
+  // Open File for Writing (ascii or binary, see set_vtu_format())
+  vtu_file* vf = vtu_open(namevtk,nv,nelm);
 
   // Dump coordinates
-  if(dim == 1) {
-    for(k=0;k<nv;k++) {
-      fprintf(fvtk," %23.16e %23.16e %23.16e ",mesh->cv->x[k],0e0,0e0);
-    }
-  } else if(dim == 2) {
-    for(k=0;k<nv;k++) {
-      fprintf(fvtk," %23.16e %23.16e %23.16e ",mesh->cv->x[k],mesh->cv->y[k],0e0);
-    }
-  } else {
-    for(k=0;k<nv;k++) {
-      fprintf(fvtk," %23.16e %23.16e %23.16e ",mesh->cv->x[k],mesh->cv->y[k], \
-  	      mesh->cv->z[k]);
-    }
-  }
-  fprintf(fvtk,"</DataArray>\n");
-  fprintf(fvtk,"</Points>\n");
+  fprintf(vf->fp,"<Points>\n");
+  vtu_array_real(vf,NULL,nv,3,xyz,1);
+  fprintf(vf->fp,"</Points>\n");
 
   // Dump solution Data on Vertices of mesh
-  fprintf(fvtk,"<PointData Scalars=\"scalars\">\n");
+  fprintf(vf->fp,"<PointData Scalars=\"scalars\">\n");
   INT i=0;
   for(i=0;i<ncomp;i++) {
-    fprintf(fvtk,"<DataArray type=\"%s\" Name=\"Solution Component %i\" Format=\"ascii\">",tfloat,i);
-    for(k=0;k<nv;k++) fprintf(fvtk," %23.16e ",sol[i*nv+k]);
-    fprintf(fvtk,"</DataArray>\n");
-  }
-  fprintf(fvtk,"</PointData>\n");
-
-  // Dump el_v map
-  fprintf(fvtk,"<Cells>\n");
-  fprintf(fvtk,"<DataArray type=\"%s\" Name=\"offsets\" Format=\"ascii\">",tinto);
-  for(k=1;k<=nelm;k++) fprintf(fvtk," %i ",mesh->el_v->IA[k]);
-  fprintf(fvtk,"</DataArray>\n");
-  fprintf(fvtk,"<DataArray type=\"%s\" Name=\"connectivity\" Format=\"ascii\">\n",tinto);
-  for(k=0;k<nelm;k++){
-    kndl=k*v_per_elm;
-    for(j=0;j<v_per_elm;j++) fprintf(fvtk," %i ",mesh->el_v->JA[kndl + j]);
+    sprintf(name,"Solution Component %i",i);
+    solptr = sol+i*nv;
+    vtu_array_real(vf,name,nv,1,&solptr,1);
   }
-  fprintf(fvtk,"</DataArray>\n");
-
-  // Dump Element Type
-  fprintf(fvtk,"<DataArray type=\"%s\" Name=\"types\" Format=\"ascii\">",tinto);
-  for(k=1;k<=nelm;k++)
-    fprintf(fvtk," %i ",tcell);
+  fprintf(vf->fp,"</PointData>\n");
 
-  // Put in remaining headers
-  fprintf(fvtk,"</DataArray>\n");
-  fprintf(fvtk,"</Cells>\n");
-  fprintf(fvtk,"</Piece>\n");
-  fprintf(fvtk,"</UnstructuredGrid>\n");
-  fprintf(fvtk,"</VTKFile>\n");
+  // Dump el_v map and element types
+  vtu_cells(vf,nelm,dim,mesh->el_v->JA,0);
 
-  fclose(fvtk);
+  vtu_close(vf);
 
   return;
 }
@@ -936,141 +811,50 @@ void dump_sol_vtk(char *namevtk,char *varname,mesh_struct *mesh,fespace *FE,REAL
   INT nv = mesh->nv;
   INT nelm = mesh->nelm;
   INT dim = mesh->dim;
-  INT v_per_elm = mesh->v_per_elm;
+  REAL* xyz[3] = {mesh->cv->x,mesh->cv->y,mesh->cv->z};
+  REAL* solptr=NULL;
+  char* name = (char *) calloc(strlen(varname)+64,sizeof(char));
 
-  // VTK needed Quantities
-  INT tcell=-10;
-  INT k=-10,j=-10,kndl=-10;
-  char *tfloat="Float64", *tinto="Int64", *endian="LittleEndian";
-
-  /*
-    What endian?:
-
-    Intel x86; OS=MAC OS X: little-endian
-    Intel x86; OS=Windows: little-endian
-    Intel x86; OS=Linux: little-endian
-    Intel x86; OS=Solaris: little-endian
-    Dec Alpha; OS=Digital Unix: little-endian
-    Dec Alpha; OS=VMS: little-endian
-    Hewlett Packard PA-RISC; OS=HP-UX: big-endian
-    IBM RS/6000; OS=AIX: big-endian
-    Motorola PowerPC; OS=Mac OS X:  big-endian
-    SGI R4000 and up; OS=IRIX: big-endian
-    Sun SPARC; OS=Solaris: big-endian
-  */
-
-  /*
-    Types of cells for VTK
-
-    VTK_VERTEX (=1)
-    VTK_POLY_VERTEX (=2)
-    VTK_LINE (=3)
-    VTK_POLY_LINE (=4)
-    VTK_TRIANGLE(=5)
-    VTK_TRIANGLE_STRIP (=6)
-    VTK_POLYGON (=7)
-    VTK_PIXEL (=8)
-    VTK_QUAD (=9)
-    VTK_TETRA (=10)
-    VTK_VOXEL (=11)
-    VTK_HEXAHEDRON (=12)
-    VTK_WEDGE (=13)
-    VTK_PYRAMID (=14)
-  */
-
-  const INT LINE=3;
-  const INT TRI=5;
-  const INT TET=10;
-
-  if(dim==1) {
-    tcell=LINE; /* line */
-  } else if(dim==2) {
-    tcell=TRI; /* triangle */
-  } else {
-    tcell=TET; /* tet */
-  }
-  // Open File for Writing
-  FILE* fvtk = HAZ_fopen(namevtk,"w");
+  // Open File for Writing (ascii or binary, see set_vtu_format())
+  vtu_file* vf = vtu_open(namevtk,nv,nelm);
 
-  // Write Headers
-  fprintf(fvtk,"<VTKFile type=\"UnstructuredGrid\" version=\"0.1\" byte_order=\"%s\">\n",endian);
-  fprintf(fvtk,"<UnstructuredGrid>\n");
-  fprintf(fvtk,"<Piece NumberOfPoints=\"%i\" NumberOfCells=\"%i\">\n",nv,nelm);
-  fprintf(fvtk,"<Points>\n");
-  fprintf(fvtk,"<DataArray type=\"%s\" NumberOfComponents=\"3\" Format=\"ascii\">",tfloat);
-
-  // Dump vertex coordinates and solution
-  if(dim == 1) {
-    for(k=0;k<nv;k++) {
-      fprintf(fvtk," %23.16e %23.16e %23.16e ",mesh->cv->x[k],0e0,0e0);
-    }
-  } else if(dim == 2) {
-    for(k=0;k<nv;k++) {
-      fprintf(fvtk," %23.16e %23.16e %23.16e ",mesh->cv->x[k],mesh->cv->y[k],0e0);
-    }
-  } else {
-    for(k=0;k<nv;k++) {
-      fprintf(fvtk," %23.16e %23.16e %23.16e ",mesh->cv->x[k],mesh->cv->y[k], \
-              mesh->cv->z[k]);
-    }
-  }
-  fprintf(fvtk,"</DataArray>\n");
-  fprintf(fvtk,"</Points>\n");
+  // Dump vertex coordinates
+  fprintf(vf->fp,"<Points>\n");
+  vtu_array_real(vf,NULL,nv,3,xyz,1);
+  fprintf(vf->fp,"</Points>\n");
 
   // Dump Solution
   // Depending on the FE space, we will dump things differently
   // since we need to project to the vertices
   REAL* sol_on_V=NULL;
   if(FE->FEtype==0) { // P0 - only have cell data
-    fprintf(fvtk,"<CellData Scalars=\"scalars\">\n");
-    fprintf(fvtk,"<DataArray type=\"%s\" Name=\"Solution Component - %s\" Format=\"ascii\">",tfloat,varname);
-    for(k=0;k<nelm;k++) fprintf(fvtk," %23.16e ",sol[k]);
-    fprintf(fvtk,"</DataArray>\n");
-    fprintf(fvtk,"</CellData>\n");
+    fprintf(vf->fp,"<CellData Scalars=\"scalars\">\n");
+    sprintf(name,"Solution Component - %s",varname);
+    vtu_array_real(vf,name,nelm,1,&sol,1);
+    fprintf(vf->fp,"</CellData>\n");
   } else if(FE->FEtype>0 && FE->FEtype<20) { // PX elements (assume sol at vertices comes first)
-    fprintf(fvtk,"<PointData Scalars=\"scalars\">\n");
-    fprintf(fvtk,"<DataArray type=\"%s\" Name=\"Solution Component - %s\" Format=\"ascii\">",tfloat,varname);
-    for(k=0;k<nv;k++) fprintf(fvtk," %23.16e ",sol[k]);
-    fprintf(fvtk,"</DataArray>\n");
-    fprintf(fvtk,"</PointData>\n");
+    fprintf(vf->fp,"<PointData Scalars=\"scalars\">\n");
+    sprintf(name,"Solution Component - %s",varname);
+    vtu_array_real(vf,name,nv,1,&sol,1);
+    fprintf(vf->fp,"</PointData>\n");
   } else { // Vector Elements
     sol_on_V = (REAL *) calloc(dim*mesh->nv,sizeof(REAL));
     Project_to_Vertices(sol_on_V,sol,FE,mesh);
-    fprintf(fvtk,"<PointData Scalars=\"scalars\">\n");
+    fprintf(vf->fp,"<PointData Scalars=\"scalars\">\n");
     for(i=0;i<dim;i++) {
-      fprintf(fvtk,"<DataArray type=\"%s\" Name=\"Solution Component - %s%i\" Format=\"ascii\">",tfloat,varname,i);
-      for(k=0;k<nv;k++) fprintf(fvtk," %23.16e ",sol_on_V[i*nv+k]);
-      fprintf(fvtk,"</DataArray>\n");
+      sprintf(name,"Solution Component - %s%i",varname,i);
+      solptr = sol_on_V+i*nv;
+      vtu_array_real(vf,name,nv,1,&solptr,1);
     }
-    fprintf(fvtk,"</PointData>\n");
+    fprintf(vf->fp,"</PointData>\n");
   }
 
-  // Dump el_v map
-  fprintf(fvtk,"<Cells>\n");
-  fprintf(fvtk,"<DataArray type=\"%s\" Name=\"offsets\" Format=\"ascii\">",tinto);
-  for(k=1;k<=nelm;k++) fprintf(fvtk," %i ",mesh->el_v->IA[k]);
-  fprintf(fvtk,"</DataArray>\n");
-  fprintf(fvtk,"<DataArray type=\"%s\" Name=\"connectivity\" Format=\"ascii\">\n",tinto);
-  for(k=0;k<nelm;k++){
-    kndl=k*v_per_elm;
-    for(j=0;j<v_per_elm;j++) fprintf(fvtk," %i ",mesh->el_v->JA[kndl + j]);
-  }
-  fprintf(fvtk,"</DataArray>\n");
+  // Dump el_v map and element types
+  vtu_cells(vf,nelm,dim,mesh->el_v->JA,0);
 
-  // Dump Element Type
-  fprintf(fvtk,"<DataArray type=\"%s\" Name=\"types\" Format=\"ascii\">",tinto);
-  for(k=1;k<=nelm;k++)
-    fprintf(fvtk," %i ",tcell);
-
-  // Put in remaining headers
-  fprintf(fvtk,"</DataArray>\n");
-  fprintf(fvtk,"</Cells>\n");
-  fprintf(fvtk,"</Piece>\n");
-  fprintf(fvtk,"</UnstructuredGrid>\n");
-  fprintf(fvtk,"</VTKFile>\n");
-
-  fclose(fvtk);
+  vtu_close(vf);
   if(sol_on_V) free(sol_on_V);
+  free(name);
 
   return;
 }
@@ -1096,86 +880,19 @@ void dump_blocksol_vtk(char *namevtk,char **varname,mesh_struct *mesh,block_fesp
   INT nv = mesh->nv;
   INT nelm = mesh->nelm;
   INT dim = mesh->dim;
-  INT v_per_elm = mesh->v_per_elm;
+  REAL* xyz[3] = {mesh->cv->x,mesh->cv->y,mesh->cv->z};
+  size_t maxlen = 0;
+  for(nsp=0;nsp<FE->nspaces;nsp++)
+    if(strlen(varname[nsp])>maxlen) maxlen = strlen(varname[nsp]);
+  char* name = (char *) calloc(maxlen+64,sizeof(char));
 
-  // VTK needed Quantities
-  INT tcell=-10;
-  INT k=-10,j=-10,kndl=-10;
-  char *tfloat="Float64", *tinto="Int64", *endian="LittleEndian";
-
-  /*
-    What endian?:
-
-    Intel x86; OS=MAC OS X: little-endian
-    Intel x86; OS=Windows: little-endian
-    Intel x86; OS=Linux: little-endian
-    Intel x86; OS=Solaris: little-endian
-    Dec Alpha; OS=Digital Unix: little-endian
-    Dec Alpha; OS=VMS: little-endian
-    Hewlett Packard PA-RISC; OS=HP-UX: big-endian
-    IBM RS/6000; OS=AIX: big-endian
-    Motorola PowerPC; OS=Mac OS X:  big-endian
-    SGI R4000 and up; OS=IRIX: big-endian
-    Sun SPARC; OS=Solaris: big-endian
-  */
-
-  /*
-    Types of cells for VTK
-
-    VTK_VERTEX (=1)
-    VTK_POLY_VERTEX (=2)
-    VTK_LINE (=3)
-    VTK_POLY_LINE (=4)
-    VTK_TRIANGLE(=5)
-    VTK_TRIANGLE_STRIP (=6)
-    VTK_POLYGON (=7)
-    VTK_PIXEL (=8)
-    VTK_QUAD (=9)
-    VTK_TETRA (=10)
-    VTK_VOXEL (=11)
-    VTK_HEXAHEDRON (=12)
-    VTK_WEDGE (=13)
-    VTK_PYRAMID (=14)
-  */
-
-  const INT LINE=3;
-  const INT TRI=5;
-  const INT TET=10;
-
-  if(dim==1) {
-    tcell=LINE; /* line */
-  } else if(dim==2) {
-    tcell=TRI; /* triangle */
-  } else {
-    tcell=TET; /* tet */
-  }
-  // Open File for Writing
-  FILE* fvtk = HAZ_fopen(namevtk,"w");
+  // Open File for Writing (ascii or binary, see set_vtu_format())
+  vtu_file* vf = vtu_open(namevtk,nv,nelm);
 
-  // Write Headers
-  fprintf(fvtk,"<VTKFile type=\"UnstructuredGrid\" version=\"0.1\" byte_order=\"%s\">\n",endian);
-  fprintf(fvtk,"<UnstructuredGrid>\n");
-  fprintf(fvtk,"<Piece NumberOfPoints=\"%i\" NumberOfCells=\"%i\">\n",nv,nelm);
-  fprintf(fvtk,"<Points>\n");
-  fprintf(fvtk,"<DataArray type=\"%s\" NumberOfComponents=\"3\" Format=\"ascii\">",tfloat);
-
-  // Dump vertex coordinates and solution
-  if(dim == 1) {
-    for(k=0;k<nv;k++) {
-      fprintf(fvtk," %23.16e %23.16e %23.16e ",mesh->cv->x[k],0e0,0e0);
-    }
-  } else if(dim == 2) {
-    for(k=0;k<nv;k++) {
-      fprintf(fvtk," %23.16e %23.16e %23.16e ",mesh->cv->x[k],mesh->cv->y[k],0e0);
-    }
-  } else {
-    for(k=0;k<nv;k++) {
-      fprintf(fvtk," %23.16e %23.16e %23.16e ",mesh->cv->x[k],mesh->cv->y[k], \
-              mesh->cv->z[k]);
-    }
-  }
-  fprintf(fvtk,"</DataArray>\n");
-  fprintf(fvtk,"</Points>\n");
+  // Dump vertex coordinates
+  fprintf(vf->fp,"<Points>\n");
+  vtu_array_real(vf,NULL,nv,3,xyz,1);
+  fprintf(vf->fp,"</Points>\n");
 
   // Dump Solution for each FE space
   REAL* sol_on_V=NULL;
@@ -1183,7 +900,7 @@ void dump_blocksol_vtk(char *namevtk,char **varname,mesh_struct *mesh,block_fesp
   INT* P0cntr = (INT *) calloc(FE->nspaces,sizeof(INT));
   INT anyP0=0;
   INT spcntr = 0;
-  fprintf(fvtk,"<PointData Scalars=\"scalars\">\n");
+  fprintf(vf->fp,"<PointData Scalars=\"scalars\">\n");
   for(nsp=0;nsp<FE->nspaces;nsp++) {
     // Depending on the FE space, we will dump things differently
     // since we need to project to the vertices
@@ -1192,69 +909,49 @@ void dump_blocksol_vtk(char *namevtk,char **varname,mesh_struct *mesh,block_fesp
       anyP0=1;
       P0cntr[nsp] = 1;
     } else if(FE->var_spaces[nsp]->FEtype>0 && FE->var_spaces[nsp]->FEtype<20) { // PX elements (assume sol at vertices comes first)
-      fprintf(fvtk,"<DataArray type=\"%s\" Name=\"Solution Component %i - %s\" Format=\"ascii\">",tfloat,nsp,varname[nsp]);
-      for(k=0;k<nv;k++) fprintf(fvtk," %23.16e ",sol[spcntr + k]);
-      fprintf(fvtk,"</DataArray>\n");
+      sprintf(name,"Solution Component %i - %s",nsp,varname[nsp]);
+      solptr = sol+spcntr;
+      vtu_array_real(vf,name,nv,1,&solptr,1);
     } else if(FE->var_spaces[nsp]->FEtype==99) { // Single DoF constraint element (just plot single value everywhere)
-      fprintf(fvtk,"<DataArray type=\"%s\" Name=\"Solution Component %i - %s\" Format=\"ascii\">",tfloat,nsp,varname[nsp]);
-      for(k=0;k<nv;k++) fprintf(fvtk," %23.16e ",sol[spcntr]);
-      fprintf(fvtk,"</DataArray>\n");
+      sprintf(name,"Solution Component %i - %s",nsp,varname[nsp]);
+      solptr = sol+spcntr;
+      vtu_array_real(vf,name,nv,1,&solptr,0);
     } else { // Vector Elements
       sol_on_V = (REAL *) calloc(dim*mesh->nv,sizeof(REAL));
       solptr = sol+spcntr;
       Project_to_Vertices(sol_on_V,solptr,FE->var_spaces[nsp],mesh);
       for(i=0;i<dim;i++) {
-        fprintf(fvtk,"<DataArray type=\"%s\" Name=\"Solution Component %i - %s%i\" Format=\"ascii\">",tfloat,nsp,varname[nsp],i);
-        for(k=0;k<nv;k++) fprintf(fvtk," %23.16e ",sol_on_V[i*nv+k]);
-        fprintf(fvtk,"</DataArray>\n");
+        sprintf(name,"Solution Component %i - %s%i",nsp,varname[nsp],i);
+        solptr = sol_on_V+i*nv;
+        vtu_array_real(vf,name,nv,1,&solptr,1);
       }
       if(sol_on_V) free(sol_on_V);
     }
     spcntr += FE->var_spaces[nsp]->ndof;
   }
-  fprintf(fvtk,"</PointData>\n");
+  fprintf(vf->fp,"</PointData>\n");
 
   // Now go back and dump P0 stuff
   if(anyP0) {
     spcntr=0;
-    fprintf(fvtk,"<CellData Scalars=\"scalars\">\n");
+    fprintf(vf->fp,"<CellData Scalars=\"scalars\">\n");
     for(nsp=0;nsp<FE->nspaces;nsp++) {
       if(P0cntr[nsp]==1) {
-        fprintf(fvtk,"<DataArray type=\"%s\" Name=\"Solution Component %i - %s\" Format=\"ascii\">",tfloat,nsp,varname[nsp]);
-        for(k=0;k<nelm;k++) fprintf(fvtk," %23.16e ",sol[spcntr+k]);
-        fprintf(fvtk,"</DataArray>\n");
+        sprintf(name,"Solution Component %i - %s",nsp,varname[nsp]);
+        solptr = sol+spcntr;
+        vtu_array_real(vf,name,nelm,1,&solptr,1);
       }
       spcntr += FE->var_spaces[nsp]->ndof;
     }
-    fprintf(fvtk,"</CellData>\n");
+    fprintf(vf->fp,"</CellData>\n");
   }
   if(P0cntr) free(P0cntr);
 
-  // Dump el_v map
-  fprintf(fvtk,"<Cells>\n");
-  fprintf(fvtk,"<DataArray type=\"%s\" Name=\"offsets\" Format=\"ascii\">",tinto);
-  for(k=1;k<=nelm;k++) fprintf(fvtk," %i ",mesh->el_v->IA[k]);
-  fprintf(fvtk,"</DataArray>\n");
-  fprintf(fvtk,"<DataArray type=\"%s\" Name=\"connectivity\" Format=\"ascii\">\n",tinto);
-  for(k=0;k<nelm;k++){
-    kndl=k*v_per_elm;
-    for(j=0;j<v_per_elm;j++) fprintf(fvtk," %i ",mesh->el_v->JA[kndl + j]);
-  }
-  fprintf(fvtk,"</DataArray>\n");
-
-  // Dump Element Type
-  fprintf(fvtk,"<DataArray type=\"%s\" Name=\"types\" Format=\"ascii\">",tinto);
-  for(k=1;k<=nelm;k++)
-    fprintf(fvtk," %i ",tcell);
-
-  // Put in remaining headers
-  fprintf(fvtk,"</DataArray>\n");
-  fprintf(fvtk,"</Cells>\n");
-  fprintf(fvtk,"</Piece>\n");
-  fprintf(fvtk,"</UnstructuredGrid>\n");
-  fprintf(fvtk,"</VTKFile>\n");
+  // Dump el_v map and element types
+  vtu_cells(vf,nelm,dim,mesh->el_v->JA,0);
 
-  fclose(fvtk);
+  vtu_close(vf);
+  free(name);
 
   return;
 }
@@ -1445,103 +1142,23 @@ void vtkw(char *namevtk, scomplex *sc, const INT shift, const REAL zscale)
 {
   if((sc->n!=2)&&(sc->n!=3))
     fprintf(stderr,"\n*** ERR(%s; dim=%d): NO vtk files for dim .eq. 1 or (dim .gt. 3).\n",__FUNCTION__,sc->n);
-  FILE *fvtk;
-  INT nv=sc->nv,ns=sc->ns, n=sc->n,n1=n+1;
-  INT *nodes = sc->nodes, *ib=sc->bndry;
-  REAL *x = sc->x;
-  INT tcell=-10;
-  INT k=-10,j=-10;
-  char *tfloat="Float64", *tinto="Int64", *endian="LittleEndian";
-  /*
-    what endian?:
-
-    Intel x86; OS=MAC OS X: little-endian
-    Intel x86; OS=Windows: little-endian
-    Intel x86; OS=Linux: little-endian
-    Intel x86; OS=Solaris: little-endian
-    Dec Alpha; OS=Digital Unix: little-endian
-    Dec Alpha; OS=VMS: little-endian
-    Hewlett Packard PA-RISC; OS=HP-UX: big-endian
-    IBM RS/6000; OS=AIX: big-endian
-    Motorola PowerPC; OS=Mac OS X:  big-endian
-    SGI R4000 and up; OS=IRIX: big-endian
-    Sun SPARC; OS=Solaris: big-endian
-  */
-  /*
-    Types of cells for VTK
-
-    VTK_VERTEX (=1)
-    VTK_POLY_VERTEX (=2)
-    VTK_LINE (=3)
-    VTK_POLY_LINE (=4)
-    VTK_TRIANGLE(=5)
-    VTK_TRIANGLE_STRIP (=6)
-    VTK_POLYGON (=7)
-    VTK_PIXEL (=8)
-    VTK_QUAD (=9)
-    VTK_TETRA (=10)
-    VTK_VOXEL (=11)
-    VTK_HEXAHEDRON (=12)
-    VTK_WEDGE (=13)
-    VTK_PYRAMID (=14)
-  */
-  const INT LINE=3;
-  const INT TRI=5;
-  const INT TET=10;
-  if(n==1)
-    tcell=LINE; /* triangle */
-  else if(n==2)
-    tcell=TRI; /* triangle */
-  else
-    tcell=TET; /* tet */
-
-  /* VTK format writing the mesh for plot */
-  fvtk=HAZ_fopen(namevtk,"w");
-  fprintf(fvtk,"<VTKFile type=\"UnstructuredGrid\" version=\"0.1\" byte_order=\"%s\">\n",endian);
-  fprintf(fvtk,"<UnstructuredGrid>\n");
-  fprintf(fvtk,"<Piece NumberOfPoints=\"%i\" NumberOfCells=\"%i\">\n",nv,ns);
-  fprintf(fvtk,"<Points>\n");
-  fprintf(fvtk,"<DataArray type=\"%s\" NumberOfComponents=\"3\" Format=\"ascii\">",tfloat);
-  for (j=0;j<nv;j++){
-    for (k=0;k<n;k++) {
-      fprintf(fvtk,"%.8f ",x[j*n+k]);
-    }
-    for (k=0;k<(3-n);k++) {
-      fprintf(fvtk,"%.8f ",0.);
-    }
-  }
-  /* if(n == 2){ */
-  /*   for (j=0;j<nv;j++){ */
-  /*     for (k=0;k<n;k++) { */
-  /* 	fprintf(fvtk,"%.8f ",x[j*n+k]); */
-  /*     } */
-  /*     fprintf(fvtk,"%.8f ",0.); */
-  /*   } */
-  /* }  else { */
-  /*   for (j=0;j<nv;j++){ */
-  /*     for (k=0;k<n-1;k++) { */
-  /* 	fprintf(fvtk,"%.8f ",x[j*n+k]); */
-  /*     } */
-  /*     fprintf(fvtk,"%.8f ",x[j*n+n-1]*zscale); */
-  /*   } */
-  /* } */
-  fprintf(fvtk,"</DataArray>\n");
-  fprintf(fvtk,"</Points>\n");
-  fprintf(fvtk,"<CellData Scalars=\"scalars\">\n");
-  fprintf(fvtk,"<DataArray type=\"%s\" Name=\"%s (layer)\" Format=\"ascii\">",tfloat,"L");
-  for(k=0;k<ns;k++) fprintf(fvtk," %g ",(REAL )sc->flags[k]);//element flags
-  fprintf(fvtk,"</DataArray>\n");
-  fprintf(fvtk,"</CellData>\n");
+  INT nv=sc->nv,ns=sc->ns, n=sc->n;
+  INT *ib=sc->bndry;
+  INT k=-10;
+  REAL *xyz[3]={NULL,NULL,NULL};
+  for(k=0;k<n && k<3;k++) xyz[k]=sc->x+k;
+  /* VTK format writing the mesh for plot (ascii or binary, see
+     set_vtu_format()) */
+  vtu_file *vf=vtu_open(namevtk,nv,ns);
+  fprintf(vf->fp,"<Points>\n");
+  vtu_array_real(vf,NULL,nv,3,xyz,n);
+  fprintf(vf->fp,"</Points>\n");
+  fprintf(vf->fp,"<CellData Scalars=\"scalars\">\n");
+  vtu_array_int(vf,"L (layer)",ns,sc->flags,1,0);//element flags
+  fprintf(vf->fp,"</CellData>\n");
   // Dump v_bdry Data to indicate if vertices are boundaries
-  fprintf(fvtk,"<PointData Scalars=\"scalars\">\n");
-  fprintf(fvtk,"<DataArray type=\"%s\" Name=\"v_bdry\" Format=\"ascii\">",tinto);
-  for(k=0;k<nv;k++) fprintf(fvtk," %i ",ib[k]);
-  fprintf(fvtk,"</DataArray>\n");
-  /*NOT USED: if(sc->fval){ */
-  /*   fprintf(fvtk,"<DataArray type=\"%s\" Name=\"ele\" Format=\"ascii\">",tfloat); */
-  /*   for(k=0;k<nv;k++) fprintf(fvtk," %e ",sc->fval[k]); */
-  /*   fprintf(fvtk,"</DataArray>\n"); */
-  /* } */
+  fprintf(vf->fp,"<PointData Scalars=\"scalars\">\n");
+  vtu_array_int(vf,"v_bdry",nv,ib,1,0);
   // Dump information about connected components.  For now only assume
   // 1 connected region and at most 2 connected boundaries.  Positive
   // integers indicate connected components of a domain Negative
@@ -1553,47 +1170,25 @@ void vtkw(char *namevtk, scomplex *sc, const INT shift, const REAL zscale)
   // boundary and -2 on the inner boundary If NULL, then one connected
   // region and boundary.
   if(sc->bndry_cc>1) {
-    fprintf(fvtk,"<DataArray type=\"%s\" Name=\"connectedcomponents\" Format=\"ascii\">",tinto);
+    INT *ccomp=(INT *)calloc(nv,sizeof(INT));
     for(k=0;k<nv;k++) {
       if(ib[k]==0) {
-	fprintf(fvtk," %i ",1);
+	ccomp[k]=1;
       } else if(ib[k]==1) {
-	fprintf(fvtk," %i ",-1);
+	ccomp[k]=-1;
       } else if(ib[k]==-1) {
-	fprintf(fvtk," %i ",-2);
+	ccomp[k]=-2;
       } else {
-	fprintf(fvtk," %i ",ib[k]);
+	ccomp[k]=ib[k];
       }
     }
-    fprintf(fvtk,"</DataArray>\n");
-  }
-  fprintf(fvtk,"</PointData>\n");
-  fprintf(fvtk,"<Cells>\n");
-  fprintf(fvtk,"<DataArray type=\"%s\" Name=\"offsets\" Format=\"ascii\">",tinto);
-  for(k=1;k<=ns;k++) fprintf(fvtk," %i ",k*n1);
-  fprintf(fvtk,"</DataArray>\n");
-  fprintf(fvtk,"<DataArray type=\"%s\" Name=\"connectivity\" Format=\"ascii\">\n",tinto);
-  /* for(k=0;k<ns;k++){ */
-  /*   kn1=k*n1; */
-  /*   for(j=0;j<n1;j++) fprintf(fvtk," %i ",nodes[kn1 + j]); */
-  /* } */
-  for (j=0;j<ns;j++){
-    /*  for (j=0;j<ns;j++){*/
-    for (k=0;k<n1;k++) {
-      fprintf(fvtk,"%d ",nodes[j*n1+k]+shift);
-    }
+    vtu_array_int(vf,"connectedcomponents",nv,ccomp,1,0);
+    free(ccomp);
   }
-  fprintf(fvtk,"</DataArray>\n");
-  fprintf(fvtk,"<DataArray type=\"%s\" Name=\"types\" Format=\"ascii\">",tinto);
-  for(k=1;k<=ns;k++)
-    fprintf(fvtk," %i ",tcell);
-  fprintf(fvtk,"</DataArray>\n");
-  fprintf(fvtk,"</Cells>\n");
-  fprintf(fvtk,"</Piece>\n");
-  fprintf(fvtk,"</UnstructuredGrid>\n");
-  fprintf(fvtk,"</VTKFile>\n");
+  fprintf(vf->fp,"</PointData>\n");
+  vtu_cells(vf,ns,n,sc->nodes,shift);
+  vtu_close(vf);
   fprintf(stdout,"%%Output (vtk) written on:%s\n",namevtk);
-  fclose(fvtk);
   return;
 }
 void matlw(scomplex *sc, char *namematl)
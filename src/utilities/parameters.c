@@ -135,6 +135,14 @@ void param_input_init (input_param *inparam)
     // HX Preconditioner
     inparam->HX_smooth_iter           = 1;
 
+    // ILU Preconditioner
+    inparam->ILU_type                 = ILUk;
+    inparam->ILU_lfil                 = 0;
+    inparam->ILU_droptol              = 1e-3;
+
+    // SAI Preconditioner
+    inparam->SAI_levels               = 1;
+
     // BSR Preconditioner
     inparam->BSR_alpha           = 1.;
     inparam->BSR_omega           = 1.;
@@ -192,6 +200,9 @@ void param_amg_init (AMG_param *amgparam)
     amgparam->Schwarz_type         = 1;
     amgparam->Schwarz_blksolver    = SOLVER_DEFAULT;
 
+    // SAI smoother parameters
+    amgparam->SAI_levels           = 1;
+
     // Other smoother param
     amgparam->HAZDIR     = NULL;
     amgparam->Schwarz_on_blk     = NULL;
@@ -248,6 +259,14 @@ void param_linear_solver_init (linear_itsolver_param *itsparam)
     // HX preconditioner
     itsparam->HX_smooth_iter       = 1;
 
+    // ILU preconditioner
+    itsparam->ILU_type             = ILUk;
+    itsparam->ILU_lfil             = 0;
+    itsparam->ILU_droptol          = 1e-3;
+
+    // SAI preconditioner
+    itsparam->SAI_levels           = 1;
+
 }
 
 /*************************************************************************************/
@@ -280,6 +299,11 @@ void param_linear_solver_set (linear_itsolver_param *itsparam,
 
     itsparam->HX_smooth_iter = inparam->HX_smooth_iter;
 
+    itsparam->ILU_type       = inparam->ILU_type;
+    itsparam->ILU_lfil       = inparam->ILU_lfil;
+    itsparam->ILU_droptol    = inparam->ILU_droptol;
+    itsparam->SAI_levels     = inparam->SAI_levels;
+
 }
 
 /*************************************************************************************/
@@ -336,6 +360,7 @@ void param_amg_set (AMG_param *amgparam,
     amgparam->Schwarz_maxlvl       = inparam->Schwarz_maxlvl;
     amgparam->Schwarz_type         = inparam->Schwarz_type;
     amgparam->Schwarz_blksolver    = inparam->Schwarz_blksolver;
+    amgparam->SAI_levels           = inparam->SAI_levels;
     amgparam->Schwarz_on_blk     = NULL;
     amgparam->HAZDIR     = NULL;
     amgparam->Schwarz_on_blk     = NULL;
@@ -397,6 +422,7 @@ void param_amg_cp (AMG_param *amgparam1,
     amgparam2->Schwarz_maxlvl       = amgparam1->Schwarz_maxlvl;
     amgparam2->Schwarz_type         = amgparam1->Schwarz_type;
     amgparam2->Schwarz_blksolver    = amgparam1->Schwarz_blksolver;
+    amgparam2->SAI_levels           = amgparam1->SAI_levels;
 
     //if(amgparam1->Schwarz_on_blk) iarray_cp(size, amgparam1->Schwarz_on_blk, amgparam2->Schwarz_on_blk);
     //if(amgparam1->Schwarz_patch_type) iarray_cp(size, amgparam1->Schwarz_patch_type, amgparam2->Schwarz_patch_type);
@@ -463,6 +489,16 @@ void param_linear_solver_print (linear_itsolver_param *itsparam)
         if ( (itsparam->linear_precond_type == PREC_HX_CURL_A) || (itsparam->linear_precond_type == PREC_HX_CURL_M) )
             printf("HX precond number of smooth:       %d\n", itsparam->HX_smooth_iter);
 
+        if ( itsparam->linear_precond_type == PREC_ILU ) {
+            printf("ILU type:                          %d\n", itsparam->ILU_type);
+            printf("ILU level of fill / max fill:      %d\n", itsparam->ILU_lfil);
+            if ( itsparam->ILU_type == ILUt )
+                printf("ILU dropping tolerance:            %.2e\n", itsparam->ILU_droptol);
+        }
+
+        if ( (itsparam->linear_precond_type == PREC_FSAI) || (itsparam->linear_precond_type == PREC_SPAI) )
+            printf("SAI pattern levels:                %d\n", itsparam->SAI_levels);
+
         printf("-----------------------------------------------\n\n");
 
     }
@@ -547,6 +583,9 @@ void param_amg_print (AMG_param *amgparam)
             printf("AMG Schwarz maximal block size:    %d\n", amgparam->Schwarz_mmsize);
         }
 
+        if ( (amgparam->smoother == SMOOTHER_FSAI) || (amgparam->smoother == SMOOTHER_SPAI) )
+            printf("AMG SAI smoother pattern levels:   %d\n", amgparam->SAI_levels);
+
         printf("-----------------------------------------------\n\n");
 
     }
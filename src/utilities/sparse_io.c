@@ -0,0 +1,729 @@
+/*! \file src/utilities/sparse_io.c
+ *
+ *  Copyright 2015__HAZMATH__. All rights reserved.
+ *
+ *  \brief Routines for reading and writing dCSRmat and dvector in a
+ *         native binary format, which can be mapped into memory, and in
+ *         MatrixMarket text format, which is parsed in parallel.
+ *
+ *  \note The text readers also read the formats written by
+ *        dcsr_write_dcoo() and dvector_write() (no banner, indices
+ *        starting from 0).
+ *
+ */
+
+#include "hazmath.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <strings.h>
+
+/* Number of entries in a piece of a text file written at once */
+#define SPIO_CHUNK 65536
+/**********************************************************************/
+/*
+ * Rounds a byte offset up to a multiple of SPBIN_ALIGN.
+ */
+static long long spbin_align(long long off)
+{
+  return ((off+SPBIN_ALIGN-1)/SPBIN_ALIGN)*SPBIN_ALIGN;
+}
+/**********************************************************************/
+/*
+ * Writes zeros from byte *pos up to byte off, then nbytes from a;
+ * *pos is the position in the file.
+ */
+static void spbin_write(FILE *fp,long long *pos,long long off,const void *a,size_t nbytes)
+{
+  static const char zeros[SPBIN_ALIGN]={0};
+  size_t m;
+  while(*pos<off){
+    m=(size_t )(off-*pos);
+    if(m>SPBIN_ALIGN) m=SPBIN_ALIGN;
+    if(fwrite(zeros,1,m,fp)!=m) check_error(ERROR_OPEN_FILE,__FUNCTION__);
+    *pos+=m;
+  }
+  if(nbytes && fwrite(a,1,nbytes,fp)!=nbytes) check_error(ERROR_OPEN_FILE,__FUNCTION__);
+  *pos+=nbytes;
+  return;
+}
+/**********************************************************************/
+/*
+ * Fills the header of a binary file; the offsets are those written by
+ * dcsr_write_bin() (matrix) and dvec_write_bin() (vector).
+ */
+static void spbin_header_init(spbin_header *head,const char *magic,INT row,INT col,INT nnz)
+{
+  memset(head,0,sizeof(spbin_header));
+  memcpy(head->magic,magic,strlen(magic)); /* not NUL terminated if 8 long */
+  head->version=SPBIN_VERSION;
+  head->byte_order=1;
+  head->int_size=(INT )sizeof(INT);
+  head->real_size=(INT )sizeof(REAL);
+  head->row=row;
+  head->col=col;
+  head->nnz=nnz;
+  if(strcmp(magic,SPBIN_MAGIC_VEC)){
+    head->off_IA=spbin_align(sizeof(spbin_header));
+    head->off_JA=spbin_align(head->off_IA+((long long )row+1)*sizeof(INT));
+    head->off_val=spbin_align(head->off_JA+(long long )nnz*sizeof(INT));
+  } else {
+    head->off_val=spbin_align(sizeof(spbin_header));
+  }
+  return;
+}
+/**********************************************************************/
+/*
+ * Length of a binary file with the given header.
+ */
+static long long spbin_end(spbin_header *head)
+{
+  return head->off_val+(long long )head->nnz*sizeof(REAL);
+}
+/**********************************************************************/
+/*
+ * Maps the binary file written by dcsr_write_bin() or dvec_write_bin()
+ * (magic tells which) into memory and checks its header.  The mapping
+ * is private and writable, and is as long as spbin_end(head).
+ */
+static void *spbin_map(const char *filename,const char *magic,spbin_header *head)
+{
+  struct stat st;
+  spbin_header ref;
+  void *map;
+  INT ok;
+  FILE *fp=fopen(filename,"rb");
+  if(fp==NULL) check_error(ERROR_OPEN_FILE,__FUNCTION__);
+  if(fstat(fileno(fp),&st) || st.st_size<(off_t )sizeof(spbin_header) || \
+     fread(head,sizeof(spbin_header),1,fp)!=1){
+    fprintf(stderr,"Binary file %s is too short\n",filename);
+    fclose(fp);
+    check_error(ERROR_WRONG_FILE,__FUNCTION__);
+  }
+  // Check that the file was written by dcsr_write_bin() or
+  // dvec_write_bin() on a similar machine
+  ok=(strncmp(head->magic,magic,sizeof(head->magic))==0);
+  if(!ok)
+    fprintf(stderr,"%s is not a binary %s file\n",filename, \
+	    strcmp(magic,SPBIN_MAGIC_VEC) ? "matrix" : "vector");
+  if(ok && (head->version<1 || head->version>SPBIN_VERSION)){
+    fprintf(stderr,"%s has version %d; only %d or earlier can be read\n", \
+	    filename,head->version,SPBIN_VERSION);
+    ok=0;
+  }
+  if(ok && (head->byte_order!=1 || head->int_size!=(INT )sizeof(INT) || \
+	    head->real_size!=(INT )sizeof(REAL))){
+    fprintf(stderr,"%s was written with a different byte order or INT/REAL size\n",filename);
+    ok=0;
+  }
+  if(ok){
+    spbin_header_init(&ref,magic,head->row,head->col,head->nnz);
+    ok=(head->row>=0 && head->col>=0 && head->nnz>=0 && \
+	(strcmp(magic,SPBIN_MAGIC_VEC) || head->nnz==head->row) && \
+	head->off_IA==ref.off_IA && head->off_JA==ref.off_JA && \
+	head->off_val==ref.off_val && spbin_end(head)<=(long long )st.st_size);
+    if(!ok) fprintf(stderr,"%s has wrong sizes or offsets\n",filename);
+  }
+  if(!ok){
+    fclose(fp);
+    check_error(ERROR_WRONG_FILE,__FUNCTION__);
+  }
+  map=mmap(NULL,(size_t )spbin_end(head),PROT_READ|PROT_WRITE,MAP_PRIVATE,fileno(fp),0);
+  fclose(fp);
+  if(map==MAP_FAILED){
+    fprintf(stderr,"Cannot map %s\n",filename);
+    check_error(ERROR_OPEN_FILE,__FUNCTION__);
+  }
+  return map;
+}
+/**********************************************************************/
+/*
+ * Removes the mapping of a binary file, given the start of its first
+ * array, which is at byte off of the file.
+ */
+static void spbin_unmap(void *first,long long off)
+{
+  spbin_header head;
+  char *map=(char *)first-off;
+  memcpy(&head,map,sizeof(spbin_header));
+  munmap(map,(size_t )spbin_end(&head));
+  return;
+}
+/**********************************************************************/
+/*!
+ * \fn void dcsr_write_bin(const char *filename,dCSRmat *A)
+ *
+ * \brief Writes a dCSRmat to a binary file: a header (struct
+ *        spbin_header), then IA, JA and val as they are in memory, each
+ *        starting at a multiple of SPBIN_ALIGN bytes.
+ *
+ * \param filename  File name
+ * \param A         Pointer to the dCSRmat matrix (IA starting from 0)
+ *
+ * \note The file is read with dcsr_map_bin() or dcsr_read_bin() on a
+ *       machine with the same byte order and INT and REAL sizes.
+ *
+ */
+void dcsr_write_bin(const char *filename,dCSRmat *A)
+{
+  spbin_header head;
+  long long pos=0;
+  FILE *fp=fopen(filename,"wb");
+  if(fp==NULL) check_error(ERROR_OPEN_FILE,__FUNCTION__);
+  spbin_header_init(&head,SPBIN_MAGIC_CSR,A->row,A->col,A->nnz);
+  spbin_write(fp,&pos,0,&head,sizeof(spbin_header));
+  spbin_write(fp,&pos,head.off_IA,A->IA,((size_t )A->row+1)*sizeof(INT));
+  spbin_write(fp,&pos,head.off_JA,A->JA,(size_t )A->nnz*sizeof(INT));
+  spbin_write(fp,&pos,head.off_val,A->val,(size_t )A->nnz*sizeof(REAL));
+  if(fclose(fp)) check_error(ERROR_OPEN_FILE,__FUNCTION__);
+  return;
+}
+/**********************************************************************/
+/*!
+ * \fn void dvec_write_bin(const char *filename,dvector *b)
+ *
+ * \brief Writes a dvector to a binary file: a header (struct
+ *        spbin_header) and then the values, starting at SPBIN_ALIGN
+ *        bytes.
+ *
+ * \param filename  File name
+ * \param b         Pointer to the dvector
+ *
+ */
+void dvec_write_bin(const char *filename,dvector *b)
+{
+  spbin_header head;
+  long long pos=0;
+  FILE *fp=fopen(filename,"wb");
+  if(fp==NULL) check_error(ERROR_OPEN_FILE,__FUNCTION__);
+  spbin_header_init(&head,SPBIN_MAGIC_VEC,b->row,1,b->row);
+  spbin_write(fp,&pos,0,&head,sizeof(spbin_header));
+  spbin_write(fp,&pos,head.off_val,b->val,(size_t )b->row*sizeof(REAL));
+  if(fclose(fp)) check_error(ERROR_OPEN_FILE,__FUNCTION__);
+  return;
+}
+/**********************************************************************/
+/*!
+ * \fn void dcsr_map_bin(const char *filename,dCSRmat *A)
+ *
+ * \brief Maps a binary file written by dcsr_write_bin() into memory;
+ *        IA, JA and val of A point into the mapping, so nothing is
+ *        read until it is used.
+ *
+ * \param filename  File name
+ * \param A         Pointer to the dCSRmat matrix (output)
+ *
+ * \note The mapping is private: A may be changed in place, which
+ *       copies only the changed pages and does not change the file.
+ *       The arrays must not be reallocated or freed; A is released
+ *       with dcsr_unmap_bin() and not with dcsr_free().
+ *
+ */
+void dcsr_map_bin(const char *filename,dCSRmat *A)
+{
+  spbin_header head;
+  char *map=(char *)spbin_map(filename,SPBIN_MAGIC_CSR,&head);
+  A->row=head.row;
+  A->col=head.col;
+  A->nnz=head.nnz;
+  A->IA=(INT *)(map+head.off_IA);
+  A->JA=(INT *)(map+head.off_JA);
+  A->val=(REAL *)(map+head.off_val);
+  return;
+}
+/**********************************************************************/
+/*!
+ * \fn void dcsr_unmap_bin(dCSRmat *A)
+ *
+ * \brief Releases a matrix mapped with dcsr_map_bin().
+ *
+ * \param A         Pointer to the dCSRmat matrix
+ *
+ */
+void dcsr_unmap_bin(dCSRmat *A)
+{
+  if(A->IA==NULL) return;
+  spbin_unmap(A->IA,spbin_align(sizeof(spbin_header)));
+  A->row=A->col=A->nnz=0;
+  A->IA=A->JA=NULL;
+  A->val=NULL;
+  return;
+}
+/**********************************************************************/
+/*!
+ * \fn void dvec_map_bin(const char *filename,dvector *b)
+ *
+ * \brief Maps a binary file written by dvec_write_bin() into memory;
+ *        the values of b point into the mapping.
+ *
+ * \param filename  File name
+ * \param b         Pointer to the dvector (output)
+ *
+ * \note As for dcsr_map_bin(), b may be changed in place and is
+ *       released with dvec_unmap_bin() and not with dvec_free().
+ *
+ */
+void dvec_map_bin(const char *filename,dvector *b)
+{
+  spbin_header head;
+  char *map=(char *)spbin_map(filename,SPBIN_MAGIC_VEC,&head);
+  b->row=head.row;
+  b->val=(REAL *)(map+head.off_val);
+  return;
+}
+/**********************************************************************/
+/*!
+ * \fn void dvec_unmap_bin(dvector *b)
+ *
+ * \brief Releases a vector mapped with dvec_map_bin().
+ *
+ * \param b         Pointer to the dvector
+ *
+ */
+void dvec_unmap_bin(dvector *b)
+{
+  if(b->val==NULL) return;
+  spbin_unmap(b->val,spbin_align(sizeof(spbin_header)));
+  b->row=0;
+  b->val=NULL;
+  return;
+}
+/**********************************************************************/
+/*!
+ * \fn void dcsr_read_bin(const char *filename,dCSRmat *A)
+ *
+ * \brief Reads a binary file written by dcsr_write_bin() into newly
+ *        allocated arrays (freed with dcsr_free()).
+ *
+ * \param filename  File name
+ * \param A         Pointer to the dCSRmat matrix (output)
+ *
+ */
+void dcsr_read_bin(const char *filename,dCSRmat *A)
+{
+  dCSRmat Amap;
+  dcsr_map_bin(filename,&Amap);
+  dcsr_alloc(Amap.row,Amap.col,Amap.nnz,A);
+  memcpy(A->IA,Amap.IA,((size_t )Amap.row+1)*sizeof(INT));
+  if(Amap.nnz){
+    memcpy(A->JA,Amap.JA,(size_t )Amap.nnz*sizeof(INT));
+    memcpy(A->val,Amap.val,(size_t )Amap.nnz*sizeof(REAL));
+  }
+  dcsr_unmap_bin(&Amap);
+  return;
+}
+/**********************************************************************/
+/*!
+ * \fn void dvec_read_bin(const char *filename,dvector *b)
+ *
+ * \brief Reads a binary file written by dvec_write_bin() into a newly
+ *        allocated vector (freed with dvec_free()).
+ *
+ * \param filename  File name
+ * \param b         Pointer to the dvector (output)
+ *
+ */
+void dvec_read_bin(const char *filename,dvector *b)
+{
+  dvector bmap;
+  dvec_map_bin(filename,&bmap);
+  dvec_alloc(bmap.row,b);
+  if(bmap.row) memcpy(b->val,bmap.val,(size_t )bmap.row*sizeof(REAL));
+  dvec_unmap_bin(&bmap);
+  return;
+}
+/**********************************************************************/
+/*
+ * Reads a whole text file; the text is terminated by a NUL.
+ */
+static char *spio_slurp(const char *filename,size_t *len)
+{
+  FILE *fp=fopen(filename,"rb");
+  char *s;
+  off_t n=0;
+  if(fp==NULL) check_error(ERROR_OPEN_FILE,__FUNCTION__);
+  if(fseeko(fp,0,SEEK_END)) check_error(ERROR_WRONG_FILE,__FUNCTION__);
+  n=ftello(fp);
+  if(n<0) check_error(ERROR_WRONG_FILE,__FUNCTION__);
+  rewind(fp);
+  s=(char *)malloc((size_t )n+1);
+  if(fread(s,1,(size_t )n,fp)!=(size_t )n) check_error(ERROR_WRONG_FILE,__FUNCTION__);
+  fclose(fp);
+  s[n]='\0';
+  *len=(size_t )n;
+  return s;
+}
+/**********************************************************************/
+static INT spio_space(char c)
+{
+  return (c==' ' || c=='\n' || c=='\t' || c=='\r' || c=='\v' || c=='\f');
+}
+/**********************************************************************/
+/*
+ * Skips white space and comments (from '%' to the end of the line).
+ */
+static char *spio_skip(char *p,char *end)
+{
+  while(p<end){
+    if(spio_space(*p))
+      p++;
+    else if(*p=='%')
+      while(p<end && *p!='\n') p++;
+    else
+      break;
+  }
+  return p;
+}
+/**********************************************************************/
+/*
+ * Reads the MatrixMarket banner of s if it has one, and returns 1 for a
+ * MatrixMarket file and 0 otherwise.  *array is 1 for the dense format,
+ * *pattern is 1 if there are no values and *symm is 0 (general), 1
+ * (symmetric) or -1 (skew-symmetric).
+ */
+static INT spio_banner(const char *s,INT *array,INT *pattern,INT *symm)
+{
+  char line[256],obj[64],fmt[64],fld[64],sym[64];
+  INT i;
+  *array=0;
+  *pattern=0;
+  *symm=0;
+  if(strncmp(s,"%%MatrixMarket",14)) return 0;
+  for(i=0;i<255 && s[i] && s[i]!='\n';i++) line[i]=s[i];
+  line[i]='\0';
+  if(sscanf(line+14,"%63s %63s %63s %63s",obj,fmt,fld,sym)!=4 || strcasecmp(obj,"matrix") || \
+     (strcasecmp(fmt,"coordinate") && strcasecmp(fmt,"array")) || \
+     (strcasecmp(fld,"real") && strcasecmp(fld,"double") && \
+      strcasecmp(fld,"integer") && strcasecmp(fld,"pattern")) || \
+     (strcasecmp(sym,"general") && strcasecmp(sym,"symmetric") && \
+      strcasecmp(sym,"skew-symmetric"))){
+    fprintf(stderr,"Only real, integer or pattern MatrixMarket matrices can be read:\n%s\n",line);
+    check_error(ERROR_WRONG_FILE,__FUNCTION__);
+  }
+  *array=(strcasecmp(fmt,"array")==0);
+  *pattern=(strcasecmp(fld,"pattern")==0);
+  if(!strcasecmp(sym,"symmetric")) *symm=1;
+  if(!strcasecmp(sym,"skew-symmetric")) *symm=-1;
+  return 1;
+}
+/**********************************************************************/
+/*
+ * Reads k nonnegative integers (the sizes) after the banner and
+ * comments; returns the text after them, or NULL if they are wrong.
+ */
+static char *spio_sizes(char *p,char *end,INT k,INT *sz)
+{
+  INT i;
+  long l;
+  char *q;
+  for(i=0;i<k;i++){
+    p=spio_skip(p,end);
+    l=strtol(p,&q,10);
+    if(q==p || l<0 || l>INT_MAX || (q<end && !spio_space(*q))) return NULL;
+    sz[i]=(INT )l;
+    p=q;
+  }
+  return p;
+}
+/**********************************************************************/
+/*
+ * Parses nent entries of ntok numbers from the text between p and end:
+ * a value (ntok=1), a row and a column (ntok=2) or a row, a column and
+ * a value (ntok=3).  Rows and columns are shifted by -base and must be
+ * in [0,m) and [0,n).  The text is split at line ends into pieces which
+ * are parsed in parallel: the numbers in each piece are counted first,
+ * which gives the entry where every piece starts.  Returns the number
+ * of wrong numbers, or -1 if there are fewer than nent entries.
+ */
+static long long spio_parse(char *p,char *end,INT ntok,INT nent,INT base,INT m,INT n, \
+			    INT *ia,INT *ja,REAL *val)
+{
+  long long ntot=(long long )nent*ntok,nbad=0;
+  INT nparts=1,c;
+#ifdef _OPENMP
+  if(end-p>(1<<20)) nparts=64;
+#endif
+  char **pb=(char **)malloc((nparts+1)*sizeof(char *));
+  long long *first=(long long *)calloc(nparts+1,sizeof(long long));
+  pb[0]=p;
+  pb[nparts]=end;
+  for(c=1;c<nparts;c++){
+    char *q=p+(end-p)/nparts*c;
+    if(q<pb[c-1]) q=pb[c-1];
+    while(q<end && *q!='\n') q++;
+    pb[c]=q;
+  }
+
+#ifdef _OPENMP
+#pragma omp parallel for if(nparts>1)
+#endif
+  for(c=0;c<nparts;c++){
+    long long k=0;
+    char *q=spio_skip(pb[c],pb[c+1]);
+    while(q<pb[c+1]){
+      k++;
+      while(q<pb[c+1] && !spio_space(*q)) q++;
+      q=spio_skip(q,pb[c+1]);
+    }
+    first[c+1]=k;
+  }
+  for(c=0;c<nparts;c++) first[c+1]+=first[c];
+  if(first[nparts]<ntot){
+    free(pb);
+    free(first);
+    return -1;
+  }
+
+#ifdef _OPENMP
+#pragma omp parallel for reduction(+:nbad) if(nparts>1)
+#endif
+  for(c=0;c<nparts;c++){
+    long long t,e,v;
+    INT k,neg;
+    char *q=spio_skip(pb[c],pb[c+1]),*r;
+    for(t=first[c];q<pb[c+1] && t<ntot;t++){
+      e=t/ntok;
+      k=(INT )(t%ntok);
+      if(k<2 && ntok>1){
+	// row or column
+	r=q;
+	neg=(*r=='-');
+	if(*r=='-' || *r=='+') r++;
+	for(v=0;*r>='0' && *r<='9' && v<=INT_MAX;r++) v=10*v+(*r-'0');
+	v=(neg ? -v : v)-base;
+	if(r==q || (r<end && !spio_space(*r)) || v<0 || v>=((k==0) ? m : n)) {
+	  nbad++;
+	  v=0;
+	}
+	if(k==0)
+	  ia[e]=(INT )v;
+	else
+	  ja[e]=(INT )v;
+      } else {
+	val[e]=strtod(q,&r);
+	if(r==q || (r<end && !spio_space(*r))) nbad++;
+      }
+      q=r;
+      while(q<pb[c+1] && !spio_space(*q)) q++;
+      q=spio_skip(q,pb[c+1]);
+    }
+  }
+  free(pb);
+  free(first);
+  return nbad;
+}
+/**********************************************************************/
+/*
+ * Stops with a message if spio_parse() returned nbad!=0; fname is the
+ * name of the reader.
+ */
+static void spio_check(const char *filename,long long nbad,INT nent,const char *fname)
+{
+  if(nbad<0)
+    fprintf(stderr,"%s has fewer than %d entries\n",filename,nent);
+  else if(nbad>0)
+    fprintf(stderr,"%s has %lld wrong numbers or indices\n",filename,nbad);
+  if(nbad) check_error(ERROR_WRONG_FILE,fname);
+  return;
+}
+/**********************************************************************/
+/*!
+ * \fn void dcsr_read_mm(const char *filename,dCSRmat *A)
+ *
+ * \brief Reads a sparse matrix from a text file and converts it to CSR
+ *        format.  The file is parsed in parallel (with OpenMP).
+ *
+ * \param filename  File name
+ * \param A         Pointer to the dCSRmat matrix (output)
+ *
+ * \note File formats:
+ *   - MatrixMarket coordinate (real, integer or pattern; general,
+ *     symmetric or skew-symmetric): banner, comments, then
+ *     "nrow ncol nnz" and "i j a_ij" with i, j starting from 1.
+ *     Symmetric matrices are expanded.
+ *   - No banner (as written by dcsr_write_dcoo()): "nrow ncol nnz"
+ *     and "i j a_ij" with i, j starting from 0.
+ *
+ */
+void dcsr_read_mm(const char *filename,dCSRmat *A)
+{
+  size_t len;
+  char *s=spio_slurp(filename,&len),*p;
+  INT mm,array,pattern,symm,sz[3],k,nnz,noff=0;
+  long long nbad;
+  mm=spio_banner(s,&array,&pattern,&symm);
+  if(array){
+    fprintf(stderr,"%s: dense MatrixMarket matrices can not be read\n",filename);
+    check_error(ERROR_WRONG_FILE,__FUNCTION__);
+  }
+  p=spio_sizes(s,s+len,3,sz);
+  if(p==NULL){
+    fprintf(stderr,"%s does not start with \"nrow ncol nnz\"\n",filename);
+    check_error(ERROR_WRONG_FILE,__FUNCTION__);
+  }
+  nnz=sz[2];
+  dCOOmat Atmp=dcoo_create(sz[0],sz[1],nnz);
+  nbad=spio_parse(p,s+len,pattern ? 2 : 3,nnz,mm,sz[0],sz[1], \
+		  Atmp.rowind,Atmp.colind,Atmp.val);
+  free(s);
+  spio_check(filename,nbad,nnz,__FUNCTION__);
+  if(pattern)
+    for(k=0;k<nnz;k++) Atmp.val[k]=1e0;
+
+  // Add the upper triangle of symmetric matrices
+  if(symm){
+    for(k=0;k<nnz;k++) noff+=(Atmp.rowind[k]!=Atmp.colind[k]);
+    Atmp.rowind=(INT *)realloc(Atmp.rowind,(nnz+noff)*sizeof(INT));
+    Atmp.colind=(INT *)realloc(Atmp.colind,(nnz+noff)*sizeof(INT));
+    Atmp.val=(REAL *)realloc(Atmp.val,(nnz+noff)*sizeof(REAL));
+    Atmp.nnz=nnz;
+    for(k=0;k<nnz;k++){
+      if(Atmp.rowind[k]==Atmp.colind[k]) continue;
+      Atmp.rowind[Atmp.nnz]=Atmp.colind[k];
+      Atmp.colind[Atmp.nnz]=Atmp.rowind[k];
+      Atmp.val[Atmp.nnz]=symm*Atmp.val[k];
+      Atmp.nnz++;
+    }
+  }
+
+  dcoo_2_dcsr(&Atmp,A);
+  dcoo_free(&Atmp);
+  return;
+}
+/**********************************************************************/
+/*!
+ * \fn void dvec_read_mm(const char *filename,dvector *b)
+ *
+ * \brief Reads a vector from a text file.  The file is parsed in
+ *        parallel (with OpenMP).
+ *
+ * \param filename  File name
+ * \param b         Pointer to the dvector (output)
+ *
+ * \note File formats:
+ *   - MatrixMarket array with one column: banner, comments, "nrow 1"
+ *     and the values.
+ *   - MatrixMarket coordinate with one column: banner, comments,
+ *     "nrow 1 nnz" and "i 1 b_i" with i starting from 1.
+ *   - No banner (as written by dvector_write()): "nrow" and the
+ *     values.
+ *
+ */
+void dvec_read_mm(const char *filename,dvector *b)
+{
+  size_t len;
+  char *s=spio_slurp(filename,&len),*p;
+  INT mm,array,pattern,symm,sz[3]={0,1,0},k,*ia,*ja;
+  REAL *val;
+  long long nbad;
+  mm=spio_banner(s,&array,&pattern,&symm);
+  p=spio_sizes(s,s+len,(mm) ? ((array) ? 2 : 3) : 1,sz);
+  if(p==NULL || sz[1]!=1){
+    fprintf(stderr,"%s does not start with the size of a vector\n",filename);
+    check_error(ERROR_WRONG_FILE,__FUNCTION__);
+  }
+  dvec_alloc(sz[0],b);
+  if(!mm || array){
+    nbad=spio_parse(p,s+len,1,sz[0],0,0,0,NULL,NULL,b->val);
+    free(s);
+    spio_check(filename,nbad,sz[0],__FUNCTION__);
+    return;
+  }
+  // MatrixMarket coordinate: the entries which are not given are zero
+  ia=(INT *)calloc(sz[2],sizeof(INT));
+  ja=(INT *)calloc(sz[2],sizeof(INT));
+  val=(REAL *)calloc(sz[2],sizeof(REAL));
+  nbad=spio_parse(p,s+len,pattern ? 2 : 3,sz[2],1,sz[0],1,ia,ja,val);
+  free(s);
+  spio_check(filename,nbad,sz[2],__FUNCTION__);
+  memset(b->val,0,sz[0]*sizeof(REAL));
+  for(k=0;k<sz[2];k++) b->val[ia[k]]+=(pattern) ? 1e0 : val[k];
+  free(ia);
+  free(ja);
+  free(val);
+  return;
+}
+/**********************************************************************/
+/*!
+ * \fn void dcsr_write_mm(const char *filename,dCSRmat *A)
+ *
+ * \brief Writes a dCSRmat to a MatrixMarket coordinate file (indices
+ *        starting from 1, values with 17 significant digits).  Pieces
+ *        of the file are formatted in parallel (with OpenMP) and written
+ *        in order.
+ *
+ * \param filename  File name
+ * \param A         Pointer to the dCSRmat matrix (IA starting from 0)
+ *
+ */
+void dcsr_write_mm(const char *filename,dCSRmat *A)
+{
+  INT nchunk=A->nnz/SPIO_CHUNK+1,c,nerr=0;
+  FILE *fp=fopen(filename,"w");
+  if(fp==NULL) check_error(ERROR_OPEN_FILE,__FUNCTION__);
+  fprintf(fp,"%%%%MatrixMarket matrix coordinate real general\n");
+  fprintf(fp,"%d %d %d\n",A->row,A->col,A->nnz);
+  if(nchunk>A->row) nchunk=(A->row>0) ? A->row : 1;
+
+#ifdef _OPENMP
+#pragma omp parallel for ordered schedule(static,1) reduction(+:nerr) if(nchunk>1)
+#endif
+  for(c=0;c<nchunk;c++){
+    INT i,k;
+    INT r0=(INT )((long long )A->row*c/nchunk);
+    INT r1=(INT )((long long )A->row*(c+1)/nchunk);
+    // at most 11+1+11+1+24+1 characters an entry
+    char *buf=(char *)malloc((size_t )(A->IA[r1]-A->IA[r0])*64+1),*q=buf;
+    for(i=r0;i<r1;i++)
+      for(k=A->IA[i];k<A->IA[i+1];k++)
+	q+=sprintf(q,"%d %d %.16e\n",i+1,A->JA[k]+1,A->val[k]);
+#ifdef _OPENMP
+#pragma omp ordered
+#endif
+    if(fwrite(buf,1,q-buf,fp)!=(size_t )(q-buf)) nerr++;
+    free(buf);
+  }
+
+  if(fclose(fp) || nerr) check_error(ERROR_OPEN_FILE,__FUNCTION__);
+  return;
+}
+/**********************************************************************/
+/*!
+ * \fn void dvec_write_mm(const char *filename,dvector *b)
+ *
+ * \brief Writes a dvector to a MatrixMarket array file with one column
+ *        (values with 17 significant digits), formatted in parallel as
+ *        in dcsr_write_mm().
+ *
+ * \param filename  File name
+ * \param b         Pointer to the dvector
+ *
+ */
+void dvec_write_mm(const char *filename,dvector *b)
+{
+  INT nchunk=b->row/SPIO_CHUNK+1,c,nerr=0;
+  FILE *fp=fopen(filename,"w");
+  if(fp==NULL) check_error(ERROR_OPEN_FILE,__FUNCTION__);
+  fprintf(fp,"%%%%MatrixMarket matrix array real general\n");
+  fprintf(fp,"%d 1\n",b->row);
+
+#ifdef _OPENMP
+#pragma omp parallel for ordered schedule(static,1) reduction(+:nerr) if(nchunk>1)
+#endif
+  for(c=0;c<nchunk;c++){
+    INT i;
+    INT i0=(INT )((long long )b->row*c/nchunk);
+    INT i1=(INT )((long long )b->row*(c+1)/nchunk);
+    char *buf=(char *)malloc((size_t )(i1-i0)*32+1),*q=buf;
+    for(i=i0;i<i1;i++)
+      q+=sprintf(q,"%.16e\n",b->val[i]);
+#ifdef _OPENMP
+#pragma omp ordered
+#endif
+    if(fwrite(buf,1,q-buf,fp)!=(size_t )(q-buf)) nerr++;
+    free(buf);
+  }
+
+  if(fclose(fp) || nerr) check_error(ERROR_OPEN_FILE,__FUNCTION__);
+  return;
+}
+/**********************************************************************/
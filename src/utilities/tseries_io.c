@@ -0,0 +1,394 @@
+/*! \file src/utilities/tseries_io.c
+ *
+ *  Copyright 2015__HAZMATH__. All rights reserved.
+ *
+ *  \brief Routines for writing time series in XDMF format: the points
+ *         and cells of the mesh are written once to a binary file, and
+ *         every step writes only its fields to a binary file of its
+ *         own.  The .xmf file (a temporal collection) references these;
+ *         it defines the topology and geometry once and every step is
+ *         appended to it, so it is complete after every step.
+ *
+ *  \note If the library is built with POSIX threads (WITH_PTHREADS),
+ *        tseries_write() only copies the fields to one of two snapshot
+ *        buffers and a background thread writes them, so the output
+ *        overlaps the next time step.  The caller waits only when both
+ *        buffers are still being written.
+ *
+ */
+
+#include "hazmath.h"
+#if WITH_PTHREADS
+#include <pthread.h>
+
+/* Background writer of a time series */
+typedef struct {
+  pthread_t thread;
+  pthread_mutex_t lock;
+  pthread_cond_t filled;   /* a snapshot was filled (or the series closed) */
+  pthread_cond_t written;  /* a snapshot was written */
+  INT done;
+} tseries_sync;
+#endif
+/**********************************************************************/
+/*
+ * Writes n bytes to fp; stops on a write error.
+ */
+static void tseries_fwrite(const void *a,size_t n,FILE *fp)
+{
+  if(n && fwrite(a,1,n,fp)!=n) check_error(ERROR_OPEN_FILE,__FUNCTION__);
+  return;
+}
+/**********************************************************************/
+/*
+ * Writes a DataItem for the binary file "file" (relative to the .xmf
+ * file), starting at byte seek.
+ */
+static void tseries_dataitem(FILE *fp,INT n,INT m,const char *type,INT prec, \
+			     long long seek,const char *file)
+{
+  unsigned INT one=1;
+  char *endian=(*(unsigned char *)&one) ? "Little" : "Big";
+  if(m>1)
+    fprintf(fp,"<DataItem Dimensions=\"%i %i\"",n,m);
+  else
+    fprintf(fp,"<DataItem Dimensions=\"%i\"",n);
+  fprintf(fp," NumberType=\"%s\" Precision=\"%i\" Format=\"Binary\" Endian=\"%s\" Seek=\"%lld\">%s</DataItem>\n", \
+	  type,prec,endian,seek,file);
+  return;
+}
+/**********************************************************************/
+/*
+ * Writes the closing tags of the .xmf file and goes back to their start,
+ * so that the file is complete after every step and the next step
+ * overwrites them.
+ */
+static void tseries_xmf_close_tags(tseries_file *ts)
+{
+  FILE *fp=ts->xmf;
+  fprintf(fp,"</Grid>\n</Domain>\n</Xdmf>\n");
+  if(fflush(fp) || fseeko(fp,(off_t )ts->xmf_end,SEEK_SET))
+    check_error(ERROR_OPEN_FILE,__FUNCTION__);
+  return;
+}
+/**********************************************************************/
+/*
+ * Starts the .xmf file: the topology and the geometry are defined once
+ * in the domain (the steps refer to them), followed by the temporal
+ * collection with no steps yet.
+ */
+static void tseries_xmf_open(tseries_file *ts)
+{
+  const char *topo[4]={"","Polyline","Triangle","Tetrahedron"};
+  const char *rel=strrchr(ts->base,'/');
+  char *geom=(char *)calloc(strlen(ts->base)+32,sizeof(char));
+  FILE *fp;
+  rel=(rel) ? rel+1 : ts->base;
+  sprintf(geom,"%s_geom.bin",rel);
+  fp=HAZ_fopen(ts->name,"w");
+  ts->xmf=fp;
+  fprintf(fp,"<?xml version=\"1.0\" ?>\n");
+  fprintf(fp,"<Xdmf Version=\"3.0\">\n<Domain>\n");
+  fprintf(fp,"<Topology Name=\"cells\" TopologyType=\"%s\" NumberOfElements=\"%i\"%s>\n", \
+	  topo[ts->dim],ts->nelm,(ts->dim==1) ? " NodesPerElement=\"2\"" : "");
+  tseries_dataitem(fp,ts->nelm,ts->dim+1,"Int",(INT )sizeof(INT), \
+		   3*(long long )ts->nv*sizeof(REAL),geom);
+  fprintf(fp,"</Topology>\n");
+  fprintf(fp,"<Geometry Name=\"points\" GeometryType=\"XYZ\">\n");
+  tseries_dataitem(fp,ts->nv,3,"Float",(INT )sizeof(REAL),0,geom);
+  fprintf(fp,"</Geometry>\n");
+  fprintf(fp,"<Grid Name=\"TimeSeries\" GridType=\"Collection\" CollectionType=\"Temporal\">\n");
+  ts->xmf_end=(long long )ftello(fp);
+  tseries_xmf_close_tags(ts);
+  free(geom);
+  return;
+}
+/**********************************************************************/
+/*
+ * Appends the step i, at the given time, to the .xmf file.
+ */
+static void tseries_xmf_step(tseries_file *ts,INT i,REAL time)
+{
+  const char *rel=strrchr(ts->base,'/');
+  char *step=(char *)calloc(strlen(ts->base)+32,sizeof(char));
+  INT f,n,m;
+  long long seek=0;
+  FILE *fp=ts->xmf;
+  rel=(rel) ? rel+1 : ts->base;
+  sprintf(step,"%s_%05d.bin",rel,i);
+  fprintf(fp,"<Grid Name=\"step%05d\" GridType=\"Uniform\">\n",i);
+  fprintf(fp,"<Time Value=\"%.16e\"/>\n",time);
+  fprintf(fp,"<Topology Reference=\"XML\">/Xdmf/Domain/Topology[1]</Topology>\n");
+  fprintf(fp,"<Geometry Reference=\"XML\">/Xdmf/Domain/Geometry[1]</Geometry>\n");
+  for(f=0;f<ts->nfield;f++){
+    n=(ts->center[f]==TSERIES_CELL) ? ts->nelm : ts->nv;
+    m=(ts->ncomp[f]>1) ? 3 : 1;
+    fprintf(fp,"<Attribute Name=\"%s\" AttributeType=\"%s\" Center=\"%s\">\n", \
+	    ts->fname[f],(m>1) ? "Vector" : "Scalar", \
+	    (ts->center[f]==TSERIES_CELL) ? "Cell" : "Node");
+    tseries_dataitem(fp,n,m,"Float",(INT )sizeof(REAL),seek,step);
+    fprintf(fp,"</Attribute>\n");
+    seek+=(long long )n*m*sizeof(REAL);
+  }
+  fprintf(fp,"</Grid>\n");
+  ts->xmf_end=(long long )ftello(fp);
+  tseries_xmf_close_tags(ts);
+  free(step);
+  return;
+}
+/**********************************************************************/
+/*
+ * Writes the snapshot k as the next step of the series and appends it
+ * to the .xmf file.
+ */
+static void tseries_dump(tseries_file *ts,INT k)
+{
+  char *step=(char *)calloc(strlen(ts->base)+32,sizeof(char));
+  FILE *fp;
+  sprintf(step,"%s_%05d.bin",ts->base,ts->nwritten);
+  fp=HAZ_fopen(step,"wb");
+  tseries_fwrite(ts->snap[k],ts->nsnap*sizeof(REAL),fp);
+  fclose(fp);
+  free(step);
+  tseries_xmf_step(ts,ts->nwritten,ts->tsnap[k]);
+  ts->nwritten++;
+  return;
+}
+#if WITH_PTHREADS
+/**********************************************************************/
+/*
+ * Background writer: writes the snapshots in the order they are filled
+ * until the series is closed and all snapshots are written.
+ */
+static void *tseries_thread(void *arg)
+{
+  tseries_file *ts=(tseries_file *)arg;
+  tseries_sync *s=(tseries_sync *)ts->sync;
+  INT k;
+  pthread_mutex_lock(&s->lock);
+  while(1){
+    k=ts->nwritten%2;
+    while(!ts->full[k] && !s->done)
+      pthread_cond_wait(&s->filled,&s->lock);
+    if(!ts->full[k]) break;
+    pthread_mutex_unlock(&s->lock);
+    tseries_dump(ts,k);
+    pthread_mutex_lock(&s->lock);
+    ts->full[k]=0;
+    pthread_cond_signal(&s->written);
+  }
+  pthread_mutex_unlock(&s->lock);
+  return NULL;
+}
+#endif
+/**********************************************************************/
+/*!
+ * \fn struct tseries_file *tseries_open(char *namexmf,mesh_struct *mesh,INT async)
+ *
+ * \brief Starts a time series on a simplicial mesh: writes the points
+ *        and the cells of the mesh once, to the file namexmf with
+ *        ".xmf" replaced by "_geom.bin".  The fields are declared with
+ *        tseries_add_field() and every step is written with
+ *        tseries_write() to the file "_%05d.bin" (step number).
+ *
+ * \param namexmf   Name of the .xmf file
+ * \param mesh      Mesh (not used after the call)
+ * \param async     If nonzero, the steps are written by a background
+ *                  thread (only if built with WITH_PTHREADS)
+ *
+ * \return the time series, to be closed with tseries_close()
+ *
+ * \note The mesh must not change during the series.
+ *
+ */
+struct tseries_file *tseries_open(char *namexmf,mesh_struct *mesh,INT async)
+{
+  tseries_file *ts=(tseries_file *)calloc(1,sizeof(tseries_file));
+  REAL *xyz[3]={mesh->cv->x,mesh->cv->y,mesh->cv->z};
+  REAL buf[1024];
+  INT i,j,m=0,len=strlen(namexmf);
+  char *geom;
+  FILE *fp;
+  if(mesh->dim<1 || mesh->dim>3) check_error(ERROR_DIM,__FUNCTION__);
+  ts->nv=mesh->nv;
+  ts->nelm=mesh->nelm;
+  ts->dim=mesh->dim;
+  ts->name=strdup(namexmf);
+  ts->base=strdup(namexmf);
+  if(len>4 && !strcmp(namexmf+len-4,".xmf")) ts->base[len-4]='\0';
+#if WITH_PTHREADS
+  ts->async=(async!=0);
+#else
+  ts->async=0;
+#endif
+  // Points (xyz of every vertex) and then the cells
+  geom=(char *)calloc(strlen(ts->base)+16,sizeof(char));
+  sprintf(geom,"%s_geom.bin",ts->base);
+  fp=HAZ_fopen(geom,"wb");
+  for(i=0;i<ts->nv;i++){
+    for(j=0;j<3;j++){
+      buf[m++]=(xyz[j]) ? xyz[j][i] : 0e0;
+    }
+    if(m>1020){
+      tseries_fwrite(buf,m*sizeof(REAL),fp);
+      m=0;
+    }
+  }
+  tseries_fwrite(buf,m*sizeof(REAL),fp);
+  tseries_fwrite(mesh->el_v->JA,(size_t )ts->nelm*(ts->dim+1)*sizeof(INT),fp);
+  fclose(fp);
+  free(geom);
+  tseries_xmf_open(ts);
+  return ts;
+}
+/**********************************************************************/
+/*!
+ * \fn void tseries_add_field(tseries_file *ts,char *fieldname,INT center,INT ncomp)
+ *
+ * \brief Declares the next field written at every step.  All fields
+ *        must be declared before the first tseries_write().
+ *
+ * \param ts         Time series
+ * \param fieldname  Name of the field
+ * \param center     TSERIES_POINT (values at vertices) or TSERIES_CELL
+ *                   (values on elements)
+ * \param ncomp      Number of components (1, 2 or 3); vectors are
+ *                   written with 3 components
+ *
+ */
+void tseries_add_field(tseries_file *ts,char *fieldname,INT center,INT ncomp)
+{
+  INT f=ts->nfield;
+  if(ts->nfill || ncomp<1 || ncomp>3 || \
+     (center!=TSERIES_POINT && center!=TSERIES_CELL))
+    check_error(ERROR_INPUT_PAR,__FUNCTION__);
+  ts->fname=(char **)realloc(ts->fname,(f+1)*sizeof(char *));
+  ts->center=(INT *)realloc(ts->center,(f+1)*sizeof(INT));
+  ts->ncomp=(INT *)realloc(ts->ncomp,(f+1)*sizeof(INT));
+  ts->fname[f]=strdup(fieldname);
+  ts->center[f]=center;
+  ts->ncomp[f]=ncomp;
+  ts->nsnap+=(long long )((center==TSERIES_CELL) ? ts->nelm : ts->nv)*((ncomp>1) ? 3 : 1);
+  ts->nfield++;
+  return;
+}
+/**********************************************************************/
+/*!
+ * \fn void tseries_write(tseries_file *ts,REAL time,REAL **vals)
+ *
+ * \brief Writes one step of a time series.  The fields are copied, so
+ *        vals can be changed as soon as this returns, also when the
+ *        step is written by the background thread.
+ *
+ * \param ts      Time series
+ * \param time    Time of the step
+ * \param vals    Values of every field in the order of
+ *                tseries_add_field(); component c of the value i is
+ *                vals[f][c*n+i] (n is the number of vertices or
+ *                elements)
+ *
+ */
+void tseries_write(tseries_file *ts,REAL time,REAL **vals)
+{
+  INT f,i,c,n,m,k=ts->nfill%2;
+  REAL *snap;
+#if WITH_PTHREADS
+  tseries_sync *s;
+  if(ts->async && ts->sync==NULL){
+    s=(tseries_sync *)calloc(1,sizeof(tseries_sync));
+    pthread_mutex_init(&s->lock,NULL);
+    pthread_cond_init(&s->filled,NULL);
+    pthread_cond_init(&s->written,NULL);
+    ts->sync=(void *)s;
+    if(pthread_create(&s->thread,NULL,tseries_thread,(void *)ts)){
+      // no thread: write the steps here
+      pthread_mutex_destroy(&s->lock);
+      pthread_cond_destroy(&s->filled);
+      pthread_cond_destroy(&s->written);
+      free(s);
+      ts->sync=NULL;
+      ts->async=0;
+    }
+  }
+  s=(tseries_sync *)ts->sync;
+  if(ts->async){
+    // wait until the snapshot k is written
+    pthread_mutex_lock(&s->lock);
+    while(ts->full[k])
+      pthread_cond_wait(&s->written,&s->lock);
+    pthread_mutex_unlock(&s->lock);
+  }
+#endif
+  if(ts->snap[k]==NULL)
+    ts->snap[k]=(REAL *)malloc(ts->nsnap*sizeof(REAL));
+  snap=ts->snap[k];
+  for(f=0;f<ts->nfield;f++){
+    n=(ts->center[f]==TSERIES_CELL) ? ts->nelm : ts->nv;
+    if(ts->ncomp[f]==1){
+      memcpy(snap,vals[f],n*sizeof(REAL));
+      snap+=n;
+      continue;
+    }
+    m=ts->ncomp[f];
+    for(i=0;i<n;i++){
+      for(c=0;c<3;c++){
+	snap[c]=(c<m) ? vals[f][c*n+i] : 0e0;
+      }
+      snap+=3;
+    }
+  }
+  ts->tsnap[k]=time;
+  ts->nfill++;
+#if WITH_PTHREADS
+  if(ts->async){
+    pthread_mutex_lock(&s->lock);
+    ts->full[k]=1;
+    pthread_cond_signal(&s->filled);
+    pthread_mutex_unlock(&s->lock);
+    return;
+  }
+#endif
+  tseries_dump(ts,k);
+  return;
+}
+/**********************************************************************/
+/*!
+ * \fn void tseries_close(tseries_file *ts)
+ *
+ * \brief Waits until all steps of a time series are written and frees
+ *        it.
+ *
+ * \param ts      Time series
+ *
+ */
+void tseries_close(tseries_file *ts)
+{
+  INT f;
+#if WITH_PTHREADS
+  tseries_sync *s=(tseries_sync *)ts->sync;
+  if(s){
+    pthread_mutex_lock(&s->lock);
+    s->done=1;
+    pthread_cond_signal(&s->filled);
+    pthread_mutex_unlock(&s->lock);
+    pthread_join(s->thread,NULL);
+    pthread_mutex_destroy(&s->lock);
+    pthread_cond_destroy(&s->filled);
+    pthread_cond_destroy(&s->written);
+    free(s);
+  }
+#endif
+  // the closing tags are already written
+  fclose(ts->xmf);
+  for(f=0;f<ts->nfield;f++) free(ts->fname[f]);
+  if(ts->fname) free(ts->fname);
+  if(ts->center) free(ts->center);
+  if(ts->ncomp) free(ts->ncomp);
+  if(ts->snap[0]) free(ts->snap[0]);
+  if(ts->snap[1]) free(ts->snap[1]);
+  free(ts->name);
+  free(ts->base);
+  free(ts);
+  return;
+}
+/**********************************************************************/
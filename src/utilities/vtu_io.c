@@ -0,0 +1,550 @@
+/*! \file src/utilities/vtu_io.c
+ *
+ *  Copyright 2015__HAZMATH__. All rights reserved.
+ *
+ *  \brief Routines for writing VTU files with ascii data, or with binary
+ *         data appended raw or encoded in base64, optionally compressed
+ *         in zlib format (as vtkZLibDataCompressor).
+ *
+ *  \note The binary data is produced and written in blocks of
+ *        VTU_BLOCK_SIZE bytes, so no value is formatted as text and no
+ *        array is copied as a whole.
+ *
+ */
+
+#include "hazmath.h"
+
+/* Format used by vtu_open(), see set_vtu_format() */
+static INT vtu_format=VTU_ASCII;
+static INT vtu_compress=0;
+
+/* Tables of the deflate format (RFC 1951) for lengths and distances */
+static const INT len_base[29]={3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,
+			       35,43,51,59,67,83,99,115,131,163,195,227,258};
+static const INT len_extra[29]={0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,
+				3,3,3,3,4,4,4,4,5,5,5,5,0};
+static const INT dist_base[30]={1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,
+				257,385,513,769,1025,1537,2049,3073,4097,
+				6145,8193,12289,16385,24577};
+static const INT dist_extra[30]={0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,
+				 7,7,8,8,9,9,10,10,11,11,12,12,13,13};
+static const char b64_chars[]=
+  "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+#define VTU_HASH_BITS 15
+#define VTU_MAX_CHAIN 8
+/**********************************************************************/
+/*
+ * Appends the len lowest bits of code to the output, least significant
+ * bit first; *bb and *nb hold the bits which do not fill a byte yet.
+ */
+static void put_bits(unsigned char *out,size_t *pos,unsigned long long *bb,
+		     INT *nb,unsigned long long code,INT len)
+{
+  *bb |= code<<(*nb);
+  *nb += len;
+  while(*nb>=8){
+    out[(*pos)++]=(unsigned char )(*bb & 0xff);
+    *bb >>= 8;
+    *nb -= 8;
+  }
+  return;
+}
+
+/*
+ * Appends a Huffman code of length len (these are stored most
+ * significant bit first).
+ */
+static void put_code(unsigned char *out,size_t *pos,unsigned long long *bb,
+		     INT *nb,unsigned INT code,INT len)
+{
+  unsigned INT r=0;
+  INT i;
+  for(i=0;i<len;i++){
+    r=(r<<1)|(code&1);
+    code>>=1;
+  }
+  put_bits(out,pos,bb,nb,r,len);
+  return;
+}
+
+/* Appends the fixed Huffman code of a literal/length symbol */
+static void put_litlen(unsigned char *out,size_t *pos,unsigned long long *bb,
+		       INT *nb,INT s)
+{
+  if(s<144)
+    put_code(out,pos,bb,nb,0x30+s,8);
+  else if(s<256)
+    put_code(out,pos,bb,nb,0x190+(s-144),9);
+  else if(s<280)
+    put_code(out,pos,bb,nb,s-256,7);
+  else
+    put_code(out,pos,bb,nb,0xc0+(s-280),8);
+  return;
+}
+
+/*
+ * Compresses in[0:n-1] (n <= VTU_BLOCK_SIZE) into a zlib stream in
+ * out, which must have room for n+n/8+64 bytes, and returns its length.
+ * Matches are found with hash chains over the whole input and coded
+ * with the fixed Huffman codes; if this does not make the data shorter,
+ * it is stored.  head (2^VTU_HASH_BITS) and prev (n) are working arrays.
+ */
+static size_t vtu_deflate(const unsigned char *in,size_t n,unsigned char *out,
+			  INT *head,INT *prev)
+{
+  size_t pos=2,i,j,maxlen;
+  unsigned long long bb=0;
+  INT nb=0,k,best,dist=0,p,chain;
+  unsigned INT h,a=1,b=0;
+  out[0]=0x78; out[1]=0x01;
+  for(k=0;k<(1<<VTU_HASH_BITS);k++) head[k]=-1;
+  put_bits(out,&pos,&bb,&nb,1,1); // last block
+  put_bits(out,&pos,&bb,&nb,1,2); // fixed Huffman codes
+  i=0;
+  while(i<n){
+    best=0;
+    if(i+2<n){
+      h=(((unsigned INT )in[i]<<16)|((unsigned INT )in[i+1]<<8)|in[i+2]);
+      h=(h*2654435761u)>>(32-VTU_HASH_BITS);
+      maxlen=n-i;
+      if(maxlen>258) maxlen=258;
+      p=head[h];
+      for(chain=0;p>=0 && chain<VTU_MAX_CHAIN;chain++){
+	for(j=0;j<maxlen && in[p+j]==in[i+j];j++);
+	if((INT )j>best){
+	  best=(INT )j;
+	  dist=(INT )i-p;
+	  if(j==maxlen) break;
+	}
+	p=prev[p];
+      }
+      prev[i]=head[h];
+      head[h]=(INT )i;
+    }
+    if(best>=3){
+      for(k=28;len_base[k]>best;k--);
+      put_litlen(out,&pos,&bb,&nb,257+k);
+      put_bits(out,&pos,&bb,&nb,best-len_base[k],len_extra[k]);
+      for(k=29;dist_base[k]>dist;k--);
+      put_code(out,&pos,&bb,&nb,k,5);
+      put_bits(out,&pos,&bb,&nb,dist-dist_base[k],dist_extra[k]);
+      // the skipped positions go in the hash chains too
+      for(j=i+1;j<i+best && j+2<n;j++){
+	h=(((unsigned INT )in[j]<<16)|((unsigned INT )in[j+1]<<8)|in[j+2]);
+	h=(h*2654435761u)>>(32-VTU_HASH_BITS);
+	prev[j]=head[h];
+	head[h]=(INT )j;
+      }
+      i+=best;
+    } else {
+      put_litlen(out,&pos,&bb,&nb,in[i]);
+      i++;
+    }
+    // fixed codes can make incompressible data longer: store it instead.
+    if(pos>n+8) break;
+  }
+  if(i<n || pos>n+8){
+    // a stored block: header byte, length and its complement, data.
+    out[2]=0x01;
+    out[3]=(unsigned char )(n&0xff); out[4]=(unsigned char )(n>>8);
+    out[5]=(unsigned char )(~n&0xff); out[6]=(unsigned char )((~n>>8)&0xff);
+    memcpy(out+7,in,n);
+    pos=7+n;
+  } else {
+    put_litlen(out,&pos,&bb,&nb,256); // end of block
+    if(nb>0) put_bits(out,&pos,&bb,&nb,0,8-nb);
+  }
+  // Adler-32 checksum of the input
+  for(i=0;i<n;i++){
+    a=(a+in[i])%65521;
+    b=(b+a)%65521;
+  }
+  h=(b<<16)|a;
+  out[pos++]=(unsigned char )(h>>24);
+  out[pos++]=(unsigned char )((h>>16)&0xff);
+  out[pos++]=(unsigned char )((h>>8)&0xff);
+  out[pos++]=(unsigned char )(h&0xff);
+  return pos;
+}
+
+/*
+ * Writes n bytes of binary data: to the appended data (VTU_BINARY) or
+ * base64 encoded to the XML (VTU_BASE64).
+ */
+static void vtu_sink(vtu_file *vf,const unsigned char *a,size_t n)
+{
+  char enc[4096];
+  INT m=0;
+  size_t i=0;
+  unsigned INT t;
+  if(vf->format==VTU_BINARY){
+    if(n && fwrite(a,1,n,vf->app)!=n) check_error(ERROR_OPEN_FILE,__FUNCTION__);
+    vf->app_len += (long long )n;
+    return;
+  }
+  while(i<n){
+    vf->b64[vf->nb64++]=a[i++];
+    if(vf->nb64==3){
+      t=((unsigned INT )vf->b64[0]<<16)|((unsigned INT )vf->b64[1]<<8)|vf->b64[2];
+      enc[m++]=b64_chars[(t>>18)&63];
+      enc[m++]=b64_chars[(t>>12)&63];
+      enc[m++]=b64_chars[(t>>6)&63];
+      enc[m++]=b64_chars[t&63];
+      vf->nb64=0;
+      if(m==4096){
+	fwrite(enc,1,m,vf->fp);
+	m=0;
+      }
+    }
+  }
+  if(m) fwrite(enc,1,m,vf->fp);
+  return;
+}
+
+/* Ends a base64 stream, padding the last group of bytes */
+static void vtu_b64_end(vtu_file *vf)
+{
+  char enc[4];
+  unsigned INT t;
+  if(vf->format!=VTU_BASE64 || vf->nb64==0) return;
+  t=(unsigned INT )vf->b64[0]<<16;
+  if(vf->nb64>1) t|=(unsigned INT )vf->b64[1]<<8;
+  enc[0]=b64_chars[(t>>18)&63];
+  enc[1]=b64_chars[(t>>12)&63];
+  enc[2]=(vf->nb64>1) ? b64_chars[(t>>6)&63] : '=';
+  enc[3]='=';
+  fwrite(enc,1,4,vf->fp);
+  vf->nb64=0;
+  return;
+}
+
+/* Sends the filled block on: compressed and kept, or written */
+static void vtu_block_done(vtu_file *vf)
+{
+  size_t m;
+  if(vf->nblock==0) return;
+  if(vf->compress){
+    m=vtu_deflate(vf->block,(size_t )vf->nblock,vf->cwork,vf->head,vf->prev);
+    if(vf->clen+(long long )m>vf->ccap){
+      vf->ccap=2*(vf->clen+(long long )m);
+      vf->cdata=(unsigned char *)realloc(vf->cdata,(size_t )vf->ccap);
+    }
+    memcpy(vf->cdata+vf->clen,vf->cwork,m);
+    vf->clen += (long long )m;
+    vf->csize[vf->ncblock++]=(unsigned long long )m;
+  } else {
+    vtu_sink(vf,vf->block,(size_t )vf->nblock);
+  }
+  vf->nblock=0;
+  return;
+}
+
+/* Adds n bytes to the binary data of the array being written */
+static void vtu_put(vtu_file *vf,const void *a,size_t n)
+{
+  const unsigned char *c=(const unsigned char *)a;
+  size_t m;
+  while(n>0){
+    m=VTU_BLOCK_SIZE-vf->nblock;
+    if(m>n) m=n;
+    memcpy(vf->block+vf->nblock,c,m);
+    vf->nblock += (INT )m;
+    c+=m;
+    n-=m;
+    if(vf->nblock==VTU_BLOCK_SIZE) vtu_block_done(vf);
+  }
+  return;
+}
+
+/*
+ * Writes the opening tag of a DataArray with nbytes of data and
+ * prepares the binary data (header of uncompressed arrays).
+ */
+static void vtu_array_begin(vtu_file *vf,const char *type,const char *name,
+			    INT ncomp,long long nbytes)
+{
+  unsigned long long hdr=(unsigned long long )nbytes;
+  INT nb;
+  fprintf(vf->fp,"<DataArray type=\"%s\"",type);
+  if(name) fprintf(vf->fp," Name=\"%s\"",name);
+  if(ncomp>1) fprintf(vf->fp," NumberOfComponents=\"%d\"",ncomp);
+  if(vf->format==VTU_ASCII){
+    fprintf(vf->fp," format=\"ascii\">");
+    return;
+  } else if(vf->format==VTU_BINARY){
+    fprintf(vf->fp," format=\"appended\" offset=\"%lld\"/>\n",vf->app_len);
+  } else {
+    fprintf(vf->fp," format=\"binary\">");
+  }
+  vf->nbytes=nbytes;
+  vf->nblock=0;
+  if(vf->compress){
+    nb=(INT )((nbytes+VTU_BLOCK_SIZE-1)/VTU_BLOCK_SIZE);
+    vf->csize=(unsigned long long *)realloc(vf->csize,(nb+1)*sizeof(unsigned long long));
+    vf->ncblock=0;
+    vf->clen=0;
+  } else {
+    // uncompressed: the header is the number of bytes
+    vtu_sink(vf,(unsigned char *)&hdr,sizeof(hdr));
+  }
+  return;
+}
+
+/* Finishes the binary data and the DataArray */
+static void vtu_array_end(vtu_file *vf)
+{
+  unsigned long long hdr[3];
+  if(vf->format==VTU_ASCII){
+    fprintf(vf->fp,"</DataArray>\n");
+    return;
+  }
+  vtu_block_done(vf);
+  if(vf->compress){
+    // header: number of blocks, block size, size of the last partial
+    // block (0 if it is full) and the compressed size of every block;
+    // base64 encoded separately from the data.
+    hdr[0]=(unsigned long long )vf->ncblock;
+    hdr[1]=VTU_BLOCK_SIZE;
+    hdr[2]=(unsigned long long )(vf->nbytes%VTU_BLOCK_SIZE);
+    vtu_sink(vf,(unsigned char *)hdr,sizeof(hdr));
+    vtu_sink(vf,(unsigned char *)vf->csize,vf->ncblock*sizeof(unsigned long long));
+    vtu_b64_end(vf);
+    vtu_sink(vf,vf->cdata,(size_t )vf->clen);
+  }
+  vtu_b64_end(vf);
+  if(vf->format==VTU_BASE64) fprintf(vf->fp,"</DataArray>\n");
+  return;
+}
+/**********************************************************************/
+/*!
+ * \fn void set_vtu_format(INT format,INT compress)
+ *
+ * \brief Sets the format of the data in the VTU files written from now
+ *        on (by vtu_open(), so by dump_mesh_vtk(), dump_sol_vtk(),
+ *        dump_blocksol_vtk(), dump_sol_onV_vtk() and vtkw()).
+ *
+ * \param format    VTU_ASCII (default): values written as text;
+ *                  VTU_BINARY: raw binary data appended to the file;
+ *                  VTU_BASE64: base64 encoded binary data in the XML
+ * \param compress  If nonzero, binary data is compressed (zlib format)
+ *
+ * \note Binary data is written with the byte order of the machine.
+ *       read_grid_vtk() only reads ascii files.
+ *
+ */
+void set_vtu_format(INT format,INT compress)
+{
+  if(format!=VTU_ASCII && format!=VTU_BINARY && format!=VTU_BASE64)
+    check_error(ERROR_INPUT_PAR,__FUNCTION__);
+  vtu_format=format;
+  vtu_compress=(compress!=0);
+  return;
+}
+/**********************************************************************/
+/*!
+ * \fn struct vtu_file *vtu_open(char *namevtu,INT nv,INT nelm)
+ *
+ * \brief Opens a VTU file for an unstructured grid with one piece,
+ *        in the format given by set_vtu_format(), and writes the
+ *        headers up to <Piece>.
+ *
+ * \param namevtu   Filename
+ * \param nv        Number of points
+ * \param nelm      Number of cells
+ *
+ * \return the file, for vtu_array_real(), vtu_array_int(),
+ *         vtu_cells() and vtu_close(). Other XML (e.g. <PointData>)
+ *         is written with fprintf() to vf->fp.
+ *
+ */
+struct vtu_file *vtu_open(char *namevtu,INT nv,INT nelm)
+{
+  vtu_file *vf=(vtu_file *)calloc(1,sizeof(vtu_file));
+  unsigned INT one=1;
+  char *endian=(*(unsigned char *)&one) ? "LittleEndian" : "BigEndian";
+  vf->format=vtu_format;
+  vf->compress=(vtu_format!=VTU_ASCII) ? vtu_compress : 0;
+  vf->fp=HAZ_fopen(namevtu,"w");
+  if(vf->format==VTU_ASCII){
+    fprintf(vf->fp,"<VTKFile type=\"UnstructuredGrid\" version=\"0.1\" byte_order=\"%s\">\n",endian);
+  } else {
+    fprintf(vf->fp,"<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\"%s\" header_type=\"UInt64\"%s>\n", \
+	    endian,vf->compress ? " compressor=\"vtkZLibDataCompressor\"" : "");
+    vf->block=(unsigned char *)malloc(VTU_BLOCK_SIZE);
+  }
+  if(vf->format==VTU_BINARY){
+    vf->app=tmpfile();
+    if(vf->app==NULL) check_error(ERROR_OPEN_FILE,__FUNCTION__);
+  }
+  if(vf->compress){
+    vf->cwork=(unsigned char *)malloc(VTU_BLOCK_SIZE+VTU_BLOCK_SIZE/8+64);
+    vf->head=(INT *)malloc((1<<VTU_HASH_BITS)*sizeof(INT));
+    vf->prev=(INT *)malloc(VTU_BLOCK_SIZE*sizeof(INT));
+  }
+  fprintf(vf->fp,"<UnstructuredGrid>\n");
+  fprintf(vf->fp,"<Piece NumberOfPoints=\"%i\" NumberOfCells=\"%i\">\n",nv,nelm);
+  return vf;
+}
+/**********************************************************************/
+/*!
+ * \fn void vtu_array_real(vtu_file *vf,const char *name,INT n,INT ncomp,REAL **src,INT stride)
+ *
+ * \brief Writes a Float64 DataArray with n tuples of ncomp components.
+ *        Component c of tuple i is src[c][i*stride], or 0 if src[c]
+ *        is NULL.
+ *
+ * \param vf      VTU file
+ * \param name    Name of the array (NULL for the points)
+ * \param n       Number of tuples
+ * \param ncomp   Number of components
+ * \param src     ncomp pointers to the components
+ * \param stride  Distance between two tuples in src[c] (0 for a
+ *                constant)
+ *
+ */
+void vtu_array_real(vtu_file *vf,const char *name,INT n,INT ncomp,REAL **src,INT stride)
+{
+  REAL buf[1024];
+  INT i,c,m=0;
+  vtu_array_begin(vf,"Float64",name,ncomp,(long long )n*ncomp*sizeof(REAL));
+  for(i=0;i<n;i++){
+    for(c=0;c<ncomp;c++){
+      buf[m]=(src[c]) ? src[c][(long long )i*stride] : 0e0;
+      if(vf->format==VTU_ASCII) {
+	fprintf(vf->fp," %23.16e ",buf[m]);
+      } else if(++m==1024) {
+	vtu_put(vf,buf,m*sizeof(REAL));
+	m=0;
+      }
+    }
+  }
+  if(m) vtu_put(vf,buf,m*sizeof(REAL));
+  vtu_array_end(vf);
+  return;
+}
+/**********************************************************************/
+/*!
+ * \fn void vtu_array_int(vtu_file *vf,const char *name,INT n,INT *src,INT stride,INT shift)
+ *
+ * \brief Writes an integer DataArray with the n values
+ *        src[i*stride]+shift, or i*stride+shift if src is NULL.
+ *
+ * \param vf      VTU file
+ * \param name    Name of the array
+ * \param n       Number of values
+ * \param src     Values (or NULL)
+ * \param stride  Distance between two values in src (0 for a constant)
+ * \param shift   Added to all values
+ *
+ */
+void vtu_array_int(vtu_file *vf,const char *name,INT n,INT *src,INT stride,INT shift)
+{
+  INT buf[1024];
+  INT i,m=0;
+  char *type=(vf->format==VTU_ASCII || sizeof(INT)==8) ? "Int64" : "Int32";
+  vtu_array_begin(vf,type,name,1,(long long )n*sizeof(INT));
+  for(i=0;i<n;i++){
+    buf[m]=((src) ? src[(long long )i*stride] : i*stride)+shift;
+    if(vf->format==VTU_ASCII) {
+      fprintf(vf->fp," %i ",buf[m]);
+    } else if(++m==1024) {
+      vtu_put(vf,buf,m*sizeof(INT));
+      m=0;
+    }
+  }
+  if(m) vtu_put(vf,buf,m*sizeof(INT));
+  vtu_array_end(vf);
+  return;
+}
+/**********************************************************************/
+/*!
+ * \fn void vtu_cells(vtu_file *vf,INT nelm,INT dim,INT *el_v,INT shift)
+ *
+ * \brief Writes the <Cells> of a simplicial grid: offsets,
+ *        connectivity and types.
+ *
+ * \param vf      VTU file
+ * \param nelm    Number of elements
+ * \param dim     Dimension: the cells are lines (1), triangles (2) or
+ *                tetrahedra (3)
+ * \param el_v    The dim+1 vertices of every element
+ * \param shift   Added to the vertex numbers
+ *
+ */
+void vtu_cells(vtu_file *vf,INT nelm,INT dim,INT *el_v,INT shift)
+{
+  /*
+    Types of cells for VTK
+
+    VTK_VERTEX (=1)
+    VTK_POLY_VERTEX (=2)
+    VTK_LINE (=3)
+    VTK_POLY_LINE (=4)
+    VTK_TRIANGLE(=5)
+    VTK_TRIANGLE_STRIP (=6)
+    VTK_POLYGON (=7)
+    VTK_PIXEL (=8)
+    VTK_QUAD (=9)
+    VTK_TETRA (=10)
+    VTK_VOXEL (=11)
+    VTK_HEXAHEDRON (=12)
+    VTK_WEDGE (=13)
+    VTK_PYRAMID (=14)
+  */
+  const INT LINE=3;
+  const INT TRI=5;
+  const INT TET=10;
+  INT n1=dim+1,tcell;
+  if(dim==1)
+    tcell=LINE; /* line */
+  else if(dim==2)
+    tcell=TRI; /* triangle */
+  else
+    tcell=TET; /* tet */
+  fprintf(vf->fp,"<Cells>\n");
+  vtu_array_int(vf,"offsets",nelm,NULL,n1,n1);
+  vtu_array_int(vf,"connectivity",nelm*n1,el_v,1,shift);
+  vtu_array_int(vf,"types",nelm,&tcell,0,0);
+  fprintf(vf->fp,"</Cells>\n");
+  return;
+}
+/**********************************************************************/
+/*!
+ * \fn void vtu_close(vtu_file *vf)
+ *
+ * \brief Writes the rest of a VTU file (with the appended data if
+ *        any), closes it and frees vf.
+ *
+ * \param vf      VTU file
+ *
+ */
+void vtu_close(vtu_file *vf)
+{
+  unsigned char *buf;
+  size_t m;
+  fprintf(vf->fp,"</Piece>\n");
+  fprintf(vf->fp,"</UnstructuredGrid>\n");
+  if(vf->format==VTU_BINARY){
+    fprintf(vf->fp,"<AppendedData encoding=\"raw\">\n_");
+    buf=(unsigned char *)malloc(VTU_BLOCK_SIZE);
+    rewind(vf->app);
+    while((m=fread(buf,1,VTU_BLOCK_SIZE,vf->app))>0){
+      if(fwrite(buf,1,m,vf->fp)!=m) check_error(ERROR_OPEN_FILE,__FUNCTION__);
+    }
+    free(buf);
+    fclose(vf->app);
+    fprintf(vf->fp,"\n</AppendedData>\n");
+  }
+  fprintf(vf->fp,"</VTKFile>\n");
+  fclose(vf->fp);
+  if(vf->block) free(vf->block);
+  if(vf->cdata) free(vf->cdata);
+  if(vf->csize) free(vf->csize);
+  if(vf->cwork) free(vf->cwork);
+  if(vf->head) free(vf->head);
+  if(vf->prev) free(vf->prev);
+  free(vf);
+  return;
+}
+/**********************************************************************/